@@ -40,6 +40,7 @@
 #include <limits>
 
 #include <pcl/common/common.h>
+#include <pcl/point_cloud_soa.h>
 
 /**
   * \file pcl/common/distances.h
@@ -192,6 +193,17 @@ namespace pcl
     return (diff_x*diff_x + diff_y*diff_y);
   }
 
+  /** \brief Calculate the squared euclidean distances between a point and all the points of a cloud in
+    * structure-of-arrays layout, with SSE2, and AVX when the CPU supports it.
+    * \param[in] cloud the view on the points of the cloud, e.g. PointCloudSoA::getView ()
+    * \param[in] point the point
+    * \param[out] sqr_distances the squared distances, \a cloud.size of them
+    * \ingroup common
+    */
+  PCL_EXPORTS void
+  squaredEuclideanDistances (const PointCloudSoAConstView &cloud, const Eigen::Vector3f &point,
+                             float *sqr_distances);
+
    /** \brief Calculate the euclidean distance between the two given points.
     * \param[in] p1 the first point
     * \param[in] p2 the second point
@@ -52,8 +52,13 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 namespace pcl
 {
@@ -214,6 +219,118 @@ struct Transformer<double>
 #endif // !defined(__AVX__)
 #endif // defined(__SSE2__)
 
+/** Instruction sets of the kernels transforming arrays of points. */
+enum class TransformKernel
+{
+  AUTO,     ///< the widest instruction set supported by the CPU
+  DEFAULT,  ///< one point at a time, with SSE2 if enabled at build time
+  AVX,      ///< two points at a time
+  AVX512    ///< four points at a time
+};
+
+/** Return whether the CPU supports the instruction set of a transform kernel. */
+PCL_EXPORTS bool
+isTransformKernelSupported (TransformKernel kernel);
+
+/** Apply a single-precision affine transform to an array of points, and rotate their normals.
+  * The kernels for the wider instruction sets are selected at runtime. They do the same operations as the
+  * SSE2 Transformer<float>, so the results only differ if the latter is built with fused multiply-add.
+  * \param[in] src the x, y, z, 1 coordinates of the first input point
+  * \param[out] tgt the x, y, z, 1 coordinates of the first output point, can be the same as \a src
+  * \param[in] nr_points the number of points
+  * \param[in] stride the distance between consecutive points, in bytes
+  * \param[in] normal_offset the distance in bytes between the coordinates of a point and its normal, or -1
+  * to only transform the points
+  * \param[in] transform the transform
+  * \param[in] check_finite if true, the points with non-finite coordinates are left untouched in the output
+  * \param[in] nr_threads the maximum number of threads to split large arrays between, or 0 for the number of processors
+  * \param[in] kernel the instruction set to use, falling back to DEFAULT if it is not supported */
+PCL_EXPORTS void
+transformPoints (const float *src, float *tgt, std::size_t nr_points, std::size_t stride,
+                 std::ptrdiff_t normal_offset, const Eigen::Matrix4f &transform,
+                 bool check_finite, unsigned int nr_threads = 1, TransformKernel kernel = TransformKernel::AUTO);
+
+/** Transform the points of a cloud with a generic scalar type. */
+template <typename PointT, typename Scalar> void
+transformCloudPoints (const pcl::PointCloud<PointT> &cloud_in, pcl::PointCloud<PointT> &cloud_out,
+                      const Eigen::Matrix<Scalar, 4, 4> &transform, unsigned int nr_threads)
+{
+  const Transformer<Scalar> tf (transform);
+  const auto nr_points = static_cast<std::ptrdiff_t> (cloud_out.points.size ());
+  const bool check_finite = !cloud_in.is_dense;
+#ifdef _OPENMP
+  if (nr_threads == 0)
+    nr_threads = omp_get_num_procs ();
+#endif
+#pragma omp parallel for \
+  default(none) \
+  shared(cloud_in, cloud_out) \
+  firstprivate(check_finite, nr_points, tf) \
+  num_threads(nr_threads)
+  for (std::ptrdiff_t i = 0; i < nr_points; ++i)
+  {
+    // Dataset might contain NaNs and Infs, so check for them first
+    if (check_finite && !(std::isfinite (cloud_in.points[i].x) &&
+                          std::isfinite (cloud_in.points[i].y) &&
+                          std::isfinite (cloud_in.points[i].z)))
+      continue;
+    tf.se3 (cloud_in[i].data, cloud_out[i].data);
+  }
+}
+
+/** Transform the points of a cloud in single precision, with the dispatched kernels. */
+template <typename PointT> void
+transformCloudPoints (const pcl::PointCloud<PointT> &cloud_in, pcl::PointCloud<PointT> &cloud_out,
+                      const Eigen::Matrix4f &transform, unsigned int nr_threads)
+{
+  if (cloud_out.points.empty ())
+    return;
+  transformPoints (cloud_in.points[0].data, cloud_out.points[0].data, cloud_out.points.size (), sizeof (PointT),
+                   -1, transform, !cloud_in.is_dense, nr_threads);
+}
+
+/** Transform the points and normals of a cloud with a generic scalar type. */
+template <typename PointT, typename Scalar> void
+transformCloudPointsWithNormals (const pcl::PointCloud<PointT> &cloud_in, pcl::PointCloud<PointT> &cloud_out,
+                                 const Eigen::Matrix<Scalar, 4, 4> &transform, unsigned int nr_threads)
+{
+  const Transformer<Scalar> tf (transform);
+  const auto nr_points = static_cast<std::ptrdiff_t> (cloud_out.points.size ());
+  const bool check_finite = !cloud_in.is_dense;
+#ifdef _OPENMP
+  if (nr_threads == 0)
+    nr_threads = omp_get_num_procs ();
+#endif
+#pragma omp parallel for \
+  default(none) \
+  shared(cloud_in, cloud_out) \
+  firstprivate(check_finite, nr_points, tf) \
+  num_threads(nr_threads)
+  for (std::ptrdiff_t i = 0; i < nr_points; ++i)
+  {
+    // Dataset might contain NaNs and Infs, so check for them first
+    if (check_finite && !(std::isfinite (cloud_in.points[i].x) &&
+                          std::isfinite (cloud_in.points[i].y) &&
+                          std::isfinite (cloud_in.points[i].z)))
+      continue;
+    tf.se3 (cloud_in[i].data, cloud_out[i].data);
+    tf.so3 (cloud_in[i].data_n, cloud_out[i].data_n);
+  }
+}
+
+/** Transform the points and normals of a cloud in single precision, with the dispatched kernels. */
+template <typename PointT> void
+transformCloudPointsWithNormals (const pcl::PointCloud<PointT> &cloud_in, pcl::PointCloud<PointT> &cloud_out,
+                                 const Eigen::Matrix4f &transform, unsigned int nr_threads)
+{
+  if (cloud_out.points.empty ())
+    return;
+  const std::ptrdiff_t normal_offset = reinterpret_cast<const std::uint8_t*> (cloud_in.points[0].data_n) -
+                                       reinterpret_cast<const std::uint8_t*> (cloud_in.points[0].data);
+  transformPoints (cloud_in.points[0].data, cloud_out.points[0].data, cloud_out.points.size (), sizeof (PointT),
+                   normal_offset, transform, !cloud_in.is_dense, nr_threads);
+}
+
 } // namespace detail
 
 
@@ -221,7 +338,8 @@ template <typename PointT, typename Scalar> void
 transformPointCloud (const pcl::PointCloud<PointT> &cloud_in,
                      pcl::PointCloud<PointT> &cloud_out,
                      const Eigen::Transform<Scalar, 3, Eigen::Affine> &transform,
-                     bool copy_all_fields)
+                     bool copy_all_fields,
+                     unsigned int nr_threads)
 {
   if (&cloud_in != &cloud_out)
   {
@@ -238,26 +356,7 @@ transformPointCloud (const pcl::PointCloud<PointT> &cloud_in,
     cloud_out.sensor_origin_      = cloud_in.sensor_origin_;
   }
 
-  pcl::detail::Transformer<Scalar> tf (transform.matrix ());
-  if (cloud_in.is_dense)
-  {
-    // If the dataset is dense, simply transform it!
-    for (std::size_t i = 0; i < cloud_out.points.size (); ++i)
-      tf.se3 (cloud_in[i].data, cloud_out[i].data);
-  }
-  else
-  {
-    // Dataset might contain NaNs and Infs, so check for them first,
-    // otherwise we get errors during the multiplication (?)
-    for (std::size_t i = 0; i < cloud_out.points.size (); ++i)
-    {
-      if (!std::isfinite (cloud_in.points[i].x) ||
-          !std::isfinite (cloud_in.points[i].y) ||
-          !std::isfinite (cloud_in.points[i].z))
-        continue;
-      tf.se3 (cloud_in[i].data, cloud_out[i].data);
-    }
-  }
+  pcl::detail::transformCloudPoints (cloud_in, cloud_out, transform.matrix (), nr_threads);
 }
 
 
@@ -312,7 +411,8 @@ template <typename PointT, typename Scalar> void
 transformPointCloudWithNormals (const pcl::PointCloud<PointT> &cloud_in,
                                 pcl::PointCloud<PointT> &cloud_out,
                                 const Eigen::Transform<Scalar, 3, Eigen::Affine> &transform,
-                                bool copy_all_fields)
+                                bool copy_all_fields,
+                                unsigned int nr_threads)
 {
   if (&cloud_in != &cloud_out)
   {
@@ -330,29 +430,7 @@ transformPointCloudWithNormals (const pcl::PointCloud<PointT> &cloud_in,
     cloud_out.sensor_origin_      = cloud_in.sensor_origin_;
   }
 
-  pcl::detail::Transformer<Scalar> tf (transform.matrix ());
-  // If the data is dense, we don't need to check for NaN
-  if (cloud_in.is_dense)
-  {
-    for (std::size_t i = 0; i < cloud_out.points.size (); ++i)
-    {
-      tf.se3 (cloud_in[i].data, cloud_out[i].data);
-      tf.so3 (cloud_in[i].data_n, cloud_out[i].data_n);
-    }
-  }
-  // Dataset might contain NaNs and Infs, so check for them first.
-  else
-  {
-    for (std::size_t i = 0; i < cloud_out.points.size (); ++i)
-    {
-      if (!std::isfinite (cloud_in.points[i].x) ||
-          !std::isfinite (cloud_in.points[i].y) ||
-          !std::isfinite (cloud_in.points[i].z))
-        continue;
-      tf.se3 (cloud_in[i].data, cloud_out[i].data);
-      tf.so3 (cloud_in[i].data_n, cloud_out[i].data_n);
-    }
-  }
+  pcl::detail::transformCloudPointsWithNormals (cloud_in, cloud_out, transform.matrix (), nr_threads);
 }
 
 
@@ -40,6 +40,7 @@
 #pragma once
 
 #include <pcl/point_cloud.h>
+#include <pcl/point_cloud_soa.h>
 #include <pcl/point_types.h>
 #include <pcl/common/centroid.h>
 #include <pcl/common/eigen.h>
@@ -53,22 +54,27 @@ namespace pcl
     * \param[in] transform an affine transformation (typically a rigid transformation)
     * \param[in] copy_all_fields flag that controls whether the contents of the fields
     * (other than x, y, z) should be copied into the new transformed cloud
-    * \note Can be used with cloud_in equal to cloud_out
+    * \param[in] nr_threads the maximum number of threads to split large clouds between,
+    * or 0 for the number of processors
+    * \note Can be used with cloud_in equal to cloud_out. Single precision transforms use the widest
+    * SIMD instruction set supported by the CPU at runtime.
     * \ingroup common
     */
   template <typename PointT, typename Scalar> void 
   transformPointCloud (const pcl::PointCloud<PointT> &cloud_in, 
                        pcl::PointCloud<PointT> &cloud_out, 
                        const Eigen::Transform<Scalar, 3, Eigen::Affine> &transform,
-                       bool copy_all_fields = true);
+                       bool copy_all_fields = true,
+                       unsigned int nr_threads = 1);
 
   template <typename PointT> void 
   transformPointCloud (const pcl::PointCloud<PointT> &cloud_in, 
                        pcl::PointCloud<PointT> &cloud_out, 
                        const Eigen::Affine3f &transform,
-                       bool copy_all_fields = true)
+                       bool copy_all_fields = true,
+                       unsigned int nr_threads = 1)
   {
-    return (transformPointCloud<PointT, float> (cloud_in, cloud_out, transform, copy_all_fields));
+    return (transformPointCloud<PointT, float> (cloud_in, cloud_out, transform, copy_all_fields, nr_threads));
   }
 
   /** \brief Apply an affine transform defined by an Eigen Transform
@@ -133,23 +139,61 @@ namespace pcl
     * \param[in] copy_all_fields flag that controls whether the contents of the fields
     * (other than x, y, z, normal_x, normal_y, normal_z) should be copied into the new
     * transformed cloud
-    * \note Can be used with cloud_in equal to cloud_out
+    * \param[in] nr_threads the maximum number of threads to split large clouds between,
+    * or 0 for the number of processors
+    * \note Can be used with cloud_in equal to cloud_out. Single precision transforms use the widest
+    * SIMD instruction set supported by the CPU at runtime.
     */
   template <typename PointT, typename Scalar> void 
   transformPointCloudWithNormals (const pcl::PointCloud<PointT> &cloud_in, 
                                   pcl::PointCloud<PointT> &cloud_out, 
                                   const Eigen::Transform<Scalar, 3, Eigen::Affine> &transform,
-                                  bool copy_all_fields = true);
+                                  bool copy_all_fields = true,
+                                  unsigned int nr_threads = 1);
 
   template <typename PointT> void 
   transformPointCloudWithNormals (const pcl::PointCloud<PointT> &cloud_in, 
                                   pcl::PointCloud<PointT> &cloud_out, 
                                   const Eigen::Affine3f &transform,
-                                  bool copy_all_fields = true)
+                                  bool copy_all_fields = true,
+                                  unsigned int nr_threads = 1)
   {
-    return (transformPointCloudWithNormals<PointT, float> (cloud_in, cloud_out, transform, copy_all_fields));
+    return (transformPointCloudWithNormals<PointT, float> (cloud_in, cloud_out, transform, copy_all_fields, nr_threads));
   }
 
+  /** \brief Apply an affine transform to a point cloud in structure-of-arrays layout.
+    * The coordinates are transformed with SSE/AVX when available. Non-finite points stay non-finite.
+    * \param[in] cloud_in the input point cloud
+    * \param[out] cloud_out the resultant output point cloud
+    * \param[in] transform an affine transformation (typically a rigid transformation)
+    * \param[in] copy_all_fields flag that controls whether the normals and colors of
+    * \a cloud_in should be copied into the new transformed cloud
+    * \note Can be used with cloud_in equal to cloud_out
+    * \ingroup common
+    */
+  PCL_EXPORTS void
+  transformPointCloud (const pcl::PointCloudSoA &cloud_in,
+                       pcl::PointCloudSoA &cloud_out,
+                       const Eigen::Affine3f &transform,
+                       bool copy_all_fields = true);
+
+  /** \brief Transform a point cloud in structure-of-arrays layout and rotate its normals.
+    * The coordinates and normals are transformed with SSE/AVX when available. Non-finite points stay
+    * non-finite.
+    * \param[in] cloud_in the input point cloud, which has to store normals
+    * \param[out] cloud_out the resultant output point cloud
+    * \param[in] transform an affine transformation (typically a rigid transformation)
+    * \param[in] copy_all_fields flag that controls whether the colors of \a cloud_in should
+    * be copied into the new transformed cloud
+    * \note Can be used with cloud_in equal to cloud_out
+    * \ingroup common
+    */
+  PCL_EXPORTS void
+  transformPointCloudWithNormals (const pcl::PointCloudSoA &cloud_in,
+                                  pcl::PointCloudSoA &cloud_out,
+                                  const Eigen::Affine3f &transform,
+                                  bool copy_all_fields = true);
+
   /** \brief Transform a point cloud and rotate its normals using an Eigen transform.
     * \param[in] cloud_in the input point cloud
     * \param[in] indices the set of point indices to use from the input point cloud
@@ -212,6 +256,8 @@ namespace pcl
     * \param[in] transform a rigid transformation 
     * \param[in] copy_all_fields flag that controls whether the contents of the fields
     * (other than x, y, z) should be copied into the new transformed cloud
+    * \param[in] nr_threads the maximum number of threads to split large clouds between,
+    * or 0 for the number of processors
     * \note Can be used with cloud_in equal to cloud_out
     * \ingroup common
     */
@@ -219,19 +265,21 @@ namespace pcl
   transformPointCloud (const pcl::PointCloud<PointT> &cloud_in, 
                        pcl::PointCloud<PointT> &cloud_out, 
                        const Eigen::Matrix<Scalar, 4, 4> &transform,
-                       bool copy_all_fields = true)
+                       bool copy_all_fields = true,
+                       unsigned int nr_threads = 1)
   {
     Eigen::Transform<Scalar, 3, Eigen::Affine> t (transform);
-    return (transformPointCloud<PointT, Scalar> (cloud_in, cloud_out, t, copy_all_fields));
+    return (transformPointCloud<PointT, Scalar> (cloud_in, cloud_out, t, copy_all_fields, nr_threads));
   }
 
   template <typename PointT> void 
   transformPointCloud (const pcl::PointCloud<PointT> &cloud_in, 
                        pcl::PointCloud<PointT> &cloud_out, 
                        const Eigen::Matrix4f &transform,
-                       bool copy_all_fields = true)
+                       bool copy_all_fields = true,
+                       unsigned int nr_threads = 1)
   {
-    return (transformPointCloud<PointT, float> (cloud_in, cloud_out, transform, copy_all_fields));
+    return (transformPointCloud<PointT, float> (cloud_in, cloud_out, transform, copy_all_fields, nr_threads));
   }
 
   /** \brief Apply a rigid transform defined by a 4x4 matrix
@@ -300,6 +348,8 @@ namespace pcl
     * \param[in] copy_all_fields flag that controls whether the contents of the fields
     * (other than x, y, z, normal_x, normal_y, normal_z) should be copied into the new
     * transformed cloud
+    * \param[in] nr_threads the maximum number of threads to split large clouds between,
+    * or 0 for the number of processors
     * \note Can be used with cloud_in equal to cloud_out
     * \ingroup common
     */
@@ -307,10 +357,11 @@ namespace pcl
   transformPointCloudWithNormals (const pcl::PointCloud<PointT> &cloud_in, 
                                   pcl::PointCloud<PointT> &cloud_out, 
                                   const Eigen::Matrix<Scalar, 4, 4> &transform,
-                                  bool copy_all_fields = true)
+                                  bool copy_all_fields = true,
+                                  unsigned int nr_threads = 1)
   {
     Eigen::Transform<Scalar, 3, Eigen::Affine> t (transform);
-    return (transformPointCloudWithNormals<PointT, Scalar> (cloud_in, cloud_out, t, copy_all_fields));
+    return (transformPointCloudWithNormals<PointT, Scalar> (cloud_in, cloud_out, t, copy_all_fields, nr_threads));
   }
 
 
@@ -318,9 +369,10 @@ namespace pcl
   transformPointCloudWithNormals (const pcl::PointCloud<PointT> &cloud_in, 
                                   pcl::PointCloud<PointT> &cloud_out, 
                                   const Eigen::Matrix4f &transform,
-                                  bool copy_all_fields = true)
+                                  bool copy_all_fields = true,
+                                  unsigned int nr_threads = 1)
   {
-    return (transformPointCloudWithNormals<PointT, float> (cloud_in, cloud_out, transform, copy_all_fields));
+    return (transformPointCloudWithNormals<PointT, float> (cloud_in, cloud_out, transform, copy_all_fields, nr_threads));
   }
 
   /** \brief Transform a point cloud and rotate its normals using an Eigen transform.
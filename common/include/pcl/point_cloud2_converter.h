@@ -0,0 +1,351 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/PCLPointCloud2.h>
+#include <pcl/PCLPointField.h>
+#include <pcl/conversions.h>
+#include <pcl/for_each_type.h>
+#include <pcl/point_cloud.h>
+#include <pcl/type_traits.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Copy a field of \a N bytes for \a count consecutive points. The size being a constant, the copy is
+      * compiled to plain loads and stores instead of a memcpy call per point.
+      */
+    template <std::size_t N> inline void
+    copyFieldBlock (const std::uint8_t *src, std::size_t src_step, std::uint8_t *dst, std::size_t dst_step,
+                    std::size_t, std::size_t count)
+    {
+      for (std::size_t i = 0; i < count; ++i, src += src_step, dst += dst_step)
+        std::memcpy (dst, src, N);
+    }
+
+    /** \brief Copy a field of any size for \a count consecutive points. */
+    inline void
+    copyFieldBlockGeneric (const std::uint8_t *src, std::size_t src_step, std::uint8_t *dst, std::size_t dst_step,
+                           std::size_t size, std::size_t count)
+    {
+      for (std::size_t i = 0; i < count; ++i, src += src_step, dst += dst_step)
+        std::memcpy (dst, src, size);
+    }
+
+    using CopyFieldBlockFunction = void (*) (const std::uint8_t*, std::size_t, std::uint8_t*, std::size_t,
+                                             std::size_t, std::size_t);
+
+    /** \brief Get the block copy specialized for fields of \a size bytes, or the generic one. */
+    inline CopyFieldBlockFunction
+    getCopyFieldBlock (std::size_t size)
+    {
+      switch (size)
+      {
+        case 1: return (&copyFieldBlock<1>);
+        case 2: return (&copyFieldBlock<2>);
+        case 4: return (&copyFieldBlock<4>);
+        case 8: return (&copyFieldBlock<8>);
+        case 12: return (&copyFieldBlock<12>);
+        case 16: return (&copyFieldBlock<16>);
+        case 20: return (&copyFieldBlock<20>);
+        case 24: return (&copyFieldBlock<24>);
+        case 28: return (&copyFieldBlock<28>);
+        case 32: return (&copyFieldBlock<32>);
+        case 48: return (&copyFieldBlock<48>);
+        case 64: return (&copyFieldBlock<64>);
+        default: return (&copyFieldBlockGeneric);
+      }
+    }
+  } // namespace detail
+
+  /** \brief PCLPointCloud2Converter converts between PCLPointCloud2 and PointCloud<PointT>, like fromPCLPointCloud2
+    * and toPCLPointCloud2, for streams of clouds sharing the same layout.
+    *
+    * The mapping between the serialized fields and the fields of \a PointT is compiled once, into a list of copies
+    * of fixed offsets and sizes, and only rebuilt when the layout of the converted message changes. The points are
+    * copied block by block, field after field, with a copy specialized for the size of each field. Large clouds are
+    * split between threads.
+    *
+    * \code
+    * pcl::PCLPointCloud2Converter<pcl::PointXYZRGB> converter;
+    * for (const auto &msg : messages)
+    *   converter.fromPCLPointCloud2 (*msg, cloud);
+    * \endcode
+    * \ingroup common
+    */
+  template <typename PointT>
+  class PCLPointCloud2Converter
+  {
+    public:
+      /** \brief Constructor.
+        * \param[in] nr_threads the number of threads to split large clouds between, or 0 for automatic
+        */
+      PCLPointCloud2Converter (unsigned int nr_threads = 0)
+      {
+        setNumberOfThreads (nr_threads);
+        for_each_type<typename traits::fieldList<PointT>::type> (detail::FieldAdder<PointT> (point_fields_));
+      }
+
+      /** \brief Set the number of threads to split large clouds between.
+        * \param[in] nr_threads the number of threads to use, or 0 for automatic
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0)
+      {
+#ifdef _OPENMP
+        threads_ = nr_threads == 0 ? omp_get_num_procs () : nr_threads;
+#else
+        threads_ = 1;
+        (void) nr_threads;
+#endif
+      }
+
+      /** \brief Compile the mapping of a serialized layout to \a PointT. This is done by fromPCLPointCloud2 when
+        * the layout of the message changes, and only needed to move that cost out of the first conversion.
+        * \param[in] fields the fields of the serialized points
+        * \param[in] point_step the size of a serialized point, in bytes
+        */
+      void
+      compile (const std::vector<pcl::PCLPointField> &fields, std::uint32_t point_step);
+
+      /** \brief Return whether the compiled mapping applies to the layout of a message. */
+      bool
+      isCompiledFor (const pcl::PCLPointCloud2 &msg) const;
+
+      /** \brief Get the compiled mapping between the serialized fields and the fields of \a PointT. */
+      inline const MsgFieldMap&
+      getFieldMap () const { return (field_map_); }
+
+      /** \brief Convert a PCLPointCloud2 binary data blob into a pcl::PointCloud<T> object, compiling the mapping
+        * first if the layout of the message is not the compiled one.
+        * \param[in] msg the PCLPointCloud2 binary blob
+        * \param[out] cloud the resultant pcl::PointCloud<T>
+        */
+      void
+      fromPCLPointCloud2 (const pcl::PCLPointCloud2 &msg, pcl::PointCloud<PointT> &cloud);
+
+      /** \brief Convert a pcl::PointCloud<T> object to a PCLPointCloud2 binary data blob.
+        * \param[in] cloud the input pcl::PointCloud<T>
+        * \param[out] msg the resultant PCLPointCloud2 binary blob
+        */
+      void
+      toPCLPointCloud2 (const pcl::PointCloud<PointT> &cloud, pcl::PCLPointCloud2 &msg) const;
+
+    protected:
+      /** \brief A copy of the compiled mapping, with the block copy specialized for its size. */
+      struct FieldCopy
+      {
+        std::size_t serialized_offset;
+        std::size_t struct_offset;
+        std::size_t size;
+        detail::CopyFieldBlockFunction copy;
+      };
+
+      /** \brief Get the number of threads to split \a nr_points points between. */
+      inline unsigned int
+      getNumberOfThreads (std::size_t nr_points) const
+      {
+        const std::size_t max_threads = std::max<std::size_t> (nr_points / min_points_per_thread_, 1);
+        return (static_cast<unsigned int> (std::min<std::size_t> (threads_, max_threads)));
+      }
+
+      /** \brief The number of consecutive points converted together, field after field. */
+      static constexpr std::size_t block_size_ = 1024;
+
+      /** \brief The minimum number of points worth an additional thread. */
+      static constexpr std::size_t min_points_per_thread_ = 32768;
+
+      /** \brief The fields of \a PointT, in the order of toPCLPointCloud2. */
+      std::vector<pcl::PCLPointField> point_fields_;
+
+      /** \brief The serialized layout the mapping is compiled for. */
+      std::vector<pcl::PCLPointField> compiled_fields_;
+      std::uint32_t compiled_point_step_ = 0;
+      bool compiled_ = false;
+
+      /** \brief The compiled mapping. */
+      MsgFieldMap field_map_;
+      std::vector<FieldCopy> copies_;
+
+      /** \brief True if a serialized point is a \a PointT, copied as a whole. */
+      bool identity_ = false;
+
+      unsigned int threads_ = 1;
+  };
+
+  template <typename PointT> void
+  PCLPointCloud2Converter<PointT>::compile (const std::vector<pcl::PCLPointField> &fields, std::uint32_t point_step)
+  {
+    field_map_.clear ();
+    createMapping<PointT> (fields, field_map_);
+
+    copies_.clear ();
+    for (const auto &mapping : field_map_)
+      copies_.push_back ({mapping.serialized_offset, mapping.struct_offset, mapping.size,
+                          detail::getCopyFieldBlock (mapping.size)});
+
+    identity_ = field_map_.size () == 1 &&
+                field_map_[0].serialized_offset == 0 &&
+                field_map_[0].struct_offset == 0 &&
+                field_map_[0].size == point_step &&
+                field_map_[0].size == sizeof (PointT);
+
+    compiled_fields_ = fields;
+    compiled_point_step_ = point_step;
+    compiled_ = true;
+  }
+
+  template <typename PointT> bool
+  PCLPointCloud2Converter<PointT>::isCompiledFor (const pcl::PCLPointCloud2 &msg) const
+  {
+    if (!compiled_ || msg.point_step != compiled_point_step_ || msg.fields.size () != compiled_fields_.size ())
+      return (false);
+    for (std::size_t i = 0; i < msg.fields.size (); ++i)
+    {
+      const pcl::PCLPointField &a = msg.fields[i], &b = compiled_fields_[i];
+      if (a.offset != b.offset || a.datatype != b.datatype || a.count != b.count || a.name != b.name)
+        return (false);
+    }
+    return (true);
+  }
+
+  template <typename PointT> void
+  PCLPointCloud2Converter<PointT>::fromPCLPointCloud2 (const pcl::PCLPointCloud2 &msg,
+                                                       pcl::PointCloud<PointT> &cloud)
+  {
+    if (!isCompiledFor (msg))
+      compile (msg.fields, msg.point_step);
+
+    // Copy info fields
+    cloud.header   = msg.header;
+    cloud.width    = msg.width;
+    cloud.height   = msg.height;
+    cloud.is_dense = msg.is_dense == 1;
+
+    const std::size_t nr_points = static_cast<std::size_t> (msg.width) * msg.height;
+    cloud.points.resize (nr_points);
+    if (nr_points == 0)
+      return;
+
+    // Split every row in blocks, converted independently
+    const std::size_t width = msg.width;
+    const std::size_t point_step = msg.point_step;
+    const std::size_t row_step = msg.row_step;
+    const std::size_t block_size = block_size_;
+    const std::size_t blocks_per_row = (width + block_size - 1) / block_size;
+    const auto nr_blocks = static_cast<std::ptrdiff_t> (blocks_per_row * msg.height);
+    const std::uint8_t *msg_data = msg.data.data ();
+    std::uint8_t *cloud_data = reinterpret_cast<std::uint8_t*> (cloud.points.data ());
+
+#pragma omp parallel for \
+  default(none) \
+  firstprivate(width, point_step, row_step, block_size, blocks_per_row, nr_blocks, msg_data, cloud_data) \
+  num_threads(getNumberOfThreads (nr_points))
+    for (std::ptrdiff_t b = 0; b < nr_blocks; ++b)
+    {
+      const std::size_t row = static_cast<std::size_t> (b) / blocks_per_row;
+      const std::size_t col = (static_cast<std::size_t> (b) % blocks_per_row) * block_size;
+      const std::size_t count = std::min (block_size, width - col);
+      const std::uint8_t *src = msg_data + row * row_step + col * point_step;
+      std::uint8_t *dst = cloud_data + (row * width + col) * sizeof (PointT);
+
+      if (identity_)
+      {
+        std::memcpy (dst, src, count * sizeof (PointT));
+        continue;
+      }
+      for (const FieldCopy &field : copies_)
+        field.copy (src + field.serialized_offset, point_step, dst + field.struct_offset, sizeof (PointT),
+                    field.size, count);
+    }
+  }
+
+  template <typename PointT> void
+  PCLPointCloud2Converter<PointT>::toPCLPointCloud2 (const pcl::PointCloud<PointT> &cloud,
+                                                     pcl::PCLPointCloud2 &msg) const
+  {
+    // Ease the user's burden on specifying width/height for unorganized datasets
+    if (cloud.width == 0 && cloud.height == 0)
+    {
+      msg.width  = static_cast<std::uint32_t> (cloud.points.size ());
+      msg.height = 1;
+    }
+    else
+    {
+      assert (cloud.points.size () == cloud.width * cloud.height);
+      msg.height = cloud.height;
+      msg.width  = cloud.width;
+    }
+
+    // Fill point cloud binary data (padding and all), in blocks of points
+    const std::size_t nr_points = cloud.points.size ();
+    msg.data.resize (sizeof (PointT) * nr_points);
+    const std::uint8_t *cloud_data = reinterpret_cast<const std::uint8_t*> (cloud.points.data ());
+    std::uint8_t *msg_data = msg.data.data ();
+    const std::size_t block_size = min_points_per_thread_;
+    const auto nr_blocks = static_cast<std::ptrdiff_t> ((nr_points + block_size - 1) / block_size);
+
+#pragma omp parallel for \
+  default(none) \
+  firstprivate(nr_points, block_size, nr_blocks, cloud_data, msg_data) \
+  num_threads(getNumberOfThreads (nr_points))
+    for (std::ptrdiff_t b = 0; b < nr_blocks; ++b)
+    {
+      const std::size_t first = static_cast<std::size_t> (b) * block_size;
+      const std::size_t count = std::min (block_size, nr_points - first);
+      std::memcpy (msg_data + first * sizeof (PointT), cloud_data + first * sizeof (PointT), count * sizeof (PointT));
+    }
+
+    msg.fields     = point_fields_;
+    msg.header     = cloud.header;
+    msg.point_step = sizeof (PointT);
+    msg.row_step   = static_cast<std::uint32_t> (sizeof (PointT) * msg.width);
+    msg.is_dense   = cloud.is_dense;
+  }
+} // namespace pcl
@@ -0,0 +1,442 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/PCLHeader.h>
+#include <pcl/pcl_macros.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <vector>
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief A standard allocator returning memory aligned on \a Alignment bytes.
+      * \note Alignment has to be a power of two, at least as large as the alignment of a pointer.
+      */
+    template <typename T, std::size_t Alignment>
+    struct AlignedAllocator
+    {
+      using value_type = T;
+
+      template <typename U>
+      struct rebind
+      {
+        using other = AlignedAllocator<U, Alignment>;
+      };
+
+      AlignedAllocator () = default;
+
+      template <typename U>
+      AlignedAllocator (const AlignedAllocator<U, Alignment>&) {}
+
+      T*
+      allocate (std::size_t n)
+      {
+        if (n > (std::numeric_limits<std::size_t>::max () - Alignment) / sizeof (T))
+          throw std::bad_alloc ();
+        // Over-allocate, and store the address returned by malloc right before the aligned block
+        void *original = std::malloc (n * sizeof (T) + Alignment);
+        if (!original)
+          throw std::bad_alloc ();
+        void *aligned = reinterpret_cast<void*> ((reinterpret_cast<std::size_t> (original) + Alignment) & ~(Alignment - 1));
+        *(reinterpret_cast<void**> (aligned) - 1) = original;
+        return (static_cast<T*> (aligned));
+      }
+
+      void
+      deallocate (T *p, std::size_t)
+      {
+        if (p)
+          std::free (*(reinterpret_cast<void**> (p) - 1));
+      }
+
+      template <typename U> bool
+      operator== (const AlignedAllocator<U, Alignment>&) const { return (true); }
+
+      template <typename U> bool
+      operator!= (const AlignedAllocator<U, Alignment>&) const { return (false); }
+    };
+
+    /** \brief Non-owning view on a range of points of a PointCloudSoA.
+      * The pointers of the fields the cloud does not store are null.
+      */
+    template <typename FloatT, typename ColorT>
+    struct PointCloudSoAView
+    {
+      FloatT *x = nullptr;
+      FloatT *y = nullptr;
+      FloatT *z = nullptr;
+      FloatT *normal_x = nullptr;
+      FloatT *normal_y = nullptr;
+      FloatT *normal_z = nullptr;
+      ColorT *rgba = nullptr;
+      std::size_t size = 0;
+
+      PointCloudSoAView () = default;
+
+      /** \brief Conversion from a mutable view to a const view. */
+      template <typename OtherFloatT, typename OtherColorT>
+      PointCloudSoAView (const PointCloudSoAView<OtherFloatT, OtherColorT> &other) :
+        x (other.x), y (other.y), z (other.z),
+        normal_x (other.normal_x), normal_y (other.normal_y), normal_z (other.normal_z),
+        rgba (other.rgba), size (other.size)
+      {}
+
+      inline bool
+      hasNormals () const { return (normal_x != nullptr); }
+
+      inline bool
+      hasColors () const { return (rgba != nullptr); }
+
+      /** \brief Get a view on the points [first, first + count) of this view. */
+      inline PointCloudSoAView
+      getSubView (std::size_t first, std::size_t count) const
+      {
+        PointCloudSoAView view (*this);
+        view.x += first;
+        view.y += first;
+        view.z += first;
+        if (hasNormals ())
+        {
+          view.normal_x += first;
+          view.normal_y += first;
+          view.normal_z += first;
+        }
+        if (hasColors ())
+          view.rgba += first;
+        view.size = count;
+        return (view);
+      }
+    };
+  } // namespace detail
+
+  /** \brief Mutable view on the points of a PointCloudSoA. */
+  using PointCloudSoAView = detail::PointCloudSoAView<float, std::uint32_t>;
+
+  /** \brief Read-only view on the points of a PointCloudSoA. */
+  using PointCloudSoAConstView = detail::PointCloudSoAView<const float, const std::uint32_t>;
+
+  /** \brief PointCloudSoA stores a point cloud as a structure of arrays: each field of the points (x, y, z,
+    * and optionally the normal and the packed color) lives in its own contiguous array.
+    *
+    * Kernels which only read a few fields, such as the coordinates, then only touch the memory of these
+    * fields, and can process consecutive points with SIMD instructions. All the arrays are aligned on
+    * \a alignment bytes.
+    *
+    * Use toPointCloudSoA () and fromPointCloudSoA () to convert from and to a pcl::PointCloud, and
+    * getView () to pass a range of points to a kernel without copying them.
+    *
+    * \ingroup common
+    */
+  class PointCloudSoA
+  {
+    public:
+      /** \brief The alignment of the arrays, in bytes. */
+      static constexpr std::size_t alignment = 64;
+
+      using FloatArray = std::vector<float, detail::AlignedAllocator<float, alignment> >;
+      using ColorArray = std::vector<std::uint32_t, detail::AlignedAllocator<std::uint32_t, alignment> >;
+
+      using Ptr = shared_ptr<PointCloudSoA>;
+      using ConstPtr = shared_ptr<const PointCloudSoA>;
+
+      /** \brief Constructor.
+        * \param[in] has_normals set to true to store the normals of the points
+        * \param[in] has_colors set to true to store the packed colors of the points
+        */
+      PointCloudSoA (bool has_normals = false, bool has_colors = false) :
+        has_normals_ (has_normals), has_colors_ (has_colors)
+      {}
+
+      /** \brief The point cloud header. */
+      pcl::PCLHeader header;
+
+      /** \brief The x coordinates of the points. */
+      FloatArray x;
+      /** \brief The y coordinates of the points. */
+      FloatArray y;
+      /** \brief The z coordinates of the points. */
+      FloatArray z;
+
+      /** \brief The x coordinates of the normals, empty if the normals are not stored. */
+      FloatArray normal_x;
+      /** \brief The y coordinates of the normals, empty if the normals are not stored. */
+      FloatArray normal_y;
+      /** \brief The z coordinates of the normals, empty if the normals are not stored. */
+      FloatArray normal_z;
+
+      /** \brief The packed colors of the points, as in the rgba field of the point types, empty if the
+        * colors are not stored.
+        */
+      ColorArray rgba;
+
+      /** \brief The point cloud width (if organized as an image-structure). */
+      std::uint32_t width = 0;
+      /** \brief The point cloud height (if organized as an image-structure). */
+      std::uint32_t height = 0;
+
+      /** \brief True if no points are invalid (e.g., have NaN or Inf values in any of their floating point fields). */
+      bool is_dense = true;
+
+      /** \brief Get the number of points. */
+      inline std::size_t
+      size () const { return (x.size ()); }
+
+      inline bool
+      empty () const { return (x.empty ()); }
+
+      /** \brief Return whether the normals of the points are stored. */
+      inline bool
+      hasNormals () const { return (has_normals_); }
+
+      /** \brief Return whether the colors of the points are stored. */
+      inline bool
+      hasColors () const { return (has_colors_); }
+
+      /** \brief Start or stop storing the normals of the points. Added normals are zero. */
+      inline void
+      setHasNormals (bool has_normals)
+      {
+        has_normals_ = has_normals;
+        const std::size_t n = has_normals_ ? size () : 0;
+        normal_x.resize (n);
+        normal_y.resize (n);
+        normal_z.resize (n);
+      }
+
+      /** \brief Start or stop storing the colors of the points. Added colors are zero. */
+      inline void
+      setHasColors (bool has_colors)
+      {
+        has_colors_ = has_colors;
+        rgba.resize (has_colors_ ? size () : 0);
+      }
+
+      /** \brief Resize all the stored fields. The cloud becomes unorganized. */
+      inline void
+      resize (std::size_t n)
+      {
+        x.resize (n);
+        y.resize (n);
+        z.resize (n);
+        if (has_normals_)
+        {
+          normal_x.resize (n);
+          normal_y.resize (n);
+          normal_z.resize (n);
+        }
+        if (has_colors_)
+          rgba.resize (n);
+        width = static_cast<std::uint32_t> (n);
+        height = 1;
+      }
+
+      /** \brief Reserve memory for all the stored fields. */
+      inline void
+      reserve (std::size_t n)
+      {
+        x.reserve (n);
+        y.reserve (n);
+        z.reserve (n);
+        if (has_normals_)
+        {
+          normal_x.reserve (n);
+          normal_y.reserve (n);
+          normal_z.reserve (n);
+        }
+        if (has_colors_)
+          rgba.reserve (n);
+      }
+
+      /** \brief Remove all the points, keeping the set of stored fields. */
+      inline void
+      clear ()
+      {
+        resize (0);
+        width = 0;
+      }
+
+      /** \brief Get a mutable view on the points [first, first + count), without copying them.
+        * The range is clipped to the points of the cloud, so the view is empty if \a first is past the end.
+        */
+      inline PointCloudSoAView
+      getView (std::size_t first = 0, std::size_t count = std::numeric_limits<std::size_t>::max ())
+      {
+        first = std::min (first, size ());
+        PointCloudSoAView view;
+        view.x = x.data ();
+        view.y = y.data ();
+        view.z = z.data ();
+        if (has_normals_)
+        {
+          view.normal_x = normal_x.data ();
+          view.normal_y = normal_y.data ();
+          view.normal_z = normal_z.data ();
+        }
+        if (has_colors_)
+          view.rgba = rgba.data ();
+        view.size = size ();
+        return (view.getSubView (first, std::min (count, size () - first)));
+      }
+
+      /** \brief Get a read-only view on the points [first, first + count), without copying them.
+        * The range is clipped to the points of the cloud, so the view is empty if \a first is past the end.
+        */
+      inline PointCloudSoAConstView
+      getView (std::size_t first = 0, std::size_t count = std::numeric_limits<std::size_t>::max ()) const
+      {
+        return (const_cast<PointCloudSoA*> (this)->getView (first, count));
+      }
+
+    private:
+      bool has_normals_;
+      bool has_colors_;
+  };
+
+  namespace detail
+  {
+    template <typename PointT, traits::HasNormal<PointT> = true> inline void
+    copyNormalsToSoA (const PointT &point, PointCloudSoA &soa, std::size_t i)
+    {
+      soa.normal_x[i] = point.normal_x;
+      soa.normal_y[i] = point.normal_y;
+      soa.normal_z[i] = point.normal_z;
+    }
+
+    template <typename PointT, traits::HasNoNormal<PointT> = true> inline void
+    copyNormalsToSoA (const PointT&, PointCloudSoA&, std::size_t) {}
+
+    template <typename PointT, traits::HasColor<PointT> = true> inline void
+    copyColorToSoA (const PointT &point, PointCloudSoA &soa, std::size_t i)
+    {
+      soa.rgba[i] = point.rgba;
+    }
+
+    template <typename PointT, traits::HasNoColor<PointT> = true> inline void
+    copyColorToSoA (const PointT&, PointCloudSoA&, std::size_t) {}
+
+    template <typename PointT, traits::HasNormal<PointT> = true> inline void
+    copyNormalsFromSoA (const PointCloudSoA &soa, std::size_t i, PointT &point)
+    {
+      point.normal_x = soa.normal_x[i];
+      point.normal_y = soa.normal_y[i];
+      point.normal_z = soa.normal_z[i];
+    }
+
+    template <typename PointT, traits::HasNoNormal<PointT> = true> inline void
+    copyNormalsFromSoA (const PointCloudSoA&, std::size_t, PointT&) {}
+
+    template <typename PointT, traits::HasColor<PointT> = true> inline void
+    copyColorFromSoA (const PointCloudSoA &soa, std::size_t i, PointT &point)
+    {
+      point.rgba = soa.rgba[i];
+    }
+
+    template <typename PointT, traits::HasNoColor<PointT> = true> inline void
+    copyColorFromSoA (const PointCloudSoA&, std::size_t, PointT&) {}
+  } // namespace detail
+
+  /** \brief Convert a point cloud to structure-of-arrays layout.
+    * The normals and colors are stored if and only if \a PointT has them.
+    * \param[in] cloud the input point cloud
+    * \param[out] soa the resultant point cloud in structure-of-arrays layout
+    * \ingroup common
+    */
+  template <typename PointT> void
+  toPointCloudSoA (const pcl::PointCloud<PointT> &cloud, PointCloudSoA &soa)
+  {
+    soa.setHasNormals (traits::has_normal_v<PointT>);
+    soa.setHasColors (traits::has_color_v<PointT>);
+    soa.resize (cloud.points.size ());
+    soa.header = cloud.header;
+    soa.width = cloud.width;
+    soa.height = cloud.height;
+    soa.is_dense = cloud.is_dense;
+    for (std::size_t i = 0; i < cloud.points.size (); ++i)
+    {
+      const PointT &point = cloud.points[i];
+      soa.x[i] = point.x;
+      soa.y[i] = point.y;
+      soa.z[i] = point.z;
+      detail::copyNormalsToSoA (point, soa, i);
+      detail::copyColorToSoA (point, soa, i);
+    }
+  }
+
+  /** \brief Convert a point cloud in structure-of-arrays layout to a point cloud.
+    * The normals and colors are copied if both \a soa and \a PointT have them. The other fields of the
+    * points keep their values if \a cloud already has as many points as \a soa, and are default
+    * initialized otherwise, so that a cloud can be processed in structure-of-arrays layout and updated
+    * in place.
+    * \param[in] soa the input point cloud in structure-of-arrays layout
+    * \param[out] cloud the resultant point cloud
+    * \ingroup common
+    */
+  template <typename PointT> void
+  fromPointCloudSoA (const PointCloudSoA &soa, pcl::PointCloud<PointT> &cloud)
+  {
+    if (cloud.points.size () != soa.size ())
+    {
+      cloud.points.clear ();
+      cloud.points.resize (soa.size ());
+    }
+    cloud.header = soa.header;
+    cloud.width = soa.width;
+    cloud.height = soa.height;
+    cloud.is_dense = soa.is_dense;
+    for (std::size_t i = 0; i < soa.size (); ++i)
+    {
+      PointT &point = cloud.points[i];
+      point.x = soa.x[i];
+      point.y = soa.y[i];
+      point.z = soa.z[i];
+      if (soa.hasNormals ())
+        detail::copyNormalsFromSoA (soa, i, point);
+      if (soa.hasColors ())
+        detail::copyColorFromSoA (soa, i, point);
+    }
+  }
+}
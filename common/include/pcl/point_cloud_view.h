@@ -0,0 +1,288 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/PCLHeader.h>
+#include <pcl/PCLPointCloud2.h>
+#include <pcl/PCLPointField.h>
+#include <pcl/conversions.h>
+#include <pcl/for_each_type.h>
+#include <pcl/pcl_macros.h>
+#include <pcl/point_cloud.h>
+#include <pcl/type_traits.h>
+#include <pcl/types.h>
+
+#include <cassert>
+#include <cstdint>
+
+namespace pcl
+{
+  /** \brief PointCloudView is a read-only, non-owning typed view on the points of a cloud, e.g. on the data buffer
+    * of a PCLPointCloud2 whose field layout matches \a PointT exactly (see makePointCloudView), or on the points of
+    * a PointCloud. Building a view does not copy any point.
+    *
+    * The view can keep the PCLPointCloud2 it is built from alive by sharing its ownership. A view built from a
+    * reference or from a PointCloud is only valid as long as the viewed buffer is not modified or destroyed.
+    *
+    * \note A view cannot be passed to PCLBase::setInputCloud or to the search classes, as they hold a shared
+    * PointCloud whose points vector cannot point into another buffer. Only the code reading the view directly avoids
+    * the copy. To run such an algorithm on a view, copy it into a PointCloud with copyPointCloud, or copy only the
+    * points the algorithm needs with the indices overload, and pass that cloud to setInputCloud.
+    * \ingroup common
+    */
+  template <typename PointT>
+  class PointCloudView
+  {
+    public:
+      using PointType = PointT;
+      using const_iterator = const PointT*;
+
+      PointCloudView () = default;
+
+      /** \brief Construct a view on a PointCloud, without copying its points.
+        * \param[in] cloud the viewed cloud, which has to outlive the view
+        */
+      explicit PointCloudView (const PointCloud<PointT> &cloud) :
+        header (cloud.header), width (cloud.width), height (cloud.height), is_dense (cloud.is_dense),
+        points_ (cloud.points.data ()), size_ (cloud.points.size ())
+      {}
+
+      /** \brief Construct a view on a buffer of points.
+        * \param[in] points the first point, aligned on alignof (PointT) bytes
+        * \param[in] width the width of the cloud
+        * \param[in] height the height of the cloud
+        * \param[in] owner optional owner of the buffer, kept alive as long as the view
+        */
+      PointCloudView (const PointT *points, std::uint32_t width, std::uint32_t height,
+                      const shared_ptr<const void> &owner = nullptr) :
+        width (width), height (height), points_ (points),
+        size_ (static_cast<std::size_t> (width) * height), owner_ (owner)
+      {
+        assert (reinterpret_cast<std::uintptr_t> (points) % alignof (PointT) == 0);
+      }
+
+      /** \brief The point cloud header. */
+      PCLHeader header;
+
+      /** \brief The point cloud width (if organized as an image-structure). */
+      std::uint32_t width = 0;
+
+      /** \brief The point cloud height (if organized as an image-structure). */
+      std::uint32_t height = 0;
+
+      /** \brief True if no points are invalid (e.g., have NaN or Inf values in any of their floating point fields). */
+      bool is_dense = true;
+
+      /** \brief Get the number of points. */
+      inline std::size_t
+      size () const { return (size_); }
+
+      inline bool
+      empty () const { return (size_ == 0); }
+
+      /** \brief Return whether the cloud is organized as an image-structure. */
+      inline bool
+      isOrganized () const { return (height > 1); }
+
+      /** \brief Get a pointer to the first point. */
+      inline const PointT*
+      data () const { return (points_); }
+
+      inline const_iterator
+      begin () const { return (points_); }
+
+      inline const_iterator
+      end () const { return (points_ + size_); }
+
+      inline const PointT&
+      operator[] (std::size_t n) const { return (points_[n]); }
+
+      /** \brief Get the point at (column, row) of an organized cloud. */
+      inline const PointT&
+      at (int column, int row) const
+      {
+        if (height > 1)
+          return (points_[row * width + column]);
+        throw UnorganizedPointCloudException ("Can't use 2D indexing with an unorganized point cloud");
+      }
+
+      /** \brief Get the point at (column, row) of an organized cloud, without bound checks. */
+      inline const PointT&
+      operator () (std::size_t column, std::size_t row) const { return (points_[row * width + column]); }
+
+    private:
+      const PointT *points_ = nullptr;
+      std::size_t size_ = 0;
+      shared_ptr<const void> owner_;
+  };
+
+  namespace detail
+  {
+    // Checks that every field of PointT is in the serialized data, at the same offset.
+    template <typename PointT>
+    struct FieldLayoutMatcher
+    {
+      FieldLayoutMatcher (const std::vector<pcl::PCLPointField> &fields, bool &matches)
+        : fields_ (fields), matches_ (matches)
+      {
+        matches_ = true;
+      }
+
+      template <typename Tag> void
+      operator () ()
+      {
+        for (const auto &field : fields_)
+        {
+          if (FieldMatches<PointT, Tag> () (field) && field.offset == traits::offset<PointT, Tag>::value)
+            return;
+        }
+        matches_ = false;
+      }
+
+      const std::vector<pcl::PCLPointField> &fields_;
+      bool &matches_;
+    };
+  } // namespace detail
+
+  /** \brief Check whether the serialized points of a PCLPointCloud2 have the memory layout of \a PointT: every
+    * field of PointT at its offset in the struct, the points sizeof (PointT) bytes apart, no padding at the end of
+    * the rows, and the data aligned for PointT. Extra serialized fields in the padding of PointT are allowed.
+    * \param[in] msg the PCLPointCloud2 binary blob
+    */
+  template <typename PointT> bool
+  hasPointLayout (const pcl::PCLPointCloud2 &msg)
+  {
+    if (msg.point_step != sizeof (PointT) || msg.row_step != msg.width * msg.point_step ||
+        msg.data.size () < static_cast<std::size_t> (msg.row_step) * msg.height)
+      return (false);
+    if (!msg.data.empty () && reinterpret_cast<std::uintptr_t> (msg.data.data ()) % alignof (PointT) != 0)
+      return (false);
+
+    bool matches;
+    for_each_type<typename traits::fieldList<PointT>::type> (detail::FieldLayoutMatcher<PointT> (msg.fields, matches));
+    return (matches);
+  }
+
+  namespace detail
+  {
+    template <typename PointT> PointCloudView<PointT>
+    makePointCloudView (const pcl::PCLPointCloud2 &msg, const shared_ptr<const void> &owner)
+    {
+      PointCloudView<PointT> view (reinterpret_cast<const PointT*> (msg.data.data ()), msg.width, msg.height, owner);
+      view.header = msg.header;
+      view.is_dense = msg.is_dense == 1;
+      return (view);
+    }
+  } // namespace detail
+
+  /** \brief Build a view on the points of a PCLPointCloud2 without copying them, if its layout matches \a PointT.
+    * \param[in] msg the PCLPointCloud2 binary blob, which has to outlive the view
+    * \param[out] view the resultant view, left untouched if the layouts differ
+    * \return true if the layout of the blob matches (see hasPointLayout) and the view was built
+    */
+  template <typename PointT> bool
+  makePointCloudView (const pcl::PCLPointCloud2 &msg, PointCloudView<PointT> &view)
+  {
+    if (!hasPointLayout<PointT> (msg))
+      return (false);
+    view = detail::makePointCloudView<PointT> (msg, nullptr);
+    return (true);
+  }
+
+  /** \brief Build a view on the points of a shared PCLPointCloud2 without copying them, if its layout matches
+    * \a PointT. The view shares the ownership of the blob, so it stays valid after \a msg is released.
+    * \param[in] msg the PCLPointCloud2 binary blob
+    * \param[out] view the resultant view, left untouched if the layouts differ
+    * \return true if the layout of the blob matches (see hasPointLayout) and the view was built
+    */
+  template <typename PointT> bool
+  makePointCloudView (const pcl::PCLPointCloud2::ConstPtr &msg, PointCloudView<PointT> &view)
+  {
+    if (!msg || !hasPointLayout<PointT> (*msg))
+      return (false);
+    view = detail::makePointCloudView<PointT> (*msg, msg);
+    return (true);
+  }
+
+  /** \brief Get a view on the points of a PCLPointCloud2. The points are viewed in place if the layout of the
+    * blob matches \a PointT, else they are converted into \a storage with fromPCLPointCloud2 and \a storage is viewed.
+    * \param[in] msg the PCLPointCloud2 binary blob, which has to outlive the view
+    * \param[out] storage the cloud receiving the converted points when the layouts differ, which has to outlive the view
+    * \return the view on the points
+    */
+  template <typename PointT> PointCloudView<PointT>
+  viewPCLPointCloud2 (const pcl::PCLPointCloud2 &msg, pcl::PointCloud<PointT> &storage)
+  {
+    PointCloudView<PointT> view;
+    if (makePointCloudView (msg, view))
+      return (view);
+    fromPCLPointCloud2 (msg, storage);
+    return (PointCloudView<PointT> (storage));
+  }
+
+  /** \brief Copy the points of a view into a PointCloud.
+    * \param[in] view the input view
+    * \param[out] cloud the resultant cloud
+    */
+  template <typename PointT> void
+  copyPointCloud (const PointCloudView<PointT> &view, pcl::PointCloud<PointT> &cloud)
+  {
+    cloud.header   = view.header;
+    cloud.width    = view.width;
+    cloud.height   = view.height;
+    cloud.is_dense = view.is_dense;
+    cloud.points.assign (view.begin (), view.end ());
+  }
+
+  /** \brief Copy a subset of the points of a view into an unorganized PointCloud, only the selected points are read.
+    * \param[in] view the input view
+    * \param[in] indices the indices of the points to copy
+    * \param[out] cloud the resultant cloud
+    */
+  template <typename PointT> void
+  copyPointCloud (const PointCloudView<PointT> &view, const Indices &indices, pcl::PointCloud<PointT> &cloud)
+  {
+    cloud.header   = view.header;
+    cloud.is_dense = view.is_dense;
+    cloud.points.resize (indices.size ());
+    for (std::size_t i = 0; i < indices.size (); ++i)
+      cloud.points[i] = view[indices[i]];
+    cloud.width    = static_cast<std::uint32_t> (indices.size ());
+    cloud.height   = 1;
+  }
+}
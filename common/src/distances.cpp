@@ -36,6 +36,46 @@
  */
 #include <pcl/common/distances.h>
 
+#if defined(__SSE2__)
+#include <xmmintrin.h>
+#endif
+
+// The AVX kernel is compiled for its instruction set regardless of the build flags,
+// and selected at runtime according to the CPU
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PCL_DISTANCES_DISPATCH 1
+// This file is built with -ffp-contract=off, so that all the kernels compute the same distances
+#define PCL_DISTANCES_TARGET(isa) __attribute__ ((target (isa)))
+#include <immintrin.h>
+#endif
+
+namespace
+{
+#ifdef PCL_DISTANCES_DISPATCH
+  /** \brief Compute the squared distances of the points of a view by blocks of 8.
+    * \return the number of points processed, a multiple of 8
+    */
+  PCL_DISTANCES_TARGET ("avx") std::size_t
+  squaredEuclideanDistancesAVX (const pcl::PointCloudSoAConstView &cloud, const Eigen::Vector3f &point,
+                                float *sqr_distances)
+  {
+    const __m256 px8 = _mm256_set1_ps (point[0]);
+    const __m256 py8 = _mm256_set1_ps (point[1]);
+    const __m256 pz8 = _mm256_set1_ps (point[2]);
+    std::size_t i = 0;
+    for (; i + 8 <= cloud.size; i += 8)
+    {
+      const __m256 dx = _mm256_sub_ps (_mm256_loadu_ps (cloud.x + i), px8);
+      const __m256 dy = _mm256_sub_ps (_mm256_loadu_ps (cloud.y + i), py8);
+      const __m256 dz = _mm256_sub_ps (_mm256_loadu_ps (cloud.z + i), pz8);
+      _mm256_storeu_ps (sqr_distances + i, _mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (dx, dx), _mm256_mul_ps (dy, dy)),
+                                                          _mm256_mul_ps (dz, dz)));
+    }
+    return (i);
+  }
+#endif
+}
+
 void
 pcl::lineToLineSegment (const Eigen::VectorXf &line_a, const Eigen::VectorXf &line_b, 
                         Eigen::Vector4f &pt1_seg, Eigen::Vector4f &pt2_seg)
@@ -89,3 +129,35 @@ pcl::lineToLineSegment (const Eigen::VectorXf &line_a, const Eigen::VectorXf &li
   pt2_seg = q1 + tc * v;
 }
 
+
+void
+pcl::squaredEuclideanDistances (const PointCloudSoAConstView &cloud, const Eigen::Vector3f &point,
+                                float *sqr_distances)
+{
+  std::size_t i = 0;
+#ifdef PCL_DISTANCES_DISPATCH
+  static const bool has_avx = __builtin_cpu_supports ("avx");
+  if (has_avx)
+    i = squaredEuclideanDistancesAVX (cloud, point, sqr_distances);
+#endif
+#if defined(__SSE2__)
+  const __m128 px4 = _mm_set1_ps (point[0]);
+  const __m128 py4 = _mm_set1_ps (point[1]);
+  const __m128 pz4 = _mm_set1_ps (point[2]);
+  for (; i + 4 <= cloud.size; i += 4)
+  {
+    const __m128 dx = _mm_sub_ps (_mm_loadu_ps (cloud.x + i), px4);
+    const __m128 dy = _mm_sub_ps (_mm_loadu_ps (cloud.y + i), py4);
+    const __m128 dz = _mm_sub_ps (_mm_loadu_ps (cloud.z + i), pz4);
+    _mm_storeu_ps (sqr_distances + i, _mm_add_ps (_mm_add_ps (_mm_mul_ps (dx, dx), _mm_mul_ps (dy, dy)),
+                                                  _mm_mul_ps (dz, dz)));
+  }
+#endif
+  for (; i < cloud.size; ++i)
+  {
+    const float dx = cloud.x[i] - point[0];
+    const float dy = cloud.y[i] - point[1];
+    const float dz = cloud.z[i] - point[2];
+    sqr_distances[i] = (dx * dx + dy * dy) + dz * dz;
+  }
+}
@@ -0,0 +1,529 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/common/transforms.h>
+#include <pcl/console/print.h>
+
+#if defined(__SSE2__)
+#include <xmmintrin.h>
+#endif
+
+// The wider kernels are compiled for their instruction set regardless of the build flags,
+// and selected at runtime according to the CPU
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PCL_TRANSFORMS_DISPATCH 1
+// This file is built with -ffp-contract=off, so that the results match those of the SSE2 Transformer
+#define PCL_TRANSFORMS_TARGET(isa) __attribute__ ((target (isa)))
+#include <immintrin.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace
+{
+  /** \brief Get the widest kernel instruction set supported by the CPU. Each wider kernel is faster than the
+    * narrower ones in TransformPointsKernelsBenchmark, including on non-dense clouds.
+    */
+  pcl::detail::TransformKernel
+  getBestTransformKernel ()
+  {
+    static const pcl::detail::TransformKernel best_kernel =
+      pcl::detail::isTransformKernelSupported (pcl::detail::TransformKernel::AVX512) ? pcl::detail::TransformKernel::AVX512 :
+      pcl::detail::isTransformKernelSupported (pcl::detail::TransformKernel::AVX) ? pcl::detail::TransformKernel::AVX :
+      pcl::detail::TransformKernel::DEFAULT;
+    return (best_kernel);
+  }
+
+  /** \brief The arguments of the kernels computing out = m * in + t for arrays of 3D vectors stored as
+    * x, y, z arrays. All three input coordinates of a point are loaded before its output is stored, so
+    * the output arrays can be the input arrays.
+    */
+  struct CoordinatesTransform
+  {
+    const float *x_in, *y_in, *z_in;
+    float *x_out, *y_out, *z_out;
+    const Eigen::Matrix3f *m;
+    const Eigen::Vector3f *t;
+  };
+
+  using CoordinatesTransformKernel = void (*) (const CoordinatesTransform &args, std::size_t begin, std::size_t end);
+
+  /** \brief Transform the vectors [begin, end), four at a time with SSE2 if enabled at build time. */
+  void
+  transformCoordinatesDefault (const CoordinatesTransform &args, std::size_t begin, std::size_t end)
+  {
+    const Eigen::Matrix3f &m = *args.m;
+    const Eigen::Vector3f &t = *args.t;
+    std::size_t i = begin;
+#if defined(__SSE2__)
+    const __m128 m4[3][3] = {{_mm_set1_ps (m (0, 0)), _mm_set1_ps (m (0, 1)), _mm_set1_ps (m (0, 2))},
+                             {_mm_set1_ps (m (1, 0)), _mm_set1_ps (m (1, 1)), _mm_set1_ps (m (1, 2))},
+                             {_mm_set1_ps (m (2, 0)), _mm_set1_ps (m (2, 1)), _mm_set1_ps (m (2, 2))}};
+    const __m128 t4[3] = {_mm_set1_ps (t[0]), _mm_set1_ps (t[1]), _mm_set1_ps (t[2])};
+    for (; i + 4 <= end; i += 4)
+    {
+      const __m128 x = _mm_loadu_ps (args.x_in + i);
+      const __m128 y = _mm_loadu_ps (args.y_in + i);
+      const __m128 z = _mm_loadu_ps (args.z_in + i);
+      __m128 r[3];
+      for (int row = 0; row < 3; ++row)
+        r[row] = _mm_add_ps (_mm_add_ps (_mm_mul_ps (m4[row][0], x), _mm_mul_ps (m4[row][1], y)),
+                             _mm_add_ps (_mm_mul_ps (m4[row][2], z), t4[row]));
+      _mm_storeu_ps (args.x_out + i, r[0]);
+      _mm_storeu_ps (args.y_out + i, r[1]);
+      _mm_storeu_ps (args.z_out + i, r[2]);
+    }
+#endif
+    for (; i < end; ++i)
+    {
+      const float x = args.x_in[i], y = args.y_in[i], z = args.z_in[i];
+      args.x_out[i] = (m (0, 0) * x + m (0, 1) * y) + (m (0, 2) * z + t[0]);
+      args.y_out[i] = (m (1, 0) * x + m (1, 1) * y) + (m (1, 2) * z + t[1]);
+      args.z_out[i] = (m (2, 0) * x + m (2, 1) * y) + (m (2, 2) * z + t[2]);
+    }
+  }
+
+#ifdef PCL_TRANSFORMS_DISPATCH
+  /** \brief Transform the vectors [begin, end) eight at a time with AVX. */
+  PCL_TRANSFORMS_TARGET ("avx") void
+  transformCoordinatesAVX (const CoordinatesTransform &args, std::size_t begin, std::size_t end)
+  {
+    const Eigen::Matrix3f &m = *args.m;
+    const Eigen::Vector3f &t = *args.t;
+    const __m256 m8[3][3] = {{_mm256_set1_ps (m (0, 0)), _mm256_set1_ps (m (0, 1)), _mm256_set1_ps (m (0, 2))},
+                             {_mm256_set1_ps (m (1, 0)), _mm256_set1_ps (m (1, 1)), _mm256_set1_ps (m (1, 2))},
+                             {_mm256_set1_ps (m (2, 0)), _mm256_set1_ps (m (2, 1)), _mm256_set1_ps (m (2, 2))}};
+    const __m256 t8[3] = {_mm256_set1_ps (t[0]), _mm256_set1_ps (t[1]), _mm256_set1_ps (t[2])};
+    std::size_t i = begin;
+    for (; i + 8 <= end; i += 8)
+    {
+      const __m256 x = _mm256_loadu_ps (args.x_in + i);
+      const __m256 y = _mm256_loadu_ps (args.y_in + i);
+      const __m256 z = _mm256_loadu_ps (args.z_in + i);
+      __m256 r[3];
+      for (int row = 0; row < 3; ++row)
+        r[row] = _mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (m8[row][0], x), _mm256_mul_ps (m8[row][1], y)),
+                                _mm256_add_ps (_mm256_mul_ps (m8[row][2], z), t8[row]));
+      _mm256_storeu_ps (args.x_out + i, r[0]);
+      _mm256_storeu_ps (args.y_out + i, r[1]);
+      _mm256_storeu_ps (args.z_out + i, r[2]);
+    }
+    transformCoordinatesDefault (args, i, end);
+  }
+
+  /** \brief Transform the vectors [begin, end) sixteen at a time with AVX-512. */
+  PCL_TRANSFORMS_TARGET ("avx512f") void
+  transformCoordinatesAVX512 (const CoordinatesTransform &args, std::size_t begin, std::size_t end)
+  {
+    const Eigen::Matrix3f &m = *args.m;
+    const Eigen::Vector3f &t = *args.t;
+    const __m512 m16[3][3] = {{_mm512_set1_ps (m (0, 0)), _mm512_set1_ps (m (0, 1)), _mm512_set1_ps (m (0, 2))},
+                              {_mm512_set1_ps (m (1, 0)), _mm512_set1_ps (m (1, 1)), _mm512_set1_ps (m (1, 2))},
+                              {_mm512_set1_ps (m (2, 0)), _mm512_set1_ps (m (2, 1)), _mm512_set1_ps (m (2, 2))}};
+    const __m512 t16[3] = {_mm512_set1_ps (t[0]), _mm512_set1_ps (t[1]), _mm512_set1_ps (t[2])};
+    std::size_t i = begin;
+    for (; i + 16 <= end; i += 16)
+    {
+      const __m512 x = _mm512_loadu_ps (args.x_in + i);
+      const __m512 y = _mm512_loadu_ps (args.y_in + i);
+      const __m512 z = _mm512_loadu_ps (args.z_in + i);
+      __m512 r[3];
+      for (int row = 0; row < 3; ++row)
+        r[row] = _mm512_add_ps (_mm512_add_ps (_mm512_mul_ps (m16[row][0], x), _mm512_mul_ps (m16[row][1], y)),
+                                _mm512_add_ps (_mm512_mul_ps (m16[row][2], z), t16[row]));
+      _mm512_storeu_ps (args.x_out + i, r[0]);
+      _mm512_storeu_ps (args.y_out + i, r[1]);
+      _mm512_storeu_ps (args.z_out + i, r[2]);
+    }
+    transformCoordinatesDefault (args, i, end);
+  }
+#endif // PCL_TRANSFORMS_DISPATCH
+
+  /** \brief Compute out = m * in + t for arrays of 3D vectors stored as x, y, z arrays, with the widest
+    * kernel supported by the CPU. The output arrays can be the input arrays.
+    */
+  void
+  transformCoordinates (const float *x_in, const float *y_in, const float *z_in,
+                        float *x_out, float *y_out, float *z_out, std::size_t size,
+                        const Eigen::Matrix3f &m, const Eigen::Vector3f &t)
+  {
+    const CoordinatesTransform args = {x_in, y_in, z_in, x_out, y_out, z_out, &m, &t};
+#ifdef PCL_TRANSFORMS_DISPATCH
+    switch (getBestTransformKernel ())
+    {
+      case pcl::detail::TransformKernel::AVX512:
+        transformCoordinatesAVX512 (args, 0, size);
+        return;
+      case pcl::detail::TransformKernel::AVX:
+        transformCoordinatesAVX (args, 0, size);
+        return;
+      default:
+        break;
+    }
+#endif
+    transformCoordinatesDefault (args, 0, size);
+  }
+
+  /** \brief Copy the header and organization of a cloud, and resize the output cloud. */
+  void
+  prepareOutput (const pcl::PointCloudSoA &cloud_in, pcl::PointCloudSoA &cloud_out,
+                 bool has_normals, bool copy_colors)
+  {
+    cloud_out.setHasNormals (has_normals);
+    cloud_out.setHasColors (copy_colors);
+    cloud_out.resize (cloud_in.size ());
+    if (copy_colors)
+      cloud_out.rgba = cloud_in.rgba;
+    cloud_out.header = cloud_in.header;
+    cloud_out.width = cloud_in.width;
+    cloud_out.height = cloud_in.height;
+    cloud_out.is_dense = cloud_in.is_dense;
+  }
+}
+
+void
+pcl::transformPointCloud (const pcl::PointCloudSoA &cloud_in,
+                          pcl::PointCloudSoA &cloud_out,
+                          const Eigen::Affine3f &transform,
+                          bool copy_all_fields)
+{
+  if (&cloud_in != &cloud_out)
+  {
+    const bool copy_normals = copy_all_fields && cloud_in.hasNormals ();
+    prepareOutput (cloud_in, cloud_out, copy_normals, copy_all_fields && cloud_in.hasColors ());
+    if (copy_normals)
+    {
+      cloud_out.normal_x = cloud_in.normal_x;
+      cloud_out.normal_y = cloud_in.normal_y;
+      cloud_out.normal_z = cloud_in.normal_z;
+    }
+  }
+
+  transformCoordinates (cloud_in.x.data (), cloud_in.y.data (), cloud_in.z.data (),
+                        cloud_out.x.data (), cloud_out.y.data (), cloud_out.z.data (), cloud_in.size (),
+                        transform.linear (), transform.translation ());
+}
+
+void
+pcl::transformPointCloudWithNormals (const pcl::PointCloudSoA &cloud_in,
+                                     pcl::PointCloudSoA &cloud_out,
+                                     const Eigen::Affine3f &transform,
+                                     bool copy_all_fields)
+{
+  if (!cloud_in.hasNormals ())
+  {
+    PCL_ERROR ("[pcl::transformPointCloudWithNormals] The input cloud does not store normals!\n");
+    return;
+  }
+
+  if (&cloud_in != &cloud_out)
+    prepareOutput (cloud_in, cloud_out, true, copy_all_fields && cloud_in.hasColors ());
+
+  transformCoordinates (cloud_in.x.data (), cloud_in.y.data (), cloud_in.z.data (),
+                        cloud_out.x.data (), cloud_out.y.data (), cloud_out.z.data (), cloud_in.size (),
+                        transform.linear (), transform.translation ());
+  // The normals are only rotated
+  transformCoordinates (cloud_in.normal_x.data (), cloud_in.normal_y.data (), cloud_in.normal_z.data (),
+                        cloud_out.normal_x.data (), cloud_out.normal_y.data (), cloud_out.normal_z.data (),
+                        cloud_in.size (), transform.linear (), Eigen::Vector3f::Zero ());
+}
+
+namespace
+{
+  /** \brief The arguments of the kernels transforming arrays of points. */
+  struct PointsTransform
+  {
+    const std::uint8_t *src;
+    std::uint8_t *tgt;
+    std::size_t stride;
+    std::ptrdiff_t normal_offset;
+    const Eigen::Matrix4f *transform;
+    bool check_finite;
+
+    inline const float*
+    srcPoint (std::size_t i) const { return (reinterpret_cast<const float*> (src + i * stride)); }
+
+    inline float*
+    tgtPoint (std::size_t i) const { return (reinterpret_cast<float*> (tgt + i * stride)); }
+
+    inline const float*
+    srcNormal (std::size_t i) const { return (reinterpret_cast<const float*> (src + i * stride + normal_offset)); }
+
+    inline float*
+    tgtNormal (std::size_t i) const { return (reinterpret_cast<float*> (tgt + i * stride + normal_offset)); }
+
+    inline bool
+    isFinite (std::size_t i) const
+    {
+      const float *p = srcPoint (i);
+      return (std::isfinite (p[0]) && std::isfinite (p[1]) && std::isfinite (p[2]));
+    }
+  };
+
+  using PointsTransformKernel = void (*) (const PointsTransform &args, std::size_t begin, std::size_t end);
+
+  /** \brief Transform the points [begin, end) one at a time, with SSE2 if enabled at build time. */
+  void
+  transformPointsDefault (const PointsTransform &args, std::size_t begin, std::size_t end)
+  {
+    const pcl::detail::Transformer<float> tf (*args.transform);
+    for (std::size_t i = begin; i < end; ++i)
+    {
+      if (args.check_finite && !args.isFinite (i))
+        continue;
+      tf.se3 (args.srcPoint (i), args.tgtPoint (i));
+      if (args.normal_offset >= 0)
+        tf.so3 (args.srcNormal (i), args.tgtNormal (i));
+    }
+  }
+
+#ifdef PCL_TRANSFORMS_DISPATCH
+  /** \brief Load the float vectors of 2 points, one per lane. */
+  PCL_TRANSFORMS_TARGET ("avx") inline __m256
+  loadAVX (const float *a, const float *b)
+  {
+    return (_mm256_insertf128_ps (_mm256_castps128_ps256 (_mm_loadu_ps (a)), _mm_loadu_ps (b), 1));
+  }
+
+  /** \brief Transform the float vectors of 2 points as se3 or so3, with the transform columns in both lanes of \a c. */
+  PCL_TRANSFORMS_TARGET ("avx") inline __m256
+  transformAVX (const __m256 *c, __m256 v, bool affine)
+  {
+    const __m256 p0 = _mm256_mul_ps (_mm256_permute_ps (v, 0x00), c[0]);
+    const __m256 p1 = _mm256_mul_ps (_mm256_permute_ps (v, 0x55), c[1]);
+    const __m256 p2 = _mm256_mul_ps (_mm256_permute_ps (v, 0xAA), c[2]);
+    return (affine ? _mm256_add_ps (p0, _mm256_add_ps (p1, _mm256_add_ps (p2, c[3])))
+                   : _mm256_add_ps (p0, _mm256_add_ps (p1, p2)));
+  }
+
+  /** \brief Get a mask with the bit j set if the x, y and z coordinates of the point in lane j are finite. */
+  PCL_TRANSFORMS_TARGET ("avx") inline int
+  finiteMaskAVX (__m256 v)
+  {
+    // v - v is 0 for finite values, and NaN for infinite and NaN values
+    const int mask = _mm256_movemask_ps (_mm256_cmp_ps (_mm256_sub_ps (v, v), _mm256_setzero_ps (), _CMP_EQ_OQ));
+    return (static_cast<int> ((mask & 0x07) == 0x07) | (static_cast<int> ((mask & 0x70) == 0x70) << 1));
+  }
+
+  /** \brief Store the transformed float vectors of the points whose bit is set in \a mask. */
+  PCL_TRANSFORMS_TARGET ("avx") inline void
+  storeAVX (float *a, float *b, __m256 r, int mask)
+  {
+    if (mask & 1)
+      _mm_storeu_ps (a, _mm256_castps256_ps128 (r));
+    if (mask & 2)
+      _mm_storeu_ps (b, _mm256_extractf128_ps (r, 1));
+  }
+
+  /** \brief Transform the points [begin, end) two at a time with AVX. The operations are the same as
+    * those of the SSE2 Transformer, so the results are identical.
+    */
+  PCL_TRANSFORMS_TARGET ("avx") void
+  transformPointsAVX (const PointsTransform &args, std::size_t begin, std::size_t end)
+  {
+    __m256 c[4];
+    for (int j = 0; j < 4; ++j)
+    {
+      const __m128 col = _mm_loadu_ps (args.transform->col (j).data ());
+      c[j] = _mm256_insertf128_ps (_mm256_castps128_ps256 (col), col, 1);
+    }
+
+    // The finite mask is taken from the points before any store, as they may be transformed in place
+    std::size_t i = begin;
+    for (; i + 2 <= end; i += 2)
+    {
+      const __m256 points = loadAVX (args.srcPoint (i), args.srcPoint (i + 1));
+      const int mask = args.check_finite ? finiteMaskAVX (points) : 0x3;
+      if (args.normal_offset >= 0)
+        storeAVX (args.tgtNormal (i), args.tgtNormal (i + 1),
+                  transformAVX (c, loadAVX (args.srcNormal (i), args.srcNormal (i + 1)), false), mask);
+      storeAVX (args.tgtPoint (i), args.tgtPoint (i + 1), transformAVX (c, points, true), mask);
+    }
+    transformPointsDefault (args, i, end);
+  }
+
+  // The AVX-512 kernel uses the zero-masking forms of the intrinsics with a full mask. They compile to the
+  // same instructions as the unmasked forms, whose undefined pass-through operand GCC warns about.
+
+  /** \brief Load the float vectors of 4 points, one per 128 bit lane. */
+  PCL_TRANSFORMS_TARGET ("avx512f") inline __m512
+  loadAVX512 (const float *a, const float *b, const float *d, const float *e)
+  {
+    __m512 v = _mm512_insertf32x4 (_mm512_setzero_ps (), _mm_loadu_ps (a), 0);
+    v = _mm512_insertf32x4 (v, _mm_loadu_ps (b), 1);
+    v = _mm512_insertf32x4 (v, _mm_loadu_ps (d), 2);
+    return (_mm512_insertf32x4 (v, _mm_loadu_ps (e), 3));
+  }
+
+  /** \brief Transform the float vectors of 4 points as se3 or so3, with the transform columns in all lanes of \a c. */
+  PCL_TRANSFORMS_TARGET ("avx512f") inline __m512
+  transformAVX512 (const __m512 *c, __m512 v, bool affine)
+  {
+    const __m512 p0 = _mm512_mul_ps (_mm512_maskz_permute_ps (0xFFFF, v, 0x00), c[0]);
+    const __m512 p1 = _mm512_mul_ps (_mm512_maskz_permute_ps (0xFFFF, v, 0x55), c[1]);
+    const __m512 p2 = _mm512_mul_ps (_mm512_maskz_permute_ps (0xFFFF, v, 0xAA), c[2]);
+    return (affine ? _mm512_add_ps (p0, _mm512_add_ps (p1, _mm512_add_ps (p2, c[3])))
+                   : _mm512_add_ps (p0, _mm512_add_ps (p1, p2)));
+  }
+
+  /** \brief Get a mask with the bit j set if the x, y and z coordinates of the point in lane j are finite. */
+  PCL_TRANSFORMS_TARGET ("avx512f") inline int
+  finiteMaskAVX512 (__m512 v)
+  {
+    // v - v is 0 for finite values, and NaN for infinite and NaN values
+    const int mask = _mm512_cmp_ps_mask (_mm512_sub_ps (v, v), _mm512_setzero_ps (), _CMP_EQ_OQ);
+    int finite = 0;
+    for (int j = 0; j < 4; ++j)
+      finite |= static_cast<int> (((mask >> (4 * j)) & 0x7) == 0x7) << j;
+    return (finite);
+  }
+
+  /** \brief Store the transformed float vectors of the points whose bit is set in \a mask. */
+  PCL_TRANSFORMS_TARGET ("avx512f") inline void
+  storeAVX512 (float *a, float *b, float *d, float *e, __m512 r, int mask)
+  {
+    if (mask & 1)
+      _mm_storeu_ps (a, _mm512_maskz_extractf32x4_ps (0xFF, r, 0));
+    if (mask & 2)
+      _mm_storeu_ps (b, _mm512_maskz_extractf32x4_ps (0xFF, r, 1));
+    if (mask & 4)
+      _mm_storeu_ps (d, _mm512_maskz_extractf32x4_ps (0xFF, r, 2));
+    if (mask & 8)
+      _mm_storeu_ps (e, _mm512_maskz_extractf32x4_ps (0xFF, r, 3));
+  }
+
+  /** \brief Transform the points [begin, end) four at a time with AVX-512. The operations are the same as
+    * those of the SSE2 Transformer, so the results are identical.
+    */
+  PCL_TRANSFORMS_TARGET ("avx512f") void
+  transformPointsAVX512 (const PointsTransform &args, std::size_t begin, std::size_t end)
+  {
+    __m512 c[4];
+    for (int j = 0; j < 4; ++j)
+      c[j] = _mm512_maskz_broadcast_f32x4 (0xFFFF, _mm_loadu_ps (args.transform->col (j).data ()));
+
+    // The finite mask is taken from the points before any store, as they may be transformed in place
+    std::size_t i = begin;
+    for (; i + 4 <= end; i += 4)
+    {
+      const __m512 points = loadAVX512 (args.srcPoint (i), args.srcPoint (i + 1), args.srcPoint (i + 2), args.srcPoint (i + 3));
+      const int mask = args.check_finite ? finiteMaskAVX512 (points) : 0xF;
+      if (args.normal_offset >= 0)
+        storeAVX512 (args.tgtNormal (i), args.tgtNormal (i + 1), args.tgtNormal (i + 2), args.tgtNormal (i + 3),
+                     transformAVX512 (c, loadAVX512 (args.srcNormal (i), args.srcNormal (i + 1), args.srcNormal (i + 2), args.srcNormal (i + 3)), false),
+                     mask);
+      storeAVX512 (args.tgtPoint (i), args.tgtPoint (i + 1), args.tgtPoint (i + 2), args.tgtPoint (i + 3),
+                   transformAVX512 (c, points, true), mask);
+    }
+    transformPointsDefault (args, i, end);
+  }
+#endif // PCL_TRANSFORMS_DISPATCH
+
+  /** \brief Get the kernel of a given instruction set, or of the widest supported one. */
+  PointsTransformKernel
+  getPointsTransformKernel (pcl::detail::TransformKernel kernel)
+  {
+    if (kernel == pcl::detail::TransformKernel::AUTO)
+      kernel = getBestTransformKernel ();
+#ifdef PCL_TRANSFORMS_DISPATCH
+    if (kernel == pcl::detail::TransformKernel::AVX512 && pcl::detail::isTransformKernelSupported (kernel))
+      return (transformPointsAVX512);
+    if (kernel == pcl::detail::TransformKernel::AVX && pcl::detail::isTransformKernelSupported (kernel))
+      return (transformPointsAVX);
+#endif
+    return (transformPointsDefault);
+  }
+}
+
+bool
+pcl::detail::isTransformKernelSupported (TransformKernel kernel)
+{
+  switch (kernel)
+  {
+#ifdef PCL_TRANSFORMS_DISPATCH
+    case TransformKernel::AVX:
+      return (__builtin_cpu_supports ("avx"));
+    case TransformKernel::AVX512:
+      return (__builtin_cpu_supports ("avx512f"));
+#else
+    case TransformKernel::AVX:
+    case TransformKernel::AVX512:
+      return (false);
+#endif
+    default:
+      return (true);
+  }
+}
+
+void
+pcl::detail::transformPoints (const float *src, float *tgt, std::size_t nr_points, std::size_t stride,
+                              std::ptrdiff_t normal_offset, const Eigen::Matrix4f &transform,
+                              bool check_finite, unsigned int nr_threads, TransformKernel kernel)
+{
+  PointsTransform args;
+  args.src = reinterpret_cast<const std::uint8_t*> (src);
+  args.tgt = reinterpret_cast<std::uint8_t*> (tgt);
+  args.stride = stride;
+  args.normal_offset = normal_offset;
+  args.transform = &transform;
+  args.check_finite = check_finite;
+  const PointsTransformKernel transform_points = getPointsTransformKernel (kernel);
+
+#ifdef _OPENMP
+  if (nr_threads == 0)
+    nr_threads = omp_get_num_procs ();
+#endif
+  // Small clouds are not worth waking up threads
+  constexpr std::size_t min_points_per_thread = 16384;
+  const auto nr_chunks = static_cast<std::ptrdiff_t> (
+      std::max<std::size_t> (1, std::min<std::size_t> (nr_threads, nr_points / min_points_per_thread)));
+  if (nr_chunks == 1)
+  {
+    transform_points (args, 0, nr_points);
+    return;
+  }
+
+#pragma omp parallel for \
+  default(none) \
+  shared(args, nr_points) \
+  firstprivate(nr_chunks, transform_points) \
+  num_threads(nr_chunks)
+  for (std::ptrdiff_t chunk = 0; chunk < nr_chunks; ++chunk)
+    transform_points (args, nr_points * chunk / nr_chunks, nr_points * (chunk + 1) / nr_chunks);
+}
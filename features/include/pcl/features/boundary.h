@@ -42,6 +42,7 @@
 
 #include <pcl/features/eigen.h>
 #include <pcl/features/feature.h>
+#include <pcl/features/neighborhood_pca.h>
 
 namespace pcl
 {
@@ -176,6 +177,13 @@ namespace pcl
 
       /** \brief The decision boundary (angle threshold) that marks points as boundary or regular. (default \f$\pi / 2.0\f$) */
       float angle_threshold_;
+
+    private:
+      /** \brief The neighbors of the query point, relative to it. */
+      detail::NeighborhoodCoordinates deltas_;
+
+      /** \brief The angles of the neighbors of the query point in the u-v plane. */
+      std::vector<float> angles_;
   };
 }
 
@@ -49,6 +49,7 @@
 #include <pcl/pcl_base.h>
 #include <pcl/pcl_macros.h>
 #include <pcl/search/search.h>
+#include <pcl/features/precomputed_neighborhoods.h>
 
 #include <functional>
 
@@ -125,11 +126,14 @@ namespace pcl
 
       using SearchMethod = std::function<int (std::size_t, double, std::vector<int> &, std::vector<float> &)>;
       using SearchMethodSurface = std::function<int (const PointCloudIn &cloud, std::size_t index, double, std::vector<int> &, std::vector<float> &)>;
+      using SearchMethodSurfaceBuffer = std::function<int (const PointCloudIn &cloud, std::size_t index, double, search::NeighborBuffer &)>;
+
+      using NeighborhoodsConstPtr = typename PrecomputedNeighborhoods<PointInT>::ConstPtr;
 
     public:
       /** \brief Empty constructor. */
       Feature () :
-        feature_name_ (), search_method_surface_ (),
+        feature_name_ (), search_method_surface_ (), search_method_surface_buffer_ (),
         surface_(), tree_(),
         search_parameter_(0), search_radius_(0), k_(0),
         fake_surface_(false)
@@ -173,6 +177,21 @@ namespace pcl
         return (tree_);
       }
 
+      /** \brief Provide neighbors searched beforehand, to be used instead of the search method for the points
+        * they cover. They have to be computed for the same input cloud, search surface and search parameter (k or
+        * radius) as this estimator, and can be shared by several estimators.
+        * \param[in] neighborhoods a pointer to the precomputed neighbors, or null to always use the search method
+        */
+      inline void
+      setSearchNeighborhoods (const NeighborhoodsConstPtr &neighborhoods) { neighborhoods_ = neighborhoods; }
+
+      /** \brief Get a pointer to the precomputed neighbors used. */
+      inline NeighborhoodsConstPtr
+      getSearchNeighborhoods () const
+      {
+        return (neighborhoods_);
+      }
+
       /** \brief Get the internal search parameter. */
       inline double
       getSearchParameter () const
@@ -225,6 +244,9 @@ namespace pcl
       /** \brief The search method template for points. */
       SearchMethodSurface search_method_surface_;
 
+      /** \brief The search method template for points, writing into a reusable buffer. */
+      SearchMethodSurfaceBuffer search_method_surface_buffer_;
+
       /** \brief An input point cloud describing the surface that is to be used
         * for nearest neighbors estimation.
         */
@@ -233,6 +255,9 @@ namespace pcl
       /** \brief A pointer to the spatial search object. */
       KdTreePtr tree_;
 
+      /** \brief The neighbors searched beforehand, if any. */
+      NeighborhoodsConstPtr neighborhoods_;
+
       /** \brief The actual search parameter (from either \a search_radius_ or \a k_). */
       double search_parameter_;
 
@@ -271,7 +296,7 @@ namespace pcl
       searchForNeighbors (std::size_t index, double parameter,
                           std::vector<int> &indices, std::vector<float> &distances) const
       {
-        return (search_method_surface_ (*input_, index, parameter, indices, distances));
+        return (searchForNeighbors (*input_, index, parameter, indices, distances));
       }
 
       /** \brief Search for k-nearest neighbors using the spatial locator from
@@ -289,9 +314,57 @@ namespace pcl
       searchForNeighbors (const PointCloudIn &cloud, std::size_t index, double parameter,
                           std::vector<int> &indices, std::vector<float> &distances) const
       {
+        if (hasPrecomputedNeighbors (cloud, index, parameter))
+          return (neighborhoods_->getNeighbors (index, indices, distances));
         return (search_method_surface_ (cloud, index, parameter, indices, distances));
       }
 
+      /** \brief Search for k-nearest neighbors using the spatial locator from
+        * \a setSearchmethod, and the given surface from \a setSearchSurface, writing the
+        * results into a reusable buffer.
+        * \param[in] index the index of the query point
+        * \param[in] parameter the search parameter (either k or radius)
+        * \param[out] neighbors the buffer receiving the indices and squared distances of the neighbors
+        *
+        * \return the number of neighbors found. If no neighbors are found or an error occurred, return 0.
+        */
+      inline int
+      searchForNeighbors (std::size_t index, double parameter, search::NeighborBuffer &neighbors) const
+      {
+        return (searchForNeighbors (*input_, index, parameter, neighbors));
+      }
+
+      /** \brief Search for k-nearest neighbors using the spatial locator from
+        * \a setSearchmethod, and the given surface from \a setSearchSurface, writing the
+        * results into a reusable buffer.
+        * \param[in] cloud the query point cloud
+        * \param[in] index the index of the query point in \a cloud
+        * \param[in] parameter the search parameter (either k or radius)
+        * \param[out] neighbors the buffer receiving the indices and squared distances of the neighbors
+        *
+        * \return the number of neighbors found. If no neighbors are found or an error occurred, return 0.
+        */
+      inline int
+      searchForNeighbors (const PointCloudIn &cloud, std::size_t index, double parameter,
+                          search::NeighborBuffer &neighbors) const
+      {
+        if (hasPrecomputedNeighbors (cloud, index, parameter))
+          return (neighborhoods_->getNeighbors (index, neighbors.indices, neighbors.sqr_distances));
+        return (search_method_surface_buffer_ (cloud, index, parameter, neighbors));
+      }
+
+      /** \brief Check whether the neighbors of a query point are available in the precomputed neighbors.
+        * \param[in] cloud the query point cloud
+        * \param[in] index the index of the query point in \a cloud
+        * \param[in] parameter the search parameter (either k or radius)
+        */
+      inline bool
+      hasPrecomputedNeighbors (const PointCloudIn &cloud, std::size_t index, double parameter) const
+      {
+        return (neighborhoods_ && &cloud == input_.get () && parameter == search_parameter_ &&
+                neighborhoods_->hasNeighbors (index));
+      }
+
     private:
       /** \brief Abstract feature estimation method.
         * \param[out] output the resultant features
@@ -42,6 +42,7 @@
 
 #include <pcl/features/feature.h>
 #include <pcl/features/fpfh.h>
+#include <pcl/search/neighborhoods.h>
 
 namespace pcl
 {
@@ -89,6 +90,7 @@ namespace pcl
       using FPFHEstimation<PointInT, PointNT, PointOutT>::hist_f3_;
       using FPFHEstimation<PointInT, PointNT, PointOutT>::weightPointSPFHSignature;
 
+      using PointCloudIn = typename Feature<PointInT, PointOutT>::PointCloudIn;
       using PointCloudOut = typename Feature<PointInT, PointOutT>::PointCloudOut;
 
       /** \brief Initialize the scheduler and set the number of threads to use.
@@ -116,6 +118,16 @@ namespace pcl
       void
       computeFeature (PointCloudOut &output) override;
 
+      /** \brief Search the neighbors of a set of points in parallel, keeping them for the following passes.
+        * \param[in] cloud the point cloud holding the query points
+        * \param[in] indices the indices of the query points in \a cloud
+        * \param[out] neighborhoods the neighbors of each query point, in the order of \a indices (none for the
+        * non finite points)
+        */
+      void
+      searchForNeighborhoods (const PointCloudIn &cloud, const std::vector<int> &indices,
+                              search::Neighborhoods &neighborhoods) const;
+
     public:
       /** \brief The number of subdivisions for each angular feature interval. */
       int nr_bins_f1_, nr_bins_f2_, nr_bins_f3_;
@@ -72,38 +72,34 @@ pcl::BoundaryEstimation<PointInT, PointNT, PointOutT>::isBoundaryPoint (
     return (false);
 
   // Compute the angles between each neighboring point and the query point itself
-  std::vector<float> angles (indices.size ());
+  detail::gatherNeighborhood (cloud, indices, q_point.getVector3fMap (), true, deltas_);
+  angles_.resize (deltas_.size);
+  const float *x = deltas_.x.data (), *y = deltas_.y.data (), *z = deltas_.z.data ();
   float max_dif = FLT_MIN, dif;
   int cp = 0;
 
-  for (const int &index : indices)
+  for (std::size_t i = 0; i < deltas_.size; ++i)
   {
-    if (!std::isfinite (cloud.points[index].x) || 
-        !std::isfinite (cloud.points[index].y) || 
-        !std::isfinite (cloud.points[index].z))
+    if (x[i] == 0 && y[i] == 0 && z[i] == 0)
       continue;
 
-    Eigen::Vector4f delta = cloud.points[index].getVector4fMap () - q_point.getVector4fMap ();
-    if (delta == Eigen::Vector4f::Zero())
-      continue;
-
-    angles[cp++] = std::atan2 (v.dot (delta), u.dot (delta)); // the angles are fine between -PI and PI too
+    angles_[cp++] = std::atan2 (v[0] * x[i] + v[1] * y[i] + v[2] * z[i],
+                                u[0] * x[i] + u[1] * y[i] + u[2] * z[i]); // the angles are fine between -PI and PI too
   }
   if (cp == 0)
     return (false);
 
-  angles.resize (cp);
-  std::sort (angles.begin (), angles.end ());
+  std::sort (angles_.begin (), angles_.begin () + cp);
 
   // Compute the maximal angle difference between two consecutive angles
-  for (std::size_t i = 0; i < angles.size () - 1; ++i)
+  for (int i = 0; i < cp - 1; ++i)
   {
-    dif = angles[i + 1] - angles[i];
+    dif = angles_[i + 1] - angles_[i];
     if (max_dif < dif)
       max_dif = dif;
   }
   // Get the angle difference between the last and the first
-  dif = 2 * static_cast<float> (M_PI) - angles[angles.size () - 1] + angles[0];
+  dif = 2 * static_cast<float> (M_PI) - angles_[cp - 1] + angles_[0];
   if (max_dif < dif)
     max_dif = dif;
 
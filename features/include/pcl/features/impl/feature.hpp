@@ -115,6 +115,10 @@ Feature<PointInT, PointOutT>::initCompute ()
     surface_ = input_;
   }
 
+  // Reuse the search method of the precomputed neighbors for the points they do not cover
+  if (!tree_ && neighborhoods_ && neighborhoods_->getSearchSurface () == surface_)
+    tree_ = neighborhoods_->getSearchMethod ();
+
   // Check if a space search locator was given
   if (!tree_)
   {
@@ -149,6 +153,11 @@ Feature<PointInT, PointOutT>::initCompute ()
       {
         return tree_->radiusSearch (cloud, index, radius, k_indices, k_distances, 0);
       };
+      search_method_surface_buffer_ = [this] (const PointCloudIn &cloud, int index, double radius,
+                                              search::NeighborBuffer &neighbors)
+      {
+        return tree_->radiusSearch (cloud.points[index], radius, neighbors, 0);
+      };
     }
   }
   else
@@ -162,6 +171,11 @@ Feature<PointInT, PointOutT>::initCompute ()
       {
         return tree_->nearestKSearch (cloud, index, k, k_indices, k_distances);
       };
+      search_method_surface_buffer_ = [this] (const PointCloudIn &cloud, int index, int k,
+                                              search::NeighborBuffer &neighbors)
+      {
+        return tree_->nearestKSearch (cloud.points[index], k, neighbors);
+      };
     }
     else
     {
@@ -172,6 +186,20 @@ Feature<PointInT, PointOutT>::initCompute ()
       return (false);
     }
   }
+
+  // The precomputed neighbors have to be searched with the same cloud, surface and parameter
+  if (neighborhoods_)
+  {
+    const bool same_parameter = (k_ != 0) ? neighborhoods_->getKSearch () == k_
+                                          : neighborhoods_->getRadiusSearch () == search_radius_;
+    if (neighborhoods_->getInputCloud () != input_ || neighborhoods_->getSearchSurface () != surface_ || !same_parameter)
+    {
+      PCL_ERROR ("[pcl::%s::compute] The precomputed neighbors do not match the input cloud, search surface and search parameter!\n", getClassName ().c_str ());
+      // Cleanup
+      deinitCompute ();
+      return (false);
+    }
+  }
   return (true);
 }
 
@@ -65,7 +65,6 @@ pcl::FPFHEstimation<PointInT, PointNT, PointOutT>::computePointSPFHSignature (
     int p_idx, int row, const std::vector<int> &indices,
     Eigen::MatrixXf &hist_f1, Eigen::MatrixXf &hist_f2, Eigen::MatrixXf &hist_f3)
 {
-  Eigen::Vector4f pfh_tuple;
   // Get the number of bins from the histograms size
   // @TODO: use arrays
   int nr_bins_f1 = static_cast<int> (hist_f1.cols ());
@@ -75,32 +74,51 @@ pcl::FPFHEstimation<PointInT, PointNT, PointOutT>::computePointSPFHSignature (
   // Factorization constant
   float hist_incr = 100.0f / static_cast<float>(indices.size () - 1);
 
+  // The pairs are computed in batches of neighbors gathered on the stack, one coordinate per column
+  constexpr Eigen::Index batch_size = 64;
+  Eigen::Matrix<float, Eigen::Dynamic, 6, Eigen::ColMajor, batch_size, 6> points_normals (batch_size, 6);
+  Eigen::Matrix<float, Eigen::Dynamic, 3, Eigen::ColMajor, batch_size, 3> pfh_tuples (batch_size, 3);
+  Eigen::Matrix<int, Eigen::Dynamic, 3, Eigen::ColMajor, batch_size, 3> h_indices (batch_size, 3);
+  const Eigen::Vector4f p = cloud.points[p_idx].getVector4fMap ();
+  const Eigen::Vector4f n = normals.points[p_idx].getNormalVector4fMap ();
+
   // Iterate over all the points in the neighborhood
-  for (const auto &index : indices)
+  for (std::size_t first = 0; first < indices.size (); first += batch_size)
   {
-    // Avoid unnecessary returns
-    if (p_idx == index)
-        continue;
+    const std::size_t last = std::min (indices.size (), first + batch_size);
 
-    // Compute the pair P to NNi
-    if (!computePairFeatures (cloud, normals, p_idx, index, pfh_tuple[0], pfh_tuple[1], pfh_tuple[2], pfh_tuple[3]))
+    // Gather the neighbors, avoiding unnecessary returns
+    Eigen::Index nr_pairs = 0;
+    for (std::size_t idx = first; idx < last; ++idx)
+    {
+      const int index = indices[idx];
+      if (p_idx == index)
         continue;
+      points_normals.row (nr_pairs).template head<3> () = cloud.points[index].getVector3fMap ();
+      points_normals.row (nr_pairs).template tail<3> () = normals.points[index].getNormalVector3fMap ();
+      ++nr_pairs;
+    }
+
+    // Compute the pairs P to NNi
+    pcl::computePairFeatures (p, n, points_normals.topRows (nr_pairs), pfh_tuples.topRows (nr_pairs));
 
-    // Normalize the f1, f2, f3 features and push them in the histogram
-    int h_index = static_cast<int> (std::floor (nr_bins_f1 * ((pfh_tuple[0] + M_PI) * d_pi_)));
-    if (h_index < 0)           h_index = 0;
-    if (h_index >= nr_bins_f1) h_index = nr_bins_f1 - 1;
-    hist_f1 (row, h_index) += hist_incr;
-
-    h_index = static_cast<int> (std::floor (nr_bins_f2 * ((pfh_tuple[1] + 1.0) * 0.5)));
-    if (h_index < 0)           h_index = 0;
-    if (h_index >= nr_bins_f2) h_index = nr_bins_f2 - 1;
-    hist_f2 (row, h_index) += hist_incr;
-
-    h_index = static_cast<int> (std::floor (nr_bins_f3 * ((pfh_tuple[2] + 1.0) * 0.5)));
-    if (h_index < 0)           h_index = 0;
-    if (h_index >= nr_bins_f3) h_index = nr_bins_f3 - 1;
-    hist_f3 (row, h_index) += hist_incr;
+    // Normalize the f1, f2, f3 features, for all the pairs before pushing them in the histogram
+    for (Eigen::Index i = 0; i < nr_pairs; ++i)
+    {
+      int h_index = static_cast<int> (std::floor (nr_bins_f1 * ((pfh_tuples (i, 0) + M_PI) * d_pi_)));
+      h_indices (i, 0) = std::min (std::max (h_index, 0), nr_bins_f1 - 1);
+      h_index = static_cast<int> (std::floor (nr_bins_f2 * ((pfh_tuples (i, 1) + 1.0) * 0.5)));
+      h_indices (i, 1) = std::min (std::max (h_index, 0), nr_bins_f2 - 1);
+      h_index = static_cast<int> (std::floor (nr_bins_f3 * ((pfh_tuples (i, 2) + 1.0) * 0.5)));
+      h_indices (i, 2) = std::min (std::max (h_index, 0), nr_bins_f3 - 1);
+    }
+
+    for (Eigen::Index i = 0; i < nr_pairs; ++i)
+    {
+      hist_f1 (row, h_indices (i, 0)) += hist_incr;
+      hist_f2 (row, h_indices (i, 1)) += hist_incr;
+      hist_f3 (row, h_indices (i, 2)) += hist_incr;
+    }
   }
 }
 
@@ -181,10 +199,7 @@ template <typename PointInT, typename PointNT, typename PointOutT> void
 pcl::FPFHEstimation<PointInT, PointNT, PointOutT>::computeSPFHSignatures (std::vector<int> &spfh_hist_lookup,
     Eigen::MatrixXf &hist_f1, Eigen::MatrixXf &hist_f2, Eigen::MatrixXf &hist_f3)
 {
-  // Allocate enough space to hold the NN search results
-  // \note This resize is irrelevant for a radiusSearch ().
-  std::vector<int> nn_indices (k_);
-  std::vector<float> nn_dists (k_);
+  search::NeighborBuffer neighbors (k_);
 
   std::set<int> spfh_indices;
   spfh_hist_lookup.resize (surface_->points.size ());
@@ -196,10 +211,10 @@ pcl::FPFHEstimation<PointInT, PointNT, PointOutT>::computeSPFHSignatures (std::v
   {
     for (const auto& p_idx: *indices_)
     {
-      if (this->searchForNeighbors (p_idx, search_parameter_, nn_indices, nn_dists) == 0)
+      if (this->searchForNeighbors (p_idx, search_parameter_, neighbors) == 0)
         continue;
 
-      spfh_indices.insert (nn_indices.begin (), nn_indices.end ());
+      spfh_indices.insert (neighbors.indices.begin (), neighbors.indices.end ());
     }
   }
   else
@@ -220,11 +235,11 @@ pcl::FPFHEstimation<PointInT, PointNT, PointOutT>::computeSPFHSignatures (std::v
   for (const auto& p_idx: spfh_indices)
   {
     // Find the neighborhood around p_idx
-    if (this->searchForNeighbors (*surface_, p_idx, search_parameter_, nn_indices, nn_dists) == 0)
+    if (this->searchForNeighbors (*surface_, p_idx, search_parameter_, neighbors) == 0)
       continue;
 
     // Estimate the SPFH signature around p_idx
-    computePointSPFHSignature (*surface_, *normals_, p_idx, i, nn_indices, hist_f1, hist_f2, hist_f3);
+    computePointSPFHSignature (*surface_, *normals_, p_idx, i, neighbors.indices, hist_f1, hist_f2, hist_f3);
 
     // Populate a lookup table for converting a point index to its corresponding row in the spfh_hist_* matrices
     spfh_hist_lookup[p_idx] = i;
@@ -236,10 +251,7 @@ pcl::FPFHEstimation<PointInT, PointNT, PointOutT>::computeSPFHSignatures (std::v
 template <typename PointInT, typename PointNT, typename PointOutT> void
 pcl::FPFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
 {
-  // Allocate enough space to hold the NN search results
-  // \note This resize is irrelevant for a radiusSearch ().
-  std::vector<int> nn_indices (k_);
-  std::vector<float> nn_dists (k_);
+  search::NeighborBuffer neighbors (k_);
 
   std::vector<int> spfh_hist_lookup;
   computeSPFHSignatures (spfh_hist_lookup, hist_f1_, hist_f2_, hist_f3_);
@@ -251,7 +263,7 @@ pcl::FPFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
     // Iterate over the entire index vector
     for (std::size_t idx = 0; idx < indices_->size (); ++idx)
     {
-      if (this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+      if (this->searchForNeighbors ((*indices_)[idx], search_parameter_, neighbors) == 0)
       {
         for (Eigen::Index d = 0; d < fpfh_histogram_.size (); ++d)
           output.points[idx].histogram[d] = std::numeric_limits<float>::quiet_NaN ();
@@ -260,13 +272,13 @@ pcl::FPFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
         continue;
       }
 
-      // ... and remap the nn_indices values so that they represent row indices in the spfh_hist_* matrices
+      // ... and remap the neighbor indices so that they represent row indices in the spfh_hist_* matrices
       // instead of indices into surface_->points
-      for (auto &nn_index : nn_indices)
+      for (auto &nn_index : neighbors.indices)
         nn_index = spfh_hist_lookup[nn_index];
 
       // Compute the FPFH signature (i.e. compute a weighted combination of local SPFH signatures) ...
-      weightPointSPFHSignature (hist_f1_, hist_f2_, hist_f3_, nn_indices, nn_dists, fpfh_histogram_);
+      weightPointSPFHSignature (hist_f1_, hist_f2_, hist_f3_, neighbors.indices, neighbors.sqr_distances, fpfh_histogram_);
 
       // ...and copy it into the output cloud
       std::copy_n(fpfh_histogram_.data (), fpfh_histogram_.size (), output.points[idx].histogram);
@@ -278,7 +290,7 @@ pcl::FPFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
     for (std::size_t idx = 0; idx < indices_->size (); ++idx)
     {
       if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+          this->searchForNeighbors ((*indices_)[idx], search_parameter_, neighbors) == 0)
       {
         for (Eigen::Index d = 0; d < fpfh_histogram_.size (); ++d)
           output.points[idx].histogram[d] = std::numeric_limits<float>::quiet_NaN ();
@@ -287,13 +299,13 @@ pcl::FPFHEstimation<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut
         continue;
       }
 
-      // ... and remap the nn_indices values so that they represent row indices in the spfh_hist_* matrices
+      // ... and remap the neighbor indices so that they represent row indices in the spfh_hist_* matrices
       // instead of indices into surface_->points
-      for (auto &nn_index : nn_indices)
+      for (auto &nn_index : neighbors.indices)
         nn_index = spfh_hist_lookup[nn_index];
 
       // Compute the FPFH signature (i.e. compute a weighted combination of local SPFH signatures) ...
-      weightPointSPFHSignature (hist_f1_, hist_f2_, hist_f3_, nn_indices, nn_dists, fpfh_histogram_);
+      weightPointSPFHSignature (hist_f1_, hist_f2_, hist_f3_, neighbors.indices, neighbors.sqr_distances, fpfh_histogram_);
 
       // ...and copy it into the output cloud
       std::copy_n(fpfh_histogram_.data (), fpfh_histogram_.size (), output.points[idx].histogram);
@@ -44,6 +44,7 @@
 
 #include <pcl/common/point_tests.h> // for pcl::isFinite
 
+#include <algorithm>
 #include <numeric>
 
 
@@ -61,6 +62,32 @@ pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::setNumberOfThreads (unsign
     threads_ = nr_threads;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::searchForNeighborhoods (
+    const PointCloudIn &cloud, const std::vector<int> &indices, search::Neighborhoods &neighborhoods) const
+{
+  auto search_block = [this, &cloud, &indices] (std::size_t first, std::size_t last,
+                                                Indices &block_indices, std::vector<float> &block_sqr_distances,
+                                                std::size_t *counts)
+  {
+    // Reused by all the queries of the block
+    search::NeighborBuffer neighbors;
+    for (std::size_t q = first; q < last; ++q)
+    {
+      counts[q - first] = 0;
+      if (!isFinite (cloud[indices[q]]) ||
+          this->searchForNeighbors (cloud, indices[q], search_parameter_, neighbors) == 0)
+        continue;
+
+      block_indices.insert (block_indices.end (), neighbors.indices.cbegin (), neighbors.indices.cend ());
+      block_sqr_distances.insert (block_sqr_distances.end (), neighbors.sqr_distances.cbegin (), neighbors.sqr_distances.cend ());
+      counts[q - first] = neighbors.size ();
+    }
+  };
+  search::searchInBlocks (indices.size (), threads_, search_block, neighborhoods);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT> void
 pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloudOut &output)
@@ -68,33 +95,27 @@ pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloud
   std::vector<int> spfh_indices_vec;
   std::vector<int> spfh_hist_lookup (surface_->points.size ());
 
-  // Build a list of (unique) indices for which we will need to compute SPFH signatures
-  // (We need an SPFH signature for every point that is a neighbor of any point in input_[indices_])
-  if (surface_ != input_ ||
-      indices_->size () != surface_->points.size ())
-  { 
-    std::vector<int> nn_indices (k_); // \note These resizes are irrelevant for a radiusSearch ().
-    std::vector<float> nn_dists (k_); 
+  // The neighbors of the query points, searched once and reused by the weighting pass
+  search::Neighborhoods query_neighborhoods;
 
-    std::set<int> spfh_indices_set;
-    for (std::size_t idx = 0; idx < indices_->size (); ++idx)
-    {
-      int p_idx = (*indices_)[idx];
-      if (!isFinite ((*input_)[p_idx]) ||
-          this->searchForNeighbors (p_idx, search_parameter_, nn_indices, nn_dists) == 0)
-        continue;
-
-      spfh_indices_set.insert (nn_indices.begin (), nn_indices.end ());
-    }
-    spfh_indices_vec.resize (spfh_indices_set.size ());
-    std::copy (spfh_indices_set.cbegin (), spfh_indices_set.cend (), spfh_indices_vec.begin ());
+  // Special case: When a feature must be computed at every point, the SPFH signatures are needed at every point,
+  // and the neighborhoods they are computed from are the ones of the query points
+  const bool all_points = (surface_ == input_ && indices_->size () == surface_->points.size ());
+  if (!all_points)
+  {
+    // Build a list of (unique) indices for which we will need to compute SPFH signatures
+    // (We need an SPFH signature for every point that is a neighbor of any point in input_[indices_])
+    searchForNeighborhoods (*input_, *indices_, query_neighborhoods);
+    spfh_indices_vec.assign (query_neighborhoods.indices.cbegin (), query_neighborhoods.indices.cend ());
+    std::sort (spfh_indices_vec.begin (), spfh_indices_vec.end ());
+    spfh_indices_vec.erase (std::unique (spfh_indices_vec.begin (), spfh_indices_vec.end ()), spfh_indices_vec.end ());
   }
   else
   {
-    // Special case: When a feature must be computed at every point, there is no need for a neighborhood search
     spfh_indices_vec.resize (indices_->size ());
     std::iota(spfh_indices_vec.begin (), spfh_indices_vec.end (),
               static_cast<decltype(spfh_indices_vec)::value_type>(0));
+    searchForNeighborhoods (*surface_, spfh_indices_vec, query_neighborhoods);
   }
 
   // Initialize the arrays that will store the SPFH signatures
@@ -103,28 +124,34 @@ pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloud
   hist_f2_.setZero (data_size, nr_bins_f2_);
   hist_f3_.setZero (data_size, nr_bins_f3_);
 
-  std::vector<int> nn_indices (k_); // \note These resizes are irrelevant for a radiusSearch ().
-  std::vector<float> nn_dists (k_); 
+  search::NeighborBuffer neighbors;
 
   // Compute SPFH signatures for every point that needs them
 
 #pragma omp parallel for \
   default(none) \
-  shared(spfh_hist_lookup, spfh_indices_vec) \
-  private(nn_indices, nn_dists) \
+  shared(query_neighborhoods, spfh_hist_lookup, spfh_indices_vec) \
+  firstprivate(all_points) \
+  private(neighbors) \
   num_threads(threads_)
   for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (spfh_indices_vec.size ()); ++i)
   {
     // Get the next point index
     int p_idx = spfh_indices_vec[i];
 
-    // Find the neighborhood around p_idx
-    if (!isFinite ((*input_)[p_idx]) ||
-        this->searchForNeighbors (*surface_, p_idx, search_parameter_, nn_indices, nn_dists) == 0)
+    // Find the neighborhood around p_idx, already known if it is a query point
+    if (all_points)
+    {
+      if (query_neighborhoods.getNumberOfNeighbors (i) == 0)
+        continue;
+      query_neighborhoods.getNeighbors (i, neighbors.indices, neighbors.sqr_distances);
+    }
+    else if (!isFinite ((*input_)[p_idx]) ||
+             this->searchForNeighbors (*surface_, p_idx, search_parameter_, neighbors) == 0)
       continue;
 
     // Estimate the SPFH signature around p_idx
-    this->computePointSPFHSignature (*surface_, *normals_, p_idx, i, nn_indices, hist_f1_, hist_f2_, hist_f3_);
+    this->computePointSPFHSignature (*surface_, *normals_, p_idx, i, neighbors.indices, hist_f1_, hist_f2_, hist_f3_);
 
     // Populate a lookup table for converting a point index to its corresponding row in the spfh_hist_* matrices
     spfh_hist_lookup[p_idx] = i;
@@ -132,21 +159,20 @@ pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloud
 
   // Initialize the array that will store the FPFH signature
   int nr_bins = nr_bins_f1_ + nr_bins_f2_ + nr_bins_f3_;
-
-  nn_indices.clear();
-  nn_dists.clear();
+  Eigen::VectorXf fpfh_histogram;
 
   // Iterate over the entire index vector
 #pragma omp parallel for \
   default(none) \
-  shared(nr_bins, output, spfh_hist_lookup) \
-  private(nn_dists, nn_indices) \
+  shared(nr_bins, output, query_neighborhoods, spfh_hist_lookup) \
+  firstprivate(all_points) \
+  private(neighbors, fpfh_histogram) \
   num_threads(threads_)
   for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
   {
-    // Find the indices of point idx's neighbors...
-    if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-        this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+    // Get the neighbors of point idx (none if it is not finite)...
+    const std::size_t query = all_points ? static_cast<std::size_t> ((*indices_)[idx]) : static_cast<std::size_t> (idx);
+    if (query_neighborhoods.getNumberOfNeighbors (query) == 0)
     {
       for (int d = 0; d < nr_bins; ++d)
         output.points[idx].histogram[d] = std::numeric_limits<float>::quiet_NaN ();
@@ -155,15 +181,14 @@ pcl::FPFHEstimationOMP<PointInT, PointNT, PointOutT>::computeFeature (PointCloud
       continue;
     }
 
-
-    // ... and remap the nn_indices values so that they represent row indices in the spfh_hist_* matrices 
+    // ... and remap the neighbor indices so that they represent row indices in the spfh_hist_* matrices 
     // instead of indices into surface_->points
-    for (int &nn_index : nn_indices)
+    query_neighborhoods.getNeighbors (query, neighbors.indices, neighbors.sqr_distances);
+    for (int &nn_index : neighbors.indices)
       nn_index = spfh_hist_lookup[nn_index];
 
     // Compute the FPFH signature (i.e. compute a weighted combination of local SPFH signatures) ...
-    Eigen::VectorXf fpfh_histogram = Eigen::VectorXf::Zero (nr_bins);
-    weightPointSPFHSignature (hist_f1_, hist_f2_, hist_f3_, nn_indices, nn_dists, fpfh_histogram);
+    weightPointSPFHSignature (hist_f1_, hist_f2_, hist_f3_, neighbors.indices, neighbors.sqr_distances, fpfh_histogram);
 
     // ...and copy it into the output cloud
     for (int d = 0; d < nr_bins; ++d)
@@ -41,8 +41,13 @@
 #ifndef PCL_INTEGRAL_IMAGE2D_IMPL_H_
 #define PCL_INTEGRAL_IMAGE2D_IMPL_H_
 
+#include <algorithm>
 #include <cstddef>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 namespace pcl
 {
@@ -54,18 +59,30 @@ IntegralImage2D<DataType, Dimension>::setSecondOrderComputation (bool compute_se
 }
 
 
+template <typename DataType, unsigned Dimension> void
+IntegralImage2D<DataType, Dimension>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
+
 template <typename DataType, unsigned Dimension> void
 IntegralImage2D<DataType, Dimension>::setInput (const DataType * data, unsigned width,unsigned height, unsigned element_stride, unsigned row_stride)
 {
-  if ((width + 1) * (height + 1) > first_order_integral_image_.size () )
-  {
-    width_  = width;
-    height_ = height;
-    first_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-    finite_values_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-    if (compute_second_order_integral_images_)
-      second_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-  }
+  // The buffers keep their memory when the size of the input does not grow
+  width_  = width;
+  height_ = height;
+  first_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
+  finite_values_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
+  if (compute_second_order_integral_images_)
+    second_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
   computeIntegralImages (data, row_stride, element_stride);
 }
 
@@ -158,83 +175,103 @@ template <typename DataType, unsigned Dimension> void
 IntegralImage2D<DataType, Dimension>::computeIntegralImages (
     const DataType *data, unsigned row_stride, unsigned element_stride)
 {
-  ElementType* previous_row = &first_order_integral_image_[0];
-  ElementType* current_row  = previous_row + (width_ + 1);
-  memset (previous_row, 0, sizeof (ElementType) * (width_ + 1));
-
-  unsigned* count_previous_row = &finite_values_integral_image_[0];
-  unsigned* count_current_row  = count_previous_row + (width_ + 1);
-  memset (count_previous_row, 0, sizeof (unsigned) * (width_ + 1));
-
-  if (!compute_second_order_integral_images_)
+  const std::size_t stride = width_ + 1;
+  const auto height = static_cast<std::ptrdiff_t> (height_);
+  ElementType* first_order = &first_order_integral_image_[0];
+  unsigned* count = &finite_values_integral_image_[0];
+  SecondOrderType* second_order = compute_second_order_integral_images_ ? &second_order_integral_image_[0] : nullptr;
+
+  memset (first_order, 0, sizeof (ElementType) * stride);
+  memset (count, 0, sizeof (unsigned) * stride);
+  if (second_order)
+    memset (second_order, 0, sizeof (SecondOrderType) * stride);
+
+  // First pass: the sums along every row, independent from the other rows
+#pragma omp parallel for \
+  default(none) \
+  firstprivate(data, row_stride, element_stride, stride, height, first_order, count, second_order) \
+  num_threads(threads_)
+  for (std::ptrdiff_t rowIdx = 0; rowIdx < height; ++rowIdx)
   {
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1))
+    const DataType* row_data = data + rowIdx * row_stride;
+    ElementType* current_row = first_order + (rowIdx + 1) * stride;
+    unsigned* count_current_row = count + (rowIdx + 1) * stride;
+    SecondOrderType* so_current_row = second_order ? second_order + (rowIdx + 1) * stride : nullptr;
+
+    current_row [0].setZero ();
+    count_current_row [0] = 0;
+    if (so_current_row)
+      so_current_row [0].setZero ();
+    for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
     {
-      current_row [0].setZero ();
-      count_current_row [0] = 0;
-      for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
+      current_row [colIdx + 1] = current_row [colIdx];
+      count_current_row [colIdx + 1] = count_current_row [colIdx];
+      if (so_current_row)
+        so_current_row [colIdx + 1] = so_current_row [colIdx];
+
+      const InputType* element = reinterpret_cast <const InputType*> (&row_data [valIdx]);
+      if (std::isfinite (element->sum ()))
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        const InputType* element = reinterpret_cast <const InputType*> (&data [valIdx]);
-        if (std::isfinite (element->sum ()))
-        {
-          current_row [colIdx + 1] += element->template cast<typename IntegralImageTypeTraits<DataType>::IntegralType>();
-          ++(count_current_row [colIdx + 1]);
-        }
+        current_row [colIdx + 1] += element->template cast<typename IntegralImageTypeTraits<DataType>::IntegralType>();
+        ++(count_current_row [colIdx + 1]);
+        if (so_current_row)
+          for (unsigned myIdx = 0, elIdx = 0; myIdx < Dimension; ++myIdx)
+            for (unsigned mxIdx = myIdx; mxIdx < Dimension; ++mxIdx, ++elIdx)
+              so_current_row [colIdx + 1][elIdx] += (*element)[myIdx] * (*element)[mxIdx];
       }
     }
   }
-  else
+
+  // Second pass: add up the rows, by tiles of columns
+  const std::size_t tile_width = 64;
+  const auto nr_tiles = static_cast<std::ptrdiff_t> ((stride + tile_width - 1) / tile_width);
+#pragma omp parallel for \
+  default(none) \
+  firstprivate(stride, height, tile_width, nr_tiles, first_order, count, second_order) \
+  num_threads(threads_)
+  for (std::ptrdiff_t tile = 0; tile < nr_tiles; ++tile)
   {
-    SecondOrderType* so_previous_row = &second_order_integral_image_[0];
-    SecondOrderType* so_current_row  = so_previous_row + (width_ + 1);
-    memset (so_previous_row, 0, sizeof (SecondOrderType) * (width_ + 1));
-
-    SecondOrderType so_element;
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1),
-                                                so_previous_row = so_current_row, so_current_row += (width_ + 1))
+    const std::size_t first = tile * tile_width;
+    const std::size_t last = std::min (first + tile_width, stride);
+    for (std::ptrdiff_t rowIdx = 2; rowIdx <= height; ++rowIdx)
     {
-      current_row [0].setZero ();
-      so_current_row [0].setZero ();
-      count_current_row [0] = 0;
-      for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
+      const std::size_t current_row = rowIdx * stride, previous_row = current_row - stride;
+      for (std::size_t colIdx = first; colIdx < last; ++colIdx)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        so_current_row [colIdx + 1] = so_previous_row [colIdx + 1] + so_current_row [colIdx] - so_previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-
-        const InputType* element = reinterpret_cast <const InputType*> (&data [valIdx]);
-        if (std::isfinite (element->sum ()))
-        {
-          current_row [colIdx + 1] += element->template cast<typename IntegralImageTypeTraits<DataType>::IntegralType>();
-          ++(count_current_row [colIdx + 1]);
-          for (unsigned myIdx = 0, elIdx = 0; myIdx < Dimension; ++myIdx)
-            for (unsigned mxIdx = myIdx; mxIdx < Dimension; ++mxIdx, ++elIdx)
-              so_current_row [colIdx + 1][elIdx] += (*element)[myIdx] * (*element)[mxIdx];
-        }
+        first_order [current_row + colIdx] += first_order [previous_row + colIdx];
+        count [current_row + colIdx] += count [previous_row + colIdx];
+        if (second_order)
+          second_order [current_row + colIdx] += second_order [previous_row + colIdx];
       }
     }
   }
 }
 
 
+template <typename DataType> void
+IntegralImage2D<DataType, 1>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
+
 template <typename DataType> void
 IntegralImage2D<DataType, 1>::setInput (const DataType * data, unsigned width,unsigned height, unsigned element_stride, unsigned row_stride)
 {
-  if ((width + 1) * (height + 1) > first_order_integral_image_.size () )
-  {
-    width_  = width;
-    height_ = height;
-    first_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-    finite_values_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-    if (compute_second_order_integral_images_)
-      second_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
-  }
+  // The buffers keep their memory when the size of the input does not grow
+  width_  = width;
+  height_ = height;
+  first_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
+  finite_values_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
+  if (compute_second_order_integral_images_)
+    second_order_integral_image_.resize ( (width_ + 1) * (height_ + 1) );
   computeIntegralImages (data, row_stride, element_stride);
 }
 
@@ -327,59 +364,70 @@ template <typename DataType> void
 IntegralImage2D<DataType, 1>::computeIntegralImages (
     const DataType *data, unsigned row_stride, unsigned element_stride)
 {
-  ElementType* previous_row = &first_order_integral_image_[0];
-  ElementType* current_row  = previous_row + (width_ + 1);
-  memset (previous_row, 0, sizeof (ElementType) * (width_ + 1));
-
-  unsigned* count_previous_row = &finite_values_integral_image_[0];
-  unsigned* count_current_row  = count_previous_row + (width_ + 1);
-  memset (count_previous_row, 0, sizeof (unsigned) * (width_ + 1));
-
-  if (!compute_second_order_integral_images_)
+  const std::size_t stride = width_ + 1;
+  const auto height = static_cast<std::ptrdiff_t> (height_);
+  ElementType* first_order = &first_order_integral_image_[0];
+  unsigned* count = &finite_values_integral_image_[0];
+  SecondOrderType* second_order = compute_second_order_integral_images_ ? &second_order_integral_image_[0] : nullptr;
+
+  memset (first_order, 0, sizeof (ElementType) * stride);
+  memset (count, 0, sizeof (unsigned) * stride);
+  if (second_order)
+    memset (second_order, 0, sizeof (SecondOrderType) * stride);
+
+  // First pass: the sums along every row, independent from the other rows
+#pragma omp parallel for \
+  default(none) \
+  firstprivate(data, row_stride, element_stride, stride, height, first_order, count, second_order) \
+  num_threads(threads_)
+  for (std::ptrdiff_t rowIdx = 0; rowIdx < height; ++rowIdx)
   {
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1))
+    const DataType* row_data = data + rowIdx * row_stride;
+    ElementType* current_row = first_order + (rowIdx + 1) * stride;
+    unsigned* count_current_row = count + (rowIdx + 1) * stride;
+    SecondOrderType* so_current_row = second_order ? second_order + (rowIdx + 1) * stride : nullptr;
+
+    current_row [0] = 0.0;
+    count_current_row [0] = 0;
+    if (so_current_row)
+      so_current_row [0] = 0.0;
+    for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
     {
-      current_row [0] = 0.0;
-      count_current_row [0] = 0;
-      for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
+      current_row [colIdx + 1] = current_row [colIdx];
+      count_current_row [colIdx + 1] = count_current_row [colIdx];
+      if (so_current_row)
+        so_current_row [colIdx + 1] = so_current_row [colIdx];
+
+      if (std::isfinite (row_data [valIdx]))
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        if (std::isfinite (data [valIdx]))
-        {
-          current_row [colIdx + 1] += data [valIdx];
-          ++(count_current_row [colIdx + 1]);
-        }
+        current_row [colIdx + 1] += row_data [valIdx];
+        ++(count_current_row [colIdx + 1]);
+        if (so_current_row)
+          so_current_row [colIdx + 1] += row_data [valIdx] * row_data [valIdx];
       }
     }
   }
-  else
+
+  // Second pass: add up the rows, by tiles of columns
+  const std::size_t tile_width = 256;
+  const auto nr_tiles = static_cast<std::ptrdiff_t> ((stride + tile_width - 1) / tile_width);
+#pragma omp parallel for \
+  default(none) \
+  firstprivate(stride, height, tile_width, nr_tiles, first_order, count, second_order) \
+  num_threads(threads_)
+  for (std::ptrdiff_t tile = 0; tile < nr_tiles; ++tile)
   {
-    SecondOrderType* so_previous_row = &second_order_integral_image_[0];
-    SecondOrderType* so_current_row  = so_previous_row + (width_ + 1);
-    memset (so_previous_row, 0, sizeof (SecondOrderType) * (width_ + 1));
-
-    for (unsigned rowIdx = 0; rowIdx < height_; ++rowIdx, data += row_stride,
-                                                previous_row = current_row, current_row += (width_ + 1),
-                                                count_previous_row = count_current_row, count_current_row += (width_ + 1),
-                                                so_previous_row = so_current_row, so_current_row += (width_ + 1))
+    const std::size_t first = tile * tile_width;
+    const std::size_t last = std::min (first + tile_width, stride);
+    for (std::ptrdiff_t rowIdx = 2; rowIdx <= height; ++rowIdx)
     {
-      current_row [0] = 0.0;
-      so_current_row [0] = 0.0;
-      count_current_row [0] = 0;
-      for (unsigned colIdx = 0, valIdx = 0; colIdx < width_; ++colIdx, valIdx += element_stride)
+      const std::size_t current_row = rowIdx * stride, previous_row = current_row - stride;
+      for (std::size_t colIdx = first; colIdx < last; ++colIdx)
       {
-        current_row [colIdx + 1] = previous_row [colIdx + 1] + current_row [colIdx] - previous_row [colIdx];
-        so_current_row [colIdx + 1] = so_previous_row [colIdx + 1] + so_current_row [colIdx] - so_previous_row [colIdx];
-        count_current_row [colIdx + 1] = count_previous_row [colIdx + 1] + count_current_row [colIdx] - count_previous_row [colIdx];
-        if (std::isfinite (data[valIdx]))
-        {
-          current_row [colIdx + 1] += data[valIdx];
-          so_current_row [colIdx + 1] += data[valIdx] * data[valIdx];
-          ++(count_current_row [colIdx + 1]);
-        }
+        first_order [current_row + colIdx] += first_order [previous_row + colIdx];
+        count [current_row + colIdx] += count [previous_row + colIdx];
+        if (second_order)
+          second_order [current_row + colIdx] += second_order [previous_row + colIdx];
       }
     }
   }
@@ -43,14 +43,57 @@
 
 #include <pcl/features/normal_3d.h>
 
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> bool
+pcl::NormalEstimation<PointInT, PointOutT>::addToBatch (
+    std::size_t idx, const std::vector<int> &nn_indices,
+    detail::NeighborhoodCoordinates &coordinates, detail::PCABatch &batch) const
+{
+  if (nn_indices.size () < 3)
+    return (false);
+
+  // The coordinates are taken relative to the query point, to keep the covariance matrix accurate far from the origin
+  detail::gatherNeighborhood (*surface_, nn_indices, input_->points[(*indices_)[idx]].getVector3fMap (),
+                              !surface_->is_dense, coordinates);
+  if (coordinates.size == 0)
+    return (false);
+
+  EIGEN_ALIGN16 Eigen::Matrix3f covariance_matrix;
+  detail::computeNeighborhoodCovariance (coordinates, covariance_matrix);
+  batch.push_back (covariance_matrix, idx);
+  return (true);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> void
+pcl::NormalEstimation<PointInT, PointOutT>::flushBatch (detail::PCABatch &batch, PointCloudOut &output) const
+{
+  detail::solvePCABatch (batch, detail::PCAEigenvector::SMALLEST);
+  for (std::size_t i = 0; i < batch.size; ++i)
+  {
+    const std::size_t idx = batch.tags[i];
+    output.points[idx].normal_x = batch.eigenvector[0][i];
+    output.points[idx].normal_y = batch.eigenvector[1][i];
+    output.points[idx].normal_z = batch.eigenvector[2][i];
+
+    // Compute the curvature surface change, as solvePlaneParameters () does
+    const float eig_sum = batch.xx[i] + batch.yy[i] + batch.zz[i];
+    output.points[idx].curvature = eig_sum != 0 ? std::abs (batch.eigenvalues[0][i] / eig_sum) : 0.0f;
+
+    flipNormalTowardsViewpoint (input_->points[(*indices_)[idx]], vpx_, vpy_, vpz_,
+                                output.points[idx].normal[0], output.points[idx].normal[1], output.points[idx].normal[2]);
+  }
+  batch.size = 0;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::NormalEstimation<PointInT, PointOutT>::computeFeature (PointCloudOut &output)
 {
-  // Allocate enough space to hold the results
-  // \note This resize is irrelevant for a radiusSearch ().
-  std::vector<int> nn_indices (k_);
-  std::vector<float> nn_dists (k_);
+  search::NeighborBuffer neighbors (k_);
+  // The covariance matrices are solved in batches, whose normals are written when they are full
+  detail::NeighborhoodCoordinates coordinates;
+  detail::PCABatch batch;
 
   output.is_dense = true;
   // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
@@ -59,8 +102,8 @@ pcl::NormalEstimation<PointInT, PointOutT>::computeFeature (PointCloudOut &outpu
     // Iterating over the entire index vector
     for (std::size_t idx = 0; idx < indices_->size (); ++idx)
     {
-      if (this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0 ||
-          !computePointNormal (*surface_, nn_indices, output.points[idx].normal[0], output.points[idx].normal[1], output.points[idx].normal[2], output.points[idx].curvature))
+      if (this->searchForNeighbors ((*indices_)[idx], search_parameter_, neighbors) == 0 ||
+          !addToBatch (idx, neighbors.indices, coordinates, batch))
       {
         output.points[idx].normal[0] = output.points[idx].normal[1] = output.points[idx].normal[2] = output.points[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
 
@@ -68,9 +111,8 @@ pcl::NormalEstimation<PointInT, PointOutT>::computeFeature (PointCloudOut &outpu
         continue;
       }
 
-      flipNormalTowardsViewpoint (input_->points[(*indices_)[idx]], vpx_, vpy_, vpz_,
-                                  output.points[idx].normal[0], output.points[idx].normal[1], output.points[idx].normal[2]);
-
+      if (batch.full ())
+        flushBatch (batch, output);
     }
   }
   else
@@ -79,8 +121,8 @@ pcl::NormalEstimation<PointInT, PointOutT>::computeFeature (PointCloudOut &outpu
     for (std::size_t idx = 0; idx < indices_->size (); ++idx)
     {
       if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0 ||
-          !computePointNormal (*surface_, nn_indices, output.points[idx].normal[0], output.points[idx].normal[1], output.points[idx].normal[2], output.points[idx].curvature))
+          this->searchForNeighbors ((*indices_)[idx], search_parameter_, neighbors) == 0 ||
+          !addToBatch (idx, neighbors.indices, coordinates, batch))
       {
         output.points[idx].normal[0] = output.points[idx].normal[1] = output.points[idx].normal[2] = output.points[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
 
@@ -88,11 +130,11 @@ pcl::NormalEstimation<PointInT, PointOutT>::computeFeature (PointCloudOut &outpu
         continue;
       }
 
-      flipNormalTowardsViewpoint (input_->points[(*indices_)[idx]], vpx_, vpy_, vpz_,
-                                  output.points[idx].normal[0], output.points[idx].normal[1], output.points[idx].normal[2]);
-
+      if (batch.full ())
+        flushBatch (batch, output);
     }
   }
+  flushBatch (batch, output);
 }
 
 #define PCL_INSTANTIATE_NormalEstimation(T,NT) template class PCL_EXPORTS pcl::NormalEstimation<T,NT>;
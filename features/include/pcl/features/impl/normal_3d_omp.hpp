@@ -43,6 +43,8 @@
 
 #include <pcl/features/normal_3d_omp.h>
 
+#include <algorithm>
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::NormalEstimationOMP<PointInT, PointOutT>::setNumberOfThreads (unsigned int nr_threads)
@@ -61,70 +63,73 @@ pcl::NormalEstimationOMP<PointInT, PointOutT>::setNumberOfThreads (unsigned int
 template <typename PointInT, typename PointOutT> void
 pcl::NormalEstimationOMP<PointInT, PointOutT>::computeFeature (PointCloudOut &output)
 {
-  // Allocate enough space to hold the results
-  // \note This resize is irrelevant for a radiusSearch ().
-  std::vector<int> nn_indices (k_);
-  std::vector<float> nn_dists (k_);
+  // The indices are scheduled in blocks of the size of a batch, which each thread solves at the end of the block
+  const std::ptrdiff_t block_size = static_cast<std::ptrdiff_t> (detail::PCABatch::capacity);
+  const std::ptrdiff_t nr_blocks = (static_cast<std::ptrdiff_t> (indices_->size ()) + block_size - 1) / block_size;
 
   output.is_dense = true;
   // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
   if (input_->is_dense)
   {
-#pragma omp parallel for \
+#pragma omp parallel \
   default(none) \
   shared(output) \
-  firstprivate(nn_indices, nn_dists) \
+  firstprivate(block_size, nr_blocks) \
   num_threads(threads_)
-    // Iterating over the entire index vector
-    for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
     {
-      Eigen::Vector4f n;
-      if (this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0 ||
-          !pcl::computePointNormal (*surface_, nn_indices, n, output.points[idx].curvature))
-      {
-        output.points[idx].normal[0] = output.points[idx].normal[1] = output.points[idx].normal[2] = output.points[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
+      search::NeighborBuffer neighbors (k_);
+      detail::NeighborhoodCoordinates coordinates;
+      detail::PCABatch batch;
 
-        output.is_dense = false;
-        continue;
+#pragma omp for
+      for (std::ptrdiff_t block = 0; block < nr_blocks; ++block)
+      {
+        const std::size_t end = std::min (indices_->size (), static_cast<std::size_t> ((block + 1) * block_size));
+        // Iterating over the block of the index vector
+        for (std::size_t idx = static_cast<std::size_t> (block * block_size); idx < end; ++idx)
+        {
+          if (this->searchForNeighbors ((*indices_)[idx], search_parameter_, neighbors) == 0 ||
+              !this->addToBatch (idx, neighbors.indices, coordinates, batch))
+          {
+            output.points[idx].normal[0] = output.points[idx].normal[1] = output.points[idx].normal[2] = output.points[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
+
+            output.is_dense = false;
+          }
+        }
+        this->flushBatch (batch, output);
       }
-
-      output.points[idx].normal_x = n[0];
-      output.points[idx].normal_y = n[1];
-      output.points[idx].normal_z = n[2];
-
-      flipNormalTowardsViewpoint (input_->points[(*indices_)[idx]], vpx_, vpy_, vpz_,
-                                  output.points[idx].normal[0], output.points[idx].normal[1], output.points[idx].normal[2]);
-
     }
   }
   else
   {
-#pragma omp parallel for \
+#pragma omp parallel \
   default(none) \
   shared(output) \
-  firstprivate(nn_indices, nn_dists) \
+  firstprivate(block_size, nr_blocks) \
   num_threads(threads_)
-    // Iterating over the entire index vector
-    for (std::ptrdiff_t idx = 0; idx < static_cast<std::ptrdiff_t> (indices_->size ()); ++idx)
     {
-      Eigen::Vector4f n;
-      if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0 ||
-          !pcl::computePointNormal (*surface_, nn_indices, n, output.points[idx].curvature))
-      {
-        output.points[idx].normal[0] = output.points[idx].normal[1] = output.points[idx].normal[2] = output.points[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
+      search::NeighborBuffer neighbors (k_);
+      detail::NeighborhoodCoordinates coordinates;
+      detail::PCABatch batch;
 
-        output.is_dense = false;
-        continue;
+#pragma omp for
+      for (std::ptrdiff_t block = 0; block < nr_blocks; ++block)
+      {
+        const std::size_t end = std::min (indices_->size (), static_cast<std::size_t> ((block + 1) * block_size));
+        // Iterating over the block of the index vector
+        for (std::size_t idx = static_cast<std::size_t> (block * block_size); idx < end; ++idx)
+        {
+          if (!isFinite ((*input_)[(*indices_)[idx]]) ||
+              this->searchForNeighbors ((*indices_)[idx], search_parameter_, neighbors) == 0 ||
+              !this->addToBatch (idx, neighbors.indices, coordinates, batch))
+          {
+            output.points[idx].normal[0] = output.points[idx].normal[1] = output.points[idx].normal[2] = output.points[idx].curvature = std::numeric_limits<float>::quiet_NaN ();
+
+            output.is_dense = false;
+          }
+        }
+        this->flushBatch (batch, output);
       }
-
-      output.points[idx].normal_x = n[0];
-      output.points[idx].normal_y = n[1];
-      output.points[idx].normal_z = n[2];
-
-      flipNormalTowardsViewpoint (input_->points[(*indices_)[idx]], vpx_, vpy_, vpz_,
-                                  output.points[idx].normal[0], output.points[idx].normal[1], output.points[idx].normal[2]);
-
     }
   }
 }
@@ -46,67 +46,73 @@
 
 
 //////////////////////////////////////////////////////////////////////////////////////////////
-template <typename PointInT, typename PointNT, typename PointOutT> void
-pcl::PrincipalCurvaturesEstimation<PointInT, PointNT, PointOutT>::computePointPrincipalCurvatures (
+template <typename PointInT, typename PointNT, typename PointOutT> bool
+pcl::PrincipalCurvaturesEstimation<PointInT, PointNT, PointOutT>::addToBatch (
       const pcl::PointCloud<PointNT> &normals, int p_idx, const std::vector<int> &indices,
-      float &pcx, float &pcy, float &pcz, float &pc1, float &pc2)
+      std::size_t tag, detail::PCABatch &batch)
 {
+  if (indices.empty ())
+    return (false);
+
   EIGEN_ALIGN16 Eigen::Matrix3f I = Eigen::Matrix3f::Identity ();
   Eigen::Vector3f n_idx (normals.points[p_idx].normal[0], normals.points[p_idx].normal[1], normals.points[p_idx].normal[2]);
   EIGEN_ALIGN16 Eigen::Matrix3f M = I - n_idx * n_idx.transpose ();    // projection matrix (into tangent plane)
 
-  // Project normals into the tangent plane
-  Eigen::Vector3f normal;
-  projected_normals_.resize (indices.size ());
-  xyz_centroid_.setZero ();
-  for (std::size_t idx = 0; idx < indices.size(); ++idx)
+  // Project normals into the tangent plane, where the normal of the query point projects to the origin
+  projected_normals_.reserve (indices.size ());
+  for (std::size_t idx = 0; idx < indices.size (); ++idx)
   {
-    normal[0] = normals.points[indices[idx]].normal[0];
-    normal[1] = normals.points[indices[idx]].normal[1];
-    normal[2] = normals.points[indices[idx]].normal[2];
-
-    projected_normals_[idx] = M * normal;
-    xyz_centroid_ += projected_normals_[idx];
+    const Eigen::Vector3f normal = M * normals.points[indices[idx]].getNormalVector3fMap ();
+    projected_normals_.x[idx] = normal[0];
+    projected_normals_.y[idx] = normal[1];
+    projected_normals_.z[idx] = normal[2];
   }
+  projected_normals_.size = indices.size ();
 
-  // Estimate the XYZ centroid
-  xyz_centroid_ /= static_cast<float> (indices.size ());
-
-  // Initialize to 0
-  covariance_matrix_.setZero ();
+  EIGEN_ALIGN16 Eigen::Matrix3f covariance_matrix;
+  detail::computeNeighborhoodCovariance (projected_normals_, covariance_matrix);
+  batch.push_back (covariance_matrix, tag);
+  return (true);
+}
 
-  // For each point in the cloud
-  for (std::size_t idx = 0; idx < indices.size (); ++idx)
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::PrincipalCurvaturesEstimation<PointInT, PointNT, PointOutT>::flushBatch (
+      detail::PCABatch &batch, PointCloudOut &output) const
+{
+  detail::solvePCABatch (batch, detail::PCAEigenvector::LARGEST);
+  for (std::size_t i = 0; i < batch.size; ++i)
   {
-    demean_ = projected_normals_[idx] - xyz_centroid_;
-
-    double demean_xy = demean_[0] * demean_[1];
-    double demean_xz = demean_[0] * demean_[2];
-    double demean_yz = demean_[1] * demean_[2];
-
-    covariance_matrix_(0, 0) += demean_[0] * demean_[0];
-    covariance_matrix_(0, 1) += static_cast<float> (demean_xy);
-    covariance_matrix_(0, 2) += static_cast<float> (demean_xz);
-
-    covariance_matrix_(1, 0) += static_cast<float> (demean_xy);
-    covariance_matrix_(1, 1) += demean_[1] * demean_[1];
-    covariance_matrix_(1, 2) += static_cast<float> (demean_yz);
-
-    covariance_matrix_(2, 0) += static_cast<float> (demean_xz);
-    covariance_matrix_(2, 1) += static_cast<float> (demean_yz);
-    covariance_matrix_(2, 2) += demean_[2] * demean_[2];
+    // The covariance matrices are normalized by the number of normals, and so are their eigenvalues
+    const std::size_t idx = batch.tags[i];
+    output.points[idx].principal_curvature[0] = batch.eigenvector[0][i];
+    output.points[idx].principal_curvature[1] = batch.eigenvector[1][i];
+    output.points[idx].principal_curvature[2] = batch.eigenvector[2][i];
+    output.points[idx].pc1 = batch.eigenvalues[2][i];
+    output.points[idx].pc2 = batch.eigenvalues[1][i];
   }
+  batch.size = 0;
+}
 
-  // Extract the eigenvalues and eigenvectors
-  pcl::eigen33 (covariance_matrix_, eigenvalues_);
-  pcl::computeCorrespondingEigenVector (covariance_matrix_, eigenvalues_ [2], eigenvector_);
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT> void
+pcl::PrincipalCurvaturesEstimation<PointInT, PointNT, PointOutT>::computePointPrincipalCurvatures (
+      const pcl::PointCloud<PointNT> &normals, int p_idx, const std::vector<int> &indices,
+      float &pcx, float &pcy, float &pcz, float &pc1, float &pc2)
+{
+  detail::PCABatch batch;
+  if (!addToBatch (normals, p_idx, indices, 0, batch))
+  {
+    pcx = pcy = pcz = pc1 = pc2 = std::numeric_limits<float>::quiet_NaN ();
+    return;
+  }
 
-  pcx = eigenvector_ [0];
-  pcy = eigenvector_ [1];
-  pcz = eigenvector_ [2];
-  float indices_size = 1.0f / static_cast<float> (indices.size ());
-  pc1 = eigenvalues_ [2] * indices_size;
-  pc2 = eigenvalues_ [1] * indices_size;
+  detail::solvePCABatch (batch, detail::PCAEigenvector::LARGEST);
+  pcx = batch.eigenvector[0][0];
+  pcy = batch.eigenvector[1][0];
+  pcz = batch.eigenvector[2][0];
+  pc1 = batch.eigenvalues[2][0];
+  pc2 = batch.eigenvalues[1][0];
 }
 
 
@@ -118,6 +124,8 @@ pcl::PrincipalCurvaturesEstimation<PointInT, PointNT, PointOutT>::computeFeature
   // \note This resize is irrelevant for a radiusSearch ().
   std::vector<int> nn_indices (k_);
   std::vector<float> nn_dists (k_);
+  // The covariance matrices are solved in batches, whose curvatures are written when they are full
+  detail::PCABatch batch;
 
   output.is_dense = true;
   // Save a few cycles by not checking every point for NaN/Inf values if the cloud is set to dense
@@ -126,7 +134,8 @@ pcl::PrincipalCurvaturesEstimation<PointInT, PointNT, PointOutT>::computeFeature
     // Iterating over the entire index vector
     for (std::size_t idx = 0; idx < indices_->size (); ++idx)
     {
-      if (this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+      if (this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0 ||
+          !addToBatch (*normals_, (*indices_)[idx], nn_indices, idx, batch))
       {
         output.points[idx].principal_curvature[0] = output.points[idx].principal_curvature[1] = output.points[idx].principal_curvature[2] =
           output.points[idx].pc1 = output.points[idx].pc2 = std::numeric_limits<float>::quiet_NaN ();
@@ -134,10 +143,8 @@ pcl::PrincipalCurvaturesEstimation<PointInT, PointNT, PointOutT>::computeFeature
         continue;
       }
 
-      // Estimate the principal curvatures at each patch
-      computePointPrincipalCurvatures (*normals_, (*indices_)[idx], nn_indices,
-                                       output.points[idx].principal_curvature[0], output.points[idx].principal_curvature[1], output.points[idx].principal_curvature[2],
-                                       output.points[idx].pc1, output.points[idx].pc2);
+      if (batch.full ())
+        flushBatch (batch, output);
     }
   }
   else
@@ -146,7 +153,8 @@ pcl::PrincipalCurvaturesEstimation<PointInT, PointNT, PointOutT>::computeFeature
     for (std::size_t idx = 0; idx < indices_->size (); ++idx)
     {
       if (!isFinite ((*input_)[(*indices_)[idx]]) ||
-          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0)
+          this->searchForNeighbors ((*indices_)[idx], search_parameter_, nn_indices, nn_dists) == 0 ||
+          !addToBatch (*normals_, (*indices_)[idx], nn_indices, idx, batch))
       {
         output.points[idx].principal_curvature[0] = output.points[idx].principal_curvature[1] = output.points[idx].principal_curvature[2] =
           output.points[idx].pc1 = output.points[idx].pc2 = std::numeric_limits<float>::quiet_NaN ();
@@ -154,12 +162,11 @@ pcl::PrincipalCurvaturesEstimation<PointInT, PointNT, PointOutT>::computeFeature
         continue;
       }
 
-      // Estimate the principal curvatures at each patch
-      computePointPrincipalCurvatures (*normals_, (*indices_)[idx], nn_indices,
-                                       output.points[idx].principal_curvature[0], output.points[idx].principal_curvature[1], output.points[idx].principal_curvature[2],
-                                       output.points[idx].pc1, output.points[idx].pc2);
+      if (batch.full ())
+        flushBatch (batch, output);
     }
   }
+  flushBatch (batch, output);
 }
 
 #define PCL_INSTANTIATE_PrincipalCurvaturesEstimation(T,NT,OutT) template class PCL_EXPORTS pcl::PrincipalCurvaturesEstimation<T,NT,OutT>;
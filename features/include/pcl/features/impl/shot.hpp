@@ -180,6 +180,7 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::initCompute ()
   lrf_estimator->setIndices (indices_);
   if (!fake_surface_)
     lrf_estimator->setSearchSurface(surface_);
+  this->shareSearchNeighborhoods (*lrf_estimator);
 
   if (!FeatureWithLocalReferenceFrames<PointInT, PointRFT>::initLocalReferenceFrames (indices_->size (), lrf_estimator))
   {
@@ -190,6 +191,16 @@ pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::initCompute ()
   return (true);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
+pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::shareSearchNeighborhoods (
+    Feature<PointInT, PointRFT> &lrf_estimator) const
+{
+  if (lrf_estimator.getRadiusSearch () == search_radius_ &&
+      this->getSearchNeighborhoods () && this->getSearchNeighborhoods ()->getSortedResults ())
+    lrf_estimator.setSearchNeighborhoods (this->getSearchNeighborhoods ());
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointNT, typename PointOutT, typename PointRFT> void
 pcl::SHOTEstimationBase<PointInT, PointNT, PointOutT, PointRFT>::createBinDistanceShape (
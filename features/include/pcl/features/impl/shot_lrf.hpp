@@ -164,6 +164,28 @@ pcl::SHOTLocalReferenceFrameEstimation<PointInT, PointOutT>::getLocalRF (const i
   return (0.0f);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointInT, typename PointOutT> bool
+pcl::SHOTLocalReferenceFrameEstimation<PointInT, PointOutT>::initCompute ()
+{
+  if (!Feature<PointInT, PointOutT>::initCompute ())
+  {
+    PCL_ERROR ("[pcl::%s::initCompute] Init failed.\n", getClassName ().c_str ());
+    return (false);
+  }
+
+  // The disambiguation of the axes depends on the order of the neighbors, which have to be sorted by distance
+  if (this->getSearchNeighborhoods () && !this->getSearchNeighborhoods ()->getSortedResults ())
+  {
+    PCL_ERROR (
+      "[pcl::%s::initCompute] Error! The precomputed neighbors are not sorted. Compute them with a search method returning sorted results.\n",
+      getClassName ().c_str ());
+    return (false);
+  }
+
+  return (true);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointInT, typename PointOutT> void
 pcl::SHOTLocalReferenceFrameEstimation<PointInT, PointOutT>::computeFeature (PointCloudOut &output)
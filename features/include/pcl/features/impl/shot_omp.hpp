@@ -73,6 +73,7 @@ pcl::SHOTEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::initCompute ()
 
   if (!fake_surface_)
     lrf_estimator->setSearchSurface(surface_);
+  this->shareSearchNeighborhoods (*lrf_estimator);
 
   if (!FeatureWithLocalReferenceFrames<PointInT, PointRFT>::initLocalReferenceFrames (indices_->size (), lrf_estimator))
   {
@@ -111,6 +112,7 @@ pcl::SHOTColorEstimationOMP<PointInT, PointNT, PointOutT, PointRFT>::initCompute
 
   if (!fake_surface_)
     lrf_estimator->setSearchSurface(surface_);
+  this->shareSearchNeighborhoods (*lrf_estimator);
 
   if (!FeatureWithLocalReferenceFrames<PointInT, PointRFT>::initLocalReferenceFrames (indices_->size (), lrf_estimator))
   {
@@ -123,7 +123,8 @@ namespace pcl
         second_order_integral_image_ (),
         width_ (1), 
         height_ (1), 
-        compute_second_order_integral_images_ (compute_second_order_integral_images)
+        compute_second_order_integral_images_ (compute_second_order_integral_images),
+        threads_ (1)
       {
       }
 
@@ -137,6 +138,14 @@ namespace pcl
       void 
       setSecondOrderComputation (bool compute_second_order_integral_images);
 
+      /** \brief Set the number of threads used to compute the integral images. Every row is summed on its own,
+        * then the rows are added up by tiles of columns. The integral images do not depend on the number of threads,
+        * but can differ by rounding from a I(r-1,c) + I(r,c-1) - I(r-1,c-1) + x recurrence.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /** \brief Set the input data to compute the integral image for
         * \param[in] data the input data
         * \param[in] width the width of the data
@@ -224,6 +233,9 @@ namespace pcl
 
       /** \brief Indicates whether second order integral images are available **/
       bool compute_second_order_integral_images_;
+
+      /** \brief The number of threads used to compute the integral images. */
+      unsigned int threads_;
    };
 
    /**
@@ -248,7 +260,8 @@ namespace pcl
         second_order_integral_image_ (),
         
         width_ (1), height_ (1), 
-        compute_second_order_integral_images_ (compute_second_order_integral_images)
+        compute_second_order_integral_images_ (compute_second_order_integral_images),
+        threads_ (1)
       {
       }
 
@@ -256,6 +269,14 @@ namespace pcl
       virtual
       ~IntegralImage2D () { }
 
+      /** \brief Set the number of threads used to compute the integral images. Every row is summed on its own,
+        * then the rows are added up by tiles of columns. The integral images do not depend on the number of threads,
+        * but can differ by rounding from a I(r-1,c) + I(r,c-1) - I(r-1,c-1) + x recurrence.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
       /** \brief Set the input data to compute the integral image for
         * \param[in] data the input data
         * \param[in] width the width of the data
@@ -343,6 +364,9 @@ namespace pcl
 
       /** \brief Indicates whether second order integral images are available **/
       bool compute_second_order_integral_images_;
+
+      /** \brief The number of threads used to compute the integral images. */
+      unsigned int threads_;
    };
  }
 
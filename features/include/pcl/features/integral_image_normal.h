@@ -115,10 +115,6 @@ namespace pcl
         , integral_image_DY_ (false)
         , integral_image_depth_ (false)
         , integral_image_XYZ_ (true)
-        , diff_x_ (nullptr)
-        , diff_y_ (nullptr)
-        , depth_data_ (nullptr)
-        , distance_map_ (nullptr)
         , use_depth_dependent_smoothing_ (false)
         , max_depth_change_factor_ (20.0f*0.001f)
         , normal_smoothing_size_ (10.0f)
@@ -130,14 +126,26 @@ namespace pcl
         , vpy_ (0.0f)
         , vpz_ (0.0f)
         , use_sensor_origin_ (true)
+        , threads_ (1)
       {
         feature_name_ = "IntegralImagesNormalEstimation";
         tree_.reset ();
         k_ = 1;
       }
 
-      /** \brief Destructor **/
-      ~IntegralImageNormalEstimation ();
+      /** \brief Set the number of threads used to build the integral images and to estimate the normals.
+        * Both are split by rows, so the resulting normals do not depend on the number of threads.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used to build the integral images and to estimate the normals. */
+      inline unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
 
       /** \brief Set the regions size which is considered for normal estimation.
         * \param[in] width the width of the search rectangle
@@ -257,7 +265,7 @@ namespace pcl
       inline float*
       getDistanceMap ()
       {
-        return (distance_map_);
+        return (distance_map_.empty () ? nullptr : distance_map_.data ());
       }
 
       /** \brief Set the viewpoint.
@@ -355,7 +363,7 @@ namespace pcl
       inline void
       flipNormalTowardsViewpoint (const PointInT &point, 
                                   float vp_x, float vp_y, float vp_z,
-                                  float &nx, float &ny, float &nz)
+                                  float &nx, float &ny, float &nz) const
       {
         // See if we need to flip any plane normals
         vp_x -= point.x;
@@ -407,15 +415,12 @@ namespace pcl
       IntegralImage2D<float, 3> integral_image_XYZ_;
 
       /** derivatives in x-direction */
-      float *diff_x_;
+      std::vector<float> diff_x_;
       /** derivatives in y-direction */
-      float *diff_y_;
-
-      /** depth data */
-      float *depth_data_;
+      std::vector<float> diff_y_;
 
       /** distance map */
-      float *distance_map_;
+      std::vector<float> distance_map_;
 
       /** \brief Smooth data based on depth (true/false). */
       bool use_depth_dependent_smoothing_;
@@ -444,6 +449,49 @@ namespace pcl
 
       /** whether the sensor origin of the input cloud or a user given viewpoint should be used.*/
       bool use_sensor_origin_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+      /** \brief Computes the normal at the specified position for a given region size.
+        * \param[in] pos_x x position (pixel)
+        * \param[in] pos_y y position (pixel)
+        * \param[in] point_index the position index of the point
+        * \param[in] rect_width the width of the search rectangle
+        * \param[in] rect_height the height of the search rectangle
+        * \param[out] normal the output estimated normal
+        */
+      void
+      computePointNormal (const int pos_x, const int pos_y, const unsigned point_index,
+                          const int rect_width, const int rect_height, PointOutT &normal) const;
+
+      /** \brief Computes the normal at the specified position for a given region size, with mirroring for border handling.
+        * \param[in] pos_x x position (pixel)
+        * \param[in] pos_y y position (pixel)
+        * \param[in] point_index the position index of the point
+        * \param[in] rect_width the width of the search rectangle
+        * \param[in] rect_height the height of the search rectangle
+        * \param[out] normal the output estimated normal
+        */
+      void
+      computePointNormalMirror (const int pos_x, const int pos_y, const unsigned point_index,
+                                const int rect_width, const int rect_height, PointOutT &normal) const;
+
+      /** \brief Computes the normal at the specified position, with a region size given by the distance map
+        * and the smoothing settings. Does not modify the estimator, so it can be called from several threads.
+        * \param[in] pos_x x position (pixel)
+        * \param[in] pos_y y position (pixel)
+        * \param[in] point_index the position index of the point
+        * \param[in] distance_map distance map
+        * \param[out] normal the output estimated normal
+        */
+      void
+      computeSmoothedPointNormal (const int pos_x, const int pos_y, const unsigned point_index,
+                                  const float *distance_map, PointOutT &normal) const;
+
+      /** \brief Initialize the data structures of the chosen estimation method, if not done yet. */
+      void
+      initMethod ();
       
       /** \brief This method should get called before starting the actual computation. */
       bool
@@ -0,0 +1,207 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/pcl_macros.h>
+#include <pcl/point_cloud.h>
+#include <pcl/types.h> // for Indices
+#include <pcl/common/point_tests.h> // for pcl::isFinite
+
+#include <Eigen/Core>
+
+#include <cstddef>
+#include <vector>
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Instruction sets of the kernels computing the principal components of neighborhoods. */
+    enum class PCAKernel
+    {
+      AUTO,     ///< the widest instruction set supported by the CPU
+      DEFAULT,  ///< one value at a time
+      AVX       ///< eight values at a time
+    };
+
+    /** \brief Return whether the CPU supports the instruction set of a principal components kernel. */
+    PCL_EXPORTS bool
+    isPCAKernelSupported (PCAKernel kernel);
+
+    /** \brief The coordinates of the points of a neighborhood relative to a reference point, stored column-wise.
+      * Reusing the same object for all the neighborhoods of a loop keeps its memory allocated.
+      */
+    struct NeighborhoodCoordinates
+    {
+      /** \brief The number of points. */
+      std::size_t size = 0;
+
+      /** \brief The x coordinates of the points, followed by unused values. */
+      std::vector<float> x;
+      /** \brief The y coordinates of the points, followed by unused values. */
+      std::vector<float> y;
+      /** \brief The z coordinates of the points, followed by unused values. */
+      std::vector<float> z;
+
+      /** \brief Make room for a number of points, keeping the allocated memory.
+        * \param[in] capacity the number of points to make room for
+        */
+      inline void
+      reserve (std::size_t capacity)
+      {
+        if (x.size () >= capacity)
+          return;
+        x.resize (capacity);
+        y.resize (capacity);
+        z.resize (capacity);
+      }
+    };
+
+    /** \brief Gather the coordinates of the indexed points of a cloud relative to a reference point. Taking the
+      * coordinates relative to a point of the neighborhood, usually the query point, keeps the covariance of a
+      * small neighborhood accurate in single precision when it is far away from the origin.
+      * \param[in] cloud the input point cloud
+      * \param[in] indices the indices of the neighborhood in \a cloud
+      * \param[in] origin the reference point
+      * \param[in] check_finite whether to skip the non finite points
+      * \param[out] coordinates the coordinates of the (finite) points, relative to \a origin
+      */
+    template <typename PointT> inline void
+    gatherNeighborhood (const pcl::PointCloud<PointT> &cloud, const Indices &indices, const Eigen::Vector3f &origin,
+                        bool check_finite, NeighborhoodCoordinates &coordinates)
+    {
+      coordinates.reserve (indices.size ());
+      float *x = coordinates.x.data (), *y = coordinates.y.data (), *z = coordinates.z.data ();
+      std::size_t size = 0;
+      for (const auto &index : indices)
+      {
+        const PointT &point = cloud.points[index];
+        if (check_finite && !isFinite (point))
+          continue;
+        x[size] = point.x - origin[0];
+        y[size] = point.y - origin[1];
+        z[size] = point.z - origin[2];
+        ++size;
+      }
+      coordinates.size = size;
+    }
+
+    /** \brief Compute the covariance matrix of the points of a neighborhood, normalized by their number. The
+      * coordinates and their products are accumulated in eight lanes, whose sums are reduced in the same order by
+      * all the kernels, so that they give the same covariance matrices. The coordinates should be relative to a
+      * point of the neighborhood, see gatherNeighborhood ().
+      * \param[in] coordinates the coordinates of the points, which must not be empty
+      * \param[out] covariance_matrix the resultant 3x3 covariance matrix
+      * \param[in] kernel the instruction set to use, falling back to DEFAULT if it is not supported
+      */
+    PCL_EXPORTS void
+    computeNeighborhoodCovariance (const NeighborhoodCoordinates &coordinates, Eigen::Matrix3f &covariance_matrix,
+                                   PCAKernel kernel = PCAKernel::AUTO);
+
+    /** \brief The eigenvector a batch of covariance matrices is solved for. */
+    enum class PCAEigenvector
+    {
+      SMALLEST,  ///< the eigenvector of the smallest eigenvalue, e.g. the normal of a surface patch
+      LARGEST    ///< the eigenvector of the largest eigenvalue, e.g. the direction of the principal curvature
+    };
+
+    /** \brief A batch of 3x3 covariance matrices whose eigenvalues and eigenvector are solved together, eight
+      * matrices at a time in the lanes of the AVX kernel. The matrices are stored as arrays of their unique
+      * coefficients, and tagged with an index chosen by the caller, e.g. the index of the output point.
+      */
+    struct PCABatch
+    {
+      /** \brief The maximal number of matrices in a batch. */
+      static constexpr std::size_t capacity = 16;
+
+      /** \brief The number of matrices in the batch. */
+      std::size_t size = 0;
+
+      /** \brief The unique coefficients of the matrices. */
+      float xx[capacity], xy[capacity], xz[capacity], yy[capacity], yz[capacity], zz[capacity];
+
+      /** \brief The indices the matrices are tagged with. */
+      std::size_t tags[capacity];
+
+      /** \brief The eigenvalues of the matrices, in increasing order. */
+      float eigenvalues[3][capacity];
+
+      /** \brief The coordinates of the requested unit eigenvector of the matrices. */
+      float eigenvector[3][capacity];
+
+      /** \brief Return whether the batch is full. */
+      inline bool
+      full () const
+      {
+        return (size == capacity);
+      }
+
+      /** \brief Add a symmetric matrix to the batch, which must not be full.
+        * \param[in] matrix the matrix to add
+        * \param[in] tag the index the matrix is tagged with
+        */
+      inline void
+      push_back (const Eigen::Matrix3f &matrix, std::size_t tag)
+      {
+        xx[size] = matrix.coeff (0, 0);
+        xy[size] = matrix.coeff (0, 1);
+        xz[size] = matrix.coeff (0, 2);
+        yy[size] = matrix.coeff (1, 1);
+        yz[size] = matrix.coeff (1, 2);
+        zz[size] = matrix.coeff (2, 2);
+        tags[size] = tag;
+        ++size;
+      }
+    };
+
+    /** \brief Solve the eigenvalues and one eigenvector of the symmetric positive semi-definite matrices of a batch.
+      * The smallest eigenvalue is found by Newton iterations on the characteristic polynomial, which converge
+      * monotonically from 0, and the two others by deflation. The matrices whose iterations do not converge, e.g.
+      * those with three close eigenvalues, are solved with the closed form of pcl::computeRoots () instead. The
+      * eigenvector is the largest cross product of two rows of the matrix minus its eigenvalue, as pcl::eigen33 ()
+      * computes it.
+      * \param[in,out] batch the batch, whose eigenvalues and eigenvector are set
+      * \param[in] eigenvector the eigenvector to compute
+      * \param[in] kernel the instruction set to use, falling back to DEFAULT if it is not supported
+      * \note All kernels compute the eigenvalues and eigenvectors with the same floating point operations, so
+      * they give the same results.
+      */
+    PCL_EXPORTS void
+    solvePCABatch (PCABatch &batch, PCAEigenvector eigenvector, PCAKernel kernel = PCAKernel::AUTO);
+  }
+}
@@ -43,6 +43,7 @@
 #include <pcl/memory.h>
 #include <pcl/pcl_macros.h>
 #include <pcl/features/feature.h>
+#include <pcl/features/neighborhood_pca.h>
 #include <pcl/common/centroid.h>
 
 namespace pcl
@@ -401,6 +402,25 @@ namespace pcl
       void
       computeFeature (PointCloudOut &output) override;
 
+      /** \brief Gather a neighborhood around the idx-th point given in <setInputCloud (), setIndices ()>, and add its
+        * covariance matrix to a batch, tagged with \a idx.
+        * \param[in] idx the index of the query point in indices_ and of its output point
+        * \param[in] nn_indices the indices of the neighborhood in the surface
+        * \param[out] coordinates the buffer the neighborhood is gathered into
+        * \param[in,out] batch the batch to add the covariance matrix to, which must not be full
+        * \return false if the neighborhood has less than 3 points or no finite point
+        */
+      bool
+      addToBatch (std::size_t idx, const std::vector<int> &nn_indices,
+                  detail::NeighborhoodCoordinates &coordinates, detail::PCABatch &batch) const;
+
+      /** \brief Solve a batch, write the normals and curvatures of its output points, and empty it.
+        * \param[in,out] batch the batch to solve
+        * \param[out] output the resultant point cloud model dataset that contains surface normals and curvatures
+        */
+      void
+      flushBatch (detail::PCABatch &batch, PointCloudOut &output) const;
+
       /** \brief Values describing the viewpoint ("pinhole" camera model assumed). For per point viewpoints, inherit
         * from NormalEstimation and provide your own computeFeature (). By default, the viewpoint is set to 0,0,0. */
       float vpx_, vpy_, vpz_;
@@ -67,6 +67,26 @@ namespace pcl
                        const Eigen::Vector4f &p2, const Eigen::Vector4f &n2, 
                        float &f1, float &f2, float &f3, float &f4);
 
+  /** \brief Compute the three angular features of the pairs made by one point and each point of a batch, as
+    * computePairFeatures () does for a single pair. The pairs are computed eight at a time with AVX when the CPU
+    * supports it, which gives the same features as the scalar fallback. The batch is stored column-wise (one
+    * coordinate of all the points per column), and the arctangent of f1 is approximated by a polynomial with an
+    * absolute error below 1e-5 radians.
+    * \param[in] p1 the first XYZ point, shared by all the pairs
+    * \param[in] n1 the first surface normal, shared by all the pairs
+    * \param[in] points_normals the second XYZ points and surface normals, one per row as (x, y, z, nx, ny, nz)
+    * \param[out] features the (f1, f2, f3) angular features of each pair, one per row. They are set to 0 when the
+    * points coincide or when the normal of the Darboux frame is parallel to the line joining the points, like the
+    * single pair version does.
+    *
+    * \note For efficiency reasons, we assume that the point data passed to the method is finite.
+    * \ingroup features
+    */
+  PCL_EXPORTS void
+  computePairFeatures (const Eigen::Vector4f &p1, const Eigen::Vector4f &n1,
+                       const Eigen::Ref<const Eigen::Matrix<float, Eigen::Dynamic, 6> > &points_normals,
+                       Eigen::Ref<Eigen::Matrix<float, Eigen::Dynamic, 3> > features);
+
   PCL_EXPORTS bool
   computeRGBPairFeatures (const Eigen::Vector4f &p1, const Eigen::Vector4f &n1, const Eigen::Vector4i &colors1,
                           const Eigen::Vector4f &p2, const Eigen::Vector4f &n2, const Eigen::Vector4i &colors2,
@@ -0,0 +1,326 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/memory.h>
+#include <pcl/pcl_base.h>
+#include <pcl/point_cloud.h>
+#include <pcl/console/print.h>
+#include <pcl/search/kdtree.h>
+#include <pcl/search/neighborhoods.h>
+#include <pcl/search/organized.h>
+
+#include <limits>
+
+namespace pcl
+{
+  /** \brief PrecomputedNeighborhoods searches the neighbors of a set of points once, in parallel,
+    * so that several feature estimators working on the same points with the same search parameter
+    * can share them instead of each redoing the same searches.
+    *
+    * The neighbors are stored in compressed sparse row format (see pcl::search::Neighborhoods) and
+    * looked up by the index of the query point in the input cloud. They are passed to any number of
+    * estimators with Feature::setSearchNeighborhoods (), which have to use the same input cloud,
+    * search surface and search parameter. Searches for points that are not covered still go through
+    * the search method of the estimator. Changing the input cloud, the search method or the search
+    * parameter discards the neighbors, until compute () is called again.
+    *
+    * \code
+    * pcl::PrecomputedNeighborhoods<pcl::PointXYZ>::Ptr neighborhoods (new pcl::PrecomputedNeighborhoods<pcl::PointXYZ>);
+    * neighborhoods->setInputCloud (cloud);
+    * neighborhoods->setRadiusSearch (0.03);
+    * neighborhoods->compute ();
+    *
+    * pcl::NormalEstimationOMP<pcl::PointXYZ, pcl::Normal> ne;
+    * ne.setInputCloud (cloud);
+    * ne.setRadiusSearch (0.03);
+    * ne.setSearchNeighborhoods (neighborhoods);
+    * ne.compute (*normals);
+    * \endcode
+    * \ingroup features
+    */
+  template <typename PointT>
+  class PrecomputedNeighborhoods
+  {
+    public:
+      using Ptr = shared_ptr<PrecomputedNeighborhoods<PointT> >;
+      using ConstPtr = shared_ptr<const PrecomputedNeighborhoods<PointT> >;
+
+      using PointCloud = pcl::PointCloud<PointT>;
+      using PointCloudConstPtr = typename PointCloud::ConstPtr;
+
+      using SearchMethod = pcl::search::Search<PointT>;
+      using SearchMethodPtr = typename SearchMethod::Ptr;
+
+      /** \brief Constructor.
+        * \param[in] nr_threads the number of threads to use for the searches (0 sets the value to the number of processors)
+        */
+      PrecomputedNeighborhoods (unsigned int nr_threads = 0) : k_ (0), search_radius_ (0), threads_ (nr_threads), sorted_results_ (false) {}
+
+      /** \brief Provide a pointer to the input cloud holding the query points, and optionally to the indices
+        * of the query points. If no indices are given, the neighbors of all the points are searched.
+        * \param[in] cloud the input point cloud
+        * \param[in] indices the indices of the query points in \a cloud
+        */
+      inline void
+      setInputCloud (const PointCloudConstPtr &cloud, const IndicesConstPtr &indices = IndicesConstPtr ())
+      {
+        input_ = cloud;
+        indices_ = indices;
+        clear ();
+      }
+
+      /** \brief Get a pointer to the input point cloud. */
+      inline PointCloudConstPtr
+      getInputCloud () const
+      {
+        return (input_);
+      }
+
+      /** \brief Get a pointer to the indices of the query points (null if all the points are queried). */
+      inline IndicesConstPtr
+      getIndices () const
+      {
+        return (indices_);
+      }
+
+      /** \brief Provide a pointer to the search object. Its input cloud is the search surface; if it has none,
+        * the input cloud is used. If no search object is given, a default one is created over the input cloud.
+        * \param[in] tree a pointer to the spatial search object
+        */
+      inline void
+      setSearchMethod (const SearchMethodPtr &tree)
+      {
+        tree_ = tree;
+        clear ();
+      }
+
+      /** \brief Get a pointer to the search method used. */
+      inline SearchMethodPtr
+      getSearchMethod () const
+      {
+        return (tree_);
+      }
+
+      /** \brief Get a pointer to the surface point cloud the neighbors were searched in, by the last call to
+        * compute () (null if the neighbors have not been computed).
+        */
+      inline PointCloudConstPtr
+      getSearchSurface () const
+      {
+        return (surface_);
+      }
+
+      /** \brief Check whether the neighbors of each point are sorted by increasing distance, as returned by the
+        * search method during the last call to compute ().
+        */
+      inline bool
+      getSortedResults () const
+      {
+        return (sorted_results_);
+      }
+
+      /** \brief Set the number of k nearest neighbors to search for.
+        * \param[in] k the number of k-nearest neighbors
+        */
+      inline void
+      setKSearch (int k)
+      {
+        k_ = k;
+        clear ();
+      }
+
+      /** \brief Get the number of k nearest neighbors to search for. */
+      inline int
+      getKSearch () const
+      {
+        return (k_);
+      }
+
+      /** \brief Set the sphere radius used to search for the neighbors.
+        * \param[in] radius the sphere radius used as the maximum distance to consider a point a neighbor
+        */
+      inline void
+      setRadiusSearch (double radius)
+      {
+        search_radius_ = radius;
+        clear ();
+      }
+
+      /** \brief Get the sphere radius used to search for the neighbors. */
+      inline double
+      getRadiusSearch () const
+      {
+        return (search_radius_);
+      }
+
+      /** \brief Initialize the scheduler and set the number of threads to use.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0)
+      {
+        threads_ = nr_threads;
+      }
+
+      /** \brief Search the neighbors of all the query points.
+        * \return false if the input cloud or the search parameter are not set properly
+        */
+      bool
+      compute ()
+      {
+        clear ();
+        if (!input_)
+        {
+          PCL_ERROR ("[pcl::PrecomputedNeighborhoods::compute] No input cloud given!\n");
+          return (false);
+        }
+        if ((k_ != 0) == (search_radius_ != 0.0))
+        {
+          PCL_ERROR ("[pcl::PrecomputedNeighborhoods::compute] Set exactly one of the radius (%f) and K (%d)!\n", search_radius_, k_);
+          return (false);
+        }
+
+        if (!tree_)
+        {
+          if (input_->isOrganized ())
+            tree_.reset (new pcl::search::OrganizedNeighbor<PointT> ());
+          else
+            tree_.reset (new pcl::search::KdTree<PointT> (false));
+        }
+        if (!tree_->getInputCloud ())
+          tree_->setInputCloud (input_);
+        // The search method may be shared with the estimators, which can change its input cloud afterwards
+        surface_ = tree_->getInputCloud ();
+        sorted_results_ = tree_->getSortedResults ();
+
+        // An empty set of indices would mean all the points to the batched searches
+        if (indices_ && indices_->empty ())
+          return (true);
+
+        const Indices all_points;
+        const Indices &queries = indices_ ? *indices_ : all_points;
+        if (k_ != 0)
+          tree_->nearestKSearch (*input_, queries, k_, neighborhoods_, threads_);
+        else
+          tree_->radiusSearch (*input_, queries, search_radius_, neighborhoods_, 0, threads_);
+
+        // Map the input points to their query; when no indices are given, the query is the point index itself
+        if (indices_)
+        {
+          rows_.assign (input_->size (), std::numeric_limits<std::size_t>::max ());
+          for (std::size_t row = 0; row < indices_->size (); ++row)
+            rows_[(*indices_)[row]] = row;
+        }
+        return (true);
+      }
+
+      /** \brief Check whether the neighbors of a point of the input cloud have been searched.
+        * \param[in] index the index of the point in the input cloud
+        */
+      inline bool
+      hasNeighbors (std::size_t index) const
+      {
+        if (indices_)
+          return (index < rows_.size () && rows_[index] != std::numeric_limits<std::size_t>::max ());
+        return (index < neighborhoods_.size ());
+      }
+
+      /** \brief Copy the neighbors of a point of the input cloud, as returned by the single query search methods.
+        * \param[in] index the index of the point in the input cloud, for which hasNeighbors () has to be true
+        * \param[out] k_indices the indices of the neighbors in the search surface
+        * \param[out] k_sqr_distances the squared distances of the neighbors
+        * \return the number of neighbors of the point
+        */
+      inline int
+      getNeighbors (std::size_t index, Indices &k_indices, std::vector<float> &k_sqr_distances) const
+      {
+        return (neighborhoods_.getNeighbors (indices_ ? rows_[index] : index, k_indices, k_sqr_distances));
+      }
+
+      /** \brief Get the neighbors of all the query points, in the order of the query indices. */
+      inline const pcl::search::Neighborhoods&
+      getNeighborhoods () const
+      {
+        return (neighborhoods_);
+      }
+
+    private:
+      /** \brief Discard the computed neighbors. */
+      inline void
+      clear ()
+      {
+        neighborhoods_.clear ();
+        rows_.clear ();
+        surface_.reset ();
+        sorted_results_ = false;
+      }
+
+      /** \brief The input point cloud holding the query points. */
+      PointCloudConstPtr input_;
+
+      /** \brief The indices of the query points in \a input_. */
+      IndicesConstPtr indices_;
+
+      /** \brief A pointer to the spatial search object. */
+      SearchMethodPtr tree_;
+
+      /** \brief The surface point cloud the neighbors were searched in. */
+      PointCloudConstPtr surface_;
+
+      /** \brief The number of K nearest neighbors to search for. */
+      int k_;
+
+      /** \brief The sphere radius used to search for the neighbors. */
+      double search_radius_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
+      /** \brief Whether the neighbors were sorted by increasing distance. */
+      bool sorted_results_;
+
+      /** \brief The neighbors of the query points. */
+      pcl::search::Neighborhoods neighborhoods_;
+
+      /** \brief The query of each point of \a input_, or the maximum value if it is not queried (only used when
+        * query indices are given).
+        */
+      std::vector<std::size_t> rows_;
+  };
+}
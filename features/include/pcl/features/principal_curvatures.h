@@ -42,6 +42,7 @@
 
 #include <pcl/features/eigen.h>
 #include <pcl/features/feature.h>
+#include <pcl/features/neighborhood_pca.h>
 
 namespace pcl
 {
@@ -75,12 +76,7 @@ namespace pcl
       using PointCloudIn = pcl::PointCloud<PointInT>;
 
       /** \brief Empty constructor. */
-      PrincipalCurvaturesEstimation () : 
-        xyz_centroid_ (Eigen::Vector3f::Zero ()), 
-        demean_ (Eigen::Vector3f::Zero ()),
-        covariance_matrix_ (Eigen::Matrix3f::Zero ()),
-        eigenvector_ (Eigen::Vector3f::Zero ()),
-        eigenvalues_ (Eigen::Vector3f::Zero ())
+      PrincipalCurvaturesEstimation ()
       {
         feature_name_ = "PrincipalCurvaturesEstimation";
       };
@@ -112,23 +108,29 @@ namespace pcl
       void
       computeFeature (PointCloudOut &output) override;
 
-    private:
-      /** \brief A pointer to the input dataset that contains the point normals of the XYZ dataset. */
-      std::vector<Eigen::Vector3f, Eigen::aligned_allocator<Eigen::Vector3f> > projected_normals_;
-
-      /** \brief SSE aligned placeholder for the XYZ centroid of a surface patch. */
-      Eigen::Vector3f xyz_centroid_;
-
-      /** \brief Temporary point placeholder. */
-      Eigen::Vector3f demean_;
+      /** \brief Project the normals of a surface patch in the tangent plane of the given point normal, and add their
+        * covariance matrix to a batch, tagged with \a tag.
+        * \param[in] normals the point cloud normals
+        * \param[in] p_idx the query point at which the least-squares plane was estimated
+        * \param[in] indices the point cloud indices that need to be used
+        * \param[in] tag the index the covariance matrix is tagged with
+        * \param[in,out] batch the batch to add the covariance matrix to, which must not be full
+        * \return false if \a indices is empty
+        */
+      bool
+      addToBatch (const pcl::PointCloud<PointNT> &normals, int p_idx, const std::vector<int> &indices,
+                  std::size_t tag, detail::PCABatch &batch);
 
-      /** \brief Placeholder for the 3x3 covariance matrix at each surface patch. */
-      EIGEN_ALIGN16 Eigen::Matrix3f covariance_matrix_;
+      /** \brief Solve a batch, write the principal curvatures of its output points, and empty it.
+        * \param[in,out] batch the batch to solve
+        * \param[out] output the resultant point cloud model dataset that contains the principal curvature estimates
+        */
+      void
+      flushBatch (detail::PCABatch &batch, PointCloudOut &output) const;
 
-      /** \brief SSE aligned eigenvectors placeholder for a covariance matrix. */
-      Eigen::Vector3f eigenvector_;
-      /** \brief eigenvalues placeholder for a covariance matrix. */
-      Eigen::Vector3f eigenvalues_;
+    private:
+      /** \brief The normals of a surface patch projected in the tangent plane of its query point. */
+      detail::NeighborhoodCoordinates projected_normals_;
   };
 }
 
@@ -131,6 +131,13 @@ namespace pcl
       bool
       initCompute () override;
 
+      /** \brief Share the precomputed neighbors with the local reference frame estimator, if it searches with the
+        * same radius and the neighbors are sorted by distance, as the disambiguation of the frame axes requires.
+        * \param[in] lrf_estimator the local reference frame estimator
+        */
+      void
+      shareSearchNeighborhoods (Feature<PointInT, PointRFT> &lrf_estimator) const;
+
       /** \brief Quadrilinear interpolation used when color and shape descriptions are NOT activated simultaneously
         *
         * \param[in] indices the neighborhood point indices
@@ -96,6 +96,10 @@ namespace pcl
       float
       getLocalRF (const int &index, Eigen::Matrix3f &rf);
 
+      /** \brief This method should get called before starting the actual computation. */
+      bool
+      initCompute () override;
+
       /** \brief Feature estimation method.
         * \param[out] output the resultant features
         */
@@ -0,0 +1,447 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/features/neighborhood_pca.h>
+#include <pcl/common/eigen.h> // for pcl::computeRoots
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+// The AVX kernels are compiled for their instruction set regardless of the build flags,
+// and selected at runtime according to the CPU
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PCL_PCA_KERNELS_DISPATCH 1
+// This file is built with -ffp-contract=off, so that all the kernels compute the same results
+#define PCL_PCA_KERNELS_TARGET(isa) __attribute__ ((target (isa)))
+#include <immintrin.h>
+#endif
+
+namespace
+{
+  using pcl::detail::PCABatch;
+  using pcl::detail::PCAEigenvector;
+  using pcl::detail::PCAKernel;
+
+  /** \brief The number of lanes the sums and the batches are computed in. */
+  constexpr std::size_t lanes = 8;
+
+  /** \brief The maximal number of Newton iterations for the smallest eigenvalue. */
+  constexpr int max_iterations = 12;
+
+  /** \brief The relative step below which the Newton iterations have converged. */
+  constexpr float relative_step = 1e-6f;
+
+  /** \brief Reduce the sums of the eight lanes, in the same order for all the kernels. */
+  inline float
+  reduceLanes (const float *sums)
+  {
+    return (((sums[0] + sums[1]) + (sums[2] + sums[3])) + ((sums[4] + sums[5]) + (sums[6] + sums[7])));
+  }
+
+  /** \brief Select the kernel to use. */
+  inline PCAKernel
+  selectKernel (PCAKernel kernel)
+  {
+    if (kernel == PCAKernel::AUTO)
+    {
+      static const PCAKernel best_kernel =
+        pcl::detail::isPCAKernelSupported (PCAKernel::AVX) ? PCAKernel::AVX : PCAKernel::DEFAULT;
+      return (best_kernel);
+    }
+    if (!pcl::detail::isPCAKernelSupported (kernel))
+      return (PCAKernel::DEFAULT);
+    return (kernel);
+  }
+
+  /** \brief Set a covariance matrix from the means of the coordinates x, y, z and of their products xx, xy, xz,
+    * yy, yz and zz.
+    */
+  inline void
+  setCovarianceMatrix (const float *means, Eigen::Matrix3f &covariance_matrix)
+  {
+    covariance_matrix.coeffRef (0, 0) = means[3] - means[0] * means[0];
+    covariance_matrix.coeffRef (0, 1) = covariance_matrix.coeffRef (1, 0) = means[4] - means[0] * means[1];
+    covariance_matrix.coeffRef (0, 2) = covariance_matrix.coeffRef (2, 0) = means[5] - means[0] * means[2];
+    covariance_matrix.coeffRef (1, 1) = means[6] - means[1] * means[1];
+    covariance_matrix.coeffRef (1, 2) = covariance_matrix.coeffRef (2, 1) = means[7] - means[1] * means[2];
+    covariance_matrix.coeffRef (2, 2) = means[8] - means[2] * means[2];
+  }
+
+  /** \brief Compute the covariance matrix of a neighborhood, one point at a time. */
+  void
+  computeCovarianceDefault (const pcl::detail::NeighborhoodCoordinates &coordinates, Eigen::Matrix3f &covariance_matrix)
+  {
+    const std::size_t size = coordinates.size;
+    const float *x = coordinates.x.data (), *y = coordinates.y.data (), *z = coordinates.z.data ();
+
+    // The sums of x, y, z, xx, xy, xz, yy, yz and zz
+    float sums[9][lanes] = {};
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      const std::size_t lane = i % lanes;
+      sums[0][lane] += x[i];
+      sums[1][lane] += y[i];
+      sums[2][lane] += z[i];
+      sums[3][lane] += x[i] * x[i];
+      sums[4][lane] += x[i] * y[i];
+      sums[5][lane] += x[i] * z[i];
+      sums[6][lane] += y[i] * y[i];
+      sums[7][lane] += y[i] * z[i];
+      sums[8][lane] += z[i] * z[i];
+    }
+    const float n = static_cast<float> (size);
+    float means[9];
+    for (std::size_t j = 0; j < 9; ++j)
+      means[j] = reduceLanes (sums[j]) / n;
+    setCovarianceMatrix (means, covariance_matrix);
+  }
+
+  /** \brief Return the larger of two values, in the same way as _mm256_max_ps (). */
+  inline float
+  maxDefault (float a, float b)
+  {
+    return (a > b ? a : b);
+  }
+
+  /** \brief Solve the i-th matrix of a batch. */
+  void
+  solveDefault (PCABatch &batch, std::size_t i, PCAEigenvector eigenvector)
+  {
+    const float max_abs = maxDefault (maxDefault (maxDefault (std::abs (batch.xx[i]), std::abs (batch.xy[i])),
+                                                  maxDefault (std::abs (batch.xz[i]), std::abs (batch.yy[i]))),
+                                      maxDefault (std::abs (batch.yz[i]), std::abs (batch.zz[i])));
+    const float scale = max_abs <= std::numeric_limits<float>::min () ? 1.0f : max_abs;
+    const float xx = batch.xx[i] / scale, xy = batch.xy[i] / scale, xz = batch.xz[i] / scale;
+    const float yy = batch.yy[i] / scale, yz = batch.yz[i] / scale, zz = batch.zz[i] / scale;
+
+    // The characteristic polynomial is x^3 - c2*x^2 + c1*x - c0, as in pcl::computeRoots ()
+    const float c0 = xx * yy * zz + 2.0f * xy * xz * yz - xx * yz * yz - yy * xz * xz - zz * xy * xy;
+    const float c1 = xx * yy - xy * xy + xx * zz - xz * xz + yy * zz - yz * yz;
+    const float c2 = xx + yy + zz;
+
+    // The polynomial is increasing and concave between 0 and its smallest root, where Newton converges from below
+    float lambda = 0.0f;
+    bool converged = !(c0 >= std::numeric_limits<float>::epsilon ());
+    for (int iteration = 0; iteration < max_iterations && !converged; ++iteration)
+    {
+      const float f = ((lambda - c2) * lambda + c1) * lambda - c0;
+      if (f >= 0.0f)
+      {
+        converged = true;
+        break;
+      }
+      const float df = (3.0f * lambda - 2.0f * c2) * lambda + c1;
+      if (!(df > 0.0f))
+        break;
+      const float step = -f / df;
+      lambda = lambda + step;
+      if (step <= relative_step * lambda)
+        converged = true;
+    }
+
+    float e0, e1, e2;
+    if (converged)
+    {
+      // Deflate the polynomial to the quadratic of the two other roots, as pcl::computeRoots2 () solves it
+      const float s = c2 - lambda;
+      const float p = c1 - lambda * s;
+      const float sd = std::sqrt (maxDefault (s * s - 4.0f * p, 0.0f));
+      const float r1 = 0.5f * (s - sd);
+      e0 = r1 < lambda ? r1 : lambda;
+      e1 = r1 < lambda ? lambda : r1;
+      e2 = 0.5f * (s + sd);
+    }
+    else
+    {
+      Eigen::Matrix3f matrix;
+      matrix << xx, xy, xz, xy, yy, yz, xz, yz, zz;
+      Eigen::Vector3f roots;
+      pcl::computeRoots (matrix, roots);
+      e0 = roots[0];
+      e1 = roots[1];
+      e2 = roots[2];
+    }
+
+    // The eigenvector is orthogonal to the rows of the matrix minus its eigenvalue
+    const float value = eigenvector == PCAEigenvector::SMALLEST ? e0 : e2;
+    const float r0x = xx - value, r0y = xy, r0z = xz;
+    const float r1x = xy, r1y = yy - value, r1z = yz;
+    const float r2x = xz, r2y = yz, r2z = zz - value;
+    float vx = r0y * r1z - r0z * r1y, vy = r0z * r1x - r0x * r1z, vz = r0x * r1y - r0y * r1x;
+    float length = (vx * vx + vy * vy) + vz * vz;
+    const float ux = r0y * r2z - r0z * r2y, uy = r0z * r2x - r0x * r2z, uz = r0x * r2y - r0y * r2x;
+    const float u_length = (ux * ux + uy * uy) + uz * uz;
+    if (u_length > length)
+    {
+      vx = ux; vy = uy; vz = uz;
+      length = u_length;
+    }
+    const float wx = r1y * r2z - r1z * r2y, wy = r1z * r2x - r1x * r2z, wz = r1x * r2y - r1y * r2x;
+    const float w_length = (wx * wx + wy * wy) + wz * wz;
+    if (w_length > length)
+    {
+      vx = wx; vy = wy; vz = wz;
+      length = w_length;
+    }
+    const float norm = std::sqrt (length);
+
+    batch.eigenvalues[0][i] = e0 * scale;
+    batch.eigenvalues[1][i] = e1 * scale;
+    batch.eigenvalues[2][i] = e2 * scale;
+    batch.eigenvector[0][i] = vx / norm;
+    batch.eigenvector[1][i] = vy / norm;
+    batch.eigenvector[2][i] = vz / norm;
+  }
+
+#ifdef PCL_PCA_KERNELS_DISPATCH
+  /** \brief Get the mask of the first \a count lanes, for the loads of the last points. */
+  PCL_PCA_KERNELS_TARGET ("avx") inline __m256i
+  headMaskAVX (std::size_t count)
+  {
+    static const std::int32_t masks[2 * lanes] = {-1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0};
+    return (_mm256_loadu_si256 (reinterpret_cast<const __m256i*> (masks + lanes - count)));
+  }
+
+  /** \brief Reduce the lanes of four sums at once, in the same order as reduceLanes (). */
+  PCL_PCA_KERNELS_TARGET ("avx") inline __m128
+  reduceAVX (__m256 a, __m256 b, __m256 c, __m256 d)
+  {
+    const __m256 sums = _mm256_hadd_ps (_mm256_hadd_ps (a, b), _mm256_hadd_ps (c, d));
+    return (_mm_add_ps (_mm256_castps256_ps128 (sums), _mm256_extractf128_ps (sums, 1)));
+  }
+
+  /** \brief The sums of the coordinates x, y, z and of their products xx, xy, xz, yy, yz and zz in eight lanes. */
+  struct SumsAVX
+  {
+    __m256 x, y, z, xx, xy, xz, yy, yz, zz;
+  };
+
+  /** \brief Add the coordinates of eight points and their products to their sums. */
+  PCL_PCA_KERNELS_TARGET ("avx") inline void
+  accumulateAVX (__m256 x, __m256 y, __m256 z, SumsAVX &sums)
+  {
+    sums.x = _mm256_add_ps (sums.x, x);
+    sums.y = _mm256_add_ps (sums.y, y);
+    sums.z = _mm256_add_ps (sums.z, z);
+    sums.xx = _mm256_add_ps (sums.xx, _mm256_mul_ps (x, x));
+    sums.xy = _mm256_add_ps (sums.xy, _mm256_mul_ps (x, y));
+    sums.xz = _mm256_add_ps (sums.xz, _mm256_mul_ps (x, z));
+    sums.yy = _mm256_add_ps (sums.yy, _mm256_mul_ps (y, y));
+    sums.yz = _mm256_add_ps (sums.yz, _mm256_mul_ps (y, z));
+    sums.zz = _mm256_add_ps (sums.zz, _mm256_mul_ps (z, z));
+  }
+
+  /** \brief Compute the covariance matrix of a neighborhood, eight points at a time with AVX. */
+  PCL_PCA_KERNELS_TARGET ("avx") void
+  computeCovarianceAVX (const pcl::detail::NeighborhoodCoordinates &coordinates, Eigen::Matrix3f &covariance_matrix)
+  {
+    const std::size_t size = coordinates.size;
+    const float *x = coordinates.x.data (), *y = coordinates.y.data (), *z = coordinates.z.data ();
+    const std::size_t head = size - size % lanes;
+
+    const __m256 zero = _mm256_setzero_ps ();
+    SumsAVX sums {zero, zero, zero, zero, zero, zero, zero, zero, zero};
+    for (std::size_t i = 0; i < head; i += lanes)
+      accumulateAVX (_mm256_loadu_ps (x + i), _mm256_loadu_ps (y + i), _mm256_loadu_ps (z + i), sums);
+    if (head != size)
+    {
+      // The missing points of the last lanes are loaded as zeros, which leaves the sums unchanged
+      const __m256i mask = headMaskAVX (size % lanes);
+      accumulateAVX (_mm256_maskload_ps (x + head, mask), _mm256_maskload_ps (y + head, mask),
+                     _mm256_maskload_ps (z + head, mask), sums);
+    }
+
+    const __m128 n = _mm_set1_ps (static_cast<float> (size));
+    float means[12];
+    _mm_storeu_ps (means, _mm_div_ps (reduceAVX (sums.x, sums.y, sums.z, sums.xx), n));
+    _mm_storeu_ps (means + 4, _mm_div_ps (reduceAVX (sums.xy, sums.xz, sums.yy, sums.yz), n));
+    _mm_storeu_ps (means + 8, _mm_div_ps (reduceAVX (sums.zz, sums.zz, sums.zz, sums.zz), n));
+    setCovarianceMatrix (means, covariance_matrix);
+  }
+
+  PCL_PCA_KERNELS_TARGET ("avx") inline __m256
+  absAVX (__m256 v)
+  {
+    return (_mm256_andnot_ps (_mm256_set1_ps (-0.0f), v));
+  }
+
+  /** \brief The cross product of two vectors, and its squared norm. */
+  PCL_PCA_KERNELS_TARGET ("avx") inline void
+  crossAVX (__m256 ax, __m256 ay, __m256 az, __m256 bx, __m256 by, __m256 bz,
+            __m256 &cx, __m256 &cy, __m256 &cz, __m256 &sqr_norm)
+  {
+    cx = _mm256_sub_ps (_mm256_mul_ps (ay, bz), _mm256_mul_ps (az, by));
+    cy = _mm256_sub_ps (_mm256_mul_ps (az, bx), _mm256_mul_ps (ax, bz));
+    cz = _mm256_sub_ps (_mm256_mul_ps (ax, by), _mm256_mul_ps (ay, bx));
+    sqr_norm = _mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (cx, cx), _mm256_mul_ps (cy, cy)), _mm256_mul_ps (cz, cz));
+  }
+
+  /** \brief Solve the eight matrices of a batch from \a i on with AVX. The matrices whose Newton iterations do not
+    * converge are solved again by the default kernel, which falls back to the closed form.
+    */
+  PCL_PCA_KERNELS_TARGET ("avx") void
+  solveAVX (PCABatch &batch, std::size_t i, PCAEigenvector eigenvector)
+  {
+    const __m256 axx = _mm256_loadu_ps (batch.xx + i), axy = _mm256_loadu_ps (batch.xy + i);
+    const __m256 axz = _mm256_loadu_ps (batch.xz + i), ayy = _mm256_loadu_ps (batch.yy + i);
+    const __m256 ayz = _mm256_loadu_ps (batch.yz + i), azz = _mm256_loadu_ps (batch.zz + i);
+    // _mm256_max_ps (a, b) and _mm256_min_ps (a, b) return a > b ? a : b and a < b ? a : b, like the default kernel
+    const __m256 max_abs = _mm256_max_ps (_mm256_max_ps (_mm256_max_ps (absAVX (axx), absAVX (axy)),
+                                                         _mm256_max_ps (absAVX (axz), absAVX (ayy))),
+                                          _mm256_max_ps (absAVX (ayz), absAVX (azz)));
+    const __m256 scale = _mm256_blendv_ps (max_abs, _mm256_set1_ps (1.0f),
+                                           _mm256_cmp_ps (max_abs, _mm256_set1_ps (std::numeric_limits<float>::min ()), _CMP_LE_OQ));
+    const __m256 xx = _mm256_div_ps (axx, scale), xy = _mm256_div_ps (axy, scale), xz = _mm256_div_ps (axz, scale);
+    const __m256 yy = _mm256_div_ps (ayy, scale), yz = _mm256_div_ps (ayz, scale), zz = _mm256_div_ps (azz, scale);
+
+    const __m256 c0 = _mm256_sub_ps (_mm256_sub_ps (_mm256_sub_ps (
+                        _mm256_add_ps (_mm256_mul_ps (_mm256_mul_ps (xx, yy), zz),
+                                       _mm256_mul_ps (_mm256_mul_ps (_mm256_mul_ps (_mm256_set1_ps (2.0f), xy), xz), yz)),
+                        _mm256_mul_ps (_mm256_mul_ps (xx, yz), yz)),
+                        _mm256_mul_ps (_mm256_mul_ps (yy, xz), xz)),
+                        _mm256_mul_ps (_mm256_mul_ps (zz, xy), xy));
+    const __m256 c1 = _mm256_sub_ps (_mm256_add_ps (_mm256_sub_ps (_mm256_add_ps (_mm256_sub_ps (
+                        _mm256_mul_ps (xx, yy), _mm256_mul_ps (xy, xy)),
+                        _mm256_mul_ps (xx, zz)), _mm256_mul_ps (xz, xz)),
+                        _mm256_mul_ps (yy, zz)), _mm256_mul_ps (yz, yz));
+    const __m256 c2 = _mm256_add_ps (_mm256_add_ps (xx, yy), zz);
+
+    const __m256 zero = _mm256_setzero_ps ();
+    __m256 lambda = zero;
+    __m256 active = _mm256_cmp_ps (c0, _mm256_set1_ps (std::numeric_limits<float>::epsilon ()), _CMP_GE_OQ);
+    __m256 failed = zero;
+    for (int iteration = 0; iteration < max_iterations && _mm256_movemask_ps (active) != 0; ++iteration)
+    {
+      const __m256 f = _mm256_sub_ps (_mm256_mul_ps (_mm256_add_ps (_mm256_mul_ps (_mm256_sub_ps (lambda, c2), lambda), c1), lambda), c0);
+      active = _mm256_andnot_ps (_mm256_cmp_ps (f, zero, _CMP_GE_OQ), active);
+      const __m256 df = _mm256_add_ps (_mm256_mul_ps (_mm256_sub_ps (_mm256_mul_ps (_mm256_set1_ps (3.0f), lambda),
+                                                                     _mm256_mul_ps (_mm256_set1_ps (2.0f), c2)), lambda), c1);
+      const __m256 diverging = _mm256_and_ps (_mm256_cmp_ps (df, zero, _CMP_NGT_UQ), active);
+      failed = _mm256_or_ps (failed, diverging);
+      active = _mm256_andnot_ps (diverging, active);
+      const __m256 step = _mm256_div_ps (_mm256_sub_ps (zero, f), df);
+      lambda = _mm256_blendv_ps (lambda, _mm256_add_ps (lambda, step), active);
+      active = _mm256_andnot_ps (_mm256_cmp_ps (step, _mm256_mul_ps (_mm256_set1_ps (relative_step), lambda), _CMP_LE_OQ), active);
+    }
+    failed = _mm256_or_ps (failed, active);
+
+    const __m256 s = _mm256_sub_ps (c2, lambda);
+    const __m256 p = _mm256_sub_ps (c1, _mm256_mul_ps (lambda, s));
+    const __m256 d = _mm256_max_ps (_mm256_sub_ps (_mm256_mul_ps (s, s), _mm256_mul_ps (_mm256_set1_ps (4.0f), p)), zero);
+    const __m256 sd = _mm256_sqrt_ps (d);
+    const __m256 r1 = _mm256_mul_ps (_mm256_set1_ps (0.5f), _mm256_sub_ps (s, sd));
+    const __m256 e0 = _mm256_min_ps (r1, lambda);
+    const __m256 e1 = _mm256_blendv_ps (r1, lambda, _mm256_cmp_ps (r1, lambda, _CMP_LT_OQ));
+    const __m256 e2 = _mm256_mul_ps (_mm256_set1_ps (0.5f), _mm256_add_ps (s, sd));
+
+    const __m256 value = eigenvector == PCAEigenvector::SMALLEST ? e0 : e2;
+    const __m256 r0x = _mm256_sub_ps (xx, value), r1y = _mm256_sub_ps (yy, value), r2z = _mm256_sub_ps (zz, value);
+    __m256 vx, vy, vz, length;
+    crossAVX (r0x, xy, xz, xy, r1y, yz, vx, vy, vz, length);
+    __m256 ux, uy, uz, u_length;
+    crossAVX (r0x, xy, xz, xz, yz, r2z, ux, uy, uz, u_length);
+    __m256 larger = _mm256_cmp_ps (u_length, length, _CMP_GT_OQ);
+    vx = _mm256_blendv_ps (vx, ux, larger);
+    vy = _mm256_blendv_ps (vy, uy, larger);
+    vz = _mm256_blendv_ps (vz, uz, larger);
+    length = _mm256_blendv_ps (length, u_length, larger);
+    crossAVX (xy, r1y, yz, xz, yz, r2z, ux, uy, uz, u_length);
+    larger = _mm256_cmp_ps (u_length, length, _CMP_GT_OQ);
+    vx = _mm256_blendv_ps (vx, ux, larger);
+    vy = _mm256_blendv_ps (vy, uy, larger);
+    vz = _mm256_blendv_ps (vz, uz, larger);
+    length = _mm256_blendv_ps (length, u_length, larger);
+    const __m256 norm = _mm256_sqrt_ps (length);
+
+    _mm256_storeu_ps (batch.eigenvalues[0] + i, _mm256_mul_ps (e0, scale));
+    _mm256_storeu_ps (batch.eigenvalues[1] + i, _mm256_mul_ps (e1, scale));
+    _mm256_storeu_ps (batch.eigenvalues[2] + i, _mm256_mul_ps (e2, scale));
+    _mm256_storeu_ps (batch.eigenvector[0] + i, _mm256_div_ps (vx, norm));
+    _mm256_storeu_ps (batch.eigenvector[1] + i, _mm256_div_ps (vy, norm));
+    _mm256_storeu_ps (batch.eigenvector[2] + i, _mm256_div_ps (vz, norm));
+
+    const int failed_lanes = _mm256_movemask_ps (failed);
+    for (std::size_t lane = 0; lane < lanes; ++lane)
+      if (failed_lanes & (1 << lane))
+        solveDefault (batch, i + lane, eigenvector);
+  }
+#endif
+}
+
+bool
+pcl::detail::isPCAKernelSupported (PCAKernel kernel)
+{
+  switch (kernel)
+  {
+    case PCAKernel::AVX:
+#ifdef PCL_PCA_KERNELS_DISPATCH
+      return (__builtin_cpu_supports ("avx"));
+#else
+      return (false);
+#endif
+    default:
+      return (true);
+  }
+}
+
+void
+pcl::detail::computeNeighborhoodCovariance (const NeighborhoodCoordinates &coordinates,
+                                            Eigen::Matrix3f &covariance_matrix, PCAKernel kernel)
+{
+#ifdef PCL_PCA_KERNELS_DISPATCH
+  if (selectKernel (kernel) == PCAKernel::AVX)
+  {
+    computeCovarianceAVX (coordinates, covariance_matrix);
+    return;
+  }
+#endif
+  computeCovarianceDefault (coordinates, covariance_matrix);
+}
+
+void
+pcl::detail::solvePCABatch (PCABatch &batch, PCAEigenvector eigenvector, PCAKernel kernel)
+{
+  std::size_t i = 0;
+#ifdef PCL_PCA_KERNELS_DISPATCH
+  if (selectKernel (kernel) == PCAKernel::AVX)
+    for (; i + lanes <= batch.size; i += lanes)
+      solveAVX (batch, i, eigenvector);
+#endif
+  for (; i < batch.size; ++i)
+    solveDefault (batch, i, eigenvector);
+}
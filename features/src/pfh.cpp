@@ -40,6 +40,15 @@
 #include <pcl/features/impl/pfh.hpp>
 #include <pcl/features/impl/pfhrgb.hpp>
 
+// The AVX kernel of the batched pair features is compiled for its instruction set regardless of the build flags,
+// and selected at runtime according to the CPU
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PCL_PFH_DISPATCH 1
+// This file is built with -ffp-contract=off, so that both kernels compute the same features
+#define PCL_PFH_TARGET(isa) __attribute__ ((target (isa)))
+#include <immintrin.h>
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 bool
 pcl::computePairFeatures (const Eigen::Vector4f &p1, const Eigen::Vector4f &n1, 
@@ -102,6 +111,176 @@ pcl::computePairFeatures (const Eigen::Vector4f &p1, const Eigen::Vector4f &n1,
   return (true);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+namespace
+{
+  /** \brief Approximation of std::atan2, with an absolute error below 1e-5 radians. */
+  inline float
+  approximateAtan2 (float y, float x)
+  {
+    const float abs_x = std::fabs (x), abs_y = std::fabs (y);
+    const float max_xy = std::max (abs_x, abs_y);
+    const float a = (max_xy == 0.0f) ? 0.0f : std::min (abs_x, abs_y) / max_xy;
+    const float s = a * a;
+    // Minimax polynomial of atan on [0, 1]
+    float r = ((((-0.0117212f * s + 0.05265332f) * s - 0.11643287f) * s + 0.19354346f) * s - 0.33262347f) * s + 0.99997726f;
+    r *= a;
+    r = (abs_y > abs_x) ? static_cast<float> (M_PI_2) - r : r;
+    r = std::signbit (x) ? static_cast<float> (M_PI) - r : r;
+    return (std::copysign (r, y));
+  }
+
+  /** \brief The arguments of the kernels computing the features of a batch of pairs, one array per coordinate. */
+  struct PairFeatures
+  {
+    const Eigen::Vector4f *p1, *n1;
+    const float *x, *y, *z, *nx, *ny, *nz;
+    float *f1, *f2, *f3;
+  };
+
+  /** \brief Compute the features of the pairs [begin, end), one at a time. */
+  void
+  computePairFeaturesDefault (const PairFeatures &args, Eigen::Index begin, Eigen::Index end)
+  {
+    const Eigen::Vector4f &p1 = *args.p1, &n1 = *args.n1;
+    for (Eigen::Index i = begin; i < end; ++i)
+    {
+      const float nx = args.nx[i], ny = args.ny[i], nz = args.nz[i];
+      float dx = args.x[i] - p1[0], dy = args.y[i] - p1[1], dz = args.z[i] - p1[2];
+      const float sqr_distance = dx * dx + dy * dy + dz * dz;
+      const float distance = (sqr_distance == 0.0f) ? 1.0f : std::sqrt (sqr_distance);
+      const float angle1 = (n1[0] * dx + n1[1] * dy + n1[2] * dz) / distance;
+      const float angle2 = (nx * dx + ny * dy + nz * dz) / distance;
+
+      // Make sure the same point is selected as 1 and 2 for each pair: acos (|angle1|) > acos (|angle2|),
+      // which is false when rounding puts |angle2| above 1
+      const bool swap = std::fabs (angle1) < std::fabs (angle2) && std::fabs (angle2) <= 1.0f;
+      const float ux = swap ? nx : n1[0], uy = swap ? ny : n1[1], uz = swap ? nz : n1[2];
+      const float mx = swap ? n1[0] : nx, my = swap ? n1[1] : ny, mz = swap ? n1[2] : nz;
+      const float sign = swap ? -1.0f : 1.0f;
+      dx *= sign; dy *= sign; dz *= sign;
+
+      // Darboux frame u-v-w: u = n1; v = (p2 - p1) x u / || (p2 - p1) x u ||; w = u x v
+      float vx = dy * uz - dz * uy, vy = dz * ux - dx * uz, vz = dx * uy - dy * ux;
+      const float sqr_v_norm = vx * vx + vy * vy + vz * vz;
+      const float inv_v_norm = (sqr_v_norm == 0.0f) ? 0.0f : 1.0f / std::sqrt (sqr_v_norm);
+      vx *= inv_v_norm; vy *= inv_v_norm; vz *= inv_v_norm;
+      const float wx = uy * vz - uz * vy, wy = uz * vx - ux * vz, wz = ux * vy - uy * vx;
+
+      const bool degenerate = (sqr_distance == 0.0f) || (sqr_v_norm == 0.0f);
+      args.f1[i] = degenerate ? 0.0f : approximateAtan2 (wx * mx + wy * my + wz * mz, ux * mx + uy * my + uz * mz);
+      args.f2[i] = degenerate ? 0.0f : vx * mx + vy * my + vz * mz;
+      args.f3[i] = degenerate ? 0.0f : sign * (swap ? angle2 : angle1);
+    }
+  }
+
+#ifdef PCL_PFH_DISPATCH
+  PCL_PFH_TARGET ("avx") inline __m256
+  absAVX (__m256 v)
+  {
+    return (_mm256_andnot_ps (_mm256_set1_ps (-0.0f), v));
+  }
+
+  /** \brief The dot products of eight pairs of 3D vectors. */
+  PCL_PFH_TARGET ("avx") inline __m256
+  dotAVX (__m256 ax, __m256 ay, __m256 az, __m256 bx, __m256 by, __m256 bz)
+  {
+    return (_mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (ax, bx), _mm256_mul_ps (ay, by)), _mm256_mul_ps (az, bz)));
+  }
+
+  /** \brief approximateAtan2 () for eight values. */
+  PCL_PFH_TARGET ("avx") inline __m256
+  approximateAtan2AVX (__m256 y, __m256 x)
+  {
+    const __m256 sign_mask = _mm256_set1_ps (-0.0f), zero = _mm256_setzero_ps ();
+    const __m256 abs_x = absAVX (x), abs_y = absAVX (y);
+    const __m256 max_xy = _mm256_max_ps (abs_x, abs_y);
+    const __m256 a = _mm256_div_ps (_mm256_min_ps (abs_x, abs_y),
+                                    _mm256_blendv_ps (max_xy, _mm256_set1_ps (1.0f), _mm256_cmp_ps (max_xy, zero, _CMP_EQ_OQ)));
+    const __m256 s = _mm256_mul_ps (a, a);
+    __m256 r = _mm256_set1_ps (-0.0117212f);
+    for (const float c : {0.05265332f, -0.11643287f, 0.19354346f, -0.33262347f, 0.99997726f})
+      r = _mm256_add_ps (_mm256_mul_ps (r, s), _mm256_set1_ps (c));
+    r = _mm256_mul_ps (r, a);
+    r = _mm256_blendv_ps (r, _mm256_sub_ps (_mm256_set1_ps (static_cast<float> (M_PI_2)), r),
+                          _mm256_cmp_ps (abs_y, abs_x, _CMP_GT_OQ));
+    r = _mm256_blendv_ps (r, _mm256_sub_ps (_mm256_set1_ps (static_cast<float> (M_PI)), r), x);
+    return (_mm256_or_ps (absAVX (r), _mm256_and_ps (sign_mask, y)));
+  }
+
+  /** \brief Compute the features of the pairs [begin, end), eight at a time with AVX. */
+  PCL_PFH_TARGET ("avx") void
+  computePairFeaturesAVX (const PairFeatures &args, Eigen::Index begin, Eigen::Index end)
+  {
+    const Eigen::Vector4f &p1 = *args.p1, &n1 = *args.n1;
+    const __m256 zero = _mm256_setzero_ps (), one = _mm256_set1_ps (1.0f);
+    const __m256 p1x = _mm256_set1_ps (p1[0]), p1y = _mm256_set1_ps (p1[1]), p1z = _mm256_set1_ps (p1[2]);
+    const __m256 n1x = _mm256_set1_ps (n1[0]), n1y = _mm256_set1_ps (n1[1]), n1z = _mm256_set1_ps (n1[2]);
+    Eigen::Index i = begin;
+    for (; i + 8 <= end; i += 8)
+    {
+      const __m256 nx = _mm256_loadu_ps (args.nx + i), ny = _mm256_loadu_ps (args.ny + i), nz = _mm256_loadu_ps (args.nz + i);
+      __m256 dx = _mm256_sub_ps (_mm256_loadu_ps (args.x + i), p1x);
+      __m256 dy = _mm256_sub_ps (_mm256_loadu_ps (args.y + i), p1y);
+      __m256 dz = _mm256_sub_ps (_mm256_loadu_ps (args.z + i), p1z);
+      const __m256 sqr_distance = dotAVX (dx, dy, dz, dx, dy, dz);
+      const __m256 coincide = _mm256_cmp_ps (sqr_distance, zero, _CMP_EQ_OQ);
+      const __m256 distance = _mm256_blendv_ps (_mm256_sqrt_ps (sqr_distance), one, coincide);
+      const __m256 angle1 = _mm256_div_ps (dotAVX (n1x, n1y, n1z, dx, dy, dz), distance);
+      const __m256 angle2 = _mm256_div_ps (dotAVX (nx, ny, nz, dx, dy, dz), distance);
+
+      const __m256 abs_angle2 = absAVX (angle2);
+      const __m256 swap = _mm256_and_ps (_mm256_cmp_ps (absAVX (angle1), abs_angle2, _CMP_LT_OQ),
+                                         _mm256_cmp_ps (abs_angle2, one, _CMP_LE_OQ));
+      const __m256 ux = _mm256_blendv_ps (n1x, nx, swap), uy = _mm256_blendv_ps (n1y, ny, swap), uz = _mm256_blendv_ps (n1z, nz, swap);
+      const __m256 mx = _mm256_blendv_ps (nx, n1x, swap), my = _mm256_blendv_ps (ny, n1y, swap), mz = _mm256_blendv_ps (nz, n1z, swap);
+      const __m256 sign = _mm256_blendv_ps (one, _mm256_set1_ps (-1.0f), swap);
+      dx = _mm256_mul_ps (dx, sign); dy = _mm256_mul_ps (dy, sign); dz = _mm256_mul_ps (dz, sign);
+
+      __m256 vx = _mm256_sub_ps (_mm256_mul_ps (dy, uz), _mm256_mul_ps (dz, uy));
+      __m256 vy = _mm256_sub_ps (_mm256_mul_ps (dz, ux), _mm256_mul_ps (dx, uz));
+      __m256 vz = _mm256_sub_ps (_mm256_mul_ps (dx, uy), _mm256_mul_ps (dy, ux));
+      const __m256 sqr_v_norm = dotAVX (vx, vy, vz, vx, vy, vz);
+      const __m256 v_zero = _mm256_cmp_ps (sqr_v_norm, zero, _CMP_EQ_OQ);
+      const __m256 inv_v_norm = _mm256_blendv_ps (_mm256_div_ps (one, _mm256_sqrt_ps (sqr_v_norm)), zero, v_zero);
+      vx = _mm256_mul_ps (vx, inv_v_norm); vy = _mm256_mul_ps (vy, inv_v_norm); vz = _mm256_mul_ps (vz, inv_v_norm);
+      const __m256 wx = _mm256_sub_ps (_mm256_mul_ps (uy, vz), _mm256_mul_ps (uz, vy));
+      const __m256 wy = _mm256_sub_ps (_mm256_mul_ps (uz, vx), _mm256_mul_ps (ux, vz));
+      const __m256 wz = _mm256_sub_ps (_mm256_mul_ps (ux, vy), _mm256_mul_ps (uy, vx));
+
+      // The features of the degenerate pairs are set to 0
+      const __m256 degenerate = _mm256_or_ps (coincide, v_zero);
+      _mm256_storeu_ps (args.f1 + i, _mm256_andnot_ps (degenerate, approximateAtan2AVX (dotAVX (wx, wy, wz, mx, my, mz),
+                                                                                        dotAVX (ux, uy, uz, mx, my, mz))));
+      _mm256_storeu_ps (args.f2 + i, _mm256_andnot_ps (degenerate, dotAVX (vx, vy, vz, mx, my, mz)));
+      _mm256_storeu_ps (args.f3 + i, _mm256_andnot_ps (degenerate, _mm256_mul_ps (sign, _mm256_blendv_ps (angle1, angle2, swap))));
+    }
+    computePairFeaturesDefault (args, i, end);
+  }
+#endif // PCL_PFH_DISPATCH
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::computePairFeatures (const Eigen::Vector4f &p1, const Eigen::Vector4f &n1,
+                          const Eigen::Ref<const Eigen::Matrix<float, Eigen::Dynamic, 6> > &points_normals,
+                          Eigen::Ref<Eigen::Matrix<float, Eigen::Dynamic, 3> > features)
+{
+  const PairFeatures args = {&p1, &n1,
+                             points_normals.col (0).data (), points_normals.col (1).data (), points_normals.col (2).data (),
+                             points_normals.col (3).data (), points_normals.col (4).data (), points_normals.col (5).data (),
+                             features.col (0).data (), features.col (1).data (), features.col (2).data ()};
+#ifdef PCL_PFH_DISPATCH
+  static const bool avx = __builtin_cpu_supports ("avx");
+  if (avx)
+  {
+    computePairFeaturesAVX (args, 0, points_normals.rows ());
+    return;
+  }
+#endif
+  computePairFeaturesDefault (args, 0, points_normals.rows ());
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 bool
 pcl::computeRGBPairFeatures (const Eigen::Vector4f &p1, const Eigen::Vector4f &n1, const Eigen::Vector4i &colors1,
@@ -40,6 +40,7 @@
 #pragma once
 
 #include <pcl/point_types.h>
+#include <pcl/point_cloud_soa.h>
 #include <pcl/filters/filter_indices.h>
 #include <pcl/common/transforms.h>
 #include <pcl/common/eigen.h>
@@ -164,6 +165,17 @@ namespace pcl
         return (transform_);
       }
 
+      using FilterIndices<PointT>::filter;
+
+      /** \brief Filter a point cloud stored in structure-of-arrays layout instead of the input cloud, with the
+        * same rules (up to rounding: the transforms are combined before being applied to the points).
+        * The removed indices are available afterwards if extract_removed_indices was set at construction.
+        * \param[in] cloud the point cloud in structure-of-arrays layout
+        * \param[out] indices the indices of the points of \a cloud passing the filter
+        */
+      void
+      filter (const PointCloudSoA &cloud, std::vector<int> &indices);
+
     protected:
       using PCLBase<PointT>::input_;
       using PCLBase<PointT>::indices_;
@@ -0,0 +1,233 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/filters/filter.h>
+#include <pcl/common/centroid.h>
+
+namespace pcl
+{
+  /** \brief HashedVoxelGrid assembles a 3D grid over the input data and approximates the points
+    * inside each voxel by their centroid, like \ref VoxelGrid, without bounding the grid.
+    *
+    * The occupied voxels are stored in an open-addressing hash table keyed on their integer
+    * coordinates, and the centroids are accumulated in a single pass over the points. Contrary to
+    * \ref VoxelGrid, no index vector of the size of the input is built and sorted, the memory used
+    * only depends on the number of occupied voxels, and the extent of the data is not limited by the
+    * number of leaves fitting in a 32 bit integer.
+    *
+    * The points can be accumulated incrementally with \ref addPointCloud, e.g. to downsample a map
+    * that does not fit in memory at once, and the centroids retrieved at any time with
+    * \ref getCentroids. \ref filter processes the input cloud on its own, discarding the points
+    * accumulated before.
+    *
+    * \note The output points are sorted by order of creation of their voxel.
+    * \ingroup filters
+    */
+  template <typename PointT>
+  class HashedVoxelGrid: public Filter<PointT>
+  {
+    protected:
+      using Filter<PointT>::filter_name_;
+      using Filter<PointT>::getClassName;
+      using Filter<PointT>::input_;
+      using Filter<PointT>::indices_;
+
+      using PointCloud = typename Filter<PointT>::PointCloud;
+      using PointCloudPtr = typename PointCloud::Ptr;
+      using PointCloudConstPtr = typename PointCloud::ConstPtr;
+
+    public:
+      using Ptr = shared_ptr<HashedVoxelGrid<PointT> >;
+      using ConstPtr = shared_ptr<const HashedVoxelGrid<PointT> >;
+
+      /** \brief Empty constructor. */
+      HashedVoxelGrid () :
+        leaf_size_ (Eigen::Vector3f::Ones ()),
+        inverse_leaf_size_ (Eigen::Array3d::Ones ()),
+        downsample_all_data_ (true),
+        min_points_per_voxel_ (0)
+      {
+        filter_name_ = "HashedVoxelGrid";
+      }
+
+      /** \brief Set the voxel grid leaf size.
+        * \note The points accumulated so far are discarded.
+        * \param[in] leaf_size the voxel grid leaf size
+        */
+      inline void
+      setLeafSize (const Eigen::Vector3f &leaf_size)
+      {
+        leaf_size_ = leaf_size;
+        inverse_leaf_size_ = Eigen::Array3d::Ones () / leaf_size_.cast<double> ().array ();
+        clear ();
+      }
+
+      /** \brief Set the voxel grid leaf size.
+        * \note The points accumulated so far are discarded.
+        * \param[in] lx the leaf size for X
+        * \param[in] ly the leaf size for Y
+        * \param[in] lz the leaf size for Z
+        */
+      inline void
+      setLeafSize (float lx, float ly, float lz)
+      {
+        setLeafSize (Eigen::Vector3f (lx, ly, lz));
+      }
+
+      /** \brief Get the voxel grid leaf size. */
+      inline Eigen::Vector3f
+      getLeafSize () const { return (leaf_size_); }
+
+      /** \brief Set to true if all fields need to be downsampled, or false if just XYZ.
+        * \param[in] downsample the new value (true/false)
+        */
+      inline void
+      setDownsampleAllData (bool downsample) { downsample_all_data_ = downsample; }
+
+      /** \brief Get the state of the internal downsampling parameter (true if
+        * all fields need to be downsampled, false if just XYZ).
+        */
+      inline bool
+      getDownsampleAllData () const { return (downsample_all_data_); }
+
+      /** \brief Set the minimum number of points required for a voxel to be used.
+        * \param[in] min_points_per_voxel the minimum number of points for required for a voxel to be used
+        */
+      inline void
+      setMinimumPointsNumberPerVoxel (unsigned int min_points_per_voxel) { min_points_per_voxel_ = min_points_per_voxel; }
+
+      /** \brief Return the minimum number of points required for a voxel to be used. */
+      inline unsigned int
+      getMinimumPointsNumberPerVoxel () const { return (min_points_per_voxel_); }
+
+      /** \brief Accumulate all the finite points of a cloud into the grid.
+        * \param[in] cloud the point cloud to add
+        */
+      void
+      addPointCloud (const PointCloud &cloud);
+
+      /** \brief Accumulate the finite points of a cloud given by a set of indices into the grid.
+        * \param[in] cloud the point cloud to add
+        * \param[in] indices the indices of the points of \a cloud to add
+        */
+      void
+      addPointCloud (const PointCloud &cloud, const std::vector<int> &indices);
+
+      /** \brief Get the centroids of all the voxels holding at least \a min_points_per_voxel_ points.
+        * \param[out] output the resultant downsampled point cloud
+        */
+      void
+      getCentroids (PointCloud &output) const;
+
+      /** \brief Get the number of occupied voxels. */
+      inline std::size_t
+      getNumberOfVoxels () const { return (voxel_coordinates_.size ()); }
+
+      /** \brief Preallocate the storage for a given number of occupied voxels.
+        * \param[in] nr_voxels the expected number of occupied voxels
+        */
+      void
+      reserve (std::size_t nr_voxels);
+
+      /** \brief Discard all the points accumulated so far. */
+      void
+      clear ();
+
+    protected:
+      /** \brief The size of a leaf. */
+      Eigen::Vector3f leaf_size_;
+
+      /** \brief Internal leaf sizes stored as 1/leaf_size_, in double precision to keep the voxel
+        * coordinates exact far from the origin.
+        */
+      Eigen::Array3d inverse_leaf_size_;
+
+      /** \brief Set to true if all fields need to be downsampled, or false if just XYZ. */
+      bool downsample_all_data_;
+
+      /** \brief Minimum number of points per voxel for the centroid to be computed */
+      unsigned int min_points_per_voxel_;
+
+      /** \brief Open-addressing (linear probing) table of 1-based indices in \a voxel_coordinates_
+        * and \a centroids_, 0 marking an empty slot. Its size is a power of 2.
+        */
+      std::vector<std::uint32_t> table_;
+
+      /** \brief The integer coordinates of the occupied voxels, in order of creation. */
+      std::vector<Eigen::Vector3i, Eigen::aligned_allocator<Eigen::Vector3i> > voxel_coordinates_;
+
+      /** \brief The centroid accumulators of the occupied voxels, in order of creation. */
+      std::vector<CentroidPoint<PointT>, Eigen::aligned_allocator<CentroidPoint<PointT> > > centroids_;
+
+      /** \brief Downsample the input cloud using a hashed voxel grid.
+        * \param[out] output the resultant point cloud
+        */
+      void
+      applyFilter (PointCloud &output) override;
+
+      /** \brief Add a single point to the centroid of its voxel, creating the voxel if needed.
+        * \param[in] point the point to add
+        * \return false if the point is not finite or its voxel coordinates do not fit in 32 bit integers
+        */
+      bool
+      addPoint (const PointT &point);
+
+      /** \brief Hash of integer voxel coordinates.
+        * \param[in] ijk the voxel coordinates
+        */
+      static inline std::uint64_t
+      hashVoxel (const Eigen::Vector3i &ijk)
+      {
+        std::uint64_t hash = static_cast<std::uint64_t> (static_cast<std::uint32_t> (ijk[0])) * 0x9E3779B97F4A7C15ull;
+        hash ^= static_cast<std::uint64_t> (static_cast<std::uint32_t> (ijk[1])) * 0xC2B2AE3D27D4EB4Full;
+        hash ^= static_cast<std::uint64_t> (static_cast<std::uint32_t> (ijk[2])) * 0x165667B19E3779F9ull;
+        return (hash ^ (hash >> 29));
+      }
+
+      /** \brief Rebuild \a table_ with a given number of slots.
+        * \param[in] nr_slots the new number of slots, a power of 2
+        */
+      void
+      rehash (std::size_t nr_slots);
+  };
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/filters/impl/hashed_voxel_grid.hpp>
+#endif
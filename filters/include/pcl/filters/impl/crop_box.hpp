@@ -44,6 +44,11 @@
 #include <pcl/filters/crop_box.h>
 #include <pcl/common/io.h>
 
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+
 ///////////////////////////////////////////////////////////////////////////////
 template<typename PointT> void
 pcl::CropBox<PointT>::applyFilter (std::vector<int> &indices)
@@ -115,6 +120,65 @@ pcl::CropBox<PointT>::applyFilter (std::vector<int> &indices)
   removed_indices_->resize (removed_indices_count);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::CropBox<PointT>::filter (const PointCloudSoA &cloud, std::vector<int> &indices)
+{
+  indices.resize (cloud.size ());
+  removed_indices_->resize (cloud.size ());
+  int indices_count = 0;
+  int removed_indices_count = 0;
+
+  // Combine the transformation of the cloud, the translation and the rotation of the box
+  Eigen::Affine3f inverse_transform = Eigen::Affine3f::Identity ();
+  if (rotation_ != Eigen::Vector3f::Zero ())
+  {
+    Eigen::Affine3f transform;
+    pcl::getTransformation (0, 0, 0,
+                            rotation_ (0), rotation_ (1), rotation_ (2),
+                            transform);
+    inverse_transform = transform.inverse ();
+  }
+  const Eigen::Affine3f local_transform = inverse_transform * Eigen::Translation3f (-translation_) * transform_;
+  const Eigen::Matrix3f m = local_transform.linear ();
+  const Eigen::Vector3f t = local_transform.translation ();
+
+  // The points are tested by blocks without branches, so that the compiler can vectorize the tests
+  constexpr std::size_t block_size = 256;
+  std::uint8_t inside[block_size];
+  std::uint8_t finite[block_size];
+  for (std::size_t begin = 0; begin < cloud.size (); begin += block_size)
+  {
+    const std::size_t size = std::min (block_size, cloud.size () - begin);
+    const float *x = cloud.x.data () + begin;
+    const float *y = cloud.y.data () + begin;
+    const float *z = cloud.z.data () + begin;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      const float local_x = m (0, 0) * x[i] + m (0, 1) * y[i] + m (0, 2) * z[i] + t[0];
+      const float local_y = m (1, 0) * x[i] + m (1, 1) * y[i] + m (1, 2) * z[i] + t[1];
+      const float local_z = m (2, 0) * x[i] + m (2, 1) * y[i] + m (2, 2) * z[i] + t[2];
+      inside[i] = (local_x >= min_pt_[0]) & (local_y >= min_pt_[1]) & (local_z >= min_pt_[2]) &
+                  (local_x <= max_pt_[0]) & (local_y <= max_pt_[1]) & (local_z <= max_pt_[2]);
+      finite[i] = (std::abs (x[i]) <= FLT_MAX) & (std::abs (y[i]) <= FLT_MAX) & (std::abs (z[i]) <= FLT_MAX);
+    }
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      // Invalid points are skipped
+      if (!cloud.is_dense && !finite[i])
+        continue;
+      const int index = static_cast<int> (begin + i);
+      if (static_cast<bool> (inside[i]) != negative_)
+        indices[indices_count++] = index;
+      else if (extract_removed_indices_)
+        (*removed_indices_)[removed_indices_count++] = index;
+    }
+  }
+  indices.resize (indices_count);
+  removed_indices_->resize (removed_indices_count);
+}
+
 #define PCL_INSTANTIATE_CropBox(T) template class PCL_EXPORTS pcl::CropBox<T>;
 
 #endif    // PCL_FILTERS_IMPL_CROP_BOX_H_
@@ -0,0 +1,222 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_FILTERS_IMPL_HASHED_VOXEL_GRID_H_
+#define PCL_FILTERS_IMPL_HASHED_VOXEL_GRID_H_
+
+#include <pcl/filters/hashed_voxel_grid.h>
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::HashedVoxelGrid<PointT>::clear ()
+{
+  table_.clear ();
+  voxel_coordinates_.clear ();
+  centroids_.clear ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::HashedVoxelGrid<PointT>::reserve (std::size_t nr_voxels)
+{
+  voxel_coordinates_.reserve (nr_voxels);
+  centroids_.reserve (nr_voxels);
+
+  // Keep the load factor of the table below 1/2
+  std::size_t nr_slots = 16;
+  while (nr_slots < 2 * nr_voxels)
+    nr_slots *= 2;
+  if (nr_slots > table_.size ())
+    rehash (nr_slots);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::HashedVoxelGrid<PointT>::rehash (std::size_t nr_slots)
+{
+  table_.assign (nr_slots, 0);
+  const std::size_t mask = nr_slots - 1;
+  for (std::size_t i = 0; i < voxel_coordinates_.size (); ++i)
+  {
+    std::size_t slot = hashVoxel (voxel_coordinates_[i]) & mask;
+    while (table_[slot] != 0)
+      slot = (slot + 1) & mask;
+    table_[slot] = static_cast<std::uint32_t> (i + 1);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::HashedVoxelGrid<PointT>::addPoint (const PointT &point)
+{
+  const double i = std::floor (point.x * inverse_leaf_size_[0]);
+  const double j = std::floor (point.y * inverse_leaf_size_[1]);
+  const double k = std::floor (point.z * inverse_leaf_size_[2]);
+  const double min_coordinate = static_cast<double> (std::numeric_limits<int>::min ());
+  const double max_coordinate = static_cast<double> (std::numeric_limits<int>::max ());
+  // Written so that NaN coordinates fail the test too
+  const auto in_range = [min_coordinate, max_coordinate] (double coordinate)
+  {
+    return (coordinate >= min_coordinate && coordinate <= max_coordinate);
+  };
+  if (!in_range (i) || !in_range (j) || !in_range (k))
+    return (false);
+  const Eigen::Vector3i ijk (static_cast<int> (i), static_cast<int> (j), static_cast<int> (k));
+
+  // Grow the table before the load factor exceeds 1/2
+  if (2 * (voxel_coordinates_.size () + 1) > table_.size ())
+    rehash (std::max<std::size_t> (16, 2 * table_.size ()));
+
+  const std::size_t mask = table_.size () - 1;
+  for (std::size_t slot = hashVoxel (ijk) & mask; ; slot = (slot + 1) & mask)
+  {
+    const std::uint32_t voxel_index = table_[slot];
+    if (voxel_index == 0)
+    {
+      // First point falling in this voxel
+      voxel_coordinates_.push_back (ijk);
+      centroids_.emplace_back ();
+      centroids_.back ().add (point);
+      table_[slot] = static_cast<std::uint32_t> (voxel_coordinates_.size ());
+      return (true);
+    }
+    if (voxel_coordinates_[voxel_index - 1] == ijk)
+    {
+      centroids_[voxel_index - 1].add (point);
+      return (true);
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::HashedVoxelGrid<PointT>::addPointCloud (const PointCloud &cloud)
+{
+  std::size_t nr_out_of_range = 0;
+  for (const auto &point : cloud.points)
+  {
+    if (!cloud.is_dense)
+      // Check if the point is invalid
+      if (!std::isfinite (point.x) || 
+          !std::isfinite (point.y) || 
+          !std::isfinite (point.z))
+        continue;
+
+    if (!addPoint (point))
+      ++nr_out_of_range;
+  }
+
+  if (nr_out_of_range > 0)
+    PCL_WARN ("[pcl::%s::addPointCloud] %lu points skipped, they are not finite or their voxel coordinates would overflow 32 bit integers.\n",
+              getClassName ().c_str (), nr_out_of_range);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::HashedVoxelGrid<PointT>::addPointCloud (const PointCloud &cloud, const std::vector<int> &indices)
+{
+  std::size_t nr_out_of_range = 0;
+  for (const int &index : indices)
+  {
+    const PointT &point = cloud.points[index];
+    if (!cloud.is_dense)
+      // Check if the point is invalid
+      if (!std::isfinite (point.x) || 
+          !std::isfinite (point.y) || 
+          !std::isfinite (point.z))
+        continue;
+
+    if (!addPoint (point))
+      ++nr_out_of_range;
+  }
+
+  if (nr_out_of_range > 0)
+    PCL_WARN ("[pcl::%s::addPointCloud] %lu points skipped, they are not finite or their voxel coordinates would overflow 32 bit integers.\n",
+              getClassName ().c_str (), nr_out_of_range);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::HashedVoxelGrid<PointT>::getCentroids (PointCloud &output) const
+{
+  output.points.clear ();
+  output.points.reserve (centroids_.size ());
+  for (const auto &centroid : centroids_)
+  {
+    if (centroid.getSize () < min_points_per_voxel_)
+      continue;
+
+    PointT point;
+    centroid.get (point);
+    if (downsample_all_data_)
+      output.points.push_back (point);
+    else
+    {
+      //Limit downsampling to coords
+      PointT point_xyz;
+      point_xyz.x = point.x;
+      point_xyz.y = point.y;
+      point_xyz.z = point.z;
+      output.points.push_back (point_xyz);
+    }
+  }
+  output.width = static_cast<std::uint32_t> (output.points.size ());
+  output.height = 1;                    // downsampling breaks the organized structure
+  output.is_dense = true;               // we filter out invalid points
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::HashedVoxelGrid<PointT>::applyFilter (PointCloud &output)
+{
+  // Has the input dataset been set already?
+  if (!input_)
+  {
+    PCL_WARN ("[pcl::%s::applyFilter] No input dataset given!\n", getClassName ().c_str ());
+    output.width = output.height = 0;
+    output.points.clear ();
+    return;
+  }
+
+  clear ();
+  addPointCloud (*input_, *indices_);
+  getCentroids (output);
+}
+
+#define PCL_INSTANTIATE_HashedVoxelGrid(T) template class PCL_EXPORTS pcl::HashedVoxelGrid<T>;
+
+#endif    // PCL_FILTERS_IMPL_HASHED_VOXEL_GRID_H_
@@ -43,6 +43,11 @@
 #include <pcl/filters/passthrough.h>
 #include <pcl/common/io.h>
 
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::PassThrough<PointT>::applyFilterIndices (std::vector<int> &indices)
@@ -135,6 +140,79 @@ pcl::PassThrough<PointT>::applyFilterIndices (std::vector<int> &indices)
   removed_indices_->resize (rii);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::PassThrough<PointT>::filter (const PointCloudSoA &cloud, std::vector<int> &indices)
+{
+  const float *field_values = nullptr;
+  if (!filter_field_name_.empty ())
+  {
+    if (filter_field_name_ == "x")
+      field_values = cloud.x.data ();
+    else if (filter_field_name_ == "y")
+      field_values = cloud.y.data ();
+    else if (filter_field_name_ == "z")
+      field_values = cloud.z.data ();
+    else if (cloud.hasNormals () && filter_field_name_ == "normal_x")
+      field_values = cloud.normal_x.data ();
+    else if (cloud.hasNormals () && filter_field_name_ == "normal_y")
+      field_values = cloud.normal_y.data ();
+    else if (cloud.hasNormals () && filter_field_name_ == "normal_z")
+      field_values = cloud.normal_z.data ();
+    else
+    {
+      PCL_WARN ("[pcl::%s::filter] Unable to find field name in point cloud.\n", getClassName ().c_str ());
+      indices.clear ();
+      removed_indices_->clear ();
+      return;
+    }
+  }
+
+  indices.resize (cloud.size ());
+  removed_indices_->resize (cloud.size ());
+  int oii = 0, rii = 0;  // oii = output indices iterator, rii = removed indices iterator
+
+  // The points are tested by blocks without branches, so that the compiler can vectorize the tests
+  constexpr std::size_t block_size = 256;
+  std::uint8_t passed[block_size];
+  for (std::size_t begin = 0; begin < cloud.size (); begin += block_size)
+  {
+    const std::size_t size = std::min (block_size, cloud.size () - begin);
+    const float *x = cloud.x.data () + begin;
+    const float *y = cloud.y.data () + begin;
+    const float *z = cloud.z.data () + begin;
+    if (field_values)
+    {
+      const float *values = field_values + begin;
+      for (std::size_t i = 0; i < size; ++i)
+      {
+        // Non-finite coordinates and values are always removed
+        const bool finite = (std::abs (x[i]) <= FLT_MAX) & (std::abs (y[i]) <= FLT_MAX) &
+                            (std::abs (z[i]) <= FLT_MAX) & (std::abs (values[i]) <= FLT_MAX);
+        const bool inside = (values[i] >= filter_limit_min_) & (values[i] <= filter_limit_max_);
+        passed[i] = finite & (inside != negative_);
+      }
+    }
+    else
+    {
+      for (std::size_t i = 0; i < size; ++i)
+        passed[i] = (std::abs (x[i]) <= FLT_MAX) & (std::abs (y[i]) <= FLT_MAX) & (std::abs (z[i]) <= FLT_MAX);
+    }
+
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      if (passed[i])
+        indices[oii++] = static_cast<int> (begin + i);
+      else if (extract_removed_indices_)
+        (*removed_indices_)[rii++] = static_cast<int> (begin + i);
+    }
+  }
+
+  // Resize the output arrays
+  indices.resize (oii);
+  removed_indices_->resize (rii);
+}
+
 #define PCL_INSTANTIATE_PassThrough(T) template class PCL_EXPORTS pcl::PassThrough<T>;
 
 #endif  // PCL_FILTERS_IMPL_PASSTHROUGH_HPP_
@@ -43,6 +43,24 @@
 #include <pcl/filters/radius_outlier_removal.h>
 #include <pcl/common/io.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::RadiusOutlierRemoval<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::RadiusOutlierRemoval<PointT>::applyFilterIndices (std::vector<int> &indices)
@@ -66,90 +84,70 @@ pcl::RadiusOutlierRemoval<PointT>::applyFilterIndices (std::vector<int> &indices
   searcher_->setInputCloud (input_);
 
   // The arrays to be used
-  std::vector<int> nn_indices (indices_->size ());
-  std::vector<float> nn_dists (indices_->size ());
+  std::vector<int> nn_indices;
+  std::vector<float> nn_dists;
+  std::vector<char> chk_neighbors (indices_->size ());
   indices.resize (indices_->size ());
   removed_indices_->resize (indices_->size ());
   int oii = 0, rii = 0;  // oii = output indices iterator, rii = removed indices iterator
 
+  // First pass: Check the number of neighbors of every point, in parallel
   // If the data is dense => use nearest-k search
   if (input_->is_dense)
   {
     // Note: k includes the query point, so is always at least 1
-    int mean_k = min_pts_radius_ + 1;
-    double nn_dists_max = search_radius_ * search_radius_;
-
-    for (std::vector<int>::const_iterator it = indices_->begin (); it != indices_->end (); ++it)
+    const int mean_k = min_pts_radius_ + 1;
+    const double nn_dists_max = search_radius_ * search_radius_;
+
+#pragma omp parallel for \
+  default(none) \
+  shared(chk_neighbors) \
+  firstprivate(mean_k, nn_dists_max, nn_indices, nn_dists) \
+  num_threads(threads_)
+    for (std::ptrdiff_t iii = 0; iii < static_cast<std::ptrdiff_t> (indices_->size ()); ++iii)
     {
       // Perform the nearest-k search
-      int k = searcher_->nearestKSearch (*it, mean_k, nn_indices, nn_dists);
+      const int k = searcher_->nearestKSearch ((*indices_)[iii], mean_k, nn_indices, nn_dists);
 
       // Check the number of neighbors
       // Note: nn_dists is sorted, so check the last item
-      bool chk_neighbors = true;
-      if (k == mean_k)
-      {
-        if (negative_)
-        {
-          chk_neighbors = false;
-          if (nn_dists_max < nn_dists[k-1])
-          {
-            chk_neighbors = true;
-          }
-        }
-        else
-        {
-          chk_neighbors = true;
-          if (nn_dists_max < nn_dists[k-1])
-          {
-            chk_neighbors = false;
-          }
-        }
-      }
-      else
-      {
-        if (negative_)
-          chk_neighbors = true;
-        else
-          chk_neighbors = false;
-      }
-
-      // Points having too few neighbors are outliers and are passed to removed indices
-      // Unless negative was set, then it's the opposite condition
-      if (!chk_neighbors)
-      {
-        if (extract_removed_indices_)
-          (*removed_indices_)[rii++] = *it;
-        continue;
-      }
-
-      // Otherwise it was a normal point for output (inlier)
-      indices[oii++] = *it;
+      chk_neighbors[iii] = (k == mean_k) ? (negative_ == (nn_dists_max < nn_dists[k-1])) : negative_;
     }
   }
   // NaN or Inf values could exist => use radius search
   else
   {
-    for (std::vector<int>::const_iterator it = indices_->begin (); it != indices_->end (); ++it)
+#pragma omp parallel for \
+  default(none) \
+  shared(chk_neighbors) \
+  firstprivate(nn_indices, nn_dists) \
+  num_threads(threads_)
+    for (std::ptrdiff_t iii = 0; iii < static_cast<std::ptrdiff_t> (indices_->size ()); ++iii)
     {
       // Perform the radius search
       // Note: k includes the query point, so is always at least 1
-      int k = searcher_->radiusSearch (*it, search_radius_, nn_indices, nn_dists);
-
-      // Points having too few neighbors are outliers and are passed to removed indices
-      // Unless negative was set, then it's the opposite condition
-      if ((!negative_ && k <= min_pts_radius_) || (negative_ && k > min_pts_radius_))
-      {
-        if (extract_removed_indices_)
-          (*removed_indices_)[rii++] = *it;
-        continue;
-      }
-
-      // Otherwise it was a normal point for output (inlier)
-      indices[oii++] = *it;
+      const int k = searcher_->radiusSearch ((*indices_)[iii], search_radius_, nn_indices, nn_dists);
+
+      // Unless negative was set, points having too few neighbors fail the check
+      chk_neighbors[iii] = negative_ ? k <= min_pts_radius_ : k > min_pts_radius_;
     }
   }
 
+  // Second pass: Points having too few neighbors are outliers and are passed to removed indices
+  // Unless negative was set, then it's the opposite condition
+  for (std::size_t iii = 0; iii < indices_->size (); ++iii)
+  {
+    if (!chk_neighbors[iii])
+    {
+      if (extract_removed_indices_)
+        (*removed_indices_)[rii++] = (*indices_)[iii];
+      continue;
+    }
+
+    // Otherwise it was a normal point for output (inlier)
+    indices[oii++] = (*indices_)[iii];
+  }
+
   // Resize the output arrays
   indices.resize (oii);
   removed_indices_->resize (rii);
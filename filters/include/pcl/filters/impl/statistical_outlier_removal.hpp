@@ -43,6 +43,24 @@
 #include <pcl/filters/statistical_outlier_removal.h>
 #include <pcl/common/io.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::StatisticalOutlierRemoval<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::StatisticalOutlierRemoval<PointT>::applyFilterIndices (std::vector<int> &indices)
@@ -67,7 +85,13 @@ pcl::StatisticalOutlierRemoval<PointT>::applyFilterIndices (std::vector<int> &in
 
   // First pass: Compute the mean distances for all points with respect to their k nearest neighbors
   int valid_distances = 0;
-  for (int iii = 0; iii < static_cast<int> (indices_->size ()); ++iii)  // iii = input indices iterator
+#pragma omp parallel for \
+  default(none) \
+  shared(distances) \
+  firstprivate(nn_indices, nn_dists) \
+  reduction(+:valid_distances) \
+  num_threads(threads_)
+  for (std::ptrdiff_t iii = 0; iii < static_cast<std::ptrdiff_t> (indices_->size ()); ++iii)  // iii = input indices iterator
   {
     if (!std::isfinite (input_->points[(*indices_)[iii]].x) ||
         !std::isfinite (input_->points[(*indices_)[iii]].y) ||
@@ -44,6 +44,13 @@
 #include <pcl/filters/voxel_grid.h>
 #include  <boost/sort/spreadsort/integer_sort.hpp>
 
+#include <algorithm>
+#include <array>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::getMinMax3D (const typename pcl::PointCloud<PointT>::ConstPtr &cloud,
@@ -211,6 +218,116 @@ struct cloud_point_index_idx
   bool operator < (const cloud_point_index_idx &p) const { return (idx < p.idx); }
 };
 
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Stable LSD radix sort of \a data on the bits [\a begin_bit, \a end_bit) of the
+      * 64 bit key returned by \a key. The histogram and scatter steps of each digit are split
+      * in contiguous blocks processed by \a nr_threads threads, and digits for which all the
+      * keys are equal are skipped.
+      * \param[in,out] data the elements to sort
+      * \param[in] key functor returning the std::uint64_t key of an element
+      * \param[in] begin_bit the first (least significant) bit of the key to sort on
+      * \param[in] end_bit one past the last (most significant) bit of the key to sort on
+      * \param[in] nr_threads the number of threads to use
+      */
+    template <typename T, typename KeyFunc> void
+    radixSort (std::vector<T> &data, KeyFunc key, unsigned int begin_bit, unsigned int end_bit, unsigned int nr_threads)
+    {
+      constexpr unsigned int radix_bits = 8;
+      constexpr std::size_t radix_size = std::size_t (1) << radix_bits;
+
+      std::ptrdiff_t nr_elements = static_cast<std::ptrdiff_t> (data.size ());
+      if (nr_elements < 2)
+        return;
+
+      std::ptrdiff_t nr_blocks = std::max<std::ptrdiff_t> (1, std::min<std::ptrdiff_t> (nr_threads, nr_elements));
+      std::ptrdiff_t block_size = (nr_elements + nr_blocks - 1) / nr_blocks;
+
+      std::vector<T> buffer (data.size ());
+      std::vector<std::array<std::size_t, radix_size> > offsets (nr_blocks);
+
+      for (unsigned int shift = begin_bit; shift < end_bit; shift += radix_bits)
+      {
+        // Count the occurrences of each digit inside each block
+#pragma omp parallel for \
+  default(none) \
+  shared(block_size, data, key, nr_blocks, nr_elements, offsets, shift) \
+  num_threads(nr_blocks)
+        for (std::ptrdiff_t b = 0; b < nr_blocks; ++b)
+        {
+          std::array<std::size_t, radix_size> &histogram = offsets[b];
+          histogram.fill (0);
+          const std::ptrdiff_t last = std::min (nr_elements, (b + 1) * block_size);
+          for (std::ptrdiff_t i = b * block_size; i < last; ++i)
+            ++histogram[(key (data[i]) >> shift) & (radix_size - 1)];
+        }
+
+        // Nothing to do if all the keys share the same digit
+        bool single_digit = false;
+        for (std::size_t d = 0; d < radix_size && !single_digit; ++d)
+        {
+          std::size_t count = 0;
+          for (std::ptrdiff_t b = 0; b < nr_blocks; ++b)
+            count += offsets[b][d];
+          single_digit = (count == data.size ());
+        }
+        if (single_digit)
+          continue;
+
+        // Exclusive prefix sum in digit-major, block-minor order keeps the sort stable
+        std::size_t sum = 0;
+        for (std::size_t d = 0; d < radix_size; ++d)
+          for (std::ptrdiff_t b = 0; b < nr_blocks; ++b)
+          {
+            const std::size_t count = offsets[b][d];
+            offsets[b][d] = sum;
+            sum += count;
+          }
+
+        // Scatter each block to its final position
+#pragma omp parallel for \
+  default(none) \
+  shared(block_size, buffer, data, key, nr_blocks, nr_elements, offsets, shift) \
+  num_threads(nr_blocks)
+        for (std::ptrdiff_t b = 0; b < nr_blocks; ++b)
+        {
+          std::array<std::size_t, radix_size> &position = offsets[b];
+          const std::ptrdiff_t last = std::min (nr_elements, (b + 1) * block_size);
+          for (std::ptrdiff_t i = b * block_size; i < last; ++i)
+            buffer[position[(key (data[i]) >> shift) & (radix_size - 1)]++] = data[i];
+        }
+        data.swap (buffer);
+      }
+    }
+
+    /** \brief Number of bits needed to represent \a value. */
+    inline unsigned int
+    bitWidth (std::uint64_t value)
+    {
+      unsigned int width = 0;
+      for (; value != 0; value >>= 1)
+        ++width;
+      return (width);
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::VoxelGrid<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
@@ -262,33 +379,32 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
   // Set up the division multiplier
   divb_mul_ = Eigen::Vector4i (1, div_b_[0], div_b_[0] * div_b_[1], 0);
 
-  // Storage for mapping leaf and pointcloud indexes
-  std::vector<cloud_point_index_idx> index_vector;
-  index_vector.reserve (indices_->size ());
-
-  // If we don't want to process the entire cloud, but rather filter points far away from the viewpoint first...
+  // Get the distance field index, if we don't want to process the entire cloud but rather
+  // filter points far away from the viewpoint first
+  std::vector<pcl::PCLPointField> fields;
+  int distance_idx = -1;
   if (!filter_field_name_.empty ())
   {
-    // Get the distance field index
-    std::vector<pcl::PCLPointField> fields;
-    int distance_idx = pcl::getFieldIndex<PointT> (filter_field_name_, fields);
+    distance_idx = pcl::getFieldIndex<PointT> (filter_field_name_, fields);
     if (distance_idx == -1)
       PCL_WARN ("[pcl::%s::applyFilter] Invalid filter field name. Index is %d.\n", getClassName ().c_str (), distance_idx);
+  }
 
-    // First pass: go over all points and insert them into the index_vector vector
-    // with calculated idx. Points with the same idx value will contribute to the
-    // same point of resulting CloudPoint
-    for (std::vector<int>::const_iterator it = indices_->begin (); it != indices_->end (); ++it)
-    {
-      if (!input_->is_dense)
-        // Check if the point is invalid
-        if (!std::isfinite (input_->points[*it].x) || 
-            !std::isfinite (input_->points[*it].y) || 
-            !std::isfinite (input_->points[*it].z))
-          continue;
+  // Compute the centroid leaf index of a point, returns false if the point has to be skipped
+  auto computeLeafIndex = [&] (int point_index, unsigned int &idx) -> bool
+  {
+    const PointT &point = input_->points[point_index];
+    if (!input_->is_dense)
+      // Check if the point is invalid
+      if (!std::isfinite (point.x) || 
+          !std::isfinite (point.y) || 
+          !std::isfinite (point.z))
+        return (false);
 
+    if (!filter_field_name_.empty ())
+    {
       // Get the distance value
-      const std::uint8_t* pt_data = reinterpret_cast<const std::uint8_t*> (&input_->points[*it]);
+      const std::uint8_t* pt_data = reinterpret_cast<const std::uint8_t*> (&point);
       float distance_value = 0;
       memcpy (&distance_value, pt_data + fields[distance_idx].offset, sizeof (float));
 
@@ -296,53 +412,83 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
       {
         // Use a threshold for cutting out points which inside the interval
         if ((distance_value < filter_limit_max_) && (distance_value > filter_limit_min_))
-          continue;
+          return (false);
       }
       else
       {
         // Use a threshold for cutting out points which are too close/far away
         if ((distance_value > filter_limit_max_) || (distance_value < filter_limit_min_))
-          continue;
+          return (false);
       }
-      
-      int ijk0 = static_cast<int> (std::floor (input_->points[*it].x * inverse_leaf_size_[0]) - static_cast<float> (min_b_[0]));
-      int ijk1 = static_cast<int> (std::floor (input_->points[*it].y * inverse_leaf_size_[1]) - static_cast<float> (min_b_[1]));
-      int ijk2 = static_cast<int> (std::floor (input_->points[*it].z * inverse_leaf_size_[2]) - static_cast<float> (min_b_[2]));
-
-      // Compute the centroid leaf index
-      int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
-      index_vector.emplace_back(static_cast<unsigned int> (idx), *it);
     }
+
+    int ijk0 = static_cast<int> (std::floor (point.x * inverse_leaf_size_[0]) - static_cast<float> (min_b_[0]));
+    int ijk1 = static_cast<int> (std::floor (point.y * inverse_leaf_size_[1]) - static_cast<float> (min_b_[1]));
+    int ijk2 = static_cast<int> (std::floor (point.z * inverse_leaf_size_[2]) - static_cast<float> (min_b_[2]));
+
+    // Compute the centroid leaf index
+    idx = static_cast<unsigned int> (ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2]);
+    return (true);
+  };
+
+  // Storage for mapping leaf and pointcloud indexes
+  std::vector<cloud_point_index_idx> index_vector;
+
+  // Points inside the same leaf are ordered by their index in the input cloud, so that the
+  // centroids are accumulated in the same order whatever the number of threads used
+  auto key_func = [] (const cloud_point_index_idx &x) -> std::uint64_t
+  {
+    return ((static_cast<std::uint64_t> (x.idx) << 32) | x.cloud_point_index);
+  };
+
+  // First pass: go over all points and insert them into the index_vector vector
+  // with calculated idx. Points with the same idx value will contribute to the
+  // same point of resulting CloudPoint
+  if (threads_ > 1)
+  {
+    // Every input index gets its slot, the skipped points are flagged with an invalid leaf
+    // index (the number of leaves is smaller than INT_MAX) and removed afterwards
+    index_vector.resize (indices_->size ());
+#pragma omp parallel for \
+  default(none) \
+  shared(computeLeafIndex, index_vector) \
+  num_threads(threads_)
+    for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t> (indices_->size ()); ++i)
+    {
+      const int point_index = (*indices_)[i];
+      unsigned int idx;
+      if (!computeLeafIndex (point_index, idx))
+        idx = std::numeric_limits<unsigned int>::max ();
+      index_vector[i] = cloud_point_index_idx (idx, static_cast<unsigned int> (point_index));
+    }
+    index_vector.erase (std::remove_if (index_vector.begin (), index_vector.end (),
+                                        [] (const cloud_point_index_idx &x) { return (x.idx == std::numeric_limits<unsigned int>::max ()); }),
+                        index_vector.end ());
+
+    // Second pass: stable parallel radix sort of the index_vector vector using value representing
+    // target cell as index. When the input indices are already sorted, sorting on the leaf index
+    // alone yields the same order as sorting on the full key
+    const std::uint64_t nr_leaves = static_cast<std::uint64_t> (div_b_[0]) * div_b_[1] * div_b_[2];
+    const unsigned int end_bit = 32 + detail::bitWidth (nr_leaves - 1);
+    const unsigned int begin_bit = std::is_sorted (indices_->begin (), indices_->end ()) ? 32 : 0;
+    detail::radixSort (index_vector, key_func, begin_bit, end_bit, threads_);
   }
-  // No distance filtering, process all data
   else
   {
-    // First pass: go over all points and insert them into the index_vector vector
-    // with calculated idx. Points with the same idx value will contribute to the
-    // same point of resulting CloudPoint
+    index_vector.reserve (indices_->size ());
     for (std::vector<int>::const_iterator it = indices_->begin (); it != indices_->end (); ++it)
     {
-      if (!input_->is_dense)
-        // Check if the point is invalid
-        if (!std::isfinite (input_->points[*it].x) || 
-            !std::isfinite (input_->points[*it].y) || 
-            !std::isfinite (input_->points[*it].z))
-          continue;
-
-      int ijk0 = static_cast<int> (std::floor (input_->points[*it].x * inverse_leaf_size_[0]) - static_cast<float> (min_b_[0]));
-      int ijk1 = static_cast<int> (std::floor (input_->points[*it].y * inverse_leaf_size_[1]) - static_cast<float> (min_b_[1]));
-      int ijk2 = static_cast<int> (std::floor (input_->points[*it].z * inverse_leaf_size_[2]) - static_cast<float> (min_b_[2]));
-
-      // Compute the centroid leaf index
-      int idx = ijk0 * divb_mul_[0] + ijk1 * divb_mul_[1] + ijk2 * divb_mul_[2];
-      index_vector.emplace_back(static_cast<unsigned int> (idx), *it);
+      unsigned int idx;
+      if (computeLeafIndex (*it, idx))
+        index_vector.emplace_back (idx, *it);
     }
-  }
 
-  // Second pass: sort the index_vector vector using value representing target cell as index
-  // in effect all points belonging to the same output cell will be next to each other
-  auto rightshift_func = [](const cloud_point_index_idx &x, const unsigned offset) { return x.idx >> offset; };
-  boost::sort::spreadsort::integer_sort(index_vector.begin(), index_vector.end(), rightshift_func);
+    // Second pass: sort the index_vector vector using value representing target cell as index
+    // in effect all points belonging to the same output cell will be next to each other
+    auto rightshift_func = [&key_func] (const cloud_point_index_idx &x, const unsigned offset) { return key_func (x) >> offset; };
+    auto compare_func = [&key_func] (const cloud_point_index_idx &a, const cloud_point_index_idx &b) { return key_func (a) < key_func (b); };
+    boost::sort::spreadsort::integer_sort (index_vector.begin (), index_vector.end (), rightshift_func, compare_func);
+  }
   
   // Third pass: count output cells
   // we need to skip all the same, adjacent idx values
@@ -394,17 +540,23 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
         "voxel_grid.hpp", "applyFilter");	
     }
   }
-  
-  index = 0;
-  for (const auto &cp : first_and_last_indices_vector)
+
+  // Every output point is computed from its own range of index_vector, so the centroids
+  // can be reduced in parallel without changing the result
+#pragma omp parallel for \
+  default(none) \
+  shared(first_and_last_indices_vector, index_vector, output) \
+  num_threads(threads_) \
+  if(threads_ > 1)
+  for (std::ptrdiff_t cp = 0; cp < static_cast<std::ptrdiff_t> (first_and_last_indices_vector.size ()); ++cp)
   {
     // calculate centroid - sum values from all input points, that have the same idx value in index_vector array
-  	unsigned int first_index = cp.first;
-  	unsigned int last_index = cp.second;
+    const unsigned int first_index = first_and_last_indices_vector[cp].first;
+    const unsigned int last_index = first_and_last_indices_vector[cp].second;
 
-    // index is centroid final position in resulting PointCloud
+    // cp is centroid final position in resulting PointCloud
     if (save_leaf_layout_)
-      leaf_layout_[index_vector[first_index].idx] = index;
+      leaf_layout_[index_vector[first_index].idx] = static_cast<int> (cp);
 
     //Limit downsampling to coords
     if (!downsample_all_data_)
@@ -415,7 +567,7 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
         centroid += input_->points[index_vector[li].cloud_point_index].getVector4fMap ();
 
       centroid /= static_cast<float> (last_index - first_index);
-      output.points[index].getVector4fMap () = centroid;
+      output.points[cp].getVector4fMap () = centroid;
     }
     else
     {
@@ -425,10 +577,8 @@ pcl::VoxelGrid<PointT>::applyFilter (PointCloud &output)
       for (unsigned int li = first_index; li < last_index; ++li)
         centroid.add (input_->points[index_vector[li].cloud_point_index]);  
 
-      centroid.get (output.points[index]);
+      centroid.get (output.points[cp]);
     }
-     
-    ++index;
   }
   output.width = static_cast<std::uint32_t> (output.points.size ());
 }
@@ -41,6 +41,7 @@
 
 #include <pcl/pcl_macros.h>
 #include <pcl/filters/filter_indices.h>
+#include <pcl/point_cloud_soa.h>
 
 namespace pcl
 {
@@ -178,6 +179,17 @@ namespace pcl
         return (negative_);
       }
 
+      using FilterIndices<PointT>::filter;
+
+      /** \brief Filter a point cloud stored in structure-of-arrays layout instead of the input cloud, with the
+        * same rules. The filter field has to be stored by \a cloud (x, y, z, normal_x, normal_y or normal_z).
+        * The removed indices are available afterwards if extract_removed_indices was set at construction.
+        * \param[in] cloud the point cloud in structure-of-arrays layout
+        * \param[out] indices the indices of the points of \a cloud passing the filter
+        */
+      void
+      filter (const PointCloudSoA &cloud, std::vector<int> &indices);
+
     protected:
       using PCLBase<PointT>::input_;
       using PCLBase<PointT>::indices_;
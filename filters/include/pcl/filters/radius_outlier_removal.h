@@ -89,7 +89,8 @@ namespace pcl
         FilterIndices<PointT> (extract_removed_indices),
         searcher_ (),
         search_radius_ (0.0),
-        min_pts_radius_ (1)
+        min_pts_radius_ (1),
+        threads_ (1)
       {
         filter_name_ = "RadiusOutlierRemoval";
       }
@@ -138,6 +139,17 @@ namespace pcl
         return (min_pts_radius_);
       }
 
+      /** \brief Set the number of threads used to search the neighbors of the points. The output, including the
+        * removed indices, is identical to the one obtained with a single thread.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used for filtering. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
     protected:
       using PCLBase<PointT>::input_;
       using PCLBase<PointT>::indices_;
@@ -173,6 +185,9 @@ namespace pcl
 
       /** \brief The minimum number of neighbors that a point needs to have in the given search radius to be considered an inlier. */
       int min_pts_radius_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
   };
 
   //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -202,7 +217,7 @@ namespace pcl
       /** \brief Empty constructor. */
       RadiusOutlierRemoval (bool extract_removed_indices = false) :
         FilterIndices<pcl::PCLPointCloud2>::FilterIndices (extract_removed_indices),
-        search_radius_ (0.0), min_pts_radius_ (1)
+        search_radius_ (0.0), min_pts_radius_ (1), threads_ (1)
       {
         filter_name_ = "RadiusOutlierRemoval";
       }
@@ -242,6 +257,17 @@ namespace pcl
         return (min_pts_radius_);
       }
 
+      /** \brief Set the number of threads used to search the neighbors of the points. The output, including the
+        * removed indices, is identical to the one obtained with a single thread.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used for filtering. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
     protected:
       /** \brief The nearest neighbors search radius for each point. */
       double search_radius_;
@@ -254,6 +280,9 @@ namespace pcl
       /** \brief A pointer to the spatial search object. */
       KdTreePtr searcher_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       void
       applyFilter (PCLPointCloud2 &output) override;
 
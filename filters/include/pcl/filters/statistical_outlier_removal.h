@@ -98,7 +98,8 @@ namespace pcl
         FilterIndices<PointT> (extract_removed_indices),
         searcher_ (),
         mean_k_ (1),
-        std_mul_ (0.0)
+        std_mul_ (0.0),
+        threads_ (1)
       {
         filter_name_ = "StatisticalOutlierRemoval";
       }
@@ -142,6 +143,17 @@ namespace pcl
         return (std_mul_);
       }
 
+      /** \brief Set the number of threads used to search the neighbors of the points. The output, including the
+        * removed indices, is identical to the one obtained with a single thread.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used for filtering. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
     protected:
       using PCLBase<PointT>::input_;
       using PCLBase<PointT>::indices_;
@@ -178,6 +190,9 @@ namespace pcl
       /** \brief Standard deviations threshold (i.e., points outside of 
         * \f$ \mu \pm \sigma \cdot std\_mul \f$ will be marked as outliers). */
       double std_mul_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
   };
 
   /** \brief @b StatisticalOutlierRemoval uses point neighborhood statistics to filter outlier data. For more
@@ -210,7 +225,7 @@ namespace pcl
       /** \brief Empty constructor. */
       StatisticalOutlierRemoval (bool extract_removed_indices = false) :
         FilterIndices<pcl::PCLPointCloud2>::FilterIndices (extract_removed_indices), mean_k_ (2),
-        std_mul_ (0.0)
+        std_mul_ (0.0), threads_ (1)
       {
         filter_name_ = "StatisticalOutlierRemoval";
       }
@@ -250,6 +265,17 @@ namespace pcl
         return (std_mul_);
       }
 
+      /** \brief Set the number of threads used to search the neighbors of the points. The output, including the
+        * removed indices, is identical to the one obtained with a single thread.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used for filtering. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
     protected:
       /** \brief The number of points to use for mean distance estimation. */
       int mean_k_;
@@ -262,6 +288,9 @@ namespace pcl
       /** \brief A pointer to the spatial search object. */
       KdTreePtr tree_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       void
       applyFilter (std::vector<int> &indices) override;
 
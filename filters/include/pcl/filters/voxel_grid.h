@@ -205,7 +205,8 @@ namespace pcl
         filter_limit_min_ (-FLT_MAX),
         filter_limit_max_ (FLT_MAX),
         filter_limit_negative_ (false),
-        min_points_per_voxel_ (0)
+        min_points_per_voxel_ (0),
+        threads_ (1)
       {
         filter_name_ = "VoxelGrid";
       }
@@ -451,6 +452,17 @@ namespace pcl
         return (filter_limit_negative_);
       }
 
+      /** \brief Set the number of threads used to compute the leaf indices, sort them and compute the centroids.
+        * The output is identical to the one obtained with a single thread.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used for filtering. */
+      inline unsigned int
+      getNumberOfThreads () const { return (threads_); }
+
     protected:
       /** \brief The size of a leaf. */
       Eigen::Vector4f leaf_size_;
@@ -485,6 +497,9 @@ namespace pcl
       /** \brief Minimum number of points per voxel for the centroid to be computed */
       unsigned int min_points_per_voxel_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       using FieldList = typename pcl::traits::fieldList<PointT>::type;
 
       /** \brief Downsample a Point Cloud using a voxelized grid approach
@@ -42,6 +42,24 @@
 #include <pcl/conversions.h>
 #include <pcl/memory.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::RadiusOutlierRemoval<pcl::PCLPointCloud2>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 void
 pcl::RadiusOutlierRemoval<pcl::PCLPointCloud2>::applyFilter (PCLPointCloud2 &output)
@@ -83,8 +101,18 @@ pcl::RadiusOutlierRemoval<pcl::PCLPointCloud2>::applyFilter (PCLPointCloud2 &out
   searcher_->setInputCloud (cloud);
 
   // Allocate enough space to hold the results
-  std::vector<int> nn_indices (indices_->size ());
-  std::vector<float> nn_dists (indices_->size ());
+  std::vector<int> nn_indices;
+  std::vector<float> nn_dists;
+  std::vector<int> nr_neighbors (indices_->size ());
+
+  // Count the neighbors of every point, in parallel
+#pragma omp parallel for \
+  default(none) \
+  shared(nr_neighbors) \
+  firstprivate(nn_indices, nn_dists) \
+  num_threads(threads_)
+  for (std::ptrdiff_t cp = 0; cp < static_cast<std::ptrdiff_t> (indices_->size ()); ++cp)
+    nr_neighbors[cp] = searcher_->radiusSearch ((*indices_)[cp], search_radius_, nn_indices, nn_dists);
 
   // Copy the common fields
   output.is_dense = input_->is_dense;
@@ -111,9 +139,8 @@ pcl::RadiusOutlierRemoval<pcl::PCLPointCloud2>::applyFilter (PCLPointCloud2 &out
   {
     //if(cp%log_step == 0)
     //  PCL_DEBUG ("[pcl::%s::applyFilter] Iteration %i of %lu\n", getClassName ().c_str (), cp, indices_->size());
-    int k = searcher_->radiusSearch ((*indices_)[cp], search_radius_, nn_indices, nn_dists);
     // Check if the number of neighbors is larger than the user imposed limit
-    if (k < min_pts_radius_)
+    if (nr_neighbors[cp] < min_pts_radius_)
     {
       if (extract_removed_indices_)
       {
@@ -178,62 +205,68 @@ pcl::RadiusOutlierRemoval<pcl::PCLPointCloud2>::applyFilter (std::vector<int> &i
   searcher_->setInputCloud (cloud);
 
   // The arrays to be used
-  std::vector<int> nn_indices (indices_->size ());
-  std::vector<float> nn_dists (indices_->size ());
+  std::vector<int> nn_indices;
+  std::vector<float> nn_dists;
+  std::vector<char> chk_neighbors (indices_->size ());
   indices.resize (indices_->size ());
   removed_indices_->resize (indices_->size ());
   int oii = 0, rii = 0;  // oii = output indices iterator, rii = removed indices iterator
 
+  // First pass: Check the number of neighbors of every point, in parallel
   // If the data is dense => use nearest-k search
   if (cloud->is_dense)
   {
     // Note: k includes the query point, so is always at least 1
-    int mean_k = min_pts_radius_ + 1;
-    double nn_dists_max = search_radius_ * search_radius_;
+    const int mean_k = min_pts_radius_ + 1;
+    const double nn_dists_max = search_radius_ * search_radius_;
 
-    for (const auto idx : *indices_)
+#pragma omp parallel for \
+  default(none) \
+  shared(chk_neighbors) \
+  firstprivate(mean_k, nn_dists_max, nn_indices, nn_dists) \
+  num_threads(threads_)
+    for (std::ptrdiff_t iii = 0; iii < static_cast<std::ptrdiff_t> (indices_->size ()); ++iii)
     {
       // Perform the nearest-k search
-      int k = searcher_->nearestKSearch (idx, mean_k, nn_indices, nn_dists);
+      const int k = searcher_->nearestKSearch ((*indices_)[iii], mean_k, nn_indices, nn_dists);
 
       // Check the number of neighbors
       // Note: nn_dists is sorted, so check the last item
-      bool chk_neighbors = (k == mean_k)? (negative_ == (nn_dists_max < nn_dists[k-1])) : negative_;
-
-      // Points having too few neighbors are outliers and are passed to removed indices
-      // Unless negative was set, then it's the opposite condition
-      if (!chk_neighbors)
-      {
-        if (extract_removed_indices_)
-          (*removed_indices_)[rii++] = idx;
-        continue;
-      }
-
-      // Otherwise it was a normal point for output (inlier)
-      indices[oii++] = idx;
+      chk_neighbors[iii] = (k == mean_k) ? (negative_ == (nn_dists_max < nn_dists[k-1])) : negative_;
     }
   }
   // NaN or Inf values could exist => use radius search
   else
   {
-    for (const auto idx : *indices_)
+#pragma omp parallel for \
+  default(none) \
+  shared(chk_neighbors) \
+  firstprivate(nn_indices, nn_dists) \
+  num_threads(threads_)
+    for (std::ptrdiff_t iii = 0; iii < static_cast<std::ptrdiff_t> (indices_->size ()); ++iii)
     {
       // Perform the radius search
       // Note: k includes the query point, so is always at least 1
-      int k = searcher_->radiusSearch (idx, search_radius_, nn_indices, nn_dists);
+      const int k = searcher_->radiusSearch ((*indices_)[iii], search_radius_, nn_indices, nn_dists);
 
-      // Points having too few neighbors are outliers and are passed to removed indices
-      // Unless negative was set, then it's the opposite condition
-      if ((!negative_ && k <= min_pts_radius_) || (negative_ && k > min_pts_radius_))
-      {
-        if (extract_removed_indices_)
-          (*removed_indices_)[rii++] = idx;
-        continue;
-      }
+      // Unless negative was set, points having too few neighbors fail the check
+      chk_neighbors[iii] = negative_ ? k <= min_pts_radius_ : k > min_pts_radius_;
+    }
+  }
 
-      // Otherwise it was a normal point for output (inlier)
-      indices[oii++] = idx;
+  // Second pass: Points having too few neighbors are outliers and are passed to removed indices
+  // Unless negative was set, then it's the opposite condition
+  for (std::size_t iii = 0; iii < indices_->size (); ++iii)
+  {
+    if (!chk_neighbors[iii])
+    {
+      if (extract_removed_indices_)
+        (*removed_indices_)[rii++] = (*indices_)[iii];
+      continue;
     }
+
+    // Otherwise it was a normal point for output (inlier)
+    indices[oii++] = (*indices_)[iii];
   }
 
   // Resize the output arrays
@@ -41,8 +41,26 @@
 #include <pcl/filters/impl/statistical_outlier_removal.hpp>
 #include <pcl/conversions.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 using namespace std;
 
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::StatisticalOutlierRemoval<pcl::PCLPointCloud2>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 void
 pcl::StatisticalOutlierRemoval<pcl::PCLPointCloud2>::applyFilter (PCLPointCloud2 &output)
@@ -162,6 +180,8 @@ pcl::StatisticalOutlierRemoval<pcl::PCLPointCloud2>::applyFilter (vector<int>& i
   double const distance_threshold = mean + std_mul_ * stddev; // a distance that is bigger than this signals an outlier
 
   // Second pass: Classify the points on the computed distance threshold
+  indices.resize (indices_->size ());
+  removed_indices_->resize (indices_->size ());
   std::size_t nr_p = 0, nr_removed_p = 0;
   for (std::size_t cp = 0; cp < indices_->size (); ++cp)
   {
@@ -180,7 +200,7 @@ pcl::StatisticalOutlierRemoval<pcl::PCLPointCloud2>::applyFilter (vector<int>& i
 
   // Resize the output arrays
   indices.resize (nr_p);
-  removed_indices_->resize (nr_p);
+  removed_indices_->resize (nr_removed_p);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -212,7 +232,13 @@ pcl::StatisticalOutlierRemoval<pcl::PCLPointCloud2>::generateStatistics (double&
   distances.resize (indices_->size ());
   int valid_distances = 0;
   // Go over all the points and calculate the mean or smallest distance
-  for (std::size_t cp = 0; cp < indices_->size (); ++cp)
+#pragma omp parallel for \
+  default(none) \
+  shared(cloud, distances) \
+  firstprivate(nn_indices, nn_dists) \
+  reduction(+:valid_distances) \
+  num_threads(threads_)
+  for (std::ptrdiff_t cp = 0; cp < static_cast<std::ptrdiff_t> (indices_->size ()); ++cp)
   {
     if (!std::isfinite (cloud->points[(*indices_)[cp]].x) || 
         !std::isfinite (cloud->points[(*indices_)[cp]].y) ||
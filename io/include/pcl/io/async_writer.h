@@ -0,0 +1,270 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/exceptions.h>
+#include <pcl/pcl_macros.h>
+#include <pcl/point_cloud.h>
+#include <pcl/io/pcd_io.h>
+#include <pcl/io/ply_io.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace pcl
+{
+  namespace io
+  {
+    /** \brief Asynchronous point cloud writer, which keeps disk I/O off the thread producing the clouds.
+      *
+      * Clouds are queued by write () and serialized to PCD or PLY files by a pool of worker threads. The queue is
+      * bounded: when it is full, write () either blocks until a frame has been written, or drops a frame, depending
+      * on the overflow policy. Written files can be synchronized to the disk (fsync) in batches, and statistics on
+      * the throughput of the writer are available at any time.
+      *
+      * The queue holds shared pointers to the clouds, which must not be modified until they are written:
+      * \code
+      * pcl::io::AsyncWriter writer (8, 2);
+      * writer.setFormat (pcl::io::AsyncWriter::PCD_BINARY_COMPRESSED);
+      * // In the grabber callback
+      * writer.write<pcl::PointXYZRGBA> (file_name, cloud);
+      * \endcode
+      * \note With a capacity of 2 frames and a single thread, the writer is a double buffer.
+      * \ingroup io
+      */
+    class PCL_EXPORTS AsyncWriter
+    {
+      public:
+        /** \brief File formats of the written clouds. */
+        enum Format
+        {
+          PCD_ASCII,
+          PCD_BINARY,
+          PCD_BINARY_COMPRESSED,
+          PCD_BINARY_COMPRESSED_CHUNKED,
+          PLY_ASCII,
+          PLY_BINARY
+        };
+
+        /** \brief What write () does when the queue is full. */
+        enum OverflowPolicy
+        {
+          /** Wait until a frame has been written. No frame is lost, but the producer is slowed down. */
+          BLOCK,
+          /** Drop the new frame. */
+          DROP_NEWEST,
+          /** Drop the oldest queued frame to make room for the new one. */
+          DROP_OLDEST
+        };
+
+        /** \brief Counters of the writer since its construction. */
+        struct Statistics
+        {
+          /** \brief The number of frames accepted by write (). */
+          std::size_t frames_queued = 0;
+          /** \brief The number of frames written successfully. */
+          std::size_t frames_written = 0;
+          /** \brief The number of frames dropped because the queue was full. */
+          std::size_t frames_dropped = 0;
+          /** \brief The number of frames which could not be written. */
+          std::size_t frames_failed = 0;
+          /** \brief The size of the written files in bytes. */
+          std::uint64_t bytes_written = 0;
+          /** \brief The number of fsync batches. */
+          std::size_t syncs = 0;
+          /** \brief The time during which at least one frame was being written, in seconds. */
+          double busy_time = 0.0;
+
+          /** \brief Get the write throughput in MB/s, over the time the writer was busy. */
+          inline double
+          getThroughput () const
+          {
+            return (busy_time > 0.0 ? static_cast<double> (bytes_written) / (1024.0 * 1024.0) / busy_time : 0.0);
+          }
+        };
+
+        /** \brief Constructor, starts the worker threads.
+          * \param[in] capacity the maximum number of frames waiting to be written, which bounds the memory held
+          * by the writer
+          * \param[in] nr_threads the number of worker threads (0 sets it to the number of hardware threads)
+          */
+        AsyncWriter (std::size_t capacity = 16, unsigned int nr_threads = 1);
+
+        AsyncWriter (const AsyncWriter&) = delete;
+        AsyncWriter& operator= (const AsyncWriter&) = delete;
+
+        /** \brief Destructor, writes all the queued frames and stops the worker threads. */
+        ~AsyncWriter ();
+
+        /** \brief Set the format of the frames queued from now on. Default: PCD_BINARY */
+        inline void
+        setFormat (Format format) { std::lock_guard<std::mutex> lock (mutex_); format_ = format; }
+
+        /** \brief Get the format of the frames queued from now on. */
+        inline Format
+        getFormat () const { std::lock_guard<std::mutex> lock (mutex_); return (format_); }
+
+        /** \brief Set what write () does when the queue is full. Default: BLOCK */
+        inline void
+        setOverflowPolicy (OverflowPolicy policy) { std::lock_guard<std::mutex> lock (mutex_); policy_ = policy; }
+
+        /** \brief Get what write () does when the queue is full. */
+        inline OverflowPolicy
+        getOverflowPolicy () const { std::lock_guard<std::mutex> lock (mutex_); return (policy_); }
+
+        /** \brief Synchronize the written files to the disk every nr_frames frames. Default: 0 (never, except
+          * in flush ())
+          * \param[in] nr_frames the number of written frames per fsync batch
+          */
+        inline void
+        setSyncInterval (std::size_t nr_frames) { std::lock_guard<std::mutex> lock (mutex_); sync_interval_ = nr_frames; }
+
+        /** \brief Get the number of written frames per fsync batch. */
+        inline std::size_t
+        getSyncInterval () const { std::lock_guard<std::mutex> lock (mutex_); return (sync_interval_); }
+
+        /** \brief Get the maximum number of frames waiting to be written. */
+        inline std::size_t
+        getCapacity () const { return (capacity_); }
+
+        /** \brief Get the number of frames waiting to be written. */
+        std::size_t
+        getQueueSize () const;
+
+        /** \brief Get the counters of the writer. */
+        Statistics
+        getStatistics () const;
+
+        /** \brief Queue a cloud to be written to a file in the current format.
+          * \param[in] file_name the output file name
+          * \param[in] cloud the cloud, which must not be modified until it is written
+          * \return false if the frame, or the oldest queued frame with DROP_OLDEST, was dropped
+          */
+        template <typename PointT> bool
+        write (const std::string &file_name, const typename pcl::PointCloud<PointT>::ConstPtr &cloud)
+        {
+          if (!cloud || cloud->empty ())
+          {
+            PCL_ERROR ("[pcl::io::AsyncWriter::write] Input point cloud has no data!\n");
+            return (false);
+          }
+          WriteFunction write_cloud = [cloud] (const std::string &file_name, Format format)
+          {
+            switch (format)
+            {
+              case PCD_ASCII:
+                return (PCDWriter ().writeASCII<PointT> (file_name, *cloud));
+              case PCD_BINARY:
+                return (PCDWriter ().writeBinary<PointT> (file_name, *cloud));
+              case PCD_BINARY_COMPRESSED:
+                return (PCDWriter ().writeBinaryCompressed<PointT> (file_name, *cloud));
+              case PCD_BINARY_COMPRESSED_CHUNKED:
+                return (PCDWriter ().writeBinaryCompressedChunked<PointT> (file_name, *cloud));
+              case PLY_ASCII:
+                return (PLYWriter ().write<PointT> (file_name, *cloud, false));
+              case PLY_BINARY:
+                return (PLYWriter ().write<PointT> (file_name, *cloud, true));
+            }
+            return (-1);
+          };
+          return (enqueue (file_name, std::move (write_cloud)));
+        }
+
+        /** \brief Block until all the queued frames are written, and synchronize the written files to the disk. */
+        void
+        flush ();
+
+      protected:
+        /** \brief A function writing a frame to a file in a given format, returning 0 on success. */
+        using WriteFunction = std::function<int (const std::string&, Format)>;
+
+        /** \brief Queue a frame, applying the overflow policy if the queue is full.
+          * \return false if a frame was dropped
+          */
+        bool
+        enqueue (const std::string &file_name, WriteFunction &&write_function);
+
+      private:
+        /** \brief A queued frame. */
+        struct Frame
+        {
+          std::string file_name;
+          Format format;
+          WriteFunction write;
+        };
+
+        /** \brief Loop of a worker thread: write frames until the writer is destroyed. */
+        void
+        run ();
+
+        /** \brief Write the unsynchronized files to the disk. */
+        void
+        sync (const std::vector<std::string> &file_names);
+
+        std::size_t capacity_;
+        Format format_ = PCD_BINARY;
+        OverflowPolicy policy_ = BLOCK;
+        std::size_t sync_interval_ = 0;
+
+        std::deque<Frame> queue_;
+        /** \brief The number of frames being written. */
+        std::size_t nr_writing_ = 0;
+        /** \brief The written files which have not been synchronized to the disk yet. */
+        std::vector<std::string> unsynced_;
+        Statistics statistics_;
+        /** \brief When the writer last started writing a frame while no other frame was being written. */
+        std::chrono::steady_clock::time_point busy_since_;
+        bool stop_ = false;
+
+        mutable std::mutex mutex_;
+        /** \brief Notified when a frame is queued, and when the writer stops. */
+        std::condition_variable frame_queued_;
+        /** \brief Notified when a frame is taken off the queue or written. */
+        std::condition_variable frame_done_;
+
+        std::vector<std::thread> threads_;
+    };
+  }
+}
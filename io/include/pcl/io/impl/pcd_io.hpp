@@ -428,6 +428,38 @@ pcl::PCDWriter::writeBinaryCompressed (const std::string &file_name,
   return (0);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::PCDWriter::writeBinaryCompressedChunked (const std::string &file_name,
+                                              const pcl::PointCloud<PointT> &cloud)
+{
+  if (cloud.points.empty ())
+  {
+    throw pcl::IOException ("[pcl::PCDWriter::writeBinaryCompressedChunked] Input point cloud has no data!");
+    return (-1);
+  }
+
+  std::ofstream fs;
+  fs.open (file_name.c_str (), std::ios::binary);      // Open file
+  if (!fs.is_open () || fs.fail ())
+  {
+    throw pcl::IOException ("[pcl::PCDWriter::writeBinaryCompressedChunked] Could not open file for writing!");
+    return (-1);
+  }
+
+  // Mandatory lock file
+  boost::interprocess::file_lock file_lock;
+  setLockingPermissions (file_name, file_lock);
+
+  // The points are compressed straight from the cloud, without an intermediate PCLPointCloud2
+  fs << generateHeader<PointT> (cloud);
+  int res = writeChunks (fs, reinterpret_cast<const std::uint8_t*> (&cloud.points[0]), cloud.points.size (),
+                         sizeof (PointT), pcl::getFields<PointT> ());
+  fs.close ();
+  resetLockingPermissions (file_name, file_lock);
+  return (res);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> int
 pcl::PCDWriter::writeASCII (const std::string &file_name, const pcl::PointCloud<PointT> &cloud, 
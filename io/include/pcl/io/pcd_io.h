@@ -42,8 +42,13 @@
 #include <pcl/memory.h>
 #include <pcl/pcl_macros.h>
 #include <pcl/point_cloud.h>
+#include <pcl/conversions.h>
 #include <pcl/io/file_io.h>
 
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+
 namespace pcl
 {
   /** \brief Point Cloud Data (PCD) file format reader.
@@ -54,10 +59,16 @@ namespace pcl
   {
     public:
       /** Empty constructor */
-      PCDReader () {}
+      PCDReader () : threads_ (0) {}
       /** Empty destructor */
       ~PCDReader () {}
 
+      /** \brief Set the number of threads used to decompress binary compressed chunked files.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
       /** \brief Various PCD file versions.
         *
         * PCD_V6 represents PCD files with version 0.6, which contain the following fields:
@@ -101,7 +112,7 @@ namespace pcl
         * \param[out] origin the sensor acquisition origin (only for > PCD_V7 - null if not present)
         * \param[out] orientation the sensor acquisition orientation (only for > PCD_V7 - identity if not present)
         * \param[out] pcd_version the PCD version of the file (i.e., PCD_V6, PCD_V7)
-        * \param[out] data_type the type of data (0 = ASCII, 1 = Binary, 2 = Binary compressed)
+        * \param[out] data_type the type of data (0 = ASCII, 1 = Binary, 2 = Binary compressed, 3 = Binary compressed chunked)
         * \param[out] data_idx the offset of cloud data within the file
         *
         * \return
@@ -129,7 +140,7 @@ namespace pcl
         * \param[out] origin the sensor acquisition origin (only for > PCD_V7 - null if not present)
         * \param[out] orientation the sensor acquisition orientation (only for > PCD_V7 - identity if not present)
         * \param[out] pcd_version the PCD version of the file (i.e., PCD_V6, PCD_V7)
-        * \param[out] data_type the type of data (0 = ASCII, 1 = Binary, 2 = Binary compressed)
+        * \param[out] data_type the type of data (0 = ASCII, 1 = Binary, 2 = Binary compressed, 3 = Binary compressed chunked)
         * \param[out] data_idx the offset of cloud data within the file
         * \param[in] offset the offset of where to expect the PCD Header in the
         * file (optional parameter). One usage example for setting the offset
@@ -214,6 +225,24 @@ namespace pcl
       readBodyBinary (const unsigned char *data, pcl::PCLPointCloud2 &cloud,
                        int pcd_version, bool compressed, unsigned int data_idx);
 
+      /** \brief Read the point cloud data (body) of a binary compressed chunked file from a block of memory.
+        *
+        * For use after readHeader(), when the resulting data_type is 3. The chunks are decompressed in
+        * parallel, see setNumberOfThreads.
+        *
+        * \param[in] data the memory location from which to read the body.
+        * \param[in] data_size the number of bytes available at data, which bounds the chunk index.
+        * \param[out] cloud the resultant point cloud dataset to be filled.
+        * \param[in] data_idx the offset of the body, as reported by readHeader().
+        *
+        * \return
+        *  * < 0 (-1) on error
+        *  * == 0 on success
+        */
+      int
+      readBodyBinaryChunked (const unsigned char *data, std::size_t data_size,
+                             pcl::PCLPointCloud2 &cloud, unsigned int data_idx);
+
       /** \brief Read a point cloud data from a PCD file and store it into a pcl/PCLPointCloud2.
         * \param[in] file_name the name of the file containing the actual PointCloud data
         * \param[out] cloud the resultant PointCloud message read from disk
@@ -286,6 +315,225 @@ namespace pcl
         return (res);
       }
 
+    private:
+      /** \brief The number of threads used to decompress chunked files (0 = automatic). */
+      unsigned int threads_;
+
+    public:
+      PCL_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+  /** \brief Lazy reader of binary and binary compressed Point Cloud Data (PCD) files.
+    *
+    * Contrary to PCDReader, which copies all the points of a file into a PCLPointCloud2, LazyPCDReader keeps the
+    * file memory mapped and gives access to rows, ranges of points or single fields through strided views on the
+    * mapped data. Only the pages of the file which are actually touched are read from the disk, so reading a few
+    * fields of a subset of the points of a large file is cheap.
+    *
+    * \note Binary compressed files are decompressed as a whole on the first access to their points, because LZF
+    * does not support random access. Binary compressed chunked files are decompressed chunk by chunk instead, and
+    * only the chunks holding requested points are decompressed. ASCII files can not be mapped, use PCDReader instead.
+    * \note The views are valid until the file is closed. The reader is thread-safe for concurrent reads.
+    * \ingroup io
+    */
+  class PCL_EXPORTS LazyPCDReader
+  {
+    public:
+      /** \brief Read-only strided view on the serialized points of a file: element i starts at data + i * stride.
+        * The serialized data is not aligned, get copies the values out.
+        */
+      struct View
+      {
+        /** \brief The first byte of the first element. */
+        const std::uint8_t *data = nullptr;
+        /** \brief The number of bytes between two elements. */
+        std::size_t stride = 0;
+        /** \brief The number of elements. */
+        std::size_t size = 0;
+
+        inline bool
+        empty () const { return (size == 0); }
+
+        /** \brief Get the first byte of element i. */
+        inline const std::uint8_t*
+        operator[] (std::size_t i) const { return (data + i * stride); }
+
+        /** \brief Get the value at index c of element i, for elements made of values of type T. */
+        template <typename T> inline T
+        get (std::size_t i, unsigned int c = 0) const
+        {
+          T value;
+          std::memcpy (&value, data + i * stride + c * sizeof (T), sizeof (T));
+          return (value);
+        }
+      };
+
+      LazyPCDReader () = default;
+      LazyPCDReader (const LazyPCDReader&) = delete;
+      LazyPCDReader& operator= (const LazyPCDReader&) = delete;
+
+      /** \brief Destructor, unmaps the file. */
+      ~LazyPCDReader () { close (); }
+
+      /** \brief Read the header of a binary PCD file and map its data, without reading any point.
+        * \param[in] file_name the name of the file to open
+        * \param[in] offset the offset of where to expect the PCD Header in the file (see PCDReader::readHeader)
+        * \return
+        *  * < 0 (-1) on error
+        *  * == 0 on success
+        */
+      int
+      open (const std::string &file_name, const int offset = 0);
+
+      /** \brief Unmap the file. All the views become invalid. */
+      void
+      close ();
+
+      /** \brief Return whether a file is mapped. */
+      inline bool
+      isOpen () const { return (map_ != nullptr); }
+
+      /** \brief Return whether the mapped file is binary compressed, chunked or not. */
+      inline bool
+      isCompressed () const { return (data_type_ >= 2); }
+
+      /** \brief Set the number of threads used to decompress the chunks of binary compressed chunked files.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
+      /** \brief Get the layout of the points of the file: fields, width, height, point_step and row_step. The data
+        * of the returned cloud is empty, and is_dense is false as the points have not been checked.
+        */
+      inline const pcl::PCLPointCloud2&
+      getHeader () const { return (header_); }
+
+      /** \brief Get the sensor acquisition origin stored in the file. */
+      inline const Eigen::Vector4f&
+      getOrigin () const { return (origin_); }
+
+      /** \brief Get the sensor acquisition orientation stored in the file. */
+      inline const Eigen::Quaternionf&
+      getOrientation () const { return (orientation_); }
+
+      /** \brief Get the number of points of the file. */
+      inline std::size_t
+      size () const { return (static_cast<std::size_t> (header_.width) * header_.height); }
+
+      /** \brief Get a view on the points [first, first + count), clamped to the number of points. Each element is a
+        * serialized point of header.point_step bytes, with the layout of getHeader ().fields.
+        */
+      View
+      getPoints (std::size_t first, std::size_t count) const;
+
+      /** \brief Get a view on the points of a row of an organized file. */
+      View
+      getRow (std::uint32_t row) const;
+
+      /** \brief Get a view on the values of a field of the points [first, first + count), clamped to the number of
+        * points. Each element is the field of a point, made of count values of the type of the field.
+        * \return an empty view if the file has no such field
+        */
+      View
+      getField (const std::string &field_name, std::size_t first = 0,
+                std::size_t count = std::numeric_limits<std::size_t>::max ()) const;
+
+      /** \brief Copy a subset of the points into an unorganized PCLPointCloud2 with the layout of the file.
+        * \param[in] indices the indices of the points to copy
+        * \param[out] cloud the resultant point cloud
+        * \return
+        *  * < 0 (-1) on error, if the file is not open or an index is out of range
+        *  * == 0 on success
+        */
+      int
+      read (const Indices &indices, pcl::PCLPointCloud2 &cloud) const;
+
+      /** \brief Copy the fields of PointT of a subset of the points into an unorganized PointCloud. Only the
+        * serialized fields which PointT has are read.
+        * \param[in] indices the indices of the points to copy
+        * \param[out] cloud the resultant point cloud
+        * \return
+        *  * < 0 (-1) on error, if the file is not open or an index is out of range
+        *  * == 0 on success
+        */
+      template <typename PointT> int
+      read (const Indices &indices, pcl::PointCloud<PointT> &cloud) const
+      {
+        const View points = getPoints (indices);
+        if (points.empty ())
+          return (-1);
+        MsgFieldMap field_map;
+        createMapping<PointT> (header_.fields, field_map);
+
+        cloud.header = header_.header;
+        cloud.sensor_origin_ = origin_;
+        cloud.sensor_orientation_ = orientation_;
+        cloud.points.resize (indices.size ());
+        for (std::size_t i = 0; i < indices.size (); ++i)
+        {
+          if (indices[i] < 0 || static_cast<std::size_t> (indices[i]) >= points.size)
+          {
+            PCL_ERROR ("[pcl::LazyPCDReader::read] Index %d out of range (%lu points)!\n", indices[i], points.size);
+            cloud.points.clear ();
+            return (-1);
+          }
+          std::uint8_t *point = reinterpret_cast<std::uint8_t*> (&cloud.points[i]);
+          for (const detail::FieldMapping &mapping : field_map)
+            std::memcpy (point + mapping.struct_offset, points[indices[i]] + mapping.serialized_offset, mapping.size);
+        }
+        cloud.width = static_cast<std::uint32_t> (indices.size ());
+        cloud.height = 1;
+        cloud.is_dense = false;
+        return (0);
+      }
+
+    private:
+      /** \brief Get the serialized points, decompressing them first for binary compressed files. */
+      const std::uint8_t*
+      getData () const;
+
+      /** \brief Get a view on all the points, of which at least the points of indices are available. */
+      View
+      getPoints (const Indices &indices) const;
+
+      /** \brief Decompress the given chunks of a binary compressed chunked file, unless they already are.
+        * \return the points of the file, or nullptr if a chunk could not be decompressed
+        */
+      const std::uint8_t*
+      decompressChunks (const std::vector<std::size_t> &chunks) const;
+
+      /** \brief The layout of the points, without data. */
+      pcl::PCLPointCloud2 header_;
+      Eigen::Vector4f origin_ = Eigen::Vector4f::Zero ();
+      Eigen::Quaternionf orientation_ = Eigen::Quaternionf::Identity ();
+
+      /** \brief The type of data (1 = Binary, 2 = Binary compressed, 3 = Binary compressed chunked). */
+      int data_type_ = 0;
+      /** \brief The offset of the data in the file. */
+      std::size_t data_offset_ = 0;
+
+      /** \brief The mapped file. */
+      unsigned char *map_ = nullptr;
+      std::size_t map_size_ = 0;
+#ifdef _WIN32
+      void *file_mapping_ = nullptr;
+#endif
+
+      /** \brief The decompressed points of a binary compressed file, filled on the first access. */
+      mutable std::vector<std::uint8_t> decompressed_;
+      mutable std::mutex decompress_mutex_;
+
+      /** \brief The number of points per chunk of a chunked file, and the offsets of its chunks in the map. */
+      std::size_t chunk_points_ = 0;
+      std::vector<std::size_t> chunk_offsets_;
+      /** \brief The points of a chunked file, of which only the decompressed chunks are initialized. */
+      mutable std::unique_ptr<std::uint8_t[]> chunked_points_;
+      mutable std::vector<bool> chunk_decompressed_;
+      /** \brief The number of threads used to decompress chunks (0 = automatic). */
+      unsigned int threads_ = 0;
+
+    public:
       PCL_MAKE_ALIGNED_OPERATOR_NEW
   };
 
@@ -296,9 +544,26 @@ namespace pcl
   class PCL_EXPORTS PCDWriter : public FileWriter
   {
     public:
-      PCDWriter() : map_synchronization_(false) {}
+      PCDWriter() : map_synchronization_(false), threads_(0), chunk_size_(65536) {}
       ~PCDWriter() {}
 
+      /** \brief Set the number of threads used to compress the chunks of binary compressed chunked files.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      inline void
+      setNumberOfThreads (unsigned int nr_threads = 0) { threads_ = nr_threads; }
+
+      /** \brief Set the number of points per chunk of binary compressed chunked files. Smaller chunks give
+        * more parallelism and finer partial reads, larger chunks compress slightly better. Default: 65536
+        * \param[in] chunk_size the number of points per chunk
+        */
+      inline void
+      setChunkSize (unsigned int chunk_size) { chunk_size_ = chunk_size; }
+
+      /** \brief Get the number of points per chunk of binary compressed chunked files. */
+      inline unsigned int
+      getChunkSize () const { return (chunk_size_); }
+
       /** \brief Set whether mmap() synchornization via msync() is desired before munmap() calls.
         * Setting this to true could prevent NFS data loss (see
         * http://www.pcl-developers.org/PCD-IO-consistency-on-NFS-msync-needed-td4885942.html).
@@ -431,6 +696,39 @@ namespace pcl
                              const Eigen::Vector4f &origin = Eigen::Vector4f::Zero (),
                              const Eigen::Quaternionf &orientation = Eigen::Quaternionf::Identity ());
 
+      /** \brief Save point cloud data to a PCD file containing n-D points, in BINARY_COMPRESSED_CHUNKED format.
+        *
+        * The points are split in chunks of getChunkSize () points, which are compressed independently and in
+        * parallel (see setNumberOfThreads). The chunks can then be decompressed in parallel, or one at a time by
+        * LazyPCDReader. There is no limit on the size of the cloud. Readers which do not support the format
+        * reject the file with an error instead of misreading it.
+        * \param[in] file_name the output file name
+        * \param[in] cloud the point cloud data message
+        * \param[in] origin the sensor acquisition origin
+        * \param[in] orientation the sensor acquisition orientation
+        * \return
+        * (-1) for a general error
+        * 0 on success
+        */
+      int
+      writeBinaryCompressedChunked (const std::string &file_name, const pcl::PCLPointCloud2 &cloud,
+                                    const Eigen::Vector4f &origin = Eigen::Vector4f::Zero (),
+                                    const Eigen::Quaternionf &orientation = Eigen::Quaternionf::Identity ());
+
+      /** \brief Save point cloud data to a std::ostream containing n-D points, in BINARY_COMPRESSED_CHUNKED format
+        * \param[out] os the stream into which to write the data
+        * \param[in] cloud the point cloud data message
+        * \param[in] origin the sensor acquisition origin
+        * \param[in] orientation the sensor acquisition orientation
+        * \return
+        * (-1) for a general error
+        * 0 on success
+        */
+      int
+      writeBinaryCompressedChunked (std::ostream &os, const pcl::PCLPointCloud2 &cloud,
+                                    const Eigen::Vector4f &origin = Eigen::Vector4f::Zero (),
+                                    const Eigen::Quaternionf &orientation = Eigen::Quaternionf::Identity ());
+
       /** \brief Save point cloud data to a PCD file containing n-D points
         * \param[in] file_name the output file name
         * \param[in] cloud the point cloud data message
@@ -503,6 +801,17 @@ namespace pcl
       writeBinaryCompressed (const std::string &file_name,
                              const pcl::PointCloud<PointT> &cloud);
 
+      /** \brief Save point cloud data to a binary compressed chunked PCD file
+        * \param[in] file_name the output file name
+        * \param[in] cloud the point cloud data message
+        * \return
+        * (-1) for a general error
+        * 0 on success
+        */
+      template <typename PointT> int
+      writeBinaryCompressedChunked (const std::string &file_name,
+                                    const pcl::PointCloud<PointT> &cloud);
+
       /** \brief Save point cloud data to a PCD file containing n-D points, in BINARY format
         * \param[in] file_name the output file name
         * \param[in] cloud the point cloud data message
@@ -600,9 +909,26 @@ namespace pcl
       resetLockingPermissions (const std::string &file_name,
                                boost::interprocess::file_lock &lock);
 
+      /** \brief Write the DATA line and the compressed chunks of a binary compressed chunked file.
+        * \param[out] os the stream into which to write the data, after the header
+        * \param[in] data the serialized points
+        * \param[in] nr_points the number of points
+        * \param[in] point_step the size of a serialized point in bytes
+        * \param[in] fields the fields of the points, "_" padding fields are not written
+        */
+      int
+      writeChunks (std::ostream &os, const std::uint8_t *data, std::size_t nr_points,
+                   std::size_t point_step, const std::vector<pcl::PCLPointField> &fields);
+
     private:
       /** \brief Set to true if msync() should be called before munmap(). Prevents data loss on NFS systems. */
       bool map_synchronization_;
+
+      /** \brief The number of threads used to compress chunks (0 = automatic). */
+      unsigned int threads_;
+
+      /** \brief The number of points per chunk of binary compressed chunked files. */
+      unsigned int chunk_size_;
   };
 
   namespace io
@@ -782,6 +1108,21 @@ namespace pcl
       return (w.writeBinaryCompressed<PointT> (file_name, cloud));
     }
 
+    /**
+      * \brief Templated version for saving point cloud data to a PCD file
+      * containing a specific given cloud format. This method will write a
+      * compressed binary file made of independently compressed chunks.
+      * \param[in] file_name the output file name
+      * \param[in] cloud the point cloud data message
+      * \ingroup io
+      */
+    template<typename PointT> inline int
+    savePCDFileBinaryCompressedChunked (const std::string &file_name, const pcl::PointCloud<PointT> &cloud)
+    {
+      PCDWriter w;
+      return (w.writeBinaryCompressedChunked<PointT> (file_name, cloud));
+    }
+
   }
 }
 
@@ -244,6 +244,17 @@ namespace pcl
       int
       read (const std::string &file_name, pcl::PolygonMesh &mesh, const int offset = 0);
 
+    protected:
+      /** \brief Read a binary PLY file of which the vertex element is a fixed-size record of scalar properties,
+        * copying whole blocks of vertices into the cloud instead of calling a callback per property. The elements
+        * following the vertices and the camera, such as the faces of a mesh, are not read.
+        * \param[in] file_name the name of the file to read
+        * \param[out] cloud the resultant point cloud, identical to what the parser gives
+        * \return false if the file is not such a file and must be read by the parser
+        */
+      bool
+      readBinaryVertices (const std::string &file_name, pcl::PCLPointCloud2 &cloud);
+
     private:
       ::pcl::io::ply::ply_parser parser_;
 
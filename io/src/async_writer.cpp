@@ -0,0 +1,232 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/io/async_writer.h>
+#include <pcl/io/low_level_io.h>
+#include <pcl/console/print.h>
+
+#include <boost/filesystem.hpp>
+
+#include <fcntl.h>
+
+///////////////////////////////////////////////////////////////////////////////////////////
+pcl::io::AsyncWriter::AsyncWriter (std::size_t capacity, unsigned int nr_threads)
+  : capacity_ ((std::max) (capacity, std::size_t (1)))
+{
+  if (nr_threads == 0)
+    nr_threads = (std::max) (std::thread::hardware_concurrency (), 1u);
+  for (unsigned int i = 0; i < nr_threads; ++i)
+    threads_.emplace_back (&AsyncWriter::run, this);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+pcl::io::AsyncWriter::~AsyncWriter ()
+{
+  flush ();
+  {
+    std::lock_guard<std::mutex> lock (mutex_);
+    stop_ = true;
+  }
+  frame_queued_.notify_all ();
+  for (auto &thread : threads_)
+    thread.join ();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+std::size_t
+pcl::io::AsyncWriter::getQueueSize () const
+{
+  std::lock_guard<std::mutex> lock (mutex_);
+  return (queue_.size ());
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+pcl::io::AsyncWriter::Statistics
+pcl::io::AsyncWriter::getStatistics () const
+{
+  std::lock_guard<std::mutex> lock (mutex_);
+  Statistics statistics = statistics_;
+  // Account for the frames being written
+  if (nr_writing_ > 0)
+    statistics.busy_time += std::chrono::duration<double> (std::chrono::steady_clock::now () - busy_since_).count ();
+  return (statistics);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::io::AsyncWriter::enqueue (const std::string &file_name, WriteFunction &&write_function)
+{
+  std::unique_lock<std::mutex> lock (mutex_);
+  bool dropped = false;
+  if (queue_.size () >= capacity_)
+  {
+    switch (policy_)
+    {
+      case BLOCK:
+        frame_done_.wait (lock, [this] { return (queue_.size () < capacity_); });
+        break;
+      case DROP_NEWEST:
+        ++statistics_.frames_dropped;
+        PCL_WARN ("[pcl::io::AsyncWriter::write] The queue is full, dropping %s!\n", file_name.c_str ());
+        return (false);
+      case DROP_OLDEST:
+        ++statistics_.frames_dropped;
+        PCL_WARN ("[pcl::io::AsyncWriter::write] The queue is full, dropping %s!\n", queue_.front ().file_name.c_str ());
+        queue_.pop_front ();
+        dropped = true;
+        break;
+    }
+  }
+  queue_.push_back (Frame {file_name, format_, std::move (write_function)});
+  ++statistics_.frames_queued;
+  lock.unlock ();
+  frame_queued_.notify_one ();
+  return (!dropped);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::io::AsyncWriter::flush ()
+{
+  std::vector<std::string> file_names;
+  {
+    std::unique_lock<std::mutex> lock (mutex_);
+    frame_done_.wait (lock, [this] { return (queue_.empty () && nr_writing_ == 0); });
+    file_names.swap (unsynced_);
+    if (!file_names.empty ())
+      ++statistics_.syncs;
+  }
+  sync (file_names);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::io::AsyncWriter::run ()
+{
+  std::unique_lock<std::mutex> lock (mutex_);
+  while (true)
+  {
+    frame_queued_.wait (lock, [this] { return (stop_ || !queue_.empty ()); });
+    if (queue_.empty ())
+      return;
+
+    Frame frame = std::move (queue_.front ());
+    queue_.pop_front ();
+    if (nr_writing_++ == 0)
+      busy_since_ = std::chrono::steady_clock::now ();
+    lock.unlock ();
+    // Room was made in the queue for a blocked producer
+    frame_done_.notify_all ();
+
+    // Write the frame without holding the lock
+    int res = -1;
+    try
+    {
+      res = frame.write (frame.file_name, frame.format);
+    }
+    catch (const std::exception &e)
+    {
+      PCL_ERROR ("[pcl::io::AsyncWriter] %s\n", e.what ());
+    }
+    catch (...)
+    {
+      // An exception escaping the worker thread would terminate the program
+      PCL_ERROR ("[pcl::io::AsyncWriter] Unknown exception while writing %s!\n", frame.file_name.c_str ());
+    }
+    std::uint64_t file_size = 0;
+    boost::system::error_code error;
+    if (res == 0)
+      file_size = boost::filesystem::file_size (frame.file_name, error);
+
+    std::vector<std::string> file_names;
+    lock.lock ();
+    if (res == 0)
+    {
+      ++statistics_.frames_written;
+      statistics_.bytes_written += error ? 0 : file_size;
+      unsynced_.push_back (frame.file_name);
+      // Synchronize a whole batch of files at once
+      if (sync_interval_ > 0 && unsynced_.size () >= sync_interval_)
+      {
+        file_names.swap (unsynced_);
+        ++statistics_.syncs;
+      }
+    }
+    else
+    {
+      ++statistics_.frames_failed;
+      PCL_ERROR ("[pcl::io::AsyncWriter] Could not write %s!\n", frame.file_name.c_str ());
+    }
+
+    if (!file_names.empty ())
+    {
+      // The frame is not done until its batch is synchronized, so that flush () waits for it
+      lock.unlock ();
+      sync (file_names);
+      lock.lock ();
+    }
+    if (--nr_writing_ == 0)
+      statistics_.busy_time += std::chrono::duration<double> (std::chrono::steady_clock::now () - busy_since_).count ();
+    frame_done_.notify_all ();
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::io::AsyncWriter::sync (const std::vector<std::string> &file_names)
+{
+  for (const auto &file_name : file_names)
+  {
+#ifdef _WIN32
+    int fd = raw_open (file_name.c_str (), _O_RDWR);
+#else
+    int fd = raw_open (file_name.c_str (), O_RDONLY);
+#endif
+    if (fd == -1)
+    {
+      PCL_ERROR ("[pcl::io::AsyncWriter::sync] Could not open %s!\n", file_name.c_str ());
+      continue;
+    }
+#ifdef _WIN32
+    if (::_commit (fd) != 0)
+#else
+    if (::fsync (fd) != 0)
+#endif
+      PCL_ERROR ("[pcl::io::AsyncWriter::sync] Could not synchronize %s!\n", file_name.c_str ());
+    raw_close (fd);
+  }
+}
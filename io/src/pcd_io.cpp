@@ -50,6 +50,11 @@
 
 #include <cstring>
 #include <cerrno>
+#include <numeric>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include <boost/version.hpp>
 
@@ -108,15 +113,16 @@ pcl::PCDWriter::resetLockingPermissions (const std::string &file_name,
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
-int
-pcl::PCDReader::readHeader (std::istream &fs, pcl::PCLPointCloud2 &cloud,
-                            Eigen::Vector4f &origin, Eigen::Quaternionf &orientation, 
-                            int &pcd_version, int &data_type, unsigned int &data_idx)
+// Parse the header of a PCD stream, without allocating the data of the cloud
+static int
+readHeaderFields (std::istream &fs, pcl::PCLPointCloud2 &cloud,
+                  Eigen::Vector4f &origin, Eigen::Quaternionf &orientation,
+                  int &pcd_version, int &data_type, unsigned int &data_idx, std::size_t &nr_points)
 {
   // Default values
   data_idx = 0;
   data_type = 0;
-  pcd_version = PCD_V6;
+  pcd_version = pcl::PCDReader::PCD_V6;
   origin      = Eigen::Vector4f::Zero ();
   orientation = Eigen::Quaternionf::Identity ();
   cloud.width = cloud.height = cloud.point_step = cloud.row_step = 0;
@@ -125,7 +131,7 @@ pcl::PCDReader::readHeader (std::istream &fs, pcl::PCLPointCloud2 &cloud,
   // By default, assume that there are _no_ invalid (e.g., NaN) points
   //cloud.is_dense = true;
 
-  std::size_t nr_points = 0;
+  nr_points = 0;
   std::string line;
 
   // field_sizes represents the size of one element in a field (e.g., float = 4, char = 1)
@@ -233,7 +239,7 @@ pcl::PCDReader::readHeader (std::istream &fs, pcl::PCLPointCloud2 &cloud,
         for (int i = 0; i < specified_channel_count; ++i)
         {
           field_types[i] = st.at (i + 1).c_str ()[0];
-          cloud.fields[i].datatype = static_cast<std::uint8_t> (getFieldType (field_sizes[i], field_types[i]));
+          cloud.fields[i].datatype = static_cast<std::uint8_t> (pcl::getFieldType (field_sizes[i], field_types[i]));
         }
         continue;
       }
@@ -289,7 +295,7 @@ pcl::PCDReader::readHeader (std::istream &fs, pcl::PCLPointCloud2 &cloud,
       // Get the acquisition viewpoint
       if (line_type.substr (0, 9) == "VIEWPOINT")
       {
-        pcd_version = PCD_V7;
+        pcd_version = pcl::PCDReader::PCD_V7;
         if (st.size () < 8)
           throw "Not enough number of elements in <VIEWPOINT>! Need 7 values (tx ty tz qw qx qy qz).";
 
@@ -307,8 +313,6 @@ pcl::PCDReader::readHeader (std::istream &fs, pcl::PCLPointCloud2 &cloud,
         if (!cloud.point_step)
           throw "Number of POINTS specified before COUNT in header!";
         sstream >> nr_points;
-        // Need to allocate: N * point_step
-        cloud.data.resize (nr_points * cloud.point_step);
         continue;
       }
 
@@ -316,7 +320,9 @@ pcl::PCDReader::readHeader (std::istream &fs, pcl::PCLPointCloud2 &cloud,
       if (line_type.substr (0, 4) == "DATA")
       {
         data_idx = static_cast<int> (fs.tellg ());
-        if (st.at (1).substr (0, 17) == "binary_compressed")
+        if (st.at (1).substr (0, 25) == "binary_compressed_chunked")
+          data_type = 3;
+        else if (st.at (1).substr (0, 17) == "binary_compressed")
          data_type = 2;
         else
           if (st.at (1).substr (0, 6) == "binary")
@@ -374,6 +380,161 @@ pcl::PCDReader::readHeader (std::istream &fs, pcl::PCLPointCloud2 &cloud,
   return (0);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+// Binary compressed chunked data. The data section starts like a binary compressed one, with
+// a compressed size of 4 and an uncompressed size of 1, followed by 4 bytes which are not
+// valid LZF data for a single byte: readers which only know binary_compressed fail to
+// decompress it and reject the file. Then come the number of points per chunk, the number of
+// chunks and the stored size of each chunk, followed by the chunks. A chunk holds the fields
+// of its points as planes (xxyyzz...) like binary compressed data, compressed with LZF, or
+// uncompressed if its stored size is the size of the planes.
+static const std::uint32_t chunked_sizes[2] = {4, 1};
+static const char chunked_magic[4] = {'\x01', 'C', 'N', 'K'};
+static const std::size_t chunked_index_offset = 20;
+
+// Get the fields written in compressed data, i.e. all but the "_" padding, and their sizes
+static std::size_t
+getCompressedFields (const std::vector<pcl::PCLPointField> &cloud_fields,
+                     std::vector<pcl::PCLPointField> &fields, std::vector<std::size_t> &fields_sizes)
+{
+  std::size_t fsize = 0;
+  fields.clear ();
+  fields_sizes.clear ();
+  for (const auto &field : cloud_fields)
+  {
+    if (field.name == "_")
+      continue;
+    fields.push_back (field);
+    fields_sizes.push_back (field.count * pcl::getFieldSize (field.datatype));
+    fsize += fields_sizes.back ();
+  }
+  return (fsize);
+}
+
+// Parse the chunk index of binary compressed chunked data, and compute the offset of each chunk
+static bool
+readChunkIndex (const unsigned char *map, std::size_t map_size, std::size_t data_idx, std::size_t nr_points,
+                std::size_t &chunk_points, std::vector<std::size_t> &chunk_offsets)
+{
+  if (data_idx + chunked_index_offset > map_size ||
+      memcmp (&map[data_idx], chunked_sizes, 8) != 0 || memcmp (&map[data_idx + 8], chunked_magic, 4) != 0)
+  {
+    PCL_ERROR ("[pcl::PCDReader::readChunkIndex] Invalid binary compressed chunked data!\n");
+    return (false);
+  }
+  std::uint32_t points_per_chunk = 0, nr_chunks = 0;
+  memcpy (&points_per_chunk, &map[data_idx + 12], 4);
+  memcpy (&nr_chunks, &map[data_idx + 16], 4);
+  if (points_per_chunk == 0 || nr_chunks != (nr_points + points_per_chunk - 1) / points_per_chunk ||
+      data_idx + chunked_index_offset + 4 * std::size_t (nr_chunks) > map_size)
+  {
+    PCL_ERROR ("[pcl::PCDReader::readChunkIndex] The chunk index does not match the %lu points of the header!\n", nr_points);
+    return (false);
+  }
+
+  chunk_points = points_per_chunk;
+  chunk_offsets.resize (nr_chunks + 1);
+  std::size_t offset = data_idx + chunked_index_offset + 4 * std::size_t (nr_chunks);
+  for (std::size_t k = 0; k < nr_chunks; ++k)
+  {
+    std::uint32_t stored_size = 0;
+    memcpy (&stored_size, &map[data_idx + chunked_index_offset + 4 * k], 4);
+    chunk_offsets[k] = offset;
+    offset += stored_size;
+  }
+  chunk_offsets[nr_chunks] = offset;
+  if (offset > map_size)
+  {
+    PCL_ERROR ("[pcl::PCDReader::readChunkIndex] Corrupted PCD file. The file is smaller than expected!\n");
+    return (false);
+  }
+  return (true);
+}
+
+// Pack nr_points points into planes and compress them into a chunk
+static void
+compressChunk (const std::uint8_t *points, std::size_t nr_points, std::size_t point_step,
+               const std::vector<pcl::PCLPointField> &fields, const std::vector<std::size_t> &fields_sizes,
+               std::size_t fsize, std::vector<char> &planes, std::vector<char> &chunk)
+{
+  const std::size_t data_size = nr_points * fsize;
+  planes.resize (data_size);
+  char *plane = planes.data ();
+  for (std::size_t j = 0; j < fields.size (); ++j)
+  {
+    for (std::size_t i = 0; i < nr_points; ++i)
+    {
+      memcpy (plane, &points[i * point_step + fields[j].offset], fields_sizes[j]);
+      plane += fields_sizes[j];
+    }
+  }
+
+  // Keep the planes uncompressed if LZF can not make them smaller
+  chunk.resize (data_size);
+  unsigned int compressed_size = 0;
+  if (data_size > 1)
+    compressed_size = pcl::lzfCompress (planes.data (), static_cast<unsigned int> (data_size),
+                                        chunk.data (), static_cast<unsigned int> (data_size - 1));
+  if (compressed_size == 0)
+    chunk.assign (planes.begin (), planes.end ());
+  else
+    chunk.resize (compressed_size);
+}
+
+// Decompress a chunk of nr_points points and unpack its planes into points
+static bool
+decompressChunk (const unsigned char *chunk, std::size_t stored_size, std::size_t nr_points, std::size_t point_step,
+                 const std::vector<pcl::PCLPointField> &fields, const std::vector<std::size_t> &fields_sizes,
+                 std::size_t fsize, std::vector<char> &planes, std::uint8_t *points)
+{
+  const std::size_t data_size = nr_points * fsize;
+  const char *plane = reinterpret_cast<const char*> (chunk);
+  if (stored_size != data_size)
+  {
+    planes.resize (data_size);
+    if (stored_size == 0 ||
+        pcl::lzfDecompress (chunk, static_cast<unsigned int> (stored_size),
+                            planes.data (), static_cast<unsigned int> (data_size)) != data_size)
+      return (false);
+    plane = planes.data ();
+  }
+
+  for (std::size_t j = 0; j < fields.size (); ++j)
+  {
+    for (std::size_t i = 0; i < nr_points; ++i)
+    {
+      memcpy (&points[i * point_step + fields[j].offset], plane, fields_sizes[j]);
+      plane += fields_sizes[j];
+    }
+  }
+  return (true);
+}
+
+// Get the number of threads to use for the chunks, 0 meaning automatic
+static int
+getNumberOfChunkThreads (unsigned int threads)
+{
+#ifdef _OPENMP
+  if (threads == 0)
+    threads = omp_get_num_procs ();
+#endif
+  return (threads == 0 ? 1 : static_cast<int> (threads));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDReader::readHeader (std::istream &fs, pcl::PCLPointCloud2 &cloud,
+                            Eigen::Vector4f &origin, Eigen::Quaternionf &orientation, 
+                            int &pcd_version, int &data_type, unsigned int &data_idx)
+{
+  std::size_t nr_points = 0;
+  const int res = readHeaderFields (fs, cloud, origin, orientation, pcd_version, data_type, data_idx, nr_points);
+  // Need to allocate: N * point_step
+  if (nr_points > 0 && cloud.point_step)
+    cloud.data.resize (nr_points * cloud.point_step);
+  return (res);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 int
 pcl::PCDReader::readHeader (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
@@ -542,6 +703,77 @@ pcl::PCDReader::readBodyASCII (std::istream &fs, pcl::PCLPointCloud2 &cloud, int
   return (0);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Check whether all the values of the points [first, last) of a binary cloud are finite
+static bool
+arePointsFinite (const pcl::PCLPointCloud2 &cloud, std::uint32_t first, std::uint32_t last)
+{
+  bool finite = true;
+  int point_size = static_cast<int> (cloud.data.size () / (cloud.height * cloud.width));
+  // Go over each field and check if it has NaN/Inf values
+  for (std::uint32_t i = first; i < last; ++i)
+  {
+    for (unsigned int d = 0; d < static_cast<unsigned int> (cloud.fields.size ()); ++d)
+    {
+      for (std::uint32_t c = 0; c < cloud.fields[d].count; ++c)
+      {
+        switch (cloud.fields[d].datatype)
+        {
+          case pcl::PCLPointField::INT8:
+          {
+            if (!pcl::isValueFinite<pcl::traits::asType<pcl::PCLPointField::INT8>::type> (cloud, i, point_size, d, c))
+              finite = false;
+            break;
+          }
+          case pcl::PCLPointField::UINT8:
+          {
+            if (!pcl::isValueFinite<pcl::traits::asType<pcl::PCLPointField::UINT8>::type> (cloud, i, point_size, d, c))
+              finite = false;
+            break;
+          }
+          case pcl::PCLPointField::INT16:
+          {
+            if (!pcl::isValueFinite<pcl::traits::asType<pcl::PCLPointField::INT16>::type> (cloud, i, point_size, d, c))
+              finite = false;
+            break;
+          }
+          case pcl::PCLPointField::UINT16:
+          {
+            if (!pcl::isValueFinite<pcl::traits::asType<pcl::PCLPointField::UINT16>::type> (cloud, i, point_size, d, c))
+              finite = false;
+            break;
+          }
+          case pcl::PCLPointField::INT32:
+          {
+            if (!pcl::isValueFinite<pcl::traits::asType<pcl::PCLPointField::INT32>::type> (cloud, i, point_size, d, c))
+              finite = false;
+            break;
+          }
+          case pcl::PCLPointField::UINT32:
+          {
+            if (!pcl::isValueFinite<pcl::traits::asType<pcl::PCLPointField::UINT32>::type> (cloud, i, point_size, d, c))
+              finite = false;
+            break;
+          }
+          case pcl::PCLPointField::FLOAT32:
+          {
+            if (!pcl::isValueFinite<pcl::traits::asType<pcl::PCLPointField::FLOAT32>::type> (cloud, i, point_size, d, c))
+              finite = false;
+            break;
+          }
+          case pcl::PCLPointField::FLOAT64:
+          {
+            if (!pcl::isValueFinite<pcl::traits::asType<pcl::PCLPointField::FLOAT64>::type> (cloud, i, point_size, d, c))
+              finite = false;
+            break;
+          }
+        }
+      }
+    }
+  }
+  return (finite);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 int
 pcl::PCDReader::readBodyBinary (const unsigned char *map, pcl::PCLPointCloud2 &cloud,
@@ -617,69 +849,61 @@ pcl::PCDReader::readBodyBinary (const unsigned char *map, pcl::PCLPointCloud2 &c
     memcpy (&cloud.data[0], &map[0] + data_idx, cloud.data.size ());
 
   // Extra checks (not needed for ASCII)
-  int point_size = static_cast<int> (cloud.data.size () / (cloud.height * cloud.width));
   // Once copied, we need to go over each field and check if it has NaN/Inf values and assign cloud.is_dense to true or false
-  for (std::uint32_t i = 0; i < cloud.width * cloud.height; ++i)
+  if (!arePointsFinite (cloud, 0, cloud.width * cloud.height))
+    cloud.is_dense = false;
+
+  return (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDReader::readBodyBinaryChunked (const unsigned char *map, std::size_t map_size,
+                                       pcl::PCLPointCloud2 &cloud, unsigned int data_idx)
+{
+  std::size_t nr_points = static_cast<std::size_t> (cloud.width) * cloud.height;
+  std::size_t chunk_points = 0;
+  std::vector<std::size_t> chunk_offsets;
+  if (!readChunkIndex (map, map_size, data_idx, nr_points, chunk_points, chunk_offsets))
+    return (-1);
+  PCL_DEBUG ("[pcl::PCDReader::read] Read a binary compressed chunked file with %lu chunks of %lu points.\n",
+             chunk_offsets.size () - 1, chunk_points);
+
+  std::vector<pcl::PCLPointField> fields;
+  std::vector<std::size_t> fields_sizes;
+  std::size_t fsize = getCompressedFields (cloud.fields, fields, fields_sizes);
+  std::size_t point_step = cloud.point_step;
+  cloud.data.resize (nr_points * point_step);
+
+  // Each chunk is decompressed straight into its points, and checked for NaN/Inf values while it is in cache
+  const int threads = getNumberOfChunkThreads (threads_);
+  const int nr_chunks = static_cast<int> (chunk_offsets.size ()) - 1;
+  bool valid = true, dense = true;
+#pragma omp parallel for \
+  default(none) \
+  shared(cloud, map, chunk_offsets, fields, fields_sizes) \
+  firstprivate(nr_chunks, nr_points, chunk_points, point_step, fsize) \
+  schedule(dynamic, 1) \
+  reduction(&&:valid, dense) \
+  num_threads(threads)
+  for (int k = 0; k < nr_chunks; ++k)
   {
-    for (unsigned int d = 0; d < static_cast<unsigned int> (cloud.fields.size ()); ++d)
-    {
-      for (std::uint32_t c = 0; c < cloud.fields[d].count; ++c)
-      {
-        switch (cloud.fields[d].datatype)
-        {
-          case pcl::PCLPointField::INT8:
-          {
-            if (!isValueFinite<pcl::traits::asType<pcl::PCLPointField::INT8>::type> (cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case pcl::PCLPointField::UINT8:
-          {
-            if (!isValueFinite<pcl::traits::asType<pcl::PCLPointField::UINT8>::type> (cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case pcl::PCLPointField::INT16:
-          {
-            if (!isValueFinite<pcl::traits::asType<pcl::PCLPointField::INT16>::type> (cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case pcl::PCLPointField::UINT16:
-          {
-            if (!isValueFinite<pcl::traits::asType<pcl::PCLPointField::UINT16>::type> (cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case pcl::PCLPointField::INT32:
-          {
-            if (!isValueFinite<pcl::traits::asType<pcl::PCLPointField::INT32>::type> (cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case pcl::PCLPointField::UINT32:
-          {
-            if (!isValueFinite<pcl::traits::asType<pcl::PCLPointField::UINT32>::type> (cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case pcl::PCLPointField::FLOAT32:
-          {
-            if (!isValueFinite<pcl::traits::asType<pcl::PCLPointField::FLOAT32>::type> (cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-          case pcl::PCLPointField::FLOAT64:
-          {
-            if (!isValueFinite<pcl::traits::asType<pcl::PCLPointField::FLOAT64>::type> (cloud, i, point_size, d, c))
-              cloud.is_dense = false;
-            break;
-          }
-        }
-      }
-    }
+    std::vector<char> planes;
+    const std::size_t first = k * chunk_points;
+    const std::size_t count = (std::min) (chunk_points, nr_points - first);
+    if (!decompressChunk (&map[chunk_offsets[k]], chunk_offsets[k + 1] - chunk_offsets[k], count, point_step,
+                          fields, fields_sizes, fsize, planes, &cloud.data[first * point_step]))
+      valid = false;
+    else if (!arePointsFinite (cloud, static_cast<std::uint32_t> (first), static_cast<std::uint32_t> (first + count)))
+      dense = false;
   }
 
+  if (!valid)
+  {
+    PCL_ERROR ("[pcl::PCDReader::read] Size of decompressed lzf data does not match value stored in the chunk index!\n");
+    return (-1);
+  }
+  cloud.is_dense = dense;
   return (0);
 }
 
@@ -772,6 +996,11 @@ pcl::PCDReader::read (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
       // Reset position
       io::raw_lseek (fd, 0, SEEK_SET);
     }
+    else if (data_type == 3)
+    {
+      // The chunk index bounds the data, map the whole file
+      mmap_size = file_size;
+    }
     else
     {
       mmap_size += cloud.data.size ();
@@ -809,7 +1038,10 @@ pcl::PCDReader::read (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
     }
 #endif
 
-    res = readBodyBinary (map, cloud, pcd_version, data_type == 2, offset + data_idx);
+    if (data_type == 3)
+      res = readBodyBinaryChunked (map, mmap_size, cloud, offset + data_idx);
+    else
+      res = readBodyBinary (map, cloud, pcd_version, data_type == 2, offset + data_idx);
 
     // Unmap the pages of memory
 #ifdef _WIN32
@@ -849,6 +1081,346 @@ pcl::PCDReader::read (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::LazyPCDReader::open (const std::string &file_name, const int offset)
+{
+  close ();
+
+  if (file_name.empty() || !boost::filesystem::exists (file_name))
+  {
+    PCL_ERROR ("[pcl::LazyPCDReader::open] Could not find file '%s'.\n", file_name.c_str ());
+    return (-1);
+  }
+
+  // Read the header only, the points are left in the file
+  std::ifstream fs;
+  fs.open (file_name.c_str (), std::ios::binary);
+  if (!fs.is_open () || fs.fail ())
+  {
+    PCL_ERROR ("[pcl::LazyPCDReader::open] Could not open file '%s'! Error : %s\n", file_name.c_str (), strerror (errno));
+    return (-1);
+  }
+  fs.seekg (offset, std::ios::beg);
+
+  int pcd_version;
+  unsigned int data_idx;
+  std::size_t nr_points;
+  int res = readHeaderFields (fs, header_, origin_, orientation_, pcd_version, data_type_, data_idx, nr_points);
+  fs.close ();
+  if (res < 0)
+    return (res);
+  header_.is_dense = false;
+
+  if (data_type_ == 0)
+  {
+    PCL_ERROR ("[pcl::LazyPCDReader::open] '%s' is an ASCII PCD file, which can not be mapped. Use PCDReader instead.\n", file_name.c_str ());
+    return (-1);
+  }
+
+  int fd = io::raw_open (file_name.c_str (), O_RDONLY);
+  if (fd == -1)
+  {
+    PCL_ERROR ("[pcl::LazyPCDReader::open] Failure to open file %s\n", file_name.c_str () );
+    return (-1);
+  }
+
+  // Infer file size
+  const std::size_t file_size = io::raw_lseek (fd, 0, SEEK_END);
+  io::raw_lseek (fd, 0, SEEK_SET);
+
+  data_offset_ = offset + data_idx;
+  map_size_ = data_offset_;   // ...because we mmap from the start of the file.
+  if (data_type_ == 2)
+  {
+    // Read compressed size to compute how much must be mapped
+    unsigned int compressed_size = 0;
+    if (io::raw_lseek (fd, static_cast<long> (data_offset_), SEEK_SET) < 0 || io::raw_read (fd, &compressed_size, 4) != 4)
+    {
+      io::raw_close (fd);
+      PCL_ERROR ("[pcl::LazyPCDReader::open] Could not read the compressed size: errno: %d strerror: %s\n", errno, strerror (errno));
+      return (-1);
+    }
+    // Add the 8 bytes used to store the compressed and uncompressed size
+    map_size_ += compressed_size + 8;
+  }
+  else if (data_type_ == 3)
+  {
+    // The chunk index bounds the data, map the whole file
+    map_size_ = file_size;
+  }
+  else
+  {
+    map_size_ += nr_points * header_.point_step;
+  }
+
+  if (map_size_ > file_size)
+  {
+    io::raw_close (fd);
+    PCL_ERROR ("[pcl::LazyPCDReader::open] Corrupted PCD file. The file is smaller than expected!\n");
+    return (-1);
+  }
+
+  // Prepare the map, which stays valid after the file is closed
+#ifdef _WIN32
+  HANDLE fm = CreateFileMapping ((HANDLE) _get_osfhandle (fd), NULL, PAGE_READONLY, 0, 0, NULL);
+  unsigned char *map = static_cast<unsigned char*> (MapViewOfFile (fm, FILE_MAP_READ, 0, 0, 0));
+  if (map == NULL)
+  {
+    CloseHandle (fm);
+    io::raw_close (fd);
+    PCL_ERROR ("[pcl::LazyPCDReader::open] Error mapping view of file, %s\n", file_name.c_str ());
+    return (-1);
+  }
+  file_mapping_ = fm;
+#else
+  unsigned char *map = static_cast<unsigned char*> (::mmap (nullptr, map_size_, PROT_READ, MAP_SHARED, fd, 0));
+  if (map == reinterpret_cast<unsigned char*> (-1))    // MAP_FAILED
+  {
+    io::raw_close (fd);
+    PCL_ERROR ("[pcl::LazyPCDReader::open] Error preparing mmap for binary PCD file.\n");
+    return (-1);
+  }
+#endif
+  io::raw_close (fd);
+  map_ = map;
+
+  if (data_type_ == 3 && !readChunkIndex (map_, map_size_, data_offset_, nr_points, chunk_points_, chunk_offsets_))
+  {
+    close ();
+    return (-1);
+  }
+
+  PCL_DEBUG ("[pcl::LazyPCDReader::open] Mapped %s with %lu points. Available dimensions: %s.\n",
+             file_name.c_str (), nr_points, pcl::getFieldsList (header_).c_str ());
+  return (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void
+pcl::LazyPCDReader::close ()
+{
+  if (map_)
+  {
+    // Unmap the pages of memory
+#ifdef _WIN32
+    UnmapViewOfFile (map_);
+    CloseHandle (static_cast<HANDLE> (file_mapping_));
+    file_mapping_ = nullptr;
+#else
+    if (::munmap (map_, map_size_) == -1)
+      PCL_ERROR ("[pcl::LazyPCDReader::close] Munmap failure\n");
+#endif
+  }
+  map_ = nullptr;
+  map_size_ = 0;
+  data_offset_ = 0;
+  data_type_ = 0;
+  header_ = pcl::PCLPointCloud2 ();
+  std::vector<std::uint8_t> ().swap (decompressed_);
+  chunk_points_ = 0;
+  chunk_offsets_.clear ();
+  chunked_points_.reset ();
+  chunk_decompressed_.clear ();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+const std::uint8_t*
+pcl::LazyPCDReader::getData () const
+{
+  if (!map_)
+    return (nullptr);
+  if (data_type_ == 3)
+  {
+    std::vector<std::size_t> chunks (chunk_offsets_.size () - 1);
+    std::iota (chunks.begin (), chunks.end (), 0);
+    return (decompressChunks (chunks));
+  }
+  if (data_type_ != 2)
+    return (map_ + data_offset_);
+
+  std::lock_guard<std::mutex> lock (decompress_mutex_);
+  if (decompressed_.empty () && size () > 0)
+  {
+    // Decompress and unpack the points as PCDReader does
+    pcl::PCLPointCloud2 cloud (header_);
+    cloud.data.resize (size () * header_.point_step);
+    if (PCDReader ().readBodyBinary (map_, cloud, PCDReader::PCD_V7, true, static_cast<unsigned int> (data_offset_)) < 0 ||
+        cloud.data.size () != size () * header_.point_step)
+    {
+      PCL_ERROR ("[pcl::LazyPCDReader::getData] Could not decompress the points!\n");
+      return (nullptr);
+    }
+    decompressed_.swap (cloud.data);
+  }
+  return (decompressed_.data ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+pcl::LazyPCDReader::View
+pcl::LazyPCDReader::getPoints (std::size_t first, std::size_t count) const
+{
+  View view;
+  if (!map_ || first >= size ())
+    return (view);
+  const std::uint8_t *data = nullptr;
+  if (data_type_ == 3)
+  {
+    // Only decompress the chunks holding the requested points
+    const std::size_t last = first + (std::min) (count, size () - first) - 1;
+    std::vector<std::size_t> chunks;
+    for (std::size_t k = first / chunk_points_; k <= last / chunk_points_; ++k)
+      chunks.push_back (k);
+    data = decompressChunks (chunks);
+  }
+  else
+    data = getData ();
+  if (!data)
+    return (view);
+  view.data = data + first * header_.point_step;
+  view.stride = header_.point_step;
+  view.size = (std::min) (count, size () - first);
+  return (view);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+pcl::LazyPCDReader::View
+pcl::LazyPCDReader::getPoints (const Indices &indices) const
+{
+  if (data_type_ != 3)
+    return (getPoints (0, size ()));
+
+  View view;
+  if (!map_ || size () == 0)
+    return (view);
+  // Only decompress the chunks holding the points of indices
+  std::vector<bool> wanted (chunk_offsets_.size () - 1, false);
+  for (const auto &index : indices)
+    if (index >= 0 && static_cast<std::size_t> (index) < size ())
+      wanted[index / chunk_points_] = true;
+  std::vector<std::size_t> chunks;
+  for (std::size_t k = 0; k < wanted.size (); ++k)
+    if (wanted[k])
+      chunks.push_back (k);
+
+  view.data = decompressChunks (chunks);
+  if (view.data)
+  {
+    view.stride = header_.point_step;
+    view.size = size ();
+  }
+  return (view);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+const std::uint8_t*
+pcl::LazyPCDReader::decompressChunks (const std::vector<std::size_t> &chunks) const
+{
+  std::lock_guard<std::mutex> lock (decompress_mutex_);
+  // The buffer is left uninitialized, so that the pages of the chunks which are never read are not allocated
+  if (!chunked_points_)
+  {
+    chunked_points_.reset (new std::uint8_t[size () * header_.point_step]);
+    chunk_decompressed_.assign (chunk_offsets_.size () - 1, false);
+  }
+
+  std::vector<std::size_t> pending;
+  for (const std::size_t k : chunks)
+    if (!chunk_decompressed_[k])
+      pending.push_back (k);
+  if (pending.empty ())
+    return (chunked_points_.get ());
+
+  std::vector<pcl::PCLPointField> fields;
+  std::vector<std::size_t> fields_sizes;
+  std::size_t fsize = getCompressedFields (header_.fields, fields, fields_sizes);
+  std::size_t nr_points = size ();
+  std::size_t point_step = header_.point_step;
+  const int threads = getNumberOfChunkThreads (threads_);
+  const int nr_pending = static_cast<int> (pending.size ());
+  bool valid = true;
+#pragma omp parallel for \
+  default(none) \
+  shared(pending, fields, fields_sizes) \
+  firstprivate(nr_pending, nr_points, point_step, fsize) \
+  schedule(dynamic, 1) \
+  reduction(&&:valid) \
+  num_threads(threads)
+  for (int i = 0; i < nr_pending; ++i)
+  {
+    std::vector<char> planes;
+    const std::size_t k = pending[i];
+    const std::size_t first = k * chunk_points_;
+    const std::size_t count = (std::min) (chunk_points_, nr_points - first);
+    std::uint8_t *points = &chunked_points_[first * point_step];
+    // The "_" padding of the points is not stored
+    memset (points, 0, count * point_step);
+    if (!decompressChunk (&map_[chunk_offsets_[k]], chunk_offsets_[k + 1] - chunk_offsets_[k], count, point_step,
+                          fields, fields_sizes, fsize, planes, points))
+      valid = false;
+  }
+
+  if (!valid)
+  {
+    PCL_ERROR ("[pcl::LazyPCDReader::decompressChunks] Could not decompress the points!\n");
+    return (nullptr);
+  }
+  for (const std::size_t k : pending)
+    chunk_decompressed_[k] = true;
+  return (chunked_points_.get ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+pcl::LazyPCDReader::View
+pcl::LazyPCDReader::getRow (std::uint32_t row) const
+{
+  if (row >= header_.height)
+    return (View ());
+  return (getPoints (static_cast<std::size_t> (row) * header_.width, header_.width));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+pcl::LazyPCDReader::View
+pcl::LazyPCDReader::getField (const std::string &field_name, std::size_t first, std::size_t count) const
+{
+  const int field_idx = pcl::getFieldIndex (header_, field_name);
+  if (field_idx < 0)
+    return (View ());
+  View view = getPoints (first, count);
+  view.data += header_.fields[field_idx].offset;
+  return (view);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::LazyPCDReader::read (const Indices &indices, pcl::PCLPointCloud2 &cloud) const
+{
+  const View points = getPoints (indices);
+  if (points.empty ())
+    return (-1);
+
+  cloud.header     = header_.header;
+  cloud.fields     = header_.fields;
+  cloud.point_step = header_.point_step;
+  cloud.width      = static_cast<std::uint32_t> (indices.size ());
+  cloud.height     = 1;
+  cloud.row_step   = cloud.point_step * cloud.width;
+  cloud.is_bigendian = header_.is_bigendian;
+  cloud.is_dense   = false;
+  cloud.data.resize (indices.size () * header_.point_step);
+  for (std::size_t i = 0; i < indices.size (); ++i)
+  {
+    if (indices[i] < 0 || static_cast<std::size_t> (indices[i]) >= points.size)
+    {
+      PCL_ERROR ("[pcl::LazyPCDReader::read] Index %d out of range (%lu points)!\n", indices[i], points.size);
+      cloud.data.clear ();
+      return (-1);
+    }
+    memcpy (&cloud.data[i * header_.point_step], points[indices[i]], header_.point_step);
+  }
+  return (0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 std::string
 pcl::PCDWriter::generateHeaderASCII (const pcl::PCLPointCloud2 &cloud,
                                      const Eigen::Vector4f &origin, const Eigen::Quaternionf &orientation)
@@ -1547,3 +2119,120 @@ pcl::PCDWriter::writeBinaryCompressed (const std::string &file_name, const pcl::
   return (0);
 }
 
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDWriter::writeBinaryCompressedChunked (std::ostream &os, const pcl::PCLPointCloud2 &cloud,
+                                              const Eigen::Vector4f &origin, const Eigen::Quaternionf &orientation)
+{
+  if (cloud.data.empty ())
+  {
+    PCL_ERROR ("[pcl::PCDWriter::writeBinaryCompressedChunked] Input point cloud has no data!\n");
+    return (-1);
+  }
+
+  const std::size_t nr_points = static_cast<std::size_t> (cloud.width) * cloud.height;
+  if (cloud.data.size () < nr_points * cloud.point_step)
+  {
+    PCL_ERROR ("[pcl::PCDWriter::writeBinaryCompressedChunked] The size of the data (%lu) is smaller than width * height * point_step (%lu)!\n",
+               cloud.data.size (), nr_points * cloud.point_step);
+    return (-1);
+  }
+
+  if (generateHeaderBinaryCompressed (os, cloud, origin, orientation))
+  {
+    return (-1);
+  }
+
+  return (writeChunks (os, &cloud.data[0], nr_points, cloud.point_step, cloud.fields));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDWriter::writeBinaryCompressedChunked (const std::string &file_name, const pcl::PCLPointCloud2 &cloud,
+                                              const Eigen::Vector4f &origin, const Eigen::Quaternionf &orientation)
+{
+  if (cloud.data.empty ())
+  {
+    PCL_ERROR ("[pcl::PCDWriter::writeBinaryCompressedChunked] Input point cloud has no data!\n");
+    return (-1);
+  }
+
+  std::ofstream fs;
+  fs.open (file_name.c_str (), std::ios::binary);      // Open file
+  if (!fs.is_open () || fs.fail ())
+  {
+    PCL_ERROR ("[pcl::PCDWriter::writeBinaryCompressedChunked] Could not open file '%s' for writing! Error : %s\n", file_name.c_str (), strerror (errno));
+    return (-1);
+  }
+  // Mandatory lock file
+  boost::interprocess::file_lock file_lock;
+  setLockingPermissions (file_name, file_lock);
+
+  int res = writeBinaryCompressedChunked (fs, cloud, origin, orientation);
+
+  fs.close ();              // Close file
+  resetLockingPermissions (file_name, file_lock);
+  return (res);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int
+pcl::PCDWriter::writeChunks (std::ostream &os, const std::uint8_t *data, std::size_t nr_points,
+                             std::size_t point_step, const std::vector<pcl::PCLPointField> &cloud_fields)
+{
+  std::vector<pcl::PCLPointField> fields;
+  std::vector<std::size_t> fields_sizes;
+  std::size_t fsize = getCompressedFields (cloud_fields, fields, fields_sizes);
+  if (fsize == 0 || fsize > point_step)
+  {
+    PCL_ERROR ("[pcl::PCDWriter::writeBinaryCompressedChunked] The size of the fields (%lu) is invalid for a point_step of %lu!\n", fsize, point_step);
+    return (-1);
+  }
+
+  // The stored size of a chunk is a 32 bit integer, which bounds the number of points per chunk
+  std::size_t chunk_points = (std::max) (chunk_size_, 1u);
+  chunk_points = (std::min) (chunk_points, static_cast<std::size_t> (std::numeric_limits<std::uint32_t>::max ()) / fsize);
+  const std::size_t nr_chunks = (nr_points + chunk_points - 1) / chunk_points;
+  if (nr_chunks > static_cast<std::size_t> (std::numeric_limits<int>::max ()))
+  {
+    PCL_ERROR ("[pcl::PCDWriter::writeBinaryCompressedChunked] Too many chunks (%lu), increase the chunk size!\n", nr_chunks);
+    return (-1);
+  }
+
+  // Compress the chunks in parallel, they are written in order afterwards
+  std::vector<std::vector<char> > chunks (nr_chunks);
+  const int threads = getNumberOfChunkThreads (threads_);
+  const int nr = static_cast<int> (nr_chunks);
+#pragma omp parallel for \
+  default(none) \
+  shared(chunks, data, fields, fields_sizes) \
+  firstprivate(nr, nr_points, chunk_points, point_step, fsize) \
+  schedule(dynamic, 1) \
+  num_threads(threads)
+  for (int k = 0; k < nr; ++k)
+  {
+    std::vector<char> planes;
+    const std::size_t first = k * chunk_points;
+    const std::size_t count = (std::min) (chunk_points, nr_points - first);
+    compressChunk (&data[first * point_step], count, point_step, fields, fields_sizes, fsize, planes, chunks[k]);
+  }
+
+  // The number of points per chunk, the number of chunks and the stored size of each chunk
+  std::vector<std::uint32_t> index (2 + nr_chunks);
+  index[0] = static_cast<std::uint32_t> (chunk_points);
+  index[1] = static_cast<std::uint32_t> (nr_chunks);
+  for (std::size_t k = 0; k < nr_chunks; ++k)
+    index[2 + k] = static_cast<std::uint32_t> (chunks[k].size ());
+
+  os.imbue (std::locale::classic ());
+  os << "DATA binary_compressed_chunked\n";
+  os.write (reinterpret_cast<const char*> (chunked_sizes), sizeof (chunked_sizes));
+  os.write (chunked_magic, sizeof (chunked_magic));
+  os.write (reinterpret_cast<const char*> (index.data ()), index.size () * sizeof (std::uint32_t));
+  for (const auto &chunk : chunks)
+    os.write (chunk.data (), chunk.size ());
+  os.flush ();
+
+  return (os ? 0 : -1);
+}
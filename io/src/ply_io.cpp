@@ -41,6 +41,7 @@
 #include <pcl/io/ply_io.h>
 #include <pcl/io/boost.h>
 
+#include <algorithm>
 #include <cstdlib>
 #include <fstream>
 #include <functional>
@@ -559,6 +560,346 @@ pcl::PLYReader::parse (const std::string& istream_filename)
   return ply_parser.parse (istream_filename);
 }
 
+////////////////////////////////////////////////////////////////////////////////////////
+namespace
+{
+  // Get the datatype of a PLY scalar type name, or 0 if it is unknown
+  std::uint8_t
+  getPLYScalarType (const std::string &type_name)
+  {
+    if (type_name == "int8" || type_name == "char")
+      return (pcl::PCLPointField::INT8);
+    if (type_name == "uint8" || type_name == "uchar")
+      return (pcl::PCLPointField::UINT8);
+    if (type_name == "int16" || type_name == "short")
+      return (pcl::PCLPointField::INT16);
+    if (type_name == "uint16" || type_name == "ushort")
+      return (pcl::PCLPointField::UINT16);
+    if (type_name == "int32" || type_name == "int")
+      return (pcl::PCLPointField::INT32);
+    if (type_name == "uint32" || type_name == "uint")
+      return (pcl::PCLPointField::UINT32);
+    if (type_name == "float32" || type_name == "float")
+      return (pcl::PCLPointField::FLOAT32);
+    if (type_name == "float64" || type_name == "double")
+      return (pcl::PCLPointField::FLOAT64);
+    return (0);
+  }
+
+  // A property of an element of a PLY header
+  struct PLYProperty
+  {
+    std::string name;
+    std::uint8_t datatype;
+    bool is_list;
+  };
+
+  // An element of a PLY header
+  struct PLYElement
+  {
+    std::string name;
+    std::size_t count;
+    std::vector<PLYProperty> properties;
+
+    std::size_t
+    getRecordSize () const
+    {
+      std::size_t size = 0;
+      for (const auto &property : properties)
+        size += pcl::getFieldSize (property.datatype);
+      return (size);
+    }
+  };
+
+  // How a vertex property is copied from a binary record to the point data, as PLYReader's callbacks would do
+  struct VertexPropertyCopy
+  {
+    enum Kind { COPY, RED, GREEN, BLUE, ALPHA, INTENSITY };
+    Kind kind;
+    std::size_t src_offset;
+    std::size_t dst_offset;
+    std::size_t size;
+  };
+
+  inline bool
+  isRed (const std::string &name) { return (name == "red" || name == "diffuse_red"); }
+
+  inline bool
+  isGreen (const std::string &name) { return (name == "green" || name == "diffuse_green"); }
+
+  inline bool
+  isBlue (const std::string &name) { return (name == "blue" || name == "diffuse_blue"); }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+bool
+pcl::PLYReader::readBinaryVertices (const std::string &file_name, pcl::PCLPointCloud2 &cloud)
+{
+  std::ifstream fs (file_name.c_str (), std::ios::in | std::ios::binary);
+  std::string line;
+  if (!std::getline (fs, line) || line != "ply")
+    return (false);
+
+  // Parse the header. Anything unusual is left to the parser, which reports the errors
+  bool big_endian = false, found_format = false;
+  std::uint32_t width = 0, height = 0;
+  std::vector<PLYElement> elements;
+  while (true)
+  {
+    if (!std::getline (fs, line) || line.find ('\r') != std::string::npos)
+      return (false);
+    std::vector<std::string> st;
+    boost::split (st, line, boost::is_any_of (std::string ( "\t ")), boost::token_compress_on);
+    if (st.empty () || st[0].empty ())
+      return (false);
+    if (st[0] == "end_header")
+      break;
+    if (st[0] == "comment")
+      continue;
+    if (st[0] == "format" && st.size () >= 3 && st[2] == "1.0" && !found_format)
+    {
+      if (st[1] != "binary_little_endian" && st[1] != "binary_big_endian")
+        return (false);
+      big_endian = (st[1] == "binary_big_endian");
+      found_format = true;
+    }
+    else if (st[0] == "obj_info")
+    {
+      if (st.size () >= 3 && st[1] == "num_cols")
+        width = atoi (st[2].c_str ());
+      else if (st.size () >= 3 && st[1] == "num_rows")
+        height = atoi (st[2].c_str ());
+    }
+    else if (st[0] == "element" && st.size () == 3)
+    {
+      elements.push_back ({st[1], static_cast<std::size_t> (std::strtoull (st[2].c_str (), nullptr, 10)), {}});
+    }
+    else if (st[0] == "property" && st.size () >= 3 && !elements.empty ())
+    {
+      const bool is_list = (st[1] == "list");
+      const std::uint8_t datatype = is_list ? 0 : getPLYScalarType (st[1]);
+      if (!is_list && (datatype == 0 || st.size () != 3))
+        return (false);
+      for (const auto &property : elements.back ().properties)
+        if (property.name == st.back ())
+          return (false);
+      elements.back ().properties.push_back ({st.back (), datatype, is_list});
+    }
+    else
+      return (false);
+  }
+
+  // The vertices must come first and be fixed-size records. A camera element may follow, a range grid is left to
+  // the parser as it reorders the vertices. The elements after them, e.g. the faces of a mesh, are never read, so
+  // they may have list properties
+  if (!found_format || elements.empty () || elements[0].name != "vertex" || elements[0].properties.empty ())
+    return (false);
+  for (std::size_t e = 0; e < elements.size (); ++e)
+  {
+    if (elements[e].name == "range_grid" || (elements[e].name == "vertex" && e > 0))
+      return (false);
+    if (elements[e].name == "camera" && e != 1)
+      return (false);
+    if (e == 0 || elements[e].name == "camera")
+      for (const auto &property : elements[e].properties)
+        if (property.is_list)
+          return (false);
+  }
+
+  // Build the fields, and the copy of each property, like the callbacks of the parser
+  const PLYElement &vertex = elements[0];
+  std::vector<pcl::PCLPointField> fields;
+  std::vector<VertexPropertyCopy> copies;
+  // The fields of which the values are checked for NaN/Inf, i.e. the floating point properties
+  std::vector<pcl::PCLPointField> checked_fields;
+  std::uint32_t point_step = 0;
+  std::size_t src_offset = 0;
+  int rgb_field = -1;
+  bool plain_copy = true;
+  for (std::size_t k = 0; k < vertex.properties.size (); ++k)
+  {
+    const PLYProperty &property = vertex.properties[k];
+    const std::size_t size = pcl::getFieldSize (property.datatype);
+    pcl::PCLPointField field;
+    field.name = property.name;
+    field.offset = point_step;
+    field.datatype = property.datatype;
+    field.count = 1;
+
+    if (property.datatype == pcl::PCLPointField::UINT8 && (isRed (property.name) || isGreen (property.name) || isBlue (property.name)))
+    {
+      // The three colors are packed into rgb, which the callbacks only get right if they follow each other
+      if (!isRed (property.name) || rgb_field >= 0 || k + 2 >= vertex.properties.size () ||
+          vertex.properties[k + 1].datatype != pcl::PCLPointField::UINT8 || !isGreen (vertex.properties[k + 1].name) ||
+          vertex.properties[k + 2].datatype != pcl::PCLPointField::UINT8 || !isBlue (vertex.properties[k + 2].name))
+        return (false);
+      field.name = "rgb";
+      field.datatype = pcl::PCLPointField::FLOAT32;
+      rgb_field = static_cast<int> (fields.size ());
+      copies.push_back ({VertexPropertyCopy::RED, src_offset, point_step, 1});
+      copies.push_back ({VertexPropertyCopy::GREEN, src_offset + 1, point_step, 1});
+      copies.push_back ({VertexPropertyCopy::BLUE, src_offset + 2, point_step, 1});
+      k += 2;
+      src_offset += 3;
+      point_step += 4;
+      fields.push_back (field);
+      plain_copy = false;
+      continue;
+    }
+    if (property.datatype == pcl::PCLPointField::UINT8 && property.name == "alpha")
+    {
+      if (rgb_field < 0)
+        return (false);
+      fields[rgb_field].name = "rgba";
+      fields[rgb_field].datatype = pcl::PCLPointField::UINT32;
+      copies.push_back ({VertexPropertyCopy::ALPHA, src_offset, fields[rgb_field].offset, 1});
+      src_offset += 1;
+      plain_copy = false;
+      continue;
+    }
+    if (property.datatype == pcl::PCLPointField::UINT8 && property.name == "intensity")
+    {
+      field.datatype = pcl::PCLPointField::FLOAT32;
+      copies.push_back ({VertexPropertyCopy::INTENSITY, src_offset, point_step, 1});
+      src_offset += 1;
+      point_step += 4;
+      fields.push_back (field);
+      plain_copy = false;
+      continue;
+    }
+    copies.push_back ({VertexPropertyCopy::COPY, src_offset, point_step, size});
+    if (field.datatype == pcl::PCLPointField::FLOAT32 || field.datatype == pcl::PCLPointField::FLOAT64)
+      checked_fields.push_back (field);
+    src_offset += size;
+    point_step += static_cast<std::uint32_t> (size);
+    fields.push_back (field);
+  }
+  const std::size_t record_size = src_offset;
+  const std::size_t nr_points = vertex.count;
+  const bool swap = big_endian != (pcl::io::ply::host_byte_order == pcl::io::ply::big_endian_byte_order);
+  plain_copy = plain_copy && !swap;
+
+  if (width == 0 || height == 0)
+  {
+    width = static_cast<std::uint32_t> (nr_points);
+    height = 1;
+  }
+  if (static_cast<std::size_t> (width) * height != nr_points)
+    return (false);
+
+  // Read the vertices: whole blocks go straight into the point data when the records already have its layout,
+  // otherwise the records are converted block by block
+  std::vector<std::uint8_t> data (nr_points * point_step);
+  if (plain_copy)
+  {
+    if (!fs.read (reinterpret_cast<char*> (data.data ()), data.size ()))
+      return (false);
+  }
+  else
+  {
+    const std::size_t block_points = (std::max) (std::size_t (1), std::size_t (1 << 20) / record_size);
+    std::vector<std::uint8_t> block (block_points * record_size);
+    for (std::size_t first = 0; first < nr_points; first += block_points)
+    {
+      const std::size_t count = (std::min) (block_points, nr_points - first);
+      if (!fs.read (reinterpret_cast<char*> (block.data ()), count * record_size))
+        return (false);
+      for (std::size_t i = 0; i < count; ++i)
+      {
+        const std::uint8_t *record = &block[i * record_size];
+        std::uint8_t *point = &data[(first + i) * point_step];
+        for (const VertexPropertyCopy &copy : copies)
+        {
+          switch (copy.kind)
+          {
+            case VertexPropertyCopy::COPY:
+              if (swap)
+                std::reverse_copy (record + copy.src_offset, record + copy.src_offset + copy.size, point + copy.dst_offset);
+              else
+                memcpy (point + copy.dst_offset, record + copy.src_offset, copy.size);
+              break;
+            case VertexPropertyCopy::RED:
+            case VertexPropertyCopy::GREEN:
+            case VertexPropertyCopy::BLUE:
+            case VertexPropertyCopy::ALPHA:
+            {
+              // rgb is stored as r << 16 | g << 8 | b, alpha goes to the upper byte
+              const int shift = copy.kind == VertexPropertyCopy::RED ? 16 : copy.kind == VertexPropertyCopy::GREEN ? 8 :
+                                copy.kind == VertexPropertyCopy::BLUE ? 0 : 24;
+              std::uint32_t rgba;
+              memcpy (&rgba, point + copy.dst_offset, sizeof (std::uint32_t));
+              rgba = (rgba & ~(0xffu << shift)) | (std::uint32_t (record[copy.src_offset]) << shift);
+              memcpy (point + copy.dst_offset, &rgba, sizeof (std::uint32_t));
+              break;
+            }
+            case VertexPropertyCopy::INTENSITY:
+            {
+              const float intensity = record[copy.src_offset];
+              memcpy (point + copy.dst_offset, &intensity, sizeof (float));
+              break;
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // The camera element may set the dimensions of the cloud
+  if (elements.size () > 1 && elements[1].name == "camera")
+  {
+    std::vector<char> record (elements[1].getRecordSize ());
+    for (std::size_t c = 0; c < elements[1].count; ++c)
+    {
+      if (!fs.read (record.data (), record.size ()))
+        return (false);
+      std::size_t offset = 0;
+      for (const auto &property : elements[1].properties)
+      {
+        if (property.datatype == pcl::PCLPointField::INT32 && (property.name == "viewportx" || property.name == "viewporty"))
+        {
+          pcl::io::ply::int32 value;
+          memcpy (&value, &record[offset], sizeof (value));
+          if (swap)
+            pcl::io::ply::swap_byte_order (value);
+          if (property.name == "viewportx")
+            width = value;
+          else
+            height = value;
+        }
+        offset += pcl::getFieldSize (property.datatype);
+      }
+    }
+  }
+
+  cloud.fields.swap (fields);
+  cloud.data.swap (data);
+  cloud.width = width;
+  cloud.height = height;
+  cloud.point_step = point_step;
+  cloud.row_step = point_step * width;
+  cloud.is_dense = true;
+  for (const auto &field : checked_fields)
+  {
+    for (std::size_t i = 0; i < nr_points && cloud.is_dense; ++i)
+    {
+      const std::uint8_t *value = &cloud.data[i * point_step + field.offset];
+      if (field.datatype == pcl::PCLPointField::FLOAT32)
+      {
+        float f;
+        memcpy (&f, value, sizeof (float));
+        cloud.is_dense = std::isfinite (f);
+      }
+      else
+      {
+        double d;
+        memcpy (&d, value, sizeof (double));
+        cloud.is_dense = std::isfinite (d);
+      }
+    }
+  }
+  return (true);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////
 int
 pcl::PLYReader::readHeader (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
@@ -595,7 +936,15 @@ pcl::PLYReader::read (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
     return (-1);
   }
 
-  if (this->readHeader (file_name, cloud, origin, orientation, ply_version, data_type, data_idx))
+  // Binary files of which the vertices are fixed-size records are read without the callbacks of the parser
+  const bool binary_vertices = readBinaryVertices (file_name, cloud);
+  if (binary_vertices)
+  {
+    cloud_ = &cloud;
+    origin = Eigen::Vector4f::Zero ();
+    orientation = Eigen::Quaternionf::Identity ();
+  }
+  else if (this->readHeader (file_name, cloud, origin, orientation, ply_version, data_type, data_idx))
   {
     PCL_ERROR ("[pcl::PLYReader::read] problem parsing header!\n");
     return (-1);
@@ -603,7 +952,7 @@ pcl::PLYReader::read (const std::string &file_name, pcl::PCLPointCloud2 &cloud,
 
   // a range_grid element was found ?
   std::size_t r_size;
-  if ((r_size  = (*range_grid_).size ()) > 0 && r_size != vertex_count_)
+  if (!binary_vertices && (r_size  = (*range_grid_).size ()) > 0 && r_size != vertex_count_)
   {
     //cloud.header = cloud_->header;
     std::vector<std::uint8_t> data ((*range_grid_).size () * cloud.point_step);
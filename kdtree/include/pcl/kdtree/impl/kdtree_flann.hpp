@@ -39,6 +39,7 @@
 #ifndef PCL_KDTREE_KDTREE_IMPL_FLANN_H_
 #define PCL_KDTREE_KDTREE_IMPL_FLANN_H_
 
+#include <algorithm>
 #include <cstdio>
 
 #include <flann/flann.hpp>
@@ -46,6 +47,10 @@
 #include <pcl/kdtree/kdtree_flann.h>
 #include <pcl/console/print.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename Dist>
 pcl::KdTreeFLANN<PointT, Dist>::KdTreeFLANN (bool sorted)
@@ -143,13 +148,13 @@ pcl::KdTreeFLANN<PointT, Dist>::nearestKSearch (const PointT &point, int k,
   k_indices.resize (k);
   k_distances.resize (k);
 
-  std::vector<float> query (dim_);
-  point_representation_->vectorize (static_cast<PointT> (point), query);
+  std::vector<float> query_buffer;
+  const float *query = getQueryVector (point, query_buffer);
 
   ::flann::Matrix<int> k_indices_mat (&k_indices[0], 1, k);
   ::flann::Matrix<float> k_distances_mat (&k_distances[0], 1, k);
   // Wrap the k_indices and k_distances vectors (no data copy)
-  flann_index_->knnSearch (::flann::Matrix<float> (&query[0], 1, dim_), 
+  flann_index_->knnSearch (::flann::Matrix<float> (const_cast<float*> (query), 1, dim_), 
                            k_indices_mat, k_distances_mat,
                            k, param_k_);
 
@@ -166,6 +171,66 @@ pcl::KdTreeFLANN<PointT, Dist>::nearestKSearch (const PointT &point, int k,
   return (k);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Dist> int
+pcl::KdTreeFLANN<PointT, Dist>::nearestKSearch (const PointCloud &cloud, const std::vector<int> &indices, int k,
+                                                std::vector<int> &k_indices, std::vector<float> &k_distances,
+                                                unsigned int nr_threads) const
+{
+  const std::size_t nr_queries = indices.empty () ? cloud.points.size () : indices.size ();
+  if (k > total_nr_points_)
+    k = total_nr_points_;
+  if (k < 1 || nr_queries == 0)
+  {
+    k_indices.clear ();
+    k_distances.clear ();
+    return (0);
+  }
+
+  k_indices.resize (nr_queries * k);
+  k_distances.resize (nr_queries * k);
+
+  // Vectorize all the queries in one contiguous matrix
+  std::vector<float> queries (nr_queries * dim_);
+  for (std::size_t i = 0; i < nr_queries; ++i)
+  {
+    float *query = &queries[i * dim_];
+    point_representation_->vectorize (indices.empty () ? cloud.points[i] : cloud.points[indices[i]], query);
+  }
+
+#ifdef _OPENMP
+  if (nr_threads == 0)
+    nr_threads = omp_get_num_procs ();
+#endif
+  // The queries are split in one block per thread here, since SearchParams::cores needs FLANN 1.8
+  const auto nr_blocks = static_cast<std::ptrdiff_t> (std::max<std::size_t> (1, std::min<std::size_t> (nr_threads, nr_queries)));
+#pragma omp parallel for \
+  default(none) \
+  shared(queries, k_indices, k_distances) \
+  firstprivate(nr_queries, nr_blocks, k) \
+  num_threads(nr_blocks)
+  for (std::ptrdiff_t block = 0; block < nr_blocks; ++block)
+  {
+    const std::size_t begin = nr_queries * block / nr_blocks;
+    const std::size_t end = nr_queries * (block + 1) / nr_blocks;
+    // Wrap the k_indices and k_distances vectors (no data copy)
+    ::flann::Matrix<int> k_indices_mat (&k_indices[begin * k], end - begin, k);
+    ::flann::Matrix<float> k_distances_mat (&k_distances[begin * k], end - begin, k);
+    flann_index_->knnSearch (::flann::Matrix<float> (&queries[begin * dim_], end - begin, dim_),
+                             k_indices_mat, k_distances_mat,
+                             k, param_k_);
+  }
+
+  // Do mapping to original point cloud
+  if (!identity_mapping_)
+  {
+    for (int &neighbor_index : k_indices)
+      neighbor_index = index_mapping_[neighbor_index];
+  }
+
+  return (k);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename Dist> int 
 pcl::KdTreeFLANN<PointT, Dist>::radiusSearch (const PointT &point, double radius, std::vector<int> &k_indices,
@@ -173,8 +238,8 @@ pcl::KdTreeFLANN<PointT, Dist>::radiusSearch (const PointT &point, double radius
 {
   assert (point_representation_->isValid (point) && "Invalid (NaN, Inf) point coordinates given to radiusSearch!");
 
-  std::vector<float> query (dim_);
-  point_representation_->vectorize (static_cast<PointT> (point), query);
+  std::vector<float> query_buffer;
+  const float *query = getQueryVector (point, query_buffer);
 
   // Has max_nn been set properly?
   if (max_nn == 0 || max_nn > static_cast<unsigned int> (total_nr_points_))
@@ -189,7 +254,7 @@ pcl::KdTreeFLANN<PointT, Dist>::radiusSearch (const PointT &point, double radius
   else
     params.max_neighbors = max_nn;
 
-  int neighbors_in_radius = flann_index_->radiusSearch (::flann::Matrix<float> (&query[0], 1, dim_),
+  int neighbors_in_radius = flann_index_->radiusSearch (::flann::Matrix<float> (const_cast<float*> (query), 1, dim_),
       indices,
       dists,
       static_cast<float> (radius * radius), 
@@ -211,6 +276,87 @@ pcl::KdTreeFLANN<PointT, Dist>::radiusSearch (const PointT &point, double radius
   return (neighbors_in_radius);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Dist> int
+pcl::KdTreeFLANN<PointT, Dist>::nearestKSearch (const PointT &point, int k,
+                                                int *k_indices, float *k_distances) const
+{
+  assert (point_representation_->isValid (point) && "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
+
+  if (k > total_nr_points_)
+    k = total_nr_points_;
+  if (k < 1)
+    return (0);
+
+  std::vector<float> query_buffer;
+  const float *query = getQueryVector (point, query_buffer);
+
+  ::flann::Matrix<int> k_indices_mat (k_indices, 1, k);
+  ::flann::Matrix<float> k_distances_mat (k_distances, 1, k);
+  flann_index_->knnSearch (::flann::Matrix<float> (const_cast<float*> (query), 1, dim_),
+                           k_indices_mat, k_distances_mat,
+                           k, param_k_);
+
+  // Do mapping to original point cloud
+  if (!identity_mapping_)
+  {
+    for (int i = 0; i < k; ++i)
+      k_indices[i] = index_mapping_[k_indices[i]];
+  }
+
+  return (k);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Dist> int
+pcl::KdTreeFLANN<PointT, Dist>::radiusSearch (const PointT &point, double radius, int *k_indices,
+                                              float *k_sqr_dists, unsigned int capacity) const
+{
+  assert (point_representation_->isValid (point) && "Invalid (NaN, Inf) point coordinates given to radiusSearch!");
+
+  if (capacity > static_cast<unsigned int> (total_nr_points_))
+    capacity = total_nr_points_;
+  // A null number of neighbors would make FLANN count the neighbors instead of returning them
+  if (capacity == 0)
+    return (0);
+
+  std::vector<float> query_buffer;
+  const float *query = getQueryVector (point, query_buffer);
+
+  // Writing into matrices keeps the closest neighbors when there are more than capacity of them
+  ::flann::SearchParams params (param_radius_);
+  params.max_neighbors = capacity;
+  ::flann::Matrix<int> k_indices_mat (k_indices, 1, capacity);
+  ::flann::Matrix<float> k_distances_mat (k_sqr_dists, 1, capacity);
+  int neighbors_in_radius = flann_index_->radiusSearch (::flann::Matrix<float> (const_cast<float*> (query), 1, dim_),
+      k_indices_mat,
+      k_distances_mat,
+      static_cast<float> (radius * radius),
+      params);
+  neighbors_in_radius = std::min (neighbors_in_radius, static_cast<int> (capacity));
+
+  // Do mapping to original point cloud
+  if (!identity_mapping_)
+  {
+    for (int i = 0; i < neighbors_in_radius; ++i)
+      k_indices[i] = index_mapping_[k_indices[i]];
+  }
+
+  return (neighbors_in_radius);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename Dist> const float*
+pcl::KdTreeFLANN<PointT, Dist>::getQueryVector (const PointT &point, std::vector<float> &buffer) const
+{
+  if (point_representation_->isTrivial ())
+    return (reinterpret_cast<const float*> (&point));
+
+  buffer.resize (dim_);
+  point_representation_->vectorize (point, buffer);
+  return (buffer.data ());
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, typename Dist> void 
 pcl::KdTreeFLANN<PointT, Dist>::cleanup ()
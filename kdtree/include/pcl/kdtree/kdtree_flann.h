@@ -161,6 +161,25 @@ namespace pcl
       nearestKSearch (const PointT &point, int k, 
                       std::vector<int> &k_indices, std::vector<float> &k_sqr_distances) const override;
 
+      /** \brief Search for the k-nearest neighbors of a set of query points, in one FLANN call per thread.
+        *
+        * \attention This method assumes valid (i.e., finite) query points.
+        *
+        * \param[in] cloud the point cloud data holding the query points
+        * \param[in] indices the indices in \a cloud of the query points. If empty, all the points of \a cloud are used
+        * \param[in] k the number of neighbors to search for
+        * \param[out] k_indices the indices of the neighbors of all the queries: the neighbors of the i-th query
+        * are stored at positions [i * n, (i + 1) * n), where n is the returned number of neighbors per query
+        * \param[out] k_sqr_distances the squared distances of the neighbors, stored like \a k_indices
+        * \param[in] nr_threads the number of OpenMP threads the queries are split between (0 sets the value to the
+        * number of processors)
+        * \return the number of neighbors found per query, i.e. \a k bounded by the number of points in the tree
+        */
+      int
+      nearestKSearch (const PointCloud &cloud, const std::vector<int> &indices, int k,
+                      std::vector<int> &k_indices, std::vector<float> &k_sqr_distances,
+                      unsigned int nr_threads = 1) const;
+
       /** \brief Search for all the nearest neighbors of the query point in a given radius.
         * 
         * \attention This method does not do any bounds checking for the input index
@@ -181,7 +200,52 @@ namespace pcl
       radiusSearch (const PointT &point, double radius, std::vector<int> &k_indices,
                     std::vector<float> &k_sqr_distances, unsigned int max_nn = 0) const override;
 
+      /** \brief Search for k-nearest neighbors for the given query point, writing the results into
+        * caller-provided arrays.
+        *
+        * Unlike the std::vector based search, no memory is allocated on the PCL side when the point
+        * representation is trivial (see PointRepresentation::isTrivial), which is the case for the default
+        * representation of all the XYZ point types.
+        *
+        * \param[in] point a given \a valid (i.e., finite) query point
+        * \param[in] k the number of neighbors to search for
+        * \param[out] k_indices an array of at least \a k elements receiving the indices of the neighboring points
+        * \param[out] k_sqr_distances an array of at least \a k elements receiving the squared distances to the
+        * neighboring points
+        * \return number of neighbors found, i.e. \a k bounded by the number of points in the tree
+        */
+      int
+      nearestKSearch (const PointT &point, int k, int *k_indices, float *k_sqr_distances) const;
+
+      /** \brief Search for the nearest neighbors of the query point in a given radius, writing the results into
+        * caller-provided arrays.
+        *
+        * At most \a capacity neighbors are written. If more neighbors lie in the radius, the \a capacity closest
+        * ones are returned, so a result equal to \a capacity means that the search may have been truncated.
+        * No memory is allocated on the PCL side when the point representation is trivial.
+        *
+        * \param[in] point a given \a valid (i.e., finite) query point
+        * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+        * \param[out] k_indices an array of at least \a capacity elements receiving the indices of the neighboring points
+        * \param[out] k_sqr_distances an array of at least \a capacity elements receiving the squared distances to the
+        * neighboring points
+        * \param[in] capacity the maximum number of neighbors to write
+        * \return number of neighbors written
+        */
+      int
+      radiusSearch (const PointT &point, double radius, int *k_indices, float *k_sqr_distances,
+                    unsigned int capacity) const;
+
     private:
+      /** \brief Get the k-D vector of a query point. With a trivial point representation the point itself is
+        * used, otherwise it is vectorized into \a buffer.
+        * \param[in] point the query point
+        * \param[out] buffer storage for the vectorized point, only used for non-trivial point representations
+        * \return a pointer to the \a dim_ coordinates of the query
+        */
+      const float*
+      getQueryVector (const PointT &point, std::vector<float> &buffer) const;
+
       /** \brief Internal cleanup method. */
       void 
       cleanup ();
@@ -40,6 +40,7 @@
 #define PCL_OCTREE_SEARCH_IMPL_H_
 
 #include <cassert>
+#include <numeric>
 
 namespace pcl {
 
@@ -200,6 +201,49 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::radiusSearch(
   return (radiusSearch(search_point, radius, k_indices, k_sqr_distances, max_nn));
 }
 
+template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+void
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::radiusSearch(
+    const AlignedPointTVector& queries,
+    const double radius,
+    std::vector<std::vector<int>>& k_indices,
+    std::vector<std::vector<float>>& k_sqr_distances,
+    unsigned int max_nn) const
+{
+  // clear the result vectors without freeing them, so that they can be reused
+  k_indices.resize(queries.size());
+  k_sqr_distances.resize(queries.size());
+  for (std::size_t i = 0; i < queries.size(); ++i) {
+    assert(isFinite(queries[i]) &&
+           "Invalid (NaN, Inf) point coordinates given to radiusSearch!");
+    k_indices[i].clear();
+    k_sqr_distances[i].clear();
+  }
+
+  if (queries.empty())
+    return;
+
+  // one list of active queries per tree level, all the queries reach the root node
+  std::vector<std::vector<std::size_t>> active_queries(this->octree_depth_ + 1);
+  active_queries[0].resize(queries.size());
+  std::iota(active_queries[0].begin(), active_queries[0].end(), std::size_t(0));
+  std::vector<int> decoded_point_vector;
+
+  OctreeKey key;
+  key.x = key.y = key.z = 0;
+
+  getNeighborsWithinRadiusRecursive(queries,
+                                    radius * radius,
+                                    this->root_node_,
+                                    key,
+                                    1,
+                                    active_queries,
+                                    decoded_point_vector,
+                                    k_indices,
+                                    k_sqr_distances,
+                                    max_nn);
+}
+
 template <typename PointT, typename LeafContainerT, typename BranchContainerT>
 int
 OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::boxSearch(
@@ -417,6 +461,114 @@ OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
   }
 }
 
+template <typename PointT, typename LeafContainerT, typename BranchContainerT>
+void
+OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
+    getNeighborsWithinRadiusRecursive(
+        const AlignedPointTVector& queries,
+        const double radiusSquared,
+        const BranchNode* node,
+        const OctreeKey& key,
+        unsigned int tree_depth,
+        std::vector<std::vector<std::size_t>>& active_queries,
+        std::vector<int>& decoded_point_vector,
+        std::vector<std::vector<int>>& k_indices,
+        std::vector<std::vector<float>>& k_sqr_distances,
+        unsigned int max_nn) const
+{
+  const std::vector<std::size_t>& node_queries = active_queries[tree_depth - 1];
+  std::vector<std::size_t>& child_queries = active_queries[tree_depth];
+
+  // get spatial voxel information
+  double voxel_squared_diameter = this->getVoxelSquaredDiameter(tree_depth);
+
+  // iterate over all children
+  for (unsigned char child_idx = 0; child_idx < 8; child_idx++) {
+    if (!this->branchHasChild(*node, child_idx))
+      continue;
+
+    const OctreeNode* child_node;
+    child_node = this->getBranchChildPtr(*node, child_idx);
+
+    OctreeKey new_key;
+    PointT voxel_center;
+
+    // generate new key for current branch voxel
+    new_key.x = (key.x << 1) + (!!(child_idx & (1 << 2)));
+    new_key.y = (key.y << 1) + (!!(child_idx & (1 << 1)));
+    new_key.z = (key.z << 1) + (!!(child_idx & (1 << 0)));
+
+    // generate voxel center point for voxel at key
+    this->genVoxelCenterFromOctreeKey(new_key, tree_depth, voxel_center);
+
+    // keep the queries that still miss neighbors, and whose search sphere reaches the
+    // voxel
+    child_queries.clear();
+    for (const std::size_t query : node_queries) {
+      if (max_nn != 0 &&
+          k_indices[query].size() == static_cast<unsigned int>(max_nn))
+        continue;
+
+      // calculate distance to search point
+      float squared_dist =
+          pointSquaredDist(static_cast<const PointT&>(voxel_center), queries[query]);
+
+      // if distance is smaller than search radius
+      if (squared_dist + this->epsilon_ <=
+          voxel_squared_diameter / 4.0 + radiusSquared +
+              sqrt(voxel_squared_diameter * radiusSquared))
+        child_queries.push_back(query);
+    }
+
+    if (child_queries.empty())
+      continue;
+
+    if (tree_depth < this->octree_depth_) {
+      // we have not reached maximum tree depth
+      getNeighborsWithinRadiusRecursive(queries,
+                                        radiusSquared,
+                                        static_cast<const BranchNode*>(child_node),
+                                        new_key,
+                                        tree_depth + 1,
+                                        active_queries,
+                                        decoded_point_vector,
+                                        k_indices,
+                                        k_sqr_distances,
+                                        max_nn);
+    }
+    else {
+      // we reached leaf node level
+      const LeafNode* child_leaf = static_cast<const LeafNode*>(child_node);
+
+      // decode leaf node into decoded_point_vector, once for all the queries
+      decoded_point_vector.clear();
+      (*child_leaf)->getPointIndices(decoded_point_vector);
+
+      for (const std::size_t query : child_queries) {
+        // Linearly iterate over all decoded (unsorted) points
+        for (const int& index : decoded_point_vector) {
+          const PointT& candidate_point = this->getPointByIndex(index);
+
+          // calculate point distance to search point
+          float squared_dist = pointSquaredDist(candidate_point, queries[query]);
+
+          // check if a match is found
+          if (squared_dist > radiusSquared)
+            continue;
+
+          // add point to result vector
+          k_indices[query].push_back(index);
+          k_sqr_distances[query].push_back(squared_dist);
+
+          if (max_nn != 0 &&
+              k_indices[query].size() == static_cast<unsigned int>(max_nn))
+            break;
+        }
+      }
+    }
+  }
+}
+
 template <typename PointT, typename LeafContainerT, typename BranchContainerT>
 void
 OctreePointCloudSearch<PointT, LeafContainerT, BranchContainerT>::
@@ -245,6 +245,27 @@ public:
                std::vector<float>& k_sqr_distances,
                unsigned int max_nn = 0) const;
 
+  /** \brief Search for all neighbors of a group of query points that are within a
+   * given radius, exploring the octree once for the whole group. Each voxel is tested
+   * against the queries that reached its parent, and each leaf is decoded once for all
+   * the queries that reach it, so groups of nearby query points share most of the
+   * traversal. The neighbors of each query, and their order, are the same as the ones
+   * returned by radiusSearch (const PointT&, ...).
+   * \param[in] queries the query points
+   * \param[in] radius the radius of the sphere bounding all of the queries' neighbors
+   * \param[out] k_indices the resultant indices of the neighboring points of each query
+   * \param[out] k_sqr_distances the resultant squared distances to the neighboring
+   * points of each query
+   * \param[in] max_nn if given, bounds the maximum returned neighbors per query to this
+   * value
+   */
+  void
+  radiusSearch(const AlignedPointTVector& queries,
+               const double radius,
+               std::vector<std::vector<int>>& k_indices,
+               std::vector<std::vector<float>>& k_sqr_distances,
+               unsigned int max_nn = 0) const;
+
   /** \brief Get a PointT vector of centers of all voxels that intersected by a ray
    * (origin, direction).
    * \param[in] origin ray origin
@@ -394,6 +415,32 @@ protected:
                                     std::vector<float>& k_sqr_distances,
                                     unsigned int max_nn) const;
 
+  /** \brief Recursive search method that explores the octree and finds the neighbors
+   * within a given radius of a group of query points
+   * \param[in] queries query points
+   * \param[in] radiusSquared squared search radius
+   * \param[in] node current octree node to be explored
+   * \param[in] key octree key addressing a leaf node.
+   * \param[in] tree_depth current depth/level in the octree
+   * \param[in,out] active_queries the queries that reached \a node, at position \a
+   * tree_depth - 1, followed by scratch lists for the deeper levels
+   * \param[in,out] decoded_point_vector scratch vector for the point indices of a leaf
+   * \param[out] k_indices vectors of indices found to be neighbors of each query
+   * \param[out] k_sqr_distances squared distances of neighbors to each query
+   * \param[in] max_nn maximum of neighbors to be found per query
+   */
+  void
+  getNeighborsWithinRadiusRecursive(const AlignedPointTVector& queries,
+                                    const double radiusSquared,
+                                    const BranchNode* node,
+                                    const OctreeKey& key,
+                                    unsigned int tree_depth,
+                                    std::vector<std::vector<std::size_t>>& active_queries,
+                                    std::vector<int>& decoded_point_vector,
+                                    std::vector<std::vector<int>>& k_indices,
+                                    std::vector<std::vector<float>>& k_sqr_distances,
+                                    unsigned int max_nn) const;
+
   /** \brief Recursive search method that explores the octree and finds the K nearest
    * neighbors
    * \param[in] point query point
@@ -40,6 +40,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <string>
 
 #include <pcl/pcl_base.h>
@@ -100,6 +101,7 @@ namespace pcl
           , source_cloud_updated_ (true)
           , force_no_recompute_ (false)
           , force_no_recompute_reciprocal_ (false)
+          , threads_ (1)
         {
         }
       
@@ -277,6 +279,20 @@ namespace pcl
           point_representation_ = point_representation;
         }
 
+        /** \brief Set the number of threads used to search the correspondences. The correspondences are
+          * the same, in the same order, for any number of threads.
+          * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+          */
+        void
+        setNumberOfThreads (unsigned int nr_threads = 0);
+
+        /** \brief Get the number of threads used to search the correspondences. */
+        inline unsigned int
+        getNumberOfThreads () const
+        {
+          return (threads_);
+        }
+
         /** \brief Clone and cast to CorrespondenceEstimationBase */
         virtual typename CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::Ptr clone () const = 0;
 
@@ -319,6 +335,18 @@ namespace pcl
         bool
         initComputeReciprocal ();
 
+        /** \brief Remove the unmatched correspondences, keeping the order of the others.
+          * The determineCorrespondences () implementations give each query point its own slot,
+          * left unmatched if it is rejected, so that their result does not depend on the number of threads.
+          */
+        static void
+        removeUnmatchedCorrespondences (pcl::Correspondences &correspondences)
+        {
+          correspondences.erase (std::remove_if (correspondences.begin (), correspondences.end (),
+                                                 [] (const pcl::Correspondence &corr) { return (corr.index_match < 0); }),
+                                 correspondences.end ());
+        }
+
         /** \brief Variable that stores whether we have a new target cloud, meaning we need to pre-process it again.
          * This way, we avoid rebuilding the kd-tree for the target cloud every time the determineCorrespondences () method
          * is called. */
@@ -335,6 +363,9 @@ namespace pcl
          * will never be recomputed*/
         bool force_no_recompute_reciprocal_;
 
+        /** \brief The number of threads used to search the correspondences. */
+        unsigned int threads_;
+
      };
 
     /** \brief @b CorrespondenceEstimation represents the base class for
@@ -378,6 +409,8 @@ namespace pcl
         using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::input_;
         using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::indices_;
         using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::input_fields_;
+        using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::threads_;
+        using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::removeUnmatchedCorrespondences;
         using PCLBase<PointSource>::deinitCompute;
 
         using KdTree = pcl::search::KdTree<PointTarget>;
@@ -61,6 +61,8 @@ namespace pcl
         using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::initCompute;
         using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::initComputeReciprocal;
         using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::input_transformed_;
+        using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::threads_;
+        using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::removeUnmatchedCorrespondences;
         using PCLBase<PointSource>::deinitCompute;
         using PCLBase<PointSource>::input_;
         using PCLBase<PointSource>::indices_;
@@ -205,6 +207,16 @@ namespace pcl
         bool
         initCompute ();
 
+        /** \brief Select the correspondence of a source point among its nearest neighbors in the target:
+          * the neighbor minimizing the distance weighted by the angle between the normals.
+          * \param[in] index the index of the source point
+          * \param[in] neighbors the nearest neighbors of the source point
+          * \param[in] max_distance the maximum weighted distance of the neighbor
+          * \return the position of the selected neighbor in \a neighbors, or -1 if there is none
+          */
+        int
+        selectCorrespondence (int index, const pcl::search::NeighborBuffer &neighbors, double max_distance) const;
+
       private:
 
         /** \brief The normals computed at each point in the source cloud */
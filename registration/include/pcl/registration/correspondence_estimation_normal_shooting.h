@@ -83,6 +83,8 @@ namespace pcl
         using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::initCompute;
         using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::initComputeReciprocal;
         using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::input_transformed_;
+        using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::threads_;
+        using CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::removeUnmatchedCorrespondences;
         using PCLBase<PointSource>::deinitCompute;
         using PCLBase<PointSource>::input_;
         using PCLBase<PointSource>::indices_;
@@ -201,6 +203,16 @@ namespace pcl
         bool
         initCompute ();
 
+        /** \brief Select the correspondence of a source point among its nearest neighbors in the target:
+          * the neighbor closest to the line through the point along its normal.
+          * \param[in] index the index of the source point
+          * \param[in] neighbors the nearest neighbors of the source point
+          * \param[in] max_distance the maximum squared distance between the line and the neighbor
+          * \return the position of the selected neighbor in \a neighbors, or -1 if there is none
+          */
+        int
+        selectCorrespondence (int index, const pcl::search::NeighborBuffer &neighbors, double max_distance) const;
+
        private:
 
         /** \brief The normals computed at each point in the source cloud */
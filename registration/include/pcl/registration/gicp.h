@@ -42,6 +42,7 @@
 
 #include <pcl/registration/icp.h>
 #include <pcl/registration/bfgs.h>
+#include <pcl/search/neighbor_buffer.h>
 
 namespace pcl
 {
@@ -111,6 +112,7 @@ namespace pcl
         , max_inner_iterations_(20)
         ,translation_gradient_tolerance_(1e-2)
         ,rotation_gradient_tolerance_(1e-2) 
+        , threads_ (1)
       {
         min_number_correspondences_ = 4;
         reg_name_ = "GeneralizedIterativeClosestPoint";
@@ -159,6 +161,19 @@ namespace pcl
         input_covariances_ = covariances;
       }
 
+      /** \brief Get the covariances of the input source, as set or computed by the last alignment.
+        * \note The covariances only depend on the cloud and on \ref k_correspondences_, so they can be cached
+        * and set again with \ref setSourceCovariances (or \ref setTargetCovariances, when the source becomes
+        * the next target) instead of being recomputed.
+        * \return the input source covariances, or a null pointer if they were neither set nor computed since the
+        * last call to \ref setInputSource
+        */
+      inline MatricesVectorPtr
+      getSourceCovariances () const
+      {
+        return (input_covariances_);
+      }
+
       /** \brief Provide a pointer to the input target (e.g., the point cloud that we want to align the input source to)
         * \param[in] target the input point cloud target
         */
@@ -180,6 +195,34 @@ namespace pcl
         target_covariances_ = covariances;
       }
 
+      /** \brief Get the covariances of the input target, as set or computed by the last alignment.
+        * \note Setting them again with \ref setTargetCovariances after \ref setInputTarget skips their
+        * computation when the target cloud did not change.
+        * \return the input target covariances, or a null pointer if they were neither set nor computed since the
+        * last call to \ref setInputTarget
+        */
+      inline MatricesVectorPtr
+      getTargetCovariances () const
+      {
+        return (target_covariances_);
+      }
+
+      /** \brief Set the number of threads used to compute the covariances, the correspondences and the
+        * optimized cost function.
+        * \note The sums of the cost function are computed in the same order for any number of threads,
+        * so the result does not depend on it.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used by the alignment. */
+      inline unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
       /** \brief Estimate a rigid rotation transformation between a source and a target point cloud using an iterative
         * non-linear Levenberg-Marquardt approach.
         * \param[in] cloud_src the source point cloud dataset
@@ -326,6 +369,9 @@ namespace pcl
 	  /** \brief minimal rotation gradient for early optimization stop */
 	  double rotation_gradient_tolerance_;
 
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       /** \brief compute points covariances matrices according to the K nearest
         * neighbors. K is set via setCorrespondenceRandomness() method.
         * \param cloud pointer to point cloud
@@ -387,6 +433,14 @@ namespace pcl
         void fdf(const Vector6d &x, double &f, Vector6d &df) override;
         BFGSSpace::Status checkGradient(const Vector6d& g) override;
 
+        /** \brief Evaluate the cost function and/or its gradient over all the correspondences.
+          * \param[in] x the transformation parameters
+          * \param[out] f the cost, not computed if null
+          * \param[out] g the gradient of the cost, not computed if null
+          */
+        void
+        evaluate (const Vector6d &x, double *f, Vector6d *g) const;
+
         const GeneralizedIterativeClosestPoint *gicp_;
       };
 
@@ -43,6 +43,11 @@
 
 #include <pcl/common/io.h>
 #include <pcl/common/copy_point.h>
+#include <pcl/search/neighbor_buffer.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 
 namespace pcl
@@ -70,6 +75,20 @@ CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::setInputTarget (
 }
 
 
+template <typename PointSource, typename PointTarget, typename Scalar> void
+CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs ();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
+
 template <typename PointSource, typename PointTarget, typename Scalar> bool
 CorrespondenceEstimationBase<PointSource, PointTarget, Scalar>::initCompute ()
 {
@@ -123,53 +142,46 @@ CorrespondenceEstimation<PointSource, PointTarget, Scalar>::determineCorresponde
   if (!initCompute ())
     return;
 
-  double max_dist_sqr = max_distance * max_distance;
-
-  correspondences.resize (indices_->size ());
-
-  std::vector<int> index (1);
-  std::vector<float> distance (1);
-  pcl::Correspondence corr;
-  unsigned int nr_valid_correspondences = 0;
+  const double max_dist_sqr = max_distance * max_distance;
 
   // Check if the template types are the same. If true, avoid a copy.
   // Both point types MUST be registered using the POINT_CLOUD_REGISTER_POINT_STRUCT macro!
-  if (isSamePointType<PointSource, PointTarget> ())
-  {
-    // Iterate over the input set of source indices
-    for (std::vector<int>::const_iterator idx = indices_->begin (); idx != indices_->end (); ++idx)
-    {
-      tree_->nearestKSearch (input_->points[*idx], 1, index, distance);
-      if (distance[0] > max_dist_sqr)
-        continue;
+  const bool same_point_type = isSamePointType<PointSource, PointTarget> ();
 
-      corr.index_query = *idx;
-      corr.index_match = index[0];
-      corr.distance = distance[0];
-      correspondences[nr_valid_correspondences++] = corr;
-    }
-  }
-  else
+  correspondences.assign (indices_->size (), pcl::Correspondence ());
+  const auto nr_indices = static_cast<std::ptrdiff_t> (indices_->size ());
+
+#pragma omp parallel \
+  default(none) \
+  shared(correspondences) \
+  firstprivate(max_dist_sqr, nr_indices, same_point_type) \
+  num_threads(threads_)
   {
+    pcl::search::NeighborBuffer neighbors (1);
     PointTarget pt;
 
-    // Iterate over the input set of source indices
-    for (std::vector<int>::const_iterator idx = indices_->begin (); idx != indices_->end (); ++idx)
+#pragma omp for schedule(dynamic, 256)
+    for (std::ptrdiff_t i = 0; i < nr_indices; ++i)
     {
-      // Copy the source data to a target PointTarget format so we can search in the tree
-      copyPoint (input_->points[*idx], pt);
-
-      tree_->nearestKSearch (pt, 1, index, distance);
-      if (distance[0] > max_dist_sqr)
+      const int idx = (*indices_)[i];
+      if (same_point_type)
+        tree_->nearestKSearch (input_->points[idx], 1, neighbors);
+      else
+      {
+        // Copy the source data to a target PointTarget format so we can search in the tree
+        copyPoint (input_->points[idx], pt);
+        tree_->nearestKSearch (pt, 1, neighbors);
+      }
+      if (neighbors.size () == 0 || neighbors.sqr_distances[0] > max_dist_sqr)
         continue;
 
-      corr.index_query = *idx;
-      corr.index_match = index[0];
-      corr.distance = distance[0];
-      correspondences[nr_valid_correspondences++] = corr;
+      pcl::Correspondence &corr = correspondences[i];
+      corr.index_query = idx;
+      corr.index_match = neighbors.indices[0];
+      corr.distance = neighbors.sqr_distances[0];
     }
   }
-  correspondences.resize (nr_valid_correspondences);
+  removeUnmatchedCorrespondences (correspondences);
   deinitCompute ();
 }
 
@@ -185,71 +197,61 @@ CorrespondenceEstimation<PointSource, PointTarget, Scalar>::determineReciprocalC
   // Set the internal point representation of choice
   if (!initComputeReciprocal())
     return;
-  double max_dist_sqr = max_distance * max_distance;
-
-  correspondences.resize (indices_->size());
-  std::vector<int> index (1);
-  std::vector<float> distance (1);
-  std::vector<int> index_reciprocal (1);
-  std::vector<float> distance_reciprocal (1);
-  pcl::Correspondence corr;
-  unsigned int nr_valid_correspondences = 0;
-  int target_idx = 0;
+  const double max_dist_sqr = max_distance * max_distance;
 
   // Check if the template types are the same. If true, avoid a copy.
   // Both point types MUST be registered using the POINT_CLOUD_REGISTER_POINT_STRUCT macro!
-  if (isSamePointType<PointSource, PointTarget> ())
-  {
-    // Iterate over the input set of source indices
-    for (std::vector<int>::const_iterator idx = indices_->begin (); idx != indices_->end (); ++idx)
-    {
-      tree_->nearestKSearch (input_->points[*idx], 1, index, distance);
-      if (distance[0] > max_dist_sqr)
-        continue;
-
-      target_idx = index[0];
+  const bool same_point_type = isSamePointType<PointSource, PointTarget> ();
 
-      tree_reciprocal_->nearestKSearch (target_->points[target_idx], 1, index_reciprocal, distance_reciprocal);
-      if (distance_reciprocal[0] > max_dist_sqr || *idx != index_reciprocal[0])
-        continue;
+  correspondences.assign (indices_->size (), pcl::Correspondence ());
+  const auto nr_indices = static_cast<std::ptrdiff_t> (indices_->size ());
 
-      corr.index_query = *idx;
-      corr.index_match = index[0];
-      corr.distance = distance[0];
-      correspondences[nr_valid_correspondences++] = corr;
-    }
-  }
-  else
+#pragma omp parallel \
+  default(none) \
+  shared(correspondences) \
+  firstprivate(max_dist_sqr, nr_indices, same_point_type) \
+  num_threads(threads_)
   {
+    pcl::search::NeighborBuffer neighbors (1);
+    pcl::search::NeighborBuffer neighbors_reciprocal (1);
     PointTarget pt_src;
     PointSource pt_tgt;
 
-    // Iterate over the input set of source indices
-    for (std::vector<int>::const_iterator idx = indices_->begin (); idx != indices_->end (); ++idx)
+#pragma omp for schedule(dynamic, 256)
+    for (std::ptrdiff_t i = 0; i < nr_indices; ++i)
     {
-      // Copy the source data to a target PointTarget format so we can search in the tree
-      copyPoint (input_->points[*idx], pt_src);
-
-      tree_->nearestKSearch (pt_src, 1, index, distance);
-      if (distance[0] > max_dist_sqr)
+      const int idx = (*indices_)[i];
+      if (same_point_type)
+        tree_->nearestKSearch (input_->points[idx], 1, neighbors);
+      else
+      {
+        // Copy the source data to a target PointTarget format so we can search in the tree
+        copyPoint (input_->points[idx], pt_src);
+        tree_->nearestKSearch (pt_src, 1, neighbors);
+      }
+      if (neighbors.size () == 0 || neighbors.sqr_distances[0] > max_dist_sqr)
         continue;
 
-      target_idx = index[0];
-
-      // Copy the target data to a target PointSource format so we can search in the tree_reciprocal
-      copyPoint (target_->points[target_idx], pt_tgt);
-
-      tree_reciprocal_->nearestKSearch (pt_tgt, 1, index_reciprocal, distance_reciprocal);
-      if (distance_reciprocal[0] > max_dist_sqr || *idx != index_reciprocal[0])
+      const int target_idx = neighbors.indices[0];
+      if (same_point_type)
+        tree_reciprocal_->nearestKSearch (target_->points[target_idx], 1, neighbors_reciprocal);
+      else
+      {
+        // Copy the target data to a target PointSource format so we can search in the tree_reciprocal
+        copyPoint (target_->points[target_idx], pt_tgt);
+        tree_reciprocal_->nearestKSearch (pt_tgt, 1, neighbors_reciprocal);
+      }
+      if (neighbors_reciprocal.size () == 0 || neighbors_reciprocal.sqr_distances[0] > max_dist_sqr ||
+          idx != neighbors_reciprocal.indices[0])
         continue;
 
-      corr.index_query = *idx;
-      corr.index_match = index[0];
-      corr.distance = distance[0];
-      correspondences[nr_valid_correspondences++] = corr;
+      pcl::Correspondence &corr = correspondences[i];
+      corr.index_query = idx;
+      corr.index_match = target_idx;
+      corr.distance = neighbors.sqr_distances[0];
     }
   }
-  correspondences.resize (nr_valid_correspondences);
+  removeUnmatchedCorrespondences (correspondences);
   deinitCompute ();
 }
 
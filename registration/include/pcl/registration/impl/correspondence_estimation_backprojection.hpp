@@ -62,99 +62,69 @@ CorrespondenceEstimationBackProjection<PointSource, PointTarget, NormalT, Scalar
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
-template <typename PointSource, typename PointTarget, typename NormalT, typename Scalar> void
-CorrespondenceEstimationBackProjection<PointSource, PointTarget, NormalT, Scalar>::determineCorrespondences (
-    pcl::Correspondences &correspondences, double max_distance)
+template <typename PointSource, typename PointTarget, typename NormalT, typename Scalar> int
+CorrespondenceEstimationBackProjection<PointSource, PointTarget, NormalT, Scalar>::selectCorrespondence (
+    int index, const pcl::search::NeighborBuffer &neighbors, double max_distance) const
 {
-  if (!initCompute ())
-    return;
-
-  correspondences.resize (indices_->size ());
+  // Among the K nearest neighbours find the one with minimum perpendicular distance to the normal
+  const NormalT &normal = source_normals_->points[index];
 
-  std::vector<int> nn_indices (k_);
-  std::vector<float> nn_dists (k_);
-
-  int min_index = 0;
-
-  pcl::Correspondence corr;
-  unsigned int nr_valid_correspondences = 0;
-
-  // Check if the template types are the same. If true, avoid a copy.
-  // Both point types MUST be registered using the POINT_CLOUD_REGISTER_POINT_STRUCT macro!
-  if (isSamePointType<PointSource, PointTarget> ())
+  float min_dist = std::numeric_limits<float>::max ();
+  int min_index = -1;
+  for (std::size_t j = 0; j < neighbors.size (); ++j)
   {
-    PointTarget pt;
-    // Iterate over the input set of source indices
-    for (std::vector<int>::const_iterator idx_i = indices_->begin (); idx_i != indices_->end (); ++idx_i)
-    {
-      tree_->nearestKSearch (input_->points[*idx_i], k_, nn_indices, nn_dists);
-
-      // Among the K nearest neighbours find the one with minimum perpendicular distance to the normal
-      float min_dist = std::numeric_limits<float>::max ();
-
-      // Find the best correspondence
-      for (std::size_t j = 0; j < nn_indices.size (); j++)
-      {
-        float cos_angle = source_normals_->points[*idx_i].normal_x * target_normals_->points[nn_indices[j]].normal_x +
-                          source_normals_->points[*idx_i].normal_y * target_normals_->points[nn_indices[j]].normal_y +
-                          source_normals_->points[*idx_i].normal_z * target_normals_->points[nn_indices[j]].normal_z ;
-        float dist = nn_dists[j] * (2.0f - cos_angle * cos_angle);
+    const NormalT &target_normal = target_normals_->points[neighbors.indices[j]];
+    const float cos_angle = normal.normal_x * target_normal.normal_x +
+                            normal.normal_y * target_normal.normal_y +
+                            normal.normal_z * target_normal.normal_z;
+    const float dist = neighbors.sqr_distances[j] * (2.0f - cos_angle * cos_angle);
 
-        if (dist < min_dist)
-        {
-          min_dist = dist;
-          min_index = static_cast<int> (j);
-        }
-      }
-      if (min_dist > max_distance)
-        continue;
-
-      corr.index_query = *idx_i;
-      corr.index_match = nn_indices[min_index];
-      corr.distance = nn_dists[min_index];//min_dist;
-      correspondences[nr_valid_correspondences++] = corr;
+    if (dist < min_dist)
+    {
+      min_dist = dist;
+      min_index = static_cast<int> (j);
     }
   }
-  else
-  {
-    PointTarget pt;
+  if (min_dist > max_distance)
+    return (-1);
+  return (min_index);
+}
 
-    // Iterate over the input set of source indices
-    for (std::vector<int>::const_iterator idx_i = indices_->begin (); idx_i != indices_->end (); ++idx_i)
-    {
-      tree_->nearestKSearch (input_->points[*idx_i], k_, nn_indices, nn_dists);
 
-      // Among the K nearest neighbours find the one with minimum perpendicular distance to the normal
-      float min_dist = std::numeric_limits<float>::max ();
+template <typename PointSource, typename PointTarget, typename NormalT, typename Scalar> void
+CorrespondenceEstimationBackProjection<PointSource, PointTarget, NormalT, Scalar>::determineCorrespondences (
+    pcl::Correspondences &correspondences, double max_distance)
+{
+  if (!initCompute ())
+    return;
 
-      // Find the best correspondence
-      for (std::size_t j = 0; j < nn_indices.size (); j++)
-      {
-        PointSource pt_src;
-        // Copy the source data to a target PointTarget format so we can search in the tree
-        copyPoint (input_->points[*idx_i], pt_src);
+  correspondences.assign (indices_->size (), pcl::Correspondence ());
+  const auto nr_indices = static_cast<std::ptrdiff_t> (indices_->size ());
 
-        float cos_angle = source_normals_->points[*idx_i].normal_x * target_normals_->points[nn_indices[j]].normal_x +
-                          source_normals_->points[*idx_i].normal_y * target_normals_->points[nn_indices[j]].normal_y +
-                          source_normals_->points[*idx_i].normal_z * target_normals_->points[nn_indices[j]].normal_z ;
-        float dist = nn_dists[j] * (2.0f - cos_angle * cos_angle);
+#pragma omp parallel \
+  default(none) \
+  shared(correspondences) \
+  firstprivate(max_distance, nr_indices) \
+  num_threads(threads_)
+  {
+    pcl::search::NeighborBuffer neighbors (k_);
 
-        if (dist < min_dist)
-        {
-          min_dist = dist;
-          min_index = static_cast<int> (j);
-        }
-      }
-      if (min_dist > max_distance)
+#pragma omp for schedule(dynamic, 256)
+    for (std::ptrdiff_t i = 0; i < nr_indices; ++i)
+    {
+      const int idx = (*indices_)[i];
+      tree_->nearestKSearch (input_->points[idx], k_, neighbors);
+      const int min_index = selectCorrespondence (idx, neighbors, max_distance);
+      if (min_index < 0)
         continue;
 
-      corr.index_query = *idx_i;
-      corr.index_match = nn_indices[min_index];
-      corr.distance = nn_dists[min_index];//min_dist;
-      correspondences[nr_valid_correspondences++] = corr;
+      pcl::Correspondence &corr = correspondences[i];
+      corr.index_query = idx;
+      corr.index_match = neighbors.indices[min_index];
+      corr.distance = neighbors.sqr_distances[min_index];
     }
   }
-  correspondences.resize (nr_valid_correspondences);
+  removeUnmatchedCorrespondences (correspondences);
   deinitCompute ();
 }
 
@@ -166,113 +136,46 @@ CorrespondenceEstimationBackProjection<PointSource, PointTarget, NormalT, Scalar
   if (!initCompute ())
     return;
 
+  // setup tree for reciprocal search
   // Set the internal point representation of choice
-  if(!initComputeReciprocal())
+  if (!initComputeReciprocal ())
     return;
 
-  correspondences.resize (indices_->size ());
-
-  std::vector<int> nn_indices (k_);
-  std::vector<float> nn_dists (k_);
-  std::vector<int> index_reciprocal (1);
-  std::vector<float> distance_reciprocal (1);
+  correspondences.assign (indices_->size (), pcl::Correspondence ());
+  const auto nr_indices = static_cast<std::ptrdiff_t> (indices_->size ());
 
-  int min_index = 0;
-
-  pcl::Correspondence corr;
-  unsigned int nr_valid_correspondences = 0;
-  int target_idx = 0;
-
-  // Check if the template types are the same. If true, avoid a copy.
-  // Both point types MUST be registered using the POINT_CLOUD_REGISTER_POINT_STRUCT macro!
-  if (isSamePointType<PointSource, PointTarget> ())
+#pragma omp parallel \
+  default(none) \
+  shared(correspondences) \
+  firstprivate(max_distance, nr_indices) \
+  num_threads(threads_)
   {
-    PointTarget pt;
-    // Iterate over the input set of source indices
-    for (std::vector<int>::const_iterator idx_i = indices_->begin (); idx_i != indices_->end (); ++idx_i)
-    {
-      tree_->nearestKSearch (input_->points[*idx_i], k_, nn_indices, nn_dists);
-
-      // Among the K nearest neighbours find the one with minimum perpendicular distance to the normal
-      float min_dist = std::numeric_limits<float>::max ();
-
-      // Find the best correspondence
-      for (std::size_t j = 0; j < nn_indices.size (); j++)
-      {
-        float cos_angle = source_normals_->points[*idx_i].normal_x * target_normals_->points[nn_indices[j]].normal_x +
-                          source_normals_->points[*idx_i].normal_y * target_normals_->points[nn_indices[j]].normal_y +
-                          source_normals_->points[*idx_i].normal_z * target_normals_->points[nn_indices[j]].normal_z ;
-        float dist = nn_dists[j] * (2.0f - cos_angle * cos_angle);
-
-        if (dist < min_dist)
-        {
-          min_dist = dist;
-          min_index = static_cast<int> (j);
-        }
-      }
-      if (min_dist > max_distance)
-        continue;
-
-      // Check if the correspondence is reciprocal
-      target_idx = nn_indices[min_index];
-      tree_reciprocal_->nearestKSearch (target_->points[target_idx], 1, index_reciprocal, distance_reciprocal);
+    pcl::search::NeighborBuffer neighbors (k_);
+    pcl::search::NeighborBuffer neighbors_reciprocal (1);
 
-      if (*idx_i != index_reciprocal[0])
-        continue;
-
-      corr.index_query = *idx_i;
-      corr.index_match = nn_indices[min_index];
-      corr.distance = nn_dists[min_index];//min_dist;
-      correspondences[nr_valid_correspondences++] = corr;
-    }
-  }
-  else
-  {
-    PointTarget pt;
-
-    // Iterate over the input set of source indices
-    for (std::vector<int>::const_iterator idx_i = indices_->begin (); idx_i != indices_->end (); ++idx_i)
+#pragma omp for schedule(dynamic, 256)
+    for (std::ptrdiff_t i = 0; i < nr_indices; ++i)
     {
-      tree_->nearestKSearch (input_->points[*idx_i], k_, nn_indices, nn_dists);
-
-      // Among the K nearest neighbours find the one with minimum perpendicular distance to the normal
-      float min_dist = std::numeric_limits<float>::max ();
-
-      // Find the best correspondence
-      for (std::size_t j = 0; j < nn_indices.size (); j++)
-      {
-        PointSource pt_src;
-        // Copy the source data to a target PointTarget format so we can search in the tree
-        copyPoint (input_->points[*idx_i], pt_src);
-
-        float cos_angle = source_normals_->points[*idx_i].normal_x * target_normals_->points[nn_indices[j]].normal_x +
-                          source_normals_->points[*idx_i].normal_y * target_normals_->points[nn_indices[j]].normal_y +
-                          source_normals_->points[*idx_i].normal_z * target_normals_->points[nn_indices[j]].normal_z ;
-        float dist = nn_dists[j] * (2.0f - cos_angle * cos_angle);
-
-        if (dist < min_dist)
-        {
-          min_dist = dist;
-          min_index = static_cast<int> (j);
-        }
-      }
-      if (min_dist > max_distance)
+      const int idx = (*indices_)[i];
+      tree_->nearestKSearch (input_->points[idx], k_, neighbors);
+      const int min_index = selectCorrespondence (idx, neighbors, max_distance);
+      if (min_index < 0)
         continue;
 
       // Check if the correspondence is reciprocal
-      target_idx = nn_indices[min_index];
-      tree_reciprocal_->nearestKSearch (target_->points[target_idx], 1, index_reciprocal, distance_reciprocal);
-
-      if (*idx_i != index_reciprocal[0])
+      const int target_idx = neighbors.indices[min_index];
+      tree_reciprocal_->nearestKSearch (target_->points[target_idx], 1, neighbors_reciprocal);
+      if (neighbors_reciprocal.size () == 0 || idx != neighbors_reciprocal.indices[0])
         continue;
 
-      corr.index_query = *idx_i;
-      corr.index_match = nn_indices[min_index];
-      corr.distance = nn_dists[min_index];//min_dist;
-      correspondences[nr_valid_correspondences++] = corr;
+      // Correspondence IS reciprocal, save it
+      pcl::Correspondence &corr = correspondences[i];
+      corr.index_query = idx;
+      corr.index_match = target_idx;
+      corr.distance = neighbors.sqr_distances[min_index];
     }
   }
-  correspondences.resize (nr_valid_correspondences);
+  removeUnmatchedCorrespondences (correspondences);
   deinitCompute ();
 }
 
@@ -63,6 +63,39 @@ CorrespondenceEstimationNormalShooting<PointSource, PointTarget, NormalT, Scalar
 }
 
 
+template <typename PointSource, typename PointTarget, typename NormalT, typename Scalar> int
+CorrespondenceEstimationNormalShooting<PointSource, PointTarget, NormalT, Scalar>::selectCorrespondence (
+    int index, const pcl::search::NeighborBuffer &neighbors, double max_distance) const
+{
+  // Among the K nearest neighbours find the one with minimum perpendicular distance to the normal
+  const NormalT &normal = source_normals_->points[index];
+  const Eigen::Vector3d N (normal.normal_x, normal.normal_y, normal.normal_z);
+  const PointSource &point = input_->points[index];
+
+  double min_dist = std::numeric_limits<double>::max ();
+  int min_index = -1;
+  for (std::size_t j = 0; j < neighbors.size (); ++j)
+  {
+    // computing the distance between a point and a line in 3d.
+    // Reference - http://mathworld.wolfram.com/Point-LineDistance3-Dimensional.html
+    const PointTarget &neighbor = target_->points[neighbors.indices[j]];
+    const Eigen::Vector3d V (neighbor.x - point.x, neighbor.y - point.y, neighbor.z - point.z);
+    const Eigen::Vector3d C = N.cross (V);
+
+    // Check if we have a better correspondence
+    const double dist = C.dot (C);
+    if (dist < min_dist)
+    {
+      min_dist = dist;
+      min_index = static_cast<int> (j);
+    }
+  }
+  if (min_dist > max_distance)
+    return (-1);
+  return (min_index);
+}
+
+
 template <typename PointSource, typename PointTarget, typename NormalT, typename Scalar> void
 CorrespondenceEstimationNormalShooting<PointSource, PointTarget, NormalT, Scalar>::determineCorrespondences (
     pcl::Correspondences &correspondences, double max_distance)
@@ -70,108 +103,33 @@ CorrespondenceEstimationNormalShooting<PointSource, PointTarget, NormalT, Scalar
   if (!initCompute ())
     return;
 
-  correspondences.resize (indices_->size ());
-
-  std::vector<int> nn_indices (k_);
-  std::vector<float> nn_dists (k_);
-
-  int min_index = 0;
+  correspondences.assign (indices_->size (), pcl::Correspondence ());
+  const auto nr_indices = static_cast<std::ptrdiff_t> (indices_->size ());
 
-  pcl::Correspondence corr;
-  unsigned int nr_valid_correspondences = 0;
-
-  // Check if the template types are the same. If true, avoid a copy.
-  // Both point types MUST be registered using the POINT_CLOUD_REGISTER_POINT_STRUCT macro!
-  if (isSamePointType<PointSource, PointTarget> ())
+#pragma omp parallel \
+  default(none) \
+  shared(correspondences) \
+  firstprivate(max_distance, nr_indices) \
+  num_threads(threads_)
   {
-    PointTarget pt;
-    // Iterate over the input set of source indices
-    for (std::vector<int>::const_iterator idx_i = indices_->begin (); idx_i != indices_->end (); ++idx_i)
-    {
-      tree_->nearestKSearch (input_->points[*idx_i], k_, nn_indices, nn_dists);
-
-      // Among the K nearest neighbours find the one with minimum perpendicular distance to the normal
-      double min_dist = std::numeric_limits<double>::max ();
+    pcl::search::NeighborBuffer neighbors (k_);
 
-      // Find the best correspondence
-      for (std::size_t j = 0; j < nn_indices.size (); j++)
-      {
-        // computing the distance between a point and a line in 3d.
-        // Reference - http://mathworld.wolfram.com/Point-LineDistance3-Dimensional.html
-        pt.x = target_->points[nn_indices[j]].x - input_->points[*idx_i].x;
-        pt.y = target_->points[nn_indices[j]].y - input_->points[*idx_i].y;
-        pt.z = target_->points[nn_indices[j]].z - input_->points[*idx_i].z;
-
-        const NormalT &normal = source_normals_->points[*idx_i];
-        Eigen::Vector3d N (normal.normal_x, normal.normal_y, normal.normal_z);
-        Eigen::Vector3d V (pt.x, pt.y, pt.z);
-        Eigen::Vector3d C = N.cross (V);
-
-        // Check if we have a better correspondence
-        double dist = C.dot (C);
-        if (dist < min_dist)
-        {
-          min_dist = dist;
-          min_index = static_cast<int> (j);
-        }
-      }
-      if (min_dist > max_distance)
-        continue;
-
-      corr.index_query = *idx_i;
-      corr.index_match = nn_indices[min_index];
-      corr.distance = nn_dists[min_index];//min_dist;
-      correspondences[nr_valid_correspondences++] = corr;
-    }
-  }
-  else
-  {
-    PointTarget pt;
-
-    // Iterate over the input set of source indices
-    for (std::vector<int>::const_iterator idx_i = indices_->begin (); idx_i != indices_->end (); ++idx_i)
+#pragma omp for schedule(dynamic, 256)
+    for (std::ptrdiff_t i = 0; i < nr_indices; ++i)
     {
-      tree_->nearestKSearch (input_->points[*idx_i], k_, nn_indices, nn_dists);
-
-      // Among the K nearest neighbours find the one with minimum perpendicular distance to the normal
-      double min_dist = std::numeric_limits<double>::max ();
-
-      // Find the best correspondence
-      for (std::size_t j = 0; j < nn_indices.size (); j++)
-      {
-        PointSource pt_src;
-        // Copy the source data to a target PointTarget format so we can search in the tree
-        copyPoint (input_->points[*idx_i], pt_src);
-
-        // computing the distance between a point and a line in 3d. 
-        // Reference - http://mathworld.wolfram.com/Point-LineDistance3-Dimensional.html
-        pt.x = target_->points[nn_indices[j]].x - pt_src.x;
-        pt.y = target_->points[nn_indices[j]].y - pt_src.y;
-        pt.z = target_->points[nn_indices[j]].z - pt_src.z;
-
-        const NormalT &normal = source_normals_->points[*idx_i];
-        Eigen::Vector3d N (normal.normal_x, normal.normal_y, normal.normal_z);
-        Eigen::Vector3d V (pt.x, pt.y, pt.z);
-        Eigen::Vector3d C = N.cross (V);
-
-        // Check if we have a better correspondence
-        double dist = C.dot (C);
-        if (dist < min_dist)
-        {
-          min_dist = dist;
-          min_index = static_cast<int> (j);
-        }
-      }
-      if (min_dist > max_distance)
+      const int idx = (*indices_)[i];
+      tree_->nearestKSearch (input_->points[idx], k_, neighbors);
+      const int min_index = selectCorrespondence (idx, neighbors, max_distance);
+      if (min_index < 0)
         continue;
 
-      corr.index_query = *idx_i;
-      corr.index_match = nn_indices[min_index];
-      corr.distance = nn_dists[min_index];//min_dist;
-      correspondences[nr_valid_correspondences++] = corr;
+      pcl::Correspondence &corr = correspondences[i];
+      corr.index_query = idx;
+      corr.index_match = neighbors.indices[min_index];
+      corr.distance = neighbors.sqr_distances[min_index];
     }
   }
-  correspondences.resize (nr_valid_correspondences);
+  removeUnmatchedCorrespondences (correspondences);
   deinitCompute ();
 }
 
@@ -188,127 +146,41 @@ CorrespondenceEstimationNormalShooting<PointSource, PointTarget, NormalT, Scalar
   if (!initComputeReciprocal ())
     return;
 
-  correspondences.resize (indices_->size ());
-
-  std::vector<int> nn_indices (k_);
-  std::vector<float> nn_dists (k_);
-  std::vector<int> index_reciprocal (1);
-  std::vector<float> distance_reciprocal (1);
-
-  int min_index = 0;
-
-  pcl::Correspondence corr;
-  unsigned int nr_valid_correspondences = 0;
-  int target_idx = 0;
-
-  // Check if the template types are the same. If true, avoid a copy.
-  // Both point types MUST be registered using the POINT_CLOUD_REGISTER_POINT_STRUCT macro!
-  if (isSamePointType<PointSource, PointTarget> ())
-  {
-    PointTarget pt;
-    // Iterate over the input set of source indices
-    for (std::vector<int>::const_iterator idx_i = indices_->begin (); idx_i != indices_->end (); ++idx_i)
-    {
-      tree_->nearestKSearch (input_->points[*idx_i], k_, nn_indices, nn_dists);
-
-      // Among the K nearest neighbours find the one with minimum perpendicular distance to the normal
-      double min_dist = std::numeric_limits<double>::max ();
-
-      // Find the best correspondence
-      for (std::size_t j = 0; j < nn_indices.size (); j++)
-      {
-        // computing the distance between a point and a line in 3d.
-        // Reference - http://mathworld.wolfram.com/Point-LineDistance3-Dimensional.html
-        pt.x = target_->points[nn_indices[j]].x - input_->points[*idx_i].x;
-        pt.y = target_->points[nn_indices[j]].y - input_->points[*idx_i].y;
-        pt.z = target_->points[nn_indices[j]].z - input_->points[*idx_i].z;
-
-        const NormalT &normal = source_normals_->points[*idx_i];
-        Eigen::Vector3d N (normal.normal_x, normal.normal_y, normal.normal_z);
-        Eigen::Vector3d V (pt.x, pt.y, pt.z);
-        Eigen::Vector3d C = N.cross (V);
-
-        // Check if we have a better correspondence
-        double dist = C.dot (C);
-        if (dist < min_dist)
-        {
-          min_dist = dist;
-          min_index = static_cast<int> (j);
-        }
-      }
-      if (min_dist > max_distance)
-        continue;
-
-      // Check if the correspondence is reciprocal
-      target_idx = nn_indices[min_index];
-      tree_reciprocal_->nearestKSearch (target_->points[target_idx], 1, index_reciprocal, distance_reciprocal);
-
-      if (*idx_i != index_reciprocal[0])
-        continue;
+  correspondences.assign (indices_->size (), pcl::Correspondence ());
+  const auto nr_indices = static_cast<std::ptrdiff_t> (indices_->size ());
 
-      // Correspondence IS reciprocal, save it and continue
-      corr.index_query = *idx_i;
-      corr.index_match = nn_indices[min_index];
-      corr.distance = nn_dists[min_index];//min_dist;
-      correspondences[nr_valid_correspondences++] = corr;
-    }
-  }
-  else
+#pragma omp parallel \
+  default(none) \
+  shared(correspondences) \
+  firstprivate(max_distance, nr_indices) \
+  num_threads(threads_)
   {
-    PointTarget pt;
+    pcl::search::NeighborBuffer neighbors (k_);
+    pcl::search::NeighborBuffer neighbors_reciprocal (1);
 
-    // Iterate over the input set of source indices
-    for (std::vector<int>::const_iterator idx_i = indices_->begin (); idx_i != indices_->end (); ++idx_i)
+#pragma omp for schedule(dynamic, 256)
+    for (std::ptrdiff_t i = 0; i < nr_indices; ++i)
     {
-      tree_->nearestKSearch (input_->points[*idx_i], k_, nn_indices, nn_dists);
-
-      // Among the K nearest neighbours find the one with minimum perpendicular distance to the normal
-      double min_dist = std::numeric_limits<double>::max ();
-
-      // Find the best correspondence
-      for (std::size_t j = 0; j < nn_indices.size (); j++)
-      {
-        PointSource pt_src;
-        // Copy the source data to a target PointTarget format so we can search in the tree
-        copyPoint (input_->points[*idx_i], pt_src);
-
-        // computing the distance between a point and a line in 3d.
-        // Reference - http://mathworld.wolfram.com/Point-LineDistance3-Dimensional.html
-        pt.x = target_->points[nn_indices[j]].x - pt_src.x;
-        pt.y = target_->points[nn_indices[j]].y - pt_src.y;
-        pt.z = target_->points[nn_indices[j]].z - pt_src.z;
-
-        const NormalT &normal = source_normals_->points[*idx_i];
-        Eigen::Vector3d N (normal.normal_x, normal.normal_y, normal.normal_z);
-        Eigen::Vector3d V (pt.x, pt.y, pt.z);
-        Eigen::Vector3d C = N.cross (V);
-
-        // Check if we have a better correspondence
-        double dist = C.dot (C);
-        if (dist < min_dist)
-        {
-          min_dist = dist;
-          min_index = static_cast<int> (j);
-        }
-      }
-      if (min_dist > max_distance)
+      const int idx = (*indices_)[i];
+      tree_->nearestKSearch (input_->points[idx], k_, neighbors);
+      const int min_index = selectCorrespondence (idx, neighbors, max_distance);
+      if (min_index < 0)
         continue;
 
       // Check if the correspondence is reciprocal
-      target_idx = nn_indices[min_index];
-      tree_reciprocal_->nearestKSearch (target_->points[target_idx], 1, index_reciprocal, distance_reciprocal);
-
-      if (*idx_i != index_reciprocal[0])
+      const int target_idx = neighbors.indices[min_index];
+      tree_reciprocal_->nearestKSearch (target_->points[target_idx], 1, neighbors_reciprocal);
+      if (neighbors_reciprocal.size () == 0 || idx != neighbors_reciprocal.indices[0])
         continue;
 
-      // Correspondence IS reciprocal, save it and continue
-      corr.index_query = *idx_i;
-      corr.index_match = nn_indices[min_index];
-      corr.distance = nn_dists[min_index];//min_dist;
-      correspondences[nr_valid_correspondences++] = corr;
+      // Correspondence IS reciprocal, save it
+      pcl::Correspondence &corr = correspondences[i];
+      corr.index_query = idx;
+      corr.index_match = target_idx;
+      corr.distance = neighbors.sqr_distances[min_index];
     }
   }
-  correspondences.resize (nr_valid_correspondences);
+  removeUnmatchedCorrespondences (correspondences);
   deinitCompute ();
 }
 
@@ -41,13 +41,32 @@
 #ifndef PCL_REGISTRATION_IMPL_GICP_HPP_
 #define PCL_REGISTRATION_IMPL_GICP_HPP_
 
+#include <pcl/common/eigen.h>
 #include <pcl/registration/boost.h>
 #include <pcl/registration/exceptions.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 namespace pcl
 {
 
+template <typename PointSource, typename PointTarget> void
+GeneralizedIterativeClosestPoint<PointSource, PointTarget>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs ();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
+
 template <typename PointSource, typename PointTarget>
 template<typename PointT> void
 GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeCovariances(typename pcl::PointCloud<PointT>::ConstPtr cloud,
@@ -60,67 +79,82 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeCovariances(t
     return;
   }
 
-  Eigen::Vector3d mean;
-  std::vector<int> nn_indecies; nn_indecies.reserve (k_correspondences_);
-  std::vector<float> nn_dist_sq; nn_dist_sq.reserve (k_correspondences_);
-
   // We should never get there but who knows
   if(cloud_covariances.size () < cloud->size ())
     cloud_covariances.resize (cloud->size ());
 
-  MatricesVector::iterator matrices_iterator = cloud_covariances.begin ();
-  for(auto points_iterator = cloud->begin ();
-      points_iterator != cloud->end ();
-      ++points_iterator, ++matrices_iterator)
+  const auto nr_points = static_cast<std::ptrdiff_t> (cloud->size ());
+  const double gicp_epsilon = gicp_epsilon_;
+  const int k_correspondences = k_correspondences_;
+
+#pragma omp parallel \
+  default(none) \
+  shared(cloud, cloud_covariances, kdtree) \
+  firstprivate(nr_points, gicp_epsilon, k_correspondences) \
+  num_threads(threads_)
   {
-    const PointT &query_point = *points_iterator;
-    Eigen::Matrix3d &cov = *matrices_iterator;
-    // Zero out the cov and mean
-    cov.setZero ();
-    mean.setZero ();
+    pcl::search::NeighborBuffer neighbors (k_correspondences);
 
-    // Search for the K nearest neighbours
-    kdtree->nearestKSearch(query_point, k_correspondences_, nn_indecies, nn_dist_sq);
+#pragma omp for schedule(dynamic, 256)
+    for (std::ptrdiff_t i = 0; i < nr_points; ++i)
+    {
+      const PointT &query_point = (*cloud)[i];
+      Eigen::Matrix3d &cov = cloud_covariances[i];
+      // Zero out the cov and mean
+      cov.setZero ();
+      Eigen::Vector3d mean = Eigen::Vector3d::Zero ();
+
+      // Search for the K nearest neighbours
+      if (kdtree->nearestKSearch (query_point, k_correspondences, neighbors) == 0)
+      {
+        cov.setIdentity ();
+        continue;
+      }
 
-    // Find the covariance matrix
-    for(int j = 0; j < k_correspondences_; j++) {
-      const PointT &pt = (*cloud)[nn_indecies[j]];
+      // Find the covariance matrix
+      for (const int nn_index : neighbors.indices)
+      {
+        const PointT &pt = (*cloud)[nn_index];
 
-      mean[0] += pt.x;
-      mean[1] += pt.y;
-      mean[2] += pt.z;
+        mean[0] += pt.x;
+        mean[1] += pt.y;
+        mean[2] += pt.z;
 
-      cov(0,0) += pt.x*pt.x;
+        cov(0,0) += pt.x*pt.x;
 
-      cov(1,0) += pt.y*pt.x;
-      cov(1,1) += pt.y*pt.y;
+        cov(1,0) += pt.y*pt.x;
+        cov(1,1) += pt.y*pt.y;
 
-      cov(2,0) += pt.z*pt.x;
-      cov(2,1) += pt.z*pt.y;
-      cov(2,2) += pt.z*pt.z;
-    }
+        cov(2,0) += pt.z*pt.x;
+        cov(2,1) += pt.z*pt.y;
+        cov(2,2) += pt.z*pt.z;
+      }
+
+      const double nr_neighbors = static_cast<double> (neighbors.size ());
+      mean /= nr_neighbors;
+      // Get the actual covariance
+      for (int k = 0; k < 3; k++)
+        for (int l = 0; l <= k; l++)
+        {
+          cov(k,l) /= nr_neighbors;
+          cov(k,l) -= mean[k]*mean[l];
+          cov(l,k) = cov(k,l);
+        }
 
-    mean /= static_cast<double> (k_correspondences_);
-    // Get the actual covariance
-    for (int k = 0; k < 3; k++)
-      for (int l = 0; l <= k; l++)
+      // Find the direction of the smallest eigenvalue in closed form
+      double eigen_value;
+      Eigen::Vector3d eigen_vector;
+      pcl::eigen33 (cov, eigen_value, eigen_vector);
+      // The closed form is undefined when the smallest eigenvalue is repeated (e.g. collinear neighbors)
+      if (!eigen_vector.allFinite ())
       {
-        cov(k,l) /= static_cast<double> (k_correspondences_);
-        cov(k,l) -= mean[k]*mean[l];
-        cov(l,k) = cov(k,l);
+        Eigen::JacobiSVD<Eigen::Matrix3d> svd (cov, Eigen::ComputeFullU);
+        eigen_vector = svd.matrixU ().col (2);
       }
 
-    // Compute the SVD (covariance matrix is symmetric so U = V')
-    Eigen::JacobiSVD<Eigen::Matrix3d> svd(cov, Eigen::ComputeFullU);
-    cov.setZero ();
-    Eigen::Matrix3d U = svd.matrixU ();
-    // Reconstitute the covariance matrix with modified singular values using the column     // vectors in V.
-    for(int k = 0; k < 3; k++) {
-      Eigen::Vector3d col = U.col(k);
-      double v = 1.; // biggest 2 singular values replaced by 1
-      if(k == 2)   // smallest singular value replaced by gicp_epsilon
-        v = gicp_epsilon_;
-      cov+= v * col * col.transpose();
+      // Reconstitute the covariance matrix with the two biggest eigenvalues replaced by 1 and
+      // the smallest one replaced by gicp_epsilon, i.e. U * diag (1, 1, epsilon) * U'
+      cov = Eigen::Matrix3d::Identity () - (1. - gicp_epsilon) * eigen_vector * eigen_vector.transpose ();
     }
   }
 }
@@ -251,98 +285,105 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget>::estimateRigidTransfo
 template <typename PointSource, typename PointTarget> inline double
 GeneralizedIterativeClosestPoint<PointSource, PointTarget>::OptimizationFunctorWithIndices::operator() (const Vector6d& x)
 {
-  Eigen::Matrix4f transformation_matrix = gicp_->base_transformation_;
-  gicp_->applyState(transformation_matrix, x);
-  double f = 0;
-  int m = static_cast<int> (gicp_->tmp_idx_src_->size ());
-  for (int i = 0; i < m; ++i)
-  {
-    // The last coordinate, p_src[3] is guaranteed to be set to 1.0 in registration.hpp
-    Vector4fMapConst p_src = gicp_->tmp_src_->points[(*gicp_->tmp_idx_src_)[i]].getVector4fMap ();
-    // The last coordinate, p_tgt[3] is guaranteed to be set to 1.0 in registration.hpp
-    Vector4fMapConst p_tgt = gicp_->tmp_tgt_->points[(*gicp_->tmp_idx_tgt_)[i]].getVector4fMap ();
-    Eigen::Vector4f pp (transformation_matrix * p_src);
-    // Estimate the distance (cost function)
-    // The last coordinate is still guaranteed to be set to 1.0
-    Eigen::Vector3d res(pp[0] - p_tgt[0], pp[1] - p_tgt[1], pp[2] - p_tgt[2]);
-    Eigen::Vector3d temp (gicp_->mahalanobis((*gicp_->tmp_idx_src_)[i]) * res);
-    //increment= res'*temp/num_matches = temp'*M*temp/num_matches (we postpone 1/num_matches after the loop closes)
-    f+= double(res.transpose() * temp);
-  }
-  return f/m;
+  double f;
+  evaluate (x, &f, nullptr);
+  return f;
 }
 
 
 template <typename PointSource, typename PointTarget> inline void
 GeneralizedIterativeClosestPoint<PointSource, PointTarget>::OptimizationFunctorWithIndices::df (const Vector6d& x, Vector6d& g)
 {
-  Eigen::Matrix4f transformation_matrix = gicp_->base_transformation_;
-  gicp_->applyState(transformation_matrix, x);
-  //Zero out g
-  g.setZero ();
-  //Eigen::Vector3d g_t = g.head<3> ();
-  Eigen::Matrix3d R = Eigen::Matrix3d::Zero ();
-  int m = static_cast<int> (gicp_->tmp_idx_src_->size ());
-  for (int i = 0; i < m; ++i)
-  {
-    // The last coordinate, p_src[3] is guaranteed to be set to 1.0 in registration.hpp
-    Vector4fMapConst p_src = gicp_->tmp_src_->points[(*gicp_->tmp_idx_src_)[i]].getVector4fMap ();
-    // The last coordinate, p_tgt[3] is guaranteed to be set to 1.0 in registration.hpp
-    Vector4fMapConst p_tgt = gicp_->tmp_tgt_->points[(*gicp_->tmp_idx_tgt_)[i]].getVector4fMap ();
-
-    Eigen::Vector4f pp (transformation_matrix * p_src);
-    // The last coordinate is still guaranteed to be set to 1.0
-    Eigen::Vector3d res (pp[0] - p_tgt[0], pp[1] - p_tgt[1], pp[2] - p_tgt[2]);
-    // temp = M*res
-    Eigen::Vector3d temp (gicp_->mahalanobis ((*gicp_->tmp_idx_src_)[i]) * res);
-    // Increment translation gradient
-    // g.head<3> ()+= 2*M*res/num_matches (we postpone 2/num_matches after the loop closes)
-    g.head<3> ()+= temp;
-    // Increment rotation gradient
-    pp = gicp_->base_transformation_ * p_src;
-    Eigen::Vector3d p_src3 (pp[0], pp[1], pp[2]);
-    R+= p_src3 * temp.transpose();
-  }
-  g.head<3> ()*= 2.0/m;
-  R*= 2.0/m;
-  gicp_->computeRDerivative(x, R, g);
+  evaluate (x, nullptr, &g);
 }
 
 
 template <typename PointSource, typename PointTarget> inline void
 GeneralizedIterativeClosestPoint<PointSource, PointTarget>::OptimizationFunctorWithIndices::fdf (const Vector6d& x, double& f, Vector6d& g)
+{
+  evaluate (x, &f, &g);
+}
+
+
+template <typename PointSource, typename PointTarget> void
+GeneralizedIterativeClosestPoint<PointSource, PointTarget>::OptimizationFunctorWithIndices::evaluate (const Vector6d& x, double *f, Vector6d *g) const
 {
   Eigen::Matrix4f transformation_matrix = gicp_->base_transformation_;
   gicp_->applyState(transformation_matrix, x);
-  f = 0;
-  g.setZero ();
+  const Eigen::Matrix4f &base_transformation = gicp_->base_transformation_;
+  const PointCloudSource &src = *gicp_->tmp_src_;
+  const PointCloudTarget &tgt = *gicp_->tmp_tgt_;
+  const std::vector<int> &idx_src = *gicp_->tmp_idx_src_;
+  const std::vector<int> &idx_tgt = *gicp_->tmp_idx_tgt_;
+  const bool compute_f = (f != nullptr);
+  const bool compute_g = (g != nullptr);
+
+  // The correspondences are summed by blocks of fixed size whose partial sums are added up in
+  // order afterwards, so that the result does not depend on the number of threads
+  const int block_size = 512;
+  const int m = static_cast<int> (idx_src.size ());
+  const int nr_blocks = (m + block_size - 1) / block_size;
+  std::vector<double> block_f (nr_blocks, 0.);
+  std::vector<Eigen::Vector3d> block_g (nr_blocks, Eigen::Vector3d::Zero ());
+  std::vector<Eigen::Matrix3d> block_R (nr_blocks, Eigen::Matrix3d::Zero ());
+
+#pragma omp parallel for \
+  default(none) \
+  shared(base_transformation, block_f, block_g, block_R, idx_src, idx_tgt, src, tgt, transformation_matrix) \
+  firstprivate(block_size, compute_f, compute_g, m, nr_blocks) \
+  schedule(dynamic) \
+  num_threads(gicp_->threads_)
+  for (int block = 0; block < nr_blocks; ++block)
+  {
+    const int end = std::min (m, (block + 1) * block_size);
+    for (int i = block * block_size; i < end; ++i)
+    {
+      // The last coordinate, p_src[3] is guaranteed to be set to 1.0 in registration.hpp
+      Vector4fMapConst p_src = src.points[idx_src[i]].getVector4fMap ();
+      // The last coordinate, p_tgt[3] is guaranteed to be set to 1.0 in registration.hpp
+      Vector4fMapConst p_tgt = tgt.points[idx_tgt[i]].getVector4fMap ();
+      Eigen::Vector4f pp (transformation_matrix * p_src);
+      // Estimate the distance (cost function)
+      // The last coordinate is still guaranteed to be set to 1.0
+      Eigen::Vector3d res (pp[0] - p_tgt[0], pp[1] - p_tgt[1], pp[2] - p_tgt[2]);
+      // temp = M*res
+      Eigen::Vector3d temp (gicp_->mahalanobis (idx_src[i]) * res);
+      // Increment total error
+      //increment= res'*temp/num_matches = temp'*M*temp/num_matches (we postpone 1/num_matches after the loop closes)
+      if (compute_f)
+        block_f[block] += double(res.transpose() * temp);
+      if (compute_g)
+      {
+        // Increment translation gradient
+        // g.head<3> ()+= 2*M*res/num_matches (we postpone 2/num_matches after the loop closes)
+        block_g[block] += temp;
+        // Increment rotation gradient
+        pp = base_transformation * p_src;
+        Eigen::Vector3d p_src3 (pp[0], pp[1], pp[2]);
+        block_R[block] += p_src3 * temp.transpose();
+      }
+    }
+  }
+
+  double sum_f = 0;
+  Eigen::Vector3d sum_g = Eigen::Vector3d::Zero ();
   Eigen::Matrix3d R = Eigen::Matrix3d::Zero ();
-  const int m = static_cast<int> (gicp_->tmp_idx_src_->size ());
-  for (int i = 0; i < m; ++i)
+  for (int block = 0; block < nr_blocks; ++block)
   {
-    // The last coordinate, p_src[3] is guaranteed to be set to 1.0 in registration.hpp
-    Vector4fMapConst p_src = gicp_->tmp_src_->points[(*gicp_->tmp_idx_src_)[i]].getVector4fMap ();
-    // The last coordinate, p_tgt[3] is guaranteed to be set to 1.0 in registration.hpp
-    Vector4fMapConst p_tgt = gicp_->tmp_tgt_->points[(*gicp_->tmp_idx_tgt_)[i]].getVector4fMap ();
-    Eigen::Vector4f pp (transformation_matrix * p_src);
-    // The last coordinate is still guaranteed to be set to 1.0
-    Eigen::Vector3d res (pp[0] - p_tgt[0], pp[1] - p_tgt[1], pp[2] - p_tgt[2]);
-    // temp = M*res
-    Eigen::Vector3d temp (gicp_->mahalanobis((*gicp_->tmp_idx_src_)[i]) * res);
-    // Increment total error
-    f+= double(res.transpose() * temp);
-    // Increment translation gradient
-    // g.head<3> ()+= 2*M*res/num_matches (we postpone 2/num_matches after the loop closes)
-    g.head<3> ()+= temp;
-    pp = gicp_->base_transformation_ * p_src;
-    Eigen::Vector3d p_src3 (pp[0], pp[1], pp[2]);
-    // Increment rotation gradient
-    R+= p_src3 * temp.transpose();
+    sum_f += block_f[block];
+    sum_g += block_g[block];
+    R += block_R[block];
+  }
+
+  if (compute_f)
+    *f = sum_f / double(m);
+  if (compute_g)
+  {
+    g->setZero ();
+    g->head<3> () = sum_g * double(2.0/m);
+    R*= 2.0/m;
+    gicp_->computeRDerivative(x, R, *g);
   }
-  f/= double(m);
-  g.head<3> ()*= double(2.0/m);
-  R*= 2.0/m;
-  gicp_->computeRDerivative(x, R, g);
 }
 
 template <typename PointSource, typename PointTarget> inline BFGSSpace::Status
@@ -394,17 +435,10 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeTransformatio
   nr_iterations_ = 0;
   converged_ = false;
   double dist_threshold = corr_dist_threshold_ * corr_dist_threshold_;
-  std::vector<int> nn_indices (1);
-  std::vector<float> nn_dists (1);
-
   pcl::transformPointCloud(output, output, guess);
 
   while(!converged_)
   {
-    std::size_t cnt = 0;
-    std::vector<int> source_indices (indices_->size ());
-    std::vector<int> target_indices (indices_->size ());
-
     // guess corresponds to base_t and transformation_ to t
     Eigen::Matrix4d transform_R = Eigen::Matrix4d::Zero ();
     for(std::size_t i = 0; i < 4; i++)
@@ -412,39 +446,70 @@ GeneralizedIterativeClosestPoint<PointSource, PointTarget>::computeTransformatio
         for(std::size_t k = 0; k < 4; k++)
           transform_R(i,j)+= double(transformation_(i,k)) * double(guess(k,j));
 
-    Eigen::Matrix3d R = transform_R.topLeftCorner<3,3> ();
+    const Eigen::Matrix3d R = transform_R.topLeftCorner<3,3> ();
 
-    for (std::size_t i = 0; i < N; i++)
+    // Nearest target point of each source point, -1 when farther than the distance threshold
+    // and -2 when no neighbor was found
+    std::vector<int> nn_targets (N);
+    const auto nr_points = static_cast<std::ptrdiff_t> (N);
+
+#pragma omp parallel \
+  default(none) \
+  shared(nn_targets, output) \
+  firstprivate(dist_threshold, nr_points, R) \
+  num_threads(threads_)
     {
-      PointSource query = output[i];
-      query.getVector4fMap () = transformation_ * query.getVector4fMap ();
+      pcl::search::NeighborBuffer neighbors (1);
+
+#pragma omp for schedule(dynamic, 256)
+      for (std::ptrdiff_t i = 0; i < nr_points; i++)
+      {
+        PointSource query = output[i];
+        query.getVector4fMap () = transformation_ * query.getVector4fMap ();
+
+        if (tree_->nearestKSearch (query, 1, neighbors) == 0)
+        {
+          nn_targets[i] = -2;
+          continue;
+        }
 
-      if (!searchForNeighbors (query, nn_indices, nn_dists))
+        // Check if the distance to the nearest neighbor is smaller than the user imposed threshold
+        if (neighbors.sqr_distances[0] < dist_threshold)
+        {
+          const Eigen::Matrix3d &C1 = (*input_covariances_)[i];
+          const Eigen::Matrix3d &C2 = (*target_covariances_)[neighbors.indices[0]];
+          Eigen::Matrix3d &M = mahalanobis_[i];
+          // M = R*C1
+          M = R * C1;
+          // temp = M*R' + C2 = R*C1*R' + C2
+          Eigen::Matrix3d temp = M * R.transpose();
+          temp+= C2;
+          // M = temp^-1
+          M = temp.inverse ();
+          nn_targets[i] = neighbors.indices[0];
+        }
+        else
+          nn_targets[i] = -1;
+      }
+    }
+
+    // Gather the valid correspondences in source order
+    std::vector<int> source_indices, target_indices;
+    source_indices.reserve (N);
+    target_indices.reserve (N);
+    for (std::size_t i = 0; i < N; i++)
+    {
+      if (nn_targets[i] == -2)
       {
         PCL_ERROR ("[pcl::%s::computeTransformation] Unable to find a nearest neighbor in the target dataset for point %d in the source!\n", getClassName ().c_str (), (*indices_)[i]);
         return;
       }
-
-      // Check if the distance to the nearest neighbor is smaller than the user imposed threshold
-      if (nn_dists[0] < dist_threshold)
+      if (nn_targets[i] >= 0)
       {
-        Eigen::Matrix3d &C1 = (*input_covariances_)[i];
-        Eigen::Matrix3d &C2 = (*target_covariances_)[nn_indices[0]];
-        Eigen::Matrix3d &M = mahalanobis_[i];
-        // M = R*C1
-        M = R * C1;
-        // temp = M*R' + C2 = R*C1*R' + C2
-        Eigen::Matrix3d temp = M * R.transpose();
-        temp+= C2;
-        // M = temp^-1
-        M = temp.inverse ();
-        source_indices[cnt] = static_cast<int> (i);
-        target_indices[cnt] = nn_indices[0];
-        cnt++;
+        source_indices.push_back (static_cast<int> (i));
+        target_indices.push_back (nn_targets[i]);
       }
     }
-    // Resize to the actual number of valid correspondences
-    source_indices.resize(cnt); target_indices.resize(cnt);
     /* optimize transformation using the current assignment and Mahalanobis metrics*/
     previous_transformation_ = transformation_;
     //optimization right here
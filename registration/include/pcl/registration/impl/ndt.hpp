@@ -41,6 +41,9 @@
 #ifndef PCL_REGISTRATION_NDT_IMPL_H_
 #define PCL_REGISTRATION_NDT_IMPL_H_
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace pcl
 {
@@ -48,6 +51,8 @@ namespace pcl
 template<typename PointSource, typename PointTarget>
 NormalDistributionsTransform<PointSource, PointTarget>::NormalDistributionsTransform ()
   : target_cells_ ()
+  , search_method_ (NeighborSearchMethod::KDTREE)
+  , threads_ (1)
   , resolution_ (1.0f)
   , step_size_ (0.1)
   , outlier_ratio_ (0.55)
@@ -71,6 +76,20 @@ NormalDistributionsTransform<PointSource, PointTarget>::NormalDistributionsTrans
 }
 
 
+template<typename PointSource, typename PointTarget> void
+NormalDistributionsTransform<PointSource, PointTarget>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs ();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
+
 template<typename PointSource, typename PointTarget> void
 NormalDistributionsTransform<PointSource, PointTarget>::computeTransformation (PointCloudSource &output, const Eigen::Matrix4f &guess)
 {
@@ -182,52 +201,106 @@ NormalDistributionsTransform<PointSource, PointTarget>::computeDerivatives (Eige
                                                                             Eigen::Matrix<double, 6, 1> &p,
                                                                             bool compute_hessian)
 {
-  // Original Point and Transformed Point
-  PointSource x_pt, x_trans_pt;
-  // Original Point and Transformed Point (for math)
-  Eigen::Vector3d x, x_trans;
-  // Occupied Voxel
-  TargetGridLeafConstPtr cell;
-  // Inverse Covariance of Occupied Voxel
-  Eigen::Matrix3d c_inv;
-
-  score_gradient.setZero ();
-  hessian.setZero ();
-  double score = 0;
-
   // Precompute Angular Derivatives (eq. 6.19 and 6.21)[Magnusson 2009]
   computeAngleDerivatives (p);
 
   // Update gradient and hessian for each point, line 17 in Algorithm 2 [Magnusson 2009]
-  for (std::size_t idx = 0; idx < input_->points.size (); idx++)
+  return (accumulateDerivatives (score_gradient, hessian, trans_cloud, true, compute_hessian));
+}
+
+
+template<typename PointSource, typename PointTarget> int
+NormalDistributionsTransform<PointSource, PointTarget>::getNeighborhood (const PointSource &x_trans_pt,
+                                                                         std::vector<TargetGridLeafConstPtr> &neighborhood,
+                                                                         std::vector<float> &distances) const
+{
+  switch (search_method_)
   {
-    x_trans_pt = trans_cloud.points[idx];
+    case NeighborSearchMethod::DIRECT7:
+      return (target_cells_.getFaceNeighborsAtPoint (x_trans_pt, neighborhood));
+    case NeighborSearchMethod::DIRECT1:
+      return (target_cells_.getVoxelAtPoint (x_trans_pt, neighborhood));
+    case NeighborSearchMethod::KDTREE:
+    default:
+      // Radius search has been experimentally faster than checking all 26 direct neighbors
+      return (target_cells_.radiusSearch (x_trans_pt, resolution_, neighborhood, distances));
+  }
+}
 
-    // Find nieghbors (Radius search has been experimentally faster than direct neighbor checking.
+
+template<typename PointSource, typename PointTarget> double
+NormalDistributionsTransform<PointSource, PointTarget>::accumulateDerivatives (Eigen::Matrix<double, 6, 1> &score_gradient,
+                                                                               Eigen::Matrix<double, 6, 6> &hessian,
+                                                                               const PointCloudSource &trans_cloud,
+                                                                               bool compute_score, bool compute_hessian)
+{
+  // The points are split in blocks of fixed size whose partial sums are added up in order
+  // afterwards, so that the result does not depend on the number of threads
+  const std::size_t block_size = 256;
+  const std::size_t nr_points = input_->points.size ();
+  const std::size_t nr_blocks = (nr_points + block_size - 1) / block_size;
+
+  std::vector<double> block_scores (nr_blocks, 0);
+  std::vector<Eigen::Matrix<double, 6, 1>, Eigen::aligned_allocator<Eigen::Matrix<double, 6, 1> > >
+    block_gradients (nr_blocks, Eigen::Matrix<double, 6, 1>::Zero ());
+  std::vector<Eigen::Matrix<double, 6, 6>, Eigen::aligned_allocator<Eigen::Matrix<double, 6, 6> > >
+    block_hessians (nr_blocks, Eigen::Matrix<double, 6, 6>::Zero ());
+
+#pragma omp parallel \
+  default(none) \
+  shared(block_scores, block_gradients, block_hessians, trans_cloud) \
+  firstprivate(compute_score, compute_hessian, nr_points, nr_blocks) \
+  num_threads(threads_)
+  {
+    // Per thread derivatives of the transformation of a point and neighbor search buffers
+    Eigen::Matrix<double, 3, 6> point_gradient;
+    point_gradient.setZero ();
+    point_gradient.block<3, 3>(0, 0).setIdentity ();
+    Eigen::Matrix<double, 18, 6> point_hessian;
+    point_hessian.setZero ();
     std::vector<TargetGridLeafConstPtr> neighborhood;
     std::vector<float> distances;
-    target_cells_.radiusSearch (x_trans_pt, resolution_, neighborhood, distances);
 
-    for (typename std::vector<TargetGridLeafConstPtr>::iterator neighborhood_it = neighborhood.begin (); neighborhood_it != neighborhood.end (); ++neighborhood_it)
+#pragma omp for schedule(dynamic)
+    for (std::ptrdiff_t block = 0; block < static_cast<std::ptrdiff_t> (nr_blocks); ++block)
     {
-      cell = *neighborhood_it;
-      x_pt = input_->points[idx];
-      x = Eigen::Vector3d (x_pt.x, x_pt.y, x_pt.z);
-
-      x_trans = Eigen::Vector3d (x_trans_pt.x, x_trans_pt.y, x_trans_pt.z);
-
-      // Denorm point, x_k' in Equations 6.12 and 6.13 [Magnusson 2009]
-      x_trans -= cell->getMean ();
-      // Uses precomputed covariance for speed.
-      c_inv = cell->getInverseCov ();
-
-      // Compute derivative of transform function w.r.t. transform vector, J_E and H_E in Equations 6.18 and 6.20 [Magnusson 2009]
-      computePointDerivatives (x);
-      // Update score, gradient and hessian, lines 19-21 in Algorithm 2, according to Equations 6.10, 6.12 and 6.13, respectively [Magnusson 2009]
-      score += updateDerivatives (score_gradient, hessian, x_trans, c_inv, compute_hessian);
+      const std::size_t end = std::min (nr_points, (block + 1) * block_size);
+      for (std::size_t idx = block * block_size; idx < end; ++idx)
+      {
+        const PointSource &x_trans_pt = trans_cloud.points[idx];
+        if (getNeighborhood (x_trans_pt, neighborhood, distances) == 0)
+          continue;
 
+        // Compute derivative of transform function w.r.t. transform vector, J_E and H_E in Equations 6.18 and 6.20 [Magnusson 2009]
+        const PointSource &x_pt = input_->points[idx];
+        const Eigen::Vector3d x (x_pt.x, x_pt.y, x_pt.z);
+        computePointDerivatives (x, point_gradient, point_hessian, compute_hessian);
+
+        for (const TargetGridLeafConstPtr &cell : neighborhood)
+        {
+          // Denorm point, x_k' in Equations 6.12 and 6.13 [Magnusson 2009]
+          const Eigen::Vector3d x_trans = Eigen::Vector3d (x_trans_pt.x, x_trans_pt.y, x_trans_pt.z) - cell->mean_;
+
+          // Update score, gradient and hessian, lines 19-21 in Algorithm 2, according to Equations 6.10, 6.12 and 6.13, respectively [Magnusson 2009]
+          if (compute_score)
+            block_scores[block] += updateDerivatives (block_gradients[block], block_hessians[block],
+                                                      point_gradient, point_hessian, x_trans, cell->icov_, compute_hessian);
+          else
+            updateHessian (block_hessians[block], point_gradient, point_hessian, x_trans, cell->icov_);
+        }
+      }
     }
   }
+
+  score_gradient.setZero ();
+  hessian.setZero ();
+  double score = 0;
+  for (std::size_t block = 0; block < nr_blocks; ++block)
+  {
+    score += block_scores[block];
+    score_gradient += block_gradients[block];
+    hessian += block_hessians[block];
+  }
   return (score);
 }
 
@@ -311,17 +384,27 @@ NormalDistributionsTransform<PointSource, PointTarget>::computeAngleDerivatives
 
 template<typename PointSource, typename PointTarget> void
 NormalDistributionsTransform<PointSource, PointTarget>::computePointDerivatives (Eigen::Vector3d &x, bool compute_hessian)
+{
+  computePointDerivatives (x, point_gradient_, point_hessian_, compute_hessian);
+}
+
+
+template<typename PointSource, typename PointTarget> void
+NormalDistributionsTransform<PointSource, PointTarget>::computePointDerivatives (const Eigen::Vector3d &x,
+                                                                                 Eigen::Matrix<double, 3, 6> &point_gradient,
+                                                                                 Eigen::Matrix<double, 18, 6> &point_hessian,
+                                                                                 bool compute_hessian) const
 {
   // Calculate first derivative of Transformation Equation 6.17 w.r.t. transform vector p.
   // Derivative w.r.t. ith element of transform vector corresponds to column i, Equation 6.18 and 6.19 [Magnusson 2009]
-  point_gradient_ (1, 3) = x.dot (j_ang_a_);
-  point_gradient_ (2, 3) = x.dot (j_ang_b_);
-  point_gradient_ (0, 4) = x.dot (j_ang_c_);
-  point_gradient_ (1, 4) = x.dot (j_ang_d_);
-  point_gradient_ (2, 4) = x.dot (j_ang_e_);
-  point_gradient_ (0, 5) = x.dot (j_ang_f_);
-  point_gradient_ (1, 5) = x.dot (j_ang_g_);
-  point_gradient_ (2, 5) = x.dot (j_ang_h_);
+  point_gradient (1, 3) = x.dot (j_ang_a_);
+  point_gradient (2, 3) = x.dot (j_ang_b_);
+  point_gradient (0, 4) = x.dot (j_ang_c_);
+  point_gradient (1, 4) = x.dot (j_ang_d_);
+  point_gradient (2, 4) = x.dot (j_ang_e_);
+  point_gradient (0, 5) = x.dot (j_ang_f_);
+  point_gradient (1, 5) = x.dot (j_ang_g_);
+  point_gradient (2, 5) = x.dot (j_ang_h_);
 
   if (compute_hessian)
   {
@@ -337,15 +420,15 @@ NormalDistributionsTransform<PointSource, PointTarget>::computePointDerivatives
 
     // Calculate second derivative of Transformation Equation 6.17 w.r.t. transform vector p.
     // Derivative w.r.t. ith and jth elements of transform vector corresponds to the 3x1 block matrix starting at (3i,j), Equation 6.20 and 6.21 [Magnusson 2009]
-    point_hessian_.block<3, 1>(9, 3) = a;
-    point_hessian_.block<3, 1>(12, 3) = b;
-    point_hessian_.block<3, 1>(15, 3) = c;
-    point_hessian_.block<3, 1>(9, 4) = b;
-    point_hessian_.block<3, 1>(12, 4) = d;
-    point_hessian_.block<3, 1>(15, 4) = e;
-    point_hessian_.block<3, 1>(9, 5) = c;
-    point_hessian_.block<3, 1>(12, 5) = e;
-    point_hessian_.block<3, 1>(15, 5) = f;
+    point_hessian.block<3, 1>(9, 3) = a;
+    point_hessian.block<3, 1>(12, 3) = b;
+    point_hessian.block<3, 1>(15, 3) = c;
+    point_hessian.block<3, 1>(9, 4) = b;
+    point_hessian.block<3, 1>(12, 4) = d;
+    point_hessian.block<3, 1>(15, 4) = e;
+    point_hessian.block<3, 1>(9, 5) = c;
+    point_hessian.block<3, 1>(12, 5) = e;
+    point_hessian.block<3, 1>(15, 5) = f;
   }
 }
 
@@ -356,7 +439,18 @@ NormalDistributionsTransform<PointSource, PointTarget>::updateDerivatives (Eigen
                                                                            Eigen::Vector3d &x_trans, Eigen::Matrix3d &c_inv,
                                                                            bool compute_hessian)
 {
-  Eigen::Vector3d cov_dxd_pi;
+  return (updateDerivatives (score_gradient, hessian, point_gradient_, point_hessian_, x_trans, c_inv, compute_hessian));
+}
+
+
+template<typename PointSource, typename PointTarget> double
+NormalDistributionsTransform<PointSource, PointTarget>::updateDerivatives (Eigen::Matrix<double, 6, 1> &score_gradient,
+                                                                           Eigen::Matrix<double, 6, 6> &hessian,
+                                                                           const Eigen::Matrix<double, 3, 6> &point_gradient,
+                                                                           const Eigen::Matrix<double, 18, 6> &point_hessian,
+                                                                           const Eigen::Vector3d &x_trans, const Eigen::Matrix3d &c_inv,
+                                                                           bool compute_hessian) const
+{
   // e^(-d_2/2 * (x_k - mu_k)^T Sigma_k^-1 (x_k - mu_k)) Equation 6.9 [Magnusson 2009]
   double e_x_cov_x = std::exp (-gauss_d2_ * x_trans.dot (c_inv * x_trans) / 2);
   // Calculate probability of transformed points existence, Equation 6.9 [Magnusson 2009]
@@ -371,26 +465,15 @@ NormalDistributionsTransform<PointSource, PointTarget>::updateDerivatives (Eigen
   // Reusable portion of Equation 6.12 and 6.13 [Magnusson 2009]
   e_x_cov_x *= gauss_d1_;
 
+  // Sigma_k^-1 d(T(x,p))/dpi for all i at once, Reusable portion of Equation 6.12 and 6.13 [Magnusson 2009]
+  const Eigen::Matrix<double, 3, 6> cov_dxd_p = c_inv * point_gradient;
+  const Eigen::Matrix<double, 6, 1> x_cov_dxd_p = cov_dxd_p.transpose () * x_trans;
 
-  for (int i = 0; i < 6; i++)
-  {
-    // Sigma_k^-1 d(T(x,p))/dpi, Reusable portion of Equation 6.12 and 6.13 [Magnusson 2009]
-    cov_dxd_pi = c_inv * point_gradient_.col (i);
-
-    // Update gradient, Equation 6.12 [Magnusson 2009]
-    score_gradient (i) += x_trans.dot (cov_dxd_pi) * e_x_cov_x;
+  // Update gradient, Equation 6.12 [Magnusson 2009]
+  score_gradient += e_x_cov_x * x_cov_dxd_p;
 
-    if (compute_hessian)
-    {
-      for (Eigen::Index j = 0; j < hessian.cols (); j++)
-      {
-        // Update hessian, Equation 6.13 [Magnusson 2009]
-        hessian (i, j) += e_x_cov_x * (-gauss_d2_ * x_trans.dot (cov_dxd_pi) * x_trans.dot (c_inv * point_gradient_.col (j)) +
-                                    x_trans.dot (c_inv * point_hessian_.block<3, 1>(3 * i, j)) +
-                                    point_gradient_.col (j).dot (cov_dxd_pi) );
-      }
-    }
-  }
+  if (compute_hessian)
+    addHessianContribution (hessian, point_gradient, point_hessian, x_trans, c_inv, cov_dxd_p, x_cov_dxd_p, e_x_cov_x);
 
   return (score_inc);
 }
@@ -400,58 +483,27 @@ template<typename PointSource, typename PointTarget> void
 NormalDistributionsTransform<PointSource, PointTarget>::computeHessian (Eigen::Matrix<double, 6, 6> &hessian,
                                                                         PointCloudSource &trans_cloud, Eigen::Matrix<double, 6, 1> &)
 {
-  // Original Point and Transformed Point
-  PointSource x_pt, x_trans_pt;
-  // Original Point and Transformed Point (for math)
-  Eigen::Vector3d x, x_trans;
-  // Occupied Voxel
-  TargetGridLeafConstPtr cell;
-  // Inverse Covariance of Occupied Voxel
-  Eigen::Matrix3d c_inv;
-
-  hessian.setZero ();
-
   // Precompute Angular Derivatives unessisary because only used after regular derivative calculation
 
   // Update hessian for each point, line 17 in Algorithm 2 [Magnusson 2009]
-  for (std::size_t idx = 0; idx < input_->points.size (); idx++)
-  {
-    x_trans_pt = trans_cloud.points[idx];
-
-    // Find nieghbors (Radius search has been experimentally faster than direct neighbor checking.
-    std::vector<TargetGridLeafConstPtr> neighborhood;
-    std::vector<float> distances;
-    target_cells_.radiusSearch (x_trans_pt, resolution_, neighborhood, distances);
-
-    for (typename std::vector<TargetGridLeafConstPtr>::iterator neighborhood_it = neighborhood.begin (); neighborhood_it != neighborhood.end (); ++neighborhood_it)
-    {
-      cell = *neighborhood_it;
-
-      {
-        x_pt = input_->points[idx];
-        x = Eigen::Vector3d (x_pt.x, x_pt.y, x_pt.z);
-
-        x_trans = Eigen::Vector3d (x_trans_pt.x, x_trans_pt.y, x_trans_pt.z);
+  Eigen::Matrix<double, 6, 1> score_gradient;
+  accumulateDerivatives (score_gradient, hessian, trans_cloud, false, true);
+}
 
-        // Denorm point, x_k' in Equations 6.12 and 6.13 [Magnusson 2009]
-        x_trans -= cell->getMean ();
-        // Uses precomputed covariance for speed.
-        c_inv = cell->getInverseCov ();
 
-        // Compute derivative of transform function w.r.t. transform vector, J_E and H_E in Equations 6.18 and 6.20 [Magnusson 2009]
-        computePointDerivatives (x);
-        // Update hessian, lines 21 in Algorithm 2, according to Equations 6.10, 6.12 and 6.13, respectively [Magnusson 2009]
-        updateHessian (hessian, x_trans, c_inv);
-      }
-    }
-  }
+template<typename PointSource, typename PointTarget> void
+NormalDistributionsTransform<PointSource, PointTarget>::updateHessian (Eigen::Matrix<double, 6, 6> &hessian, Eigen::Vector3d &x_trans, Eigen::Matrix3d &c_inv)
+{
+  updateHessian (hessian, point_gradient_, point_hessian_, x_trans, c_inv);
 }
 
 
 template<typename PointSource, typename PointTarget> void
-NormalDistributionsTransform<PointSource, PointTarget>::updateHessian (Eigen::Matrix<double, 6, 6> &hessian, Eigen::Vector3d &x_trans, Eigen::Matrix3d &c_inv)
+NormalDistributionsTransform<PointSource, PointTarget>::updateHessian (Eigen::Matrix<double, 6, 6> &hessian,
+                                                                       const Eigen::Matrix<double, 3, 6> &point_gradient,
+                                                                       const Eigen::Matrix<double, 18, 6> &point_hessian,
+                                                                       const Eigen::Vector3d &x_trans, const Eigen::Matrix3d &c_inv) const
 {
-  Eigen::Vector3d cov_dxd_pi;
   // e^(-d_2/2 * (x_k - mu_k)^T Sigma_k^-1 (x_k - mu_k)) Equation 6.9 [Magnusson 2009]
   double e_x_cov_x = gauss_d2_ * std::exp (-gauss_d2_ * x_trans.dot (c_inv * x_trans) / 2);
 
@@ -462,20 +514,34 @@ NormalDistributionsTransform<PointSource, PointTarget>::updateHessian (Eigen::Ma
   // Reusable portion of Equation 6.12 and 6.13 [Magnusson 2009]
   e_x_cov_x *= gauss_d1_;
 
-  for (int i = 0; i < 6; i++)
-  {
-    // Sigma_k^-1 d(T(x,p))/dpi, Reusable portion of Equation 6.12 and 6.13 [Magnusson 2009]
-    cov_dxd_pi = c_inv * point_gradient_.col (i);
+  // Sigma_k^-1 d(T(x,p))/dpi for all i at once, Reusable portion of Equation 6.12 and 6.13 [Magnusson 2009]
+  const Eigen::Matrix<double, 3, 6> cov_dxd_p = c_inv * point_gradient;
+  const Eigen::Matrix<double, 6, 1> x_cov_dxd_p = cov_dxd_p.transpose () * x_trans;
 
-    for (Eigen::Index j = 0; j < hessian.cols (); j++)
-    {
-      // Update hessian, Equation 6.13 [Magnusson 2009]
-      hessian (i, j) += e_x_cov_x * (-gauss_d2_ * x_trans.dot (cov_dxd_pi) * x_trans.dot (c_inv * point_gradient_.col (j)) +
-                                  x_trans.dot (c_inv * point_hessian_.block<3, 1>(3 * i, j)) +
-                                  point_gradient_.col (j).dot (cov_dxd_pi) );
-    }
-  }
+  addHessianContribution (hessian, point_gradient, point_hessian, x_trans, c_inv, cov_dxd_p, x_cov_dxd_p, e_x_cov_x);
+}
+
+
+template<typename PointSource, typename PointTarget> void
+NormalDistributionsTransform<PointSource, PointTarget>::addHessianContribution (Eigen::Matrix<double, 6, 6> &hessian,
+                                                                                const Eigen::Matrix<double, 3, 6> &point_gradient,
+                                                                                const Eigen::Matrix<double, 18, 6> &point_hessian,
+                                                                                const Eigen::Vector3d &x_trans, const Eigen::Matrix3d &c_inv,
+                                                                                const Eigen::Matrix<double, 3, 6> &cov_dxd_p,
+                                                                                const Eigen::Matrix<double, 6, 1> &x_cov_dxd_p,
+                                                                                double e_x_cov_x) const
+{
+  // x_k'^T Sigma_k^-1 d^2(T(x,p))/dpidpj
+  const Eigen::Vector3d cov_x = c_inv.transpose () * x_trans;
+  Eigen::Matrix<double, 6, 6> x_cov_dxd2_p;
+  for (int i = 0; i < 6; i++)
+    for (int j = 0; j < 6; j++)
+      x_cov_dxd2_p (i, j) = cov_x.dot (point_hessian.block<3, 1>(3 * i, j));
 
+  // Update hessian, Equation 6.13 [Magnusson 2009]
+  hessian += e_x_cov_x * (-gauss_d2_ * x_cov_dxd_p * x_cov_dxd_p.transpose () +
+                          x_cov_dxd2_p +
+                          cov_dxd_p.transpose () * point_gradient);
 }
 
 
@@ -91,6 +91,13 @@ namespace pcl
       using Ptr = shared_ptr< NormalDistributionsTransform<PointSource, PointTarget> >;
       using ConstPtr = shared_ptr< const NormalDistributionsTransform<PointSource, PointTarget> >;
 
+      /** \brief Method used to find the target voxels contributing to the score of a transformed point. */
+      enum class NeighborSearchMethod
+      {
+        KDTREE,   ///< radius search over the centroids of the occupied voxels
+        DIRECT7,  ///< the voxel containing the point and its 6 face neighbors
+        DIRECT1   ///< only the voxel containing the point
+      };
 
       /** \brief Constructor.
         * Sets \ref outlier_ratio_ to 0.35, \ref step_size_ to 0.05 and \ref resolution_ to 1.0
@@ -170,6 +177,39 @@ namespace pcl
         outlier_ratio_ = outlier_ratio;
       }
 
+      /** \brief Set the method used to look up the target voxels around each transformed point.
+        * \note The direct lookups skip the kd-tree search and are considerably faster, at the cost of a
+        * smaller basin of convergence.
+        * \param[in] method the neighbor search method (default: KDTREE)
+        */
+      inline void
+      setNeighborSearchMethod (NeighborSearchMethod method)
+      {
+        search_method_ = method;
+      }
+
+      /** \brief Get the method used to look up the target voxels around each transformed point. */
+      inline NeighborSearchMethod
+      getNeighborSearchMethod () const
+      {
+        return (search_method_);
+      }
+
+      /** \brief Set the number of threads used to compute the score derivatives.
+        * \note The derivatives are summed in the same order for any number of threads, so the result
+        * does not depend on it.
+        * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+        */
+      void
+      setNumberOfThreads (unsigned int nr_threads = 0);
+
+      /** \brief Get the number of threads used to compute the score derivatives. */
+      inline unsigned int
+      getNumberOfThreads () const
+      {
+        return (threads_);
+      }
+
       /** \brief Get the registration alignment probability.
         * \return transformation probability
         */
@@ -288,6 +328,24 @@ namespace pcl
                          Eigen::Vector3d &x_trans, Eigen::Matrix3d &c_inv,
                          bool compute_hessian = true);
 
+      /** \brief Compute individual point contirbutions to derivatives of probability function w.r.t. the transformation vector.
+        * \note Equation 6.10, 6.12 and 6.13 [Magnusson 2009].
+        * \param[in,out] score_gradient the gradient vector of the probability function w.r.t. the transformation vector
+        * \param[in,out] hessian the hessian matrix of the probability function w.r.t. the transformation vector
+        * \param[in] point_gradient the first order derivative of the transformation of the point, see \ref computePointDerivatives
+        * \param[in] point_hessian the second order derivative of the transformation of the point, see \ref computePointDerivatives
+        * \param[in] x_trans transformed point minus mean of occupied covariance voxel
+        * \param[in] c_inv covariance of occupied covariance voxel
+        * \param[in] compute_hessian flag to calculate hessian, unnessissary for step calculation.
+        */
+      double
+      updateDerivatives (Eigen::Matrix<double, 6, 1> &score_gradient,
+                         Eigen::Matrix<double, 6, 6> &hessian,
+                         const Eigen::Matrix<double, 3, 6> &point_gradient,
+                         const Eigen::Matrix<double, 18, 6> &point_hessian,
+                         const Eigen::Vector3d &x_trans, const Eigen::Matrix3d &c_inv,
+                         bool compute_hessian = true) const;
+
       /** \brief Precompute anglular components of derivatives.
         * \note Equation 6.19 and 6.21 [Magnusson 2009].
         * \param[in] p the current transform vector
@@ -304,6 +362,19 @@ namespace pcl
       void
       computePointDerivatives (Eigen::Vector3d &x, bool compute_hessian = true);
 
+      /** \brief Compute point derivatives.
+        * \note Equation 6.18-21 [Magnusson 2009].
+        * \param[in] x point from the input cloud
+        * \param[in,out] point_gradient the first order derivative of the transformation of the point, \f$ J_E \f$ in Equation 6.18 [Magnusson 2009]
+        * \param[in,out] point_hessian the second order derivative of the transformation of the point, \f$ H_E \f$ in Equation 6.20 [Magnusson 2009]
+        * \param[in] compute_hessian flag to calculate hessian, unnessissary for step calculation.
+        */
+      void
+      computePointDerivatives (const Eigen::Vector3d &x,
+                               Eigen::Matrix<double, 3, 6> &point_gradient,
+                               Eigen::Matrix<double, 18, 6> &point_hessian,
+                               bool compute_hessian = true) const;
+
       /** \brief Compute hessian of probability function w.r.t. the transformation vector.
         * \note Equation 6.13 [Magnusson 2009].
         * \param[out] hessian the hessian matrix of the probability function w.r.t. the transformation vector
@@ -325,6 +396,64 @@ namespace pcl
       updateHessian (Eigen::Matrix<double, 6, 6> &hessian,
                      Eigen::Vector3d &x_trans, Eigen::Matrix3d &c_inv);
 
+      /** \brief Compute individual point contirbutions to hessian of probability function w.r.t. the transformation vector.
+        * \note Equation 6.13 [Magnusson 2009].
+        * \param[in,out] hessian the hessian matrix of the probability function w.r.t. the transformation vector
+        * \param[in] point_gradient the first order derivative of the transformation of the point, see \ref computePointDerivatives
+        * \param[in] point_hessian the second order derivative of the transformation of the point, see \ref computePointDerivatives
+        * \param[in] x_trans transformed point minus mean of occupied covariance voxel
+        * \param[in] c_inv covariance of occupied covariance voxel
+        */
+      void
+      updateHessian (Eigen::Matrix<double, 6, 6> &hessian,
+                     const Eigen::Matrix<double, 3, 6> &point_gradient,
+                     const Eigen::Matrix<double, 18, 6> &point_hessian,
+                     const Eigen::Vector3d &x_trans, const Eigen::Matrix3d &c_inv) const;
+
+      /** \brief Add the hessian contribution of a point w.r.t. one occupied voxel, Equation 6.13 [Magnusson 2009].
+        * \param[in,out] hessian the hessian matrix of the probability function w.r.t. the transformation vector
+        * \param[in] point_gradient the first order derivative of the transformation of the point
+        * \param[in] point_hessian the second order derivative of the transformation of the point
+        * \param[in] x_trans transformed point minus mean of occupied covariance voxel
+        * \param[in] c_inv covariance of occupied covariance voxel
+        * \param[in] cov_dxd_p c_inv times point_gradient
+        * \param[in] x_cov_dxd_p x_trans times cov_dxd_p
+        * \param[in] e_x_cov_x the scaled exponential of Equation 6.9
+        */
+      void
+      addHessianContribution (Eigen::Matrix<double, 6, 6> &hessian,
+                              const Eigen::Matrix<double, 3, 6> &point_gradient,
+                              const Eigen::Matrix<double, 18, 6> &point_hessian,
+                              const Eigen::Vector3d &x_trans, const Eigen::Matrix3d &c_inv,
+                              const Eigen::Matrix<double, 3, 6> &cov_dxd_p,
+                              const Eigen::Matrix<double, 6, 1> &x_cov_dxd_p,
+                              double e_x_cov_x) const;
+
+      /** \brief Find the occupied target voxels contributing to the score of a transformed point.
+        * \param[in] x_trans_pt transformed point
+        * \param[out] neighborhood the occupied voxels around the point, according to \ref search_method_
+        * \param[out] distances buffer used by the kd-tree search
+        * \return number of voxels found
+        */
+      int
+      getNeighborhood (const PointSource &x_trans_pt,
+                       std::vector<TargetGridLeafConstPtr> &neighborhood,
+                       std::vector<float> &distances) const;
+
+      /** \brief Sum the contributions of all points, split in fixed blocks computed in parallel.
+        * \param[out] score_gradient the gradient vector of the probability function w.r.t. the transformation vector
+        * \param[out] hessian the hessian matrix of the probability function w.r.t. the transformation vector
+        * \param[in] trans_cloud transformed point cloud
+        * \param[in] compute_score flag to calculate the score and gradient, false when only the hessian is needed
+        * \param[in] compute_hessian flag to calculate hessian
+        * \return the score
+        */
+      double
+      accumulateDerivatives (Eigen::Matrix<double, 6, 1> &score_gradient,
+                             Eigen::Matrix<double, 6, 6> &hessian,
+                             const PointCloudSource &trans_cloud,
+                             bool compute_score, bool compute_hessian);
+
       /** \brief Compute line search step length and update transform and probability derivatives using More-Thuente method.
         * \note Search Algorithm [More, Thuente 1994]
         * \param[in] x initial transformation vector, \f$ x \f$ in Equation 1.3 (Moore, Thuente 1994) and \f$ \vec{p} \f$ in Algorithm 2 [Magnusson 2009]
@@ -419,6 +548,12 @@ namespace pcl
       /** \brief The voxel grid generated from target cloud containing point means and covariances. */
       TargetGrid target_cells_;
 
+      /** \brief The method used to find the target voxels around each transformed point. */
+      NeighborSearchMethod search_method_;
+
+      /** \brief The number of threads the scheduler should use. */
+      unsigned int threads_;
+
       //double fitness_epsilon_;
 
       /** \brief The side length of voxels. */
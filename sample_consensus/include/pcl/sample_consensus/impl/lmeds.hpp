@@ -42,6 +42,7 @@
 #define PCL_SAMPLE_CONSENSUS_IMPL_LMEDS_H_
 
 #include <pcl/sample_consensus/lmeds.h>
+#include <pcl/sample_consensus/sprt.h>
 
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
@@ -64,7 +65,11 @@ pcl::LeastMedianSquares<PointT>::computeModel (int debug_verbosity_level)
   unsigned skipped_count = 0;
   // suppress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
   const unsigned max_skip = max_iterations_ * 10;
-  
+
+  // Pre-verification of the hypotheses on random points, disabled with 0 points
+  SampleConsensusSPRT sprt (use_sprt_ ? sac_model_->getIndices ()->size () : 0);
+  std::minstd_rand sprt_rng (use_sprt_ ? static_cast<unsigned> (rng_->base () ()) : 0u);
+
   // Iterate
   while ((iterations_ < max_iterations_) && (skipped_count < max_skip))
   {
@@ -84,6 +89,18 @@ pcl::LeastMedianSquares<PointT>::computeModel (int debug_verbosity_level)
       continue;
     }
 
+    // Skip the hypotheses which the pre-verification on a few random points rejects
+    if (use_sprt_)
+    {
+      const SampleConsensusSPRT::Result pre_verification = sprt.verify (*sac_model_, model_coefficients, threshold_, sprt_rng);
+      if (pre_verification.rejected)
+      {
+        sprt.addRejected (pre_verification);
+        ++iterations_;
+        continue;
+      }
+    }
+
     double d_cur_penalty;
     // d_cur_penalty = sum (min (dist, threshold))
 
@@ -136,6 +153,13 @@ pcl::LeastMedianSquares<PointT>::computeModel (int debug_verbosity_level)
       // Save the current model/coefficients selection as being the best so far
       model_              = selection;
       model_coefficients_ = model_coefficients;
+
+      // The pre-verification takes the inlier ratio of the best model as the one of the good hypotheses
+      if (use_sprt_)
+      {
+        const auto nr_inliers = std::count_if (distances.begin (), new_end, [this] (double distance) { return (distance <= threshold_); });
+        sprt.setInlierRatio (static_cast<double> (nr_inliers) / static_cast<double> (nr_valid_dists));
+      }
     }
 
     ++iterations_;
@@ -0,0 +1,215 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SAMPLE_CONSENSUS_IMPL_LO_RANSAC_H_
+#define PCL_SAMPLE_CONSENSUS_IMPL_LO_RANSAC_H_
+
+#include <pcl/sample_consensus/lo_ransac.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::LocallyOptimizedSampleConsensus<PointT>::computeModel (int)
+{
+  // Warn and exit if no threshold was set
+  if (threshold_ == std::numeric_limits<double>::max())
+  {
+    PCL_ERROR ("[pcl::LocallyOptimizedSampleConsensus::computeModel] No threshold set!\n");
+    return (false);
+  }
+
+  iterations_ = 0;
+  std::size_t n_best_inliers_count = 0;
+  double k = std::numeric_limits<double>::max();
+
+  const double log_probability  = std::log (1.0 - probability_);
+  const double one_over_indices = 1.0 / static_cast<double> (sac_model_->getIndices ()->size ());
+
+  unsigned skipped_count = 0;
+
+  // suppress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
+  const unsigned max_skip = max_iterations_ * 10;
+
+  int threads = threads_;
+  if (threads >= 0)
+  {
+#ifdef _OPENMP
+    if (threads == 0)
+    {
+      threads = omp_get_num_procs();
+      PCL_DEBUG ("[pcl::LocallyOptimizedSampleConsensus::computeModel] Automatic number of threads requested, choosing %i threads.\n", threads);
+    }
+#else
+    // Parallelization desired, but not available
+    PCL_WARN ("[pcl::LocallyOptimizedSampleConsensus::computeModel] Parallelization is requested, but OpenMP is not available! Continuing without parallelization.\n");
+    threads = -1;
+#endif
+  }
+
+  // The hypotheses of a batch, a count of invalid_count marks the samples which do not give a valid model
+  const std::size_t invalid_count = std::numeric_limits<std::size_t>::max ();
+  std::vector<Indices> samples (batch_size_);
+  std::vector<Eigen::VectorXf> coefficients (batch_size_);
+  std::vector<std::size_t> counts (batch_size_);
+
+  // Iterate
+  while (iterations_ < k && iterations_ < max_iterations_ && skipped_count < max_skip)
+  {
+    // Get X samples which satisfy the model criteria. The random number generator used when choosing the samples
+    // should not be called in parallel, and drawing them in order keeps the result independent of the threads
+    int nr_samples = 0;
+    const int batch_size = (std::min) (static_cast<int> (batch_size_), max_iterations_ - iterations_);
+    for (; nr_samples < batch_size; ++nr_samples)
+    {
+      sac_model_->getSamples (iterations_, samples[nr_samples]);
+      if (samples[nr_samples].empty ())
+        break;
+    }
+
+    if (nr_samples == 0)
+    {
+      PCL_ERROR ("[pcl::LocallyOptimizedSampleConsensus::computeModel] No samples could be selected!\n");
+      break;
+    }
+
+    // Search for inliers in the point cloud for the models of the batch. Most work is done here
+#pragma omp parallel for \
+  default(none) \
+  shared(samples, coefficients, counts) \
+  firstprivate(nr_samples, invalid_count) \
+  schedule(dynamic, 1) \
+  num_threads(threads) \
+  if(threads > 0)
+    for (int i = 0; i < nr_samples; ++i)
+    {
+      if (sac_model_->computeModelCoefficients (samples[i], coefficients[i])) // This function has to be thread-safe
+        counts[i] = sac_model_->countWithinDistance (coefficients[i], threshold_); // This function has to be thread-safe
+      else
+        counts[i] = invalid_count;
+    }
+
+    // Pick the best hypothesis of the batch, the first one on ties
+    int best = -1;
+    for (int i = 0; i < nr_samples; ++i)
+    {
+      if (counts[i] == invalid_count)
+      {
+        ++skipped_count;
+        continue;
+      }
+      ++iterations_;
+      if (counts[i] > n_best_inliers_count && (best < 0 || counts[i] > counts[best]))
+        best = i;
+    }
+
+    // Better match ?
+    if (best >= 0)
+    {
+      // Save the current model/inlier/coefficients selection as being the best so far
+      n_best_inliers_count = counts[best];
+      model_              = samples[best];
+      model_coefficients_ = coefficients[best];
+
+      // Refine the new best model, the refined model keeps the sample of the hypothesis it grew from
+      if (optimizeLocally (model_coefficients_, n_best_inliers_count))
+        PCL_DEBUG ("[pcl::LocallyOptimizedSampleConsensus::computeModel] Local optimization increased the inliers from %lu to %lu.\n", counts[best], n_best_inliers_count);
+
+      // Compute the k parameter (k=std::log(z)/std::log(1-w^n))
+      const double w = static_cast<double> (n_best_inliers_count) * one_over_indices;
+      double p_no_outliers = 1.0 - std::pow (w, static_cast<double> (model_.size ()));
+      p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
+      p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
+      k = log_probability / std::log (p_no_outliers);
+    }
+
+    PCL_DEBUG ("[pcl::LocallyOptimizedSampleConsensus::computeModel] Trial %d out of %f: %lu inliers so far.\n", iterations_, k, n_best_inliers_count);
+  }
+
+  if (iterations_ >= max_iterations_)
+    PCL_DEBUG ("[pcl::LocallyOptimizedSampleConsensus::computeModel] LO-RANSAC reached the maximum number of trials.\n");
+
+  PCL_DEBUG ("[pcl::LocallyOptimizedSampleConsensus::computeModel] Model: %lu size, %lu inliers.\n", model_.size (), n_best_inliers_count);
+
+  if (model_.empty ())
+  {
+    PCL_ERROR ("[pcl::LocallyOptimizedSampleConsensus::computeModel] LO-RANSAC found no model.\n");
+    inliers_.clear ();
+    return (false);
+  }
+
+  // Get the set of inliers that correspond to the best model found so far
+  sac_model_->selectWithinDistance (model_coefficients_, threshold_, inliers_);
+  return (true);
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::LocallyOptimizedSampleConsensus<PointT>::optimizeLocally (Eigen::VectorXf &model_coefficients,
+                                                               std::size_t &n_inliers_count) const
+{
+  bool improved = false;
+  Indices inliers;
+  Eigen::VectorXf current_coefficients = model_coefficients, optimized_coefficients;
+  for (unsigned int i = 0; i < lo_iterations_; ++i)
+  {
+    // Shrink the inlier threshold linearly from threshold_multiplier_ * threshold_ down to threshold_
+    const double step = lo_iterations_ > 1 ? static_cast<double> (i) / static_cast<double> (lo_iterations_ - 1) : 1.0;
+    const double threshold = threshold_ * (threshold_multiplier_ - (threshold_multiplier_ - 1.0) * step);
+
+    sac_model_->selectWithinDistance (current_coefficients, threshold, inliers);
+    // Need more than the minimum sample size to make a difference
+    if (inliers.size () <= sac_model_->getSampleSize ())
+      break;
+
+    sac_model_->optimizeModelCoefficients (inliers, current_coefficients, optimized_coefficients);
+    const std::size_t count = sac_model_->countWithinDistance (optimized_coefficients, threshold_);
+    if (count > n_inliers_count)
+    {
+      n_inliers_count    = count;
+      model_coefficients = optimized_coefficients;
+      improved = true;
+    }
+    current_coefficients = optimized_coefficients;
+  }
+  return (improved);
+}
+
+#define PCL_INSTANTIATE_LocallyOptimizedSampleConsensus(T) template class PCL_EXPORTS pcl::LocallyOptimizedSampleConsensus<T>;
+
+#endif    // PCL_SAMPLE_CONSENSUS_IMPL_LO_RANSAC_H_
@@ -42,6 +42,7 @@
 #define PCL_SAMPLE_CONSENSUS_IMPL_MSAC_H_
 
 #include <pcl/sample_consensus/msac.h>
+#include <pcl/sample_consensus/sprt.h>
 
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
@@ -66,7 +67,11 @@ pcl::MEstimatorSampleConsensus<PointT>::computeModel (int debug_verbosity_level)
   unsigned skipped_count = 0;
   // suppress infinite loops by just allowing 10 x maximum allowed iterations for invalid model parameters!
   const unsigned max_skip = max_iterations_ * 10;
-  
+
+  // Pre-verification of the hypotheses on random points, disabled with 0 points
+  SampleConsensusSPRT sprt (use_sprt_ ? sac_model_->getIndices ()->size () : 0);
+  std::minstd_rand sprt_rng (use_sprt_ ? static_cast<unsigned> (rng_->base () ()) : 0u);
+
   // Iterate
   while (iterations_ < k && skipped_count < max_skip)
   {
@@ -83,6 +88,20 @@ pcl::MEstimatorSampleConsensus<PointT>::computeModel (int debug_verbosity_level)
       continue;
      }
 
+    // Skip the hypotheses which the pre-verification on a few random points rejects
+    if (use_sprt_)
+    {
+      const SampleConsensusSPRT::Result pre_verification = sprt.verify (*sac_model_, model_coefficients, threshold_, sprt_rng);
+      if (pre_verification.rejected)
+      {
+        sprt.addRejected (pre_verification);
+        ++iterations_;
+        if (iterations_ > max_iterations_)
+          break;
+        continue;
+      }
+    }
+
     double d_cur_penalty = 0;
     // Iterate through the 3d points and calculate the distances from them to the model
     sac_model_->getDistancesToModel (model_coefficients, distances);
@@ -108,9 +127,13 @@ pcl::MEstimatorSampleConsensus<PointT>::computeModel (int debug_verbosity_level)
         if (distance <= threshold_)
           ++n_inliers_count;
 
-      // Compute the k parameter (k=std::log(z)/std::log(1-w^n))
       double w = static_cast<double> (n_inliers_count) / static_cast<double> (sac_model_->getIndices ()->size ());
-      double p_no_outliers = 1.0 - std::pow (w, static_cast<double> (selection.size ()));
+      if (use_sprt_)
+        sprt.setInlierRatio (w);
+
+      // Compute the k parameter (k=std::log(z)/std::log(1-w^n)), without the good samples which the
+      // pre-verification rejects
+      double p_no_outliers = 1.0 - std::pow (w, static_cast<double> (selection.size ())) * (1.0 - sprt.getFalseRejectionProbability ());
       p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
       p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
       k = std::log (1.0 - probability_) / std::log (p_no_outliers);
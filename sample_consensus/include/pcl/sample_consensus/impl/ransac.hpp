@@ -42,6 +42,7 @@
 #define PCL_SAMPLE_CONSENSUS_IMPL_RANSAC_H_
 
 #include <pcl/sample_consensus/ransac.h>
+#include <pcl/sample_consensus/sprt.h>
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -95,6 +96,10 @@ pcl::RandomSampleConsensus<PointT>::computeModel (int)
 #endif
   }
 
+  // Pre-verification of the hypotheses on random points, disabled with 0 points
+  SampleConsensusSPRT sprt (use_sprt_ ? sac_model_->getIndices ()->size () : 0);
+  const unsigned sprt_seed = use_sprt_ ? static_cast<unsigned> (rng_->base () ()) : 0u;
+
 #if OPENMP_AVAILABLE_RANSAC
 #pragma omp parallel if(threads > 0) num_threads(threads) shared(k, skipped_count, n_best_inliers_count) private(selection, model_coefficients, n_inliers_count) // would be nice to have a default(none)-clause here, but then some compilers complain about the shared const variables
 #endif
@@ -107,6 +112,13 @@ pcl::RandomSampleConsensus<PointT>::computeModel (int)
 #endif
       PCL_DEBUG ("[pcl::RandomSampleConsensus::computeModel] Computing not parallel.\n");
 
+    // Each thread draws its own random points for the pre-verification
+#if OPENMP_AVAILABLE_RANSAC
+    std::minstd_rand sprt_rng (sprt_seed + omp_get_thread_num ());
+#else
+    std::minstd_rand sprt_rng (sprt_seed);
+#endif
+
     // Iterate
     while (true) // infinite loop with four possible breaks
     {
@@ -144,7 +156,27 @@ pcl::RandomSampleConsensus<PointT>::computeModel (int)
       //if (inliers.empty () && k > 1.0)
       //  continue;
 
-      n_inliers_count = sac_model_->countWithinDistance (model_coefficients, threshold_); // This functions has to be thread-safe. Most work is done here
+      // Skip the hypotheses which the pre-verification on a few random points rejects
+      bool rejected = false;
+      if (use_sprt_)
+      {
+        SampleConsensusSPRT test;
+#if OPENMP_AVAILABLE_RANSAC
+#pragma omp critical(sprt)
+#endif
+        test = sprt;
+        const SampleConsensusSPRT::Result pre_verification = test.verify (*sac_model_, model_coefficients, threshold_, sprt_rng);
+        if (pre_verification.rejected)
+        {
+#if OPENMP_AVAILABLE_RANSAC
+#pragma omp critical(sprt)
+#endif
+          sprt.addRejected (pre_verification);
+          rejected = true;
+        }
+      }
+
+      n_inliers_count = rejected ? 0 : sac_model_->countWithinDistance (model_coefficients, threshold_); // This functions has to be thread-safe. Most work is done here
 
       std::size_t n_best_inliers_count_tmp;
 #if OPENMP_AVAILABLE_RANSAC
@@ -168,9 +200,22 @@ pcl::RandomSampleConsensus<PointT>::computeModel (int)
             model_              = selection;
             model_coefficients_ = model_coefficients;
 
-            // Compute the k parameter (k=std::log(z)/std::log(1-w^n))
             const double w = static_cast<double> (n_best_inliers_count) * one_over_indices;
-            double p_no_outliers = 1.0 - std::pow (w, static_cast<double> (selection.size ()));
+            double false_rejection = 0.0;
+            if (use_sprt_)
+            {
+#if OPENMP_AVAILABLE_RANSAC
+#pragma omp critical(sprt)
+#endif
+              {
+                sprt.setInlierRatio (w);
+                false_rejection = sprt.getFalseRejectionProbability ();
+              }
+            }
+
+            // Compute the k parameter (k=std::log(z)/std::log(1-w^n)), without the good samples which the
+            // pre-verification rejects
+            double p_no_outliers = 1.0 - std::pow (w, static_cast<double> (selection.size ())) * (1.0 - false_rejection);
             p_no_outliers = (std::max) (std::numeric_limits<double>::epsilon (), p_no_outliers);       // Avoid division by -Inf
             p_no_outliers = (std::min) (1.0 - std::numeric_limits<double>::epsilon (), p_no_outliers);   // Avoid division by 0.
             k = log_probability / std::log (p_no_outliers);
@@ -43,6 +43,7 @@
 
 #include <pcl/sample_consensus/eigen.h>
 #include <pcl/sample_consensus/sac_model_circle.h>
+#include <pcl/sample_consensus/sac_model_kernels.h>
 #include <pcl/common/concatenate.h>
 
 //////////////////////////////////////////////////////////////////////////
@@ -176,24 +177,11 @@ pcl::SampleConsensusModelCircle2D<PointT>::countWithinDistance (
   // Check if the model is valid given the user constraints
   if (!isModelValid (model_coefficients))
     return (0);
-  std::size_t nr_p = 0;
 
-  // Iterate through the 3d points and calculate the distances from them to the circle
-  for (std::size_t i = 0; i < indices_->size (); ++i)
-  {
-    // Calculate the distance from the point to the circle as the difference between
-    // dist(point,circle_origin) and circle_radius
-    float distance = std::abs (std::sqrt (
-                                      ( input_->points[(*indices_)[i]].x - model_coefficients[0] ) *
-                                      ( input_->points[(*indices_)[i]].x - model_coefficients[0] ) +
-
-                                      ( input_->points[(*indices_)[i]].y - model_coefficients[1] ) *
-                                      ( input_->points[(*indices_)[i]].y - model_coefficients[1] )
-                                      ) - model_coefficients[2]);
-    if (distance < threshold)
-      nr_p++;
-  }
-  return (nr_p);
+  // Calculate the distances from the 3d points to the circle as the difference between
+  // dist(point,circle_origin) and circle_radius, several points at a time
+  return (pcl::detail::countWithinCircleDistance (pcl::detail::makeSacPoints (*input_, *indices_),
+                                                  model_coefficients.template head<3> (), threshold));
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -294,6 +282,19 @@ pcl::SampleConsensusModelCircle2D<PointT>::projectPoints (
   }
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::SampleConsensusModelCircle2D<PointT>::countSamplesWithinDistance (
+      const Indices &samples, const Eigen::VectorXf &model_coefficients, const double threshold) const
+{
+  // Check if the model is valid given the user constraints
+  if (!isModelValid (model_coefficients))
+    return (0);
+
+  return (pcl::detail::countWithinCircleDistance (pcl::detail::makeSacPoints (*input_, samples),
+                                                  model_coefficients.template head<3> (), threshold));
+}
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
 pcl::SampleConsensusModelCircle2D<PointT>::doSamplesVerifyModel (
@@ -42,6 +42,7 @@
 #define PCL_SAMPLE_CONSENSUS_IMPL_SAC_MODEL_LINE_H_
 
 #include <pcl/sample_consensus/sac_model_line.h>
+#include <pcl/sample_consensus/sac_model_kernels.h>
 #include <pcl/common/centroid.h>
 #include <pcl/common/concatenate.h>
 
@@ -176,24 +177,15 @@ pcl::SampleConsensusModelLine<PointT>::countWithinDistance (
 
   double sqr_threshold = threshold * threshold;
 
-  std::size_t nr_p = 0;
-
   // Obtain the line point and direction
   Eigen::Vector4f line_pt  (model_coefficients[0], model_coefficients[1], model_coefficients[2], 0.0f);
   Eigen::Vector4f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5], 0.0f);
   line_dir.normalize ();
 
-  // Iterate through the 3d points and calculate the distances from them to the line
-  for (std::size_t i = 0; i < indices_->size (); ++i)
-  {
-    // Calculate the distance from the point to the line
-    // D = ||(P2-P1) x (P1-P0)|| / ||P2-P1|| = norm (cross (p2-p1, p2-p0)) / norm(p2-p1)
-    double sqr_distance = (line_pt - input_->points[(*indices_)[i]].getVector4fMap ()).cross3 (line_dir).squaredNorm ();
-
-    if (sqr_distance < sqr_threshold)
-      nr_p++;
-  }
-  return (nr_p);
+  // Calculate the distances from the 3d points to the line, several points at a time
+  // D = ||(P2-P1) x (P1-P0)|| / ||P2-P1|| = norm (cross (p2-p1, p2-p0)) / norm(p2-p1)
+  return (pcl::detail::countWithinLineDistance (pcl::detail::makeSacPoints (*input_, *indices_),
+                                                line_pt.head<3> (), line_dir.head<3> (), sqr_threshold));
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -310,6 +302,22 @@ pcl::SampleConsensusModelLine<PointT>::projectPoints (
   }
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::SampleConsensusModelLine<PointT>::countSamplesWithinDistance (
+      const Indices &samples, const Eigen::VectorXf &model_coefficients, const double threshold) const
+{
+  // Check if the model is valid given the user constraints
+  if (!isModelValid (model_coefficients))
+    return (0);
+
+  Eigen::Vector4f line_dir (model_coefficients[3], model_coefficients[4], model_coefficients[5], 0.0f);
+  line_dir.normalize ();
+  return (pcl::detail::countWithinLineDistance (pcl::detail::makeSacPoints (*input_, samples),
+                                                model_coefficients.template head<3> (), line_dir.head<3> (),
+                                                threshold * threshold));
+}
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
 pcl::SampleConsensusModelLine<PointT>::doSamplesVerifyModel (
@@ -110,8 +110,16 @@ pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::countWithinDistance (
     return (0);
   }
 
+  return (countSamplesWithinDistance (*indices_, model_coefficients, threshold));
+}
+
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename PointNT> std::size_t
+pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::countSamplesWithinDistance (
+      const Indices &samples, const Eigen::VectorXf &model_coefficients, const double threshold) const
+{
   // Check if the model is valid given the user constraints
-  if (!isModelValid (model_coefficients))
+  if (!normals_ || !isModelValid (model_coefficients))
     return (0);
 
   // Obtain the plane normal
@@ -121,10 +129,10 @@ pcl::SampleConsensusModelNormalPlane<PointT, PointNT>::countWithinDistance (
   std::size_t nr_p = 0;
 
   // Iterate through the 3d points and calculate the distances from them to the plane
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  for (const auto &index : samples)
   {
-    const PointT  &pt = input_->points[(*indices_)[i]];
-    const PointNT &nt = normals_->points[(*indices_)[i]];
+    const PointT  &pt = input_->points[index];
+    const PointNT &nt = normals_->points[index];
     // Calculate the distance from the point to the plane normal as the dot product
     // D = (P-A).N/|N|
     Eigen::Vector4f p (pt.x, pt.y, pt.z, 0.0f);
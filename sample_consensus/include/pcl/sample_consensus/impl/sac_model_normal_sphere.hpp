@@ -114,10 +114,17 @@ pcl::SampleConsensusModelNormalSphere<PointT, PointNT>::countWithinDistance (
     return (0);
   }
 
-  // Check if the model is valid given the user constraints
-  if (!isModelValid (model_coefficients))
-    return(0);
+  return (countSamplesWithinDistance (*indices_, model_coefficients, threshold));
+}
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT, typename PointNT> std::size_t
+pcl::SampleConsensusModelNormalSphere<PointT, PointNT>::countSamplesWithinDistance (
+      const Indices &samples, const Eigen::VectorXf &model_coefficients, const double threshold) const
+{
+  // Check if the model is valid given the user constraints
+  if (!normals_ || !isModelValid (model_coefficients))
+    return (0);
 
   // Obtain the sphere centroid
   Eigen::Vector4f center = model_coefficients;
@@ -126,18 +133,18 @@ pcl::SampleConsensusModelNormalSphere<PointT, PointNT>::countWithinDistance (
   std::size_t nr_p = 0;
 
   // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (std::size_t i = 0; i < indices_->size (); ++i)
+  for (const auto &index : samples)
   {
     // Calculate the distance from the point to the sphere centroid as the difference between
     // dist(point,sphere_origin) and sphere_radius
-    Eigen::Vector4f p (input_->points[(*indices_)[i]].x, 
-                       input_->points[(*indices_)[i]].y, 
-                       input_->points[(*indices_)[i]].z, 
+    Eigen::Vector4f p (input_->points[index].x, 
+                       input_->points[index].y, 
+                       input_->points[index].z, 
                        0.0f);
 
-    Eigen::Vector4f n (normals_->points[(*indices_)[i]].normal[0], 
-                       normals_->points[(*indices_)[i]].normal[1], 
-                       normals_->points[(*indices_)[i]].normal[2], 
+    Eigen::Vector4f n (normals_->points[index].normal[0], 
+                       normals_->points[index].normal[1], 
+                       normals_->points[index].normal[2], 
                        0.0f);
 
     Eigen::Vector4f n_dir = (p-center);
@@ -42,6 +42,7 @@
 #define PCL_SAMPLE_CONSENSUS_IMPL_SAC_MODEL_PLANE_H_
 
 #include <pcl/sample_consensus/sac_model_plane.h>
+#include <pcl/sample_consensus/sac_model_kernels.h>
 #include <pcl/common/centroid.h>
 #include <pcl/common/eigen.h>
 #include <pcl/common/concatenate.h>
@@ -192,23 +193,10 @@ pcl::SampleConsensusModelPlane<PointT>::countWithinDistance (
     return (0);
   }
 
-  std::size_t nr_p = 0;
-
-  // Iterate through the 3d points and calculate the distances from them to the plane
-  for (std::size_t i = 0; i < indices_->size (); ++i)
-  {
-    // Calculate the distance from the point to the plane normal as the dot product
-    // D = (P-A).N/|N|
-    Eigen::Vector4f pt (input_->points[(*indices_)[i]].x,
-                        input_->points[(*indices_)[i]].y,
-                        input_->points[(*indices_)[i]].z,
-                        1.0f);
-    if (std::abs (model_coefficients.dot (pt)) < threshold)
-    {
-      nr_p++;
-    }
-  }
-  return (nr_p);
+  // Calculate the distances from the 3d points to the plane as the dot product D = (P-A).N/|N|,
+  // several points at a time with the widest instruction set supported by the CPU
+  return (pcl::detail::countWithinPlaneDistance (pcl::detail::makeSacPoints (*input_, *indices_),
+                                                 model_coefficients.template head<4> (), threshold));
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -346,6 +334,19 @@ pcl::SampleConsensusModelPlane<PointT>::projectPoints (
   }
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::SampleConsensusModelPlane<PointT>::countSamplesWithinDistance (
+      const Indices &samples, const Eigen::VectorXf &model_coefficients, const double threshold) const
+{
+  // Check if the model is valid given the user constraints
+  if (!isModelValid (model_coefficients))
+    return (0);
+
+  return (pcl::detail::countWithinPlaneDistance (pcl::detail::makeSacPoints (*input_, samples),
+                                                 model_coefficients.template head<4> (), threshold));
+}
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
 pcl::SampleConsensusModelPlane<PointT>::doSamplesVerifyModel (
@@ -242,6 +242,44 @@ pcl::SampleConsensusModelRegistration<PointT>::countWithinDistance (
   return (nr_p);
 } 
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::SampleConsensusModelRegistration<PointT>::countSamplesWithinDistance (
+    const Indices &samples, const Eigen::VectorXf &model_coefficients, const double threshold) const
+{
+  // Check if the model is valid given the user constraints
+  if (!target_ || !isModelValid (model_coefficients))
+    return (0);
+
+  Eigen::Matrix4f transform;
+  transform.row (0).matrix () = model_coefficients.segment<4>(0);
+  transform.row (1).matrix () = model_coefficients.segment<4>(4);
+  transform.row (2).matrix () = model_coefficients.segment<4>(8);
+  transform.row (3).matrix () = model_coefficients.segment<4>(12);
+
+  const double thresh = threshold * threshold;
+  std::size_t nr_p = 0;
+  for (const auto &index : samples)
+  {
+    // The samples are source indices, matched to their target point as in computeModelCoefficients
+    const auto correspondence = correspondences_.find (index);
+    if (correspondence == correspondences_.end ())
+      continue;
+    Eigen::Vector4f pt_src (input_->points[index].x,
+                            input_->points[index].y,
+                            input_->points[index].z, 1);
+    Eigen::Vector4f pt_tgt (target_->points[correspondence->second].x,
+                            target_->points[correspondence->second].y,
+                            target_->points[correspondence->second].z, 1);
+
+    Eigen::Vector4f p_tr (transform * pt_src);
+    // Calculate the distance from the transformed point to its correspondence
+    if ((p_tr - pt_tgt).squaredNorm () < thresh)
+      nr_p++;
+  }
+  return (nr_p);
+}
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::SampleConsensusModelRegistration<PointT>::optimizeModelCoefficients (const Indices &inliers, const Eigen::VectorXf &model_coefficients, Eigen::VectorXf &optimized_coefficients) const
@@ -43,6 +43,7 @@
 
 #include <pcl/sample_consensus/eigen.h>
 #include <pcl/sample_consensus/sac_model_sphere.h>
+#include <pcl/sample_consensus/sac_model_kernels.h>
 
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
@@ -207,26 +208,10 @@ pcl::SampleConsensusModelSphere<PointT>::countWithinDistance (
   if (!isModelValid (model_coefficients))
     return (0);
 
-  std::size_t nr_p = 0;
-
-  // Iterate through the 3d points and calculate the distances from them to the sphere
-  for (std::size_t i = 0; i < indices_->size (); ++i)
-  {
-    // Calculate the distance from the point to the sphere as the difference between
-    // dist(point,sphere_origin) and sphere_radius
-    if (std::abs (std::sqrt (
-                        ( input_->points[(*indices_)[i]].x - model_coefficients[0] ) *
-                        ( input_->points[(*indices_)[i]].x - model_coefficients[0] ) +
-
-                        ( input_->points[(*indices_)[i]].y - model_coefficients[1] ) *
-                        ( input_->points[(*indices_)[i]].y - model_coefficients[1] ) +
-
-                        ( input_->points[(*indices_)[i]].z - model_coefficients[2] ) *
-                        ( input_->points[(*indices_)[i]].z - model_coefficients[2] )
-                        ) - model_coefficients[3]) < threshold)
-      nr_p++;
-  }
-  return (nr_p);
+  // Calculate the distances from the 3d points to the sphere as the difference between
+  // dist(point,sphere_origin) and sphere_radius, several points at a time
+  return (pcl::detail::countWithinSphereDistance (pcl::detail::makeSacPoints (*input_, *indices_),
+                                                  model_coefficients.template head<4> (), threshold));
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -283,6 +268,19 @@ pcl::SampleConsensusModelSphere<PointT>::projectPoints (
   projected_points.points = input_->points;
 }
 
+//////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::SampleConsensusModelSphere<PointT>::countSamplesWithinDistance (
+      const Indices &samples, const Eigen::VectorXf &model_coefficients, const double threshold) const
+{
+  // Check if the model is valid given the user constraints
+  if (!isModelValid (model_coefficients))
+    return (0);
+
+  return (pcl::detail::countWithinSphereDistance (pcl::detail::makeSacPoints (*input_, samples),
+                                                  model_coefficients.template head<4> (), threshold));
+}
+
 //////////////////////////////////////////////////////////////////////////
 template <typename PointT> bool
 pcl::SampleConsensusModelSphere<PointT>::doSamplesVerifyModel (
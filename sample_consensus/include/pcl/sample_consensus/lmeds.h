@@ -49,6 +49,7 @@ namespace pcl
     * is a RANSAC-like model-fitting algorithm that can tolerate up to 50% outliers without requiring thresholds to be 
     * set. See Andrea Fusiello's "Elements of Geometric Computer Vision"
     * (http://homepages.inf.ed.ac.uk/rbf/CVonline/LOCAL_COPIES/FUSIELLO4/tutorial.html#x1-520007) for more details.
+    * Bad hypotheses can be rejected after a few random points, enable with setUseSPRT.
     * \author Radu B. Rusu
     * \ingroup sample_consensus
     */
@@ -68,6 +69,8 @@ namespace pcl
       using SampleConsensus<PointT>::model_;
       using SampleConsensus<PointT>::model_coefficients_;
       using SampleConsensus<PointT>::inliers_;
+      using SampleConsensus<PointT>::use_sprt_;
+      using SampleConsensus<PointT>::rng_;
 
       /** \brief LMedS (Least Median of Squares) main constructor
         * \param[in] model a Sample Consensus model
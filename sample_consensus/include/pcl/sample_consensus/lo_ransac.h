@@ -0,0 +1,162 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/sample_consensus/sac.h>
+#include <pcl/sample_consensus/sac_model.h>
+
+namespace pcl
+{
+  /** \brief @b LocallyOptimizedSampleConsensus represents an implementation of the LO-RANSAC (Locally Optimized
+    * RANdom SAmple Consensus) algorithm, as described in: "Locally Optimized RANSAC", Ondřej Chum, Jiří Matas and
+    * Josef Kittler, DAGM 2003, and "Fixing the Locally Optimized RANSAC", Karel Lebeda, Jiří Matas and Ondřej Chum,
+    * BMVC 2012.
+    * Every time a hypothesis is better than all the previous ones, it is refined with iterated least squares: the
+    * model is re-estimated from its inliers with a threshold which shrinks from a multiple of the distance threshold
+    * down to the distance threshold, and the refined model is kept if it has more inliers. The better models stop
+    * the iterations much earlier than with RANSAC.
+    * The hypotheses are generated and scored in batches, in parallel if enabled with setNumberOfThreads. The samples
+    * are drawn sequentially and the batches are reduced in order, so the result does not depend on the number of threads.
+    * \ingroup sample_consensus
+    */
+  template <typename PointT>
+  class LocallyOptimizedSampleConsensus : public SampleConsensus<PointT>
+  {
+    using SampleConsensusModelPtr = typename SampleConsensusModel<PointT>::Ptr;
+
+    public:
+      using Ptr = shared_ptr<LocallyOptimizedSampleConsensus<PointT> >;
+      using ConstPtr = shared_ptr<const LocallyOptimizedSampleConsensus<PointT> >;
+
+      using SampleConsensus<PointT>::max_iterations_;
+      using SampleConsensus<PointT>::threshold_;
+      using SampleConsensus<PointT>::iterations_;
+      using SampleConsensus<PointT>::sac_model_;
+      using SampleConsensus<PointT>::model_;
+      using SampleConsensus<PointT>::model_coefficients_;
+      using SampleConsensus<PointT>::inliers_;
+      using SampleConsensus<PointT>::probability_;
+      using SampleConsensus<PointT>::threads_;
+
+      /** \brief LO-RANSAC (Locally Optimized RAndom SAmple Consensus) main constructor
+        * \param[in] model a Sample Consensus model
+        */
+      LocallyOptimizedSampleConsensus (const SampleConsensusModelPtr &model)
+        : SampleConsensus<PointT> (model)
+        , lo_iterations_ (4)
+        , threshold_multiplier_ (3.0)
+        , batch_size_ (16)
+      {
+        // Maximum number of trials before we give up.
+        max_iterations_ = 10000;
+      }
+
+      /** \brief LO-RANSAC (Locally Optimized RAndom SAmple Consensus) main constructor
+        * \param[in] model a Sample Consensus model
+        * \param[in] threshold distance to model threshold
+        */
+      LocallyOptimizedSampleConsensus (const SampleConsensusModelPtr &model, double threshold)
+        : SampleConsensus<PointT> (model, threshold)
+        , lo_iterations_ (4)
+        , threshold_multiplier_ (3.0)
+        , batch_size_ (16)
+      {
+        // Maximum number of trials before we give up.
+        max_iterations_ = 10000;
+      }
+
+      /** \brief Set the number of least squares iterations of the local optimization.
+        * \param[in] lo_iterations the number of iterations (0 disables the local optimization)
+        */
+      inline void
+      setLocalOptimizationIterations (unsigned int lo_iterations) { lo_iterations_ = lo_iterations; }
+
+      /** \brief Get the number of least squares iterations of the local optimization. */
+      inline unsigned int
+      getLocalOptimizationIterations () const { return (lo_iterations_); }
+
+      /** \brief Set the multiple of the distance threshold used to select the inliers in the first iteration of the
+        * local optimization. The threshold shrinks linearly to the distance threshold in the last iteration.
+        * \param[in] threshold_multiplier the multiplier, at least 1 (default: 3)
+        */
+      inline void
+      setThresholdMultiplier (double threshold_multiplier) { threshold_multiplier_ = (std::max) (1.0, threshold_multiplier); }
+
+      /** \brief Get the multiple of the distance threshold used in the first iteration of the local optimization. */
+      inline double
+      getThresholdMultiplier () const { return (threshold_multiplier_); }
+
+      /** \brief Set the number of hypotheses generated and scored together, split among the threads.
+        * \param[in] batch_size the number of hypotheses in a batch (default: 16)
+        */
+      inline void
+      setBatchSize (unsigned int batch_size) { batch_size_ = (std::max) (1u, batch_size); }
+
+      /** \brief Get the number of hypotheses generated and scored together. */
+      inline unsigned int
+      getBatchSize () const { return (batch_size_); }
+
+      /** \brief Compute the actual model and find the inliers
+        * \param[in] debug_verbosity_level enable/disable on-screen debug information and set the verbosity level
+        */
+      bool
+      computeModel (int debug_verbosity_level = 0) override;
+
+    protected:
+      /** \brief Refine a model with iterated least squares on its inliers.
+        * \param[in,out] model_coefficients the model to refine, replaced by the refined model if it has more inliers
+        * \param[in,out] n_inliers_count the number of inliers of the model
+        * \return true if the model was replaced
+        */
+      bool
+      optimizeLocally (Eigen::VectorXf &model_coefficients, std::size_t &n_inliers_count) const;
+
+      /** \brief The number of least squares iterations of the local optimization. */
+      unsigned int lo_iterations_;
+
+      /** \brief The multiple of the distance threshold used in the first iteration of the local optimization. */
+      double threshold_multiplier_;
+
+      /** \brief The number of hypotheses generated and scored together. */
+      unsigned int batch_size_;
+  };
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/sample_consensus/impl/lo_ransac.hpp>
+#endif
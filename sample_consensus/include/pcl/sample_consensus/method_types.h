@@ -49,4 +49,5 @@ namespace pcl
   const static int SAC_RMSAC   = 4;
   const static int SAC_MLESAC  = 5;
   const static int SAC_PROSAC  = 6;
+  const static int SAC_LORANSAC = 7;
 }
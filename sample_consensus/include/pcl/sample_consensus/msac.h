@@ -49,6 +49,7 @@ namespace pcl
   /** \brief @b MEstimatorSampleConsensus represents an implementation of the MSAC (M-estimator SAmple Consensus) 
     * algorithm, as described in: "MLESAC: A new robust estimator with application to estimating image geometry", P.H.S. 
     * Torr and A. Zisserman, Computer Vision and Image Understanding, vol 78, 2000.
+    * Bad hypotheses can be rejected after a few random points, enable with setUseSPRT.
     * \author Radu B. Rusu
     * \ingroup sample_consensus
     */
@@ -69,6 +70,8 @@ namespace pcl
       using SampleConsensus<PointT>::model_coefficients_;
       using SampleConsensus<PointT>::inliers_;
       using SampleConsensus<PointT>::probability_;
+      using SampleConsensus<PointT>::use_sprt_;
+      using SampleConsensus<PointT>::rng_;
 
       /** \brief MSAC (M-estimator SAmple Consensus) main constructor
         * \param[in] model a Sample Consensus model
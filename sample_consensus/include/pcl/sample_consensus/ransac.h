@@ -49,6 +49,7 @@ namespace pcl
     * described in: "Random Sample Consensus: A Paradigm for Model Fitting with Applications to Image Analysis and 
     * Automated Cartography", Martin A. Fischler and Robert C. Bolles, Comm. Of the ACM 24: 381–395, June 1981.
     * A parallel variant is available, enable with setNumberOfThreads. Default is non-parallel.
+    * Bad hypotheses can be rejected after a few random points, enable with setUseSPRT.
     * \author Radu B. Rusu
     * \ingroup sample_consensus
     */
@@ -70,6 +71,8 @@ namespace pcl
       using SampleConsensus<PointT>::inliers_;
       using SampleConsensus<PointT>::probability_;
       using SampleConsensus<PointT>::threads_;
+      using SampleConsensus<PointT>::use_sprt_;
+      using SampleConsensus<PointT>::rng_;
 
       /** \brief RANSAC (RAndom SAmple Consensus) main constructor
         * \param[in] model a Sample Consensus model
@@ -79,6 +79,7 @@ namespace pcl
         , threshold_ (std::numeric_limits<double>::max ())
         , max_iterations_ (1000)
         , threads_ (-1)
+        , use_sprt_ (false)
         , rng_ (new boost::uniform_01<boost::mt19937> (rng_alg_))
       {
          // Create a random number generator object
@@ -102,6 +103,7 @@ namespace pcl
         , threshold_ (threshold)
         , max_iterations_ (1000)
         , threads_ (-1)
+        , use_sprt_ (false)
         , rng_ (new boost::uniform_01<boost::mt19937> (rng_alg_))
       {
          // Create a random number generator object
@@ -172,6 +174,18 @@ namespace pcl
       inline int
       getNumberOfThreads () const { return (threads_); }
 
+      /** \brief Set whether to pre-verify the hypotheses on a few random points with Wald's sequential
+        * probability ratio test (see SampleConsensusSPRT), and only score those which pass on all the points.
+        * \param[in] use_sprt true to pre-verify the hypotheses (default: false)
+        * \note Only RANSAC, MSAC and LMedS use the test. Some will ignore this setting.
+        */
+      inline void
+      setUseSPRT (bool use_sprt) { use_sprt_ = use_sprt; }
+
+      /** \brief Get whether the hypotheses are pre-verified with Wald's sequential probability ratio test. */
+      inline bool
+      getUseSPRT () const { return (use_sprt_); }
+
       /** \brief Compute the actual model. Pure virtual. */
       virtual bool 
       computeModel (int debug_verbosity_level = 0) = 0;
@@ -341,6 +355,9 @@ namespace pcl
       /** \brief The number of threads the scheduler should use, or a negative number if no parallelization is wanted. */
       int threads_;
 
+      /** \brief Whether to pre-verify the hypotheses with Wald's sequential probability ratio test. */
+      bool use_sprt_;
+
       /** \brief Boost-based random number generator algorithm. */
       boost::mt19937 rng_alg_;
 
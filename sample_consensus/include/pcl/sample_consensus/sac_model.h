@@ -288,6 +288,45 @@ namespace pcl
                             const Eigen::VectorXf &model_coefficients,
                             const double threshold) const = 0;
 
+      /** \brief Count the points of a subset of the indices which respect the given
+        * model coefficients as inliers. The sample consensus methods use it to
+        * pre-verify the hypotheses on a few random points (see SampleConsensusSPRT).
+        * The default implementation tests the points one at a time with
+        * doSamplesVerifyModel, models override it with a faster test.
+        * Implementations of this function must be thread-safe.
+        * \note The points are only counted as countWithinDistance would count them
+        * in the models for which canCountSamplesWithinDistance returns true.
+        * \param[in] samples the data indices that need to be tested against the model
+        * \param[in] model_coefficients the set of model coefficients
+        * \param[in] threshold a maximum admissible distance threshold for
+        * determining the inliers from the outliers
+        * \return the number of inliers among the samples
+        */
+      virtual std::size_t
+      countSamplesWithinDistance (const Indices &samples,
+                                  const Eigen::VectorXf &model_coefficients,
+                                  const double threshold) const
+      {
+        std::size_t nr_inliers = 0;
+        std::set<index_t> sample;
+        for (const auto &index : samples)
+        {
+          sample.clear ();
+          sample.insert (index);
+          if (doSamplesVerifyModel (sample, model_coefficients, threshold))
+            ++nr_inliers;
+        }
+        return (nr_inliers);
+      }
+
+      /** \brief Whether countSamplesWithinDistance counts the inliers exactly as
+        * countWithinDistance does. The sample consensus methods only pre-verify the
+        * hypotheses of such models. False by default, since doSamplesVerifyModel does
+        * not apply the distance of every model (e.g. the weighted normal distances).
+        */
+      virtual bool
+      canCountSamplesWithinDistance () const { return (false); }
+
       /** \brief Provide a pointer to the input dataset
         * \param[in] cloud the const boost shared pointer to a PointCloud message
         */
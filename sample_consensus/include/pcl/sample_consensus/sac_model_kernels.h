@@ -0,0 +1,144 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/pcl_macros.h>
+#include <pcl/point_cloud.h>
+#include <pcl/types.h> // for index_t, Indices
+
+#include <Eigen/Core>
+
+#include <cstdint>
+
+namespace pcl
+{
+  namespace detail
+  {
+    /** \brief Instruction sets of the kernels counting the points within a distance of a model. */
+    enum class SacKernel
+    {
+      AUTO,     ///< the widest instruction set supported by the CPU
+      DEFAULT,  ///< one point at a time
+      SSE2,     ///< four points at a time, if enabled at build time
+      AVX2      ///< eight points at a time
+    };
+
+    /** \brief Return whether the CPU supports the instruction set of a sample consensus kernel. */
+    PCL_EXPORTS bool
+    isSacKernelSupported (SacKernel kernel);
+
+    /** \brief The indexed points a sample consensus model is evaluated on. */
+    struct SacPoints
+    {
+      /** \brief The x coordinate of the first point of the cloud, followed by y and z. */
+      const float *xyz = nullptr;
+      /** \brief The distance between consecutive points, in bytes. */
+      std::size_t stride = 0;
+      /** \brief The indices of the points to evaluate. */
+      const index_t *indices = nullptr;
+      /** \brief The number of indices. */
+      std::size_t size = 0;
+      /** \brief Whether 4 floats can be read from the x coordinate of each point. Otherwise the
+        * points are only evaluated one at a time.
+        */
+      bool padded = false;
+    };
+
+    /** \brief Describe the indexed points of a cloud for the sample consensus kernels. */
+    template <typename PointT> inline SacPoints
+    makeSacPoints (const pcl::PointCloud<PointT> &cloud, const Indices &indices)
+    {
+      SacPoints points;
+      if (cloud.points.empty () || indices.empty ())
+        return (points);
+      const PointT &p = cloud.points[0];
+      points.xyz = &p.x;
+      points.stride = sizeof (PointT);
+      points.indices = indices.data ();
+      points.size = indices.size ();
+      const auto x_offset = reinterpret_cast<const std::uint8_t*> (&p.x) - reinterpret_cast<const std::uint8_t*> (&p);
+      points.padded = (&p.y == &p.x + 1) && (&p.z == &p.x + 2) && (x_offset + 4 * sizeof (float) <= sizeof (PointT));
+      return (points);
+    }
+
+    /** \brief Count the points whose distance |n . p + d| to a plane is smaller than a threshold.
+      * \param[in] points the points to evaluate
+      * \param[in] plane the plane coefficients n_x, n_y, n_z, d, with a unit normal
+      * \param[in] threshold the distance threshold
+      * \param[in] kernel the instruction set to use, falling back to DEFAULT if it is not supported
+      * \note All kernels compute the distances with the same floating point operations, so they count the
+      * same points.
+      */
+    PCL_EXPORTS std::size_t
+    countWithinPlaneDistance (const SacPoints &points, const Eigen::Vector4f &plane, double threshold,
+                              SacKernel kernel = SacKernel::AUTO);
+
+    /** \brief Count the points whose distance ||p - c|| - r to the surface of a sphere is smaller than a
+      * threshold in absolute value.
+      * \param[in] points the points to evaluate
+      * \param[in] sphere the sphere coefficients c_x, c_y, c_z, r
+      * \param[in] threshold the distance threshold
+      * \param[in] kernel the instruction set to use, falling back to DEFAULT if it is not supported
+      */
+    PCL_EXPORTS std::size_t
+    countWithinSphereDistance (const SacPoints &points, const Eigen::Vector4f &sphere, double threshold,
+                               SacKernel kernel = SacKernel::AUTO);
+
+    /** \brief Count the points whose distance to a circle in the XY plane, ignoring their z coordinate, is
+      * smaller than a threshold.
+      * \param[in] points the points to evaluate
+      * \param[in] circle the circle coefficients c_x, c_y, r
+      * \param[in] threshold the distance threshold
+      * \param[in] kernel the instruction set to use, falling back to DEFAULT if it is not supported
+      */
+    PCL_EXPORTS std::size_t
+    countWithinCircleDistance (const SacPoints &points, const Eigen::Vector3f &circle, double threshold,
+                               SacKernel kernel = SacKernel::AUTO);
+
+    /** \brief Count the points whose squared distance to a line is smaller than a threshold.
+      * \param[in] points the points to evaluate
+      * \param[in] line_pt a point of the line
+      * \param[in] line_dir the unit direction of the line
+      * \param[in] sqr_threshold the squared distance threshold
+      * \param[in] kernel the instruction set to use, falling back to DEFAULT if it is not supported
+      */
+    PCL_EXPORTS std::size_t
+    countWithinLineDistance (const SacPoints &points, const Eigen::Vector3f &line_pt, const Eigen::Vector3f &line_dir,
+                             double sqr_threshold, SacKernel kernel = SacKernel::AUTO);
+  }
+}
@@ -148,6 +148,21 @@ namespace pcl
       countWithinDistance (const Eigen::VectorXf &model_coefficients,
                            const double threshold) const override;
 
+      /** \brief Count the points of a subset of the indices which respect the given model coefficients
+        * as inliers, with the same weighted distance as countWithinDistance.
+        * \param[in] samples the data indices that need to be tested against the model
+        * \param[in] model_coefficients the coefficients of a model that we need to compute distances to
+        * \param[in] threshold maximum admissible distance threshold for determining the inliers from the outliers
+        */
+      std::size_t
+      countSamplesWithinDistance (const Indices &samples,
+                                  const Eigen::VectorXf &model_coefficients,
+                                  const double threshold) const override;
+
+      /** \brief The points of the samples are counted with the distance of countWithinDistance. */
+      bool
+      canCountSamplesWithinDistance () const override { return (true); }
+
       /** \brief Compute all distances from the cloud data to a given plane model.
         * \param[in] model_coefficients the coefficients of a plane model that we need to compute distances to
         * \param[out] distances the resultant estimated distances
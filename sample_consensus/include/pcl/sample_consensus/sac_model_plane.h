@@ -249,6 +249,21 @@ namespace pcl
                             const Eigen::VectorXf &model_coefficients,
                             const double threshold) const override;
 
+      /** \brief Count the points of a subset of the indices which are within a distance
+        * threshold of the plane model.
+        * \param[in] samples the data indices that need to be tested against the plane model
+        * \param[in] model_coefficients the plane model coefficients
+        * \param[in] threshold a maximum admissible distance threshold for determining the inliers from the outliers
+        */
+      std::size_t
+      countSamplesWithinDistance (const Indices &samples,
+                                  const Eigen::VectorXf &model_coefficients,
+                                  const double threshold) const override;
+
+      /** \brief The points of the samples are counted with the distance of countWithinDistance. */
+      bool
+      canCountSamplesWithinDistance () const override { return (true); }
+
       /** \brief Return a unique id for this model (SACMODEL_PLANE). */
       inline pcl::SacModel 
       getModelType () const override { return (SACMODEL_PLANE); }
@@ -135,6 +135,12 @@ namespace pcl
       countWithinDistance (const Eigen::VectorXf &model_coefficients,
                            const double threshold) const;
 
+      /** \brief The inliers are counted with the projection distance, which countSamplesWithinDistance
+        * of SampleConsensusModelRegistration does not apply.
+        */
+      bool
+      canCountSamplesWithinDistance () const override { return (false); }
+
       /** \brief Set the camera projection matrix. 
         * \param[in] projection_matrix the camera projection matrix 
         */
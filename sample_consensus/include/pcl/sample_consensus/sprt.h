@@ -0,0 +1,219 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/sample_consensus/sac_model.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+namespace pcl
+{
+  /** \brief @b SampleConsensusSPRT is Wald's sequential probability ratio test (SPRT), which rejects
+    * bad hypotheses of a sample consensus estimator after verifying them on a few random points, as
+    * described in: "Optimal Randomized RANSAC", Ondřej Chum and Jiří Matas, IEEE Transactions on
+    * Pattern Analysis and Machine Intelligence 30(8): 1472–1482, 2008.
+    *
+    * A point is an inlier of a good hypothesis with probability epsilon, the inlier ratio, and of a bad
+    * one with probability delta. The test accumulates the likelihood ratio of the hypothesis being bad
+    * rather than good over random points, and rejects it as soon as the ratio exceeds the threshold A
+    * which minimizes the expected time of the estimation. Epsilon is set from the best hypothesis found
+    * so far, and delta is estimated from the rejected hypotheses. The test only starts once epsilon is
+    * known and larger than delta.
+    *
+    * Models for which SampleConsensusModel::canCountSamplesWithinDistance returns false are not
+    * pre-verified, all their hypotheses are left to the estimator.
+    *
+    * A hypothesis which is not rejected after 10 times the average number of points needed to reject a
+    * bad one is left to the estimator, to be scored on all the points.
+    * \ingroup sample_consensus
+    */
+  class SampleConsensusSPRT
+  {
+    public:
+      /** \brief The outcome of the pre-verification of a hypothesis. */
+      struct Result
+      {
+        /** \brief Whether the hypothesis was rejected. Otherwise it should be scored on all the points. */
+        bool rejected = false;
+        /** \brief The number of random points tested. */
+        std::size_t nr_tested = 0;
+        /** \brief The number of tested points which are inliers of the hypothesis. */
+        std::size_t nr_consistent = 0;
+      };
+
+      /** \brief Constructor.
+        * \param[in] nr_points the number of points the hypotheses are scored on
+        * \param[in] model_estimation_cost the time needed to compute a hypothesis from a sample, relative
+        * to the time needed to verify one point
+        * \param[in] delta the initial probability for a point to be an inlier of a bad hypothesis
+        */
+      SampleConsensusSPRT (std::size_t nr_points = 0, double model_estimation_cost = 100.0, double delta = 0.01)
+        : nr_points_ (nr_points)
+        , model_estimation_cost_ (model_estimation_cost)
+        , epsilon_ (0.0)
+        , delta_ (delta)
+      {
+        updateThreshold ();
+      }
+
+      /** \brief Pre-verify a hypothesis on random points of a model.
+        * \param[in] model the sample consensus model
+        * \param[in] model_coefficients the coefficients of the hypothesis
+        * \param[in] threshold the distance threshold of the inliers
+        * \param[in,out] rng the random number generator drawing the points
+        */
+      template <typename PointT, typename RandomGenerator> Result
+      verify (const SampleConsensusModel<PointT> &model, const Eigen::VectorXf &model_coefficients,
+              double threshold, RandomGenerator &rng) const
+      {
+        Result result;
+        if (!active_ || !model.canCountSamplesWithinDistance ())
+          return (result);
+
+        const IndicesPtr indices = model.getIndices ();
+        std::uniform_int_distribution<std::size_t> random_point (0, indices->size () - 1);
+        // The points are tested in small blocks, so that the model can verify them with its vectorized kernels
+        constexpr std::size_t block_size = 8;
+        Indices block;
+        block.reserve (block_size);
+        double log_lambda = 0.0;
+        while (result.nr_tested < max_nr_tested_)
+        {
+          block.resize (std::min (block_size, max_nr_tested_ - result.nr_tested));
+          for (auto &index : block)
+            index = (*indices)[random_point (rng)];
+          const std::size_t nr_consistent = model.countSamplesWithinDistance (block, model_coefficients, threshold);
+          result.nr_tested += block.size ();
+          result.nr_consistent += nr_consistent;
+          log_lambda += static_cast<double> (nr_consistent) * log_consistent_ +
+                        static_cast<double> (block.size () - nr_consistent) * log_inconsistent_;
+          if (log_lambda > log_threshold_)
+          {
+            result.rejected = true;
+            break;
+          }
+        }
+        return (result);
+      }
+
+      /** \brief Update the probability delta with the points tested on a rejected hypothesis. */
+      void
+      addRejected (const Result &result)
+      {
+        nr_rejected_consistent_ += result.nr_consistent;
+        nr_rejected_tested_ += result.nr_tested;
+        if (nr_rejected_tested_ == 0)
+          return;
+        delta_ = static_cast<double> (nr_rejected_consistent_) / static_cast<double> (nr_rejected_tested_);
+        updateThreshold ();
+      }
+
+      /** \brief Set the inlier ratio epsilon of the good hypotheses, from the best hypothesis found so far. */
+      void
+      setInlierRatio (double epsilon)
+      {
+        epsilon_ = epsilon;
+        updateThreshold ();
+      }
+
+      /** \brief Get the inlier ratio of the good hypotheses. */
+      inline double
+      getInlierRatio () const { return (epsilon_); }
+
+      /** \brief Get the probability for a point to be an inlier of a bad hypothesis. */
+      inline double
+      getDelta () const { return (delta_); }
+
+      /** \brief Get the probability for the test to reject a good hypothesis, at most 1 / A. Estimators
+        * divide the number of good samples they draw by 1 minus this probability.
+        */
+      inline double
+      getFalseRejectionProbability () const { return (active_ ? std::exp (-log_threshold_) : 0.0); }
+
+      /** \brief Whether the test rejects hypotheses, i.e. epsilon is known and larger than delta. */
+      inline bool
+      isActive () const { return (active_); }
+
+    private:
+      /** \brief Compute the decision threshold A for the current epsilon and delta. */
+      void
+      updateThreshold ()
+      {
+        // Avoid infinite log-likelihoods
+        const double epsilon = (std::min) (epsilon_, 1.0 - 1e-6);
+        const double delta = (std::max) (delta_, 1e-6);
+        active_ = nr_points_ > 0 && epsilon > delta;
+        if (!active_)
+          return;
+
+        log_consistent_ = std::log (delta / epsilon);
+        log_inconsistent_ = std::log ((1.0 - delta) / (1.0 - epsilon));
+        // The expected information gained per point of a bad hypothesis, and the fixed point of
+        // A = t_M * C + 1 + log (A), with one hypothesis per sample
+        const double c = (1.0 - delta) * log_inconsistent_ + delta * log_consistent_;
+        const double k = model_estimation_cost_ * c + 1.0;
+        double a = k;
+        for (int i = 0; i < 20; ++i)
+          a = k + std::log (a);
+        log_threshold_ = std::log (a);
+        // Wald's approximation of the number of points needed to reject a bad hypothesis is log (A) / C
+        const double max_nr_tested = std::ceil (10.0 * log_threshold_ / c);
+        max_nr_tested_ = max_nr_tested < static_cast<double> (nr_points_) ? static_cast<std::size_t> (max_nr_tested) : nr_points_;
+      }
+
+      /** \brief The number of points the hypotheses are scored on. */
+      std::size_t nr_points_;
+      /** \brief The time needed to compute a hypothesis, relative to the time needed to verify a point. */
+      double model_estimation_cost_;
+      /** \brief The probability for a point to be an inlier of a good hypothesis. */
+      double epsilon_;
+      /** \brief The probability for a point to be an inlier of a bad hypothesis. */
+      double delta_;
+      /** \brief The number of inliers and of points tested on the rejected hypotheses. */
+      std::size_t nr_rejected_consistent_ = 0, nr_rejected_tested_ = 0;
+      /** \brief Whether the test rejects hypotheses. */
+      bool active_ = false;
+      /** \brief The logarithms of the likelihood ratio factors of an inlier and of an outlier, and of A. */
+      double log_consistent_ = 0.0, log_inconsistent_ = 0.0, log_threshold_ = 0.0;
+      /** \brief The maximum number of points tested on a hypothesis. */
+      std::size_t max_nr_tested_ = 0;
+  };
+}
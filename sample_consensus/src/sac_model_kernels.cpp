@@ -0,0 +1,408 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/sample_consensus/sac_model_kernels.h>
+
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#include <xmmintrin.h>
+#endif
+
+// The AVX2 kernel is compiled for its instruction set regardless of the build flags,
+// and selected at runtime according to the CPU
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PCL_SAC_KERNELS_DISPATCH 1
+// This file is built with -ffp-contract=off, so that all the kernels compute the same distances
+#define PCL_SAC_KERNELS_TARGET(isa) __attribute__ ((target (isa)))
+#include <immintrin.h>
+#endif
+
+namespace
+{
+  /** \brief Get the coordinates of the i-th indexed point. */
+  inline const float*
+  getPoint (const pcl::detail::SacPoints &points, std::size_t i)
+  {
+    return (reinterpret_cast<const float*> (reinterpret_cast<const std::uint8_t*> (points.xyz) +
+                                            static_cast<std::size_t> (points.indices[i]) * points.stride));
+  }
+
+  /** \brief Round a threshold up to a float, so that a float distance is smaller than the result
+    * if and only if it is smaller than the original threshold.
+    */
+  inline float
+  toFloatThreshold (double threshold)
+  {
+    float result = static_cast<float> (threshold);
+    if (static_cast<double> (result) < threshold)
+      result = std::nextafter (result, std::numeric_limits<float>::infinity ());
+    return (result);
+  }
+
+#if defined(__SSE2__)
+  /** \brief Load the coordinates of 4 indexed points, and transpose them into x, y and z registers. */
+  inline void
+  gatherSSE2 (const pcl::detail::SacPoints &points, std::size_t i, __m128 &x, __m128 &y, __m128 &z)
+  {
+    x = _mm_loadu_ps (getPoint (points, i));
+    y = _mm_loadu_ps (getPoint (points, i + 1));
+    z = _mm_loadu_ps (getPoint (points, i + 2));
+    __m128 w = _mm_loadu_ps (getPoint (points, i + 3));
+    _MM_TRANSPOSE4_PS (x, y, z, w);
+  }
+
+  inline __m128
+  absSSE2 (__m128 v)
+  {
+    return (_mm_andnot_ps (_mm_set1_ps (-0.0f), v));
+  }
+#endif
+
+#ifdef PCL_SAC_KERNELS_DISPATCH
+  /** \brief Load the coordinates of 8 indexed points, and transpose them into x, y and z registers. */
+  PCL_SAC_KERNELS_TARGET ("avx2") inline void
+  gatherAVX2 (const pcl::detail::SacPoints &points, std::size_t i, __m256 &x, __m256 &y, __m256 &z)
+  {
+    __m256 r[4];
+    for (std::size_t j = 0; j < 4; ++j)
+      r[j] = _mm256_insertf128_ps (_mm256_castps128_ps256 (_mm_loadu_ps (getPoint (points, i + j))),
+                                   _mm_loadu_ps (getPoint (points, i + j + 4)), 1);
+    const __m256 t0 = _mm256_unpacklo_ps (r[0], r[1]);
+    const __m256 t1 = _mm256_unpacklo_ps (r[2], r[3]);
+    const __m256 t2 = _mm256_unpackhi_ps (r[0], r[1]);
+    const __m256 t3 = _mm256_unpackhi_ps (r[2], r[3]);
+    x = _mm256_shuffle_ps (t0, t1, 0x44);
+    y = _mm256_shuffle_ps (t0, t1, 0xEE);
+    z = _mm256_shuffle_ps (t2, t3, 0x44);
+  }
+
+  PCL_SAC_KERNELS_TARGET ("avx2") inline __m256
+  absAVX2 (__m256 v)
+  {
+    return (_mm256_andnot_ps (_mm256_set1_ps (-0.0f), v));
+  }
+#endif
+
+  /** \brief The distance |n . p + d| of points to a plane. */
+  struct PlaneDistance
+  {
+    float a, b, c, d;
+
+    inline float
+    operator() (float x, float y, float z) const
+    {
+      return (std::abs ((a * x + c * z) + (b * y + d)));
+    }
+
+#if defined(__SSE2__)
+    inline __m128
+    operator() (__m128 x, __m128 y, __m128 z) const
+    {
+      return (absSSE2 (_mm_add_ps (_mm_add_ps (_mm_mul_ps (_mm_set1_ps (a), x), _mm_mul_ps (_mm_set1_ps (c), z)),
+                                   _mm_add_ps (_mm_mul_ps (_mm_set1_ps (b), y), _mm_set1_ps (d)))));
+    }
+#endif
+
+#ifdef PCL_SAC_KERNELS_DISPATCH
+    PCL_SAC_KERNELS_TARGET ("avx2") inline __m256
+    operator() (__m256 x, __m256 y, __m256 z) const
+    {
+      return (absAVX2 (_mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (_mm256_set1_ps (a), x), _mm256_mul_ps (_mm256_set1_ps (c), z)),
+                                      _mm256_add_ps (_mm256_mul_ps (_mm256_set1_ps (b), y), _mm256_set1_ps (d)))));
+    }
+#endif
+  };
+
+  /** \brief The distance | ||p - c|| - r | of points to the surface of a sphere. */
+  struct SphereDistance
+  {
+    float cx, cy, cz, r;
+
+    inline float
+    operator() (float x, float y, float z) const
+    {
+      const float dx = x - cx, dy = y - cy, dz = z - cz;
+      return (std::abs (std::sqrt ((dx * dx + dy * dy) + dz * dz) - r));
+    }
+
+#if defined(__SSE2__)
+    inline __m128
+    operator() (__m128 x, __m128 y, __m128 z) const
+    {
+      const __m128 dx = _mm_sub_ps (x, _mm_set1_ps (cx));
+      const __m128 dy = _mm_sub_ps (y, _mm_set1_ps (cy));
+      const __m128 dz = _mm_sub_ps (z, _mm_set1_ps (cz));
+      const __m128 sqr_norm = _mm_add_ps (_mm_add_ps (_mm_mul_ps (dx, dx), _mm_mul_ps (dy, dy)), _mm_mul_ps (dz, dz));
+      return (absSSE2 (_mm_sub_ps (_mm_sqrt_ps (sqr_norm), _mm_set1_ps (r))));
+    }
+#endif
+
+#ifdef PCL_SAC_KERNELS_DISPATCH
+    PCL_SAC_KERNELS_TARGET ("avx2") inline __m256
+    operator() (__m256 x, __m256 y, __m256 z) const
+    {
+      const __m256 dx = _mm256_sub_ps (x, _mm256_set1_ps (cx));
+      const __m256 dy = _mm256_sub_ps (y, _mm256_set1_ps (cy));
+      const __m256 dz = _mm256_sub_ps (z, _mm256_set1_ps (cz));
+      const __m256 sqr_norm = _mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (dx, dx), _mm256_mul_ps (dy, dy)), _mm256_mul_ps (dz, dz));
+      return (absAVX2 (_mm256_sub_ps (_mm256_sqrt_ps (sqr_norm), _mm256_set1_ps (r))));
+    }
+#endif
+  };
+
+  /** \brief The distance | ||p_xy - c|| - r | of points to a circle in the XY plane. */
+  struct CircleDistance
+  {
+    float cx, cy, r;
+
+    inline float
+    operator() (float x, float y, float) const
+    {
+      const float dx = x - cx, dy = y - cy;
+      return (std::abs (std::sqrt (dx * dx + dy * dy) - r));
+    }
+
+#if defined(__SSE2__)
+    inline __m128
+    operator() (__m128 x, __m128 y, __m128) const
+    {
+      const __m128 dx = _mm_sub_ps (x, _mm_set1_ps (cx));
+      const __m128 dy = _mm_sub_ps (y, _mm_set1_ps (cy));
+      return (absSSE2 (_mm_sub_ps (_mm_sqrt_ps (_mm_add_ps (_mm_mul_ps (dx, dx), _mm_mul_ps (dy, dy))), _mm_set1_ps (r))));
+    }
+#endif
+
+#ifdef PCL_SAC_KERNELS_DISPATCH
+    PCL_SAC_KERNELS_TARGET ("avx2") inline __m256
+    operator() (__m256 x, __m256 y, __m256) const
+    {
+      const __m256 dx = _mm256_sub_ps (x, _mm256_set1_ps (cx));
+      const __m256 dy = _mm256_sub_ps (y, _mm256_set1_ps (cy));
+      return (absAVX2 (_mm256_sub_ps (_mm256_sqrt_ps (_mm256_add_ps (_mm256_mul_ps (dx, dx), _mm256_mul_ps (dy, dy))),
+                                      _mm256_set1_ps (r))));
+    }
+#endif
+  };
+
+  /** \brief The squared distance ||(l - p) x u||^2 of points to a line through l with unit direction u. */
+  struct LineSqrDistance
+  {
+    float lx, ly, lz, ux, uy, uz;
+
+    inline float
+    operator() (float x, float y, float z) const
+    {
+      const float vx = lx - x, vy = ly - y, vz = lz - z;
+      const float cx = vy * uz - vz * uy;
+      const float cy = vz * ux - vx * uz;
+      const float cz = vx * uy - vy * ux;
+      return ((cx * cx + cz * cz) + cy * cy);
+    }
+
+#if defined(__SSE2__)
+    inline __m128
+    operator() (__m128 x, __m128 y, __m128 z) const
+    {
+      const __m128 vx = _mm_sub_ps (_mm_set1_ps (lx), x);
+      const __m128 vy = _mm_sub_ps (_mm_set1_ps (ly), y);
+      const __m128 vz = _mm_sub_ps (_mm_set1_ps (lz), z);
+      const __m128 cx = _mm_sub_ps (_mm_mul_ps (vy, _mm_set1_ps (uz)), _mm_mul_ps (vz, _mm_set1_ps (uy)));
+      const __m128 cy = _mm_sub_ps (_mm_mul_ps (vz, _mm_set1_ps (ux)), _mm_mul_ps (vx, _mm_set1_ps (uz)));
+      const __m128 cz = _mm_sub_ps (_mm_mul_ps (vx, _mm_set1_ps (uy)), _mm_mul_ps (vy, _mm_set1_ps (ux)));
+      return (_mm_add_ps (_mm_add_ps (_mm_mul_ps (cx, cx), _mm_mul_ps (cz, cz)), _mm_mul_ps (cy, cy)));
+    }
+#endif
+
+#ifdef PCL_SAC_KERNELS_DISPATCH
+    PCL_SAC_KERNELS_TARGET ("avx2") inline __m256
+    operator() (__m256 x, __m256 y, __m256 z) const
+    {
+      const __m256 vx = _mm256_sub_ps (_mm256_set1_ps (lx), x);
+      const __m256 vy = _mm256_sub_ps (_mm256_set1_ps (ly), y);
+      const __m256 vz = _mm256_sub_ps (_mm256_set1_ps (lz), z);
+      const __m256 cx = _mm256_sub_ps (_mm256_mul_ps (vy, _mm256_set1_ps (uz)), _mm256_mul_ps (vz, _mm256_set1_ps (uy)));
+      const __m256 cy = _mm256_sub_ps (_mm256_mul_ps (vz, _mm256_set1_ps (ux)), _mm256_mul_ps (vx, _mm256_set1_ps (uz)));
+      const __m256 cz = _mm256_sub_ps (_mm256_mul_ps (vx, _mm256_set1_ps (uy)), _mm256_mul_ps (vy, _mm256_set1_ps (ux)));
+      return (_mm256_add_ps (_mm256_add_ps (_mm256_mul_ps (cx, cx), _mm256_mul_ps (cz, cz)), _mm256_mul_ps (cy, cy)));
+    }
+#endif
+  };
+
+  /** \brief Count the indexed points from \a begin on which are closer than \a threshold, one at a time. */
+  template <typename Distance> std::size_t
+  countDefault (const pcl::detail::SacPoints &points, std::size_t begin, const Distance &distance, float threshold)
+  {
+    std::size_t count = 0;
+    for (std::size_t i = begin; i < points.size; ++i)
+    {
+      const float *p = getPoint (points, i);
+      if (distance (p[0], p[1], p[2]) < threshold)
+        ++count;
+    }
+    return (count);
+  }
+
+#if defined(__SSE2__)
+  /** \brief Count the indexed points which are closer than \a threshold, four at a time. */
+  template <typename Distance> std::size_t
+  countSSE2 (const pcl::detail::SacPoints &points, const Distance &distance, float threshold)
+  {
+    const __m128 threshold4 = _mm_set1_ps (threshold);
+    // The lanes of the comparison masks are -1 for the points within the threshold
+    __m128i counts = _mm_setzero_si128 ();
+    std::size_t i = 0;
+    for (; i + 4 <= points.size; i += 4)
+    {
+      __m128 x, y, z;
+      gatherSSE2 (points, i, x, y, z);
+      counts = _mm_sub_epi32 (counts, _mm_castps_si128 (_mm_cmplt_ps (distance (x, y, z), threshold4)));
+    }
+    alignas (16) std::uint32_t lanes[4];
+    _mm_store_si128 (reinterpret_cast<__m128i*> (lanes), counts);
+    return (std::size_t (lanes[0]) + lanes[1] + lanes[2] + lanes[3] + countDefault (points, i, distance, threshold));
+  }
+#endif
+
+#ifdef PCL_SAC_KERNELS_DISPATCH
+  /** \brief Count the indexed points which are closer than \a threshold, eight at a time. */
+  template <typename Distance> PCL_SAC_KERNELS_TARGET ("avx2") std::size_t
+  countAVX2 (const pcl::detail::SacPoints &points, const Distance &distance, float threshold)
+  {
+    const __m256 threshold8 = _mm256_set1_ps (threshold);
+    __m256i counts = _mm256_setzero_si256 ();
+    std::size_t i = 0;
+    for (; i + 8 <= points.size; i += 8)
+    {
+      __m256 x, y, z;
+      gatherAVX2 (points, i, x, y, z);
+      counts = _mm256_sub_epi32 (counts, _mm256_castps_si256 (_mm256_cmp_ps (distance (x, y, z), threshold8, _CMP_LT_OQ)));
+    }
+    alignas (32) std::uint32_t lanes[8];
+    _mm256_store_si256 (reinterpret_cast<__m256i*> (lanes), counts);
+    std::size_t count = 0;
+    for (const auto lane : lanes)
+      count += lane;
+    return (count + countDefault (points, i, distance, threshold));
+  }
+#endif
+
+  /** \brief Count the indexed points which are closer than \a threshold with a given kernel. */
+  template <typename Distance> std::size_t
+  countWithinDistance (const pcl::detail::SacPoints &points, const Distance &distance, double threshold,
+                       pcl::detail::SacKernel kernel)
+  {
+    using pcl::detail::SacKernel;
+    const float float_threshold = toFloatThreshold (threshold);
+    if (points.padded)
+    {
+      if (kernel == SacKernel::AUTO)
+      {
+        static const SacKernel best_kernel =
+          pcl::detail::isSacKernelSupported (SacKernel::AVX2) ? SacKernel::AVX2 :
+          pcl::detail::isSacKernelSupported (SacKernel::SSE2) ? SacKernel::SSE2 :
+          SacKernel::DEFAULT;
+        kernel = best_kernel;
+      }
+#ifdef PCL_SAC_KERNELS_DISPATCH
+      if (kernel == SacKernel::AVX2 && pcl::detail::isSacKernelSupported (kernel))
+        return (countAVX2 (points, distance, float_threshold));
+#endif
+#if defined(__SSE2__)
+      if (kernel == SacKernel::SSE2)
+        return (countSSE2 (points, distance, float_threshold));
+#endif
+    }
+    return (countDefault (points, 0, distance, float_threshold));
+  }
+}
+
+bool
+pcl::detail::isSacKernelSupported (SacKernel kernel)
+{
+  switch (kernel)
+  {
+    case SacKernel::SSE2:
+#if defined(__SSE2__)
+      return (true);
+#else
+      return (false);
+#endif
+    case SacKernel::AVX2:
+#ifdef PCL_SAC_KERNELS_DISPATCH
+      return (__builtin_cpu_supports ("avx2"));
+#else
+      return (false);
+#endif
+    default:
+      return (true);
+  }
+}
+
+std::size_t
+pcl::detail::countWithinPlaneDistance (const SacPoints &points, const Eigen::Vector4f &plane, double threshold,
+                                      SacKernel kernel)
+{
+  const PlaneDistance distance {plane[0], plane[1], plane[2], plane[3]};
+  return (countWithinDistance (points, distance, threshold, kernel));
+}
+
+std::size_t
+pcl::detail::countWithinSphereDistance (const SacPoints &points, const Eigen::Vector4f &sphere, double threshold,
+                                       SacKernel kernel)
+{
+  const SphereDistance distance {sphere[0], sphere[1], sphere[2], sphere[3]};
+  return (countWithinDistance (points, distance, threshold, kernel));
+}
+
+std::size_t
+pcl::detail::countWithinCircleDistance (const SacPoints &points, const Eigen::Vector3f &circle, double threshold,
+                                       SacKernel kernel)
+{
+  const CircleDistance distance {circle[0], circle[1], circle[2]};
+  return (countWithinDistance (points, distance, threshold, kernel));
+}
+
+std::size_t
+pcl::detail::countWithinLineDistance (const SacPoints &points, const Eigen::Vector3f &line_pt, const Eigen::Vector3f &line_dir,
+                                     double sqr_threshold, SacKernel kernel)
+{
+  const LineSqrDistance distance {line_pt[0], line_pt[1], line_pt[2], line_dir[0], line_dir[1], line_dir[2]};
+  return (countWithinDistance (points, distance, sqr_threshold, kernel));
+}
@@ -121,6 +121,33 @@ namespace pcl
                       Indices &k_indices, std::vector<float> &k_sqr_distances,
                       unsigned int max_nn = 0) const override;
 
+        /** \brief Search for the k-nearest neighbors of a set of query points, in parallel.
+          * The queries are processed by tiles, so that each point of the input cloud is loaded once
+          * per tile instead of once per query.
+          * \param[in] cloud the point cloud data holding the query points
+          * \param[in] indices the indices in \a cloud of the query points. If empty, all the points of \a cloud are used
+          * \param[in] k the number of neighbors to search for
+          * \param[out] neighborhoods the neighbors of each query point, sorted by increasing distance
+          * \param[in] nr_threads the number of threads to use (0 sets the value to the number of processors)
+          */
+        void
+        nearestKSearch (const PointCloud &cloud, const Indices &indices, int k,
+                        Neighborhoods &neighborhoods, unsigned int nr_threads = 1) const override;
+
+        /** \brief Search for all the nearest neighbors of a set of query points in a given radius, in parallel.
+          * The queries are processed by tiles, so that each point of the input cloud is loaded once
+          * per tile instead of once per query.
+          * \param[in] cloud the point cloud data holding the query points
+          * \param[in] indices the indices in \a cloud of the query points. If empty, all the points of \a cloud are used
+          * \param[in] radius the radius of the sphere bounding all of the query points' neighbors
+          * \param[out] neighborhoods the neighbors of each query point
+          * \param[in] max_nn if given, bounds the maximum returned neighbors per query to this value
+          * \param[in] nr_threads the number of threads to use (0 sets the value to the number of processors)
+          */
+        void
+        radiusSearch (const PointCloud &cloud, const Indices &indices, double radius,
+                      Neighborhoods &neighborhoods, unsigned int max_nn = 0, unsigned int nr_threads = 1) const override;
+
       private:
         int
         denseKSearch (const PointT &point, int k, Indices &k_indices, std::vector<float> &k_distances) const;
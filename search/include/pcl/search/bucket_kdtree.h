@@ -0,0 +1,264 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/search/search.h>
+
+#include <map>
+
+namespace pcl
+{
+  namespace search
+  {
+    /** \brief BucketKdTree is a k-d tree over the x, y, z coordinates of a point cloud, implemented natively
+      * instead of wrapping FLANN.
+      *
+      * The nodes are stored in a single array in depth-first order, with the left child of an inner node
+      * immediately following it. The points are split at the median of the widest dimension until at most
+      * \a max_leaf_size points remain, and the coordinates of the points of each leaf are stored contiguously
+      * in structure-of-arrays form, so that the leaves are scanned with pcl::squaredEuclideanDistances (SSE2,
+      * and AVX when the CPU supports it). The tree can
+      * be built with several threads, and its searches are exact: they return the same neighbors as
+      * KdTreeFLANN with a null epsilon, up to the order of neighbors at equal distances.
+      *
+      * Points with non-finite coordinates are skipped when building the tree.
+      *
+      * \ingroup search
+      */
+    template<typename PointT>
+    class BucketKdTree : public Search<PointT>
+    {
+      public:
+        using PointCloud = typename Search<PointT>::PointCloud;
+        using PointCloudConstPtr = typename Search<PointT>::PointCloudConstPtr;
+
+        using pcl::search::Search<PointT>::indices_;
+        using pcl::search::Search<PointT>::input_;
+        using pcl::search::Search<PointT>::getIndices;
+        using pcl::search::Search<PointT>::getInputCloud;
+        using pcl::search::Search<PointT>::nearestKSearch;
+        using pcl::search::Search<PointT>::radiusSearch;
+        using pcl::search::Search<PointT>::sorted_results_;
+
+        using Ptr = shared_ptr<BucketKdTree<PointT> >;
+        using ConstPtr = shared_ptr<const BucketKdTree<PointT> >;
+
+        /** \brief Constructor.
+          * \param[in] sorted set to true if the radius search results need to be sorted in ascending order
+          * based on their distance to the query point
+          */
+        BucketKdTree (bool sorted = true);
+
+        /** \brief Set the maximum number of points in a leaf. Smaller leaves make deeper trees.
+          * \param[in] max_leaf_size the maximum number of points in a leaf, between 1 and 64 (default: 16)
+          */
+        void
+        setMaxLeafSize (unsigned int max_leaf_size);
+
+        /** \brief Get the maximum number of points in a leaf. */
+        inline unsigned int
+        getMaxLeafSize () const
+        {
+          return (max_leaf_size_);
+        }
+
+        /** \brief Set the number of threads used to build the tree.
+          * \param[in] nr_threads the number of hardware threads to use (0 sets the value back to automatic)
+          */
+        void
+        setNumberOfThreads (unsigned int nr_threads = 0);
+
+        /** \brief Get the number of threads used to build the tree. */
+        inline unsigned int
+        getNumberOfThreads () const
+        {
+          return (threads_);
+        }
+
+        /** \brief Provide a pointer to the input dataset, and build the tree.
+          * \param[in] cloud the const boost shared pointer to a PointCloud message
+          * \param[in] indices the point indices subset that is to be used from \a cloud
+          */
+        void
+        setInputCloud (const PointCloudConstPtr& cloud,
+                       const IndicesConstPtr& indices = IndicesConstPtr ()) override;
+
+        /** \brief Search for the k-nearest neighbors for the given query point.
+          * \param[in] point the given query point
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points, sorted by increasing distance
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \return number of neighbors found
+          */
+        int
+        nearestKSearch (const PointT &point, int k,
+                        Indices &k_indices,
+                        std::vector<float> &k_sqr_distances) const override;
+
+        /** \brief Search for all the nearest neighbors of the query point in a given radius.
+          * \param[in] point the given query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value, keeping the closest
+          * ones. If \a max_nn is set to 0 or to a number higher than the number of points in the input cloud, all
+          * neighbors in \a radius will be returned.
+          * \return number of neighbors found in radius
+          */
+        int
+        radiusSearch (const PointT& point, double radius,
+                      Indices &k_indices,
+                      std::vector<float> &k_sqr_distances,
+                      unsigned int max_nn = 0) const override;
+
+      protected:
+        /** \brief A node of the tree. */
+        struct Node
+        {
+          /** \brief The split dimension of an inner node, or minus the number of points of a leaf. */
+          int dim;
+
+          /** \brief The index of the right child of an inner node, or the position of the first point of a leaf.
+            * The left child of an inner node is the node following it.
+            */
+          int first;
+
+          /** \brief The largest coordinate of the left child of an inner node along \a dim. */
+          float low;
+
+          /** \brief The smallest coordinate of the right child of an inner node along \a dim. */
+          float high;
+        };
+
+        /** \brief Count the number of nodes of the subtree holding a given number of points, and store it in
+          * \a nr_nodes_ along with the counts of all its subtrees.
+          * \param[in] nr_points the number of points of the subtree
+          * \return the number of nodes of the subtree
+          */
+        std::size_t
+        countNodes (std::size_t nr_points);
+
+        /** \brief Build the subtree holding the points at positions [begin, end) of \a point_indices_.
+          * \param[in] node the index of the root node of the subtree
+          * \param[in] begin the position of the first point of the subtree
+          * \param[in] end the position after the last point of the subtree
+          */
+        void
+        buildSubtree (std::size_t node, std::size_t begin, std::size_t end);
+
+        /** \brief Recursively search the k nearest neighbors in the subtree of a node.
+          * \param[in] node the index of the node
+          * \param[in] query the coordinates of the query point
+          * \param[in] min_sqr_distance a lower bound of the squared distance between the query and the subtree
+          * \param[in,out] cut_sqr_distances the squared distances between the query and the cells of the subtree
+          * along each dimension, summing to \a min_sqr_distance
+          * \param[in] k the maximum number of neighbors
+          * \param[in] max_sqr_distance the squared distance neighbors have to be strictly below
+          * \param[in,out] heap_indices the indices of the neighbors found so far, in a max-heap on their distance
+          * \param[in,out] heap_sqr_distances the squared distances of the neighbors found so far
+          * \param[in,out] heap_size the number of neighbors found so far
+          */
+        void
+        searchKNearest (std::size_t node, const float *query, float min_sqr_distance, float *cut_sqr_distances,
+                        std::size_t k, float max_sqr_distance, index_t *heap_indices, float *heap_sqr_distances,
+                        std::size_t &heap_size) const;
+
+        /** \brief Recursively search all the neighbors in a radius in the subtree of a node.
+          * \param[in] node the index of the node
+          * \param[in] query the coordinates of the query point
+          * \param[in] min_sqr_distance a lower bound of the squared distance between the query and the subtree
+          * \param[in,out] cut_sqr_distances the squared distances between the query and the cells of the subtree
+          * along each dimension, summing to \a min_sqr_distance
+          * \param[in] sqr_radius the squared radius
+          * \param[out] k_indices the indices of the neighbors, appended to
+          * \param[out] k_sqr_distances the squared distances of the neighbors, appended to
+          */
+        void
+        searchRadius (std::size_t node, const float *query, float min_sqr_distance, float *cut_sqr_distances,
+                      float sqr_radius, Indices &k_indices, std::vector<float> &k_sqr_distances) const;
+
+        /** \brief Compute the squared distances between a query point and the points of a leaf.
+          * \param[in] node the leaf
+          * \param[in] query the coordinates of the query point
+          * \param[out] sqr_distances the squared distances, one per point of the leaf
+          */
+        void
+        computeLeafSqrDistances (const Node &node, const float *query, float *sqr_distances) const;
+
+        /** \brief Get the squared distance between a query point and the bounding box of the tree, and its
+          * components along each dimension.
+          */
+        float
+        computeInitialSqrDistances (const float *query, float *cut_sqr_distances) const;
+
+        /** \brief The nodes of the tree, in depth-first order. */
+        std::vector<Node> nodes_;
+
+        /** \brief The indices in the input cloud of the points of the tree, in leaf order. */
+        Indices point_indices_;
+
+        /** \brief The x coordinates of the points of the tree, in leaf order. */
+        std::vector<float> x_;
+
+        /** \brief The y coordinates of the points of the tree, in leaf order. */
+        std::vector<float> y_;
+
+        /** \brief The z coordinates of the points of the tree, in leaf order. */
+        std::vector<float> z_;
+
+        /** \brief The minimum coordinates of the points of the tree. */
+        float min_[3];
+
+        /** \brief The maximum coordinates of the points of the tree. */
+        float max_[3];
+
+        /** \brief The number of nodes of the subtrees holding a given number of points, filled by countNodes (). */
+        std::map<std::size_t, std::size_t> nr_nodes_;
+
+        /** \brief The maximum number of points in a leaf. */
+        unsigned int max_leaf_size_;
+
+        /** \brief The number of threads used to build the tree. */
+        unsigned int threads_;
+    };
+  }
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/search/impl/bucket_kdtree.hpp>
+#endif
@@ -39,6 +39,7 @@
 
 #include <pcl/common/point_tests.h> // for pcl::isFinite
 #include <pcl/search/brute_force.h>
+#include <algorithm>
 #include <queue>
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -347,4 +348,135 @@ pcl::search::BruteForce<PointT>::radiusSearch (
   return sparseRadiusSearch (point, radius, k_indices, k_sqr_distances, max_nn);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::BruteForce<PointT>::nearestKSearch (
+    const PointCloud &cloud, const Indices &indices, int k,
+    Neighborhoods &neighborhoods, unsigned int nr_threads) const
+{
+  const std::size_t nr_points = indices_ ? indices_->size () : input_->size ();
+  auto search_block = [this, &cloud, &indices, k, nr_points] (std::size_t first, std::size_t last,
+                                                              Indices &block_indices, std::vector<float> &block_sqr_distances,
+                                                              std::size_t *counts)
+  {
+    // Number of queries compared to each point of the input cloud at once
+    const std::size_t query_tile_size = 32;
+    // One max-heap of the current k best entries per query of the tile
+    std::vector<std::vector<Entry> > heaps (query_tile_size);
+    for (auto &heap : heaps)
+      heap.reserve (std::max (k, 0));
+
+    for (std::size_t tile = first; tile < last; tile += query_tile_size)
+    {
+      const std::size_t tile_size = std::min (query_tile_size, last - tile);
+      for (std::size_t q = 0; q < tile_size; ++q)
+        heaps[q].clear ();
+      if (k < 1)
+      {
+        std::fill (counts + tile - first, counts + tile - first + tile_size, 0);
+        continue;
+      }
+
+      for (std::size_t i = 0; i < nr_points; ++i)
+      {
+        const index_t index = indices_ ? (*indices_)[i] : static_cast<index_t> (i);
+        const PointT &point = input_->points[index];
+        if (!input_->is_dense && !std::isfinite (point.x))
+          continue;
+
+        for (std::size_t q = 0; q < tile_size; ++q)
+        {
+          const PointT &query = indices.empty () ? cloud.points[tile + q] : cloud.points[indices[tile + q]];
+          const float distance = getDistSqr (point, query);
+          std::vector<Entry> &heap = heaps[q];
+          if (heap.size () < static_cast<std::size_t> (k))
+          {
+            heap.emplace_back (index, distance);
+            std::push_heap (heap.begin (), heap.end ());
+          }
+          else if (distance < heap.front ().distance)
+          {
+            std::pop_heap (heap.begin (), heap.end ());
+            heap.back () = Entry (index, distance);
+            std::push_heap (heap.begin (), heap.end ());
+          }
+        }
+      }
+
+      for (std::size_t q = 0; q < tile_size; ++q)
+      {
+        std::vector<Entry> &heap = heaps[q];
+        std::sort_heap (heap.begin (), heap.end ());
+        for (const auto &entry : heap)
+        {
+          block_indices.push_back (entry.index);
+          block_sqr_distances.push_back (entry.distance);
+        }
+        counts[tile + q - first] = heap.size ();
+      }
+    }
+  };
+  pcl::search::searchInBlocks (indices.empty () ? cloud.size () : indices.size (), nr_threads, search_block, neighborhoods);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::BruteForce<PointT>::radiusSearch (
+    const PointCloud &cloud, const Indices &indices, double radius,
+    Neighborhoods &neighborhoods, unsigned int max_nn, unsigned int nr_threads) const
+{
+  const std::size_t nr_points = indices_ ? indices_->size () : input_->size ();
+  const float sqr_radius = static_cast<float> (radius * radius);
+  auto search_block = [this, &cloud, &indices, sqr_radius, max_nn, nr_points] (std::size_t first, std::size_t last,
+                                                                               Indices &block_indices, std::vector<float> &block_sqr_distances,
+                                                                               std::size_t *counts)
+  {
+    // Number of queries compared to each point of the input cloud at once
+    const std::size_t query_tile_size = 32;
+    std::vector<Indices> tile_indices (query_tile_size);
+    std::vector<std::vector<float> > tile_sqr_distances (query_tile_size);
+
+    for (std::size_t tile = first; tile < last; tile += query_tile_size)
+    {
+      const std::size_t tile_size = std::min (query_tile_size, last - tile);
+      for (std::size_t q = 0; q < tile_size; ++q)
+      {
+        tile_indices[q].clear ();
+        tile_sqr_distances[q].clear ();
+      }
+
+      for (std::size_t i = 0; i < nr_points; ++i)
+      {
+        const index_t index = indices_ ? (*indices_)[i] : static_cast<index_t> (i);
+        const PointT &point = input_->points[index];
+        if (!input_->is_dense && !std::isfinite (point.x))
+          continue;
+
+        for (std::size_t q = 0; q < tile_size; ++q)
+        {
+          if (max_nn != 0 && tile_indices[q].size () == max_nn)
+            continue;
+          const PointT &query = indices.empty () ? cloud.points[tile + q] : cloud.points[indices[tile + q]];
+          const float distance = getDistSqr (point, query);
+          if (distance <= sqr_radius)
+          {
+            tile_indices[q].push_back (index);
+            tile_sqr_distances[q].push_back (distance);
+          }
+        }
+      }
+
+      for (std::size_t q = 0; q < tile_size; ++q)
+      {
+        if (sorted_results_)
+          this->sortResults (tile_indices[q], tile_sqr_distances[q]);
+        block_indices.insert (block_indices.end (), tile_indices[q].begin (), tile_indices[q].end ());
+        block_sqr_distances.insert (block_sqr_distances.end (), tile_sqr_distances[q].begin (), tile_sqr_distances[q].end ());
+        counts[tile + q - first] = tile_indices[q].size ();
+      }
+    }
+  };
+  pcl::search::searchInBlocks (indices.empty () ? cloud.size () : indices.size (), nr_threads, search_block, neighborhoods);
+}
+
 #define PCL_INSTANTIATE_BruteForce(T) template class PCL_EXPORTS pcl::search::BruteForce<T>;
@@ -0,0 +1,447 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SEARCH_BUCKET_KDTREE_IMPL_HPP_
+#define PCL_SEARCH_BUCKET_KDTREE_IMPL_HPP_
+
+#include <pcl/search/bucket_kdtree.h>
+#include <pcl/search/impl/search.hpp>
+#include <pcl/search/impl/neighbor_heap.hpp>
+#include <pcl/common/distances.h>
+#include <pcl/common/point_tests.h> // for pcl::isFinite
+
+#include <algorithm>
+#include <limits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+pcl::search::BucketKdTree<PointT>::BucketKdTree (bool sorted)
+  : pcl::search::Search<PointT> ("BucketKdTree", sorted)
+  , min_ {0.0f, 0.0f, 0.0f}
+  , max_ {0.0f, 0.0f, 0.0f}
+  , max_leaf_size_ (16)
+  , threads_ (1)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::BucketKdTree<PointT>::setMaxLeafSize (unsigned int max_leaf_size)
+{
+  max_leaf_size_ = std::min (std::max (max_leaf_size, 1u), 64u);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::BucketKdTree<PointT>::setNumberOfThreads (unsigned int nr_threads)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    threads_ = omp_get_num_procs ();
+#else
+    threads_ = 1;
+#endif
+  else
+    threads_ = nr_threads;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::BucketKdTree<PointT>::setInputCloud (
+    const PointCloudConstPtr& cloud,
+    const IndicesConstPtr& indices)
+{
+  input_ = cloud;
+  indices_ = indices;
+
+  nodes_.clear ();
+  nr_nodes_.clear ();
+  point_indices_.clear ();
+  x_.clear ();
+  y_.clear ();
+  z_.clear ();
+  std::fill (min_, min_ + 3, 0.0f);
+  std::fill (max_, max_ + 3, 0.0f);
+
+  if (!input_)
+    return;
+
+  // Only finite points are inserted in the tree
+  if (indices_)
+  {
+    point_indices_.reserve (indices_->size ());
+    for (const auto &index : *indices_)
+      if (isFinite (input_->points[index]))
+        point_indices_.push_back (index);
+  }
+  else
+  {
+    point_indices_.reserve (input_->points.size ());
+    for (std::size_t i = 0; i < input_->points.size (); ++i)
+      if (isFinite (input_->points[i]))
+        point_indices_.push_back (static_cast<index_t> (i));
+  }
+
+  if (point_indices_.empty ())
+    return;
+
+  // The node counts give the position of the right child of each inner node, so that
+  // the subtrees can be built independently
+  const std::size_t nr_points = point_indices_.size ();
+  nodes_.resize (countNodes (nr_points));
+
+#pragma omp parallel \
+  default(none) \
+  firstprivate(nr_points) \
+  num_threads(threads_)
+  {
+#pragma omp single nowait
+    buildSubtree (0, 0, nr_points);
+  }
+
+  // Store the coordinates of the points of each leaf contiguously
+  x_.resize (point_indices_.size ());
+  y_.resize (point_indices_.size ());
+  z_.resize (point_indices_.size ());
+  for (std::size_t i = 0; i < point_indices_.size (); ++i)
+  {
+    const PointT &point = input_->points[point_indices_[i]];
+    x_[i] = point.x;
+    y_[i] = point.y;
+    z_[i] = point.z;
+  }
+
+  std::copy (input_->points[point_indices_[0]].data, input_->points[point_indices_[0]].data + 3, min_);
+  std::copy (min_, min_ + 3, max_);
+  for (std::size_t i = 1; i < point_indices_.size (); ++i)
+  {
+    min_[0] = std::min (min_[0], x_[i]);
+    min_[1] = std::min (min_[1], y_[i]);
+    min_[2] = std::min (min_[2], z_[i]);
+    max_[0] = std::max (max_[0], x_[i]);
+    max_[1] = std::max (max_[1], y_[i]);
+    max_[2] = std::max (max_[2], z_[i]);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::search::BucketKdTree<PointT>::countNodes (std::size_t nr_points)
+{
+  const auto it = nr_nodes_.find (nr_points);
+  if (it != nr_nodes_.end ())
+    return (it->second);
+
+  std::size_t nr_nodes = 1;
+  if (nr_points > max_leaf_size_)
+    nr_nodes += countNodes (nr_points / 2) + countNodes (nr_points - nr_points / 2);
+  nr_nodes_[nr_points] = nr_nodes;
+  return (nr_nodes);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::BucketKdTree<PointT>::buildSubtree (std::size_t node, std::size_t begin, std::size_t end)
+{
+  const std::size_t size = end - begin;
+  if (size <= max_leaf_size_)
+  {
+    nodes_[node].dim = -static_cast<int> (size);
+    nodes_[node].first = static_cast<int> (begin);
+    nodes_[node].low = nodes_[node].high = 0.0f;
+    return;
+  }
+
+  // Split along the dimension of largest extent
+  Eigen::Array3f min_pt = input_->points[point_indices_[begin]].getArray3fMap ();
+  Eigen::Array3f max_pt = min_pt;
+  for (std::size_t i = begin + 1; i < end; ++i)
+  {
+    const Eigen::Array3f pt = input_->points[point_indices_[i]].getArray3fMap ();
+    min_pt = min_pt.min (pt);
+    max_pt = max_pt.max (pt);
+  }
+  int dim;
+  (max_pt - min_pt).maxCoeff (&dim);
+
+  // Split at the median, so that the shape of the tree only depends on the number of points
+  const std::size_t mid = begin + size / 2;
+  const auto &points = input_->points;
+  std::nth_element (point_indices_.begin () + begin, point_indices_.begin () + mid, point_indices_.begin () + end,
+                    [&points, dim] (index_t a, index_t b) { return (points[a].data[dim] < points[b].data[dim]); });
+
+  float low = -std::numeric_limits<float>::max ();
+  for (std::size_t i = begin; i < mid; ++i)
+    low = std::max (low, points[point_indices_[i]].data[dim]);
+
+  const std::size_t right = node + 1 + nr_nodes_.find (mid - begin)->second;
+  nodes_[node].dim = dim;
+  nodes_[node].first = static_cast<int> (right);
+  nodes_[node].low = low;
+  nodes_[node].high = points[point_indices_[mid]].data[dim];
+
+  // Large subtrees are built in parallel; the result does not depend on the number of threads
+#pragma omp task \
+  default(none) \
+  firstprivate(node, begin, mid) \
+  if(size > 4096)
+  buildSubtree (node + 1, begin, mid);
+  buildSubtree (right, mid, end);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::BucketKdTree<PointT>::computeLeafSqrDistances (
+    const Node &node, const float *query, float *sqr_distances) const
+{
+  PointCloudSoAConstView leaf;
+  leaf.x = x_.data () + node.first;
+  leaf.y = y_.data () + node.first;
+  leaf.z = z_.data () + node.first;
+  leaf.size = -node.dim;
+  squaredEuclideanDistances (leaf, Eigen::Vector3f (query[0], query[1], query[2]), sqr_distances);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> float
+pcl::search::BucketKdTree<PointT>::computeInitialSqrDistances (const float *query, float *cut_sqr_distances) const
+{
+  float min_sqr_distance = 0.0f;
+  for (int dim = 0; dim < 3; ++dim)
+  {
+    cut_sqr_distances[dim] = 0.0f;
+    if (query[dim] < min_[dim])
+      cut_sqr_distances[dim] = (min_[dim] - query[dim]) * (min_[dim] - query[dim]);
+    else if (query[dim] > max_[dim])
+      cut_sqr_distances[dim] = (query[dim] - max_[dim]) * (query[dim] - max_[dim]);
+    min_sqr_distance += cut_sqr_distances[dim];
+  }
+  return (min_sqr_distance);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::BucketKdTree<PointT>::searchKNearest (
+    std::size_t node, const float *query, float min_sqr_distance, float *cut_sqr_distances,
+    std::size_t k, float max_sqr_distance, index_t *heap_indices, float *heap_sqr_distances,
+    std::size_t &heap_size) const
+{
+  const Node &current = nodes_[node];
+  if (current.dim < 0)
+  {
+    float sqr_distances[64];
+    computeLeafSqrDistances (current, query, sqr_distances);
+    for (int i = 0; i < -current.dim; ++i)
+    {
+      if (heap_size < k)
+      {
+        if (sqr_distances[i] >= max_sqr_distance)
+          continue;
+        heap_indices[heap_size] = point_indices_[current.first + i];
+        heap_sqr_distances[heap_size] = sqr_distances[i];
+        detail::siftUpNeighbor (heap_indices, heap_sqr_distances, heap_size++);
+      }
+      else if (sqr_distances[i] < heap_sqr_distances[0])
+      {
+        heap_indices[0] = point_indices_[current.first + i];
+        heap_sqr_distances[0] = sqr_distances[i];
+        detail::siftDownNeighbor (heap_indices, heap_sqr_distances, 0, heap_size);
+      }
+    }
+    return;
+  }
+
+  // Descend first into the child on the side of the query, then into the other one if it
+  // may still hold closer points
+  const int dim = current.dim;
+  const float diff_low = query[dim] - current.low;
+  const float diff_high = query[dim] - current.high;
+  std::size_t best_child, other_child;
+  float cut_sqr_distance;
+  if (diff_low + diff_high < 0.0f)
+  {
+    best_child = node + 1;
+    other_child = current.first;
+    cut_sqr_distance = diff_high * diff_high;
+  }
+  else
+  {
+    best_child = current.first;
+    other_child = node + 1;
+    cut_sqr_distance = diff_low * diff_low;
+  }
+
+  searchKNearest (best_child, query, min_sqr_distance, cut_sqr_distances, k, max_sqr_distance,
+                  heap_indices, heap_sqr_distances, heap_size);
+
+  const float old_cut_sqr_distance = cut_sqr_distances[dim];
+  const float other_sqr_distance = min_sqr_distance + cut_sqr_distance - old_cut_sqr_distance;
+  if (heap_size < k ? other_sqr_distance < max_sqr_distance : other_sqr_distance < heap_sqr_distances[0])
+  {
+    cut_sqr_distances[dim] = cut_sqr_distance;
+    searchKNearest (other_child, query, other_sqr_distance, cut_sqr_distances, k, max_sqr_distance,
+                    heap_indices, heap_sqr_distances, heap_size);
+    cut_sqr_distances[dim] = old_cut_sqr_distance;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::BucketKdTree<PointT>::searchRadius (
+    std::size_t node, const float *query, float min_sqr_distance, float *cut_sqr_distances,
+    float sqr_radius, Indices &k_indices, std::vector<float> &k_sqr_distances) const
+{
+  const Node &current = nodes_[node];
+  if (current.dim < 0)
+  {
+    float sqr_distances[64];
+    computeLeafSqrDistances (current, query, sqr_distances);
+    for (int i = 0; i < -current.dim; ++i)
+      if (sqr_distances[i] < sqr_radius)
+      {
+        k_indices.push_back (point_indices_[current.first + i]);
+        k_sqr_distances.push_back (sqr_distances[i]);
+      }
+    return;
+  }
+
+  const int dim = current.dim;
+  const float diff_low = query[dim] - current.low;
+  const float diff_high = query[dim] - current.high;
+  std::size_t best_child, other_child;
+  float cut_sqr_distance;
+  if (diff_low + diff_high < 0.0f)
+  {
+    best_child = node + 1;
+    other_child = current.first;
+    cut_sqr_distance = diff_high * diff_high;
+  }
+  else
+  {
+    best_child = current.first;
+    other_child = node + 1;
+    cut_sqr_distance = diff_low * diff_low;
+  }
+
+  searchRadius (best_child, query, min_sqr_distance, cut_sqr_distances, sqr_radius, k_indices, k_sqr_distances);
+
+  const float old_cut_sqr_distance = cut_sqr_distances[dim];
+  const float other_sqr_distance = min_sqr_distance + cut_sqr_distance - old_cut_sqr_distance;
+  if (other_sqr_distance < sqr_radius)
+  {
+    cut_sqr_distances[dim] = cut_sqr_distance;
+    searchRadius (other_child, query, other_sqr_distance, cut_sqr_distances, sqr_radius, k_indices, k_sqr_distances);
+    cut_sqr_distances[dim] = old_cut_sqr_distance;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::BucketKdTree<PointT>::nearestKSearch (
+    const PointT &point, int k, Indices &k_indices, std::vector<float> &k_sqr_distances) const
+{
+  assert (isFinite (point) && "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
+
+  const std::size_t nr_neighbors = std::min (static_cast<std::size_t> (std::max (k, 0)), point_indices_.size ());
+  k_indices.resize (nr_neighbors);
+  k_sqr_distances.resize (nr_neighbors);
+  if (nr_neighbors == 0)
+    return (0);
+
+  const float query[3] = {point.x, point.y, point.z};
+  float cut_sqr_distances[3];
+  const float min_sqr_distance = computeInitialSqrDistances (query, cut_sqr_distances);
+
+  std::size_t heap_size = 0;
+  searchKNearest (0, query, min_sqr_distance, cut_sqr_distances, nr_neighbors, std::numeric_limits<float>::infinity (),
+                  k_indices.data (), k_sqr_distances.data (), heap_size);
+  detail::sortNeighborHeap (k_indices.data (), k_sqr_distances.data (), heap_size);
+  return (static_cast<int> (heap_size));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::BucketKdTree<PointT>::radiusSearch (
+    const PointT& point, double radius, Indices &k_indices,
+    std::vector<float> &k_sqr_distances, unsigned int max_nn) const
+{
+  assert (isFinite (point) && "Invalid (NaN, Inf) point coordinates given to radiusSearch!");
+
+  k_indices.clear ();
+  k_sqr_distances.clear ();
+  if (point_indices_.empty ())
+    return (0);
+
+  const float query[3] = {point.x, point.y, point.z};
+  const float sqr_radius = static_cast<float> (radius * radius);
+  float cut_sqr_distances[3];
+  const float min_sqr_distance = computeInitialSqrDistances (query, cut_sqr_distances);
+  if (min_sqr_distance >= sqr_radius)
+    return (0);
+
+  if (max_nn > 0 && max_nn < point_indices_.size ())
+  {
+    // Keep the max_nn closest neighbors in radius
+    k_indices.resize (max_nn);
+    k_sqr_distances.resize (max_nn);
+    std::size_t heap_size = 0;
+    searchKNearest (0, query, min_sqr_distance, cut_sqr_distances, max_nn, sqr_radius,
+                    k_indices.data (), k_sqr_distances.data (), heap_size);
+    detail::sortNeighborHeap (k_indices.data (), k_sqr_distances.data (), heap_size);
+    k_indices.resize (heap_size);
+    k_sqr_distances.resize (heap_size);
+    return (static_cast<int> (heap_size));
+  }
+
+  searchRadius (0, query, min_sqr_distance, cut_sqr_distances, sqr_radius, k_indices, k_sqr_distances);
+
+  if (sorted_results_)
+  {
+    for (std::size_t i = k_indices.size () / 2; i-- > 0; )
+      detail::siftDownNeighbor (k_indices.data (), k_sqr_distances.data (), i, k_indices.size ());
+    detail::sortNeighborHeap (k_indices.data (), k_sqr_distances.data (), k_indices.size ());
+  }
+  return (static_cast<int> (k_indices.size ()));
+}
+
+#define PCL_INSTANTIATE_BucketKdTree(T) template class PCL_EXPORTS pcl::search::BucketKdTree<T>;
+
+#endif  //#ifndef PCL_SEARCH_BUCKET_KDTREE_IMPL_HPP_
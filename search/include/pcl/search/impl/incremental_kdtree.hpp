@@ -0,0 +1,591 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SEARCH_INCREMENTAL_KDTREE_IMPL_HPP_
+#define PCL_SEARCH_INCREMENTAL_KDTREE_IMPL_HPP_
+
+#include <pcl/search/incremental_kdtree.h>
+#include <pcl/search/impl/search.hpp>
+#include <pcl/search/impl/neighbor_heap.hpp>
+#include <pcl/common/point_tests.h> // for pcl::isFinite
+
+#include <algorithm>
+#include <limits>
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT>
+pcl::search::IncrementalKdTree<PointT>::IncrementalKdTree (bool sorted)
+  : pcl::search::Search<PointT> ("IncrementalKdTree", sorted)
+  , root_ (-1)
+  , balance_threshold_ (0.7f)
+  , deleted_threshold_ (0.5f)
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::setBalanceThreshold (float balance_threshold)
+{
+  balance_threshold_ = std::min (std::max (balance_threshold, 0.5f), 1.0f);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::setDeletedThreshold (float deleted_threshold)
+{
+  deleted_threshold_ = std::min (std::max (deleted_threshold, 0.0f), 1.0f);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::setInputCloud (
+    const PointCloudConstPtr& cloud,
+    const IndicesConstPtr& indices)
+{
+  nodes_.clear ();
+  free_nodes_.clear ();
+  point_nodes_.clear ();
+  root_ = -1;
+
+  if (!cloud)
+  {
+    cloud_.reset ();
+    input_.reset ();
+    indices_copy_.reset ();
+    indices_.reset ();
+    return;
+  }
+  cloud_.reset (new PointCloud (*cloud));
+  input_ = cloud_;
+  if (indices)
+    indices_copy_.reset (new Indices (*indices));
+  else
+    indices_copy_.reset ();
+  indices_ = indices_copy_;
+  point_nodes_.assign (cloud_->points.size (), -1);
+
+  // Only finite points are inserted in the tree
+  rebuild_indices_.clear ();
+  if (indices_)
+  {
+    rebuild_indices_.reserve (indices_->size ());
+    for (const auto &index : *indices_)
+      if (isFinite (cloud_->points[index]))
+        rebuild_indices_.push_back (index);
+  }
+  else
+  {
+    rebuild_indices_.reserve (cloud_->points.size ());
+    for (std::size_t i = 0; i < cloud_->points.size (); ++i)
+      if (isFinite (cloud_->points[i]))
+        rebuild_indices_.push_back (static_cast<index_t> (i));
+  }
+  nodes_.reserve (rebuild_indices_.size ());
+  root_ = buildSubtree (rebuild_indices_.begin (), rebuild_indices_.end (), -1);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::addPoints (const PointCloud &cloud)
+{
+  if (!cloud_)
+  {
+    cloud_.reset (new PointCloud);
+    input_ = cloud_;
+  }
+
+  const auto first = static_cast<index_t> (cloud_->points.size ());
+  cloud_->points.insert (cloud_->points.end (), cloud.points.begin (), cloud.points.end ());
+  cloud_->width = static_cast<std::uint32_t> (cloud_->points.size ());
+  cloud_->height = 1;
+  cloud_->is_dense = cloud_->is_dense && cloud.is_dense;
+  point_nodes_.resize (cloud_->points.size (), -1);
+
+  const auto last = static_cast<index_t> (cloud_->points.size ());
+  if (indices_copy_)
+    for (index_t i = first; i < last; ++i)
+      indices_copy_->push_back (i);
+
+  // An empty tree is built at once, with the points balanced
+  if (root_ < 0)
+  {
+    rebuild_indices_.clear ();
+    for (index_t i = first; i < last; ++i)
+      if (isFinite (cloud_->points[i]))
+        rebuild_indices_.push_back (i);
+    root_ = buildSubtree (rebuild_indices_.begin (), rebuild_indices_.end (), -1);
+    return;
+  }
+
+  for (index_t i = first; i < last; ++i)
+    insertPoint (i);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::search::IncrementalKdTree<PointT>::removePoints (const Indices &indices)
+{
+  std::size_t nr_removed = 0;
+  for (const auto &index : indices)
+  {
+    if (index < 0 || static_cast<std::size_t> (index) >= point_nodes_.size () || point_nodes_[index] < 0)
+      continue;
+    deleteNode (point_nodes_[index]);
+    ++nr_removed;
+  }
+  return (nr_removed);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::search::IncrementalKdTree<PointT>::removeBox (const Eigen::Vector3f &min_pt, const Eigen::Vector3f &max_pt)
+{
+  return (removeBoxSubtree (root_, min_pt.data (), max_pt.data ()));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::IncrementalKdTree<PointT>::allocateNode ()
+{
+  if (free_nodes_.empty ())
+  {
+    nodes_.emplace_back ();
+    return (static_cast<int> (nodes_.size ()) - 1);
+  }
+  const int node = free_nodes_.back ();
+  free_nodes_.pop_back ();
+  return (node);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::IncrementalKdTree<PointT>::buildSubtree (Indices::iterator begin, Indices::iterator end, int parent)
+{
+  if (begin == end)
+    return (-1);
+
+  // The bounding box of the points is also the one of the subtree
+  float min[3], max[3];
+  std::copy (cloud_->points[*begin].data, cloud_->points[*begin].data + 3, min);
+  std::copy (min, min + 3, max);
+  for (auto it = begin + 1; it != end; ++it)
+  {
+    const float *xyz = cloud_->points[*it].data;
+    for (int d = 0; d < 3; ++d)
+    {
+      min[d] = std::min (min[d], xyz[d]);
+      max[d] = std::max (max[d], xyz[d]);
+    }
+  }
+
+  // Split at the median of the widest dimension
+  int dim = 0;
+  for (int d = 1; d < 3; ++d)
+    if (max[d] - min[d] > max[dim] - min[dim])
+      dim = d;
+  const auto middle = begin + (end - begin) / 2;
+  std::nth_element (begin, middle, end, [this, dim] (index_t a, index_t b)
+  {
+    return (cloud_->points[a].data[dim] < cloud_->points[b].data[dim]);
+  });
+
+  const int node = allocateNode ();
+  {
+    Node &current = nodes_[node];
+    current.point = *middle;
+    std::copy (cloud_->points[*middle].data, cloud_->points[*middle].data + 3, current.xyz);
+    current.dim = dim;
+    current.parent = parent;
+    current.size = static_cast<int> (end - begin);
+    current.nr_deleted = 0;
+    current.deleted = false;
+    std::copy (min, min + 3, current.min);
+    std::copy (max, max + 3, current.max);
+  }
+  point_nodes_[*middle] = node;
+
+  // The nodes may be reallocated while building the children
+  const int left = buildSubtree (begin, middle, node);
+  const int right = buildSubtree (middle + 1, end, node);
+  nodes_[node].left = left;
+  nodes_[node].right = right;
+  return (node);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::flattenSubtree (int node)
+{
+  if (node < 0)
+    return;
+  const Node &current = nodes_[node];
+  flattenSubtree (current.left);
+  if (!current.deleted)
+    rebuild_indices_.push_back (current.point);
+  flattenSubtree (current.right);
+  free_nodes_.push_back (node);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::rebuildSubtree (int node)
+{
+  const int parent = nodes_[node].parent;
+  rebuild_indices_.clear ();
+  flattenSubtree (node);
+  const int new_node = buildSubtree (rebuild_indices_.begin (), rebuild_indices_.end (), parent);
+
+  if (parent < 0)
+  {
+    root_ = new_node;
+    return;
+  }
+  if (nodes_[parent].left == node)
+    nodes_[parent].left = new_node;
+  else
+    nodes_[parent].right = new_node;
+
+  // The deleted nodes are gone from the ancestors
+  for (int ancestor = parent; ancestor >= 0; ancestor = nodes_[ancestor].parent)
+    pullUp (ancestor);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::pullUp (int node)
+{
+  Node &current = nodes_[node];
+  current.size = 1;
+  current.nr_deleted = current.deleted ? 1 : 0;
+  if (current.deleted)
+  {
+    std::fill (current.min, current.min + 3, std::numeric_limits<float>::max ());
+    std::fill (current.max, current.max + 3, std::numeric_limits<float>::lowest ());
+  }
+  else
+  {
+    std::copy (current.xyz, current.xyz + 3, current.min);
+    std::copy (current.xyz, current.xyz + 3, current.max);
+  }
+
+  for (const int child : {current.left, current.right})
+  {
+    if (child < 0)
+      continue;
+    const Node &child_node = nodes_[child];
+    current.size += child_node.size;
+    current.nr_deleted += child_node.nr_deleted;
+    if (child_node.nr_deleted == child_node.size)
+      continue;
+    for (int d = 0; d < 3; ++d)
+    {
+      current.min[d] = std::min (current.min[d], child_node.min[d]);
+      current.max[d] = std::max (current.max[d], child_node.max[d]);
+    }
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> bool
+pcl::search::IncrementalKdTree<PointT>::isUnbalanced (int node) const
+{
+  // Small subtrees are cheap to search either way
+  constexpr int min_size = 16;
+  const Node &current = nodes_[node];
+  if (current.size < min_size)
+    return (false);
+  if (static_cast<float> (current.nr_deleted) > deleted_threshold_ * static_cast<float> (current.size))
+    return (true);
+  const int left_size = current.left < 0 ? 0 : nodes_[current.left].size;
+  const int right_size = current.right < 0 ? 0 : nodes_[current.right].size;
+  return (static_cast<float> (std::max (left_size, right_size)) > balance_threshold_ * static_cast<float> (current.size));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::rebalancePath (int node)
+{
+  path_.clear ();
+  for (; node >= 0; node = nodes_[node].parent)
+    path_.push_back (node);
+  for (auto it = path_.rbegin (); it != path_.rend (); ++it)
+    if (isUnbalanced (*it))
+    {
+      rebuildSubtree (*it);
+      return;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::insertPoint (index_t index)
+{
+  const PointT &point = cloud_->points[index];
+  if (!isFinite (point))
+    return;
+
+  const int leaf = allocateNode ();
+  {
+    Node &current = nodes_[leaf];
+    current.point = index;
+    std::copy (point.data, point.data + 3, current.xyz);
+    current.left = current.right = -1;
+    current.size = 1;
+    current.nr_deleted = 0;
+    current.deleted = false;
+    std::copy (point.data, point.data + 3, current.min);
+    std::copy (point.data, point.data + 3, current.max);
+  }
+  point_nodes_[index] = leaf;
+
+  if (root_ < 0)
+  {
+    nodes_[leaf].dim = 0;
+    nodes_[leaf].parent = -1;
+    root_ = leaf;
+    return;
+  }
+
+  // Descend to the insertion place, growing the subtrees on the way
+  int node = root_;
+  while (true)
+  {
+    Node &current = nodes_[node];
+    ++current.size;
+    for (int d = 0; d < 3; ++d)
+    {
+      current.min[d] = std::min (current.min[d], point.data[d]);
+      current.max[d] = std::max (current.max[d], point.data[d]);
+    }
+    int &child = point.data[current.dim] < current.xyz[current.dim] ? current.left : current.right;
+    if (child < 0)
+    {
+      child = leaf;
+      nodes_[leaf].dim = (current.dim + 1) % 3;
+      nodes_[leaf].parent = node;
+      break;
+    }
+    node = child;
+  }
+  rebalancePath (leaf);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::deleteNode (int node)
+{
+  nodes_[node].deleted = true;
+  point_nodes_[nodes_[node].point] = -1;
+  for (int ancestor = node; ancestor >= 0; ancestor = nodes_[ancestor].parent)
+    pullUp (ancestor);
+  rebalancePath (node);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> std::size_t
+pcl::search::IncrementalKdTree<PointT>::removeBoxSubtree (int node, const float *min_pt, const float *max_pt)
+{
+  if (node < 0)
+    return (0);
+  const Node &current = nodes_[node];
+  if (current.nr_deleted == current.size)
+    return (0);
+  for (int d = 0; d < 3; ++d)
+    if (current.max[d] < min_pt[d] || current.min[d] > max_pt[d])
+      return (0);
+
+  std::size_t nr_removed = 0;
+  if (!current.deleted &&
+      current.xyz[0] >= min_pt[0] && current.xyz[0] <= max_pt[0] &&
+      current.xyz[1] >= min_pt[1] && current.xyz[1] <= max_pt[1] &&
+      current.xyz[2] >= min_pt[2] && current.xyz[2] <= max_pt[2])
+  {
+    nodes_[node].deleted = true;
+    point_nodes_[current.point] = -1;
+    ++nr_removed;
+  }
+  const int left = current.left;
+  const int right = current.right;
+  nr_removed += removeBoxSubtree (left, min_pt, max_pt);
+  nr_removed += removeBoxSubtree (right, min_pt, max_pt);
+
+  if (nr_removed > 0)
+  {
+    pullUp (node);
+    if (isUnbalanced (node))
+      rebuildSubtree (node);
+  }
+  return (nr_removed);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::searchKNearest (
+    int node, const float *query, std::size_t k, float max_sqr_distance,
+    index_t *heap_indices, float *heap_sqr_distances, std::size_t &heap_size) const
+{
+  const Node &current = nodes_[node];
+  if (!current.deleted)
+  {
+    float sqr_distance = 0.0f;
+    for (int d = 0; d < 3; ++d)
+      sqr_distance += (query[d] - current.xyz[d]) * (query[d] - current.xyz[d]);
+    if (heap_size < k)
+    {
+      if (sqr_distance < max_sqr_distance)
+      {
+        heap_indices[heap_size] = current.point;
+        heap_sqr_distances[heap_size] = sqr_distance;
+        detail::siftUpNeighbor (heap_indices, heap_sqr_distances, heap_size++);
+      }
+    }
+    else if (sqr_distance < heap_sqr_distances[0])
+    {
+      heap_indices[0] = current.point;
+      heap_sqr_distances[0] = sqr_distance;
+      detail::siftDownNeighbor (heap_indices, heap_sqr_distances, 0, heap_size);
+    }
+  }
+
+  // Descend first into the child whose bounding box is the closest
+  int children[2] = {current.left, current.right};
+  float child_sqr_distances[2];
+  for (int i = 0; i < 2; ++i)
+    child_sqr_distances[i] = (children[i] < 0 || nodes_[children[i]].nr_deleted == nodes_[children[i]].size) ?
+                             std::numeric_limits<float>::infinity () : getBoxSqrDistance (nodes_[children[i]], query);
+  if (child_sqr_distances[1] < child_sqr_distances[0])
+  {
+    std::swap (children[0], children[1]);
+    std::swap (child_sqr_distances[0], child_sqr_distances[1]);
+  }
+  for (int i = 0; i < 2; ++i)
+    if (heap_size < k ? child_sqr_distances[i] < max_sqr_distance : child_sqr_distances[i] < heap_sqr_distances[0])
+      searchKNearest (children[i], query, k, max_sqr_distance, heap_indices, heap_sqr_distances, heap_size);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::IncrementalKdTree<PointT>::searchRadius (
+    int node, const float *query, float sqr_radius, Indices &k_indices, std::vector<float> &k_sqr_distances) const
+{
+  const Node &current = nodes_[node];
+  if (!current.deleted)
+  {
+    float sqr_distance = 0.0f;
+    for (int d = 0; d < 3; ++d)
+      sqr_distance += (query[d] - current.xyz[d]) * (query[d] - current.xyz[d]);
+    if (sqr_distance < sqr_radius)
+    {
+      k_indices.push_back (current.point);
+      k_sqr_distances.push_back (sqr_distance);
+    }
+  }
+
+  for (const int child : {current.left, current.right})
+    if (child >= 0 && nodes_[child].nr_deleted < nodes_[child].size &&
+        getBoxSqrDistance (nodes_[child], query) < sqr_radius)
+      searchRadius (child, query, sqr_radius, k_indices, k_sqr_distances);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::IncrementalKdTree<PointT>::nearestKSearch (
+    const PointT &point, int k, Indices &k_indices, std::vector<float> &k_sqr_distances) const
+{
+  assert (isFinite (point) && "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
+
+  const std::size_t nr_neighbors = std::min (static_cast<std::size_t> (std::max (k, 0)), getNumberOfPoints ());
+  k_indices.resize (nr_neighbors);
+  k_sqr_distances.resize (nr_neighbors);
+  if (nr_neighbors == 0)
+    return (0);
+
+  const float query[3] = {point.x, point.y, point.z};
+  std::size_t heap_size = 0;
+  searchKNearest (root_, query, nr_neighbors, std::numeric_limits<float>::infinity (),
+                  k_indices.data (), k_sqr_distances.data (), heap_size);
+  detail::sortNeighborHeap (k_indices.data (), k_sqr_distances.data (), heap_size);
+  return (static_cast<int> (heap_size));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::IncrementalKdTree<PointT>::radiusSearch (
+    const PointT& point, double radius, Indices &k_indices,
+    std::vector<float> &k_sqr_distances, unsigned int max_nn) const
+{
+  assert (isFinite (point) && "Invalid (NaN, Inf) point coordinates given to radiusSearch!");
+
+  k_indices.clear ();
+  k_sqr_distances.clear ();
+  const std::size_t nr_points = getNumberOfPoints ();
+  if (nr_points == 0)
+    return (0);
+
+  const float query[3] = {point.x, point.y, point.z};
+  const float sqr_radius = static_cast<float> (radius * radius);
+  // Like BucketKdTree, the points exactly on the sphere are not neighbors
+  if (getBoxSqrDistance (nodes_[root_], query) >= sqr_radius)
+    return (0);
+
+  if (max_nn > 0 && max_nn < nr_points)
+  {
+    // Keep the max_nn closest neighbors in radius
+    k_indices.resize (max_nn);
+    k_sqr_distances.resize (max_nn);
+    std::size_t heap_size = 0;
+    searchKNearest (root_, query, max_nn, sqr_radius, k_indices.data (), k_sqr_distances.data (), heap_size);
+    detail::sortNeighborHeap (k_indices.data (), k_sqr_distances.data (), heap_size);
+    k_indices.resize (heap_size);
+    k_sqr_distances.resize (heap_size);
+    return (static_cast<int> (heap_size));
+  }
+
+  searchRadius (root_, query, sqr_radius, k_indices, k_sqr_distances);
+
+  if (sorted_results_)
+  {
+    for (std::size_t i = k_indices.size () / 2; i-- > 0; )
+      detail::siftDownNeighbor (k_indices.data (), k_sqr_distances.data (), i, k_indices.size ());
+    detail::sortNeighborHeap (k_indices.data (), k_sqr_distances.data (), k_indices.size ());
+  }
+  return (static_cast<int> (k_indices.size ()));
+}
+
+#define PCL_INSTANTIATE_IncrementalKdTree(T) template class PCL_EXPORTS pcl::search::IncrementalKdTree<T>;
+
+#endif  //#ifndef PCL_SEARCH_INCREMENTAL_KDTREE_IMPL_HPP_
@@ -41,6 +41,8 @@
 #include <pcl/search/kdtree.h>
 #include <pcl/search/impl/search.hpp>
 
+#include <algorithm>
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT, class Tree>
 pcl::search::KdTree<PointT,Tree>::KdTree (bool sorted)
@@ -102,6 +104,77 @@ pcl::search::KdTree<PointT,Tree>::radiusSearch (
   return (tree_->radiusSearch (point, radius, k_indices, k_sqr_distances, max_nn));
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, class Tree> int
+pcl::search::KdTree<PointT,Tree>::nearestKSearch (
+    const PointT &point, int k, NeighborBuffer &neighbors) const
+{
+  neighbors.resize (std::max (k, 0));
+  const int nr_neighbors = tree_->nearestKSearch (point, k, neighbors.indices.data (), neighbors.sqr_distances.data ());
+  neighbors.resize (nr_neighbors);
+  return (nr_neighbors);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, class Tree> int
+pcl::search::KdTree<PointT,Tree>::radiusSearch (
+    const PointT &point, double radius, NeighborBuffer &neighbors,
+    unsigned int max_nn) const
+{
+  // FLANN writes into caller-provided arrays through a bounded result set, whose order only matches the one of
+  // the std::vector based search once sorted
+  if (sorted_results_)
+  {
+    unsigned int capacity = static_cast<unsigned int> (neighbors.capacity ());
+    if (max_nn != 0)
+      capacity = std::min (capacity, max_nn);
+    if (capacity != 0)
+    {
+      neighbors.resize (capacity);
+      const int nr_neighbors = tree_->radiusSearch (point, radius, neighbors.indices.data (),
+                                                    neighbors.sqr_distances.data (), capacity);
+      // The result is complete if it did not fill the buffer, or if it holds as many neighbors as requested
+      if (nr_neighbors < static_cast<int> (capacity) || capacity == max_nn)
+      {
+        neighbors.resize (nr_neighbors);
+        return (nr_neighbors);
+      }
+    }
+  }
+
+  const int nr_neighbors = tree_->radiusSearch (point, radius, neighbors.indices, neighbors.sqr_distances, max_nn);
+  // One more slot than needed, so that the same number of neighbors does not fill the buffer next time
+  neighbors.reserve (neighbors.size () + 1);
+  return (nr_neighbors);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, class Tree> void
+pcl::search::KdTree<PointT,Tree>::nearestKSearch (
+    const PointCloud &cloud, const Indices &indices, int k,
+    Neighborhoods &neighborhoods, unsigned int nr_threads) const
+{
+  const std::size_t nr_queries = indices.empty () ? cloud.points.size () : indices.size ();
+  const int nr_neighbors = tree_->nearestKSearch (cloud, indices, k, neighborhoods.indices,
+                                                  neighborhoods.sqr_distances, nr_threads);
+  neighborhoods.offsets.resize (nr_queries + 1);
+  for (std::size_t i = 0; i <= nr_queries; ++i)
+    neighborhoods.offsets[i] = i * nr_neighbors;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT, class Tree> void
+pcl::search::KdTree<PointT,Tree>::radiusSearch (
+    const PointCloud &cloud, const Indices &indices, double radius,
+    Neighborhoods &neighborhoods, unsigned int max_nn, unsigned int nr_threads) const
+{
+  auto search_query = [this, radius, max_nn] (const PointT &point, NeighborBuffer &neighbors)
+  {
+    return (radiusSearch (point, radius, neighbors, max_nn));
+  };
+  this->searchQueries (cloud, indices, nr_threads, search_query, neighborhoods);
+}
+
 #define PCL_INSTANTIATE_KdTree(T) template class PCL_EXPORTS pcl::search::KdTree<T>;
 
 #endif  //#ifndef _PCL_SEARCH_KDTREE_IMPL_HPP_
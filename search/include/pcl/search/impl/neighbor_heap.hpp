@@ -0,0 +1,108 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef PCL_SEARCH_NEIGHBOR_HEAP_IMPL_HPP_
+#define PCL_SEARCH_NEIGHBOR_HEAP_IMPL_HPP_
+
+#include <pcl/types.h>
+
+#include <cstddef>
+#include <utility>
+
+namespace pcl
+{
+  namespace search
+  {
+    namespace detail
+    {
+      /** \brief Restore the max-heap property of the neighbors below a given position.
+        * The indices and squared distances are permuted together.
+        */
+      inline void
+      siftDownNeighbor (index_t *indices, float *sqr_distances, std::size_t pos, std::size_t size)
+      {
+        const index_t index = indices[pos];
+        const float sqr_distance = sqr_distances[pos];
+        for (std::size_t child = 2 * pos + 1; child < size; child = 2 * pos + 1)
+        {
+          if (child + 1 < size && sqr_distances[child + 1] > sqr_distances[child])
+            ++child;
+          if (sqr_distances[child] <= sqr_distance)
+            break;
+          indices[pos] = indices[child];
+          sqr_distances[pos] = sqr_distances[child];
+          pos = child;
+        }
+        indices[pos] = index;
+        sqr_distances[pos] = sqr_distance;
+      }
+
+      /** \brief Restore the max-heap property of the neighbors above a given position. */
+      inline void
+      siftUpNeighbor (index_t *indices, float *sqr_distances, std::size_t pos)
+      {
+        const index_t index = indices[pos];
+        const float sqr_distance = sqr_distances[pos];
+        while (pos > 0)
+        {
+          const std::size_t parent = (pos - 1) / 2;
+          if (sqr_distances[parent] >= sqr_distance)
+            break;
+          indices[pos] = indices[parent];
+          sqr_distances[pos] = sqr_distances[parent];
+          pos = parent;
+        }
+        indices[pos] = index;
+        sqr_distances[pos] = sqr_distance;
+      }
+
+      /** \brief Sort neighbors forming a max-heap by increasing squared distance, in place. */
+      inline void
+      sortNeighborHeap (index_t *indices, float *sqr_distances, std::size_t size)
+      {
+        for (std::size_t end = size; end > 1; --end)
+        {
+          std::swap (indices[0], indices[end - 1]);
+          std::swap (sqr_distances[0], sqr_distances[end - 1]);
+          siftDownNeighbor (indices, sqr_distances, 0, end - 1);
+        }
+      }
+    }
+  }
+}
+
+#endif  //#ifndef PCL_SEARCH_NEIGHBOR_HEAP_IMPL_HPP_
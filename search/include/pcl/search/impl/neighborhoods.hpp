@@ -0,0 +1,111 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/search/neighborhoods.h>
+
+#include <algorithm>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename BlockSearch> void
+pcl::search::searchInBlocks (std::size_t nr_queries, unsigned int nr_threads,
+                             const BlockSearch &search_block, Neighborhoods &neighborhoods)
+{
+  if (nr_threads == 0)
+#ifdef _OPENMP
+    nr_threads = omp_get_num_procs ();
+#else
+    nr_threads = 1;
+#endif
+
+  neighborhoods.offsets.assign (nr_queries + 1, 0);
+  neighborhoods.indices.clear ();
+  neighborhoods.sqr_distances.clear ();
+  if (nr_queries == 0)
+    return;
+
+  // A single thread writes directly into the output vectors
+  if (nr_threads == 1)
+  {
+    search_block (0, nr_queries, neighborhoods.indices, neighborhoods.sqr_distances, neighborhoods.offsets.data () + 1);
+    for (std::size_t i = 0; i < nr_queries; ++i)
+      neighborhoods.offsets[i + 1] += neighborhoods.offsets[i];
+    return;
+  }
+
+  // A few blocks per thread balance the load when the number of neighbors varies between queries. The
+  // number of blocks is recomputed from the block size, so that none of them is empty
+  const std::size_t block_size = (nr_queries + 8 * nr_threads - 1) / (8 * nr_threads);
+  const std::ptrdiff_t nr_blocks = static_cast<std::ptrdiff_t> ((nr_queries + block_size - 1) / block_size);
+  std::vector<Indices> block_indices (nr_blocks);
+  std::vector<std::vector<float> > block_sqr_distances (nr_blocks);
+
+#pragma omp parallel for \
+  default(none) \
+  shared(block_indices, block_sqr_distances, neighborhoods, search_block) \
+  firstprivate(block_size, nr_blocks, nr_queries) \
+  schedule(dynamic) \
+  num_threads(nr_threads)
+  for (std::ptrdiff_t b = 0; b < nr_blocks; ++b)
+  {
+    const std::size_t first = b * block_size;
+    const std::size_t last = std::min (nr_queries, first + block_size);
+    search_block (first, last, block_indices[b], block_sqr_distances[b], neighborhoods.offsets.data () + first + 1);
+  }
+
+  for (std::size_t i = 0; i < nr_queries; ++i)
+    neighborhoods.offsets[i + 1] += neighborhoods.offsets[i];
+  neighborhoods.indices.resize (neighborhoods.offsets.back ());
+  neighborhoods.sqr_distances.resize (neighborhoods.offsets.back ());
+
+#pragma omp parallel for \
+  default(none) \
+  shared(block_indices, block_sqr_distances, neighborhoods) \
+  firstprivate(block_size, nr_blocks) \
+  num_threads(nr_threads)
+  for (std::ptrdiff_t b = 0; b < nr_blocks; ++b)
+  {
+    const std::size_t first = b * block_size;
+    std::copy (block_indices[b].begin (), block_indices[b].end (), neighborhoods.indices.begin () + neighborhoods.offsets[first]);
+    std::copy (block_sqr_distances[b].begin (), block_sqr_distances[b].end (), neighborhoods.sqr_distances.begin () + neighborhoods.offsets[first]);
+  }
+}
@@ -56,26 +56,71 @@ pcl::search::OrganizedNeighbor<PointT>::radiusSearch (const               PointT
   // NAN test
   assert (isFinite (query) && "Invalid (NaN, Inf) point coordinates given to nearestKSearch!");
 
-  // search window
-  unsigned left, right, top, bottom;
-  //unsigned x, y, idx;
-  float squared_distance;
-  double squared_radius;
-
   k_indices.clear ();
   k_sqr_distances.clear ();
 
-  squared_radius = radius * radius;
-
-  this->getProjectedRadiusSearchBox (query, static_cast<float> (squared_radius), left, right, top, bottom);
-
-  // iterate over search box
   if (max_nn == 0 || max_nn >= static_cast<unsigned int> (input_->points.size ()))
     max_nn = static_cast<unsigned int> (input_->points.size ());
 
   k_indices.reserve (max_nn);
   k_sqr_distances.reserve (max_nn);
 
+  appendRadiusNeighbors (query, radius * radius, max_nn, k_indices, k_sqr_distances);
+  if (sorted_results_)
+    this->sortResults (k_indices, k_sqr_distances);
+  return (static_cast<int> (k_indices.size ()));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> void
+pcl::search::OrganizedNeighbor<PointT>::radiusSearch (const PointCloud &cloud,
+                                                      const Indices &indices,
+                                                      double radius,
+                                                      Neighborhoods &neighborhoods,
+                                                      unsigned int max_nn,
+                                                      unsigned int nr_threads) const
+{
+  const double squared_radius = radius * radius;
+  if (max_nn == 0 || max_nn >= static_cast<unsigned int> (input_->points.size ()))
+    max_nn = static_cast<unsigned int> (input_->points.size ());
+
+  auto search_block = [this, &cloud, &indices, squared_radius, max_nn] (std::size_t first, std::size_t last,
+                                                                        Indices &block_indices,
+                                                                        std::vector<float> &block_sqr_distances,
+                                                                        std::size_t *counts)
+  {
+    // Reused by all the queries of the block to sort their neighbors
+    std::vector<std::pair<float, index_t> > neighbors;
+    for (std::size_t i = first; i < last; ++i)
+    {
+      const PointT &query = indices.empty () ? cloud.points[i] : cloud.points[indices[i]];
+      assert (isFinite (query) && "Invalid (NaN, Inf) point coordinates given to radiusSearch!");
+
+      const std::size_t begin = block_indices.size ();
+      counts[i - first] = appendRadiusNeighbors (query, squared_radius, max_nn, block_indices, block_sqr_distances);
+      if (sorted_results_)
+        this->sortResults (block_indices, block_sqr_distances, begin, block_indices.size (), neighbors);
+    }
+  };
+  pcl::search::searchInBlocks (indices.empty () ? cloud.size () : indices.size (), nr_threads, search_block, neighborhoods);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+template<typename PointT> std::size_t
+pcl::search::OrganizedNeighbor<PointT>::appendRadiusNeighbors (const PointT &query,
+                                                               double squared_radius,
+                                                               std::size_t max_nn,
+                                                               Indices &k_indices,
+                                                               std::vector<float> &k_sqr_distances) const
+{
+  // search window
+  unsigned left, right, top, bottom;
+  float squared_distance;
+  std::size_t nr_neighbors = 0;
+
+  this->getProjectedRadiusSearchBox (query, static_cast<float> (squared_radius), left, right, top, bottom);
+
+  // iterate over search box
   unsigned yEnd  = (bottom + 1) * input_->width + right + 1;
   unsigned idx  = top * input_->width + left;
   unsigned skip = input_->width - right + left - 1;
@@ -98,18 +143,12 @@ pcl::search::OrganizedNeighbor<PointT>::radiusSearch (const               PointT
         k_indices.push_back (idx);
         k_sqr_distances.push_back (squared_distance);
         // already done ?
-        if (k_indices.size () == max_nn)
-        {
-          if (sorted_results_)
-            this->sortResults (k_indices, k_sqr_distances);
-          return (max_nn);
-        }
+        if (++nr_neighbors == max_nn)
+          return (nr_neighbors);
       }
     }
   }
-  if (sorted_results_)
-    this->sortResults (k_indices, k_sqr_distances);  
-  return (static_cast<int> (k_indices.size ()));
+  return (nr_neighbors);
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
@@ -40,6 +40,8 @@
 
 #include <pcl/search/search.h>
 
+#include <algorithm>
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT>
 pcl::search::Search<PointT>::Search (const std::string& name, bool sorted)
@@ -183,6 +185,75 @@ pcl::search::Search<PointT>::radiusSearch (
   }
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::Search<PointT>::nearestKSearch (
+    const PointCloud &cloud, const Indices &indices, int k,
+    Neighborhoods &neighborhoods, unsigned int nr_threads) const
+{
+  auto search_query = [this, k] (const PointT &point, NeighborBuffer &neighbors)
+  {
+    return (nearestKSearch (point, k, neighbors));
+  };
+  searchQueries (cloud, indices, nr_threads, search_query, neighborhoods);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::Search<PointT>::radiusSearch (
+    const PointCloud &cloud, const Indices &indices, double radius,
+    Neighborhoods &neighborhoods, unsigned int max_nn, unsigned int nr_threads) const
+{
+  auto search_query = [this, radius, max_nn] (const PointT &point, NeighborBuffer &neighbors)
+  {
+    return (radiusSearch (point, radius, neighbors, max_nn));
+  };
+  searchQueries (cloud, indices, nr_threads, search_query, neighborhoods);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::Search<PointT>::nearestKSearch (
+    const PointT &point, int k, NeighborBuffer &neighbors) const
+{
+  // Like the std::vector based callers, hand over vectors already holding k elements
+  neighbors.resize (std::max (k, 0));
+  return (nearestKSearch (point, k, neighbors.indices, neighbors.sqr_distances));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> int
+pcl::search::Search<PointT>::radiusSearch (
+    const PointT &point, double radius, NeighborBuffer &neighbors,
+    unsigned int max_nn) const
+{
+  return (radiusSearch (point, radius, neighbors.indices, neighbors.sqr_distances, max_nn));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> template <typename QuerySearch> void
+pcl::search::Search<PointT>::searchQueries (
+    const PointCloud &cloud, const Indices &indices, unsigned int nr_threads,
+    const QuerySearch &search_query, Neighborhoods &neighborhoods) const
+{
+  auto search_block = [&cloud, &indices, &search_query] (std::size_t first, std::size_t last,
+                                                         Indices &block_indices, std::vector<float> &block_sqr_distances,
+                                                         std::size_t *counts)
+  {
+    // Reused by all the queries of the block
+    NeighborBuffer neighbors;
+    for (std::size_t i = first; i < last; ++i)
+    {
+      const PointT &point = indices.empty () ? cloud.points[i] : cloud.points[indices[i]];
+      const int nr_neighbors = std::max (0, search_query (point, neighbors));
+      block_indices.insert (block_indices.end (), neighbors.indices.begin (), neighbors.indices.begin () + nr_neighbors);
+      block_sqr_distances.insert (block_sqr_distances.end (), neighbors.sqr_distances.begin (), neighbors.sqr_distances.begin () + nr_neighbors);
+      counts[i - first] = nr_neighbors;
+    }
+  };
+  pcl::search::searchInBlocks (indices.empty () ? cloud.size () : indices.size (), nr_threads, search_block, neighborhoods);
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////
 template <typename PointT> void
 pcl::search::Search<PointT>::sortResults (
@@ -205,6 +276,25 @@ pcl::search::Search<PointT>::sortResults (
   sort (distances.begin (), distances.end ());
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////
+template <typename PointT> void
+pcl::search::Search<PointT>::sortResults (
+    Indices& indices, std::vector<float>& distances, std::size_t begin, std::size_t end,
+    std::vector<std::pair<float, index_t> >& neighbors) const
+{
+  neighbors.clear ();
+  for (std::size_t idx = begin; idx < end; ++idx)
+    neighbors.emplace_back (distances[idx], indices[idx]);
+
+  std::sort (neighbors.begin (), neighbors.end ());
+
+  for (std::size_t idx = begin; idx < end; ++idx)
+  {
+    distances[idx] = neighbors[idx - begin].first;
+    indices[idx] = neighbors[idx - begin].second;
+  }
+}
+
 #define PCL_INSTANTIATE_Search(T) template class PCL_EXPORTS pcl::search::Search<T>;
 
 #endif  //#ifndef _PCL_SEARCH_SEARCH_IMPL_HPP_
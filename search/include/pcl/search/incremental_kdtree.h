@@ -0,0 +1,332 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/search/search.h>
+
+#include <Eigen/Core>
+
+namespace pcl
+{
+  namespace search
+  {
+    /** \brief IncrementalKdTree is a k-d tree which supports inserting and removing points without
+      * rebuilding the whole tree, for maps that grow and move every frame.
+      *
+      * Each node of the tree holds one point and the bounding box of the valid points of its subtree. Removed
+      * points are only marked as deleted, and subtrees are rebuilt from their valid points once they become
+      * unbalanced or hold too many deleted points, following the scapegoat strategy of ikd-tree. Insertions and
+      * removals are thus amortized O(log n), and the searches are exact, with the same semantics as
+      * BucketKdTree.
+      *
+      * The tree keeps its own copy of the points, returned by getInputCloud (): the points added with
+      * addPoints () are appended to it, and removed points stay in it, so that the indices returned by the
+      * searches remain valid across updates. Calling setInputCloud () again releases the removed points.
+      *
+      * Points with non-finite coordinates are never inserted in the tree.
+      *
+      * \ingroup search
+      */
+    template<typename PointT>
+    class IncrementalKdTree : public Search<PointT>
+    {
+      public:
+        using PointCloud = typename Search<PointT>::PointCloud;
+        using PointCloudConstPtr = typename Search<PointT>::PointCloudConstPtr;
+
+        using pcl::search::Search<PointT>::indices_;
+        using pcl::search::Search<PointT>::input_;
+        using pcl::search::Search<PointT>::getIndices;
+        using pcl::search::Search<PointT>::getInputCloud;
+        using pcl::search::Search<PointT>::nearestKSearch;
+        using pcl::search::Search<PointT>::radiusSearch;
+        using pcl::search::Search<PointT>::sorted_results_;
+
+        using Ptr = shared_ptr<IncrementalKdTree<PointT> >;
+        using ConstPtr = shared_ptr<const IncrementalKdTree<PointT> >;
+
+        /** \brief Constructor.
+          * \param[in] sorted set to true if the radius search results need to be sorted in ascending order
+          * based on their distance to the query point
+          */
+        IncrementalKdTree (bool sorted = true);
+
+        /** \brief Set the largest fraction of the nodes of a subtree that one of its children may hold
+          * before the subtree is rebuilt.
+          * \param[in] balance_threshold the fraction, between 0.5 and 1 (default: 0.7)
+          */
+        void
+        setBalanceThreshold (float balance_threshold);
+
+        /** \brief Get the largest fraction of the nodes of a subtree that one of its children may hold. */
+        inline float
+        getBalanceThreshold () const
+        {
+          return (balance_threshold_);
+        }
+
+        /** \brief Set the largest fraction of deleted nodes a subtree may hold before it is rebuilt.
+          * \param[in] deleted_threshold the fraction, between 0 and 1 (default: 0.5)
+          */
+        void
+        setDeletedThreshold (float deleted_threshold);
+
+        /** \brief Get the largest fraction of deleted nodes a subtree may hold. */
+        inline float
+        getDeletedThreshold () const
+        {
+          return (deleted_threshold_);
+        }
+
+        /** \brief Provide a pointer to the input dataset, and build the tree from a copy of it.
+          * \param[in] cloud the const boost shared pointer to a PointCloud message
+          * \param[in] indices the point indices subset that is to be used from \a cloud
+          */
+        void
+        setInputCloud (const PointCloudConstPtr& cloud,
+                       const IndicesConstPtr& indices = IndicesConstPtr ()) override;
+
+        /** \brief Append points to the input cloud of the tree, and insert them in the tree.
+          * \param[in] cloud the points to add, which get the indices following the last point of the input cloud
+          */
+        void
+        addPoints (const PointCloud &cloud);
+
+        /** \brief Remove points from the tree. They stay in the input cloud, but are no longer returned by the
+          * searches.
+          * \param[in] indices the indices of the points to remove in the input cloud
+          * \return the number of points removed, not counting those which were not in the tree
+          */
+        std::size_t
+        removePoints (const Indices &indices);
+
+        /** \brief Remove the points inside an axis-aligned box from the tree.
+          * \param[in] min_pt the minimum corner of the box
+          * \param[in] max_pt the maximum corner of the box
+          * \return the number of points removed
+          */
+        std::size_t
+        removeBox (const Eigen::Vector3f &min_pt, const Eigen::Vector3f &max_pt);
+
+        /** \brief Get the number of points in the tree, excluding the removed ones. */
+        inline std::size_t
+        getNumberOfPoints () const
+        {
+          return (root_ < 0 ? 0 : static_cast<std::size_t> (nodes_[root_].size - nodes_[root_].nr_deleted));
+        }
+
+        /** \brief Search for the k-nearest neighbors for the given query point.
+          * \param[in] point the given query point
+          * \param[in] k the number of neighbors to search for
+          * \param[out] k_indices the resultant indices of the neighboring points, sorted by increasing distance
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \return number of neighbors found
+          */
+        int
+        nearestKSearch (const PointT &point, int k,
+                        Indices &k_indices,
+                        std::vector<float> &k_sqr_distances) const override;
+
+        /** \brief Search for all the nearest neighbors of the query point in a given radius.
+          * \param[in] point the given query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] k_indices the resultant indices of the neighboring points
+          * \param[out] k_sqr_distances the resultant squared distances to the neighboring points
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value, keeping the closest
+          * ones. If \a max_nn is set to 0 or to a number higher than the number of points in the tree, all
+          * neighbors in \a radius will be returned.
+          * \return number of neighbors found in radius
+          */
+        int
+        radiusSearch (const PointT& point, double radius,
+                      Indices &k_indices,
+                      std::vector<float> &k_sqr_distances,
+                      unsigned int max_nn = 0) const override;
+
+      protected:
+        /** \brief A node of the tree, holding one point. */
+        struct Node
+        {
+          /** \brief The index of the point in the input cloud. */
+          index_t point;
+
+          /** \brief The coordinates of the point. */
+          float xyz[3];
+
+          /** \brief The split dimension: points smaller along it are inserted on the left. */
+          int dim;
+
+          /** \brief The indices of the left and right children and of the parent, or -1. */
+          int left, right, parent;
+
+          /** \brief The number of nodes of the subtree, including the deleted ones. */
+          int size;
+
+          /** \brief The number of deleted nodes of the subtree. */
+          int nr_deleted;
+
+          /** \brief Whether the point of the node has been removed. */
+          bool deleted;
+
+          /** \brief The bounding box of the valid points of the subtree, empty if there are none. */
+          float min[3], max[3];
+        };
+
+        /** \brief Get a free node. */
+        int
+        allocateNode ();
+
+        /** \brief Build a balanced subtree from points of the input cloud.
+          * \param[in] begin the first of the indices of the points, which are reordered
+          * \param[in] end the end of the indices of the points
+          * \param[in] parent the parent of the subtree
+          * \return the root of the subtree, or -1 if there are no points
+          */
+        int
+        buildSubtree (Indices::iterator begin, Indices::iterator end, int parent);
+
+        /** \brief Rebuild a subtree from its valid points, releasing its deleted nodes.
+          * \param[in] node the root of the subtree
+          */
+        void
+        rebuildSubtree (int node);
+
+        /** \brief Append the valid points of a subtree to \a rebuild_indices_, and release its nodes. */
+        void
+        flattenSubtree (int node);
+
+        /** \brief Update the size, deleted count and bounding box of a node from those of its children. */
+        void
+        pullUp (int node);
+
+        /** \brief Check whether a subtree needs to be rebuilt. */
+        bool
+        isUnbalanced (int node) const;
+
+        /** \brief Rebuild the topmost unbalanced subtree on the path from the root to a node, if any. */
+        void
+        rebalancePath (int node);
+
+        /** \brief Insert a point of the input cloud in the tree. */
+        void
+        insertPoint (index_t index);
+
+        /** \brief Mark a node as deleted, and update its ancestors. */
+        void
+        deleteNode (int node);
+
+        /** \brief Recursively remove the points inside a box from a subtree.
+          * \return the number of points removed
+          */
+        std::size_t
+        removeBoxSubtree (int node, const float *min_pt, const float *max_pt);
+
+        /** \brief Get the squared distance between a query point and the bounding box of a subtree. */
+        inline float
+        getBoxSqrDistance (const Node &node, const float *query) const
+        {
+          float sqr_distance = 0.0f;
+          for (int d = 0; d < 3; ++d)
+          {
+            const float diff = query[d] < node.min[d] ? node.min[d] - query[d] :
+                               query[d] > node.max[d] ? query[d] - node.max[d] : 0.0f;
+            sqr_distance += diff * diff;
+          }
+          return (sqr_distance);
+        }
+
+        /** \brief Recursively search the k nearest neighbors in a subtree.
+          * \param[in] node the root of the subtree
+          * \param[in] query the coordinates of the query point
+          * \param[in] k the maximum number of neighbors
+          * \param[in] max_sqr_distance the squared distance neighbors have to be strictly below
+          * \param[in,out] heap_indices the indices of the neighbors found so far, in a max-heap on their distance
+          * \param[in,out] heap_sqr_distances the squared distances of the neighbors found so far
+          * \param[in,out] heap_size the number of neighbors found so far
+          */
+        void
+        searchKNearest (int node, const float *query, std::size_t k, float max_sqr_distance,
+                        index_t *heap_indices, float *heap_sqr_distances, std::size_t &heap_size) const;
+
+        /** \brief Recursively search all the neighbors in a radius in a subtree.
+          * \param[in] node the root of the subtree
+          * \param[in] query the coordinates of the query point
+          * \param[in] sqr_radius the squared radius
+          * \param[out] k_indices the indices of the neighbors, appended to
+          * \param[out] k_sqr_distances the squared distances of the neighbors, appended to
+          */
+        void
+        searchRadius (int node, const float *query, float sqr_radius,
+                      Indices &k_indices, std::vector<float> &k_sqr_distances) const;
+
+        /** \brief The copy of the input cloud, to which the added points are appended. */
+        typename PointCloud::Ptr cloud_;
+
+        /** \brief The copy of the input indices, if any, to which the indices of the added points are appended. */
+        IndicesPtr indices_copy_;
+
+        /** \brief The nodes of the tree, including the free ones. */
+        std::vector<Node> nodes_;
+
+        /** \brief The free nodes. */
+        std::vector<int> free_nodes_;
+
+        /** \brief The node of each point of the input cloud, or -1 if it is not in the tree. */
+        std::vector<int> point_nodes_;
+
+        /** \brief The root of the tree, or -1 if it is empty. */
+        int root_;
+
+        /** \brief Buffer for the points of the subtrees being rebuilt. */
+        Indices rebuild_indices_;
+
+        /** \brief Buffer for the path from the root to a node. */
+        std::vector<int> path_;
+
+        /** \brief The largest fraction of the nodes of a subtree that one of its children may hold. */
+        float balance_threshold_;
+
+        /** \brief The largest fraction of deleted nodes a subtree may hold. */
+        float deleted_threshold_;
+    };
+  }
+}
+
+#ifdef PCL_NO_PRECOMPILE
+#include <pcl/search/impl/incremental_kdtree.hpp>
+#endif
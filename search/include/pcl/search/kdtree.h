@@ -162,6 +162,60 @@ namespace pcl
                       Indices &k_indices,
                       std::vector<float> &k_sqr_distances,
                       unsigned int max_nn = 0) const override;
+
+        /** \brief Search for the k-nearest neighbors for the given query point, writing the results into a
+          * reusable buffer. No memory is allocated once the buffer holds \a k neighbors.
+          * \param[in] point the given query point
+          * \param[in] k the number of neighbors to search for
+          * \param[out] neighbors the buffer receiving the neighbors
+          * \return number of neighbors found
+          */
+        int
+        nearestKSearch (const PointT &point, int k, NeighborBuffer &neighbors) const override;
+
+        /** \brief Search for all the nearest neighbors of the query point in a given radius, writing the results
+          * into a reusable buffer. With sorted results, the neighbors are written in place up to the capacity of
+          * the buffer. If they fill it, the search is repeated once without bound and the buffer grows to the
+          * number of neighbors plus one, so no memory is allocated once the buffer is larger than the largest
+          * neighborhood. Unsorted results always go through the std::vector based search, to keep its order, and
+          * FLANN then allocates memory for every query.
+          * \param[in] point the given query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] neighbors the buffer receiving the neighbors
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value. If \a max_nn is set to
+          * 0 or to a number higher than the number of points in the input cloud, all neighbors in \a radius will be
+          * returned.
+          * \return number of neighbors found in radius
+          */
+        int
+        radiusSearch (const PointT &point, double radius, NeighborBuffer &neighbors,
+                      unsigned int max_nn = 0) const override;
+
+        /** \brief Search for the k-nearest neighbors of a set of query points, in parallel.
+          * The queries are split in one block per thread, and each block is handed to the k-d tree in a single
+          * FLANN k-NN call (see KdTreeFLANN::nearestKSearch ()).
+          * \param[in] cloud the point cloud data holding the query points
+          * \param[in] indices the indices in \a cloud of the query points. If empty, all the points of \a cloud are used
+          * \param[in] k the number of neighbors to search for
+          * \param[out] neighborhoods the neighbors of each query point, in the order of the queries
+          * \param[in] nr_threads the number of threads to use (0 sets the value to the number of processors)
+          */
+        void
+        nearestKSearch (const PointCloud &cloud, const Indices &indices, int k,
+                        Neighborhoods &neighborhoods, unsigned int nr_threads = 1) const override;
+
+        /** \brief Search for all the nearest neighbors of a set of query points in a given radius, in parallel.
+          * \param[in] cloud the point cloud data holding the query points
+          * \param[in] indices the indices in \a cloud of the query points. If empty, all the points of \a cloud are used
+          * \param[in] radius the radius of the sphere bounding all of the query points' neighbors
+          * \param[out] neighborhoods the neighbors of each query point, in the order of the queries
+          * \param[in] max_nn if given, bounds the maximum returned neighbors per query to this value
+          * \param[in] nr_threads the number of threads to use (0 sets the value to the number of processors)
+          */
+        void
+        radiusSearch (const PointCloud &cloud, const Indices &indices, double radius,
+                      Neighborhoods &neighborhoods, unsigned int max_nn = 0, unsigned int nr_threads = 1) const override;
+
       protected:
         /** \brief A pointer to the internal KdTree object. */
         KdTreePtr tree_;
@@ -0,0 +1,124 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/types.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace pcl
+{
+  namespace search
+  {
+    /** \brief Reusable storage for the results of single query neighbor searches.
+      *
+      * The search methods taking a NeighborBuffer resize \a indices and \a sqr_distances to the
+      * number of neighbors found, and only grow their capacity when a result does not fit. Reusing
+      * the same buffer for all the queries of a loop lets KdTree stop allocating memory once the
+      * buffer is larger than the largest neighborhood, for k-nearest neighbor searches and for
+      * radius searches with sorted results; reserve () can set that size upfront. The other
+      * searches forward to the std::vector based methods, which may still allocate per query.
+      * Parallel loops keep one buffer per thread, created in the parallel region, as copying a
+      * buffer does not copy its capacity.
+      * \ingroup search
+      */
+    struct NeighborBuffer
+    {
+      /** \brief Empty constructor. */
+      NeighborBuffer () = default;
+
+      /** \brief Constructor, reserving space for a number of neighbors.
+        * \param[in] capacity the number of neighbors to reserve space for
+        */
+      explicit NeighborBuffer (std::size_t capacity)
+      {
+        reserve (capacity);
+      }
+
+      /** \brief The indices of the neighbors found by the last search. */
+      Indices indices;
+
+      /** \brief The squared distances of the neighbors found by the last search. */
+      std::vector<float> sqr_distances;
+
+      /** \brief Get the number of neighbors found by the last search. */
+      inline std::size_t
+      size () const
+      {
+        return (indices.size ());
+      }
+
+      /** \brief Get the number of neighbors the buffer can hold without allocating memory. */
+      inline std::size_t
+      capacity () const
+      {
+        return (std::min (indices.capacity (), sqr_distances.capacity ()));
+      }
+
+      /** \brief Reserve space for a number of neighbors.
+        * \param[in] capacity the number of neighbors to reserve space for
+        */
+      inline void
+      reserve (std::size_t capacity)
+      {
+        indices.reserve (capacity);
+        sqr_distances.reserve (capacity);
+      }
+
+      /** \brief Set the number of neighbors, keeping the allocated memory when shrinking.
+        * \param[in] size the new number of neighbors
+        */
+      inline void
+      resize (std::size_t size)
+      {
+        indices.resize (size);
+        sqr_distances.resize (size);
+      }
+
+      /** \brief Remove all the neighbors, keeping the allocated memory. */
+      inline void
+      clear ()
+      {
+        indices.clear ();
+        sqr_distances.clear ();
+      }
+    };
+  }
+}
@@ -0,0 +1,128 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#pragma once
+
+#include <pcl/types.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace pcl
+{
+  namespace search
+  {
+    /** \brief Neighbors of a set of query points, stored in compressed sparse row (CSR) format.
+      *
+      * The neighbors of the i-th query are \a indices[offsets[i]] ... \a indices[offsets[i + 1] - 1],
+      * with their squared distances at the same positions in \a sqr_distances. Storing all the
+      * results in three flat vectors avoids one allocation per query, and the vectors keep their
+      * capacity when the object is reused for the next batch.
+      * \ingroup search
+      */
+    struct Neighborhoods
+    {
+      /** \brief Start of the neighbors of each query in \a indices, plus the total number of neighbors. */
+      std::vector<std::size_t> offsets;
+
+      /** \brief The indices of the neighbors of all the queries. */
+      Indices indices;
+
+      /** \brief The squared distances of the neighbors of all the queries. */
+      std::vector<float> sqr_distances;
+
+      /** \brief Get the number of queries. */
+      inline std::size_t
+      size () const
+      {
+        return (offsets.empty () ? 0 : offsets.size () - 1);
+      }
+
+      /** \brief Get the number of neighbors of a query.
+        * \param[in] query the index of the query
+        */
+      inline std::size_t
+      getNumberOfNeighbors (std::size_t query) const
+      {
+        return (offsets[query + 1] - offsets[query]);
+      }
+
+      /** \brief Copy the neighbors of a query into separate vectors, as returned by the
+        * single query search methods.
+        * \param[in] query the index of the query
+        * \param[out] k_indices the indices of the neighbors
+        * \param[out] k_sqr_distances the squared distances of the neighbors
+        * \return the number of neighbors of the query
+        */
+      inline int
+      getNeighbors (std::size_t query, Indices &k_indices, std::vector<float> &k_sqr_distances) const
+      {
+        k_indices.assign (indices.begin () + offsets[query], indices.begin () + offsets[query + 1]);
+        k_sqr_distances.assign (sqr_distances.begin () + offsets[query], sqr_distances.begin () + offsets[query + 1]);
+        return (static_cast<int> (k_indices.size ()));
+      }
+
+      /** \brief Remove all the queries, keeping the allocated memory. */
+      inline void
+      clear ()
+      {
+        offsets.clear ();
+        indices.clear ();
+        sqr_distances.clear ();
+      }
+    };
+
+    /** \brief Split a set of queries in contiguous blocks searched in parallel, and gather their
+      * results in \a neighborhoods. The output does not depend on the number of threads.
+      * \param[in] nr_queries the number of query points
+      * \param[in] nr_threads the number of threads to use (0 sets the value to the number of processors)
+      * \param[in] search_block functor called as search_block (first, last, block_indices, block_sqr_distances, counts).
+      * It has to append the neighbors of the queries [first, last) to \a block_indices and \a block_sqr_distances,
+      * in order, and write the number of neighbors of query first + i in counts[i].
+      * \note With more than one thread, the neighbors of each block are gathered in temporary vectors before being
+      * copied into \a neighborhoods, and these vectors are allocated on every call. A single thread appends them
+      * directly to \a neighborhoods, which keeps its capacity between calls.
+      * \param[out] neighborhoods the neighbors of each query point
+      * \ingroup search
+      */
+    template <typename BlockSearch> void
+    searchInBlocks (std::size_t nr_queries, unsigned int nr_threads,
+                    const BlockSearch &search_block, Neighborhoods &neighborhoods);
+  }
+}
+
+#include <pcl/search/impl/neighborhoods.hpp>
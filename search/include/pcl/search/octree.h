@@ -237,6 +237,54 @@ namespace pcl
           return (static_cast<int> (k_indices.size ()));
         }
 
+        /** \brief Search for all the nearest neighbors of a set of query points in a given radius, in parallel.
+          * Consecutive queries are searched in groups, which explore the octree once for the whole group (see
+          * pcl::octree::OctreePointCloudSearch::radiusSearch ()), so this is fastest when nearby queries are
+          * stored next to each other. The batched k-nearest neighbor search is not specialized, as the
+          * priority driven traversal of each query cannot be shared, and goes through Search::nearestKSearch ().
+          * \param[in] cloud the point cloud data holding the query points
+          * \param[in] indices the indices in \a cloud of the query points. If empty, all the points of \a cloud are used
+          * \param[in] radius the radius of the sphere bounding all of the query points' neighbors
+          * \param[out] neighborhoods the neighbors of each query point, in the order of the queries
+          * \param[in] max_nn if given, bounds the maximum returned neighbors per query to this value
+          * \param[in] nr_threads the number of threads to use (0 sets the value to the number of processors)
+          */
+        void
+        radiusSearch (const PointCloud &cloud, const Indices &indices, double radius,
+                      Neighborhoods &neighborhoods, unsigned int max_nn = 0, unsigned int nr_threads = 1) const override
+        {
+          auto search_block = [this, &cloud, &indices, radius, max_nn] (std::size_t first, std::size_t last,
+                                                                        Indices &block_indices,
+                                                                        std::vector<float> &block_sqr_distances,
+                                                                        std::size_t *counts)
+          {
+            // Reused by all the groups of the block
+            typename pcl::octree::OctreePointCloudSearch<PointT, LeafTWrap, BranchTWrap>::AlignedPointTVector queries;
+            std::vector<Indices> k_indices;
+            std::vector<std::vector<float> > k_sqr_distances;
+            std::vector<std::pair<float, index_t> > neighbors;
+            // Groups of 128 queries were the fastest in a benchmark on a stereo scan, for queries in scan
+            // order as well as in random order, as the upper levels of the octree are shared by all the queries
+            for (std::size_t group = first; group < last; group += queries.size ())
+            {
+              queries.clear ();
+              for (std::size_t i = group; i < std::min (last, group + 128); ++i)
+                queries.push_back (indices.empty () ? cloud.points[i] : cloud.points[indices[i]]);
+
+              tree_->radiusSearch (queries, radius, k_indices, k_sqr_distances, max_nn);
+              for (std::size_t j = 0; j < queries.size (); ++j)
+              {
+                const std::size_t begin = block_indices.size ();
+                block_indices.insert (block_indices.end (), k_indices[j].begin (), k_indices[j].end ());
+                block_sqr_distances.insert (block_sqr_distances.end (), k_sqr_distances[j].begin (), k_sqr_distances[j].end ());
+                counts[group - first + j] = k_indices[j].size ();
+                if (sorted_results_)
+                  this->sortResults (block_indices, block_sqr_distances, begin, block_indices.size (), neighbors);
+              }
+            }
+          };
+          pcl::search::searchInBlocks (indices.empty () ? cloud.size () : indices.size (), nr_threads, search_block, neighborhoods);
+        }
 
         /** \brief Search for approximate nearest neighbor at the query point.
           * \param[in] cloud the point cloud data
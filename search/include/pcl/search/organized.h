@@ -162,6 +162,22 @@ namespace pcl
                       std::vector<float> &k_sqr_distances,
                       unsigned int max_nn = 0) const override;
 
+        /** \brief Search for all the nearest neighbors of a set of query points in a given radius, in parallel.
+          * The neighbors are written directly into the neighborhoods of each block of queries, and sorted in place,
+          * instead of going through one result vector per query. The batched k-nearest neighbor search is not
+          * specialized, as its search window grows differently for each query, and goes through
+          * Search::nearestKSearch ().
+          * \param[in] cloud the point cloud data holding the query points
+          * \param[in] indices the indices in \a cloud of the query points. If empty, all the points of \a cloud are used
+          * \param[in] radius the radius of the sphere bounding all of the query points' neighbors
+          * \param[out] neighborhoods the neighbors of each query point, in the order of the queries
+          * \param[in] max_nn if given, bounds the maximum returned neighbors per query to this value
+          * \param[in] nr_threads the number of threads to use (0 sets the value to the number of processors)
+          */
+        void
+        radiusSearch (const PointCloud &cloud, const Indices &indices, double radius,
+                      Neighborhoods &neighborhoods, unsigned int max_nn = 0, unsigned int nr_threads = 1) const override;
+
         /** \brief estimated the projection matrix from the input cloud. */
         void 
         estimateProjectionMatrix ();
@@ -204,6 +220,19 @@ namespace pcl
           }
         };
 
+        /** \brief Append the neighbors of a query point within a radius to the given vectors, in the order of the
+          * projected search window.
+          * \param[in] query the query point
+          * \param[in] squared_radius the squared radius of the sphere bounding the neighbors
+          * \param[in] max_nn the maximum number of neighbors to append
+          * \param[in,out] k_indices the indices of the neighbors are appended to this vector
+          * \param[in,out] k_sqr_distances the squared distances of the neighbors are appended to this vector
+          * \return the number of neighbors appended
+          */
+        std::size_t
+        appendRadiusNeighbors (const PointT &query, double squared_radius, std::size_t max_nn,
+                               Indices &k_indices, std::vector<float> &k_sqr_distances) const;
+
         /** \brief test if point given by index is among the k NN in results to the query point.
           * \param[in] query query point
           * \param[in] k number of maximum nn interested in
@@ -43,3 +43,5 @@
 #include <pcl/search/kdtree.h>
 #include <pcl/search/octree.h>
 #include <pcl/search/organized.h>
+#include <pcl/search/bucket_kdtree.h>
+#include <pcl/search/incremental_kdtree.h>
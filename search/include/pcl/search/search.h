@@ -43,6 +43,10 @@
 #include <pcl/for_each_type.h>
 #include <pcl/common/concatenate.h>
 #include <pcl/common/copy_point.h>
+#include <pcl/search/neighbor_buffer.h>
+#include <pcl/search/neighborhoods.h>
+
+#include <utility>
 
 namespace pcl
 {
@@ -396,10 +400,93 @@ namespace pcl
           }
         }
 
+        /** \brief Search for the k-nearest neighbors of a set of query points, in parallel.
+          * The results of all the queries are written in the flat vectors of \a neighborhoods. Each block of queries
+          * reuses one NeighborBuffer, so the searches only allocate memory when the single query search taking a
+          * NeighborBuffer does.
+          * \param[in] cloud the point cloud data holding the query points
+          * \param[in] indices the indices in \a cloud of the query points. If empty, all the points of \a cloud are used
+          * \param[in] k the number of neighbors to search for
+          * \param[out] neighborhoods the neighbors of each query point, in the order of the queries
+          * \param[in] nr_threads the number of threads to use (0 sets the value to the number of processors)
+          */
+        virtual void
+        nearestKSearch (const PointCloud &cloud, const Indices &indices, int k,
+                        Neighborhoods &neighborhoods, unsigned int nr_threads = 1) const;
+
+        /** \brief Search for all the nearest neighbors of a set of query points in a given radius, in parallel.
+          * The results of all the queries are written in the flat vectors of \a neighborhoods. Each block of queries
+          * reuses one NeighborBuffer, so the searches only allocate memory when the single query search taking a
+          * NeighborBuffer does.
+          * \param[in] cloud the point cloud data holding the query points
+          * \param[in] indices the indices in \a cloud of the query points. If empty, all the points of \a cloud are used
+          * \param[in] radius the radius of the sphere bounding all of the query points' neighbors
+          * \param[out] neighborhoods the neighbors of each query point, in the order of the queries
+          * \param[in] max_nn if given, bounds the maximum returned neighbors per query to this value. If \a max_nn is set to
+          * 0 or to a number higher than the number of points in the input cloud, all neighbors in \a radius will be
+          * returned.
+          * \param[in] nr_threads the number of threads to use (0 sets the value to the number of processors)
+          */
+        virtual void
+        radiusSearch (const PointCloud &cloud, const Indices &indices, double radius,
+                      Neighborhoods &neighborhoods, unsigned int max_nn = 0, unsigned int nr_threads = 1) const;
+
+        /** \brief Search for the k-nearest neighbors for the given query point, writing the results into a
+          * reusable buffer. The default implementation resizes the buffer to \a k and forwards to the std::vector
+          * based search; implementations overriding it (e.g. KdTree) do not allocate memory once the buffer holds
+          * \a k neighbors.
+          * \param[in] point the given query point
+          * \param[in] k the number of neighbors to search for
+          * \param[out] neighbors the buffer receiving the neighbors
+          * \return number of neighbors found
+          */
+        virtual int
+        nearestKSearch (const PointT &point, int k, NeighborBuffer &neighbors) const;
+
+        /** \brief Search for all the nearest neighbors of the query point in a given radius, writing the results
+          * into a reusable buffer. The default implementation forwards to the std::vector based search, which may
+          * allocate memory for every query. Implementations overriding it (e.g. KdTree with sorted results) do not
+          * allocate memory once the buffer is larger than the largest neighborhood.
+          * \param[in] point the given query point
+          * \param[in] radius the radius of the sphere bounding all of p_q's neighbors
+          * \param[out] neighbors the buffer receiving the neighbors
+          * \param[in] max_nn if given, bounds the maximum returned neighbors to this value. If \a max_nn is set to
+          * 0 or to a number higher than the number of points in the input cloud, all neighbors in \a radius will be
+          * returned.
+          * \return number of neighbors found in radius
+          */
+        virtual int
+        radiusSearch (const PointT &point, double radius, NeighborBuffer &neighbors,
+                      unsigned int max_nn = 0) const;
+
       protected:
         void 
         sortResults (Indices& indices, std::vector<float>& distances) const;
 
+        /** \brief Sort the neighbors at positions [begin, end) of \a indices and \a distances by increasing distance,
+          * in place. Used by the batched searches to sort the neighbors of each query in their block.
+          * \param[in,out] indices the indices of the neighbors
+          * \param[in,out] distances the squared distances of the neighbors
+          * \param[in] begin the position of the first neighbor to sort
+          * \param[in] end the position after the last neighbor to sort
+          * \param[in,out] neighbors scratch vector, which can be reused between calls to avoid allocating memory
+          */
+        void
+        sortResults (Indices& indices, std::vector<float>& distances, std::size_t begin, std::size_t end,
+                     std::vector<std::pair<float, index_t> >& neighbors) const;
+
+        /** \brief Search a set of queries one by one in parallel, and gather their results in \a neighborhoods.
+          * \param[in] cloud the point cloud data holding the query points
+          * \param[in] indices the indices in \a cloud of the query points. If empty, all the points of \a cloud are used
+          * \param[in] nr_threads the number of threads to use (0 sets the value to the number of processors)
+          * \param[in] search_query functor called as search_query (point, neighbors), with the same semantics as the
+          * single query search methods taking a NeighborBuffer. The buffer is reused by all the queries of a block
+          * \param[out] neighborhoods the neighbors of each query point
+          */
+        template <typename QuerySearch> void
+        searchQueries (const PointCloud &cloud, const Indices &indices, unsigned int nr_threads,
+                       const QuerySearch &search_query, Neighborhoods &neighborhoods) const;
+
         PointCloudConstPtr input_;
         IndicesConstPtr indices_;
         bool sorted_results_;
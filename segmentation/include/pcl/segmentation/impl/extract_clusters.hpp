@@ -58,8 +58,7 @@ pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
   // Create a bool vector of processed point indices, and initialize it to false
   std::vector<bool> processed (cloud.points.size (), false);
 
-  std::vector<int> nn_indices;
-  std::vector<float> nn_distances;
+  search::NeighborBuffer neighbors;
   // Process all points in the indices vector
   for (int i = 0; i < static_cast<int> (cloud.points.size ()); ++i)
   {
@@ -75,20 +74,20 @@ pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
     while (sq_idx < static_cast<int> (seed_queue.size ()))
     {
       // Search for sq_idx
-      if (!tree->radiusSearch (seed_queue[sq_idx], tolerance, nn_indices, nn_distances))
+      if (!tree->radiusSearch (cloud.points[seed_queue[sq_idx]], tolerance, neighbors))
       {
         sq_idx++;
         continue;
       }
 
-      for (std::size_t j = nn_start_idx; j < nn_indices.size (); ++j)             // can't assume sorted (default isn't!)
+      for (std::size_t j = nn_start_idx; j < neighbors.size (); ++j)             // can't assume sorted (default isn't!)
       {
-        if (nn_indices[j] == -1 || processed[nn_indices[j]])        // Has this point been processed before ?
+        if (neighbors.indices[j] == -1 || processed[neighbors.indices[j]])        // Has this point been processed before ?
           continue;
 
         // Perform a simple Euclidean clustering
-        seed_queue.push_back (nn_indices[j]);
-        processed[nn_indices[j]] = true;
+        seed_queue.push_back (neighbors.indices[j]);
+        processed[neighbors.indices[j]] = true;
       }
 
       sq_idx++;
@@ -140,8 +139,7 @@ pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
   // Create a bool vector of processed point indices, and initialize it to false
   std::vector<bool> processed (cloud.points.size (), false);
 
-  std::vector<int> nn_indices;
-  std::vector<float> nn_distances;
+  search::NeighborBuffer neighbors;
   // Process all points in the indices vector
   for (const int &index : indices)
   {
@@ -157,7 +155,7 @@ pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
     while (sq_idx < static_cast<int> (seed_queue.size ()))
     {
       // Search for sq_idx
-      int ret = tree->radiusSearch (cloud.points[seed_queue[sq_idx]], tolerance, nn_indices, nn_distances);
+      int ret = tree->radiusSearch (cloud.points[seed_queue[sq_idx]], tolerance, neighbors);
       if( ret == -1)
       {
         PCL_ERROR("[pcl::extractEuclideanClusters] Received error code -1 from radiusSearch\n");
@@ -169,14 +167,14 @@ pcl::extractEuclideanClusters (const PointCloud<PointT> &cloud,
         continue;
       }
 
-      for (std::size_t j = nn_start_idx; j < nn_indices.size (); ++j)             // can't assume sorted (default isn't!)
+      for (std::size_t j = nn_start_idx; j < neighbors.size (); ++j)             // can't assume sorted (default isn't!)
       {
-        if (nn_indices[j] == -1 || processed[nn_indices[j]])        // Has this point been processed before ?
+        if (neighbors.indices[j] == -1 || processed[neighbors.indices[j]])        // Has this point been processed before ?
           continue;
 
         // Perform a simple Euclidean clustering
-        seed_queue.push_back (nn_indices[j]);
-        processed[nn_indices[j]] = true;
+        seed_queue.push_back (neighbors.indices[j]);
+        processed[neighbors.indices[j]] = true;
       }
 
       sq_idx++;
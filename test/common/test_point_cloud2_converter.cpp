@@ -0,0 +1,191 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/test/gtest.h>
+
+#include <pcl/point_types.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_cloud2_converter.h>
+#include <pcl/conversions.h>
+
+#include <cstdint>
+#include <cstring>
+
+#include "test_point_cloud_data.h"
+
+using namespace pcl;
+
+// A serialized layout unlike any point type: shuffled fields, padding between the points and at the end of the rows
+PCLPointCloud2
+createShuffledMessage (std::uint32_t width, std::uint32_t height)
+{
+  PCLPointCloud2 msg;
+  msg.width = width;
+  msg.height = height;
+  msg.point_step = 20;
+  msg.row_step = width * msg.point_step + 8;
+  const char* names[] = {"rgba", "z", "x", "y"};
+  for (std::uint32_t f = 0; f < 4; ++f)
+  {
+    PCLPointField field;
+    field.name = names[f];
+    field.offset = 4 * f;
+    field.datatype = f == 0 ? PCLPointField::UINT32 : PCLPointField::FLOAT32;
+    field.count = 1;
+    msg.fields.push_back (field);
+  }
+  msg.data.resize (msg.row_step * height);
+  for (std::uint32_t row = 0; row < height; ++row)
+    for (std::uint32_t col = 0; col < width; ++col)
+    {
+      const std::uint32_t i = row * width + col;
+      const std::uint32_t rgba = i * 2654435761u;
+      const float xyz[3] = {static_cast<float> (col), static_cast<float> (row), static_cast<float> (i) * 0.5f};
+      std::uint8_t* point = &msg.data[row * msg.row_step + col * msg.point_step];
+      std::memcpy (point, &rgba, 4);
+      std::memcpy (point + 4, &xyz[2], 4);
+      std::memcpy (point + 8, &xyz[0], 8);
+    }
+  return (msg);
+}
+
+template <typename PointT> void
+expectEqualXYZ (const PointCloud<PointT> &cloud, const PointCloud<PointT> &expected)
+{
+  EXPECT_EQ (cloud.header, expected.header);
+  EXPECT_EQ (cloud.width, expected.width);
+  EXPECT_EQ (cloud.height, expected.height);
+  EXPECT_EQ (cloud.is_dense, expected.is_dense);
+  ASSERT_EQ (cloud.size (), expected.size ());
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+    EXPECT_EQ (cloud[i].getVector3fMap (), expected[i].getVector3fMap ());
+}
+
+TEST (PCLPointCloud2Converter, SameLayout)
+{
+  const auto cloud = createCloud (100, 3, "frame");
+  PCLPointCloud2 msg, expected_msg;
+  toPCLPointCloud2 (cloud, expected_msg);
+
+  PCLPointCloud2Converter<PointXYZRGBNormal> converter (2);
+  converter.toPCLPointCloud2 (cloud, msg);
+  EXPECT_EQ (msg.header, expected_msg.header);
+  EXPECT_EQ (msg.width, expected_msg.width);
+  EXPECT_EQ (msg.height, expected_msg.height);
+  EXPECT_EQ (msg.point_step, expected_msg.point_step);
+  EXPECT_EQ (msg.row_step, expected_msg.row_step);
+  EXPECT_EQ (msg.is_dense, expected_msg.is_dense);
+  EXPECT_EQ (msg.data, expected_msg.data);
+  ASSERT_EQ (msg.fields.size (), expected_msg.fields.size ());
+  for (std::size_t f = 0; f < msg.fields.size (); ++f)
+  {
+    EXPECT_EQ (msg.fields[f].name, expected_msg.fields[f].name);
+    EXPECT_EQ (msg.fields[f].offset, expected_msg.fields[f].offset);
+  }
+
+  PointCloud<PointXYZRGBNormal> converted;
+  converter.fromPCLPointCloud2 (msg, converted);
+  EXPECT_TRUE (converter.isCompiledFor (msg));
+  ASSERT_EQ (converter.getFieldMap ().size (), 1u);
+  expectEqualXYZ (converted, cloud);
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+  {
+    EXPECT_EQ (converted[i].getNormalVector3fMap (), cloud[i].getNormalVector3fMap ());
+    EXPECT_EQ (converted[i].rgba, cloud[i].rgba);
+    EXPECT_EQ (converted[i].curvature, cloud[i].curvature);
+  }
+}
+
+TEST (PCLPointCloud2Converter, DifferentLayout)
+{
+  PCLPointCloud2Converter<PointXYZRGBA> converter (4);
+  // Large enough to be split between threads, with rows spanning several blocks
+  for (const auto &size : {std::make_pair (7u, 5u), std::make_pair (3000u, 40u)})
+  {
+    const PCLPointCloud2 msg = createShuffledMessage (size.first, size.second);
+    PointCloud<PointXYZRGBA> converted, expected;
+    fromPCLPointCloud2 (msg, expected);
+    converter.fromPCLPointCloud2 (msg, converted);
+    EXPECT_TRUE (converter.isCompiledFor (msg));
+    expectEqualXYZ (converted, expected);
+    for (std::size_t i = 0; i < expected.size (); ++i)
+      EXPECT_EQ (converted[i].rgba, expected[i].rgba);
+  }
+
+  // The mapping is recompiled when the layout changes
+  const auto cloud = createCloud (10, 1, "frame");
+  PCLPointCloud2 msg;
+  toPCLPointCloud2 (cloud, msg);
+  EXPECT_FALSE (converter.isCompiledFor (msg));
+  PointCloud<PointXYZRGBA> converted, expected;
+  fromPCLPointCloud2 (msg, expected);
+  converter.fromPCLPointCloud2 (msg, converted);
+  EXPECT_TRUE (converter.isCompiledFor (msg));
+  expectEqualXYZ (converted, expected);
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+    EXPECT_EQ (converted[i].rgba, cloud[i].rgba);
+
+  // Keeping only some of the fields
+  PCLPointCloud2Converter<PointXYZ> xyz_converter;
+  PointCloud<PointXYZ> xyz, expected_xyz;
+  fromPCLPointCloud2 (msg, expected_xyz);
+  xyz_converter.fromPCLPointCloud2 (msg, xyz);
+  expectEqualXYZ (xyz, expected_xyz);
+}
+
+TEST (PCLPointCloud2Converter, Empty)
+{
+  PCLPointCloud2Converter<PointXYZ> converter;
+  PointCloud<PointXYZ> cloud;
+  PCLPointCloud2 msg;
+  converter.toPCLPointCloud2 (cloud, msg);
+  EXPECT_EQ (msg.width, 0u);
+  EXPECT_EQ (msg.height, 1u);
+  EXPECT_TRUE (msg.data.empty ());
+
+  converter.fromPCLPointCloud2 (msg, cloud);
+  EXPECT_TRUE (cloud.empty ());
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
@@ -0,0 +1,199 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/test/gtest.h>
+
+#include <pcl/point_types.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_cloud_soa.h>
+#include <pcl/common/distances.h>
+#include <pcl/common/transforms.h>
+
+#include <cmath>
+#include <cstdint>
+
+#include "test_point_cloud_data.h"
+
+using namespace pcl;
+
+TEST (PointCloudSoA, Conversion)
+{
+  const PointCloud<PointXYZRGBNormal> cloud = createCloud (37);
+  PointCloudSoA soa;
+  toPointCloudSoA (cloud, soa);
+  ASSERT_EQ (cloud.size (), soa.size ());
+  EXPECT_TRUE (soa.hasNormals ());
+  EXPECT_TRUE (soa.hasColors ());
+  EXPECT_EQ (cloud.width, soa.width);
+  EXPECT_EQ (cloud.height, soa.height);
+  EXPECT_EQ (0u, reinterpret_cast<std::uintptr_t> (soa.x.data ()) % PointCloudSoA::alignment);
+  EXPECT_EQ (0u, reinterpret_cast<std::uintptr_t> (soa.normal_z.data ()) % PointCloudSoA::alignment);
+  EXPECT_EQ (0u, reinterpret_cast<std::uintptr_t> (soa.rgba.data ()) % PointCloudSoA::alignment);
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+  {
+    EXPECT_EQ (cloud[i].y, soa.y[i]);
+    EXPECT_EQ (cloud[i].normal_z, soa.normal_z[i]);
+    EXPECT_EQ (cloud[i].rgba, soa.rgba[i]);
+  }
+
+  // The fields which are not stored keep their values
+  PointCloud<PointXYZRGBNormal> output = cloud;
+  soa.z[3] = 42.0f;
+  fromPointCloudSoA (soa, output);
+  ASSERT_EQ (cloud.size (), output.size ());
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+  {
+    EXPECT_EQ (i == 3 ? 42.0f : cloud[i].z, output[i].z);
+    EXPECT_EQ (cloud[i].normal_x, output[i].normal_x);
+    EXPECT_EQ (cloud[i].rgba, output[i].rgba);
+    EXPECT_EQ (cloud[i].curvature, output[i].curvature);
+  }
+
+  // Point types without normals nor colors
+  PointCloud<PointXYZ> xyz;
+  fromPointCloudSoA (soa, xyz);
+  toPointCloudSoA (xyz, soa);
+  EXPECT_FALSE (soa.hasNormals ());
+  EXPECT_FALSE (soa.hasColors ());
+  EXPECT_TRUE (soa.normal_x.empty ());
+  EXPECT_TRUE (soa.rgba.empty ());
+  EXPECT_EQ (cloud.size (), soa.size ());
+  EXPECT_EQ (42.0f, soa.z[3]);
+}
+
+TEST (PointCloudSoA, Views)
+{
+  PointCloudSoA soa (true, false);
+  soa.resize (10);
+  for (std::size_t i = 0; i < soa.size (); ++i)
+    soa.x[i] = static_cast<float> (i);
+
+  PointCloudSoAView view = soa.getView (2, 5);
+  EXPECT_EQ (5u, view.size);
+  EXPECT_TRUE (view.hasNormals ());
+  EXPECT_FALSE (view.hasColors ());
+  EXPECT_EQ (soa.x.data () + 2, view.x);
+  EXPECT_EQ (soa.normal_y.data () + 2, view.normal_y);
+  view.x[0] = -1.0f;
+  EXPECT_EQ (-1.0f, soa.x[2]);
+
+  const PointCloudSoA &const_soa = soa;
+  const PointCloudSoAConstView tail = const_soa.getView (8);
+  EXPECT_EQ (2u, tail.size);
+  EXPECT_EQ (9.0f, tail.x[1]);
+  EXPECT_EQ (0u, const_soa.getView (20).size);
+  EXPECT_EQ (0u, soa.getView (10, 5).size);
+
+  const PointCloudSoAConstView sub_view = PointCloudSoAConstView (view).getSubView (1, 2);
+  EXPECT_EQ (2u, sub_view.size);
+  EXPECT_EQ (3.0f, sub_view.x[0]);
+}
+
+TEST (PointCloudSoA, Transforms)
+{
+  PointCloud<PointXYZRGBNormal> cloud = createCloud (101);
+  cloud[5].x = std::numeric_limits<float>::quiet_NaN ();
+  cloud.is_dense = false;
+  Eigen::Affine3f transform;
+  pcl::getTransformation (0.1f, -0.5f, 2.0f, 0.3f, 1.2f, -0.7f, transform);
+
+  PointCloud<PointXYZRGBNormal> expected;
+  pcl::transformPointCloudWithNormals (cloud, expected, transform);
+
+  PointCloudSoA soa, transformed;
+  toPointCloudSoA (cloud, soa);
+  pcl::transformPointCloudWithNormals (soa, transformed, transform);
+  ASSERT_EQ (cloud.size (), transformed.size ());
+  EXPECT_EQ (soa.rgba, transformed.rgba);
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+  {
+    if (i == 5)
+    {
+      EXPECT_FALSE (std::isfinite (transformed.x[i]));
+      continue;
+    }
+    EXPECT_NEAR (expected[i].x, transformed.x[i], 1e-5);
+    EXPECT_NEAR (expected[i].y, transformed.y[i], 1e-5);
+    EXPECT_NEAR (expected[i].z, transformed.z[i], 1e-5);
+    EXPECT_NEAR (expected[i].normal_x, transformed.normal_x[i], 1e-5);
+    EXPECT_NEAR (expected[i].normal_y, transformed.normal_y[i], 1e-5);
+    EXPECT_NEAR (expected[i].normal_z, transformed.normal_z[i], 1e-5);
+  }
+
+  // In place, the normals being copied but not rotated
+  pcl::transformPointCloud (soa, soa, transform);
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+  {
+    if (i == 5)
+      continue;
+    EXPECT_EQ (transformed.x[i], soa.x[i]);
+    EXPECT_EQ (transformed.z[i], soa.z[i]);
+    EXPECT_EQ (cloud[i].normal_x, soa.normal_x[i]);
+  }
+
+  // Without copying the other fields
+  pcl::transformPointCloud (soa, transformed, transform.inverse (), false);
+  EXPECT_FALSE (transformed.hasNormals ());
+  EXPECT_FALSE (transformed.hasColors ());
+  EXPECT_NEAR (cloud[7].y, transformed.y[7], 1e-5);
+}
+
+TEST (PointCloudSoA, SquaredEuclideanDistances)
+{
+  const PointCloud<PointXYZRGBNormal> cloud = createCloud (23);
+  PointCloudSoA soa;
+  toPointCloudSoA (cloud, soa);
+
+  const Eigen::Vector3f point (0.5f, -0.25f, 0.1f);
+  std::vector<float> sqr_distances (soa.size ());
+  pcl::squaredEuclideanDistances (soa.getView (), point, sqr_distances.data ());
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+    EXPECT_NEAR ((cloud[i].getVector3fMap () - point).squaredNorm (), sqr_distances[i], 1e-6);
+
+  // On a view
+  pcl::squaredEuclideanDistances (soa.getView (10, 3), point, sqr_distances.data ());
+  EXPECT_NEAR ((cloud[11].getVector3fMap () - point).squaredNorm (), sqr_distances[1], 1e-6);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
@@ -0,0 +1,213 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/test/gtest.h>
+
+#include <pcl/point_types.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_cloud_view.h>
+#include <pcl/conversions.h>
+#include <pcl/common/pca.h>
+
+#include <cstdint>
+
+#include "test_point_cloud_data.h"
+
+using namespace pcl;
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PointCloudView, MatchingLayout)
+{
+  const PointCloud<PointXYZRGBNormal> cloud = createCloud (16, 8, "view");
+  PCLPointCloud2 msg;
+  toPCLPointCloud2 (cloud, msg);
+  ASSERT_TRUE (hasPointLayout<PointXYZRGBNormal> (msg));
+
+  // The view points in the buffer of the blob
+  PointCloudView<PointXYZRGBNormal> view;
+  ASSERT_TRUE (makePointCloudView (msg, view));
+  EXPECT_EQ (reinterpret_cast<const PointXYZRGBNormal*> (msg.data.data ()), view.data ());
+  EXPECT_EQ ("view", view.header.frame_id);
+  EXPECT_EQ (16, view.width);
+  EXPECT_EQ (8, view.height);
+  EXPECT_TRUE (view.isOrganized ());
+  ASSERT_EQ (cloud.size (), view.size ());
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+  {
+    EXPECT_EQ (cloud[i].getVector3fMap (), view[i].getVector3fMap ());
+    EXPECT_EQ (cloud[i].getNormalVector3fMap (), view[i].getNormalVector3fMap ());
+    EXPECT_EQ (cloud[i].rgba, view[i].rgba);
+    EXPECT_EQ (cloud[i].curvature, view[i].curvature);
+  }
+  EXPECT_EQ (&view[3 * 16 + 5], &view.at (5, 3));
+  EXPECT_EQ (&view[3 * 16 + 5], &view (5, 3));
+  EXPECT_EQ (cloud.size (), static_cast<std::size_t> (view.end () - view.begin ()));
+
+  // No conversion when the layouts match
+  PointCloud<PointXYZRGBNormal> storage;
+  const PointCloudView<PointXYZRGBNormal> view_or_copy = viewPCLPointCloud2 (msg, storage);
+  EXPECT_EQ (view.data (), view_or_copy.data ());
+  EXPECT_TRUE (storage.empty ());
+
+  // A subset of the points of a view
+  PointCloud<PointXYZRGBNormal> subset;
+  copyPointCloud (view, Indices {7, 2, 100}, subset);
+  ASSERT_EQ (3, subset.size ());
+  EXPECT_EQ (1, subset.height);
+  EXPECT_EQ (cloud[2].rgba, subset[1].rgba);
+  EXPECT_EQ (cloud[100].getVector3fMap (), subset[2].getVector3fMap ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PointCloudView, SharedOwnership)
+{
+  const PointCloud<PointXYZRGBNormal> cloud = createCloud (100, 1, "view");
+  PCLPointCloud2::Ptr msg (new PCLPointCloud2);
+  toPCLPointCloud2 (cloud, *msg);
+
+  PointCloudView<PointXYZRGBNormal> view;
+  ASSERT_TRUE (makePointCloudView (PCLPointCloud2::ConstPtr (msg), view));
+  msg.reset ();
+
+  // The view keeps the blob alive
+  ASSERT_EQ (cloud.size (), view.size ());
+  EXPECT_FALSE (view.isOrganized ());
+  PointCloud<PointXYZRGBNormal> copy;
+  copyPointCloud (view, copy);
+  ASSERT_EQ (cloud.size (), copy.size ());
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+  {
+    EXPECT_EQ (cloud[i].getVector3fMap (), copy[i].getVector3fMap ());
+    EXPECT_EQ (cloud[i].rgba, copy[i].rgba);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PointCloudView, DifferentLayout)
+{
+  const PointCloud<PointXYZRGBNormal> cloud = createCloud (20, 5, "view");
+  PCLPointCloud2 msg;
+  toPCLPointCloud2 (cloud, msg);
+
+  // A different point size
+  PointCloudView<PointXYZ> xyz_view;
+  EXPECT_FALSE (hasPointLayout<PointXYZ> (msg));
+  EXPECT_FALSE (makePointCloudView (msg, xyz_view));
+  EXPECT_EQ (nullptr, xyz_view.data ());
+
+  // The points are converted when the layouts differ
+  PointCloud<PointXYZ> storage;
+  const PointCloudView<PointXYZ> converted = viewPCLPointCloud2 (msg, storage);
+  ASSERT_EQ (cloud.size (), storage.size ());
+  EXPECT_EQ (storage.points.data (), converted.data ());
+  EXPECT_EQ (20, converted.width);
+  EXPECT_EQ (5, converted.height);
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+    EXPECT_EQ (cloud[i].getVector3fMap (), converted[i].getVector3fMap ());
+
+  // Same point size, but a field moved
+  PCLPointCloud2 moved = msg;
+  for (auto &field : moved.fields)
+    if (field.name == "curvature")
+      field.offset += 4;
+  PointCloudView<PointXYZRGBNormal> view;
+  EXPECT_FALSE (makePointCloudView (moved, view));
+
+  // Same point size, but a field missing
+  PCLPointCloud2 missing = msg;
+  missing.fields.pop_back ();
+  EXPECT_FALSE (makePointCloudView (missing, view));
+
+  // Padding at the end of the rows
+  PCLPointCloud2 padded = msg;
+  padded.row_step += 16;
+  padded.data.resize (padded.row_step * padded.height);
+  EXPECT_FALSE (makePointCloudView (padded, view));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PointCloudView, PointCloud)
+{
+  const PointCloud<PointXYZRGBNormal> cloud = createCloud (10, 10, "view");
+  const PointCloudView<PointXYZRGBNormal> view (cloud);
+  EXPECT_EQ (cloud.points.data (), view.data ());
+  EXPECT_EQ (cloud.size (), view.size ());
+  EXPECT_EQ (cloud.width, view.width);
+  EXPECT_EQ (cloud.height, view.height);
+  EXPECT_EQ (cloud.is_dense, view.is_dense);
+  EXPECT_EQ (&cloud.at (3, 4), &view.at (3, 4));
+
+  const PointCloudView<PointXYZRGBNormal> empty;
+  EXPECT_TRUE (empty.empty ());
+  EXPECT_EQ (empty.begin (), empty.end ());
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PointCloudView, PCLBaseInput)
+{
+  const PointCloud<PointXYZRGBNormal> cloud = createCloud (16, 8, "view");
+  PCLPointCloud2 msg;
+  toPCLPointCloud2 (cloud, msg);
+  PointCloudView<PointXYZRGBNormal> view;
+  ASSERT_TRUE (makePointCloudView (msg, view));
+
+  // A PCLBase algorithm is given a copy of the view, or of only the points it uses
+  const IndicesPtr indices (new Indices {3, 17, 42, 64, 100, 127});
+  PointCloud<PointXYZRGBNormal>::Ptr copy (new PointCloud<PointXYZRGBNormal>);
+  PointCloud<PointXYZRGBNormal>::Ptr subset (new PointCloud<PointXYZRGBNormal>);
+  copyPointCloud (view, *copy);
+  copyPointCloud (view, *indices, *subset);
+
+  PCA<PointXYZRGBNormal> pca, copy_pca, subset_pca;
+  pca.setInputCloud (cloud.makeShared ());
+  pca.setIndices (indices);
+  copy_pca.setInputCloud (copy);
+  copy_pca.setIndices (indices);
+  subset_pca.setInputCloud (subset);
+  EXPECT_TRUE (pca.getMean ().isApprox (copy_pca.getMean ()));
+  EXPECT_TRUE (pca.getMean ().isApprox (subset_pca.getMean ()));
+  EXPECT_TRUE (pca.getEigenValues ().isApprox (subset_pca.getEigenValues ()));
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
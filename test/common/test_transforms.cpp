@@ -45,9 +45,13 @@
 #include <pcl/point_cloud.h>
 #include <pcl/common/transforms.h>
 #include <pcl/common/io.h>
+#include <pcl/common/time.h>
 
 #include <pcl/pcl_tests.h>
 
+#include <cstring>
+#include <iostream>
+
 using namespace pcl;
 
 using TransformTypes = ::testing::Types
@@ -279,6 +283,152 @@ TEST (PCL, Matrix4Affine3Transform)
   EXPECT_NEAR (pt.z, ct[0].z, 1e-4);
 }
 
+template <typename PointT> void
+makeTransformKernelCloud (pcl::PointCloud<PointT> &cloud, std::size_t size)
+{
+  cloud.resize (size);
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    cloud[i].getVector4fMap () = Eigen::Vector4f::Random () * 10.f;
+    cloud[i].data[3] = 1.f;
+  }
+  // A few invalid points, which must be left untouched, with the invalid value in each coordinate
+  for (std::size_t i = 0; i < size; i += 97)
+    cloud[i].x = std::numeric_limits<float>::quiet_NaN ();
+  for (std::size_t i = 1; i < size; i += 101)
+    cloud[i].y = std::numeric_limits<float>::infinity ();
+  for (std::size_t i = 2; i < size; i += 103)
+    cloud[i].z = -std::numeric_limits<float>::infinity ();
+  cloud.is_dense = false;
+}
+
+// The kernels do the same operations as the default one, without fusing multiplications and additions,
+// so their results must be identical
+template <typename PointT> void
+expectTransformedEqual (const pcl::PointCloud<PointT> &cloud, const pcl::PointCloud<PointT> &ref)
+{
+  ASSERT_EQ (cloud.size (), ref.size ());
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+  {
+    if (!pcl::isFinite (ref[i]))
+    {
+      // Untouched
+      ASSERT_EQ (0, std::memcmp (&cloud[i], &ref[i], sizeof (PointT)));
+      continue;
+    }
+    ASSERT_EQ (cloud[i].x, ref[i].x);
+    ASSERT_EQ (cloud[i].y, ref[i].y);
+    ASSERT_EQ (cloud[i].z, ref[i].z);
+    ASSERT_EQ (cloud[i].data[3], ref[i].data[3]);
+  }
+}
+
+template <> void
+expectTransformedEqual (const pcl::PointCloud<pcl::PointXYZRGBNormal> &cloud, const pcl::PointCloud<pcl::PointXYZRGBNormal> &ref)
+{
+  ASSERT_EQ (cloud.size (), ref.size ());
+  // Transformed or untouched, the whole point must match, normal and color included
+  for (std::size_t i = 0; i < cloud.size (); ++i)
+    ASSERT_EQ (0, std::memcmp (&cloud[i], &ref[i], sizeof (pcl::PointXYZRGBNormal)));
+}
+
+TEST (PCL, TransformPointsKernels)
+{
+  const Eigen::Matrix4f tf = (Eigen::Translation3f (1.f, -2.f, 3.f) *
+                              Eigen::AngleAxisf (0.7f, Eigen::Vector3f (1.f, 2.f, 3.f).normalized ())).matrix ();
+  // Odd size, to exercise the remainder of the wide kernels
+  const std::size_t size = 100003;
+
+  pcl::PointCloud<pcl::PointXYZ> xyz, xyz_ref, xyz_out;
+  makeTransformKernelCloud (xyz, size);
+  pcl::PointCloud<pcl::PointXYZRGBNormal> xyzn, xyzn_ref, xyzn_out;
+  makeTransformKernelCloud (xyzn, size);
+  for (auto &p : xyzn.points)
+    p.getNormalVector4fMap () = Eigen::Vector4f (p.y, p.z, 1.f, 0.f).normalized ();
+  const std::ptrdiff_t normal_offset = reinterpret_cast<const std::uint8_t*> (xyzn[0].data_n) -
+                                       reinterpret_cast<const std::uint8_t*> (xyzn[0].data);
+
+  using pcl::detail::TransformKernel;
+  EXPECT_TRUE (pcl::detail::isTransformKernelSupported (TransformKernel::AUTO));
+  EXPECT_TRUE (pcl::detail::isTransformKernelSupported (TransformKernel::DEFAULT));
+
+  xyz_ref = xyz;
+  pcl::detail::transformPoints (xyz[0].data, xyz_ref[0].data, size, sizeof (pcl::PointXYZ), -1, tf, true, 1, TransformKernel::DEFAULT);
+  xyzn_ref = xyzn;
+  pcl::detail::transformPoints (xyzn[0].data, xyzn_ref[0].data, size, sizeof (pcl::PointXYZRGBNormal), normal_offset, tf, true, 1, TransformKernel::DEFAULT);
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    if (!pcl::isFinite (xyz[i]))
+    {
+      // Untouched
+      EXPECT_EQ (0, std::memcmp (&xyz[i], &xyz_ref[i], sizeof (pcl::PointXYZ)));
+      EXPECT_EQ (0, std::memcmp (&xyzn[i], &xyzn_ref[i], sizeof (pcl::PointXYZRGBNormal)));
+      continue;
+    }
+    ASSERT_XYZ_NEAR (xyz_ref[i], pcl::transformPoint (xyz[i], Eigen::Affine3f (tf)), 1e-4);
+    ASSERT_NORMAL_NEAR (xyzn_ref[i], pcl::transformPointWithNormal (xyzn[i], Eigen::Affine3f (tf)), 1e-4);
+  }
+
+  for (const auto kernel : {TransformKernel::AUTO, TransformKernel::AVX, TransformKernel::AVX512})
+  {
+    for (const unsigned int nr_threads : {1, 4})
+    {
+      SCOPED_TRACE (static_cast<int> (kernel) * 10 + nr_threads);
+      xyz_out = xyz;
+      pcl::detail::transformPoints (xyz[0].data, xyz_out[0].data, size, sizeof (pcl::PointXYZ), -1, tf, true, nr_threads, kernel);
+      expectTransformedEqual (xyz_out, xyz_ref);
+
+      // In place, with normals
+      xyzn_out = xyzn;
+      pcl::detail::transformPoints (xyzn_out[0].data, xyzn_out[0].data, size, sizeof (pcl::PointXYZRGBNormal), normal_offset, tf, true, nr_threads, kernel);
+      expectTransformedEqual (xyzn_out, xyzn_ref);
+    }
+  }
+
+  // The whole cloud transforms go through the same kernels
+  pcl::transformPointCloud (xyz, xyz_out, tf, true, 4);
+  expectTransformedEqual (xyz_out, xyz_ref);
+  xyzn_out = xyzn;
+  pcl::transformPointCloudWithNormals (xyzn_out, xyzn_out, Eigen::Affine3f (tf), true, 4);
+  expectTransformedEqual (xyzn_out, xyzn_ref);
+}
+
+TEST (PCL, TransformPointsKernelsBenchmark)
+{
+  const Eigen::Matrix4f tf = (Eigen::Translation3f (1.f, -2.f, 3.f) *
+                              Eigen::AngleAxisf (0.7f, Eigen::Vector3f::UnitZ ())).matrix ();
+  const std::size_t size = 1 << 20;
+  const int nr_runs = 10;
+
+  pcl::PointCloud<pcl::PointXYZRGBNormal> cloud, ref, out;
+  makeTransformKernelCloud (cloud, size);
+  const std::ptrdiff_t normal_offset = reinterpret_cast<const std::uint8_t*> (cloud[0].data_n) -
+                                       reinterpret_cast<const std::uint8_t*> (cloud[0].data);
+  ref = cloud;
+  pcl::detail::transformPoints (cloud[0].data, ref[0].data, size, sizeof (pcl::PointXYZRGBNormal), normal_offset, tf, true, 1,
+                                pcl::detail::TransformKernel::DEFAULT);
+
+  using pcl::detail::TransformKernel;
+  const std::pair<TransformKernel, const char*> kernels[] = {{TransformKernel::DEFAULT, "default"},
+                                                              {TransformKernel::AVX, "avx"},
+                                                              {TransformKernel::AVX512, "avx512"}};
+  for (const auto &kernel : kernels)
+  {
+    if (!pcl::detail::isTransformKernelSupported (kernel.first))
+    {
+      std::cout << kernel.second << ": not supported by this CPU" << std::endl;
+      continue;
+    }
+    out = cloud;
+    pcl::StopWatch timer;
+    for (int run = 0; run < nr_runs; ++run)
+      pcl::detail::transformPoints (cloud[0].data, out[0].data, size, sizeof (pcl::PointXYZRGBNormal), normal_offset, tf, true, 1,
+                                    kernel.first);
+    std::cout << kernel.second << ": " << timer.getTime () / nr_runs << " ms per " << size << " points with normals" << std::endl;
+    expectTransformedEqual (out, ref);
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
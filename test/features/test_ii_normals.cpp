@@ -342,6 +342,69 @@ TEST(PCL, IntegralImage3D)
   delete[] data;
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(PCL, IntegralImage3DRecurrence)
+{
+  // The integral images used to be built with the I(r,c) = I(r-1,c) + I(r,c-1) - I(r-1,c-1) + x recurrence.
+  // Summing the rows first and then the columns only changes the rounding.
+  const unsigned width = 163;
+  const unsigned height = 121;
+  std::vector<float> data (width * height * 3);
+  srand (5);
+  for (std::size_t i = 0; i < data.size (); ++i)
+    data[i] = 20.0f * static_cast<float> (rand ()) / static_cast<float> (RAND_MAX) - 10.0f;
+  for (std::size_t i = 0; i < data.size (); i += 3 * 31)
+    data[i + 1] = std::numeric_limits<float>::quiet_NaN ();
+
+  using ElementType = IntegralImage2D<float, 3>::ElementType;
+  using SecondOrderType = IntegralImage2D<float, 3>::SecondOrderType;
+  const std::size_t stride = width + 1;
+  std::vector<ElementType> first_order (stride * (height + 1), ElementType::Zero ());
+  std::vector<SecondOrderType> second_order (stride * (height + 1), SecondOrderType::Zero ());
+  std::vector<unsigned> count (stride * (height + 1), 0);
+  for (std::size_t row = 1; row <= height; ++row)
+  {
+    for (std::size_t col = 1; col <= width; ++col)
+    {
+      const std::size_t idx = row * stride + col;
+      first_order[idx] = first_order[idx - stride] + first_order[idx - 1] - first_order[idx - stride - 1];
+      second_order[idx] = second_order[idx - stride] + second_order[idx - 1] - second_order[idx - stride - 1];
+      count[idx] = count[idx - stride] + count[idx - 1] - count[idx - stride - 1];
+      const float *element = &data[((row - 1) * width + col - 1) * 3];
+      if (!std::isfinite (element[0] + element[1] + element[2]))
+        continue;
+      for (unsigned i = 0, so_idx = 0; i < 3; ++i)
+      {
+        first_order[idx][i] += element[i];
+        for (unsigned j = i; j < 3; ++j, ++so_idx)
+          second_order[idx][so_idx] += element[i] * element[j];
+      }
+      ++count[idx];
+    }
+  }
+
+  for (const unsigned nr_threads : {1, 3})
+  {
+    IntegralImage2D<float, 3> integral_image (true);
+    integral_image.setNumberOfThreads (nr_threads);
+    integral_image.setInput (&data[0], width, height, 3, width * 3);
+    for (unsigned row = 0; row <= height; ++row)
+    {
+      for (unsigned col = 0; col <= width; ++col)
+      {
+        const std::size_t idx = row * stride + col;
+        ASSERT_EQ (count[idx], integral_image.getFiniteElementsCountSE (0, 0, col, row));
+        const ElementType sum = integral_image.getFirstOrderSumSE (0, 0, col, row);
+        const SecondOrderType sum_sqr = integral_image.getSecondOrderSumSE (0, 0, col, row);
+        for (int i = 0; i < 3; ++i)
+          ASSERT_NEAR (first_order[idx][i], sum[i], 1e-8);
+        for (int i = 0; i < 6; ++i)
+          ASSERT_NEAR (second_order[idx][i], sum_sqr[i], 1e-6);
+      }
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, NormalEstimation)
 {
@@ -490,6 +553,68 @@ TEST (PCL, IINormalEstimationSimple3DGradient)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, IINormalEstimationMultithreaded)
+{
+  PointCloud<PointXYZ>::Ptr wave (new PointCloud<PointXYZ>);
+  wave->width = 160;
+  wave->height = 120;
+  wave->points.resize (wave->width * wave->height);
+  for (std::size_t v = 0; v < wave->height; ++v)
+  {
+    for (std::size_t u = 0; u < wave->width; ++u)
+    {
+      (*wave) (u, v).x = static_cast<float> (u) * 0.01f;
+      (*wave) (u, v).y = static_cast<float> (v) * 0.01f;
+      (*wave) (u, v).z = 1.0f + 0.1f * std::sin (static_cast<float> (u) * 0.1f) * std::cos (static_cast<float> (v) * 0.07f);
+      if ((u * 7 + v * 13) % 97 == 0)
+        (*wave) (u, v).z = std::numeric_limits<float>::quiet_NaN ();
+    }
+  }
+
+  const IntegralImageNormalEstimation<PointXYZ, Normal>::NormalEstimationMethod methods[] =
+    { ne.COVARIANCE_MATRIX, ne.AVERAGE_3D_GRADIENT, ne.AVERAGE_DEPTH_CHANGE };
+  for (const auto method : methods)
+  {
+    for (const auto border_policy : { ne.BORDER_POLICY_IGNORE, ne.BORDER_POLICY_MIRROR })
+    {
+      IntegralImageNormalEstimation<PointXYZ, Normal> ne_single, ne_multi;
+      PointCloud<Normal> output_single, output_multi;
+      for (auto* estimator : { &ne_single, &ne_multi })
+      {
+        estimator->setNormalEstimationMethod (method);
+        estimator->setBorderPolicy (border_policy);
+        estimator->setNormalSmoothingSize (5.0f);
+        estimator->setDepthDependentSmoothing (true);
+      }
+      ne_multi.setNumberOfThreads (4);
+      EXPECT_EQ (ne_multi.getNumberOfThreads (), 4);
+
+      ne_single.setInputCloud (wave);
+      ne_single.compute (output_single);
+
+      // The second estimator reuses its buffers from a previous, different frame
+      ne_multi.setInputCloud (cloud.makeShared ());
+      ne_multi.compute (output_multi);
+      ne_multi.setInputCloud (wave);
+      ne_multi.compute (output_multi);
+
+      ASSERT_EQ (output_single.size (), output_multi.size ());
+      for (std::size_t i = 0; i < output_single.size (); ++i)
+      {
+        if (!std::isfinite (output_single[i].normal_x))
+        {
+          EXPECT_FALSE (std::isfinite (output_multi[i].normal_x));
+          continue;
+        }
+        EXPECT_EQ (output_single[i].normal_x, output_multi[i].normal_x);
+        EXPECT_EQ (output_single[i].normal_y, output_multi[i].normal_y);
+        EXPECT_EQ (output_single[i].normal_z, output_multi[i].normal_z);
+      }
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, IINormalEstimationSimple3DGradientUnorganized)
 {
@@ -274,6 +274,168 @@ TEST (PCL, NormalEstimationOpenMP)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NormalEstimationPrecomputedNeighborhoods)
+{
+  PointCloud<PointXYZ>::ConstPtr cloudptr = cloud.makeShared ();
+  IndicesConstPtr query_indices (new std::vector<int> (indices.begin (), indices.begin () + indices.size () / 2));
+  KdTreePtr surface_tree (new search::KdTree<PointXYZ> (false));
+
+  NormalEstimationOMP<PointXYZ, Normal> n (4);
+  n.setInputCloud (cloudptr);
+  n.setSearchMethod (surface_tree);
+  n.setKSearch (10);
+  PointCloud<Normal> reference;
+  n.compute (reference);
+
+  // Neighbors of all the points, shared by two estimators
+  PrecomputedNeighborhoods<PointXYZ>::Ptr neighborhoods (new PrecomputedNeighborhoods<PointXYZ> (4));
+  neighborhoods->setInputCloud (cloudptr);
+  neighborhoods->setSearchMethod (surface_tree);
+  neighborhoods->setKSearch (10);
+  ASSERT_TRUE (neighborhoods->compute ());
+  EXPECT_EQ (neighborhoods->getNeighborhoods ().size (), cloud.size ());
+
+  PointCloud<Normal> normals, normals_single;
+  n.setSearchNeighborhoods (neighborhoods);
+  n.compute (normals);
+  NormalEstimation<PointXYZ, Normal> n_single;
+  n_single.setInputCloud (cloudptr);
+  n_single.setKSearch (10);
+  n_single.setSearchNeighborhoods (neighborhoods);
+  n_single.compute (normals_single);
+  ASSERT_EQ (normals.size (), reference.size ());
+  ASSERT_EQ (normals_single.size (), reference.size ());
+  for (std::size_t i = 0; i < reference.size (); ++i)
+  {
+    for (int j = 0; j < 3; ++j)
+    {
+      EXPECT_NEAR (normals[i].normal[j], reference[i].normal[j], 1e-4);
+      EXPECT_NEAR (normals_single[i].normal[j], reference[i].normal[j], 1e-4);
+    }
+    EXPECT_NEAR (normals[i].curvature, reference[i].curvature, 1e-4);
+  }
+
+  // Neighbors of a subset of the points; the other points fall back to the search method
+  neighborhoods->setInputCloud (cloudptr, query_indices);
+  ASSERT_TRUE (neighborhoods->compute ());
+  EXPECT_EQ (neighborhoods->getNeighborhoods ().size (), query_indices->size ());
+  EXPECT_TRUE (neighborhoods->hasNeighbors (query_indices->back ()));
+  EXPECT_FALSE (neighborhoods->hasNeighbors (query_indices->back () + 1));
+  n.compute (normals);
+  ASSERT_EQ (normals.size (), reference.size ());
+  for (std::size_t i = 0; i < reference.size (); ++i)
+    for (int j = 0; j < 3; ++j)
+      EXPECT_NEAR (normals[i].normal[j], reference[i].normal[j], 1e-4);
+
+  // Neighbors searched with another parameter are rejected
+  n.setKSearch (20);
+  n.compute (normals);
+  EXPECT_EQ (normals.size (), 0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NormalEstimationFarFromOrigin)
+{
+  // The same neighborhood far away from the origin keeps its normal in single precision
+  PointCloud<PointXYZ>::Ptr shifted_cloud (new PointCloud<PointXYZ> (cloud));
+  for (auto &point : *shifted_cloud)
+    point.getVector3fMap () += Eigen::Vector3f (100.0f, 100.0f, 100.0f);
+
+  NormalEstimation<PointXYZ, Normal> n;
+  n.setInputCloud (shifted_cloud);
+  n.setIndices (pcl::IndicesPtr (new pcl::Indices (indices)));
+  n.setSearchMethod (KdTreePtr (new search::KdTree<PointXYZ> (false)));
+  n.setKSearch (static_cast<int> (indices.size ()));
+  PointCloud<Normal> normals;
+  n.compute (normals);
+  ASSERT_EQ (normals.size (), indices.size ());
+  for (const auto &point : normals)
+  {
+    EXPECT_NEAR (std::abs (point.normal[0]), 0.035592, 1e-3);
+    EXPECT_NEAR (std::abs (point.normal[1]), 0.369596, 1e-3);
+    EXPECT_NEAR (std::abs (point.normal[2]), 0.928511, 1e-3);
+    EXPECT_NEAR (point.curvature, 0.0693136, 1e-3);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NeighborhoodPCAKernels)
+{
+  std::vector<detail::PCAKernel> kernels {detail::PCAKernel::DEFAULT};
+  if (detail::isPCAKernelSupported (detail::PCAKernel::AVX))
+    kernels.push_back (detail::PCAKernel::AVX);
+
+  // Neighborhoods of all the sizes, with flat and elongated ones
+  detail::NeighborhoodCoordinates coordinates;
+  std::vector<Eigen::Matrix3f, Eigen::aligned_allocator<Eigen::Matrix3f> > covariance_matrices;
+  for (std::size_t size = 1; size <= indices.size (); ++size)
+  {
+    const std::vector<int> neighborhood (indices.begin (), indices.begin () + size);
+    detail::gatherNeighborhood (cloud, neighborhood, cloud[neighborhood.back ()].getVector3fMap (), false, coordinates);
+    ASSERT_EQ (coordinates.size, size);
+    Eigen::Matrix3f reference;
+    detail::computeNeighborhoodCovariance (coordinates, reference, detail::PCAKernel::DEFAULT);
+    for (const auto kernel : kernels)
+    {
+      Eigen::Matrix3f covariance_matrix;
+      detail::computeNeighborhoodCovariance (coordinates, covariance_matrix, kernel);
+      for (int i = 0; i < 9; ++i)
+        EXPECT_EQ (covariance_matrix (i), reference (i));
+    }
+    Eigen::Matrix3f covariance_matrix;
+    Eigen::Vector4f centroid;
+    computeMeanAndCovarianceMatrix (cloud, neighborhood, covariance_matrix, centroid);
+    for (int i = 0; i < 9; ++i)
+      EXPECT_NEAR (reference (i), covariance_matrix (i), 1e-6);
+    covariance_matrices.push_back (reference);
+    covariance_matrices.push_back (reference.cwiseProduct (Eigen::Vector3f (1.0f, 1e-3f, 1.0f) * Eigen::Vector3f (1.0f, 1e-3f, 1.0f).transpose ()));
+  }
+  covariance_matrices.push_back (Eigen::Matrix3f::Identity ());
+  covariance_matrices.push_back (Eigen::Matrix3f::Zero ());
+
+  for (const auto eigenvector : {detail::PCAEigenvector::SMALLEST, detail::PCAEigenvector::LARGEST})
+  {
+    for (std::size_t begin = 0; begin < covariance_matrices.size (); begin += detail::PCABatch::capacity)
+    {
+      detail::PCABatch reference;
+      for (std::size_t i = begin; i < std::min (begin + detail::PCABatch::capacity, covariance_matrices.size ()); ++i)
+        reference.push_back (covariance_matrices[i], i);
+      detail::PCABatch batch = reference;
+      detail::solvePCABatch (reference, eigenvector, detail::PCAKernel::DEFAULT);
+
+      // All the kernels give the same results
+      for (const auto kernel : kernels)
+      {
+        detail::solvePCABatch (batch, eigenvector, kernel);
+        for (std::size_t i = 0; i < batch.size; ++i)
+          for (int j = 0; j < 3; ++j)
+          {
+            EXPECT_EQ (batch.eigenvalues[j][i], reference.eigenvalues[j][i]);
+            if (std::isfinite (reference.eigenvector[j][i]))
+              EXPECT_EQ (batch.eigenvector[j][i], reference.eigenvector[j][i]);
+          }
+      }
+
+      // They agree with eigen33
+      for (std::size_t i = 0; i < reference.size; ++i)
+      {
+        const Eigen::Matrix3f &covariance_matrix = covariance_matrices[reference.tags[i]];
+        Eigen::Vector3f eigenvalues;
+        eigen33 (covariance_matrix, eigenvalues);
+        for (int j = 0; j < 3; ++j)
+          EXPECT_NEAR (reference.eigenvalues[j][i], eigenvalues[j], 1e-4 * eigenvalues[2]);
+        if (eigenvalues[1] - eigenvalues[0] <= 1e-3 * eigenvalues[2] || eigenvalues[2] - eigenvalues[1] <= 1e-3 * eigenvalues[2])
+          continue;
+        Eigen::Vector3f expected;
+        computeCorrespondingEigenVector (covariance_matrix, eigenvector == detail::PCAEigenvector::SMALLEST ? eigenvalues[0] : eigenvalues[2], expected);
+        const Eigen::Vector3f result (reference.eigenvector[0][i], reference.eigenvector[1][i], reference.eigenvector[2][i]);
+        EXPECT_NEAR (std::abs (result.dot (expected)), 1.0f, 1e-4);
+      }
+    }
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // This tests the indexing issue from #3573
 // In certain cases when you used a subset of the indices
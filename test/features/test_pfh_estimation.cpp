@@ -448,6 +448,91 @@ TYPED_TEST (FPFHTest, Estimation)
   (cloud, cloud, test_indices, 33);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, FPFHEstimationOMPIndicesAndSearchSurface)
+{
+  // The neighbors of the query points are reused between the SPFH and the weighting passes
+  pcl::IndicesPtr test_indices (new pcl::Indices (0));
+  for (std::size_t i = 0; i < cloud->size (); i+=3)
+    test_indices->push_back (static_cast<int> (i));
+
+  testIndicesAndSearchSurface<FPFHEstimationOMP, PointT, PointT, FPFHSignature33>
+  (cloud, cloud, test_indices, 33);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, computePairFeaturesBatch)
+{
+  // Pairs made by the first point and each of the following ones, two of them coinciding with the first point.
+  // The number of pairs is not a multiple of the vector width, so both the vector and the scalar code run
+  const int nr_pairs = 43;
+  Eigen::Matrix<float, Eigen::Dynamic, 6> points_normals (nr_pairs, 6);
+  for (int i = 0; i < nr_pairs; ++i)
+  {
+    points_normals.row (i).head<3> () = cloud->points[i + 1].getVector3fMap ();
+    points_normals.row (i).tail<3> () = cloud->points[i + 1].getNormalVector3fMap ();
+  }
+  points_normals.row (3).head<3> () = cloud->points[0].getVector3fMap ();
+  points_normals.row (nr_pairs - 1).head<3> () = cloud->points[0].getVector3fMap ();
+
+  Eigen::Matrix<float, Eigen::Dynamic, 3> features (nr_pairs, 3);
+  pcl::computePairFeatures (cloud->points[0].getVector4fMap (), cloud->points[0].getNormalVector4fMap (),
+                            points_normals, features);
+
+  float f1, f2, f3, f4;
+  for (int i = 0; i < nr_pairs; ++i)
+  {
+    Eigen::Vector4f p2 (points_normals (i, 0), points_normals (i, 1), points_normals (i, 2), 1.0f);
+    Eigen::Vector4f n2 (points_normals (i, 3), points_normals (i, 4), points_normals (i, 5), 0.0f);
+    pcl::computePairFeatures (cloud->points[0].getVector4fMap (), cloud->points[0].getNormalVector4fMap (),
+                              p2, n2, f1, f2, f3, f4);
+    EXPECT_NEAR (features (i, 0), f1, 1e-4);
+    EXPECT_NEAR (features (i, 1), f2, 1e-5);
+    EXPECT_NEAR (features (i, 2), f3, 1e-5);
+  }
+  for (const int i : {3, nr_pairs - 1})
+  {
+    EXPECT_EQ (features (i, 0), 0.0f);
+    EXPECT_EQ (features (i, 1), 0.0f);
+    EXPECT_EQ (features (i, 2), 0.0f);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, FPFHEstimationSPFHDuplicatedNeighbor)
+{
+  // The same neighborhood, without and with a duplicate of the query point under another index
+  PointCloud<PointT> duplicated = *cloud;
+  duplicated.push_back (duplicated[0]);
+  std::vector<int> neighbors;
+  for (int i = 0; i < 30; ++i)
+    neighbors.push_back (i);
+  std::vector<int> duplicated_neighbors = neighbors;
+  duplicated_neighbors.push_back (static_cast<int> (duplicated.size ()) - 1);
+
+  const int nr_bins = 11;
+  FPFHEstimation<PointT, PointT, FPFHSignature33> fpfh;
+  Eigen::MatrixXf hist_f1 = Eigen::MatrixXf::Zero (2, nr_bins), hist_f2 = hist_f1, hist_f3 = hist_f1;
+  fpfh.computePointSPFHSignature (duplicated, duplicated, 0, 0, neighbors, hist_f1, hist_f2, hist_f3);
+  fpfh.computePointSPFHSignature (duplicated, duplicated, 0, 1, duplicated_neighbors, hist_f1, hist_f2, hist_f3);
+
+  // Each pair but the one of the query point with itself counts, the degenerate one included
+  for (const Eigen::MatrixXf *hist : {&hist_f1, &hist_f2, &hist_f3})
+  {
+    EXPECT_NEAR (100.0f, hist->row (0).sum (), 1e-3);
+    EXPECT_NEAR (100.0f, hist->row (1).sum (), 1e-3);
+  }
+
+  // The degenerate pair has 0 features, which fall in the middle bin of each histogram
+  const float nr_pairs = static_cast<float> (neighbors.size () - 1);
+  for (const Eigen::MatrixXf *hist : {&hist_f1, &hist_f2, &hist_f3})
+  {
+    const Eigen::VectorXf counts = hist->row (0).transpose () * nr_pairs / 100.0f;
+    const Eigen::VectorXf duplicated_counts = hist->row (1).transpose () * (nr_pairs + 1.0f) / 100.0f;
+    for (int bin = 0; bin < nr_bins; ++bin)
+      EXPECT_NEAR (counts[bin] + (bin == nr_bins / 2 ? 1.0f : 0.0f), duplicated_counts[bin], 1e-3);
+  }
+}
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, VFHEstimation)
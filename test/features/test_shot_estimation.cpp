@@ -46,6 +46,9 @@
 #include "pcl/features/shot_lrf.h"
 #include <pcl/features/3dsc.h>
 #include <pcl/features/usc.h>
+#include <pcl/features/fpfh_omp.h>
+
+#include <atomic>
 
 using namespace pcl;
 using namespace pcl::io;
@@ -687,6 +690,145 @@ TYPED_TEST (SHOTShapeAndColorTest, Estimation)
   testSHOTLocalReferenceFrame<TypeParam, PointXYZRGBA, Normal, SHOT1344> (cloudWithColors.makeShared (), normals, test_indices);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// A k-d tree counting the single point radius searches, to check which estimators use the precomputed neighbors
+class CountingKdTree : public search::KdTree<PointXYZ>
+{
+  public:
+    using search::KdTree<PointXYZ>::radiusSearch;
+
+    CountingKdTree (bool sorted) : search::KdTree<PointXYZ> (sorted) {}
+
+    int
+    radiusSearch (const PointXYZ &point, double radius, Indices &k_indices, std::vector<float> &k_sqr_distances,
+                  unsigned int max_nn = 0) const override
+    {
+      ++nr_searches;
+      return (search::KdTree<PointXYZ>::radiusSearch (point, radius, k_indices, k_sqr_distances, max_nn));
+    }
+
+    int
+    radiusSearch (const PointXYZ &point, double radius, search::NeighborBuffer &neighbors,
+                  unsigned int max_nn = 0) const override
+    {
+      ++nr_searches;
+      return (search::KdTree<PointXYZ>::radiusSearch (point, radius, neighbors, max_nn));
+    }
+
+    mutable std::atomic<int> nr_searches {0};
+};
+
+TEST (PCL, SHOTAndFPFHPrecomputedNeighborhoods)
+{
+  const double radius = 0.04;
+  PointCloud<PointXYZ>::ConstPtr cloudptr = cloud.makeShared ();
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal> ());
+  NormalEstimationOMP<PointXYZ, Normal> n (4);
+  n.setInputCloud (cloudptr);
+  n.setKSearch (10);
+  n.compute (*normals);
+
+  // Reference descriptors, each estimator searching its own neighbors
+  SHOTEstimationOMP<PointXYZ, Normal, SHOT352> shot (4);
+  shot.setInputCloud (cloudptr);
+  shot.setInputNormals (normals);
+  shot.setRadiusSearch (radius);
+  PointCloud<SHOT352> shots_ref;
+  shot.compute (shots_ref);
+  FPFHEstimationOMP<PointXYZ, Normal, FPFHSignature33> fpfh (4);
+  fpfh.setInputCloud (cloudptr);
+  fpfh.setInputNormals (normals);
+  fpfh.setRadiusSearch (radius);
+  PointCloud<FPFHSignature33> fpfhs_ref;
+  fpfh.compute (fpfhs_ref);
+
+  // The same neighbors, searched once and shared by both estimators and by the local reference frames of SHOT
+  shared_ptr<CountingKdTree> counting_tree (new CountingKdTree (true));
+  PrecomputedNeighborhoods<PointXYZ>::Ptr neighborhoods (new PrecomputedNeighborhoods<PointXYZ> (4));
+  neighborhoods->setInputCloud (cloudptr);
+  neighborhoods->setSearchMethod (counting_tree);
+  neighborhoods->setRadiusSearch (radius);
+  ASSERT_TRUE (neighborhoods->compute ());
+  EXPECT_EQ (cloudptr, neighborhoods->getSearchSurface ());
+  EXPECT_TRUE (neighborhoods->getSortedResults ());
+  counting_tree->nr_searches = 0;
+
+  SHOTEstimationOMP<PointXYZ, Normal, SHOT352> shot_shared (4);
+  shot_shared.setInputCloud (cloudptr);
+  shot_shared.setInputNormals (normals);
+  shot_shared.setRadiusSearch (radius);
+  shot_shared.setSearchNeighborhoods (neighborhoods);
+  PointCloud<SHOT352> shots;
+  shot_shared.compute (shots);
+  FPFHEstimationOMP<PointXYZ, Normal, FPFHSignature33> fpfh_shared (4);
+  fpfh_shared.setInputCloud (cloudptr);
+  fpfh_shared.setInputNormals (normals);
+  fpfh_shared.setRadiusSearch (radius);
+  fpfh_shared.setSearchNeighborhoods (neighborhoods);
+  PointCloud<FPFHSignature33> fpfhs;
+  fpfh_shared.compute (fpfhs);
+  EXPECT_EQ (0, counting_tree->nr_searches);
+
+  ASSERT_EQ (shots_ref.size (), shots.size ());
+  for (std::size_t i = 0; i < shots.size (); ++i)
+  {
+    for (int j = 0; j < 9; ++j)
+      EXPECT_NEAR (shots_ref[i].rf[j], shots[i].rf[j], 1e-5);
+    for (int j = 0; j < 352; ++j)
+      EXPECT_NEAR (shots_ref[i].descriptor[j], shots[i].descriptor[j], 1e-5);
+  }
+  ASSERT_EQ (fpfhs_ref.size (), fpfhs.size ());
+  for (std::size_t i = 0; i < fpfhs.size (); ++i)
+    for (int j = 0; j < 33; ++j)
+      EXPECT_NEAR (fpfhs_ref[i].histogram[j], fpfhs[i].histogram[j], 1e-3);
+
+  // Unsorted neighbors are not shared with the local reference frames, whose disambiguation depends on the order
+  shared_ptr<CountingKdTree> unsorted_tree (new CountingKdTree (false));
+  neighborhoods->setSearchMethod (unsorted_tree);
+  ASSERT_TRUE (neighborhoods->compute ());
+  EXPECT_FALSE (neighborhoods->getSortedResults ());
+  unsorted_tree->nr_searches = 0;
+  SHOTEstimationOMP<PointXYZ, Normal, SHOT352> shot_unsorted (4);
+  shot_unsorted.setInputCloud (cloudptr);
+  shot_unsorted.setInputNormals (normals);
+  shot_unsorted.setRadiusSearch (radius);
+  shot_unsorted.setSearchNeighborhoods (neighborhoods);
+  shot_unsorted.compute (shots);
+  EXPECT_EQ (0, unsorted_tree->nr_searches);
+  ASSERT_EQ (shots_ref.size (), shots.size ());
+  for (std::size_t i = 0; i < shots.size (); ++i)
+    for (int j = 0; j < 9; ++j)
+      EXPECT_NEAR (shots_ref[i].rf[j], shots[i].rf[j], 1e-5);
+  SHOTLocalReferenceFrameEstimation<PointXYZ> lrf_unsorted;
+  lrf_unsorted.setInputCloud (cloudptr);
+  lrf_unsorted.setRadiusSearch (radius);
+  lrf_unsorted.setSearchNeighborhoods (neighborhoods);
+  PointCloud<ReferenceFrame> frames;
+  lrf_unsorted.compute (frames);
+  EXPECT_EQ (0, frames.size ());
+  neighborhoods->setSearchMethod (counting_tree);
+  ASSERT_TRUE (neighborhoods->compute ());
+
+  // Another estimator moving the shared search method to another surface does not make the neighbors valid for it
+  PointCloud<PointXYZ>::Ptr other_surface (new PointCloud<PointXYZ> (cloud));
+  NormalEstimation<PointXYZ, Normal> n_other;
+  n_other.setInputCloud (other_surface);
+  n_other.setSearchMethod (counting_tree);
+  n_other.setRadiusSearch (radius);
+  PointCloud<Normal> other_normals;
+  n_other.compute (other_normals);
+  EXPECT_EQ (other_surface, counting_tree->getInputCloud ());
+  EXPECT_EQ (cloudptr, neighborhoods->getSearchSurface ());
+  fpfh_shared.setSearchSurface (other_surface);
+  fpfh_shared.compute (fpfhs);
+  EXPECT_TRUE (fpfhs.empty ());
+
+  // Changing the search parameter discards the neighbors
+  neighborhoods->setRadiusSearch (2 * radius);
+  EXPECT_FALSE (neighborhoods->hasNeighbors (0));
+  EXPECT_EQ (nullptr, neighborhoods->getSearchSurface ());
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL,3DSCEstimation)
 {
@@ -48,6 +48,7 @@
 #include <pcl/filters/extract_indices.h>
 
 #include <pcl/common/transforms.h>
+#include <pcl/point_cloud_soa.h>
 #include <pcl/common/eigen.h>
 
 using namespace pcl;
@@ -771,6 +772,44 @@ TEST (CropBox, Filters)
 
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (CropBox, PointCloudSoA)
+{
+  PointCloud<PointXYZ>::Ptr input (new PointCloud<PointXYZ>);
+  for (int i = 0; i < 1000; ++i)
+  {
+    const Eigen::Vector3f p = Eigen::Vector3f::Random () * 2.0f;
+    input->push_back (PointXYZ (p[0], p[1], p[2]));
+  }
+  input->points[10].y = std::numeric_limits<float>::quiet_NaN ();
+  input->is_dense = false;
+  PointCloudSoA soa;
+  toPointCloudSoA (*input, soa);
+
+  CropBox<PointXYZ> crop_box (true);
+  crop_box.setInputCloud (input);
+  crop_box.setMin (Eigen::Vector4f (-0.8f, -1.0f, -0.5f, 1.0f));
+  crop_box.setMax (Eigen::Vector4f (0.9f, 0.7f, 1.2f, 1.0f));
+  Eigen::Affine3f transform;
+  pcl::getTransformation (0.1f, 0.2f, -0.3f, 0.4f, -0.5f, 0.6f, transform);
+
+  std::vector<int> indices, soa_indices;
+  for (const bool negative : {false, true})
+    for (const bool transformed : {false, true})
+    {
+      crop_box.setNegative (negative);
+      crop_box.setTranslation (transformed ? Eigen::Vector3f (0.3f, -0.2f, 0.1f) : Eigen::Vector3f::Zero ());
+      crop_box.setRotation (transformed ? Eigen::Vector3f (0.5f, 0.0f, -0.25f) : Eigen::Vector3f::Zero ());
+      crop_box.setTransform (transformed ? transform : Eigen::Affine3f::Identity ());
+      crop_box.filter (indices);
+      const Indices removed_indices = *crop_box.getRemovedIndices ();
+      crop_box.filter (soa, soa_indices);
+      EXPECT_FALSE (indices.empty ());
+      EXPECT_EQ (indices, soa_indices);
+      EXPECT_EQ (removed_indices, *crop_box.getRemovedIndices ());
+    }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
@@ -48,6 +48,7 @@
 #include <pcl/filters/frustum_culling.h>
 #include <pcl/filters/sampling_surface_normal.h>
 #include <pcl/filters/voxel_grid.h>
+#include <pcl/filters/hashed_voxel_grid.h>
 #include <pcl/filters/voxel_grid_covariance.h>
 #include <pcl/filters/extract_indices.h>
 #include <pcl/filters/project_inliers.h>
@@ -58,6 +59,7 @@
 #include <pcl/filters/normal_refinement.h>
 
 #include <pcl/common/transforms.h>
+#include <pcl/point_cloud_soa.h>
 #include <pcl/common/eigen.h>
 
 #include <pcl/segmentation/sac_segmentation.h>
@@ -562,6 +564,40 @@ TEST (PassThrough, Filters)
   EXPECT_NEAR (output.points[41].z, cloud->points[41].z, 1e-5);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PassThrough, PointCloudSoA)
+{
+  PointCloud<PointXYZ>::Ptr input (new PointCloud<PointXYZ> (*cloud));
+  input->points[3].x = std::numeric_limits<float>::quiet_NaN ();
+  input->points[7].z = std::numeric_limits<float>::infinity ();
+  input->is_dense = false;
+  PointCloudSoA soa;
+  toPointCloudSoA (*input, soa);
+
+  PassThrough<PointXYZ> pt (true);
+  pt.setInputCloud (input);
+  std::vector<int> indices, soa_indices;
+  for (const bool negative : {false, true})
+  {
+    pt.setNegative (negative);
+    for (const std::string field_name : {"", "x", "z"})
+    {
+      pt.setFilterFieldName (field_name);
+      pt.setFilterLimits (-0.02f, 0.1f);
+      pt.filter (indices);
+      const std::vector<int> removed_indices = *pt.getRemovedIndices ();
+      pt.filter (soa, soa_indices);
+      EXPECT_EQ (indices, soa_indices);
+      EXPECT_EQ (removed_indices, *pt.getRemovedIndices ());
+    }
+  }
+
+  // The field has to be stored in the point cloud
+  pt.setFilterFieldName ("normal_x");
+  pt.filter (soa, soa_indices);
+  EXPECT_TRUE (soa_indices.empty ());
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (VoxelGrid, Filters)
 {
@@ -722,6 +758,70 @@ TEST (VoxelGrid, Filters)
   EXPECT_LE (output.points[neighbors2.at (0)].z - output.points[centroidIdx2].z, 0.02 * 2);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (VoxelGrid_MultiThreaded, Filters)
+{
+  PointCloud<PointXYZ> output_serial, output_parallel;
+  VoxelGrid<PointXYZ> grid;
+
+  grid.setLeafSize (0.01f, 0.01f, 0.01f);
+  grid.setInputCloud (cloud);
+
+  // Unsorted indices exercise the ordering of the points inside each leaf
+  IndicesPtr indices (new std::vector<int> (cloud->points.size ()));
+  for (std::size_t i = 0; i < indices->size (); ++i)
+    (*indices)[i] = static_cast<int> (indices->size () - 1 - i);
+
+  for (const bool use_indices : {false, true})
+  {
+    for (const bool downsample_all_data : {true, false})
+    {
+      if (use_indices)
+        grid.setIndices (indices);
+      grid.setDownsampleAllData (downsample_all_data);
+      grid.setSaveLeafLayout (true);
+
+      grid.setNumberOfThreads (1);
+      grid.filter (output_serial);
+      const std::vector<int> leaf_layout_serial = grid.getLeafLayout ();
+
+      grid.setNumberOfThreads (4);
+      EXPECT_EQ (grid.getNumberOfThreads (), 4u);
+      grid.filter (output_parallel);
+
+      ASSERT_EQ (output_serial.points.size (), output_parallel.points.size ());
+      EXPECT_EQ (output_serial.width, output_parallel.width);
+      EXPECT_EQ (output_serial.height, output_parallel.height);
+      for (std::size_t i = 0; i < output_serial.points.size (); ++i)
+      {
+        // The result has to be bit-identical, not only close
+        EXPECT_EQ (output_serial.points[i].x, output_parallel.points[i].x);
+        EXPECT_EQ (output_serial.points[i].y, output_parallel.points[i].y);
+        EXPECT_EQ (output_serial.points[i].z, output_parallel.points[i].z);
+      }
+      EXPECT_EQ (leaf_layout_serial, grid.getLeafLayout ());
+    }
+  }
+
+  // Distance filtering and the minimum number of points per voxel in threaded mode
+  grid.setFilterFieldName ("z");
+  grid.setFilterLimits (0.05, 0.1);
+  grid.setMinimumPointsNumberPerVoxel (2);
+
+  grid.setNumberOfThreads (1);
+  grid.filter (output_serial);
+  grid.setNumberOfThreads (4);
+  grid.filter (output_parallel);
+
+  ASSERT_EQ (output_serial.points.size (), output_parallel.points.size ());
+  for (std::size_t i = 0; i < output_serial.points.size (); ++i)
+  {
+    EXPECT_EQ (output_serial.points[i].x, output_parallel.points[i].x);
+    EXPECT_EQ (output_serial.points[i].y, output_parallel.points[i].y);
+    EXPECT_EQ (output_serial.points[i].z, output_parallel.points[i].z);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (VoxelGrid_No_DownsampleAllData, Filters)
 {
@@ -1244,6 +1344,88 @@ TEST (VoxelGrid_XYZNormal, Filters)
 
 #endif
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (HashedVoxelGrid, Filters)
+{
+  PointCloud<PointXYZ> output, output_grid;
+  HashedVoxelGrid<PointXYZ> hashed_grid;
+  VoxelGrid<PointXYZ> grid;
+
+  hashed_grid.setLeafSize (0.02f, 0.02f, 0.02f);
+  hashed_grid.setInputCloud (cloud);
+  hashed_grid.filter (output);
+
+  EXPECT_EQ (int (output.points.size ()), 103);
+  EXPECT_EQ (int (output.width), 103);
+  EXPECT_EQ (int (output.height), 1);
+  EXPECT_EQ (bool (output.is_dense), true);
+  EXPECT_EQ (hashed_grid.getNumberOfVoxels (), 103u);
+
+  // Same centroids as VoxelGrid, in a different order
+  grid.setLeafSize (0.02f, 0.02f, 0.02f);
+  grid.setInputCloud (cloud);
+  grid.filter (output_grid);
+  ASSERT_EQ (output.points.size (), output_grid.points.size ());
+  for (const auto &point : output.points)
+  {
+    bool found = false;
+    for (std::size_t i = 0; i < output_grid.points.size () && !found; ++i)
+      found = (point.getVector3fMap () - output_grid.points[i].getVector3fMap ()).norm () < 1e-5;
+    EXPECT_TRUE (found);
+  }
+
+  // Accumulating the cloud in two parts gives the same result
+  PointCloud<PointXYZ> first_half, second_half, output_incremental;
+  first_half.points.assign (cloud->points.begin (), cloud->points.begin () + cloud->points.size () / 2);
+  second_half.points.assign (cloud->points.begin () + cloud->points.size () / 2, cloud->points.end ());
+  hashed_grid.clear ();
+  EXPECT_EQ (hashed_grid.getNumberOfVoxels (), 0u);
+  hashed_grid.addPointCloud (first_half);
+  hashed_grid.addPointCloud (second_half);
+  hashed_grid.getCentroids (output_incremental);
+  ASSERT_EQ (output.points.size (), output_incremental.points.size ());
+  for (std::size_t i = 0; i < output.points.size (); ++i)
+  {
+    EXPECT_NEAR (output.points[i].x, output_incremental.points[i].x, 1e-5);
+    EXPECT_NEAR (output.points[i].y, output_incremental.points[i].y, 1e-5);
+    EXPECT_NEAR (output.points[i].z, output_incremental.points[i].z, 1e-5);
+  }
+
+  // Minimum number of points per voxel
+  hashed_grid.setMinimumPointsNumberPerVoxel (5);
+  grid.setMinimumPointsNumberPerVoxel (5);
+  hashed_grid.filter (output);
+  grid.filter (output_grid);
+  EXPECT_EQ (output.points.size (), output_grid.points.size ());
+
+  // An extent VoxelGrid refuses, as its number of leaves would overflow an int
+  PointCloud<PointXYZ> wide_cloud;
+  for (int i = 0; i < 100; ++i)
+  {
+    wide_cloud.points.emplace_back (-1000.0f + 20.0f * i, 1000.0f - 20.0f * i, 0.5f * i);
+    wide_cloud.points.emplace_back (-1000.0f + 20.0f * i, 1000.0f - 20.0f * i, 0.5f * i);
+  }
+  wide_cloud.width = static_cast<std::uint32_t> (wide_cloud.points.size ());
+  wide_cloud.height = 1;
+  HashedVoxelGrid<PointXYZ> wide_grid;
+  wide_grid.setLeafSize (0.001f, 0.001f, 0.001f);
+  wide_grid.addPointCloud (wide_cloud);
+  wide_grid.getCentroids (output);
+  ASSERT_EQ (output.points.size (), 100u);
+  EXPECT_NEAR (output.points[99].x, wide_cloud.points[198].x, 1e-3);
+  EXPECT_NEAR (output.points[99].y, wide_cloud.points[198].y, 1e-3);
+  EXPECT_NEAR (output.points[99].z, wide_cloud.points[198].z, 1e-3);
+
+  // Non finite points are skipped, even in a cloud wrongly marked as dense
+  wide_cloud.points.emplace_back (std::numeric_limits<float>::quiet_NaN (), 0.0f, 0.0f);
+  wide_cloud.points.emplace_back (0.0f, std::numeric_limits<float>::infinity (), 0.0f);
+  wide_cloud.width = static_cast<std::uint32_t> (wide_cloud.points.size ());
+  wide_cloud.is_dense = true;
+  wide_grid.clear ();
+  wide_grid.addPointCloud (wide_cloud);
+  EXPECT_EQ (wide_grid.getNumberOfVoxels (), 100u);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (VoxelGridCovariance, Filters)
 {
@@ -1548,6 +1730,73 @@ TEST (StatisticalOutlierRemoval, Filters)
   EXPECT_NEAR (output.points[output.points.size () - 1].z, -0.0444, 1e-4);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (OutlierRemoval, Multithreaded)
+{
+  // The output and the removed indices do not depend on the number of threads
+  for (const bool negative : {false, true})
+  {
+    std::vector<int> indices[2], removed[2], indices2[2], removed2[2];
+    PCLPointCloud2 output2[2];
+    for (int t = 0; t < 2; ++t)
+    {
+      StatisticalOutlierRemoval<PointXYZ> sor (true);
+      sor.setInputCloud (cloud);
+      sor.setMeanK (50);
+      sor.setStddevMulThresh (1.0);
+      sor.setNegative (negative);
+      sor.setNumberOfThreads (t == 0 ? 1 : 4);
+      sor.filter (indices[t]);
+      removed[t] = *sor.getRemovedIndices ();
+
+      StatisticalOutlierRemoval<PCLPointCloud2> sor2 (true);
+      sor2.setInputCloud (cloud_blob);
+      sor2.setMeanK (50);
+      sor2.setStddevMulThresh (1.0);
+      sor2.setNegative (negative);
+      sor2.setNumberOfThreads (t == 0 ? 1 : 4);
+      sor2.filter (indices2[t]);
+      removed2[t] = *sor2.getRemovedIndices ();
+      sor2.filter (output2[t]);
+    }
+    EXPECT_EQ (indices[0], indices[1]);
+    EXPECT_EQ (removed[0], removed[1]);
+    EXPECT_EQ (indices[0].size () + removed[0].size (), cloud->size ());
+    EXPECT_EQ (indices2[0], indices2[1]);
+    EXPECT_EQ (removed2[0], removed2[1]);
+    EXPECT_EQ (indices2[0].size () + removed2[0].size (), cloud->size ());
+    EXPECT_EQ (output2[0].data, output2[1].data);
+
+    for (int t = 0; t < 2; ++t)
+    {
+      RadiusOutlierRemoval<PointXYZ> ror (true);
+      ror.setInputCloud (cloud);
+      ror.setRadiusSearch (0.02);
+      ror.setMinNeighborsInRadius (14);
+      ror.setNegative (negative);
+      ror.setNumberOfThreads (t == 0 ? 1 : 4);
+      ror.filter (indices[t]);
+      removed[t] = *ror.getRemovedIndices ();
+
+      RadiusOutlierRemoval<PCLPointCloud2> ror2 (true);
+      ror2.setInputCloud (cloud_blob);
+      ror2.setRadiusSearch (0.02);
+      ror2.setMinNeighborsInRadius (14);
+      ror2.setNegative (negative);
+      ror2.setNumberOfThreads (t == 0 ? 1 : 4);
+      ror2.filter (indices2[t]);
+      removed2[t] = *ror2.getRemovedIndices ();
+      ror2.filter (output2[t]);
+    }
+    EXPECT_EQ (indices[0], indices[1]);
+    EXPECT_EQ (removed[0], removed[1]);
+    EXPECT_EQ (indices[0].size () + removed[0].size (), cloud->size ());
+    EXPECT_EQ (indices2[0], indices2[1]);
+    EXPECT_EQ (removed2[0], removed2[1]);
+    EXPECT_EQ (output2[0].data, output2[1].data);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////
 TEST (ConditionalRemoval, Filters)
 {
@@ -43,6 +43,7 @@
 #include <pcl/point_types.h>
 #include <pcl/common/io.h>
 #include <pcl/console/print.h>
+#include <pcl/io/async_writer.h>
 #include <pcl/io/auto_io.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/io/ply_io.h>
@@ -1236,6 +1237,340 @@ TEST (PCL, LZFInMem)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, LazyPCDReader)
+{
+  PointCloud<PointXYZRGBNormal> cloud;
+  cloud.width  = 64;
+  cloud.height = 48;
+  cloud.points.resize (cloud.width * cloud.height);
+  cloud.sensor_origin_ = Eigen::Vector4f (1.0f, 2.0f, 3.0f, 0.0f);
+
+  srand (static_cast<unsigned int> (time (nullptr)));
+  for (auto &point : cloud.points)
+  {
+    point.x = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    point.y = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    point.z = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    point.normal_x = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    point.normal_y = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    point.normal_z = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    point.rgba = static_cast<std::uint32_t> (rand ());
+  }
+
+  PCDWriter writer;
+  EXPECT_EQ (0, writer.writeBinary ("test_pcl_io_lazy.pcd", cloud));
+  EXPECT_EQ (0, writer.writeBinaryCompressed ("test_pcl_io_lazy_compressed.pcd", cloud));
+  EXPECT_EQ (0, writer.writeASCII ("test_pcl_io_lazy_ascii.pcd", cloud));
+  writer.setChunkSize (100);
+  EXPECT_EQ (0, writer.writeBinaryCompressedChunked ("test_pcl_io_lazy_chunked.pcd", cloud));
+
+  LazyPCDReader reader;
+  EXPECT_FALSE (reader.isOpen ());
+  EXPECT_TRUE (reader.getPoints (0, 10).empty ());
+  EXPECT_GT (0, reader.open ("test_pcl_io_lazy_ascii.pcd"));
+  EXPECT_FALSE (reader.isOpen ());
+
+  for (const std::string file_name : {"test_pcl_io_lazy.pcd", "test_pcl_io_lazy_compressed.pcd", "test_pcl_io_lazy_chunked.pcd"})
+  {
+    ASSERT_EQ (0, reader.open (file_name));
+    ASSERT_TRUE (reader.isOpen ());
+    EXPECT_EQ (file_name != "test_pcl_io_lazy.pcd", reader.isCompressed ());
+    EXPECT_EQ (cloud.width, reader.getHeader ().width);
+    EXPECT_EQ (cloud.height, reader.getHeader ().height);
+    EXPECT_TRUE (reader.getHeader ().data.empty ());
+    EXPECT_EQ (cloud.size (), reader.size ());
+    EXPECT_EQ (cloud.sensor_origin_, reader.getOrigin ());
+
+    // A single field of a range of points
+    const LazyPCDReader::View y = reader.getField ("y", 100, 50);
+    ASSERT_EQ (50, y.size);
+    for (std::size_t i = 0; i < y.size; ++i)
+      EXPECT_EQ (cloud[100 + i].y, y.get<float> (i));
+    const LazyPCDReader::View normals = reader.getField ("normal_x", cloud.size () - 5);
+    ASSERT_EQ (5, normals.size);
+    EXPECT_EQ (cloud.back ().normal_x, normals.get<float> (4));
+    EXPECT_TRUE (reader.getField ("intensity").empty ());
+
+    // A row of points
+    const LazyPCDReader::View row = reader.getRow (7);
+    ASSERT_EQ (cloud.width, row.size);
+    EXPECT_EQ (reader.getHeader ().point_step, row.stride);
+    const int rgb_idx = pcl::getFieldIndex (reader.getHeader (), "rgb");
+    ASSERT_LE (0, rgb_idx);
+    for (std::size_t i = 0; i < row.size; ++i)
+      EXPECT_EQ (cloud.at (i, 7).rgba, row.get<std::uint32_t> (i, reader.getHeader ().fields[rgb_idx].offset / 4));
+    EXPECT_TRUE (reader.getRow (cloud.height).empty ());
+
+    // A subset of the points
+    const Indices indices {3, 2000, 17, 3000};
+    PointCloud<PointXYZ> xyz;
+    ASSERT_EQ (0, reader.read (indices, xyz));
+    ASSERT_EQ (indices.size (), xyz.size ());
+    for (std::size_t i = 0; i < indices.size (); ++i)
+      EXPECT_EQ (cloud[indices[i]].getVector3fMap (), xyz[i].getVector3fMap ());
+
+    pcl::PCLPointCloud2 blob;
+    ASSERT_EQ (0, reader.read (indices, blob));
+    PointCloud<PointXYZRGBNormal> subset;
+    pcl::fromPCLPointCloud2 (blob, subset);
+    ASSERT_EQ (indices.size (), subset.size ());
+    for (std::size_t i = 0; i < indices.size (); ++i)
+    {
+      EXPECT_EQ (cloud[indices[i]].getNormalVector3fMap (), subset[i].getNormalVector3fMap ());
+      EXPECT_EQ (cloud[indices[i]].rgba, subset[i].rgba);
+    }
+    EXPECT_GT (0, reader.read (Indices {static_cast<index_t> (cloud.size ())}, blob));
+
+    reader.close ();
+    EXPECT_FALSE (reader.isOpen ());
+  }
+
+  remove ("test_pcl_io_lazy.pcd");
+  remove ("test_pcl_io_lazy_compressed.pcd");
+  remove ("test_pcl_io_lazy_ascii.pcd");
+  remove ("test_pcl_io_lazy_chunked.pcd");
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, PCDReaderWriterChunked)
+{
+  PointCloud<PointXYZRGBNormal> cloud;
+  cloud.width  = 1000;
+  cloud.height = 3;
+  cloud.points.resize (cloud.width * cloud.height);
+
+  srand (static_cast<unsigned int> (time (nullptr)));
+  for (auto &point : cloud.points)
+  {
+    point.x = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    point.y = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    point.z = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    point.normal_x = point.normal_y = point.normal_z = 0.0f;
+    point.curvature = static_cast<float> (rand () % 4);
+    point.rgba = static_cast<std::uint32_t> (rand ());
+  }
+  cloud.points[2500].x = std::numeric_limits<float>::quiet_NaN ();
+
+  pcl::PCLPointCloud2 blob;
+  pcl::toPCLPointCloud2 (cloud, blob);
+
+  PCDWriter writer;
+  PCDReader reader;
+  // A chunk size which does not divide the number of points, one chunk, and one point per chunk
+  for (const unsigned int chunk_size : {128u, 100000u, 1u})
+  {
+    for (const unsigned int threads : {1u, 4u})
+    {
+      writer.setChunkSize (chunk_size);
+      writer.setNumberOfThreads (threads);
+      EXPECT_EQ (0, writer.writeBinaryCompressedChunked ("test_pcl_io_chunked.pcd", blob));
+
+      pcl::PCLPointCloud2 blob2;
+      reader.setNumberOfThreads (threads);
+      ASSERT_EQ (0, reader.read ("test_pcl_io_chunked.pcd", blob2));
+      EXPECT_EQ (blob.width, blob2.width);
+      EXPECT_EQ (blob.height, blob2.height);
+      EXPECT_FALSE (blob2.is_dense);
+      PointCloud<PointXYZRGBNormal> cloud2;
+      pcl::fromPCLPointCloud2 (blob2, cloud2);
+      ASSERT_EQ (cloud.size (), cloud2.size ());
+      for (std::size_t i = 0; i < cloud.size (); ++i)
+      {
+        if (i == 2500)
+          EXPECT_TRUE (std::isnan (cloud2[i].x));
+        else
+          EXPECT_EQ (cloud[i].getVector3fMap (), cloud2[i].getVector3fMap ());
+        EXPECT_EQ (cloud[i].curvature, cloud2[i].curvature);
+        EXPECT_EQ (cloud[i].rgba, cloud2[i].rgba);
+      }
+    }
+  }
+
+  // The templated writer produces the same data
+  EXPECT_EQ (0, writer.writeBinaryCompressedChunked ("test_pcl_io_chunked.pcd", cloud));
+  PointCloud<PointXYZRGBNormal> cloud2;
+  ASSERT_EQ (0, pcl::io::loadPCDFile ("test_pcl_io_chunked.pcd", cloud2));
+  ASSERT_EQ (cloud.size (), cloud2.size ());
+  EXPECT_EQ (cloud[17].getVector3fMap (), cloud2[17].getVector3fMap ());
+  EXPECT_EQ (cloud.back ().rgba, cloud2.back ().rgba);
+
+  // A reader which only knows binary compressed data rejects the file
+  std::ifstream fs ("test_pcl_io_chunked.pcd", std::ios::binary);
+  const std::string file_content ((std::istreambuf_iterator<char> (fs)), std::istreambuf_iterator<char> ());
+  pcl::PCLPointCloud2 blob3;
+  Eigen::Vector4f origin;
+  Eigen::Quaternionf orientation;
+  int pcd_version, data_type;
+  unsigned int data_idx;
+  std::istringstream header_stream (file_content);
+  ASSERT_EQ (0, reader.readHeader (header_stream, blob3, origin, orientation, pcd_version, data_type, data_idx));
+  EXPECT_EQ (3, data_type);
+  const unsigned char *data = reinterpret_cast<const unsigned char*> (file_content.data ());
+  EXPECT_GT (0, reader.readBodyBinary (data, blob3, pcd_version, true, data_idx));
+
+  remove ("test_pcl_io_chunked.pcd");
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, AsyncWriter)
+{
+  PointCloud<PointXYZRGB>::Ptr cloud (new PointCloud<PointXYZRGB>);
+  cloud->width  = 320;
+  cloud->height = 2;
+  cloud->points.resize (cloud->width * cloud->height);
+  srand (static_cast<unsigned int> (time (nullptr)));
+  for (auto &point : cloud->points)
+  {
+    point.x = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    point.y = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    point.z = static_cast<float> (1024 * rand () / (RAND_MAX + 1.0));
+    point.rgba = static_cast<std::uint32_t> (rand ());
+  }
+
+  const int nr_frames = 10;
+  {
+    pcl::io::AsyncWriter writer (4, 2);
+    writer.setSyncInterval (3);
+    for (int i = 0; i < nr_frames; ++i)
+    {
+      writer.setFormat (i % 2 ? pcl::io::AsyncWriter::PLY_BINARY : pcl::io::AsyncWriter::PCD_BINARY_COMPRESSED);
+      const std::string file_name = "test_pcl_io_async_" + std::to_string (i) + (i % 2 ? ".ply" : ".pcd");
+      EXPECT_TRUE (writer.write<PointXYZRGB> (file_name, cloud));
+      EXPECT_GE (writer.getCapacity (), writer.getQueueSize ());
+    }
+    EXPECT_FALSE (writer.write<PointXYZRGB> ("test_pcl_io_async_empty.pcd", PointCloud<PointXYZRGB>::ConstPtr ()));
+    writer.flush ();
+    EXPECT_EQ (0, writer.getQueueSize ());
+
+    const pcl::io::AsyncWriter::Statistics statistics = writer.getStatistics ();
+    EXPECT_EQ (nr_frames, statistics.frames_queued);
+    EXPECT_EQ (nr_frames, statistics.frames_written);
+    EXPECT_EQ (0, statistics.frames_dropped);
+    EXPECT_EQ (0, statistics.frames_failed);
+    EXPECT_LT (0, statistics.bytes_written);
+    EXPECT_LE (3, statistics.syncs);
+    EXPECT_LT (0.0, statistics.getThroughput ());
+  }
+
+  for (int i = 0; i < nr_frames; ++i)
+  {
+    const std::string file_name = "test_pcl_io_async_" + std::to_string (i) + (i % 2 ? ".ply" : ".pcd");
+    PointCloud<PointXYZRGB> cloud2;
+    if (i % 2)
+      ASSERT_EQ (0, loadPLYFile (file_name, cloud2));
+    else
+      ASSERT_EQ (0, loadPCDFile (file_name, cloud2));
+    ASSERT_EQ (cloud->size (), cloud2.size ());
+    for (std::size_t j = 0; j < cloud->size (); ++j)
+    {
+      EXPECT_EQ ((*cloud)[j].getVector3fMap (), cloud2[j].getVector3fMap ());
+      EXPECT_EQ ((*cloud)[j].getRGBVector3i (), cloud2[j].getRGBVector3i ());
+    }
+    remove (file_name.c_str ());
+  }
+}
+
+// Exposes the queue of AsyncWriter with frames which are written when the test says so
+class BlockingAsyncWriter : public pcl::io::AsyncWriter
+{
+  public:
+    BlockingAsyncWriter () : pcl::io::AsyncWriter (2, 1) {}
+
+    bool
+    write (const std::string &file_name, std::vector<std::string> &written)
+    {
+      return (enqueue (file_name, [this, &written] (const std::string &file_name, Format)
+      {
+        std::unique_lock<std::mutex> lock (mutex_);
+        started_ = true;
+        started_cond_.notify_all ();
+        release_cond_.wait (lock, [this] { return (released_); });
+        std::ofstream (file_name).close ();
+        written.push_back (file_name);
+        return (0);
+      }));
+    }
+
+    bool
+    writeThrowing (const std::string &file_name)
+    {
+      return (enqueue (file_name, [] (const std::string&, Format) -> int
+      {
+        throw std::runtime_error ("No space left on device");
+      }));
+    }
+
+    void
+    waitForStart ()
+    {
+      std::unique_lock<std::mutex> lock (mutex_);
+      started_cond_.wait (lock, [this] { return (started_); });
+    }
+
+    void
+    release ()
+    {
+      std::lock_guard<std::mutex> lock (mutex_);
+      released_ = true;
+      release_cond_.notify_all ();
+    }
+
+  private:
+    std::mutex mutex_;
+    std::condition_variable started_cond_, release_cond_;
+    bool started_ = false, released_ = false;
+};
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, AsyncWriterOverflow)
+{
+  for (const auto policy : {pcl::io::AsyncWriter::DROP_NEWEST, pcl::io::AsyncWriter::DROP_OLDEST})
+  {
+    std::vector<std::string> written;
+    BlockingAsyncWriter writer;
+    writer.setOverflowPolicy (policy);
+    // The first frame is being written, the next two fill the queue
+    EXPECT_TRUE (writer.write ("test_pcl_io_async_a", written));
+    writer.waitForStart ();
+    EXPECT_TRUE (writer.write ("test_pcl_io_async_b", written));
+    EXPECT_TRUE (writer.write ("test_pcl_io_async_c", written));
+    EXPECT_EQ (2, writer.getQueueSize ());
+    EXPECT_FALSE (writer.write ("test_pcl_io_async_d", written));
+    EXPECT_EQ (2, writer.getQueueSize ());
+    writer.release ();
+    writer.flush ();
+
+    const std::vector<std::string> expected = policy == pcl::io::AsyncWriter::DROP_NEWEST ?
+      std::vector<std::string> {"test_pcl_io_async_a", "test_pcl_io_async_b", "test_pcl_io_async_c"} :
+      std::vector<std::string> {"test_pcl_io_async_a", "test_pcl_io_async_c", "test_pcl_io_async_d"};
+    EXPECT_EQ (expected, written);
+    EXPECT_EQ (1, writer.getStatistics ().frames_dropped);
+    EXPECT_EQ (3, writer.getStatistics ().frames_written);
+    for (const auto &file_name : written)
+      remove (file_name.c_str ());
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, AsyncWriterException)
+{
+  std::vector<std::string> written;
+  BlockingAsyncWriter writer;
+  writer.release ();
+  // A throwing frame counts as failed, and the worker thread keeps on writing the next ones
+  EXPECT_TRUE (writer.writeThrowing ("test_pcl_io_async_a"));
+  writer.flush ();
+  EXPECT_EQ (1, writer.getStatistics ().frames_failed);
+  EXPECT_EQ (0, writer.getStatistics ().frames_written);
+  EXPECT_TRUE (writer.write ("test_pcl_io_async_b", written));
+  writer.flush ();
+  EXPECT_EQ (std::vector<std::string> {"test_pcl_io_async_b"}, written);
+  EXPECT_EQ (1, writer.getStatistics ().frames_written);
+  for (const auto &file_name : written)
+    remove (file_name.c_str ());
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, Locale)
 {
@@ -42,6 +42,10 @@
 #include <pcl/point_types.h>
 #include <pcl/test/gtest.h>
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, PLYReaderWriter)
 {
@@ -531,6 +535,225 @@ TEST_F (PLYTest, CommentAtTheEnd)
   ASSERT_EQ (cloud.empty(), false);
 }
 
+/** \brief Gives access to the binary vertices reader, to check which files it reads. */
+class PLYReaderProbe : public pcl::PLYReader
+{
+  public:
+    using pcl::PLYReader::readBinaryVertices;
+};
+
+void
+expectSameCloud (const pcl::PCLPointCloud2 &cloud, const pcl::PCLPointCloud2 &ref)
+{
+  EXPECT_EQ (cloud.width, ref.width);
+  EXPECT_EQ (cloud.height, ref.height);
+  EXPECT_EQ (cloud.point_step, ref.point_step);
+  EXPECT_EQ (cloud.row_step, ref.row_step);
+  EXPECT_EQ (cloud.is_dense, ref.is_dense);
+  ASSERT_EQ (cloud.fields.size (), ref.fields.size ());
+  for (std::size_t f = 0; f < ref.fields.size (); ++f)
+  {
+    EXPECT_EQ (cloud.fields[f].name, ref.fields[f].name);
+    EXPECT_EQ (cloud.fields[f].offset, ref.fields[f].offset);
+    EXPECT_EQ (cloud.fields[f].datatype, ref.fields[f].datatype);
+    EXPECT_EQ (cloud.fields[f].count, ref.fields[f].count);
+  }
+  EXPECT_EQ (cloud.data, ref.data);
+}
+
+bool
+isHostBigEndian ()
+{
+  const std::uint16_t one = 1;
+  std::uint8_t first_byte;
+  std::memcpy (&first_byte, &one, 1);
+  return (first_byte == 0);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F (PLYTest, BinaryMatchesASCII)
+{
+  // Binary vertices are read without the per-scalar callbacks and must give the same cloud as the parser
+  const char* header_begin = "ply\n";
+  const char* header_end = "element vertex 3\n"
+                           "property float x\n"
+                           "property float y\n"
+                           "property float z\n"
+                           "property uchar red\n"
+                           "property uchar green\n"
+                           "property uchar blue\n"
+                           "property uchar alpha\n"
+                           "property uchar intensity\n"
+                           "property double curvature\n"
+                           "property short label\n"
+                           "end_header\n";
+  const float xyz[3][3] = {{1.5f, -2.25f, 3.f}, {0.f, 4.5f, -1.f}, {7.f, 8.125f, 9.f}};
+  const std::uint8_t rgbai[3][5] = {{255, 0, 10, 200, 7}, {1, 2, 3, 4, 5}, {100, 150, 250, 255, 0}};
+  const double curvature[3] = {0.5, -0.25, 1024.};
+  const std::int16_t label[3] = {-3, 0, 32000};
+
+  const std::string ascii_file = "test_ply_ascii.ply";
+  std::ofstream fs (ascii_file.c_str ());
+  fs << header_begin << "format ascii 1.0\n" << header_end;
+  for (int i = 0; i < 3; ++i)
+  {
+    fs << xyz[i][0] << " " << xyz[i][1] << " " << xyz[i][2];
+    for (const auto &c : rgbai[i])
+      fs << " " << static_cast<int> (c);
+    fs << " " << curvature[i] << " " << label[i] << "\n";
+  }
+  fs.close ();
+
+  pcl::PLYReader reader;
+  pcl::PCLPointCloud2 ascii_cloud;
+  ASSERT_EQ (reader.read (ascii_file, ascii_cloud), 0);
+  remove (ascii_file.c_str ());
+
+  for (const bool big_endian : {false, true})
+  {
+    const std::string binary_file = "test_ply_binary.ply";
+    fs.open (binary_file.c_str (), std::ios::binary);
+    fs << header_begin << (big_endian ? "format binary_big_endian 1.0\n" : "format binary_little_endian 1.0\n")
+       << header_end;
+    const auto write_value = [&] (auto value)
+    {
+      char bytes[sizeof (value)];
+      std::memcpy (bytes, &value, sizeof (value));
+      if (big_endian)
+        std::reverse (bytes, bytes + sizeof (value));
+      fs.write (bytes, sizeof (value));
+    };
+    for (int i = 0; i < 3; ++i)
+    {
+      for (const auto &v : xyz[i])
+        write_value (v);
+      for (const auto &c : rgbai[i])
+        write_value (c);
+      write_value (curvature[i]);
+      write_value (label[i]);
+    }
+    fs.close ();
+
+    PLYReaderProbe probe;
+    pcl::PCLPointCloud2 fast_cloud;
+    EXPECT_TRUE (probe.readBinaryVertices (binary_file, fast_cloud));
+    pcl::PCLPointCloud2 binary_cloud;
+    ASSERT_EQ (reader.read (binary_file, binary_cloud), 0);
+    remove (binary_file.c_str ());
+
+    expectSameCloud (binary_cloud, ascii_cloud);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F (PLYTest, BinaryPlainCopy)
+{
+  // Float properties in the byte order of the host have the layout of the cloud, and are read with a single call
+  const char* header = "element vertex 4\n"
+                       "property float x\n"
+                       "property float y\n"
+                       "property float z\n"
+                       "property float intensity\n"
+                       "end_header\n";
+  const float values[4][4] = {{1.5f, -2.25f, 3.f, 0.5f}, {0.f, 4.5f, -1.f, 1.f},
+                              {7.f, 8.125f, 9.f, std::numeric_limits<float>::quiet_NaN ()}, {-1.f, -2.f, -3.f, 2.f}};
+
+  std::ofstream fs (mesh_file_ply_.c_str ());
+  fs << "ply\nformat ascii 1.0\n" << header;
+  for (const auto &vertex : values)
+    fs << vertex[0] << " " << vertex[1] << " " << vertex[2] << " " << vertex[3] << "\n";
+  fs.close ();
+  pcl::PLYReader reader;
+  pcl::PCLPointCloud2 ascii_cloud;
+  ASSERT_EQ (reader.read (mesh_file_ply_, ascii_cloud), 0);
+
+  fs.open (mesh_file_ply_.c_str (), std::ios::binary);
+  fs << "ply\n" << (isHostBigEndian () ? "format binary_big_endian 1.0\n" : "format binary_little_endian 1.0\n")
+     << header;
+  fs.write (reinterpret_cast<const char*> (values), sizeof (values));
+  fs.close ();
+
+  PLYReaderProbe probe;
+  pcl::PCLPointCloud2 binary_cloud;
+  ASSERT_TRUE (probe.readBinaryVertices (mesh_file_ply_, binary_cloud));
+  expectSameCloud (binary_cloud, ascii_cloud);
+  EXPECT_FALSE (binary_cloud.is_dense);
+  ASSERT_EQ (sizeof (values), binary_cloud.data.size ());
+  EXPECT_EQ (0, std::memcmp (values, binary_cloud.data.data (), sizeof (values)));
+
+  // A truncated file is left to the parser
+  fs.open (mesh_file_ply_.c_str (), std::ios::binary);
+  fs << "ply\n" << (isHostBigEndian () ? "format binary_big_endian 1.0\n" : "format binary_little_endian 1.0\n")
+     << header;
+  fs.write (reinterpret_cast<const char*> (values), sizeof (values) - 1);
+  fs.close ();
+  EXPECT_FALSE (probe.readBinaryVertices (mesh_file_ply_, binary_cloud));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST_F (PLYTest, BinaryVerticesWithFaces)
+{
+  // The faces of a mesh follow the vertices, so they do not prevent reading the vertices without the parser
+  const char* vertex_header = "element vertex 4\n"
+                              "property float x\n"
+                              "property float y\n"
+                              "property float z\n"
+                              "property uchar red\n"
+                              "property uchar green\n"
+                              "property uchar blue\n"
+                              "element face 2\n"
+                              "property list uchar int vertex_indices\n"
+                              "end_header\n";
+  const float xyz[4][3] = {{0.f, 0.f, 0.f}, {1.f, 0.f, 0.f}, {0.f, 1.f, 0.f}, {1.f, 1.f, 0.5f}};
+  const std::uint8_t rgb[4][3] = {{255, 0, 0}, {0, 255, 0}, {0, 0, 255}, {10, 20, 30}};
+  const std::int32_t faces[2][3] = {{0, 1, 2}, {1, 3, 2}};
+
+  std::ofstream fs (mesh_file_ply_.c_str ());
+  fs << "ply\nformat ascii 1.0\n" << vertex_header;
+  for (int i = 0; i < 4; ++i)
+    fs << xyz[i][0] << " " << xyz[i][1] << " " << xyz[i][2] << " " << static_cast<int> (rgb[i][0]) << " "
+       << static_cast<int> (rgb[i][1]) << " " << static_cast<int> (rgb[i][2]) << "\n";
+  for (const auto &face : faces)
+    fs << "3 " << face[0] << " " << face[1] << " " << face[2] << "\n";
+  fs.close ();
+  pcl::PLYReader reader;
+  pcl::PCLPointCloud2 ascii_cloud;
+  ASSERT_EQ (reader.read (mesh_file_ply_, ascii_cloud), 0);
+
+  fs.open (mesh_file_ply_.c_str (), std::ios::binary);
+  fs << "ply\n" << (isHostBigEndian () ? "format binary_big_endian 1.0\n" : "format binary_little_endian 1.0\n")
+     << vertex_header;
+  for (int i = 0; i < 4; ++i)
+  {
+    fs.write (reinterpret_cast<const char*> (xyz[i]), sizeof (xyz[i]));
+    fs.write (reinterpret_cast<const char*> (rgb[i]), sizeof (rgb[i]));
+  }
+  for (const auto &face : faces)
+  {
+    const std::uint8_t size = 3;
+    fs.write (reinterpret_cast<const char*> (&size), 1);
+    fs.write (reinterpret_cast<const char*> (face), sizeof (face));
+  }
+  fs.close ();
+
+  PLYReaderProbe probe;
+  pcl::PCLPointCloud2 binary_cloud;
+  ASSERT_TRUE (probe.readBinaryVertices (mesh_file_ply_, binary_cloud));
+  expectSameCloud (binary_cloud, ascii_cloud);
+
+  // The mesh is still read by the parser, with its faces
+  pcl::PolygonMesh mesh;
+  ASSERT_EQ (reader.read (mesh_file_ply_, mesh), 0);
+  expectSameCloud (mesh.cloud, ascii_cloud);
+  ASSERT_EQ (2, mesh.polygons.size ());
+  for (std::size_t f = 0; f < 2; ++f)
+  {
+    ASSERT_EQ (3, mesh.polygons[f].vertices.size ());
+    for (std::size_t v = 0; v < 3; ++v)
+      EXPECT_EQ (faces[f][v], static_cast<std::int32_t> (mesh.polygons[f].vertices[v]));
+  }
+}
+
 /* ---[ */
 int
 main (int argc, char** argv)
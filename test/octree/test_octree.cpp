@@ -1450,6 +1450,69 @@ TEST (PCL, Octree_Pointcloud_Neighbours_Within_Radius_Search)
 
 }
 
+TEST (PCL, Octree_Pointcloud_Neighbours_Within_Radius_Group_Search)
+{
+  // instantiate point cloud
+  PointCloud<PointXYZ>::Ptr cloudIn (new PointCloud<PointXYZ> ());
+
+  srand (static_cast<unsigned int> (time (nullptr)));
+
+  cloudIn->width = 1000;
+  cloudIn->height = 1;
+  cloudIn->points.resize (cloudIn->width * cloudIn->height);
+
+  // generate point cloud data
+  for (std::size_t i = 0; i < 1000; i++)
+  {
+    cloudIn->points[i] = PointXYZ (static_cast<float> (10.0 * rand () / RAND_MAX),
+                                   static_cast<float> (10.0 * rand () / RAND_MAX),
+                                   static_cast<float> (5.0  * rand () / RAND_MAX));
+  }
+
+  OctreePointCloudSearch<PointXYZ> octree (0.5);
+
+  // build octree
+  octree.setInputCloud (cloudIn);
+  octree.addPointsFromInputCloud ();
+
+  // query points of the cloud, and a few random ones
+  OctreePointCloudSearch<PointXYZ>::AlignedPointTVector queries (cloudIn->points.begin (), cloudIn->points.begin () + 50);
+  for (std::size_t i = 0; i < 10; i++)
+  {
+    queries.push_back (PointXYZ (static_cast<float> (10.0 * rand () / RAND_MAX),
+                                 static_cast<float> (10.0 * rand () / RAND_MAX),
+                                 static_cast<float> (10.0 * rand () / RAND_MAX)));
+  }
+
+  std::vector<std::vector<int> > groupIndices;
+  std::vector<std::vector<float> > groupDistances;
+  std::vector<int> cloudNWRSearch;
+  std::vector<float> cloudNWRRadius;
+
+  // each query gets the neighbors of the single query search, in the same order
+  for (const double searchRadius : {0.3, 1.5})
+  {
+    for (const unsigned int max_nn : {0u, 5u})
+    {
+      octree.radiusSearch (queries, searchRadius, groupIndices, groupDistances, max_nn);
+
+      ASSERT_EQ (queries.size (), groupIndices.size ());
+      ASSERT_EQ (queries.size (), groupDistances.size ());
+      for (std::size_t i = 0; i < queries.size (); i++)
+      {
+        octree.radiusSearch (queries[i], searchRadius, cloudNWRSearch, cloudNWRRadius, max_nn);
+        EXPECT_EQ (cloudNWRSearch, groupIndices[i]);
+        EXPECT_EQ (cloudNWRRadius, groupDistances[i]);
+      }
+    }
+  }
+
+  // an empty group clears the results
+  octree.radiusSearch (OctreePointCloudSearch<PointXYZ>::AlignedPointTVector (), 1.5, groupIndices, groupDistances);
+  EXPECT_TRUE (groupIndices.empty ());
+  EXPECT_TRUE (groupDistances.empty ());
+}
+
 TEST (PCL, Octree_Pointcloud_Ray_Traversal)
 {
   constexpr unsigned int test_runs = 100;
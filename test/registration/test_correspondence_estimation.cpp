@@ -38,6 +38,7 @@
 #include <pcl/test/gtest.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/registration/correspondence_estimation_normal_shooting.h>
+#include <pcl/registration/correspondence_estimation_backprojection.h>
 #include <pcl/features/normal_3d.h>
 #include <pcl/kdtree/kdtree.h>
 
@@ -119,6 +120,80 @@ TEST (CorrespondenceEstimation, CorrespondenceEstimationSetSearchMethod)
   
 }
 
+//////////////////////////////////////////////////////////////////////////////////////
+void
+expectSameCorrespondences (const pcl::Correspondences &expected, const pcl::Correspondences &correspondences)
+{
+  ASSERT_EQ (expected.size (), correspondences.size ());
+  for (std::size_t i = 0; i < expected.size (); i++)
+  {
+    EXPECT_EQ (expected[i].index_query, correspondences[i].index_query);
+    EXPECT_EQ (expected[i].index_match, correspondences[i].index_match);
+    EXPECT_EQ (expected[i].distance, correspondences[i].distance);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+TEST (CorrespondenceEstimation, NumberOfThreads)
+{
+  // A noisy wave surface, and a shifted copy of it
+  pcl::PointCloud<pcl::PointXYZ>::Ptr source (new pcl::PointCloud<pcl::PointXYZ> ());
+  pcl::PointCloud<pcl::PointXYZ>::Ptr target (new pcl::PointCloud<pcl::PointXYZ> ());
+  srand (42);
+  for (float x = 0.0f; x < 4.0f; x += 0.1f)
+  {
+    for (float y = 0.0f; y < 4.0f; y += 0.1f)
+    {
+      const float noise = 0.01f * static_cast<float> (rand ()) / static_cast<float> (RAND_MAX);
+      source->points.emplace_back (x, y, std::sin (x) * std::cos (y) + noise);
+      target->points.emplace_back (x + 0.03f, y - 0.02f, std::sin (x) * std::cos (y) + 0.05f);
+    }
+  }
+
+  pcl::NormalEstimation<pcl::PointXYZ, pcl::Normal> ne;
+  ne.setKSearch (8);
+  pcl::PointCloud<pcl::Normal>::Ptr source_normals (new pcl::PointCloud<pcl::Normal>);
+  ne.setInputCloud (source);
+  ne.compute (*source_normals);
+  pcl::PointCloud<pcl::Normal>::Ptr target_normals (new pcl::PointCloud<pcl::Normal>);
+  ne.setInputCloud (target);
+  ne.compute (*target_normals);
+
+  pcl::registration::CorrespondenceEstimation<pcl::PointXYZ, pcl::PointXYZ> ce;
+  pcl::registration::CorrespondenceEstimationNormalShooting<pcl::PointXYZ, pcl::PointXYZ, pcl::Normal> ns;
+  ns.setSourceNormals (source_normals);
+  ns.setKSearch (10);
+  pcl::registration::CorrespondenceEstimationBackProjection<pcl::PointXYZ, pcl::PointXYZ, pcl::Normal> bp;
+  bp.setSourceNormals (source_normals);
+  bp.setTargetNormals (target_normals);
+  bp.setKSearch (10);
+
+  using Estimation = pcl::registration::CorrespondenceEstimationBase<pcl::PointXYZ, pcl::PointXYZ>;
+  const double max_distance = 0.06;
+  for (Estimation *estimation : std::vector<Estimation*> {&ce, &ns, &bp})
+  {
+    estimation->setInputSource (source);
+    estimation->setInputTarget (target);
+    for (const bool reciprocal : {false, true})
+    {
+      pcl::Correspondences expected, correspondences;
+      estimation->setNumberOfThreads (1);
+      if (reciprocal)
+        estimation->determineReciprocalCorrespondences (expected, max_distance);
+      else
+        estimation->determineCorrespondences (expected, max_distance);
+      EXPECT_LT (0, expected.size ());
+
+      estimation->setNumberOfThreads (4);
+      if (reciprocal)
+        estimation->determineReciprocalCorrespondences (correspondences, max_distance);
+      else
+        estimation->determineCorrespondences (correspondences, max_distance);
+      expectSameCorrespondences (expected, correspondences);
+    }
+  }
+}
+
 /* ---[ */
 int
   main (int argc, char** argv)
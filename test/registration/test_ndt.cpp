@@ -94,6 +94,45 @@ TEST (PCL, NormalDistributionsTransform)
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, NormalDistributionsTransformSearchMethodsAndThreads)
+{
+  using PointT = PointXYZ;
+  using NDT = NormalDistributionsTransform<PointT, PointT>;
+  PointCloud<PointT>::ConstPtr src = cloud_source.makeShared ();
+  PointCloud<PointT>::ConstPtr tgt = cloud_target.makeShared ();
+  PointCloud<PointT> output;
+
+  for (const NDT::NeighborSearchMethod method : {NDT::NeighborSearchMethod::KDTREE,
+                                                 NDT::NeighborSearchMethod::DIRECT7,
+                                                 NDT::NeighborSearchMethod::DIRECT1})
+  {
+    NDT reg;
+    reg.setNeighborSearchMethod (method);
+    EXPECT_EQ (method, reg.getNeighborSearchMethod ());
+    reg.setStepSize (0.05);
+    reg.setResolution (0.025f);
+    reg.setInputSource (src);
+    reg.setInputTarget (tgt);
+    reg.setMaximumIterations (50);
+    reg.setTransformationEpsilon (1e-8);
+
+    reg.setNumberOfThreads (1);
+    reg.align (output);
+    EXPECT_EQ (output.points.size (), cloud_source.points.size ());
+    EXPECT_LT (reg.getFitnessScore (), 0.001);
+    const Eigen::Matrix4f transformation = reg.getFinalTransformation ();
+    const int nr_iterations = reg.getFinalNumIteration ();
+
+    // The derivatives are summed in the same order for any number of threads
+    reg.setNumberOfThreads (4);
+    EXPECT_EQ (4, reg.getNumberOfThreads ());
+    reg.align (output);
+    EXPECT_EQ (nr_iterations, reg.getFinalNumIteration ());
+    EXPECT_EQ (transformation, reg.getFinalTransformation ());
+  }
+}
+
 int
 main (int argc, char** argv)
 {
@@ -586,6 +586,58 @@ TEST (PCL, GeneralizedIterativeClosestPoint)
   EXPECT_LT (reg.getFitnessScore (), 0.0001);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (PCL, GeneralizedIterativeClosestPointThreadsAndCovariances)
+{
+  using PointT = PointXYZ;
+  using GICP = GeneralizedIterativeClosestPoint<PointT, PointT>;
+  PointCloud<PointT>::Ptr src (new PointCloud<PointT>);
+  copyPointCloud (cloud_source, *src);
+  PointCloud<PointT>::Ptr tgt (new PointCloud<PointT>);
+  copyPointCloud (cloud_target, *tgt);
+  PointCloud<PointT> output;
+
+  GICP reg;
+  reg.setInputSource (src);
+  reg.setInputTarget (tgt);
+  reg.setMaximumIterations (50);
+  reg.setTransformationEpsilon (1e-8);
+  reg.align (output);
+  EXPECT_LT (reg.getFitnessScore (), 0.0001);
+  const Eigen::Matrix4f transformation = reg.getFinalTransformation ();
+
+  // The regularized covariances have the eigenvalues (epsilon, 1, 1)
+  const GICP::MatricesVectorPtr target_covariances = reg.getTargetCovariances ();
+  ASSERT_TRUE (target_covariances);
+  ASSERT_EQ (tgt->size (), target_covariances->size ());
+  for (const Eigen::Matrix3d &covariance : *target_covariances)
+  {
+    Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver (covariance);
+    EXPECT_NEAR (0.001, solver.eigenvalues () (0), 1e-9);
+    EXPECT_NEAR (1.0, solver.eigenvalues () (1), 1e-9);
+    EXPECT_NEAR (1.0, solver.eigenvalues () (2), 1e-9);
+  }
+
+  // The cost function is summed in the same order for any number of threads
+  GICP reg_threads;
+  reg_threads.setNumberOfThreads (4);
+  EXPECT_EQ (4, reg_threads.getNumberOfThreads ());
+  reg_threads.setInputSource (src);
+  reg_threads.setInputTarget (tgt);
+  reg_threads.setMaximumIterations (50);
+  reg_threads.setTransformationEpsilon (1e-8);
+  reg_threads.align (output);
+  EXPECT_EQ (transformation, reg_threads.getFinalTransformation ());
+
+  // Setting the target again resets its covariances, unless they are provided again
+  reg_threads.setInputTarget (tgt);
+  EXPECT_FALSE (reg_threads.getTargetCovariances ());
+  reg_threads.setTargetCovariances (target_covariances);
+  reg_threads.align (output);
+  EXPECT_EQ (target_covariances, reg_threads.getTargetCovariances ());
+  EXPECT_EQ (transformation, reg_threads.getFinalTransformation ());
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (PCL, GeneralizedIterativeClosestPoint6D)
 {
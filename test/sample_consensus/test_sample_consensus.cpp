@@ -44,12 +44,20 @@
 #include <pcl/sample_consensus/mlesac.h>
 #include <pcl/sample_consensus/ransac.h>
 #include <pcl/sample_consensus/rransac.h>
+#include <pcl/sample_consensus/sac_model_circle.h>
+#include <pcl/sample_consensus/sac_model_kernels.h>
+#include <pcl/sample_consensus/sac_model_line.h>
+#include <pcl/sample_consensus/sac_model_plane.h>
+#include <pcl/sample_consensus/sac_model_registration.h>
 #include <pcl/sample_consensus/sac_model_sphere.h>
+#include <pcl/common/time.h>
 
 #include <chrono>
 #include <condition_variable>
+#include <functional>
 #include <memory>
 #include <mutex>
+#include <random>
 #include <thread>
 
 using namespace pcl;
@@ -136,6 +144,183 @@ TYPED_TEST(SacTest, InfiniteLoop)
   thread.join ();
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+using pcl::detail::SacKernel;
+
+const std::pair<SacKernel, const char*> sac_kernels[] = {{SacKernel::DEFAULT, "default"},
+                                                          {SacKernel::SSE2, "sse2"},
+                                                          {SacKernel::AVX2, "avx2"}};
+
+// Random points around the unit sphere, with a few invalid ones
+void
+makeKernelCloud (PointCloud<PointXYZ> &cloud, Indices &indices, std::size_t size)
+{
+  std::mt19937 rng (42);
+  std::normal_distribution<float> direction;
+  std::uniform_real_distribution<float> radius (0.9f, 1.1f);
+  cloud.resize (size);
+  for (auto &p : cloud)
+  {
+    p.getVector3fMap () = Eigen::Vector3f (direction (rng), direction (rng), direction (rng)).normalized () * radius (rng);
+    if (rng () % 100 == 0)
+      p.z = std::numeric_limits<float>::quiet_NaN ();
+  }
+  cloud.is_dense = false;
+  // Skip some points, so that the indices are not contiguous and their number is not a multiple of 8
+  indices.clear ();
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    if (i % 7 != 3)
+      indices.push_back (static_cast<index_t> (i));
+  }
+}
+
+template <typename ModelT> void
+expectKernelsCountEqual (ModelT &model, const Eigen::VectorXf &coefficients, double threshold,
+                         const std::function<std::size_t (SacKernel)> &count)
+{
+  // The vectorized count of the model matches the inliers selected one point at a time
+  Indices inliers;
+  model.selectWithinDistance (coefficients, threshold, inliers);
+  EXPECT_LT (0, inliers.size ());
+  EXPECT_EQ (inliers.size (), model.countWithinDistance (coefficients, threshold));
+  for (const auto &kernel : sac_kernels)
+  {
+    if (pcl::detail::isSacKernelSupported (kernel.first))
+      EXPECT_EQ (inliers.size (), count (kernel.first)) << kernel.second;
+  }
+}
+
+TEST (SampleConsensus, CountWithinDistanceKernels)
+{
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  Indices indices;
+  makeKernelCloud (*cloud, indices, 1003);
+  const auto points = pcl::detail::makeSacPoints (*cloud, indices);
+  EXPECT_TRUE (points.padded);
+
+  SampleConsensusModelPlane<PointXYZ> plane (cloud, indices);
+  Eigen::VectorXf plane_coefficients (4);
+  plane_coefficients << 0.6f, 0.0f, 0.8f, -0.1f;
+  for (const double threshold : {0.05, 0.2})
+    expectKernelsCountEqual (plane, plane_coefficients, threshold, [&] (SacKernel kernel)
+    {
+      return (pcl::detail::countWithinPlaneDistance (points, plane_coefficients, threshold, kernel));
+    });
+
+  SampleConsensusModelSphere<PointXYZ> sphere (cloud, indices);
+  Eigen::VectorXf sphere_coefficients (4);
+  sphere_coefficients << 0.01f, -0.02f, 0.03f, 1.0f;
+  for (const double threshold : {0.01, 0.05})
+    expectKernelsCountEqual (sphere, sphere_coefficients, threshold, [&] (SacKernel kernel)
+    {
+      return (pcl::detail::countWithinSphereDistance (points, sphere_coefficients, threshold, kernel));
+    });
+
+  SampleConsensusModelCircle2D<PointXYZ> circle (cloud, indices);
+  Eigen::VectorXf circle_coefficients (3);
+  circle_coefficients << 0.05f, 0.0f, 0.7f;
+  for (const double threshold : {0.01, 0.05})
+    expectKernelsCountEqual (circle, circle_coefficients, threshold, [&] (SacKernel kernel)
+    {
+      return (pcl::detail::countWithinCircleDistance (points, circle_coefficients, threshold, kernel));
+    });
+
+  SampleConsensusModelLine<PointXYZ> line (cloud, indices);
+  Eigen::VectorXf line_coefficients (6);
+  line_coefficients << 0.1f, 0.2f, 0.0f, 0.0f, 0.0f, 1.0f;
+  for (const double threshold : {0.3, 0.5})
+    expectKernelsCountEqual (line, line_coefficients, threshold, [&] (SacKernel kernel)
+    {
+      return (pcl::detail::countWithinLineDistance (points, line_coefficients.head<3> (), line_coefficients.tail<3> (),
+                                                    threshold * threshold, kernel));
+    });
+}
+
+TEST (SampleConsensus, CountWithinDistanceKernelsBenchmark)
+{
+  PointCloud<PointXYZ> cloud;
+  Indices indices;
+  makeKernelCloud (cloud, indices, 1 << 20);
+  const auto points = pcl::detail::makeSacPoints (cloud, indices);
+  const Eigen::Vector4f plane (0.6f, 0.0f, 0.8f, -0.1f);
+  const Eigen::Vector4f sphere (0.01f, -0.02f, 0.03f, 1.0f);
+  const int nr_iterations = 20;
+
+  const std::size_t plane_count = pcl::detail::countWithinPlaneDistance (points, plane, 0.05, SacKernel::DEFAULT);
+  const std::size_t sphere_count = pcl::detail::countWithinSphereDistance (points, sphere, 0.05, SacKernel::DEFAULT);
+  for (const auto &kernel : sac_kernels)
+  {
+    if (!pcl::detail::isSacKernelSupported (kernel.first))
+    {
+      std::cout << kernel.second << ": not supported by this CPU" << std::endl;
+      continue;
+    }
+    pcl::StopWatch timer;
+    for (int iteration = 0; iteration < nr_iterations; ++iteration)
+      EXPECT_EQ (plane_count, pcl::detail::countWithinPlaneDistance (points, plane, 0.05, kernel.first));
+    const double plane_time = timer.getTimeSeconds ();
+    timer.reset ();
+    for (int iteration = 0; iteration < nr_iterations; ++iteration)
+      EXPECT_EQ (sphere_count, pcl::detail::countWithinSphereDistance (points, sphere, 0.05, kernel.first));
+    const double sphere_time = timer.getTimeSeconds ();
+    std::cout << kernel.second << ": " << nr_iterations / plane_time << " plane and "
+              << nr_iterations / sphere_time << " sphere iterations per second on " << indices.size () << " points" << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SampleConsensusModelRegistration, SPRT)
+{
+  // 60% of the correspondences follow a rigid transformation, the others are random
+  std::mt19937 rng (3);
+  std::uniform_real_distribution<float> uniform (-1.0f, 1.0f);
+  const Eigen::Affine3f transform = Eigen::Translation3f (0.1f, -0.2f, 0.3f) *
+                                    Eigen::AngleAxisf (0.3f, Eigen::Vector3f (1.0f, 2.0f, 3.0f).normalized ());
+  PointCloud<PointXYZ>::Ptr source (new PointCloud<PointXYZ>);
+  PointCloud<PointXYZ>::Ptr target (new PointCloud<PointXYZ>);
+  const std::size_t size = 2000;
+  source->resize (size);
+  target->resize (size);
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    source->points[i].getVector3fMap () = Eigen::Vector3f (uniform (rng), uniform (rng), uniform (rng));
+    if (i % 5 < 3)
+      target->points[i].getVector3fMap () = transform * source->points[i].getVector3fMap ();
+    else
+      target->points[i].getVector3fMap () = Eigen::Vector3f (uniform (rng), uniform (rng), uniform (rng));
+  }
+
+  SampleConsensusModelRegistration<PointXYZ>::Ptr model (new SampleConsensusModelRegistration<PointXYZ> (source));
+  model->setInputTarget (target);
+  EXPECT_TRUE (model->canCountSamplesWithinDistance ());
+
+  // The pre-verification counts the inliers with the point to point distance of countWithinDistance
+  Eigen::VectorXf coefficients (16);
+  for (int row = 0; row < 4; ++row)
+    coefficients.segment<4> (4 * row) = transform.matrix ().row (row);
+  const std::size_t nr_inliers = model->countWithinDistance (coefficients, 0.01);
+  EXPECT_NEAR (0.6 * size, nr_inliers, 10);
+  EXPECT_EQ (nr_inliers, model->countSamplesWithinDistance (*model->getIndices (), coefficients, 0.01));
+
+  // The estimators find the transformation with the pre-verification
+  RandomSampleConsensus<PointXYZ> ransac (model, 0.01);
+  MEstimatorSampleConsensus<PointXYZ> msac (model, 0.01);
+  LeastMedianSquares<PointXYZ> lmeds (model, 0.01);
+  for (SampleConsensus<PointXYZ> *sac : std::vector<SampleConsensus<PointXYZ>*> {&ransac, &msac, &lmeds})
+  {
+    sac->setUseSPRT (true);
+    ASSERT_TRUE (sac->computeModel ());
+    Indices inliers;
+    sac->getInliers (inliers);
+    EXPECT_EQ (nr_inliers, inliers.size ());
+    Eigen::VectorXf sac_coefficients;
+    sac->getModelCoefficients (sac_coefficients);
+    for (Eigen::Index i = 0; i < coefficients.size (); ++i)
+      EXPECT_NEAR (coefficients[i], sac_coefficients[i], 1e-3);
+  }
+}
+
 int
 main (int argc, char** argv)
 {
@@ -44,6 +44,7 @@
 
 #include <pcl/sample_consensus/msac.h>
 #include <pcl/sample_consensus/lmeds.h>
+#include <pcl/sample_consensus/lo_ransac.h>
 #include <pcl/sample_consensus/rmsac.h>
 #include <pcl/sample_consensus/mlesac.h>
 #include <pcl/sample_consensus/ransac.h>
@@ -51,6 +52,9 @@
 #include <pcl/sample_consensus/sac_model_plane.h>
 #include <pcl/sample_consensus/sac_model_normal_plane.h>
 #include <pcl/sample_consensus/sac_model_normal_parallel_plane.h>
+#include <pcl/sample_consensus/sprt.h>
+
+#include <random>
 
 using namespace pcl;
 using namespace pcl::io;
@@ -223,6 +227,115 @@ TEST (SampleConsensusModelPlane, RMSAC)
   verifyPlaneSac (model, sac, 600, 1.0f, 1.0f, 0.01f);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SampleConsensusModelPlane, LORANSAC)
+{
+  srand (0);
+
+  // Create a shared plane model pointer directly
+  SampleConsensusModelPlanePtr model (new SampleConsensusModelPlane<PointXYZ> (cloud_));
+
+  // Create the LO-RANSAC object
+  LocallyOptimizedSampleConsensus<PointXYZ> sac (model, 0.03);
+
+  verifyPlaneSac (model, sac);
+
+  // The batches are reduced in order, the result does not depend on the number of threads
+  Eigen::VectorXf coeff;
+  sac.getModelCoefficients (coeff);
+
+  srand (0);
+  SampleConsensusModelPlanePtr model_parallel (new SampleConsensusModelPlane<PointXYZ> (cloud_));
+  LocallyOptimizedSampleConsensus<PointXYZ> sac_parallel (model_parallel, 0.03);
+  sac_parallel.setNumberOfThreads (4);
+  verifyPlaneSac (model_parallel, sac_parallel);
+
+  Eigen::VectorXf coeff_parallel;
+  sac_parallel.getModelCoefficients (coeff_parallel);
+  for (Eigen::Index i = 0; i < coeff.size (); ++i)
+    EXPECT_EQ (coeff[i], coeff_parallel[i]);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SampleConsensusModelPlane, SPRT)
+{
+  srand (0);
+
+  SampleConsensusModelPlanePtr model (new SampleConsensusModelPlane<PointXYZ> (cloud_));
+
+  RandomSampleConsensus<PointXYZ> ransac (model, 0.03);
+  EXPECT_FALSE (ransac.getUseSPRT ());
+  ransac.setUseSPRT (true);
+  EXPECT_TRUE (ransac.getUseSPRT ());
+  verifyPlaneSac (model, ransac);
+
+  MEstimatorSampleConsensus<PointXYZ> msac (model, 0.03);
+  msac.setUseSPRT (true);
+  verifyPlaneSac (model, msac);
+
+  LeastMedianSquares<PointXYZ> lmeds (model, 0.03);
+  lmeds.setUseSPRT (true);
+  verifyPlaneSac (model, lmeds);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SampleConsensusModelPlane, SPRTDenseCloud)
+{
+  // A noisy plane z = 0.1 x - 0.2 y + 1 with 30% of the points, and uniform outliers
+  std::mt19937 rng (7);
+  std::uniform_real_distribution<float> uniform (-5.0f, 5.0f);
+  std::normal_distribution<float> noise (0.0f, 0.005f);
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  const std::size_t size = 1 << 19;
+  cloud->resize (size);
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    PointXYZ &p = cloud->points[i];
+    p.x = uniform (rng);
+    p.y = uniform (rng);
+    p.z = (i % 10 < 3) ? 0.1f * p.x - 0.2f * p.y + 1.0f + noise (rng) : uniform (rng);
+  }
+  SampleConsensusModelPlanePtr model (new SampleConsensusModelPlane<PointXYZ> (cloud));
+
+  // The test rejects a bad hypothesis after a few points, and scores a good one on all of them
+  SampleConsensusSPRT sprt (size);
+  EXPECT_FALSE (sprt.isActive ());
+  sprt.setInlierRatio (0.3);
+  ASSERT_TRUE (sprt.isActive ());
+  EXPECT_GT (0.05, sprt.getFalseRejectionProbability ());
+  Eigen::VectorXf bad (4), good (4);
+  bad << 0.0f, 0.0f, 1.0f, 0.0f;
+  good << 0.1f, -0.2f, -1.0f, 1.0f;
+  good /= good.head<3> ().norm ();
+  std::minstd_rand sprt_rng (42);
+  const SampleConsensusSPRT::Result bad_result = sprt.verify (*model, bad, 0.02, sprt_rng);
+  EXPECT_TRUE (bad_result.rejected);
+  EXPECT_GT (200, bad_result.nr_tested);
+  const SampleConsensusSPRT::Result good_result = sprt.verify (*model, good, 0.02, sprt_rng);
+  EXPECT_FALSE (good_result.rejected);
+  sprt.addRejected (bad_result);
+  EXPECT_NEAR (static_cast<double> (bad_result.nr_consistent) / bad_result.nr_tested, sprt.getDelta (), 1e-12);
+
+  // The estimators find the same plane with and without the pre-verification
+  RandomSampleConsensus<PointXYZ> ransac (model, 0.02);
+  ASSERT_TRUE (ransac.computeModel ());
+  Indices inliers;
+  ransac.getInliers (inliers);
+
+  ransac.setUseSPRT (true);
+  ASSERT_TRUE (ransac.computeModel ());
+  Indices sprt_inliers;
+  ransac.getInliers (sprt_inliers);
+  EXPECT_NEAR (0.3 * size, inliers.size (), 0.01 * size);
+  EXPECT_NEAR (0.3 * size, sprt_inliers.size (), 0.01 * size);
+
+  MEstimatorSampleConsensus<PointXYZ> msac (model, 0.02);
+  msac.setUseSPRT (true);
+  ASSERT_TRUE (msac.computeModel ());
+  msac.getInliers (sprt_inliers);
+  EXPECT_NEAR (0.3 * size, sprt_inliers.size (), 0.01 * size);
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (SampleConsensusModelNormalPlane, RANSAC)
 {
@@ -239,6 +352,53 @@ TEST (SampleConsensusModelNormalPlane, RANSAC)
   verifyPlaneSac (model, sac);
 }
 
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SampleConsensusModelNormalPlane, CountSamplesWithinDistance)
+{
+  SampleConsensusModelNormalPlanePtr model (new SampleConsensusModelNormalPlane<PointXYZ, Normal> (cloud_));
+  model->setInputNormals (normals_);
+  EXPECT_TRUE (model->canCountSamplesWithinDistance ());
+
+  Eigen::VectorXf coeff (4);
+  coeff << plane_coeffs_[0], plane_coeffs_[1], plane_coeffs_[2], 1.0f;
+  coeff /= coeff.head<3> ().norm ();
+
+  // The pre-verification counts the inliers with the weighted distance of countWithinDistance
+  for (const double weight : {0.0, 0.1, 0.5})
+  {
+    model->setNormalDistanceWeight (weight);
+    for (const double threshold : {0.03, 0.1})
+      EXPECT_EQ (model->countWithinDistance (coeff, threshold),
+                 model->countSamplesWithinDistance (*model->getIndices (), coeff, threshold)) << weight << " " << threshold;
+  }
+
+  model->setNormalDistanceWeight (0.01);
+  RandomSampleConsensus<PointXYZ> sac (model, 0.03);
+  sac.setUseSPRT (true);
+  verifyPlaneSac (model, sac);
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SampleConsensusModelNormalParallelPlane, CountSamplesWithinDistance)
+{
+  SampleConsensusModelNormalParallelPlanePtr model (new SampleConsensusModelNormalParallelPlane<PointXYZ, Normal> (cloud_));
+  model->setInputNormals (normals_);
+  model->setNormalDistanceWeight (0.01);
+  model->setEpsAngle (0.1);
+
+  Eigen::VectorXf coeff (4);
+  coeff << plane_coeffs_[0], plane_coeffs_[1], plane_coeffs_[2], 1.0f;
+  coeff /= coeff.head<3> ().norm ();
+
+  // The points are only counted on the models which respect the axis
+  model->setAxis (coeff.head<3> ());
+  EXPECT_LT (2000, model->countSamplesWithinDistance (*model->getIndices (), coeff, 0.03));
+  EXPECT_EQ (model->countWithinDistance (coeff, 0.03), model->countSamplesWithinDistance (*model->getIndices (), coeff, 0.03));
+  model->setAxis (Eigen::Vector3f (coeff[1], -coeff[0], 0.0f).normalized ());
+  EXPECT_EQ (0, model->countWithinDistance (coeff, 0.03));
+  EXPECT_EQ (0, model->countSamplesWithinDistance (*model->getIndices (), coeff, 0.03));
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (SampleConsensusModelNormalParallelPlane, RANSAC)
 {
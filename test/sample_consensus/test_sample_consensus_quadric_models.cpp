@@ -46,6 +46,8 @@
 #include <pcl/sample_consensus/sac_model_circle3d.h>
 #include <pcl/sample_consensus/sac_model_normal_sphere.h>
 
+#include <random>
+
 using namespace pcl;
 
 using SampleConsensusModelSpherePtr = SampleConsensusModelSphere<PointXYZ>::Ptr;
@@ -207,6 +209,55 @@ TEST (SampleConsensusModelNormalSphere, RANSAC)
   EXPECT_NEAR (1.000, coeff_refined[2], 1e-2);
   EXPECT_NEAR (0.050, coeff_refined[3], 1e-2);
 }
+//////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST (SampleConsensusModelNormalSphere, CountSamplesWithinDistance)
+{
+  // A noisy sphere with noisy normals, and uniform outliers
+  std::mt19937 rng (5);
+  std::uniform_real_distribution<float> uniform (-1.0f, 1.0f);
+  std::normal_distribution<float> noise (0.0f, 0.01f);
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  PointCloud<Normal>::Ptr normals (new PointCloud<Normal>);
+  const Eigen::Vector3f center (0.1f, 0.2f, 0.3f);
+  for (int i = 0; i < 500; ++i)
+  {
+    const Eigen::Vector3f direction = Eigen::Vector3f (uniform (rng), uniform (rng), uniform (rng)).normalized ();
+    PointXYZ point;
+    Normal normal;
+    if (i % 4 == 0)
+    {
+      point.getVector3fMap () = Eigen::Vector3f (uniform (rng), uniform (rng), uniform (rng));
+      normal.getNormalVector3fMap () = Eigen::Vector3f (uniform (rng), uniform (rng), uniform (rng)).normalized ();
+    }
+    else
+    {
+      point.getVector3fMap () = center + (0.5f + noise (rng)) * direction;
+      normal.getNormalVector3fMap () = (direction + 10.0f * Eigen::Vector3f (noise (rng), noise (rng), noise (rng))).normalized ();
+    }
+    cloud->push_back (point);
+    normals->push_back (normal);
+  }
+
+  SampleConsensusModelNormalSpherePtr model (new SampleConsensusModelNormalSphere<PointXYZ, Normal> (cloud));
+  model->setInputNormals (normals);
+  EXPECT_TRUE (model->canCountSamplesWithinDistance ());
+
+  // The pre-verification counts the inliers with the weighted distance of countWithinDistance
+  Eigen::VectorXf coeff (4);
+  coeff << center[0], center[1], center[2], 0.5f;
+  for (const double weight : {0.0, 0.1, 0.5})
+  {
+    model->setNormalDistanceWeight (weight);
+    for (const double threshold : {0.01, 0.03})
+      EXPECT_EQ (model->countWithinDistance (coeff, threshold),
+                 model->countSamplesWithinDistance (*model->getIndices (), coeff, threshold)) << weight << " " << threshold;
+  }
+
+  // Spheres out of the radius limits have no inliers
+  model->setRadiusLimits (0.0, 0.4);
+  EXPECT_EQ (0, model->countSamplesWithinDistance (*model->getIndices (), coeff, 0.03));
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 TEST (SampleConsensusModelCone, RANSAC)
 {
@@ -0,0 +1,288 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/test/gtest.h>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+#include <pcl/search/bucket_kdtree.h>
+#include <pcl/search/incremental_kdtree.h>
+
+#include <algorithm>
+#include <random>
+
+using namespace pcl;
+
+/** \brief Gives access to the nodes of the tree. */
+class IncrementalKdTreeProbe : public search::IncrementalKdTree<PointXYZ>
+{
+  public:
+    int
+    getDepth (int node = -2) const
+    {
+      if (node == -2)
+        node = root_;
+      if (node < 0)
+        return (0);
+      return (1 + std::max (getDepth (nodes_[node].left), getDepth (nodes_[node].right)));
+    }
+};
+
+PointCloud<PointXYZ>
+makeRandomCloud (std::mt19937 &rng, std::size_t size, float offset)
+{
+  std::uniform_real_distribution<float> u (0.0f, 1.0f);
+  PointCloud<PointXYZ> cloud;
+  for (std::size_t i = 0; i < size; ++i)
+  {
+    cloud.push_back (PointXYZ (u (rng) + offset, u (rng), u (rng)));
+    if (i % 50 == 0)
+      cloud.back ().y = std::numeric_limits<float>::quiet_NaN ();
+  }
+  cloud.is_dense = false;
+  return (cloud);
+}
+
+/** \brief Check the searches of the tree against a BucketKdTree over the points it should hold. */
+void
+checkSearches (const search::IncrementalKdTree<PointXYZ> &tree, const IndicesPtr &valid, std::mt19937 &rng)
+{
+  ASSERT_EQ (valid->size (), tree.getNumberOfPoints ());
+  search::BucketKdTree<PointXYZ> reference;
+  reference.setInputCloud (tree.getInputCloud (), valid);
+
+  std::uniform_real_distribution<float> u (-0.2f, 1.2f);
+  for (int i = 0; i < 50; ++i)
+  {
+    const PointXYZ query (u (rng) + 0.5f, u (rng), u (rng));
+    for (const int k : {1, 8, 50})
+    {
+      Indices indices, expected_indices;
+      std::vector<float> sqr_distances, expected_sqr_distances;
+      const int nr_neighbors = tree.nearestKSearch (query, k, indices, sqr_distances);
+      ASSERT_EQ (reference.nearestKSearch (query, k, expected_indices, expected_sqr_distances), nr_neighbors);
+      for (int j = 0; j < nr_neighbors; ++j)
+        EXPECT_NEAR (expected_sqr_distances[j], sqr_distances[j], 1e-6);
+    }
+    for (const double radius : {0.05, 0.2})
+    {
+      Indices indices, expected_indices;
+      std::vector<float> sqr_distances, expected_sqr_distances;
+      tree.radiusSearch (query, radius, indices, sqr_distances);
+      reference.radiusSearch (query, radius, expected_indices, expected_sqr_distances);
+      EXPECT_TRUE (std::is_sorted (sqr_distances.begin (), sqr_distances.end ()));
+      std::sort (indices.begin (), indices.end ());
+      std::sort (expected_indices.begin (), expected_indices.end ());
+      EXPECT_EQ (expected_indices, indices);
+    }
+  }
+}
+
+TEST (IncrementalKdTree, Updates)
+{
+  std::mt19937 rng (42);
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ> (makeRandomCloud (rng, 2000, 0.0f)));
+
+  search::IncrementalKdTree<PointXYZ> tree;
+  tree.setInputCloud (cloud);
+  // The points the tree should hold
+  IndicesPtr valid (new Indices);
+  for (std::size_t i = 0; i < cloud->size (); ++i)
+    if (isFinite ((*cloud)[i]))
+      valid->push_back (static_cast<index_t> (i));
+  checkSearches (tree, valid, rng);
+
+  // A map growing along x and losing its old parts
+  for (int frame = 1; frame <= 20; ++frame)
+  {
+    const auto first = static_cast<index_t> (tree.getInputCloud ()->size ());
+    const PointCloud<PointXYZ> points = makeRandomCloud (rng, 300, 0.05f * static_cast<float> (frame));
+    tree.addPoints (points);
+    ASSERT_EQ (first + points.size (), tree.getInputCloud ()->size ());
+    for (std::size_t i = 0; i < points.size (); ++i)
+      if (isFinite (points[i]))
+        valid->push_back (first + static_cast<index_t> (i));
+
+    const Eigen::Vector3f min_pt (0.05f * static_cast<float> (frame - 1), 0.0f, 0.0f);
+    const Eigen::Vector3f max_pt (0.05f * static_cast<float> (frame), 0.5f, 1.0f);
+    const auto in_box = [&] (index_t index)
+    {
+      const Eigen::Vector3f p = (*tree.getInputCloud ())[index].getVector3fMap ();
+      return ((p.array () >= min_pt.array ()).all () && (p.array () <= max_pt.array ()).all ());
+    };
+    const auto nr_in_box = std::count_if (valid->begin (), valid->end (), in_box);
+    EXPECT_EQ (static_cast<std::size_t> (nr_in_box), tree.removeBox (min_pt, max_pt));
+    valid->erase (std::remove_if (valid->begin (), valid->end (), in_box), valid->end ());
+
+    // Remove every 7th point, plus one already removed
+    Indices removed;
+    for (std::size_t i = 0; i < valid->size (); i += 7)
+      removed.push_back ((*valid)[i]);
+    const std::size_t nr_removed = removed.size ();
+    removed.push_back (removed.front ());
+    EXPECT_EQ (nr_removed, tree.removePoints (removed));
+    std::sort (removed.begin (), removed.end ());
+    valid->erase (std::remove_if (valid->begin (), valid->end (), [&] (index_t index)
+    {
+      return (std::binary_search (removed.begin (), removed.end (), index));
+    }), valid->end ());
+
+    checkSearches (tree, valid, rng);
+  }
+}
+
+TEST (IncrementalKdTree, Balance)
+{
+  // Points inserted one by one in sorted order would make a list without rebalancing
+  PointCloud<PointXYZ> points;
+  for (int i = 0; i < 20000; ++i)
+    points.push_back (PointXYZ (0.001f * static_cast<float> (i), 0.0f, 0.0f));
+
+  IncrementalKdTreeProbe tree;
+  for (const auto &point : points)
+  {
+    PointCloud<PointXYZ> single;
+    single.push_back (point);
+    tree.addPoints (single);
+  }
+  EXPECT_EQ (points.size (), tree.getNumberOfPoints ());
+  EXPECT_LT (tree.getDepth (), 50);
+
+  // Removing most of the points also shrinks the tree
+  EXPECT_EQ (18000, tree.removeBox (Eigen::Vector3f (-1.0f, -1.0f, -1.0f), Eigen::Vector3f (17.9995f, 1.0f, 1.0f)));
+  EXPECT_EQ (2000, tree.getNumberOfPoints ());
+  EXPECT_LT (tree.getDepth (), 30);
+
+  Indices indices;
+  std::vector<float> sqr_distances;
+  ASSERT_EQ (1, tree.nearestKSearch (PointXYZ (0.0f, 0.0f, 0.0f), 1, indices, sqr_distances));
+  EXPECT_EQ (18000, indices[0]);
+}
+
+TEST (IncrementalKdTree, Empty)
+{
+  search::IncrementalKdTree<PointXYZ> tree;
+  Indices indices;
+  std::vector<float> sqr_distances;
+  EXPECT_EQ (0, tree.nearestKSearch (PointXYZ (0.0f, 0.0f, 0.0f), 5, indices, sqr_distances));
+  EXPECT_EQ (0, tree.removeBox (Eigen::Vector3f::Zero (), Eigen::Vector3f::Ones ()));
+
+  PointCloud<PointXYZ> points;
+  points.push_back (PointXYZ (0.5f, 0.5f, 0.5f));
+  points.push_back (PointXYZ (2.0f, 2.0f, 2.0f));
+  tree.addPoints (points);
+  EXPECT_EQ (2, tree.getNumberOfPoints ());
+  EXPECT_EQ (1, tree.removeBox (Eigen::Vector3f::Zero (), Eigen::Vector3f::Ones ()));
+  EXPECT_EQ (1, tree.removePoints (Indices {0, 1}));
+  EXPECT_EQ (0, tree.getNumberOfPoints ());
+  EXPECT_EQ (0, tree.radiusSearch (PointXYZ (2.0f, 2.0f, 2.0f), 1.0, indices, sqr_distances));
+
+  tree.addPoints (points);
+  ASSERT_EQ (1, tree.nearestKSearch (PointXYZ (2.0f, 2.0f, 2.0f), 1, indices, sqr_distances));
+  EXPECT_EQ (3, indices[0]);
+}
+
+TEST (IncrementalKdTree, InputIndices)
+{
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  cloud->push_back (PointXYZ (0.0f, 0.0f, 0.0f));
+  cloud->push_back (PointXYZ (1.0f, 0.0f, 0.0f));
+  cloud->push_back (PointXYZ (2.0f, 0.0f, 0.0f));
+  IndicesPtr input_indices (new Indices {0, 2});
+
+  search::IncrementalKdTree<PointXYZ> tree;
+  tree.setInputCloud (cloud, input_indices);
+  PointCloud<PointXYZ> points;
+  points.push_back (PointXYZ (3.0f, 0.0f, 0.0f));
+  points.push_back (PointXYZ (4.0f, 0.0f, 0.0f));
+  tree.addPoints (points);
+
+  EXPECT_EQ (Indices ({0, 2}), *input_indices);
+  EXPECT_EQ (Indices ({0, 2, 3, 4}), *tree.getIndices ());
+  EXPECT_EQ (4, tree.getNumberOfPoints ());
+
+  Indices indices;
+  std::vector<float> sqr_distances;
+  ASSERT_EQ (1, tree.nearestKSearch (PointXYZ (1.1f, 0.0f, 0.0f), 1, indices, sqr_distances));
+  EXPECT_EQ (2, indices[0]);
+}
+
+TEST (IncrementalKdTree, RadiusBoundary)
+{
+  // Points exactly on the sphere of radius 0.5 around the query, which are not neighbors, and points inside it
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  for (const float d : {0.5f, -0.5f})
+  {
+    cloud->push_back (PointXYZ (d, 0.0f, 0.0f));
+    cloud->push_back (PointXYZ (0.0f, d, 0.0f));
+    cloud->push_back (PointXYZ (0.0f, 0.0f, d));
+    cloud->push_back (PointXYZ (0.5f * d, 0.0f, 0.0f));
+  }
+  cloud->push_back (PointXYZ (0.0f, 0.0f, 0.0f));
+
+  search::IncrementalKdTree<PointXYZ> tree;
+  tree.setInputCloud (cloud);
+  search::BucketKdTree<PointXYZ> reference;
+  reference.setInputCloud (cloud);
+
+  const PointXYZ query (0.0f, 0.0f, 0.0f);
+  for (const unsigned int max_nn : {0u, 2u, 3u})
+  {
+    Indices indices, expected_indices;
+    std::vector<float> sqr_distances, expected_sqr_distances;
+    const int nr_neighbors = tree.radiusSearch (query, 0.5, indices, sqr_distances, max_nn);
+    EXPECT_EQ (reference.radiusSearch (query, 0.5, expected_indices, expected_sqr_distances, max_nn), nr_neighbors);
+    EXPECT_EQ (max_nn == 2 ? 2 : 3, nr_neighbors);
+    std::sort (indices.begin (), indices.end ());
+    std::sort (expected_indices.begin (), expected_indices.end ());
+    EXPECT_EQ (expected_indices, indices);
+  }
+
+  // A sphere touching the bounding box of the points only at its boundary holds no neighbors
+  Indices indices;
+  std::vector<float> sqr_distances;
+  EXPECT_EQ (0, tree.radiusSearch (PointXYZ (1.0f, 0.0f, 0.0f), 0.5, indices, sqr_distances));
+  EXPECT_EQ (1, tree.radiusSearch (PointXYZ (1.0f, 0.0f, 0.0f), 0.75, indices, sqr_distances));
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  testing::InitGoogleTest (&argc, argv);
+  return (RUN_ALL_TESTS ());
+}
+/* ]--- */
@@ -195,6 +195,37 @@ TEST (PCL, KdTree_multipointKnnSearch)
   }
 }
 
+/* Test for KdTree searches writing into a reusable NeighborBuffer, with sorted and unsorted results */
+TEST (PCL, KdTree_neighborBuffer)
+{
+  for (const bool sorted : {true, false})
+  {
+    pcl::search::KdTree<PointXYZ> kdtree (sorted);
+    kdtree.setInputCloud (cloud_big.makeShared ());
+
+    std::vector<int> k_indices;
+    std::vector<float> k_distances;
+    // Start with a small capacity, so that the radius searches have to grow it
+    pcl::search::NeighborBuffer neighbors (4);
+    for (std::size_t i = 0; i < 1000; ++i)
+    {
+      const PointXYZ &point = cloud_big.points[i];
+      kdtree.nearestKSearch (point, 20, k_indices, k_distances);
+      EXPECT_EQ (20, kdtree.nearestKSearch (point, 20, neighbors));
+      EXPECT_EQ (k_indices, neighbors.indices);
+      EXPECT_EQ (k_distances, neighbors.sqr_distances);
+
+      for (const unsigned int max_nn : {0u, 3u, 50u})
+      {
+        kdtree.radiusSearch (point, 30.0, k_indices, k_distances, max_nn);
+        EXPECT_EQ (static_cast<int> (k_indices.size ()), kdtree.radiusSearch (point, 30.0, neighbors, max_nn));
+        EXPECT_EQ (k_indices, neighbors.indices);
+        EXPECT_EQ (k_distances, neighbors.sqr_distances);
+      }
+    }
+  }
+}
+
 int
 main (int argc, char** argv)
 {
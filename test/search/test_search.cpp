@@ -43,6 +43,8 @@
 #include <pcl/search/kdtree.h>
 #include <pcl/search/organized.h>
 #include <pcl/search/octree.h>
+#include <pcl/search/bucket_kdtree.h>
+#include <pcl/search/incremental_kdtree.h>
 #include <pcl/io/pcd_io.h>
 #include <pcl/common/point_tests.h> // for pcl::isFinite
 #include <pcl/common/time.h>
@@ -68,6 +70,8 @@ using namespace std;
 #define TEST_ORGANIZED_SPARSE_VIEW_KNN                1
 #define TEST_ORGANIZED_SPARSE_COMPLETE_RADIUS         1
 #define TEST_ORGANIZED_SPARSE_VIEW_RADIUS             1
+#define TEST_BATCH_SEARCH                             1
+#define TEST_BUCKET_KDTREE_RADIUS_BOUNDARY            1
 
 #if EXCESSIVE_TESTING
 /** \brief number of points used for creating unordered point clouds */
@@ -119,6 +123,12 @@ pcl::search::KdTree<pcl::PointXYZ> KDTree;
 /** \brief instance of Octree search method to be tested*/
 pcl::search::Octree<pcl::PointXYZ> octree_search (0.1);
 
+/** \brief instance of BucketKdTree search method to be tested*/
+pcl::search::BucketKdTree<pcl::PointXYZ> bucket_kdtree;
+
+/** \brief instance of IncrementalKdTree search method to be tested*/
+pcl::search::IncrementalKdTree<pcl::PointXYZ> incremental_kdtree;
+
 /** \brief instance of Organized search method to be tested*/
 pcl::search::OrganizedNeighbor<pcl::PointXYZ> organized;
 
@@ -434,6 +444,58 @@ testRadiusSearch (typename PointCloud<PointT>::ConstPtr point_cloud, std::vector
   }
 }
 
+/** \brief does batched KNN and radius searches and tests that they return the same results as the single query
+  * searches of each method, independently of the number of threads
+  * \param cloud the input point cloud
+  * \param search_methods vector of all search methods to be tested
+  * \param query_indices indices of query points in the point cloud (not necessarily in input_indices)
+  * \param input_indices indices defining a subset of the point cloud.
+  */
+template<typename PointT> void
+testBatchSearch (typename PointCloud<PointT>::ConstPtr point_cloud, std::vector<search::Search<PointT>*> search_methods,
+                 const std::vector<int>& query_indices, const std::vector<int>& input_indices = std::vector<int> () )
+{
+  IndicesConstPtr input_indices_;
+  if (!input_indices.empty ())
+    input_indices_.reset (new std::vector<int> (input_indices));
+
+  const int knn = 10;
+  const double radius = 0.1;
+  std::vector<int> indices, batch_indices;
+  std::vector<float> distances, batch_distances;
+  search::Neighborhoods neighborhoods;
+  for (const auto& search_method : search_methods)
+  {
+    search_method->setInputCloud (point_cloud, input_indices_);
+    for (const unsigned int nr_threads : {1u, 2u, 4u})
+    {
+      search_method->nearestKSearch (*point_cloud, query_indices, knn, neighborhoods, nr_threads);
+      ASSERT_EQ (query_indices.size (), neighborhoods.size ());
+      for (std::size_t qIdx = 0; qIdx < query_indices.size (); ++qIdx)
+      {
+        search_method->nearestKSearch (point_cloud->points[query_indices[qIdx]], knn, indices, distances);
+        neighborhoods.getNeighbors (qIdx, batch_indices, batch_distances);
+        EXPECT_TRUE (compareResults (indices, distances, search_method->getName (),
+                                     batch_indices, batch_distances, search_method->getName () + " (batch)", 1e-6f));
+      }
+
+      // max_nn keeps the same first neighbors found as the single query searches
+      for (const unsigned int max_nn : {0u, 5u})
+      {
+        search_method->radiusSearch (*point_cloud, query_indices, radius, neighborhoods, max_nn, nr_threads);
+        ASSERT_EQ (query_indices.size (), neighborhoods.size ());
+        for (std::size_t qIdx = 0; qIdx < query_indices.size (); ++qIdx)
+        {
+          search_method->radiusSearch (point_cloud->points[query_indices[qIdx]], radius, indices, distances, max_nn);
+          neighborhoods.getNeighbors (qIdx, batch_indices, batch_distances);
+          EXPECT_TRUE (compareResults (indices, distances, search_method->getName (),
+                                       batch_indices, batch_distances, search_method->getName () + " (batch)", 1e-6f));
+        }
+      }
+    }
+  }
+}
+
 #if TEST_unorganized_dense_cloud_COMPLETE_KNN
 // Test search on unorganized point clouds
 TEST (PCL, unorganized_dense_cloud_Complete_KNN)
@@ -540,6 +602,56 @@ TEST (PCL, Organized_Sparse_View_Radius)
 }
 #endif
 
+#if TEST_BATCH_SEARCH
+TEST (PCL, unorganized_sparse_cloud_View_Batch)
+{
+  testBatchSearch (unorganized_sparse_cloud, unorganized_search_methods, unorganized_sparse_cloud_query_indices, unorganized_input_indices);
+}
+
+TEST (PCL, Organized_Sparse_Complete_Batch)
+{
+  testBatchSearch (organized_sparse_cloud, organized_search_methods, organized_sparse_query_indices);
+}
+
+TEST (PCL, unorganized_sparse_cloud_Complete_Batch_Uneven)
+{
+  // 17 queries do not split evenly in blocks on 2 or 4 threads
+  ASSERT_GE (unorganized_sparse_cloud_query_indices.size (), 17u);
+  const std::vector<int> query_indices (unorganized_sparse_cloud_query_indices.begin (),
+                                        unorganized_sparse_cloud_query_indices.begin () + 17);
+  testBatchSearch (unorganized_sparse_cloud, unorganized_search_methods, query_indices);
+}
+#endif
+
+#if TEST_BUCKET_KDTREE_RADIUS_BOUNDARY
+// Neighbors exactly at the radius are excluded by BucketKdTree, as by KdTree
+TEST (PCL, BucketKdTree_Radius_Boundary)
+{
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  for (int x = 0; x < 5; ++x)
+    for (int y = 0; y < 5; ++y)
+      for (int z = 0; z < 5; ++z)
+        cloud->push_back (PointXYZ (static_cast<float> (x), static_cast<float> (y), static_cast<float> (z)));
+
+  pcl::search::BucketKdTree<PointXYZ> tree;
+  pcl::search::KdTree<PointXYZ> flann_tree;
+  tree.setInputCloud (cloud);
+  flann_tree.setInputCloud (cloud);
+
+  std::vector<int> indices, flann_indices;
+  std::vector<float> distances, flann_distances;
+  const PointXYZ &query = cloud->points[62];
+  EXPECT_EQ (1, tree.radiusSearch (query, 1.0, indices, distances));
+  EXPECT_EQ (7, tree.radiusSearch (query, 1.001, indices, distances));
+  for (const unsigned int max_nn : {0u, 3u})
+  {
+    tree.radiusSearch (query, 1.0, indices, distances, max_nn);
+    flann_tree.radiusSearch (query, 1.0, flann_indices, flann_distances, max_nn);
+    EXPECT_EQ (flann_indices, indices);
+  }
+}
+#endif
+
 /** \brief create subset of point in cloud to use as query points
   * \param[out] query_indices resulting query indices - not guaranteed to have size of query_count but guaranteed not to exceed that value
   * \param cloud input cloud required to check for nans and to get number of points
@@ -643,15 +755,21 @@ main (int argc, char** argv)
   KDTree.setSortedResults (true);
   octree_search.setSortedResults (true);
   organized.setSortedResults (true);
+  bucket_kdtree.setSortedResults (true);
+  incremental_kdtree.setSortedResults (true);
   
   unorganized_search_methods.push_back (&brute_force);
   unorganized_search_methods.push_back (&KDTree);
   unorganized_search_methods.push_back (&octree_search);
+  unorganized_search_methods.push_back (&bucket_kdtree);
+  unorganized_search_methods.push_back (&incremental_kdtree);
   
   organized_search_methods.push_back (&brute_force);
   organized_search_methods.push_back (&KDTree);
   organized_search_methods.push_back (&octree_search);
   organized_search_methods.push_back (&organized);
+  organized_search_methods.push_back (&bucket_kdtree);
+  organized_search_methods.push_back (&incremental_kdtree);
   
   createQueryIndices (unorganized_dense_cloud_query_indices, unorganized_dense_cloud, query_count);
   createQueryIndices (unorganized_sparse_cloud_query_indices, unorganized_sparse_cloud, query_count);
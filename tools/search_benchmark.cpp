@@ -0,0 +1,169 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Point Cloud Library (PCL) - www.pointclouds.org
+ *  Copyright (c) 2020-, Open Perception, Inc.
+ *
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of the copyright holder(s) nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <pcl/point_types.h>
+#include <pcl/io/pcd_io.h>
+#include <pcl/search/kdtree.h>
+#include <pcl/search/bucket_kdtree.h>
+#include <pcl/common/point_tests.h> // for pcl::isFinite
+#include <pcl/console/print.h>
+#include <pcl/console/parse.h>
+#include <pcl/console/time.h>
+
+#include <cmath>
+
+using namespace pcl;
+using namespace pcl::io;
+using namespace pcl::console;
+
+int    default_k = 10;
+double default_radius = 0.01;
+int    default_leaf_size = 16;
+int    default_threads = 1;
+
+void
+printHelp (int, char **argv)
+{
+  print_error ("Syntax is: %s input.pcd <options>\n", argv[0]);
+  print_info ("  where options are:\n");
+  print_info ("                     -k X         = the number of nearest neighbors to search for (default: ");
+  print_value ("%d", default_k); print_info (")\n");
+  print_info ("                     -radius X    = the radius of the radius searches (default: ");
+  print_value ("%f", default_radius); print_info (")\n");
+  print_info ("                     -leaf_size X = the maximum number of points in a leaf of BucketKdTree (default: ");
+  print_value ("%d", default_leaf_size); print_info (")\n");
+  print_info ("                     -threads X   = the number of threads used to build BucketKdTree (default: ");
+  print_value ("%d", default_threads); print_info (")\n");
+}
+
+/** \brief Build a search method on a cloud, and time its searches with every finite point of the cloud as query.
+  * \return the number of neighbors found in the radius searches, to compare the search methods
+  */
+std::size_t
+benchmark (search::Search<PointXYZ> &search, const PointCloud<PointXYZ>::ConstPtr &cloud, const Indices &queries,
+           int k, double radius, std::vector<std::vector<float> > &knn_sqr_distances)
+{
+  TicToc tt;
+  tt.tic ();
+  search.setInputCloud (cloud);
+  print_info ("%15s: build ", search.getName ().c_str ()); print_value ("%8g", tt.toc ()); print_info (" ms, ");
+
+  Indices k_indices;
+  std::vector<float> k_sqr_distances;
+  knn_sqr_distances.resize (queries.size ());
+  tt.tic ();
+  for (std::size_t i = 0; i < queries.size (); ++i)
+  {
+    search.nearestKSearch (cloud->points[queries[i]], k, k_indices, k_sqr_distances);
+    knn_sqr_distances[i] = k_sqr_distances;
+  }
+  print_info ("%d-NN ", k); print_value ("%8g", tt.toc ()); print_info (" ms, ");
+
+  std::size_t nr_neighbors = 0;
+  tt.tic ();
+  for (const auto &query : queries)
+    nr_neighbors += search.radiusSearch (cloud->points[query], radius, k_indices, k_sqr_distances);
+  print_info ("radius "); print_value ("%8g", tt.toc ()); print_info (" ms ("); print_value ("%zu", nr_neighbors);
+  print_info (" neighbors)\n");
+  return (nr_neighbors);
+}
+
+/* ---[ */
+int
+main (int argc, char** argv)
+{
+  print_info ("Compare the FLANN based KdTree and BucketKdTree search methods. For more information, use: %s -h\n", argv[0]);
+
+  std::vector<int> p_file_indices = parse_file_extension_argument (argc, argv, ".pcd");
+  if (p_file_indices.size () != 1)
+  {
+    printHelp (argc, argv);
+    return (-1);
+  }
+
+  int k = default_k;
+  double radius = default_radius;
+  int leaf_size = default_leaf_size;
+  int threads = default_threads;
+  parse_argument (argc, argv, "-k", k);
+  parse_argument (argc, argv, "-radius", radius);
+  parse_argument (argc, argv, "-leaf_size", leaf_size);
+  parse_argument (argc, argv, "-threads", threads);
+
+  PointCloud<PointXYZ>::Ptr cloud (new PointCloud<PointXYZ>);
+  if (loadPCDFile (argv[p_file_indices[0]], *cloud) < 0)
+  {
+    print_error ("Unable to load %s.\n", argv[p_file_indices[0]]);
+    return (-1);
+  }
+
+  Indices queries;
+  for (std::size_t i = 0; i < cloud->points.size (); ++i)
+    if (isFinite (cloud->points[i]))
+      queries.push_back (static_cast<int> (i));
+  print_info ("Searching the neighbors of "); print_value ("%zu", queries.size ()); print_info (" points.\n");
+
+  search::KdTree<PointXYZ> kdtree (false);
+  search::BucketKdTree<PointXYZ> bucket_kdtree (false);
+  bucket_kdtree.setMaxLeafSize (leaf_size);
+  bucket_kdtree.setNumberOfThreads (threads);
+
+  std::vector<std::vector<float> > kdtree_sqr_distances, bucket_kdtree_sqr_distances;
+  const std::size_t kdtree_nr_neighbors = benchmark (kdtree, cloud, queries, k, radius, kdtree_sqr_distances);
+  const std::size_t bucket_kdtree_nr_neighbors = benchmark (bucket_kdtree, cloud, queries, k, radius, bucket_kdtree_sqr_distances);
+
+  // Both trees are exact, so they must find neighbors at the same distances
+  std::size_t nr_mismatches = 0;
+  for (std::size_t i = 0; i < queries.size (); ++i)
+  {
+    const auto &a = kdtree_sqr_distances[i];
+    const auto &b = bucket_kdtree_sqr_distances[i];
+    bool match = (a.size () == b.size ());
+    for (std::size_t j = 0; match && j < a.size (); ++j)
+      match = (std::abs (a[j] - b[j]) <= 1e-6f * (1.0f + a[j]));
+    if (!match)
+      ++nr_mismatches;
+  }
+  if (nr_mismatches != 0 || kdtree_nr_neighbors != bucket_kdtree_nr_neighbors)
+  {
+    print_error ("The results differ for %zu nearest neighbor queries, and the radius searches found %zu and %zu neighbors.\n",
+                 nr_mismatches, kdtree_nr_neighbors, bucket_kdtree_nr_neighbors);
+    return (-1);
+  }
+  print_info ("The results of both search methods match.\n");
+  return (0);
+}